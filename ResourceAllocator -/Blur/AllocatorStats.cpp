@@ -0,0 +1,168 @@
+#include "AllocatorStats.h"
+#include <algorithm>
+#include <sstream>
+
+namespace DSM {
+	namespace {
+		void WriteJsonString(std::ostringstream& os, const std::string& str)
+		{
+			constexpr char HexDigits[] = "0123456789abcdef";
+			os << '"';
+			for (auto c : str) {
+				auto code = static_cast<unsigned char>(c);
+				if (c == '"' || c == '\\') {
+					os << '\\' << c;
+				}
+				else if (c == '\n') {
+					os << "\\n";
+				}
+				else if (c == '\t') {
+					os << "\\t";
+				}
+				else if (code < 0x20) {
+					// 其余控制字符必须以 \u 转义
+					os << "\\u00" << HexDigits[code >> 4] << HexDigits[code & 0xf];
+				}
+				else {
+					os << c;
+				}
+			}
+			os << '"';
+		}
+
+		void WriteJsonArray(std::ostringstream& os, const std::vector<std::uint64_t>& values)
+		{
+			os << '[';
+			for (std::size_t i = 0; i < values.size(); ++i) {
+				os << (i == 0 ? "" : ",") << values[i];
+			}
+			os << ']';
+		}
+
+		void AddPerOrder(std::vector<std::uint64_t>& dst, const std::vector<std::uint64_t>& src)
+		{
+			if (dst.size() < src.size()) {
+				dst.resize(src.size(), 0);
+			}
+			for (std::size_t i = 0; i < src.size(); ++i) {
+				dst[i] += src[i];
+			}
+		}
+	}
+
+	std::string BuddyPoolStats::ToJson() const
+	{
+		std::ostringstream os;
+		os << "{\"poolSize\":" << m_PoolSize
+			<< ",\"requestedBytes\":" << m_RequestedBytes
+			<< ",\"reservedBytes\":" << m_ReservedBytes
+			<< ",\"largestFreeBlock\":" << m_LargestFreeBlock
+			<< ",\"liveAllocations\":" << m_LiveAllocations
+			<< ",\"freeBytesPerOrder\":";
+		WriteJsonArray(os, m_FreeBytesPerOrder);
+		os << '}';
+		return os.str();
+	}
+
+	void AllocatorStats::AddPool(const BuddyPoolStats& pool)
+	{
+		m_RequestedBytes += pool.m_RequestedBytes;
+		m_ReservedBytes += pool.m_ReservedBytes;
+		m_InternalWaste = m_ReservedBytes - m_RequestedBytes;
+		m_PoolBytes += pool.m_PoolSize;
+		m_PoolCount += 1;
+		m_LargestFreeBlock = (std::max)(m_LargestFreeBlock, pool.m_LargestFreeBlock);
+		m_LiveAllocations += pool.m_LiveAllocations;
+		AddPerOrder(m_FreeBytesPerOrder, pool.m_FreeBytesPerOrder);
+		m_Pools.push_back(pool);
+	}
+
+	void AllocatorStats::Merge(const AllocatorStats& other)
+	{
+		m_RequestedBytes += other.m_RequestedBytes;
+		m_ReservedBytes += other.m_ReservedBytes;
+		m_InternalWaste = m_ReservedBytes - m_RequestedBytes;
+		m_PoolBytes += other.m_PoolBytes;
+		m_PoolCount += other.m_PoolCount;
+		m_LargestFreeBlock = (std::max)(m_LargestFreeBlock, other.m_LargestFreeBlock);
+		// 各分配器的峰值不一定同时出现，取最大值与合并后的当前占用作为峰值的下界
+		m_HighWaterMark = (std::max)({ m_HighWaterMark, other.m_HighWaterMark, m_ReservedBytes });
+		m_LiveAllocations += other.m_LiveAllocations;
+		m_TotalAllocations += other.m_TotalAllocations;
+		m_TotalFrees += other.m_TotalFrees;
+		m_AllocationRate += other.m_AllocationRate;
+		m_FreeRate += other.m_FreeRate;
+		AddPerOrder(m_FreeBytesPerOrder, other.m_FreeBytesPerOrder);
+		m_Pools.insert(m_Pools.end(), other.m_Pools.begin(), other.m_Pools.end());
+	}
+
+	void AllocatorStats::ComputeRates(const AllocatorStats& previous, double elapsedSeconds)
+	{
+		if (elapsedSeconds <= 0) return;
+
+		auto delta = [](std::uint64_t curr, std::uint64_t prev) {
+			return curr >= prev ? static_cast<double>(curr - prev) : 0.0;
+			};
+		m_AllocationRate = delta(m_TotalAllocations, previous.m_TotalAllocations) / elapsedSeconds;
+		m_FreeRate = delta(m_TotalFrees, previous.m_TotalFrees) / elapsedSeconds;
+	}
+
+	double AllocatorStats::GetFragmentation() const noexcept
+	{
+		// 最大空闲块与空闲大小都按单个分配器计算后再累加，避免混用不同范围的统计
+		std::uint64_t freeBytes = 0;
+		std::uint64_t largestFreeBytes = 0;
+		for (const auto& pool : m_Pools) {
+			std::uint64_t poolFree = 0;
+			for (auto bytes : pool.m_FreeBytesPerOrder) {
+				poolFree += bytes;
+			}
+			if (pool.m_FreeBytesPerOrder.empty() && pool.m_PoolSize > pool.m_ReservedBytes) {
+				poolFree = pool.m_PoolSize - pool.m_ReservedBytes;
+			}
+			freeBytes += poolFree;
+			largestFreeBytes += (std::min)(pool.m_LargestFreeBlock, poolFree);
+		}
+		if (freeBytes == 0) return 0;
+		return 1.0 - static_cast<double>(largestFreeBytes) / static_cast<double>(freeBytes);
+	}
+
+	std::string AllocatorStats::ToJson() const
+	{
+		std::ostringstream os;
+		os << "{\"name\":";
+		WriteJsonString(os, m_Name);
+		os << ",\"requestedBytes\":" << m_RequestedBytes
+			<< ",\"reservedBytes\":" << m_ReservedBytes
+			<< ",\"internalWaste\":" << m_InternalWaste
+			<< ",\"poolBytes\":" << m_PoolBytes
+			<< ",\"poolCount\":" << m_PoolCount
+			<< ",\"largestFreeBlock\":" << m_LargestFreeBlock
+			<< ",\"highWaterMark\":" << m_HighWaterMark
+			<< ",\"fragmentation\":" << GetFragmentation()
+			<< ",\"liveAllocations\":" << m_LiveAllocations
+			<< ",\"totalAllocations\":" << m_TotalAllocations
+			<< ",\"totalFrees\":" << m_TotalFrees
+			<< ",\"allocationRate\":" << m_AllocationRate
+			<< ",\"freeRate\":" << m_FreeRate
+			<< ",\"freeBytesPerOrder\":";
+		WriteJsonArray(os, m_FreeBytesPerOrder);
+		os << ",\"pools\":[";
+		for (std::size_t i = 0; i < m_Pools.size(); ++i) {
+			os << (i == 0 ? "" : ",") << m_Pools[i].ToJson();
+		}
+		os << "]}";
+		return os.str();
+	}
+
+	std::string AllocatorStatsToJson(const std::vector<AllocatorStats>& stats)
+	{
+		std::ostringstream os;
+		os << "{\"allocators\":[";
+		for (std::size_t i = 0; i < stats.size(); ++i) {
+			os << (i == 0 ? "" : ",") << stats[i].ToJson();
+		}
+		os << "]}";
+		return os.str();
+	}
+}
@@ -0,0 +1,60 @@
+#pragma once
+#ifndef __ALLOCATORSTATS__H__
+#define __ALLOCATORSTATS__H__
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace DSM {
+	// 单个 Buddy 分配器的统计信息
+	struct BuddyPoolStats
+	{
+		std::uint64_t m_PoolSize = 0;
+		std::uint64_t m_RequestedBytes = 0;         // 调用者请求的大小
+		std::uint64_t m_ReservedBytes = 0;          // 实际占用的块的大小
+		std::uint64_t m_LargestFreeBlock = 0;
+		std::uint64_t m_LiveAllocations = 0;
+		std::vector<std::uint64_t> m_FreeBytesPerOrder;
+
+		std::string ToJson() const;
+	};
+
+	// 一类分配器的统计信息
+	struct AllocatorStats
+	{
+		std::string m_Name;
+
+		std::uint64_t m_RequestedBytes = 0;         // 调用者请求的大小
+		std::uint64_t m_ReservedBytes = 0;          // 实际占用的块的大小
+		std::uint64_t m_InternalWaste = 0;          // 2 的幂取整浪费的大小
+		std::uint64_t m_PoolBytes = 0;              // 所有分配器的总大小
+		std::uint32_t m_PoolCount = 0;
+		std::uint64_t m_LargestFreeBlock = 0;
+		std::uint64_t m_HighWaterMark = 0;          // 占用大小的峰值
+
+		std::uint64_t m_LiveAllocations = 0;
+		std::uint64_t m_TotalAllocations = 0;       // 累计分配次数
+		std::uint64_t m_TotalFrees = 0;             // 累计释放次数
+		double m_AllocationRate = 0;                // 每秒分配次数
+		double m_FreeRate = 0;                      // 每秒释放次数
+
+		std::vector<std::uint64_t> m_FreeBytesPerOrder;
+		std::vector<BuddyPoolStats> m_Pools;
+
+		// 加入一个分配器的统计
+		void AddPool(const BuddyPoolStats& pool);
+		// 合并同类分配器的统计，例如每个帧资源中的分配器
+		void Merge(const AllocatorStats& other);
+		// 根据上一次的采样计算速率
+		void ComputeRates(const AllocatorStats& previous, double elapsedSeconds);
+		// 每个分配器中不属于最大空闲块的空闲内存所占的比例，0 表示没有碎片
+		double GetFragmentation() const noexcept;
+
+		std::string ToJson() const;
+	};
+
+	std::string AllocatorStatsToJson(const std::vector<AllocatorStats>& stats);
+}
+
+#endif
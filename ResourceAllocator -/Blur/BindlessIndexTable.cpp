@@ -0,0 +1,45 @@
+#include "BindlessIndexTable.h"
+#include <cassert>
+
+namespace DSM {
+	BindlessIndexTable::BindlessIndexTable(std::uint32_t capacity, const IFence* fence)
+		:m_Allocator(capacity), m_Fence(fence) {
+		assert(m_Fence != nullptr);
+	}
+
+	std::uint32_t BindlessIndexTable::Allocate()
+	{
+		return m_Allocator.Allocate(1);
+	}
+
+	std::uint32_t BindlessIndexTable::Reallocate(std::uint32_t oldIndex)
+	{
+		auto index = m_Allocator.Allocate(1);
+		if (index != InvalidIndex && oldIndex != InvalidIndex) {
+			m_RetiredIndices.Push(m_Fence->GetCurrentValue(), oldIndex);
+		}
+		return index;
+	}
+
+	void BindlessIndexTable::ClearUp()
+	{
+		m_RetiredIndices.Retire(m_Fence->GetCompletedValue(), [this](std::uint32_t index) {
+			m_Allocator.Free(index);
+			});
+	}
+
+	std::uint32_t BindlessIndexTable::GetCapacity() const noexcept
+	{
+		return m_Allocator.GetCapacity();
+	}
+
+	std::uint32_t BindlessIndexTable::GetUsedCount() const noexcept
+	{
+		return m_Allocator.GetUsedCount();
+	}
+
+	std::size_t BindlessIndexTable::GetRetiredCount() const noexcept
+	{
+		return m_RetiredIndices.Size();
+	}
+}
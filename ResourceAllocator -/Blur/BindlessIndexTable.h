@@ -0,0 +1,39 @@
+#pragma once
+#ifndef __BINDLESSINDEXTABLE__H__
+#define __BINDLESSINDEXTABLE__H__
+
+#include "DeferredDeletionQueue.h"
+#include "DescriptorRangeAllocator.h"
+#include "Fence.h"
+
+namespace DSM {
+	// 无绑定描述符索引的分配与回收，不依赖 D3D12 设备
+	// 执行中的帧可能仍在通过旧的索引读取，因此替换下来的索引等到当前帧的围栏完成后才能复用
+	class BindlessIndexTable
+	{
+	public:
+		static constexpr std::uint32_t InvalidIndex = DescriptorRangeAllocator::InvalidOffset;
+
+		BindlessIndexTable(std::uint32_t capacity, const IFence* fence);
+
+		// 分配新的索引，索引用完时返回 InvalidIndex
+		std::uint32_t Allocate();
+		// 为资源分配新的索引，成功时旧的索引在当前帧的围栏完成后回收
+		// 索引用完时返回 InvalidIndex，旧的索引保持不变
+		std::uint32_t Reallocate(std::uint32_t oldIndex);
+		// 回收围栏已完成的索引
+		void ClearUp();
+
+		std::uint32_t GetCapacity() const noexcept;
+		// 包括等待围栏的索引
+		std::uint32_t GetUsedCount() const noexcept;
+		std::size_t GetRetiredCount() const noexcept;
+
+	private:
+		DescriptorRangeAllocator m_Allocator;
+		DeferredDeletionQueue<std::uint32_t> m_RetiredIndices;
+		const IFence* m_Fence = nullptr;
+	};
+}
+
+#endif
@@ -6,6 +6,7 @@
 #include "LightManager.h"
 #include "TextureManager.h"
 #include "Material.h"
+#include <algorithm>
 
 using namespace DirectX;
 using namespace DSM::Geometry;
@@ -25,10 +26,12 @@ namespace DSM {
 
 		ThrowIfFailed(m_CommandList->Reset(m_DirectCmdListAlloc.Get(), nullptr));
 
+		m_FrameFence = std::make_unique<D3D12Fence>(m_D3D12Fence.Get(), &m_CurrentFence);
+
 		LightManager::Create();
 		ObjectManager::Create();
 		ModelManager::Create(m_D3D12Device.Get());
-		TextureManager::Create(m_D3D12Device.Get(), m_CommandList.Get());
+		TextureManager::Create(m_D3D12Device.Get(), m_CommandList.Get(), m_FrameFence.get());
 		ImguiManager::Create();
 		if (!ImguiManager::GetInstance().InitImGui(
 			m_D3D12Device.Get(),
@@ -38,6 +41,15 @@ namespace DSM {
 			return false;
 		}
 
+		// 调试时监视工程中的着色器源文件，修改后在后台重新编译
+#if defined(DEBUG) || defined(_DEBUG)
+#ifdef DSM_SHADER_SOURCE_DIR
+		ShaderHelper::GetHotReload().Enable(DSM_SHADER_SOURCE_DIR);
+#else
+		ShaderHelper::GetHotReload().Enable();
+#endif
+#endif
+
 		if (!InitResource()) {
 			return false;
 		}
@@ -60,97 +72,180 @@ namespace DSM {
 			WaitForGPU();
 		}
 
+		// 回收 GPU 已经不再使用的资源
+		m_CurrFrameResource->ClearUp();
+		m_UploadRingBuffer->ClearUpAllocations();
+		m_DescriptorRing->ClearUpAllocations();
+		m_TextureAllocator->ClearUpAllocations();
+		m_RenderTargetAllocator->ClearUpAllocations();
+		TextureManager::GetInstance().ClearUpAllocations();
+
+		// 在录制命令前交换已经编译完成的着色器
+		auto& hotReload = ShaderHelper::GetHotReload();
+		hotReload.Update();
+		ImguiManager::GetInstance().m_ShaderReloadStats = hotReload.GetStats();
+
 		// Update
+		UpdateAllocatorStats(timer);
 		ImguiManager::GetInstance().Update(timer);
 		UpdatePassCB(timer);
 		UpdateShadowCB(timer);
+		ImguiManager::GetInstance().m_TransformUpdateCount = ObjectManager::GetInstance().GetObjectStore().UpdateWorldMatrices();
+		UpdateCulling();
 		UpdateLightCB(timer);
 		m_CameraController->Update(timer.DeltaTime());
 	}
 
 	void BlurAPP::OnRender(const CpuTimer& timer)
 	{
-		auto& lightManager = LightManager::GetInstance();
 		auto& imgui = ImguiManager::GetInstance();
 
-
 		auto& cmdListAlloc = m_CurrFrameResource->m_CmdListAlloc;
 		ThrowIfFailed(cmdListAlloc->Reset());
 		ThrowIfFailed(m_CommandList->Reset(cmdListAlloc.Get(), nullptr));
+		// 命令列表重置后所有状态都需要重新设置
+		m_CurrFrameResource->BeginRecording();
+		m_CurrFrameResource->m_CommandListState.Reset(m_CommandList.Get());
 
-		RenderShadow();
-
-		auto viewPort = m_Camera->GetViewPort();
-		m_CommandList->RSSetViewports(1, &viewPort);
-		m_CommandList->RSSetScissorRects(1, &m_ScissorRect);
+		TextureManager::GetInstance().Defragment(m_CommandList.Get());
 
-		D3D12_RESOURCE_BARRIER presentToRt{};
-		presentToRt.Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
-		presentToRt.Flags = D3D12_RESOURCE_BARRIER_FLAG_NONE;
-		presentToRt.Transition = {
-			GetCurrentBackBuffer(),
-			D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES,
-			D3D12_RESOURCE_STATE_PRESENT,
-			D3D12_RESOURCE_STATE_RENDER_TARGET
-		};
-		m_CommandList->ResourceBarrier(1, &presentToRt);
-
-		auto currBackBV = GetCurrentBackBufferView();
-		auto dsv = GetDepthStencilView();
-		m_CommandList->ClearRenderTargetView(currBackBV, Colors::Pink, 0, nullptr);
-		m_CommandList->ClearDepthStencilView(dsv, D3D12_CLEAR_FLAG_DEPTH | D3D12_CLEAR_FLAG_STENCIL, 1, 0, 0, nullptr);
-		m_CommandList->OMSetRenderTargets(1, &currBackBV, true, &dsv);
-
-
-		RenderScene(RenderLayer::Opaque);
+		if (imgui.m_EnableParallelRecord && !m_RecordWorkers.empty()) {
+			RenderFrameParallel();
+		}
+		else {
+			RenderFrame();
+		}
 
-		m_BlurShader->SetInputTexture(GetCurrentBackBuffer());
-		m_BlurShader->SetBlurCount(imgui.m_BlurCount);
-		m_BlurShader->Apply(m_CommandList.Get(), m_CurrFrameResource);
-		
-		D3D12_RESOURCE_BARRIER sourceToDest{};
-		sourceToDest.Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
-		sourceToDest.Transition = {
-			GetCurrentBackBuffer(),
-			D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES,
-			D3D12_RESOURCE_STATE_COPY_SOURCE,
-			D3D12_RESOURCE_STATE_COPY_DEST
-		};
+		// 统计每帧跳过的冗余状态设置与常量缓冲区的上传量
+		imgui.m_CommandListStats = m_CurrFrameResource->m_CommandListState.GetStats();
+		m_CurrFrameResource->m_CommandListState.ResetStats();
+		imgui.m_ConstantBufferUploadBytes = m_CurrFrameResource->m_ConstantBufferUploadBytes;
+		for (auto& worker : m_CurrFrameResource->m_Workers) {
+			imgui.m_CommandListStats.Merge(worker->m_CommandListState.GetStats());
+			worker->m_CommandListState.ResetStats();
+			imgui.m_ConstantBufferUploadBytes += worker->m_ConstantBufferUploadBytes;
+			worker->m_ConstantBufferUploadBytes = 0;
+		}
 
-		// 将结果拷贝到后台缓冲区中
-		m_CommandList->CopyResource(GetCurrentBackBuffer(), m_BlurShader->GetOutputTexture());
+		ThrowIfFailed(m_DxgiSwapChain->Present(0, 0));
 
-		auto destToRT = sourceToDest;
-		destToRT.Transition.StateBefore = D3D12_RESOURCE_STATE_COPY_DEST;
-		destToRT.Transition.StateAfter = D3D12_RESOURCE_STATE_RENDER_TARGET;
+		// 环形缓冲区记录的是即将发出的围栏值
+		m_UploadRingBuffer->FinishFrame();
+		m_DescriptorRing->FinishFrame();
+		m_CurrFrameResource->m_Fence = ++m_CurrentFence;
+		m_CurrBackBuffer = (m_CurrBackBuffer + 1) % SwapChainBufferCount;
+		ThrowIfFailed(m_CommandQueue->Signal(m_D3D12Fence.Get(), m_CurrentFence));
+	}
 
-		ImguiManager::GetInstance().RenderImGui(m_CommandList.Get());
+	void BlurAPP::RenderFrame()
+	{
+		BeginShadowPass(m_CommandList.Get());
+		BindShaderConstants();
+		RecordShadowDraws(m_CommandList.Get(), *m_ShadowShader, m_CurrFrameResource, m_ShadowDrawItems);
+		EndShadowPass(m_CommandList.Get());
 
-		D3D12_RESOURCE_BARRIER rtToPresent{};
-		rtToPresent.Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
-		rtToPresent.Flags = D3D12_RESOURCE_BARRIER_FLAG_NONE;
-		rtToPresent.Transition = {
-			GetCurrentBackBuffer(),
-			D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES,
-			D3D12_RESOURCE_STATE_RENDER_TARGET,
-			D3D12_RESOURCE_STATE_PRESENT
-		};
-		m_CommandList->ResourceBarrier(1, &rtToPresent);
+		BeginScenePass(m_CommandList.Get());
+		RecordSceneDraws(m_CommandList.Get(), *m_LitShader, m_CurrFrameResource, m_SceneDrawItems);
 
-		
+		EndFrame(m_CommandList.Get());
 
 		ThrowIfFailed(m_CommandList->Close());
 		ID3D12CommandList* pCmdLists[] = { m_CommandList.Get() };
 		m_CommandQueue->ExecuteCommandLists(_countof(pCmdLists), pCmdLists);
+		ImguiManager::GetInstance().m_RecordCommandListCount = 1;
+	}
 
-		ThrowIfFailed(m_DxgiSwapChain->Present(0, 0));
+	void BlurAPP::RenderFrameParallel()
+	{
+		std::uint32_t passDrawCounts[RecordPassCount]{};
+		passDrawCounts[ShadowRecordPass] = static_cast<std::uint32_t>(m_ShadowDrawItems.size());
+		passDrawCounts[SceneRecordPass] = static_cast<std::uint32_t>(m_SceneDrawItems.size());
+		auto workerCount = static_cast<std::uint32_t>(m_RecordWorkers.size());
+		m_RecordPlan.Build(passDrawCounts, workerCount, MinDrawsPerRecordTask);
+		m_TaskCommandLists.assign(m_RecordPlan.GetTasks().size(), nullptr);
+
+		// 变体的合并与管线状态的创建不是线程安全的，在分发前完成
+		for (auto& worker : m_RecordWorkers) {
+			worker.m_LitShader->PrepareForRecording();
+		}
+		// 每个槽位作为一个任务，无论由哪个线程执行，槽位的命令分配器同时只被一个线程使用
+		auto& jobSystem = JobSystem::GetDefault();
+		JobCounter recordCounter;
+		for (std::uint32_t workerIndex = 0; workerIndex < workerCount; ++workerIndex) {
+			if (m_RecordPlan.GetWorkerTasks(workerIndex).empty()) continue;
+			jobSystem.Run([this, workerIndex]() {
+				RecordWorkerTasks(workerIndex);
+				}, recordCounter);
+		}
 
-		m_CurrFrameResource->m_Fence = ++m_CurrentFence;
-		m_CurrBackBuffer = (m_CurrBackBuffer + 1) % SwapChainBufferCount;
-		ThrowIfFailed(m_CommandQueue->Signal(m_D3D12Fence.Get(), m_CurrentFence));
+		// 任务系统录制绘制的同时，主线程录制各通道之间的屏障、清除与后处理
+		// 主命令列表 0 为 m_CommandList，其余使用当前帧资源的额外命令列表，共用同一个分配器
+		auto mainList = m_CommandList.Get();
+		BeginShadowPass(mainList);
+		ThrowIfFailed(mainList->Close());
+
+		mainList = m_CurrFrameResource->GetCommandList(0);
+		ThrowIfFailed(mainList->Reset(m_CurrFrameResource->m_CmdListAlloc.Get(), nullptr));
+		EndShadowPass(mainList);
+		BeginScenePass(mainList);
+		ThrowIfFailed(mainList->Close());
+
+		mainList = m_CurrFrameResource->GetCommandList(1);
+		ThrowIfFailed(mainList->Reset(m_CurrFrameResource->m_CmdListAlloc.Get(), nullptr));
+		EndFrame(mainList);
+		ThrowIfFailed(mainList->Close());
+
+		// 等待期间主线程也会录制尚未开始的槽位
+		jobSystem.Wait(recordCounter);
+
+		// 按通道顺序一次提交所有命令列表
+		auto& cmdLists = m_SubmitCommandLists;
+		cmdLists.clear();
+		for (const auto& entry : m_RecordPlan.GetSubmitOrder()) {
+			if (entry.m_Type == RecordSubmitEntry::Type::Task) {
+				cmdLists.push_back(m_TaskCommandLists[entry.m_Index]);
+			}
+			else if (entry.m_Index == 0) {
+				cmdLists.push_back(m_CommandList.Get());
+			}
+			else {
+				cmdLists.push_back(m_CurrFrameResource->GetCommandList(entry.m_Index - 1));
+			}
+		}
+		m_CommandQueue->ExecuteCommandLists(static_cast<UINT>(cmdLists.size()), cmdLists.data());
+		ImguiManager::GetInstance().m_RecordCommandListCount = static_cast<std::uint32_t>(cmdLists.size());
+	}
 
-		for (auto& frameResource : m_FrameResources) {
-			frameResource->ClearUp(m_CurrentFence);
+	void BlurAPP::RecordWorkerTasks(std::uint32_t workerIndex)
+	{
+		auto frameResource = m_CurrFrameResource->m_Workers[workerIndex].get();
+		auto& worker = m_RecordWorkers[workerIndex];
+
+		// 帧资源的围栏已在 OnUpdate 中等待，分配器中的命令已经执行完毕
+		ThrowIfFailed(frameResource->m_CmdListAlloc->Reset());
+		frameResource->BeginRecording();
+
+		auto tasks = m_RecordPlan.GetTasks();
+		auto workerTasks = m_RecordPlan.GetWorkerTasks(workerIndex);
+		for (std::uint32_t i = 0; i < workerTasks.size(); ++i) {
+			const auto& task = tasks[workerTasks[i]];
+			auto cmdList = frameResource->GetCommandList(i);
+			ThrowIfFailed(cmdList->Reset(frameResource->m_CmdListAlloc.Get(), nullptr));
+
+			// 命令列表之间不继承状态，每个任务都需要重新设置渲染目标
+			if (task.m_Pass == ShadowRecordPass) {
+				SetShadowTarget(cmdList);
+				auto items = std::span{ m_ShadowDrawItems }.subspan(task.m_Begin, task.m_End - task.m_Begin);
+				RecordShadowDraws(cmdList, *worker.m_ShadowShader, frameResource, items);
+			}
+			else {
+				SetSceneTarget(cmdList);
+				auto items = std::span{ m_SceneDrawItems }.subspan(task.m_Begin, task.m_End - task.m_Begin);
+				RecordSceneDraws(cmdList, *worker.m_LitShader, frameResource, items);
+			}
+
+			ThrowIfFailed(cmdList->Close());
+			m_TaskCommandLists[workerTasks[i]] = cmdList;
 		}
 	}
 
@@ -163,6 +258,8 @@ namespace DSM {
 
 		if (m_BlurShader != nullptr) {
 			m_BlurShader->OnResize(m_ClientWidth, m_ClientHeight, m_TextureAllocator.get());
+			// 模糊纹理的描述符在原处重建
+			m_DescriptorAllocator->InvalidateCachedTables();
 		}
 	}
 
@@ -174,70 +271,46 @@ namespace DSM {
 		CloseHandle(eventHandle);
 	}
 
-	void BlurAPP::RenderScene(RenderLayer layer)
+	void BlurAPP::BindShaderConstants()
 	{
-		auto& objManager = ObjectManager::GetInstance();
-		auto& modelManager = ModelManager::GetInstance();
-		auto& texManager = TextureManager::GetInstance();
 		auto& lightManager = LightManager::GetInstance();
 
+		// 只有主线程的着色器使用帧资源中的常量缓冲区，录制槽位的着色器每帧写入临时内存
+		// 类型名只在第一次调用时计算哈希
+		static const ShaderPropertyID passCBID{ typeid(PassConstants).name() };
 		auto& constBuffers = m_CurrFrameResource->m_Resources;
-		m_LitShader->SetPassCB(constBuffers[typeid(PassConstants).name()]);
-		m_LitShader->SetLightCB(constBuffers[lightManager.GetLightBufferName()]);
-		m_CommandList->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
-
-		for (const auto& [name, obj] : objManager.GetAllObject()[(int)layer]) {
-			if (auto model = obj->GetModel(); model != nullptr) {
-				const auto& meshData = modelManager.GetMeshData<VertexPosNormalTex>(model->GetName());
-				auto vertexBV = meshData->GetVertexBufferView();
-				auto indexBV = meshData->GetIndexBufferView();
-				m_CommandList->IASetVertexBuffers(0, 1, &vertexBV);
-				m_CommandList->IASetIndexBuffer(&indexBV);
-
-				m_LitShader->SetObjectCB(constBuffers[name]);
-
-				auto getObjCB = [](const Object& obj, RenderLayer layer) {
-					ObjectConstants ret{};
-					auto world = obj.GetTransform().GetLocalToWorldMatrix();
-					XMStoreFloat4x4(&ret.m_World, XMMatrixTranspose(world));
-					XMStoreFloat4x4(&ret.m_WorldInvTranspose, MathHelper::InverseTransposeWithOutTranslate(world));
-					return ret; };
-				m_LitShader->SetObjectConstants(getObjCB(*obj, layer));
-
+		m_LitShader->SetPassCB(constBuffers[passCBID]);
+		m_LitShader->SetLightCB(constBuffers[lightManager.GetLightBufferID()]);
+		m_ShadowShader->SetPassCB(constBuffers["ShadowMap"]);
+	}
 
-				for (const auto& [itemName, drawItem] : meshData->m_DrawArgs) {
-					auto matIndex = model->GetMesh(itemName)->m_MaterialIndex;
-					const auto& mat = model->GetMaterial(matIndex);
-					auto matResource = constBuffers[name + "Mat" + std::to_string(matIndex)];
-					m_LitShader->SetMaterialCB(matResource);
-					m_LitShader->SetMaterialConstants(GetMaterialConstants(mat));
+	void BlurAPP::SetShadowTarget(ID3D12GraphicsCommandList* cmdList)
+	{
+		auto desc = m_ShadowMap->GetResource()->m_Resource->GetDesc();
+		D3D12_VIEWPORT viewport = { 0,0, (float)desc.Width, (float)desc.Height, 0.0f, 1.0f };
+		cmdList->RSSetViewports(1, &viewport);
+		cmdList->RSSetScissorRects(1, &m_ScissorRect);
+		cmdList->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
 
-					auto diffuseTex = mat.Get<std::string>("Diffuse");
-					std::string texName = diffuseTex == nullptr ? "" : *diffuseTex;
-					m_LitShader->SetTexture({ texManager.GetTextureResourceView(texName) });
-					m_LitShader->SetShadowMap(m_ShadowMap->m_SrvHandle);
+		auto handle = m_ShadowMap->m_DsvHandle;
+		cmdList->OMSetRenderTargets(0, nullptr, false, &handle);
+	}
 
-					m_LitShader->Apply(m_CommandList.Get(), m_CurrFrameResource);
+	void BlurAPP::SetSceneTarget(ID3D12GraphicsCommandList* cmdList)
+	{
+		auto viewPort = m_Camera->GetViewPort();
+		cmdList->RSSetViewports(1, &viewPort);
+		cmdList->RSSetScissorRects(1, &m_ScissorRect);
+		cmdList->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
 
-					m_CommandList->DrawIndexedInstanced(drawItem.m_IndexCount, 1, drawItem.m_StarIndexLocation, drawItem.m_BaseVertexLocation, 0);
-				}
-			}
-		}
+		auto currBackBV = GetCurrentBackBufferView();
+		auto dsv = GetDepthStencilView();
+		cmdList->OMSetRenderTargets(1, &currBackBV, true, &dsv);
 	}
 
-
-	void BlurAPP::RenderShadow()
+	void BlurAPP::BeginShadowPass(ID3D12GraphicsCommandList* cmdList)
 	{
-		auto& objManager = ObjectManager::GetInstance();
-		auto& modelManager = ModelManager::GetInstance();
-		auto& texManager = TextureManager::GetInstance();
-
 		auto& shadowResource = m_ShadowMap->GetResource()->m_Resource;
-		auto desc = shadowResource->GetDesc();
-		D3D12_VIEWPORT viewport = { 0,0, (float)desc.Width, (float)desc.Height, 0.0f, 1.0f };
-		m_CommandList->RSSetViewports(1, &viewport);
-		m_CommandList->RSSetScissorRects(1, &m_ScissorRect);
-		m_CommandList->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
 
 		D3D12_RESOURCE_BARRIER readToWrite{};
 		readToWrite.Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
@@ -248,64 +321,142 @@ namespace DSM {
 			D3D12_RESOURCE_STATE_GENERIC_READ,
 			D3D12_RESOURCE_STATE_DEPTH_WRITE
 		};
-		m_CommandList->ResourceBarrier(1, &readToWrite);
+		cmdList->ResourceBarrier(1, &readToWrite);
 
-		auto handle = m_ShadowMap->m_DsvHandle;
-		m_CommandList->ClearDepthStencilView(handle, D3D12_CLEAR_FLAG_DEPTH | D3D12_CLEAR_FLAG_STENCIL,
+		cmdList->ClearDepthStencilView(m_ShadowMap->m_DsvHandle, D3D12_CLEAR_FLAG_DEPTH | D3D12_CLEAR_FLAG_STENCIL,
 			1.0f, 0, 0, nullptr);
-		m_CommandList->OMSetRenderTargets(
-			0, nullptr, false, &handle);
+		SetShadowTarget(cmdList);
+	}
 
-		auto& constBuffers = m_CurrFrameResource->m_Resources;
-		m_ShadowShader->SetPassCB(constBuffers["ShadowMap"]);
+	void BlurAPP::EndShadowPass(ID3D12GraphicsCommandList* cmdList)
+	{
+		D3D12_RESOURCE_BARRIER writeToRead{};
+		writeToRead.Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
+		writeToRead.Flags = D3D12_RESOURCE_BARRIER_FLAG_NONE;
+		writeToRead.Transition = {
+			m_ShadowMap->GetResource()->m_Resource.Get(),
+			D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES,
+			D3D12_RESOURCE_STATE_DEPTH_WRITE,
+			D3D12_RESOURCE_STATE_GENERIC_READ
+		};
+		cmdList->ResourceBarrier(1, &writeToRead);
+	}
+
+	void BlurAPP::BeginScenePass(ID3D12GraphicsCommandList* cmdList)
+	{
+		D3D12_RESOURCE_BARRIER presentToRt{};
+		presentToRt.Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
+		presentToRt.Flags = D3D12_RESOURCE_BARRIER_FLAG_NONE;
+		presentToRt.Transition = {
+			GetCurrentBackBuffer(),
+			D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES,
+			D3D12_RESOURCE_STATE_PRESENT,
+			D3D12_RESOURCE_STATE_RENDER_TARGET
+		};
+		cmdList->ResourceBarrier(1, &presentToRt);
+
+		cmdList->ClearRenderTargetView(GetCurrentBackBufferView(), Colors::Pink, 0, nullptr);
+		cmdList->ClearDepthStencilView(GetDepthStencilView(), D3D12_CLEAR_FLAG_DEPTH | D3D12_CLEAR_FLAG_STENCIL, 1, 0, 0, nullptr);
+		SetSceneTarget(cmdList);
+	}
+
+	void BlurAPP::EndFrame(ID3D12GraphicsCommandList* cmdList)
+	{
+		auto& imgui = ImguiManager::GetInstance();
+
+		m_BlurShader->SetInputTexture(GetCurrentBackBuffer());
+		m_BlurShader->SetBlurCount(imgui.m_BlurCount);
+		m_BlurShader->Apply(cmdList, m_CurrFrameResource);
+
+		// 将结果拷贝到后台缓冲区中
+		cmdList->CopyResource(GetCurrentBackBuffer(), m_BlurShader->GetOutputTexture());
+
+		imgui.RenderImGui(cmdList);
+		// ImGui 会直接修改命令列表上的描述符堆与管线状态
+		m_CurrFrameResource->m_CommandListState.Reset(cmdList);
+
+		D3D12_RESOURCE_BARRIER rtToPresent{};
+		rtToPresent.Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
+		rtToPresent.Flags = D3D12_RESOURCE_BARRIER_FLAG_NONE;
+		rtToPresent.Transition = {
+			GetCurrentBackBuffer(),
+			D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES,
+			D3D12_RESOURCE_STATE_RENDER_TARGET,
+			D3D12_RESOURCE_STATE_PRESENT
+		};
+		cmdList->ResourceBarrier(1, &rtToPresent);
+	}
 
-		for (const auto& [name, obj] : objManager.GetAllObject()[(int)RenderLayer::Opaque]) {
-			if (auto model = obj->GetModel(); model != nullptr) {
-				const auto& meshData = modelManager.GetMeshData<VertexPosNormalTex>(model->GetName());
+	void BlurAPP::RecordSceneDraws(
+		ID3D12GraphicsCommandList* cmdList,
+		LitShader& shader,
+		FrameResource* frameResource,
+		std::span<const std::uint32_t> items)
+	{
+		shader.SetShadowMap(m_ShadowMap->m_SrvHandle);
+
+		auto currObject = ObjectHandle::InvalidIndex;
+		for (auto index : items) {
+			const auto& item = m_CullingItems[index];
+
+			// 同一物体的子网格相邻，物体改变时才设置顶点缓冲区与物体常量
+			if (item.m_ObjectIndex != currObject) {
+				currObject = item.m_ObjectIndex;
+				const auto& meshData = item.m_Model->m_MeshData;
 				auto vertexBV = meshData->GetVertexBufferView();
 				auto indexBV = meshData->GetIndexBufferView();
-				m_CommandList->IASetVertexBuffers(0, 1, &vertexBV);
-				m_CommandList->IASetIndexBuffer(&indexBV);
+				cmdList->IASetVertexBuffers(0, 1, &vertexBV);
+				cmdList->IASetIndexBuffer(&indexBV);
+				shader.SetObjectConstants(GetObjectConstants(currObject));
+			}
 
-				m_ShadowShader->SetObjectCB(constBuffers[name]);
+			const auto& material = m_MaterialDraws[item.m_Submesh->m_MaterialIndex];
+			shader.SetMaterialConstants(material.GetConstants());
 
-				auto getObjCB = [](const Object& obj, RenderLayer layer) {
-					ObjectConstants ret{};
-					auto world = obj.GetTransform().GetLocalToWorldMatrix();
-					XMStoreFloat4x4(&ret.m_World, XMMatrixTranspose(world));
-					XMStoreFloat4x4(&ret.m_WorldInvTranspose, MathHelper::InverseTransposeWithOutTranslate(world));
-					return ret; };
-				m_ShadowShader->SetObjectConstants(getObjCB(*obj, RenderLayer::Opaque));
+			if (!shader.IsBindless()) {
+				shader.SetTexture({ material.m_DiffuseTexture->GetSRV() });
+			}
 
+			shader.Apply(cmdList, frameResource);
 
-				for (const auto& [itemName, drawItem] : meshData->m_DrawArgs) {
-					auto matIndex = model->GetMesh(itemName)->m_MaterialIndex;
-					const auto& mat = model->GetMaterial(matIndex);
-					auto matResource = constBuffers[name + "Mat" + std::to_string(matIndex)];
-					m_ShadowShader->SetMaterialCB(matResource);
-					m_ShadowShader->SetMaterialConstants(GetMaterialConstants(mat));
+			const auto& drawItem = *item.m_Submesh->m_Submesh;
+			cmdList->DrawIndexedInstanced(drawItem.m_IndexCount, 1, drawItem.m_StarIndexLocation, drawItem.m_BaseVertexLocation, 0);
+		}
+	}
 
-					auto diffuseTex = mat.Get<std::string>("Diffuse");
-					std::string texName = diffuseTex == nullptr ? "" : *diffuseTex;
-					m_ShadowShader->SetTexture(texManager.GetTextureResourceView(texName));
 
-					m_ShadowShader->Apply(m_CommandList.Get(), m_CurrFrameResource);
+	void BlurAPP::RecordShadowDraws(
+		ID3D12GraphicsCommandList* cmdList,
+		ShadowShader& shader,
+		FrameResource* frameResource,
+		std::span<const std::uint32_t> items)
+	{
+		auto currObject = ObjectHandle::InvalidIndex;
+		for (auto index : items) {
+			const auto& item = m_CullingItems[index];
 
-					m_CommandList->DrawIndexedInstanced(drawItem.m_IndexCount, 1, drawItem.m_StarIndexLocation, drawItem.m_BaseVertexLocation, 0);
-				}
+			if (item.m_ObjectIndex != currObject) {
+				currObject = item.m_ObjectIndex;
+				const auto& meshData = item.m_Model->m_MeshData;
+				auto vertexBV = meshData->GetVertexBufferView();
+				auto indexBV = meshData->GetIndexBufferView();
+				cmdList->IASetVertexBuffers(0, 1, &vertexBV);
+				cmdList->IASetIndexBuffer(&indexBV);
+				shader.SetObjectConstants(GetObjectConstants(currObject));
 			}
-		}
 
-		D3D12_RESOURCE_BARRIER writeToRead{};
-		writeToRead.Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
-		writeToRead.Flags = D3D12_RESOURCE_BARRIER_FLAG_NONE;
-		writeToRead.Transition = {
-			shadowResource.Get(),
-			D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES,
-			D3D12_RESOURCE_STATE_DEPTH_WRITE,
-			D3D12_RESOURCE_STATE_GENERIC_READ
-		};
-		m_CommandList->ResourceBarrier(1, &writeToRead);
+			const auto& material = m_MaterialDraws[item.m_Submesh->m_MaterialIndex];
+			shader.SetMaterialConstants(material.GetConstants());
+
+			if (!shader.IsBindless()) {
+				shader.SetTexture(material.m_DiffuseTexture->GetSRV());
+			}
+
+			shader.Apply(cmdList, frameResource);
+
+			const auto& drawItem = *item.m_Submesh->m_Submesh;
+			cmdList->DrawIndexedInstanced(drawItem.m_IndexCount, 1, drawItem.m_StarIndexLocation, drawItem.m_BaseVertexLocation, 0);
+		}
 	}
 
 
@@ -315,32 +466,45 @@ namespace DSM {
 
 		m_ShadowMap = std::make_unique<DepthBuffer>();
 		
-		m_RenderTargetAllocator = std::make_unique<D3D12RenderTargetAllocator>(m_D3D12Device.Get());
-		m_TextureAllocator = std::make_unique<D3D12TextureAllocator>(m_D3D12Device.Get());
+		m_RenderTargetAllocator = std::make_unique<D3D12RenderTargetAllocator>(m_D3D12Device.Get(), m_FrameFence.get());
+		m_TextureAllocator = std::make_unique<D3D12TextureAllocator>(m_D3D12Device.Get(), m_FrameFence.get());
+		m_UploadRingBuffer = std::make_unique<D3D12UploadRingBuffer>(m_D3D12Device.Get(), m_FrameFence.get());
+		m_DescriptorRing = std::make_unique<D3D12DescriptorRing>(
+			m_D3D12Device.Get(),
+			m_FrameFence.get(),
+			D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV,
+			D3D12DescriptorRing::DefaultRingSize,
+			EnableBindless ? TextureManager::MaxBindlessTextures : 0);
+		if constexpr (EnableBindless) {
+			TextureManager::GetInstance().SetBindlessTable(m_DescriptorRing.get());
+		}
 
 		m_Camera->SetViewPort(0.0f, 0.0f, (float)m_ClientWidth, (float)m_ClientHeight);
 		m_Camera->SetFrustum(XM_PI / 3, GetAspectRatio(), 0.5f, 300.0f);
 		m_Camera->LookAt({4, 10, -4}, {0,0,0}, {0,1,0});
 		m_CameraController->InitCamera(m_Camera.get());
 		
-		m_ShaderDescriptorHeap = std::make_unique<D3D12DescriptorCache>(m_D3D12Device.Get());
+		m_DescriptorAllocator = std::make_unique<D3D12DescriptorAllocator>(m_D3D12Device.Get());
+		m_DescriptorAllocator->AddDescriptorRing(m_DescriptorRing.get());
+		TextureManager::GetInstance().AddDescriptorRing(m_DescriptorRing.get());
 
 		m_SceneSphere.Center = XMFLOAT3(0.0f, 0.0f, 0.0f);
 		m_SceneSphere.Radius = std::sqrt(50 * 50 + 40 * 40);
 
-		m_LitShader = std::make_unique<LitShader>(m_D3D12Device.Get());
-		m_ShadowShader = std::make_unique<ShadowShader>(m_D3D12Device.Get());
+		m_LitShader = std::make_unique<LitShader>(m_D3D12Device.Get(), 3, 1, 1, EnableBindless);
+		m_ShadowShader = std::make_unique<ShadowShader>(m_D3D12Device.Get(), EnableBindless);
 
 
 		CreateObject();
 		CreateTexture();
+		CreateDrawData();
 		CreateFrameResource();
 		m_BlurShader = std::make_unique<BlurShader>(
 			m_D3D12Device.Get(), m_ClientWidth, m_ClientHeight,
 			m_BackBufferFormat, m_TextureAllocator.get(),
 			m_FrameResources[0]->m_Resources["BlurCB"]);
 		CreateDescriptor();
-		
+		CreateRecordWorkers();
 
 		return true;
 	}
@@ -355,13 +519,11 @@ namespace DSM {
 			"Elena",
 			"Models\\Elena.obj",
 			m_CommandList.Get());
-		auto elena = std::make_shared<Object>(elenaModel->GetName(), elenaModel);
-		objManager.AddObject(elena, RenderLayer::Opaque);
+		objManager.AddObject(elenaModel->GetName(), elenaModel, RenderLayer::Opaque);
 
 		const Model* planeModel = modelManager.LoadModelFromeGeometry(
 			"Plane", GeometryGenerator::CreateGrid(80, 80, 2, 2));
-		auto plane = std::make_shared<Object>(planeModel->GetName(), planeModel);
-		objManager.AddObject(plane, RenderLayer::Opaque);
+		objManager.AddObject(planeModel->GetName(), planeModel, RenderLayer::Opaque);
 
 		auto vertFunc0 = [](const Vertex& vert) {
 			VertexPosNormalTex ret{};
@@ -408,23 +570,73 @@ namespace DSM {
 		setTexture("Mirror", "Textures\\ice.dds", m_CommandList.Get());
 	}
 
+	void BlurAPP::CreateDrawData()
+	{
+		auto& modelManager = ModelManager::GetInstance();
+		auto& texManager = TextureManager::GetInstance();
+
+		m_ModelDraws.clear();
+		m_MaterialDraws.clear();
+		m_ModelDrawIndices.clear();
+		for (const auto& [modelName, model] : modelManager.GetAllModel()) {
+			const auto meshData = modelManager.GetMeshData<VertexPosNormalTex>(modelName);
+			if (meshData == nullptr) continue;
+
+			// 模型的材质连续存放，子网格的材质下标加上模型的起始位置
+			auto firstMaterial = static_cast<std::uint32_t>(m_MaterialDraws.size());
+			for (std::size_t i = 0; i < model.GetMaterialSize(); ++i) {
+				const auto& material = model.GetMaterial(i);
+				auto diffuseTex = material.Get<std::string>("Diffuse");
+				m_MaterialDraws.push_back({ GetMaterialConstants(material),
+					texManager.GetTexture(diffuseTex == nullptr ? "" : *diffuseTex) });
+			}
+
+			ModelDraw modelDraw{};
+			modelDraw.m_MeshData = meshData;
+			for (const auto& [itemName, drawItem] : meshData->m_DrawArgs) {
+				modelDraw.m_Submeshes.push_back({ &drawItem, firstMaterial + model.GetMesh(itemName)->m_MaterialIndex });
+			}
+			m_ModelDrawIndices[&model] = static_cast<std::uint32_t>(m_ModelDraws.size());
+			m_ModelDraws.push_back(std::move(modelDraw));
+		}
+	}
+
 	void BlurAPP::CreateFrameResource()
 	{
-		auto& objManager = ObjectManager::GetInstance();
 		auto& lightManager = LightManager::GetInstance();
 
 		for (auto& resource : m_FrameResources) {
-			resource = std::make_unique<FrameResource>(m_D3D12Device.Get());
+			// 物体与材质的常量缓冲区每次绘制时从环形缓冲区中分配
+			resource = std::make_unique<FrameResource>(
+				m_D3D12Device.Get(), m_FrameFence.get(),
+				m_UploadRingBuffer.get(), m_DescriptorRing.get());
 			
 			resource->AddConstantBuffer(sizeof(PassConstants), 1, typeid(PassConstants).name());
 			resource->AddConstantBuffer(lightManager.GetLightByteSize(), 1, lightManager.GetLightBufferName());
-			objManager.CreateObjectsResource(resource.get(), sizeof(ObjectConstants), sizeof(MaterialConstants));
 			resource->AddConstantBuffer(sizeof(float), 1, "CylinderHeight");
 			resource->AddConstantBuffer(sizeof(PassConstants), 1, "ShadowMap");
 			resource->AddConstantBuffer(sizeof(float) * (BlurShader::sm_MaxBlurRadius * 2 + 1), 1, "BlurCB");
 		}
 	}
 
+	void BlurAPP::CreateRecordWorkers()
+	{
+		// 录制槽位与任务系统的线程数相同，主线程录制屏障与后处理，完成后帮助录制
+		auto workerCount = std::clamp(JobSystem::GetDefault().GetThreadCount(), 1u, MaxRecordWorkers);
+
+		// 着色器保存了绑定的常量与资源，每个录制槽位使用独立的实例
+		m_RecordWorkers.resize(workerCount);
+		for (auto& worker : m_RecordWorkers) {
+			worker.m_LitShader = std::make_unique<LitShader>(m_D3D12Device.Get(), 3, 1, 1, EnableBindless);
+			worker.m_ShadowShader = std::make_unique<ShadowShader>(m_D3D12Device.Get(), EnableBindless);
+		}
+		for (auto& frameResource : m_FrameResources) {
+			frameResource->CreateWorkers(workerCount);
+		}
+
+		ImguiManager::GetInstance().m_RecordWorkerCount = workerCount;
+	}
+
 	void BlurAPP::CreateDescriptor()
 	{
 
@@ -455,18 +667,18 @@ namespace DSM {
 		smSrvDesc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURE2D;
 		smSrvDesc.Format = DXGI_FORMAT_R24_UNORM_X8_TYPELESS;
 		smSrvDesc.Texture2D.MipLevels = 1;
-		auto smSrvHandle = m_ShaderDescriptorHeap->Allocate(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
+		auto smSrvHandle = m_DescriptorAllocator->Allocate(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV).m_Handle;
 		m_D3D12Device->CreateShaderResourceView(pShadowMapResource, &smSrvDesc, smSrvHandle);
 		m_ShadowMap->m_SrvHandle = smSrvHandle;
 
 		D3D12_DEPTH_STENCIL_VIEW_DESC smDsvDesc = {};
 		smDsvDesc.ViewDimension = D3D12_DSV_DIMENSION_TEXTURE2D;
 		smDsvDesc.Format = DXGI_FORMAT_D24_UNORM_S8_UINT;
-		auto dsvhandle = m_ShaderDescriptorHeap->Allocate(D3D12_DESCRIPTOR_HEAP_TYPE_DSV);
+		auto dsvhandle = m_DescriptorAllocator->Allocate(D3D12_DESCRIPTOR_HEAP_TYPE_DSV).m_Handle;
 		m_D3D12Device->CreateDepthStencilView(pShadowMapResource, &smDsvDesc, dsvhandle);
 		m_ShadowMap->m_DsvHandle = dsvhandle;
 
-		auto blurHandle = m_ShaderDescriptorHeap->Allocate(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV, 4);
+		auto blurHandle = m_DescriptorAllocator->Allocate(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV, 4).m_Handle;
 		m_BlurShader->CreateDescriptors(blurHandle, m_D3D12Device->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV));
 	}
 
@@ -499,6 +711,11 @@ namespace DSM {
 		passConstants.m_FogRange = imgui.m_FogRange;
 
 		m_LitShader->SetPassConstants(passConstants);
+		m_LitShader->SetFogEnable(imgui.m_EnableFog);
+		for (auto& worker : m_RecordWorkers) {
+			worker.m_LitShader->SetPassConstants(passConstants);
+			worker.m_LitShader->SetFogEnable(imgui.m_EnableFog);
+		}
 	}
 	
 	void BlurAPP::UpdateLightCB(const CpuTimer& timer)
@@ -513,6 +730,48 @@ namespace DSM {
 
 		auto lightByteSize = lightManager.GetDirLightCount() * sizeof(DirectionalLight);
 		m_LitShader->SetDirectionalLights(lightByteSize, lightManager.GetDirLight());
+		// 场景中只设置了第一个方向光，选择只计算该光源的变体
+		m_LitShader->SetLightCount(1, 0, 0);
+		for (auto& worker : m_RecordWorkers) {
+			worker.m_LitShader->SetDirectionalLights(lightByteSize, lightManager.GetDirLight());
+			worker.m_LitShader->SetLightCount(1, 0, 0);
+		}
+	}
+
+	void BlurAPP::UpdateAllocatorStats(const CpuTimer& timer)
+	{
+		// 收集统计需要为每个分配器构造名称与逐层级的容器，因此按固定间隔采样
+		auto totalTime = timer.TotalTime();
+		auto elapsed = totalTime - m_AllocatorStatsTime;
+		if (!m_PrevAllocatorStats.empty() && elapsed < AllocatorStatsInterval) return;
+
+		auto& stats = m_AllocatorStats;
+		stats.clear();
+		stats.push_back(m_TextureAllocator->GetStats());
+		stats.push_back(m_RenderTargetAllocator->GetStats());
+		TextureManager::GetInstance().GetAllocatorStats(stats);
+
+		// 合并所有帧资源中的分配器
+		AllocatorStats frameDefault{}, frameUpload{};
+		frameDefault.m_Name = "FrameResource DefaultBuffer";
+		frameUpload.m_Name = "FrameResource UploadBuffer";
+		for (const auto& frameResource : m_FrameResources) {
+			frameDefault.Merge(frameResource->m_DefaultBufferAllocator->GetStats());
+			frameUpload.Merge(frameResource->m_UploadBufferAllocator->GetStats());
+		}
+		stats.push_back(std::move(frameDefault));
+		stats.push_back(std::move(frameUpload));
+
+		// 由上一次采样计算速率，第一次采样时没有速率
+		if (m_PrevAllocatorStats.size() == stats.size()) {
+			for (std::size_t i = 0; i < stats.size(); ++i) {
+				stats[i].ComputeRates(m_PrevAllocatorStats[i], elapsed);
+			}
+		}
+		m_PrevAllocatorStats = stats;
+		m_AllocatorStatsTime = totalTime;
+
+		ImguiManager::GetInstance().m_AllocatorStats = stats;
 	}
 
 	void BlurAPP::UpdateShadowCB(const CpuTimer& timer)
@@ -551,6 +810,7 @@ namespace DSM {
 
 		XMMATRIX S = lightView * lightProj * T;
 		m_ShadowTrans = S;
+		m_LightViewProj = lightView * lightProj;
 
 		PassConstants passConstants;
 		XMStoreFloat4x4(&passConstants.m_View, XMMatrixTranspose(lightView));
@@ -570,10 +830,66 @@ namespace DSM {
 		passConstants.m_FogRange = imgui.m_FogRange;
 
 		m_ShadowShader->SetPassConstants(passConstants);
+		for (auto& worker : m_RecordWorkers) {
+			worker.m_ShadowShader->SetPassConstants(passConstants);
+		}
 	}
 
 
 
+	void BlurAPP::UpdateCulling()
+	{
+		const auto& objStore = ObjectManager::GetInstance().GetObjectStore();
+
+		m_FrustumCuller.Clear();
+		m_CullingItems.clear();
+
+		// 世界矩阵已由 ObjectStore::UpdateWorldMatrices 计算，按稠密数组顺序遍历
+		auto models = objStore.GetModels();
+		auto worldMatrices = objStore.GetWorldMatrices();
+		auto layerMasks = objStore.GetLayerMasks();
+		for (std::uint32_t i = 0; i < objStore.Size(); ++i) {
+			auto modelDraw = m_ModelDrawIndices.find(models[i]);
+			if (modelDraw == m_ModelDrawIndices.end()) continue;
+
+			const auto& model = m_ModelDraws[modelDraw->second];
+			for (const auto& submesh : model.m_Submeshes) {
+				const auto& bound = submesh.m_Submesh->m_Bound;
+				m_FrustumCuller.AddBox(bound.Center, bound.Extents, worldMatrices[i]);
+				m_CullingItems.push_back({ i, layerMasks[i], &model, &submesh });
+			}
+		}
+
+		// 相机与光源的剔除互不依赖，光源的剔除交给任务系统
+		XMFLOAT4X4 viewProj, lightViewProj;
+		XMStoreFloat4x4(&viewProj, m_Camera->GetViewProjMatrixXM());
+		XMStoreFloat4x4(&lightViewProj, m_LightViewProj);
+		auto& jobSystem = JobSystem::GetDefault();
+		JobCounter shadowCullCounter;
+		jobSystem.Run([this, &lightViewProj]() {
+			m_FrustumCuller.Cull(lightViewProj, m_ShadowVisibleItems);
+			}, shadowCullCounter);
+		m_FrustumCuller.Cull(viewProj, m_VisibleItems);
+		jobSystem.Wait(shadowCullCounter);
+
+		// 按渲染层筛选各通道绘制的子网格，阴影只由不透明物体投射
+		auto filterItems = [this](const std::vector<std::uint32_t>& visible, RenderLayer layer, std::vector<std::uint32_t>& items) {
+			items.clear();
+			for (auto index : visible) {
+				if (m_CullingItems[index].m_LayerMask & GetRenderLayerMask(layer)) {
+					items.push_back(index);
+				}
+			}
+			};
+		filterItems(m_VisibleItems, RenderLayer::Opaque, m_SceneDrawItems);
+		filterItems(m_ShadowVisibleItems, RenderLayer::Opaque, m_ShadowDrawItems);
+
+		auto& imgui = ImguiManager::GetInstance();
+		imgui.m_TotalDrawCount = m_FrustumCuller.GetBoxCount();
+		imgui.m_VisibleDrawCount = static_cast<std::uint32_t>(m_VisibleItems.size());
+		imgui.m_ShadowDrawCount = static_cast<std::uint32_t>(m_ShadowVisibleItems.size());
+	}
+
 	MaterialConstants BlurAPP::GetMaterialConstants(const Material& material)
 	{
 		MaterialConstants ret{};
@@ -603,14 +919,24 @@ namespace DSM {
 		return ret;
 	}
 
+	MaterialConstants BlurAPP::MaterialDraw::GetConstants() const
+	{
+		// 纹理整理后会使用新的无绑定索引，每次绘制时读取
+		auto ret = m_Constants;
+		ret.m_DiffuseIndex = m_DiffuseTexture->GetDescriptorIndex();
+		return ret;
+	}
+
 	
 	
-	ObjectConstants BlurAPP::GetObjectConstants(const Object& obj)
+	ObjectConstants BlurAPP::GetObjectConstants(std::uint32_t objectIndex)
 	{
+		const auto& objStore = ObjectManager::GetInstance().GetObjectStore();
 		ObjectConstants ret{};
-		auto world = obj.GetTransform().GetLocalToWorldMatrix();
+		// 世界矩阵与逆转置矩阵只在物体移动后重新计算，两个渲染通道共用
+		auto world = XMLoadFloat4x4(&objStore.GetWorldMatrices()[objectIndex]);
 		XMStoreFloat4x4(&ret.m_World, XMMatrixTranspose(world));
-		XMStoreFloat4x4(&ret.m_WorldInvTranspose, MathHelper::InverseTransposeWithOutTranslate(world));
+		ret.m_WorldInvTranspose = objStore.GetWorldInvTransposes()[objectIndex];
 		return ret;
 	}
 
@@ -9,9 +9,16 @@
 #include "Buffer.h"
 #include "ConstantData.h"
 #include "Shader.h"
+#include "D3D12Fence.h"
+#include "D3D12DescriptorAllocator.h"
+#include "FrustumCuller.h"
+#include "ParallelRecord.h"
+#include "JobSystem.h"
+#include <span>
 
 namespace DSM {
 struct Material;
+class Texture;
 
 
 class BlurAPP : public D3D12App {
@@ -26,8 +33,34 @@ class BlurAPP : public D3D12App {
     void OnResize() override;
 
     void WaitForGPU();
-    void RenderScene(RenderLayer layer);
-    void RenderShadow();
+    // 单个命令列表录制整帧
+    void RenderFrame();
+    // 绘制分配给工作线程录制，主线程录制通道之间的命令，按通道顺序一次提交
+    void RenderFrameParallel();
+    void RecordWorkerTasks(std::uint32_t workerIndex);
+    // 主线程的着色器绑定帧资源中的常量缓冲区
+    void BindShaderConstants();
+
+    // 设置视口与渲染目标，命令列表之间不继承状态，每个录制绘制的命令列表都需要设置
+    void SetShadowTarget(ID3D12GraphicsCommandList* cmdList);
+    void SetSceneTarget(ID3D12GraphicsCommandList* cmdList);
+    // 通道开始与结束时的屏障与清除
+    void BeginShadowPass(ID3D12GraphicsCommandList* cmdList);
+    void EndShadowPass(ID3D12GraphicsCommandList* cmdList);
+    void BeginScenePass(ID3D12GraphicsCommandList* cmdList);
+    // 模糊、ImGui 与呈现前的屏障
+    void EndFrame(ID3D12GraphicsCommandList* cmdList);
+    // items 为 m_CullingItems 的索引，可在工作线程中调用，着色器与帧资源同时只能被一个线程使用
+    void RecordSceneDraws(
+        ID3D12GraphicsCommandList* cmdList,
+        LitShader& shader,
+        FrameResource* frameResource,
+        std::span<const std::uint32_t> items);
+    void RecordShadowDraws(
+        ID3D12GraphicsCommandList* cmdList,
+        ShadowShader& shader,
+        FrameResource* frameResource,
+        std::span<const std::uint32_t> items);
 
     bool InitResource();
 
@@ -35,19 +68,80 @@ class BlurAPP : public D3D12App {
     void CreateTexture();
     void CreateFrameResource();
     void CreateDescriptor();
+    void CreateRecordWorkers();
+    // 由名称解析所有模型的网格与材质，绘制时只以下标访问，需在纹理加载之后调用
+    void CreateDrawData();
 
     void UpdatePassCB(const CpuTimer& timer);
     void UpdateLightCB(const CpuTimer& timer);
     void UpdateShadowCB(const CpuTimer& timer);
+    void UpdateAllocatorStats(const CpuTimer& timer);
+    // 由相机与光源的视锥体剔除子网格，需在更新相机与阴影矩阵之后调用
+    void UpdateCulling();
 
+    // 不包含纹理的描述符索引，索引在纹理整理后会改变，绘制时由 MaterialDraw 读取
     MaterialConstants GetMaterialConstants(const Material& material);
-    ObjectConstants GetObjectConstants(const Object& obj);
+    // objectIndex 为物体在 ObjectStore 稠密数组中的下标
+    ObjectConstants GetObjectConstants(std::uint32_t objectIndex);
+
+    // 绘制使用的材质，常量在加载时计算
+    struct MaterialDraw
+    {
+        MaterialConstants m_Constants{};
+        const Texture* m_DiffuseTexture = nullptr;
+
+        MaterialConstants GetConstants() const;
+    };
+
+    // 绘制一个子网格所需的数据，材质为 m_MaterialDraws 的下标
+    struct SubmeshDraw
+    {
+        const Geometry::SubmeshData* m_Submesh = nullptr;
+        std::uint32_t m_MaterialIndex = 0;
+    };
+
+    // 一个模型的绘制数据，子网格按 MeshData::m_DrawArgs 的顺序排列
+    struct ModelDraw
+    {
+        const Geometry::MeshData* m_MeshData = nullptr;
+        std::vector<SubmeshDraw> m_Submeshes;
+    };
+
+    // 参与剔除的一个子网格，按物体的顺序加入，同一物体的子网格在可见列表中相邻
+    struct CullingItem
+    {
+        std::uint32_t m_ObjectIndex = ObjectHandle::InvalidIndex;
+        RenderLayerMask m_LayerMask = 0;
+        const ModelDraw* m_Model = nullptr;
+        const SubmeshDraw* m_Submesh = nullptr;
+    };
+
+    // 录制槽位独占的着色器
+    struct RecordWorker
+    {
+        std::unique_ptr<LitShader> m_LitShader;
+        std::unique_ptr<ShadowShader> m_ShadowShader;
+    };
 
    public:
     inline static constexpr UINT FrameCount = 3;
+    // 无绑定模式下纹理通过材质中的索引访问，绘制时不再复制纹理描述符
+    inline static constexpr bool EnableBindless = true;
+    // 并行录制的通道顺序与划分参数
+    inline static constexpr std::uint32_t ShadowRecordPass = 0;
+    inline static constexpr std::uint32_t SceneRecordPass = 1;
+    inline static constexpr std::uint32_t RecordPassCount = 2;
+    inline static constexpr std::uint32_t MaxRecordWorkers = 8;
+    inline static constexpr std::uint32_t MinDrawsPerRecordTask = 64;
+    // 分配器统计的采样间隔，单位为秒
+    inline static constexpr float AllocatorStatsInterval = 1.0f;
 
    protected:
-    std::unique_ptr<D3D12DescriptorCache> m_ShaderDescriptorHeap;
+    std::unique_ptr<D3D12Fence> m_FrameFence;
+    std::unique_ptr<D3D12UploadRingBuffer> m_UploadRingBuffer;
+    std::unique_ptr<D3D12DescriptorRing> m_DescriptorRing;
+
+    std::unique_ptr<D3D12DescriptorAllocator> m_DescriptorAllocator;
 
     DirectX::BoundingSphere m_SceneSphere{};
 
@@ -69,6 +163,33 @@ class BlurAPP : public D3D12App {
     std::unique_ptr<BlurShader> m_BlurShader;
  
     DirectX::XMMATRIX m_ShadowTrans;
+    DirectX::XMMATRIX m_LightViewProj;
+
+    // 加载后建立的绘制数据，模型以指针索引，每帧建立剔除列表时不需要按名称查找
+    std::vector<ModelDraw> m_ModelDraws;
+    std::vector<MaterialDraw> m_MaterialDraws;
+    std::unordered_map<const Model*, std::uint32_t> m_ModelDrawIndices;
+
+    // 每帧由所有子网格的包围盒重新建立，可见列表中为 m_CullingItems 的索引
+    FrustumCuller m_FrustumCuller;
+    std::vector<CullingItem> m_CullingItems;
+    std::vector<std::uint32_t> m_VisibleItems;
+    std::vector<std::uint32_t> m_ShadowVisibleItems;
+    // 按渲染层筛选后各通道绘制的子网格
+    std::vector<std::uint32_t> m_SceneDrawItems;
+    std::vector<std::uint32_t> m_ShadowDrawItems;
+
+    // 最近一次采样的统计与用于计算分配速率的上一次采样
+    std::vector<AllocatorStats> m_AllocatorStats;
+    std::vector<AllocatorStats> m_PrevAllocatorStats;
+    float m_AllocatorStatsTime = 0;
+
+    // 并行录制，每个录制槽位一组着色器
+    std::vector<RecordWorker> m_RecordWorkers;
+    ParallelRecordPlan m_RecordPlan;
+    std::vector<ID3D12CommandList*> m_TaskCommandLists;
+    // 按提交顺序排列的命令列表，每帧清空后重新填充，保留容量
+    std::vector<ID3D12CommandList*> m_SubmitCommandLists;
 };
 
 
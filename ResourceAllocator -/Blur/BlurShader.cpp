@@ -17,16 +17,19 @@ namespace DSM{
             tex = std::make_unique<GpuBuffer>();
         }
         
+        // 两个入口点并行编译
+        std::vector<ShaderDesc> shaderDescs;
         ShaderDesc shaderDesc{};
         shaderDesc.m_Target = "cs_6_1";
         shaderDesc.m_EnterPoint = "HorizBlurCS";
         shaderDesc.m_Type = ShaderType::COMPUTE_SHADER;
         shaderDesc.m_FileName = "Shaders\\Blur.hlsl";
         shaderDesc.m_ShaderName = "HorizBlurCS";
-        m_ShaderHelper->CreateShaderFormFile(shaderDesc);
+        shaderDescs.push_back(shaderDesc);
         shaderDesc.m_EnterPoint = "VerticBlurCS";
         shaderDesc.m_ShaderName = "VerticBlurCS";
-        m_ShaderHelper->CreateShaderFormFile(shaderDesc);
+        shaderDescs.push_back(shaderDesc);
+        m_ShaderHelper->CreateShadersFromFile(shaderDescs);
         ShaderPassDesc passDesc{};
         passDesc.m_CSName = "HorizBlurCS";
         m_ShaderHelper->AddShaderPass("HorizBlurCS", passDesc, device);
@@ -0,0 +1,228 @@
+#include "BuddyAllocator.h"
+#include <algorithm>
+#include <bit>
+#include <cassert>
+
+namespace DSM {
+	BuddyAllocator::BuddyAllocator(std::size_t minBlockSize, std::size_t maxBlockSize)
+		:m_MinBlockSize(minBlockSize),
+		// 最大块向下取整到最小块的 2 的幂倍，避免分配超出范围的偏移量
+		m_MaxBlockSize(minBlockSize == 0 ? 0 : std::bit_floor(maxBlockSize / minBlockSize) * minBlockSize) {
+		assert(m_MinBlockSize > 0 && m_MaxBlockSize >= m_MinBlockSize);
+
+		// 计算最大层级，偏移量以 uint32 记录
+		m_MaxOrder = UnitSizeToOrder(SizeToUnitSize(m_MaxBlockSize));
+		assert(m_MaxOrder < 32);
+		assert(UnitSizeToSize(OrderToUnitSize(m_MaxOrder)) == m_MaxBlockSize);
+
+		const std::size_t unitCount = OrderToUnitSize(m_MaxOrder);
+		const std::size_t nodeCount = unitCount << 1;
+
+		m_FreeListHead.assign(m_MaxOrder + 1, NullLink);
+		m_FreeBlockCount.assign(m_MaxOrder + 1, 0);
+		m_NextFree.assign(unitCount, NullLink);
+		m_PrevFree.assign(unitCount, NullLink);
+		m_FreeBitmap.assign((nodeCount + 63) / 64, 0);
+
+		// 初始只有一个最大层级的空闲块
+		PushFreeBlock(0, m_MaxOrder);
+	}
+
+	std::uint32_t BuddyAllocator::AllocateBlock(std::uint32_t order)
+	{
+		if (order > m_MaxOrder) {
+			return InvalidOffset;
+		}
+
+		// 查找不小于所需层级的最小非空层级
+		const auto mask = m_NonEmptyOrderMask >> order;
+		if (mask == 0) {
+			return InvalidOffset;
+		}
+		auto currOrder = order + static_cast<std::uint32_t>(std::countr_zero(mask));
+
+		auto offset = m_FreeListHead[currOrder];
+		RemoveFreeBlock(offset, currOrder);
+
+		// 逐级拆分，左块继续拆分，右块放回空闲链表
+		while (currOrder > order) {
+			--currOrder;
+			PushFreeBlock(offset + static_cast<std::uint32_t>(OrderToUnitSize(currOrder)), currOrder);
+		}
+
+		m_AllocatedUnits += OrderToUnitSize(order);
+		return offset;
+	}
+
+	void BuddyAllocator::DeallocateBlock(std::uint32_t offset, std::uint32_t order)
+	{
+		assert(order <= m_MaxOrder);
+		assert(IsAllocatedBlock(offset, order));
+		m_AllocatedUnits -= OrderToUnitSize(order);
+
+		// 伙伴块空闲则向上合并
+		while (order < m_MaxOrder) {
+			auto buddyOffset = offset ^ static_cast<std::uint32_t>(OrderToUnitSize(order));
+			if (!IsFreeBlock(buddyOffset, order)) {
+				break;
+			}
+			RemoveFreeBlock(buddyOffset, order);
+			offset = (std::min)(offset, buddyOffset);
+			++order;
+		}
+
+		PushFreeBlock(offset, order);
+	}
+
+	// 计算对其后的字节数
+	std::size_t BuddyAllocator::SizeToUnitSize(std::size_t size) const noexcept
+	{
+		return ((size + m_MinBlockSize - 1) / m_MinBlockSize);
+	}
+
+	std::uint32_t BuddyAllocator::UnitSizeToOrder(std::size_t unitSize) const noexcept
+	{
+		// 计算对数 ceil(log2(size))
+		return unitSize <= 1 ? 0 : static_cast<std::uint32_t>(std::bit_width(unitSize - 1));
+	}
+
+	std::size_t BuddyAllocator::OrderToUnitSize(std::uint32_t order) const noexcept
+	{
+		return std::size_t(1) << order;
+	}
+
+	std::size_t BuddyAllocator::UnitSizeToSize(std::size_t unitSize) const noexcept
+	{
+		return unitSize * m_MinBlockSize;
+	}
+
+	std::uint32_t BuddyAllocator::GetMaxOrder() const noexcept
+	{
+		return m_MaxOrder;
+	}
+
+	std::size_t BuddyAllocator::GetMinBlockSize() const noexcept
+	{
+		return m_MinBlockSize;
+	}
+
+	std::size_t BuddyAllocator::GetMaxBlockSize() const noexcept
+	{
+		return m_MaxBlockSize;
+	}
+
+	bool BuddyAllocator::IsEmpty() const noexcept
+	{
+		return IsFreeBlock(0, m_MaxOrder);
+	}
+
+	std::uint32_t BuddyAllocator::GetFreeBlockCount(std::uint32_t order) const noexcept
+	{
+		return order <= m_MaxOrder ? m_FreeBlockCount[order] : 0;
+	}
+
+	std::size_t BuddyAllocator::GetLargestFreeBlockSize() const noexcept
+	{
+		if (m_NonEmptyOrderMask == 0) return 0;
+		auto order = static_cast<std::uint32_t>(std::bit_width(m_NonEmptyOrderMask) - 1);
+		return UnitSizeToSize(OrderToUnitSize(order));
+	}
+
+	std::size_t BuddyAllocator::GetAllocatedSize() const noexcept
+	{
+		return UnitSizeToSize(m_AllocatedUnits);
+	}
+
+	std::size_t BuddyAllocator::GetBookkeepingSize() const noexcept
+	{
+		return (m_NextFree.size() + m_PrevFree.size()) * sizeof(std::uint32_t) +
+			m_FreeBitmap.size() * sizeof(std::uint64_t) +
+			(m_FreeListHead.size() + m_FreeBlockCount.size()) * sizeof(std::uint32_t);
+	}
+
+	std::size_t BuddyAllocator::GetNodeIndex(std::uint32_t offset, std::uint32_t order) const noexcept
+	{
+		return (std::size_t(1) << (m_MaxOrder - order)) + (std::size_t(offset) >> order);
+	}
+
+	bool BuddyAllocator::IsAllocatedBlock(std::uint32_t offset, std::uint32_t order) const noexcept
+	{
+		if (order > m_MaxOrder || (offset & (OrderToUnitSize(order) - 1)) != 0 ||
+			offset + OrderToUnitSize(order) > OrderToUnitSize(m_MaxOrder)) {
+			return false;
+		}
+
+		// 块本身以及包含它的祖先块都不能是空闲块
+		for (auto currOrder = order; currOrder <= m_MaxOrder; ++currOrder) {
+			auto currOffset = offset & ~static_cast<std::uint32_t>(OrderToUnitSize(currOrder) - 1);
+			if (IsFreeBlock(currOffset, currOrder)) {
+				return false;
+			}
+		}
+
+		// 子树中的节点在每一层都是连续的，按位图的字检查
+		for (std::uint32_t depth = 1; depth <= order; ++depth) {
+			auto begin = GetNodeIndex(offset, order - depth);
+			auto end = begin + (std::size_t(1) << depth);
+			for (auto index = begin; index < end;) {
+				auto bit = index & 63;
+				auto count = (std::min)(end - index, std::size_t(64) - bit);
+				auto mask = count == 64 ? ~std::uint64_t(0) : ((std::uint64_t(1) << count) - 1) << bit;
+				if ((m_FreeBitmap[index >> 6] & mask) != 0) {
+					return false;
+				}
+				index += count;
+			}
+		}
+
+		return true;
+	}
+
+	bool BuddyAllocator::IsFreeBlock(std::uint32_t offset, std::uint32_t order) const noexcept
+	{
+		auto index = GetNodeIndex(offset, order);
+		return (m_FreeBitmap[index >> 6] >> (index & 63)) & 1;
+	}
+
+	void BuddyAllocator::PushFreeBlock(std::uint32_t offset, std::uint32_t order) noexcept
+	{
+		auto index = GetNodeIndex(offset, order);
+		m_FreeBitmap[index >> 6] |= std::uint64_t(1) << (index & 63);
+
+		// 插入到链表头部
+		auto head = m_FreeListHead[order];
+		m_NextFree[offset] = head;
+		m_PrevFree[offset] = NullLink;
+		if (head != NullLink) {
+			m_PrevFree[head] = offset;
+		}
+		m_FreeListHead[order] = offset;
+		++m_FreeBlockCount[order];
+		m_NonEmptyOrderMask |= std::uint64_t(1) << order;
+	}
+
+	void BuddyAllocator::RemoveFreeBlock(std::uint32_t offset, std::uint32_t order) noexcept
+	{
+		auto index = GetNodeIndex(offset, order);
+		m_FreeBitmap[index >> 6] &= ~(std::uint64_t(1) << (index & 63));
+
+		auto prev = m_PrevFree[offset];
+		auto next = m_NextFree[offset];
+		if (prev != NullLink) {
+			m_NextFree[prev] = next;
+		}
+		else {
+			m_FreeListHead[order] = next;
+		}
+		if (next != NullLink) {
+			m_PrevFree[next] = prev;
+		}
+		m_NextFree[offset] = NullLink;
+		m_PrevFree[offset] = NullLink;
+		--m_FreeBlockCount[order];
+
+		if (m_FreeListHead[order] == NullLink) {
+			m_NonEmptyOrderMask &= ~(std::uint64_t(1) << order);
+		}
+	}
+}
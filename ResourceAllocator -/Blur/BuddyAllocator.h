@@ -0,0 +1,77 @@
+#pragma once
+#ifndef __BUDDYALLOCATOR__H__
+#define __BUDDYALLOCATOR__H__
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+namespace DSM {
+	// Buddy System 的簿记核心，不依赖 D3D12 设备
+	// 每个层级维护一条侵入式的双向空闲链表，并用位图记录节点是否空闲，
+	// 分配与释放均为常数时间，且过程中不会产生额外的内存分配
+	// 代价是簿记内存与最小单位的数量成正比：链表每个最小单位 8 字节，位图每个单位约 2 位，
+	// 例如 512MB、256B 粒度的分配器有 2M 个单位，约占用 16.5MB 的 CPU 内存，可由 GetBookkeepingSize 查询
+	class BuddyAllocator
+	{
+	public:
+		static constexpr std::uint32_t InvalidOffset = UINT32_MAX;
+
+		// maxBlockSize 会向下取整到 minBlockSize 的 2 的幂倍
+		BuddyAllocator(std::size_t minBlockSize, std::size_t maxBlockSize);
+
+		// 分配指定层级的块，返回以最小块为单位的偏移量，失败返回 InvalidOffset
+		std::uint32_t AllocateBlock(std::uint32_t order);
+		// 释放块，并逐级与空闲的伙伴块合并
+		void DeallocateBlock(std::uint32_t offset, std::uint32_t order);
+
+		// 实际大小获取单位大小
+		std::size_t SizeToUnitSize(std::size_t size) const noexcept;
+		// 单位大小获取层级
+		std::uint32_t UnitSizeToOrder(std::size_t unitSize) const noexcept;
+		// 层级获取单位大小
+		std::size_t OrderToUnitSize(std::uint32_t order) const noexcept;
+		// 单位大小获取实际大小
+		std::size_t UnitSizeToSize(std::size_t unitSize) const noexcept;
+
+		std::uint32_t GetMaxOrder() const noexcept;
+		std::size_t GetMinBlockSize() const noexcept;
+		std::size_t GetMaxBlockSize() const noexcept;
+		// 是否没有任何已分配的块
+		bool IsEmpty() const noexcept;
+		// 块是否整块处于已分配状态，即自身、祖先与子树中均没有空闲块
+		bool IsAllocatedBlock(std::uint32_t offset, std::uint32_t order) const noexcept;
+
+		// 统计信息
+		std::uint32_t GetFreeBlockCount(std::uint32_t order) const noexcept;
+		std::size_t GetLargestFreeBlockSize() const noexcept;
+		std::size_t GetAllocatedSize() const noexcept;
+		// 空闲链表与位图占用的 CPU 内存
+		std::size_t GetBookkeepingSize() const noexcept;
+
+	private:
+		// 节点在完全二叉树中的索引(从 1 开始)
+		std::size_t GetNodeIndex(std::uint32_t offset, std::uint32_t order) const noexcept;
+		bool IsFreeBlock(std::uint32_t offset, std::uint32_t order) const noexcept;
+		void PushFreeBlock(std::uint32_t offset, std::uint32_t order) noexcept;
+		void RemoveFreeBlock(std::uint32_t offset, std::uint32_t order) noexcept;
+
+	private:
+		static constexpr std::uint32_t NullLink = UINT32_MAX;
+
+		const std::size_t m_MinBlockSize;     // 内存块的最小大小
+		const std::size_t m_MaxBlockSize;     // 内存块的最大大小
+		std::uint32_t m_MaxOrder = 0;         // 最大层级
+
+		std::vector<std::uint32_t> m_FreeListHead;  // 每个层级空闲链表的头
+		std::vector<std::uint32_t> m_FreeBlockCount;// 每个层级空闲块的数量
+		// 空闲块互不重叠，因此每个最小单位至多是一个空闲块的起点，可直接用偏移量作为链表节点
+		std::vector<std::uint32_t> m_NextFree;
+		std::vector<std::uint32_t> m_PrevFree;
+		std::vector<std::uint64_t> m_FreeBitmap;    // 每个节点是否为空闲块
+		std::uint64_t m_NonEmptyOrderMask = 0;      // 空闲链表非空的层级
+		std::size_t m_AllocatedUnits = 0;           // 已分配的最小单位数量
+	};
+}
+
+#endif
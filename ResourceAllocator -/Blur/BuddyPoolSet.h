@@ -0,0 +1,274 @@
+#pragma once
+#ifndef __BUDDYPOOLSET__H__
+#define __BUDDYPOOLSET__H__
+
+#include "AllocatorStats.h"
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace DSM {
+	// 分配器的大小类别
+	enum class BuddyPoolSizeClass : std::uint32_t
+	{
+		Small,      // 小块请求使用较小的分配器，避免零散地占用大分配器
+		Normal,
+		Dedicated   // 超过分配器一半大小的请求独占一个分配器，空闲后立即释放
+	};
+
+	// 创建分配器所需的参数
+	struct BuddyPoolDesc
+	{
+		BuddyPoolSizeClass m_SizeClass;
+		std::size_t m_MaxBlockSize;
+		std::size_t m_BackingSize;      // 实际创建的大小，专用的分配器只创建请求所需的大小
+	};
+
+	// 按请求大小将分配路由到一组 Buddy 分配器，并回收长时间空闲的分配器，不依赖 D3D12 设备
+	// 分配器由构造时传入的工厂创建，Pool 需提供以下接口：
+	//   std::size_t ClearUpAllocations();   回收围栏已完成的内存块，返回回收的数量
+	//   bool IsEmpty() const;               没有存活的分配，包括等待围栏的内存块
+	//   std::size_t GetReservedSize() const;
+	//   std::size_t GetBackingSize() const;
+	//   void GetStats(BuddyPoolStats&) const;
+	// 分配器的索引在其存活期间保持不变，被回收的位置会被之后创建的分配器复用
+	template <typename Pool>
+	class BuddyPoolSet
+	{
+	public:
+		using SizeClass = BuddyPoolSizeClass;
+		using PoolFactory = std::function<std::shared_ptr<Pool>(const BuddyPoolDesc&)>;
+
+		static constexpr std::uint32_t InvalidIndex = UINT32_MAX;
+		static constexpr std::size_t MinBlockSize = 256;
+		static constexpr std::size_t SmallAllocationSize = 1024 * 64;
+		static constexpr std::size_t MinSmallPoolSize = 1024 * 1024 * 4;
+		static constexpr std::size_t DedicatedAlignment = 1024 * 64;
+		static constexpr std::uint32_t DefaultTrimIdleFrames = 120;
+
+	public:
+		BuddyPoolSet(PoolFactory factory, std::size_t poolSize, std::uint32_t trimIdleFrames = DefaultTrimIdleFrames)
+			:m_Factory(std::move(factory)), m_PoolSize(poolSize),
+			m_SmallPoolSize((std::min)(poolSize, (std::max)(poolSize / 16, MinSmallPoolSize))),
+			m_TrimIdleFrames(trimIdleFrames) {
+		}
+
+		// 依次在同一类别的分配器中调用 tryAllocate(Pool&)，都失败时创建新的分配器
+		// 专用的请求总是新建分配器，返回成功分配的分配器的索引，无法分配时返回 InvalidIndex
+		template <typename TryAllocate>
+		std::uint32_t Allocate(std::size_t size, TryAllocate&& tryAllocate)
+		{
+			auto sizeClass = GetSizeClass(size);
+			if (sizeClass != SizeClass::Dedicated) {
+				for (std::uint32_t i = 0; i < m_Pools.size(); ++i) {
+					if (m_Pools[i].m_Allocator == nullptr || m_Pools[i].m_SizeClass != sizeClass) continue;
+					if (TryAllocateInPool(i, tryAllocate)) {
+						return i;
+					}
+				}
+			}
+
+			auto poolIndex = CreatePool(sizeClass, size);
+			if (TryAllocateInPool(poolIndex, tryAllocate)) {
+				return poolIndex;
+			}
+			// 新建的分配器仍无法满足（例如对齐后超出分配器的范围），释放后改用专用的分配器
+			ReleasePool(poolIndex);
+			if (sizeClass != SizeClass::Dedicated) {
+				poolIndex = CreatePool(SizeClass::Dedicated, size);
+				if (TryAllocateInPool(poolIndex, tryAllocate)) {
+					return poolIndex;
+				}
+				ReleasePool(poolIndex);
+			}
+			return InvalidIndex;
+		}
+
+		// 只在指定的分配器中分配
+		template <typename TryAllocate>
+		bool AllocateInPool(std::uint32_t poolIndex, TryAllocate&& tryAllocate)
+		{
+			if (GetPool(poolIndex) == nullptr) return false;
+			return TryAllocateInPool(poolIndex, tryAllocate);
+		}
+
+		// 回收围栏已完成的内存块，并释放空闲次数超过 trimIdleFrames 的分配器
+		// 通常每帧调用一次，因此空闲次数近似为空闲的帧数
+		void ClearUpAllocations()
+		{
+			m_ReservedBytes = 0;
+			for (std::uint32_t i = 0; i < m_Pools.size(); ++i) {
+				auto& pool = m_Pools[i];
+				if (pool.m_Allocator == nullptr) continue;
+
+				m_TotalFrees += pool.m_Allocator->ClearUpAllocations();
+				if (!pool.m_Allocator->IsEmpty()) {
+					pool.m_IdleFrames = 0;
+					m_ReservedBytes += pool.m_Allocator->GetReservedSize();
+					continue;
+				}
+
+				// 专用的分配器空闲后立即释放，其余的分配器空闲足够久后释放
+				auto trimIdleFrames = pool.m_SizeClass == SizeClass::Dedicated ? 0 : m_TrimIdleFrames;
+				if (pool.m_IdleFrames++ >= trimIdleFrames) {
+					ReleasePool(i);
+				}
+			}
+		}
+
+		void GetStats(AllocatorStats& stats) const
+		{
+			for (const auto& pool : m_Pools) {
+				if (pool.m_Allocator == nullptr) continue;
+				BuddyPoolStats poolStats{};
+				pool.m_Allocator->GetStats(poolStats);
+				stats.AddPool(poolStats);
+			}
+			stats.m_HighWaterMark = m_HighWaterMark;
+			stats.m_TotalAllocations = m_TotalAllocations;
+			stats.m_TotalFrees = m_TotalFrees;
+		}
+
+		void SetTrimIdleFrames(std::uint32_t trimIdleFrames) noexcept
+		{
+			m_TrimIdleFrames = trimIdleFrames;
+		}
+
+		SizeClass GetSizeClass(std::size_t size) const noexcept
+		{
+			if (size > m_PoolSize / 2) {
+				return SizeClass::Dedicated;
+			}
+			if (size <= SmallAllocationSize && m_SmallPoolSize < m_PoolSize) {
+				return SizeClass::Small;
+			}
+			return SizeClass::Normal;
+		}
+
+		// 新建分配器的参数
+		BuddyPoolDesc GetPoolDesc(SizeClass sizeClass, std::size_t size) const noexcept
+		{
+			switch (sizeClass) {
+			case SizeClass::Small:
+				return { sizeClass, m_SmallPoolSize, 0 };
+			case SizeClass::Normal:
+				return { sizeClass, m_PoolSize, 0 };
+			default:
+				// 只创建请求所需的大小，按 64KB 对齐
+				return { sizeClass, std::bit_ceil(size), (size + DedicatedAlignment - 1) / DedicatedAlignment * DedicatedAlignment };
+			}
+		}
+
+		std::size_t GetPoolCount() const noexcept
+		{
+			return m_PoolCount;
+		}
+
+		// 所有存活的分配器实际创建的大小
+		std::uint64_t GetPoolBytes() const noexcept
+		{
+			return m_PoolBytes;
+		}
+
+		// 上一次回收后的占用加上之后新分配的块
+		std::uint64_t GetReservedBytes() const noexcept
+		{
+			return m_ReservedBytes;
+		}
+
+		std::uint64_t GetHighWaterMark() const noexcept
+		{
+			return m_HighWaterMark;
+		}
+
+		std::uint32_t GetPoolSlotCount() const noexcept
+		{
+			return static_cast<std::uint32_t>(m_Pools.size());
+		}
+
+		// 已被回收的位置返回 nullptr
+		Pool* GetPool(std::uint32_t poolIndex) const noexcept
+		{
+			return poolIndex < m_Pools.size() ? m_Pools[poolIndex].m_Allocator.get() : nullptr;
+		}
+
+		SizeClass GetPoolSizeClass(std::uint32_t poolIndex) const noexcept
+		{
+			return m_Pools[poolIndex].m_SizeClass;
+		}
+
+	private:
+		struct PoolEntry
+		{
+			std::shared_ptr<Pool> m_Allocator;
+			SizeClass m_SizeClass;
+			std::uint32_t m_IdleFrames = 0;
+		};
+
+		template <typename TryAllocate>
+		bool TryAllocateInPool(std::uint32_t poolIndex, TryAllocate& tryAllocate)
+		{
+			auto& pool = m_Pools[poolIndex];
+			// 以分配前后的占用之差计入统计，专用分配器的占用不超过实际创建的大小
+			auto reservedSize = pool.m_Allocator->GetReservedSize();
+			if (!tryAllocate(*pool.m_Allocator)) {
+				return false;
+			}
+			pool.m_IdleFrames = 0;
+			m_ReservedBytes += pool.m_Allocator->GetReservedSize() - reservedSize;
+			m_HighWaterMark = (std::max)(m_HighWaterMark, m_ReservedBytes);
+			++m_TotalAllocations;
+			return true;
+		}
+
+		std::uint32_t CreatePool(SizeClass sizeClass, std::size_t size)
+		{
+			auto allocator = m_Factory(GetPoolDesc(sizeClass, size));
+			assert(allocator != nullptr);
+			m_PoolBytes += allocator->GetBackingSize();
+
+			++m_PoolCount;
+			if (!m_FreePoolSlots.empty()) {
+				auto poolIndex = m_FreePoolSlots.back();
+				m_FreePoolSlots.pop_back();
+				m_Pools[poolIndex] = { std::move(allocator), sizeClass, 0 };
+				return poolIndex;
+			}
+			m_Pools.push_back({ std::move(allocator), sizeClass, 0 });
+			return static_cast<std::uint32_t>(m_Pools.size() - 1);
+		}
+
+		void ReleasePool(std::uint32_t poolIndex)
+		{
+			auto& pool = m_Pools[poolIndex];
+			m_PoolBytes -= pool.m_Allocator->GetBackingSize();
+			pool.m_Allocator = nullptr;
+			m_FreePoolSlots.push_back(poolIndex);
+			--m_PoolCount;
+		}
+
+	private:
+		PoolFactory m_Factory;
+
+		std::vector<PoolEntry> m_Pools;             // 被回收的分配器留下空位，索引保持不变
+		std::vector<std::uint32_t> m_FreePoolSlots; // 可复用的空位
+		std::size_t m_PoolCount = 0;
+
+		std::size_t m_PoolSize;         // 普通分配器的大小
+		std::size_t m_SmallPoolSize;    // 小块分配器的大小
+		std::uint32_t m_TrimIdleFrames;
+
+		// 统计信息
+		std::uint64_t m_PoolBytes = 0;
+		std::uint64_t m_ReservedBytes = 0;
+		std::uint64_t m_HighWaterMark = 0;
+		std::uint64_t m_TotalAllocations = 0;
+		std::uint64_t m_TotalFrees = 0;
+	};
+}
+
+#endif
@@ -0,0 +1,168 @@
+#include "CommandListStateTracker.h"
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+
+namespace DSM {
+	std::uint64_t CommandListStateStats::GetIssuedCount() const noexcept
+	{
+		return m_PipelineStateCalls + m_RootSignatureCalls + m_DescriptorHeapCalls + m_RootArgumentCalls;
+	}
+
+	std::uint64_t CommandListStateStats::GetSkippedCount() const noexcept
+	{
+		return m_PipelineStateSkipped + m_RootSignatureSkipped + m_DescriptorHeapSkipped + m_RootArgumentSkipped;
+	}
+
+	void CommandListStateStats::Merge(const CommandListStateStats& other) noexcept
+	{
+		m_PipelineStateCalls += other.m_PipelineStateCalls;
+		m_PipelineStateSkipped += other.m_PipelineStateSkipped;
+		m_RootSignatureCalls += other.m_RootSignatureCalls;
+		m_RootSignatureSkipped += other.m_RootSignatureSkipped;
+		m_DescriptorHeapCalls += other.m_DescriptorHeapCalls;
+		m_DescriptorHeapSkipped += other.m_DescriptorHeapSkipped;
+		m_RootArgumentCalls += other.m_RootArgumentCalls;
+		m_RootArgumentSkipped += other.m_RootArgumentSkipped;
+	}
+
+	void CommandListStateTracker::Reset() noexcept
+	{
+		m_PipelineState = nullptr;
+		m_RootSignatures.fill(nullptr);
+		m_DescriptorHeaps.fill(nullptr);
+		m_NumDescriptorHeaps = 0;
+		InvalidateRootArguments(false);
+		InvalidateRootArguments(true);
+	}
+
+	bool CommandListStateTracker::SetPipelineState(const void* pipelineState)
+	{
+		assert(pipelineState != nullptr);
+
+		if (m_PipelineState == pipelineState) {
+			++m_Stats.m_PipelineStateSkipped;
+			return false;
+		}
+		m_PipelineState = pipelineState;
+		++m_Stats.m_PipelineStateCalls;
+		return true;
+	}
+
+	bool CommandListStateTracker::SetRootSignature(const void* rootSignature, bool isCompute)
+	{
+		assert(rootSignature != nullptr);
+
+		auto& current = m_RootSignatures[isCompute];
+		if (current == rootSignature) {
+			++m_Stats.m_RootSignatureSkipped;
+			return false;
+		}
+		current = rootSignature;
+		InvalidateRootArguments(isCompute);
+		++m_Stats.m_RootSignatureCalls;
+		return true;
+	}
+
+	bool CommandListStateTracker::SetDescriptorHeaps(std::uint32_t numHeaps, const void* const* heaps)
+	{
+		assert(numHeaps > 0 && numHeaps <= MaxDescriptorHeaps);
+
+		if (m_NumDescriptorHeaps == numHeaps &&
+			std::equal(heaps, heaps + numHeaps, m_DescriptorHeaps.begin())) {
+			++m_Stats.m_DescriptorHeapSkipped;
+			return false;
+		}
+		std::copy(heaps, heaps + numHeaps, m_DescriptorHeaps.begin());
+		m_NumDescriptorHeaps = numHeaps;
+		++m_Stats.m_DescriptorHeapCalls;
+
+		// 更换堆后之前设置的描述符表不再有效
+		for (auto& arguments : m_RootArguments) {
+			for (auto& argument : arguments) {
+				if (argument.m_Type == RootArgumentType::DESCRIPTOR_TABLE) {
+					argument.m_Type = RootArgumentType::NONE;
+				}
+			}
+		}
+		return true;
+	}
+
+	bool CommandListStateTracker::SetRootConstantBufferView(
+		std::uint32_t rootIndex,
+		std::uint64_t gpuAddress,
+		bool isCompute)
+	{
+		return SetRootArgument(GetRootArgument(rootIndex, isCompute), RootArgumentType::CONSTANT_BUFFER_VIEW, gpuAddress);
+	}
+
+	bool CommandListStateTracker::SetRootDescriptorTable(
+		std::uint32_t rootIndex,
+		std::uint64_t gpuHandle,
+		bool isCompute)
+	{
+		return SetRootArgument(GetRootArgument(rootIndex, isCompute), RootArgumentType::DESCRIPTOR_TABLE, gpuHandle);
+	}
+
+	bool CommandListStateTracker::SetRoot32BitConstants(
+		std::uint32_t rootIndex,
+		std::uint32_t num32BitValues,
+		const void* data,
+		bool isCompute)
+	{
+		assert(data != nullptr);
+
+		auto& argument = GetRootArgument(rootIndex, isCompute);
+		auto byteSize = num32BitValues * sizeof(std::uint32_t);
+		if (argument.m_Type == RootArgumentType::CONSTANTS &&
+			argument.m_Constants.size() == num32BitValues &&
+			std::memcmp(argument.m_Constants.data(), data, byteSize) == 0) {
+			++m_Stats.m_RootArgumentSkipped;
+			return false;
+		}
+		argument.m_Type = RootArgumentType::CONSTANTS;
+		argument.m_Constants.resize(num32BitValues);
+		std::memcpy(argument.m_Constants.data(), data, byteSize);
+		++m_Stats.m_RootArgumentCalls;
+		return true;
+	}
+
+	const CommandListStateStats& CommandListStateTracker::GetStats() const noexcept
+	{
+		return m_Stats;
+	}
+
+	void CommandListStateTracker::ResetStats() noexcept
+	{
+		m_Stats = {};
+	}
+
+	CommandListStateTracker::RootArgument& CommandListStateTracker::GetRootArgument(std::uint32_t rootIndex, bool isCompute)
+	{
+		auto& arguments = m_RootArguments[isCompute];
+		if (rootIndex >= arguments.size()) {
+			arguments.resize(rootIndex + 1);
+		}
+		return arguments[rootIndex];
+	}
+
+	bool CommandListStateTracker::SetRootArgument(RootArgument& argument, RootArgumentType type, std::uint64_t value)
+	{
+		if (argument.m_Type == type && argument.m_Value == value) {
+			++m_Stats.m_RootArgumentSkipped;
+			return false;
+		}
+		argument.m_Type = type;
+		argument.m_Value = value;
+		++m_Stats.m_RootArgumentCalls;
+		return true;
+	}
+
+	void CommandListStateTracker::InvalidateRootArguments(bool isCompute) noexcept
+	{
+		// 保留 m_Constants 的内存，避免每次更换根签名时重新分配
+		for (auto& argument : m_RootArguments[isCompute]) {
+			argument.m_Type = RootArgumentType::NONE;
+		}
+	}
+}
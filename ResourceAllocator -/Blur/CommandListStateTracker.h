@@ -0,0 +1,87 @@
+#pragma once
+#ifndef __COMMANDLISTSTATETRACKER__H__
+#define __COMMANDLISTSTATETRACKER__H__
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+namespace DSM {
+	// 状态设置调用的统计，跳过的调用即与命令列表上已有状态相同的冗余调用
+	struct CommandListStateStats
+	{
+		std::uint64_t m_PipelineStateCalls = 0;
+		std::uint64_t m_PipelineStateSkipped = 0;
+		std::uint64_t m_RootSignatureCalls = 0;
+		std::uint64_t m_RootSignatureSkipped = 0;
+		std::uint64_t m_DescriptorHeapCalls = 0;
+		std::uint64_t m_DescriptorHeapSkipped = 0;
+		std::uint64_t m_RootArgumentCalls = 0;
+		std::uint64_t m_RootArgumentSkipped = 0;
+
+		std::uint64_t GetIssuedCount() const noexcept;
+		std::uint64_t GetSkippedCount() const noexcept;
+		// 累加其他命令列表的统计，用于汇总并行录制的结果
+		void Merge(const CommandListStateStats& other) noexcept;
+	};
+
+	// 记录命令列表上最后设置的 PSO、根签名、描述符堆与根参数，判断一次设置是否需要提交，不依赖 D3D12 设备
+	// 对象只以地址区分，GPU 地址与描述符句柄以数值记录
+	// 每个 Set 返回 true 表示状态发生了变化，调用者需要将其写入命令列表
+	class CommandListStateTracker
+	{
+	public:
+		// D3D12 中每个命令列表最多同时绑定 CBV_SRV_UAV 与 Sampler 两个堆
+		static constexpr std::uint32_t MaxDescriptorHeaps = 2;
+
+		// 清空记录的状态，之后的设置都会提交，统计数据保留
+		void Reset() noexcept;
+
+		bool SetPipelineState(const void* pipelineState);
+		// 根签名改变时，对应管线上的根参数全部失效
+		bool SetRootSignature(const void* rootSignature, bool isCompute);
+		// 描述符堆改变时，两条管线上的描述符表失效，其余根参数不受影响
+		bool SetDescriptorHeaps(std::uint32_t numHeaps, const void* const* heaps);
+
+		bool SetRootConstantBufferView(std::uint32_t rootIndex, std::uint64_t gpuAddress, bool isCompute);
+		bool SetRootDescriptorTable(std::uint32_t rootIndex, std::uint64_t gpuHandle, bool isCompute);
+		// 根常量按值比较，内容相同时无需重新写入
+		bool SetRoot32BitConstants(std::uint32_t rootIndex, std::uint32_t num32BitValues, const void* data, bool isCompute);
+
+		const CommandListStateStats& GetStats() const noexcept;
+		void ResetStats() noexcept;
+
+	private:
+		enum class RootArgumentType : std::uint8_t
+		{
+			NONE,
+			CONSTANT_BUFFER_VIEW,
+			DESCRIPTOR_TABLE,
+			CONSTANTS
+		};
+
+		struct RootArgument
+		{
+			RootArgumentType m_Type = RootArgumentType::NONE;
+			std::uint64_t m_Value = 0;
+			std::vector<std::uint32_t> m_Constants;
+		};
+
+		RootArgument& GetRootArgument(std::uint32_t rootIndex, bool isCompute);
+		bool SetRootArgument(RootArgument& argument, RootArgumentType type, std::uint64_t value);
+		void InvalidateRootArguments(bool isCompute) noexcept;
+
+	private:
+		const void* m_PipelineState = nullptr;
+		// 图形与计算管线的根签名及根参数相互独立
+		std::array<const void*, 2> m_RootSignatures{};
+		std::array<std::vector<RootArgument>, 2> m_RootArguments{};
+		std::array<const void*, MaxDescriptorHeaps> m_DescriptorHeaps{};
+		// 为 0 时表示尚未设置
+		std::uint32_t m_NumDescriptorHeaps = 0;
+
+		CommandListStateStats m_Stats{};
+	};
+}
+
+#endif
@@ -0,0 +1,86 @@
+#include "ConstantBufferData.h"
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <iterator>
+
+namespace DSM {
+	ConstantBufferData::ConstantBufferData(std::uint32_t byteSize)
+		:m_Data(byteSize) {
+	}
+
+	bool ConstantBufferData::Write(std::uint32_t offset, const void* data, std::uint32_t byteSize)
+	{
+		assert(data != nullptr && offset <= m_Data.size() && byteSize <= m_Data.size() - offset);
+		auto dest = m_Data.data() + offset;
+
+		// 写入的值未改变时不需要重新上传
+		if (byteSize == 0 || std::memcmp(dest, data, byteSize) == 0) return false;
+		std::memcpy(dest, data, byteSize);
+		MarkDirty(offset, offset + byteSize);
+		return true;
+	}
+
+	std::uint32_t ConstantBufferData::UpdateBuffer(const std::shared_ptr<void>& resource, void* mappedAddress)
+	{
+		assert(resource != nullptr && mappedAddress != nullptr);
+		auto it = std::find_if(m_BoundStates.begin(), m_BoundStates.end(), [&resource](const auto& state) {
+			return state.m_Resource.lock() == resource;
+			});
+		if (it == m_BoundStates.end()) {
+			if (m_BoundStates.size() >= MaxBoundResourceStates) {
+				m_BoundStates.erase(m_BoundStates.begin());
+			}
+			m_BoundStates.emplace_back().m_Resource = resource;
+			it = std::prev(m_BoundStates.end());
+		}
+		else if (it->m_MappedAddress == mappedAddress && it->m_Version == m_Version) {
+			return 0;
+		}
+
+		if (it->m_MappedAddress != mappedAddress) {
+			it->m_MappedAddress = mappedAddress;
+			it->m_DirtyBegin = 0;
+			it->m_DirtyEnd = static_cast<std::uint32_t>(m_Data.size());
+		}
+
+		auto byteSize = it->m_DirtyEnd - it->m_DirtyBegin;
+		if (byteSize > 0) {
+			std::memcpy(static_cast<std::uint8_t*>(mappedAddress) + it->m_DirtyBegin,
+				m_Data.data() + it->m_DirtyBegin, byteSize);
+		}
+		it->m_DirtyBegin = it->m_DirtyEnd = 0;
+		it->m_Version = m_Version;
+		return byteSize;
+	}
+
+	const std::uint8_t* ConstantBufferData::GetData() const noexcept
+	{
+		return m_Data.data();
+	}
+
+	std::uint32_t ConstantBufferData::GetByteSize() const noexcept
+	{
+		return static_cast<std::uint32_t>(m_Data.size());
+	}
+
+	std::uint64_t ConstantBufferData::GetVersion() const noexcept
+	{
+		return m_Version;
+	}
+
+	void ConstantBufferData::MarkDirty(std::uint32_t begin, std::uint32_t end)
+	{
+		++m_Version;
+		for (auto& state : m_BoundStates) {
+			if (state.m_DirtyBegin == state.m_DirtyEnd) {
+				state.m_DirtyBegin = begin;
+				state.m_DirtyEnd = end;
+			}
+			else {
+				state.m_DirtyBegin = (std::min)(state.m_DirtyBegin, begin);
+				state.m_DirtyEnd = (std::max)(state.m_DirtyEnd, end);
+			}
+		}
+	}
+}
@@ -0,0 +1,52 @@
+#pragma once
+#ifndef __CONSTANTBUFFERDATA__H__
+#define __CONSTANTBUFFERDATA__H__
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace DSM {
+	// 常量缓冲区在 CPU 端的数据，不依赖 D3D12 设备
+	// 每个已绑定的上传资源分别记录上次同步后改变的范围，同步时只写入该范围
+	class ConstantBufferData
+	{
+	public:
+		// 记录的资源数量上限，超过时丢弃最早的记录
+		static constexpr std::size_t MaxBoundResourceStates = 8;
+
+		explicit ConstantBufferData(std::uint32_t byteSize = 0);
+
+		// 写入 [offset, offset + byteSize)，值未改变时不标记，返回内容是否改变
+		bool Write(std::uint32_t offset, const void* data, std::uint32_t byteSize);
+
+		// 将 resource 上次同步后改变的范围写入 mappedAddress，返回写入的字节数
+		// 第一次同步或资源被移动到新的地址时内容未知，写入全部数据
+		std::uint32_t UpdateBuffer(const std::shared_ptr<void>& resource, void* mappedAddress);
+
+		const std::uint8_t* GetData() const noexcept;
+		std::uint32_t GetByteSize() const noexcept;
+		// 内容每次改变时递增
+		std::uint64_t GetVersion() const noexcept;
+
+	private:
+		// 一个已绑定资源的同步状态，每个帧资源的常量缓冲区分别记录尚未写入的范围
+		struct BoundResourceState
+		{
+			std::weak_ptr<void> m_Resource;
+			void* m_MappedAddress = nullptr;
+			std::uint64_t m_Version = 0;
+			std::uint32_t m_DirtyBegin = 0;
+			std::uint32_t m_DirtyEnd = 0;
+		};
+
+		void MarkDirty(std::uint32_t begin, std::uint32_t end);
+
+	private:
+		std::vector<std::uint8_t> m_Data;
+		std::uint64_t m_Version = 0;
+		std::vector<BoundResourceState> m_BoundStates;
+	};
+}
+
+#endif
@@ -39,7 +39,7 @@ namespace DSM {
 		DirectX::XMFLOAT3 m_Specular = { 0,0,0 };
 		float m_Gloss = 0.2;
 		DirectX::XMFLOAT3 m_Ambient = { 0,0,0 };
-		float m_Pad1;
+		std::uint32_t m_DiffuseIndex = 0;	// 无绑定模式下漫反射纹理的描述符索引
 	};
 }
 
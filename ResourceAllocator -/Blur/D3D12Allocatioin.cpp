@@ -1,5 +1,7 @@
 #include "D3D12Allocatioin.h"
 #include "D3DUtil.h"
+#include <algorithm>
+#include <bit>
 
 using namespace DirectX;
 using Microsoft::WRL::ComPtr;
@@ -8,10 +10,16 @@ namespace DSM {
 	D3D12BuddyAllocator::D3D12BuddyAllocator(
 		ID3D12Device* device,
 		const AllocatorInitData& initData,
+		IFence* fence,
 		std::size_t minBlockSize,
-		std::size_t maxBlockSize)
-		:m_Device(device), m_InitData(initData), m_MinBlockSize(minBlockSize), m_MaxBlockSize(maxBlockSize) {
-		assert(m_Device != nullptr);
+		std::size_t maxBlockSize,
+		std::size_t backingSize)
+		:m_InitData(initData), m_MinBlockSize(minBlockSize), m_MaxBlockSize(maxBlockSize),
+		m_BlockAllocator(minBlockSize, maxBlockSize),
+		m_BackingSize(backingSize == 0 ? m_BlockAllocator.GetMaxBlockSize() : backingSize), m_Fence(fence),
+		m_Device(device) {
+		assert(m_Device != nullptr && m_Fence != nullptr);
+		assert(m_BackingSize <= m_BlockAllocator.GetMaxBlockSize());
 
 		D3D12_HEAP_PROPERTIES heapProper{};
 		heapProper.Type = m_InitData.m_HeapType;
@@ -20,7 +28,7 @@ namespace DSM {
 			D3D12_HEAP_DESC heapDesc{};
 			heapDesc.Flags = m_InitData.m_HeapFlags;
 			heapDesc.Properties = heapProper;
-			heapDesc.SizeInBytes = m_MaxBlockSize;
+			heapDesc.SizeInBytes = m_BackingSize;
 
 			ThrowIfFailed(m_Device->CreateHeap(&heapDesc, IID_PPV_ARGS(m_Heap.GetAddressOf())));
 			m_Heap->SetName(L"D3D12BuddyAllocator BuddyHeap");
@@ -30,7 +38,7 @@ namespace DSM {
 			D3D12_RESOURCE_DESC resourceDesc{};
 			resourceDesc.Dimension = D3D12_RESOURCE_DIMENSION_BUFFER;
 			resourceDesc.Flags = m_InitData.m_ResourceFlags;
-			resourceDesc.Width = maxBlockSize;
+			resourceDesc.Width = m_BackingSize;
 			resourceDesc.Height = 1;
 			resourceDesc.DepthOrArraySize = 1;
 			resourceDesc.MipLevels = 1;
@@ -61,64 +69,57 @@ namespace DSM {
 				m_Resource->Map();
 			}
 		}
-		// 计算最大层级
-		m_MaxOrder = UnitSizeToOrder(SizeToUnitSize(maxBlockSize));
-
-		// 创建空闲的块
-		m_FreeBlock.resize(m_MaxOrder + 1);
-		m_FreeBlock[m_MaxOrder].insert(std::uint32_t(0));   // 初始偏移量为0
 	}
 
 	D3D12BuddyAllocator::~D3D12BuddyAllocator()
 	{
-		if (m_Resource != nullptr) {
+		if (m_Resource != nullptr && m_Resource->m_MappedBaseAddress != nullptr) {
 			m_Resource->Unmap();
 		}
-		if (m_Heap != nullptr) {
-			m_Heap->Release();
-		}
 	}
 
 	bool D3D12BuddyAllocator::Allocate(std::uint32_t size,
 		std::uint32_t alignment,
 		D3D12ResourceLocation& resourceLocation)
 	{
-		auto unitSize = SizeToUnitSize(size);
-		auto order = UnitSizeToOrder(unitSize);
-		auto blockSize = UnitSizeToSize(unitSize);
-
-		try {
-			// 获取偏移量
-			auto offset = AllocBlock(order);
-			const auto offsetSize = UnitSizeToSize(offset);
-			auto aligOffsetSize = offsetSize;
-			// 将偏移量进行对齐
-			if (alignment != 0 && offsetSize % alignment != 0) {
-				aligOffsetSize = D3DUtil::AlignArbitrary(aligOffsetSize, alignment);
-				assert((size + aligOffsetSize - offsetSize) <= blockSize);
-			}
+		// 块按自身大小对齐，块不小于 2 的幂的对齐时无需填充
+		auto blockRequest = std::has_single_bit(alignment) ? (std::max)(size, alignment) : size;
+		auto unitSize = m_BlockAllocator.SizeToUnitSize(blockRequest);
+		auto order = m_BlockAllocator.UnitSizeToOrder(unitSize);
+		auto blockSize = m_BlockAllocator.UnitSizeToSize(m_BlockAllocator.OrderToUnitSize(order));
+
+		// 获取偏移量
+		auto offset = m_BlockAllocator.AllocateBlock(order);
+		if (offset == BuddyAllocator::InvalidOffset) {
+			return false;
+		}
 
-			resourceLocation.m_Allocator = this;
-			resourceLocation.m_BlockData.m_Offset = offset;
-			resourceLocation.m_BlockData.m_Order = order;
-			resourceLocation.m_BlockData.m_ActualUseSize = size;
-			resourceLocation.m_ResourceLocationType = D3D12ResourceLocation::ResourceLocationType::SubAllocation;
-
-			if (m_InitData.m_Strategy == AllocationStrategy::ManualSubAllocation) {
-				resourceLocation.m_UnderlyingResource = m_Resource.get();
-				resourceLocation.m_GPUVirtualAddress = m_Resource->m_GPUVirtualAddress + aligOffsetSize;
-				resourceLocation.m_OffsetFromBaseOfResource = aligOffsetSize;
-				if (m_InitData.m_HeapType == D3D12_HEAP_TYPE_UPLOAD) {
-					resourceLocation.m_MappedBaseAddress = static_cast<char*>(m_Resource->m_MappedBaseAddress) + aligOffsetSize;
-				}
-			}
-			else {
-				// Placed Resource 由创建者初始化
-				resourceLocation.m_OffsetFromBaseOfHeap = aligOffsetSize;
+		const auto offsetSize = m_BlockAllocator.UnitSizeToSize(offset);
+		std::size_t aligOffsetSize = 0;
+		if (!GetAlignedOffset(offsetSize, blockSize, m_BackingSize, size, alignment, aligOffsetSize)) {
+			m_BlockAllocator.DeallocateBlock(offset, order);
+			return false;
+		}
+		m_RequestedBytes += size;
+		++m_LiveAllocations;
+
+		resourceLocation.m_Allocator = this;
+		resourceLocation.m_BlockData.m_Offset = offset;
+		resourceLocation.m_BlockData.m_Order = order;
+		resourceLocation.m_BlockData.m_ActualUseSize = size;
+		resourceLocation.m_ResourceLocationType = D3D12ResourceLocation::ResourceLocationType::SubAllocation;
+
+		if (m_InitData.m_Strategy == AllocationStrategy::ManualSubAllocation) {
+			resourceLocation.m_UnderlyingResource = m_Resource.get();
+			resourceLocation.m_GPUVirtualAddress = m_Resource->m_GPUVirtualAddress + aligOffsetSize;
+			resourceLocation.m_OffsetFromBaseOfResource = aligOffsetSize;
+			if (m_InitData.m_HeapType == D3D12_HEAP_TYPE_UPLOAD) {
+				resourceLocation.m_MappedBaseAddress = static_cast<char*>(m_Resource->m_MappedBaseAddress) + aligOffsetSize;
 			}
 		}
-		catch (std::bad_alloc&) {
-			return false;
+		else {
+			// Placed Resource 由创建者初始化
+			resourceLocation.m_OffsetFromBaseOfHeap = aligOffsetSize;
 		}
 
 		return true;
@@ -126,16 +127,15 @@ namespace DSM {
 
 	void D3D12BuddyAllocator::Deallocate(D3D12ResourceLocation& resourceLocation)
 	{
-		m_DeferredDeletionQueue.push(resourceLocation.m_BlockData);
+		// 记录释放时所在帧的围栏值
+		m_DeferredDeletionQueue.Push(m_Fence->GetCurrentValue(), resourceLocation.m_BlockData);
 	}
 
-	void D3D12BuddyAllocator::ClearUpAllocations()
+	std::size_t D3D12BuddyAllocator::ClearUpAllocations()
 	{
-		for (std::size_t i = 0; i < m_DeferredDeletionQueue.size(); ++i) {
-			auto& blockData = m_DeferredDeletionQueue.front();
-			DeallocateInternal(blockData);
-			m_DeferredDeletionQueue.pop();
-		}
+		// 只回收 GPU 已经不再使用的内存块
+		return m_DeferredDeletionQueue.Retire(m_Fence->GetCompletedValue(),
+			[this](D3D12BuddyBlockData& blockData) { DeallocateInternal(blockData); });
 	}
 
 	ID3D12Heap* D3D12BuddyAllocator::GetHeap() const
@@ -148,129 +148,175 @@ namespace DSM {
 		return m_InitData.m_Strategy;
 	}
 
-
-	// 计算对其后的字节数
-	std::size_t D3D12BuddyAllocator::SizeToUnitSize(std::size_t size)
+	std::size_t D3D12BuddyAllocator::GetBlockSize(std::uint32_t order) const
 	{
-		return ((size + m_MinBlockSize - 1) / m_MinBlockSize);
+		return m_BlockAllocator.UnitSizeToSize(m_BlockAllocator.OrderToUnitSize(order));
 	}
 
-	std::uint32_t D3D12BuddyAllocator::UnitSizeToOrder(std::size_t unitSize)
+	std::size_t D3D12BuddyAllocator::GetReservedSize() const
 	{
-		// 计算对数log2(size)
-		unsigned long index;
-		_BitScanReverse(&index, unitSize + unitSize - 1);
-		return index;
+		// 专用分配器的块按 2 的幂取整，可能超出实际创建的大小
+		return (std::min)(m_BlockAllocator.GetAllocatedSize(), m_BackingSize);
 	}
 
-	std::size_t D3D12BuddyAllocator::OrderToUnitSize(std::uint32_t order)
+	std::size_t D3D12BuddyAllocator::GetBackingSize() const
 	{
-		return std::size_t(1) << order;
+		return m_BackingSize;
 	}
 
-	std::size_t D3D12BuddyAllocator::UnitSizeToSize(std::size_t unitSize)
+	bool D3D12BuddyAllocator::IsEmpty() const
 	{
-		return unitSize * m_MinBlockSize;
+		// 存活数量在内存块真正回收时才减少，因此也包括了延迟删除队列
+		return m_LiveAllocations == 0;
 	}
 
-	std::size_t D3D12BuddyAllocator::GetBuddyOffset(const std::size_t& offset, const std::size_t& size)
+	void D3D12BuddyAllocator::GetStats(BuddyPoolStats& stats) const
 	{
-		return offset ^ size;
+		stats.m_PoolSize = m_BackingSize;
+		stats.m_RequestedBytes = m_RequestedBytes;
+		stats.m_ReservedBytes = GetReservedSize();
+		stats.m_LargestFreeBlock = m_BlockAllocator.GetLargestFreeBlockSize();
+		stats.m_LiveAllocations = m_LiveAllocations;
+
+		auto maxOrder = m_BlockAllocator.GetMaxOrder();
+		stats.m_FreeBytesPerOrder.resize(maxOrder + 1);
+		for (std::uint32_t order = 0; order <= maxOrder; ++order) {
+			stats.m_FreeBytesPerOrder[order] = GetBlockSize(order) * m_BlockAllocator.GetFreeBlockCount(order);
+		}
 	}
 
-	std::size_t D3D12BuddyAllocator::AllocBlock(std::uint32_t order)
+	const BuddyAllocator& D3D12BuddyAllocator::GetBlockAllocator() const
 	{
-		if (order > m_MaxOrder) {
-			throw std::bad_alloc();
-		}
+		return m_BlockAllocator;
+	}
 
-		std::size_t offset;
-
-		if (auto it = m_FreeBlock[order].begin(); it == m_FreeBlock[order].end()) {
-			// 若当前层级内存不够，向上查询并拆分
-			auto left = AllocBlock(order + 1);
-			auto size = OrderToUnitSize(order);
-			auto right = left + size;
-			// 将右块插入空闲块中，相当于记录资源的偏移量
-			m_FreeBlock[order].insert(std::uint32_t(right));
-			// 将左块提供给调用者
-			offset = left;
-		}
-		else {  // 若够则将此内存块移除
-			offset = *it;
-			m_FreeBlock[order].erase(it);
+	bool D3D12BuddyAllocator::GetAlignedOffset(
+		std::size_t blockOffset,
+		std::size_t blockSize,
+		std::size_t backingSize,
+		std::uint32_t size,
+		std::uint32_t alignment,
+		std::size_t& alignedOffset)
+	{
+		alignedOffset = blockOffset;
+		// 将偏移量进行对齐
+		if (alignment != 0 && blockOffset % alignment != 0) {
+			alignedOffset = D3DUtil::AlignArbitrary(blockOffset, alignment);
 		}
-
-		return offset;
+		auto blockEnd = (std::min)(blockOffset + blockSize, backingSize);
+		return alignedOffset + size <= blockEnd;
 	}
 
 	void D3D12BuddyAllocator::DeallocateInternal(D3D12BuddyBlockData& blockData)
 	{
-		DeallocateBlock(blockData.m_Offset, blockData.m_Order);
+		m_BlockAllocator.DeallocateBlock(blockData.m_Offset, blockData.m_Order);
+		m_RequestedBytes -= blockData.m_ActualUseSize;
+		--m_LiveAllocations;
 
 		if (m_InitData.m_Strategy == AllocationStrategy::PlacedResource) {
 			blockData.m_PlacedResource = nullptr;
 		}
 	}
 
-	void D3D12BuddyAllocator::DeallocateBlock(std::size_t offset, std::uint32_t order)
-	{
-		std::size_t unitSize = OrderToUnitSize(order);
-		auto buddyOffset = GetBuddyOffset(offset, unitSize);
-
-		if (auto it = m_FreeBlock[order].begin(); it == m_FreeBlock[order].end()) {
-			// 将该块加入空闲块中
-			m_FreeBlock[order].insert(offset);
-		}
-		else {
-			// 该块空闲，向上合并
-			DeallocateBlock(min(offset, buddyOffset), order + 1);
-			m_FreeBlock[order].erase(it);
-		}
-	}
+	static_assert(BuddyPoolSet<D3D12BuddyAllocator>::DedicatedAlignment == D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT);
 
 	D3D12MultiBuddyAllocator::D3D12MultiBuddyAllocator(ID3D12Device* device,
-		D3D12BuddyAllocator::AllocatorInitData initData)
-		:m_Device(device), m_InitData(initData) {
+		D3D12BuddyAllocator::AllocatorInitData initData,
+		IFence* fence,
+		std::size_t poolSize,
+		std::uint32_t trimIdleFrames)
+		:m_InitData(initData), m_Fence(fence), m_Device(device),
+		m_Pools([this](const BuddyPoolDesc& desc) { return CreatePool(desc); }, poolSize, trimIdleFrames) {
 	}
 
-	void D3D12MultiBuddyAllocator::Allocate(
+	bool D3D12MultiBuddyAllocator::Allocate(
 		std::uint32_t size,
 		std::uint32_t alignment,
 		D3D12ResourceLocation& resourceLocation)
 	{
-		// 查找所有分配器分配内存
-		for (auto& allocator : m_BuddyAllocators) {
-			bool success = allocator->Allocate(size, alignment, resourceLocation);
-			if (success) return;
+		auto poolIndex = m_Pools.Allocate(size, [&](D3D12BuddyAllocator& pool) {
+			return pool.Allocate(size, alignment, resourceLocation);
+			});
+		if (poolIndex == PoolSet::InvalidIndex) {
+			return false;
 		}
-
-		// 新分配一个分配器
-		auto newBuddyAllocator = std::make_shared<D3D12BuddyAllocator>(m_Device.Get(), m_InitData);
-		bool sucess = newBuddyAllocator->Allocate(size, alignment, resourceLocation);
-		assert(sucess);
-		m_BuddyAllocators.push_back(newBuddyAllocator);
+		resourceLocation.m_PoolIndex = poolIndex;
+		return true;
 	}
 
 	void D3D12MultiBuddyAllocator::Deallocate(D3D12ResourceLocation& resourceLocation)
 	{
-		for (auto& allocator : m_BuddyAllocators) {
-			if (resourceLocation.m_Allocator == allocator.get()) {
-				allocator->Deallocate(resourceLocation);
-				break;
-			}
-		}
+		auto pool = m_Pools.GetPool(resourceLocation.m_PoolIndex);
+		assert(pool != nullptr && pool == resourceLocation.m_Allocator);
+		pool->Deallocate(resourceLocation);
 	}
 
 	void D3D12MultiBuddyAllocator::ClearUpAllocations()
 	{
-		for (auto& allocator : m_BuddyAllocators) {
-			allocator->ClearUpAllocations();
+		m_Pools.ClearUpAllocations();
+	}
+
+	void D3D12MultiBuddyAllocator::SetTrimIdleFrames(std::uint32_t trimIdleFrames) noexcept
+	{
+		m_Pools.SetTrimIdleFrames(trimIdleFrames);
+	}
+
+	D3D12MultiBuddyAllocator::SizeClass D3D12MultiBuddyAllocator::GetSizeClass(std::size_t size) const noexcept
+	{
+		return m_Pools.GetSizeClass(size);
+	}
+
+	std::size_t D3D12MultiBuddyAllocator::GetPoolCount() const noexcept
+	{
+		return m_Pools.GetPoolCount();
+	}
+
+	std::uint32_t D3D12MultiBuddyAllocator::GetPoolSlotCount() const noexcept
+	{
+		return m_Pools.GetPoolSlotCount();
+	}
+
+	const D3D12BuddyAllocator* D3D12MultiBuddyAllocator::GetPool(std::uint32_t poolIndex) const noexcept
+	{
+		return m_Pools.GetPool(poolIndex);
+	}
+
+	D3D12MultiBuddyAllocator::SizeClass D3D12MultiBuddyAllocator::GetPoolSizeClass(std::uint32_t poolIndex) const noexcept
+	{
+		return m_Pools.GetPoolSizeClass(poolIndex);
+	}
+
+	bool D3D12MultiBuddyAllocator::AllocateInPool(
+		std::uint32_t poolIndex,
+		std::uint32_t size,
+		std::uint32_t alignment,
+		D3D12ResourceLocation& resourceLocation)
+	{
+		bool sucess = m_Pools.AllocateInPool(poolIndex, [&](D3D12BuddyAllocator& pool) {
+			return pool.Allocate(size, alignment, resourceLocation);
+			});
+		if (sucess) {
+			resourceLocation.m_PoolIndex = poolIndex;
 		}
+		return sucess;
+	}
+
+	std::shared_ptr<D3D12BuddyAllocator> D3D12MultiBuddyAllocator::CreatePool(const BuddyPoolDesc& desc)
+	{
+		return std::make_shared<D3D12BuddyAllocator>(
+			m_Device.Get(), m_InitData, m_Fence,
+			BuddyPoolSet<D3D12BuddyAllocator>::MinBlockSize, desc.m_MaxBlockSize, desc.m_BackingSize);
+	}
+
+	void D3D12MultiBuddyAllocator::GetStats(AllocatorStats& stats) const
+	{
+		m_Pools.GetStats(stats);
 	}
 
 	D3D12DefaultBufferAllocator::D3D12DefaultBufferAllocator(
-		ID3D12Device* device)
+		ID3D12Device* device,
+		IFence* fence,
+		std::size_t poolSize)
 		:m_Device(device) {
 		D3D12BuddyAllocator::AllocatorInitData initData{};
 		initData.m_HeapFlags = D3D12_HEAP_FLAG_NONE;
@@ -278,7 +324,7 @@ namespace DSM {
 		initData.m_ResourceFlags = D3D12_RESOURCE_FLAG_NONE;
 		initData.m_Strategy = D3D12BuddyAllocator::AllocationStrategy::ManualSubAllocation;
 
-		m_DefaultBufferAllocator = std::make_unique<D3D12MultiBuddyAllocator>(m_Device.Get(), initData);
+		m_DefaultBufferAllocator = std::make_unique<D3D12MultiBuddyAllocator>(m_Device.Get(), initData, fence, poolSize);
 	}
 
 	void D3D12DefaultBufferAllocator::AllocateDefaultBuffer(
@@ -286,7 +332,9 @@ namespace DSM {
 		std::uint32_t alignment,
 		D3D12ResourceLocation& resourceLocation)
 	{
-		m_DefaultBufferAllocator->Allocate(byteSize, alignment, resourceLocation);
+		if (!m_DefaultBufferAllocator->Allocate(byteSize, alignment, resourceLocation)) {
+			ThrowIfFailed(E_OUTOFMEMORY);
+		}
 	}
 
 	void D3D12DefaultBufferAllocator::Deallocate(D3D12ResourceLocation& resourceLocation)
@@ -299,7 +347,23 @@ namespace DSM {
 		m_DefaultBufferAllocator->ClearUpAllocations();
 	}
 
-	D3D12UploadBufferAllocator::D3D12UploadBufferAllocator(ID3D12Device* device)
+	AllocatorStats D3D12DefaultBufferAllocator::GetStats() const
+	{
+		AllocatorStats stats{};
+		stats.m_Name = "DefaultBuffer";
+		m_DefaultBufferAllocator->GetStats(stats);
+		return stats;
+	}
+
+	D3D12MultiBuddyAllocator* D3D12DefaultBufferAllocator::GetBuddyAllocator() const noexcept
+	{
+		return m_DefaultBufferAllocator.get();
+	}
+
+	D3D12UploadBufferAllocator::D3D12UploadBufferAllocator(
+		ID3D12Device* device,
+		IFence* fence,
+		std::size_t poolSize)
 		:m_Device(device) {
 		D3D12BuddyAllocator::AllocatorInitData initData{};
 		initData.m_HeapFlags = D3D12_HEAP_FLAG_NONE;
@@ -307,7 +371,7 @@ namespace DSM {
 		initData.m_ResourceFlags = D3D12_RESOURCE_FLAG_NONE;
 		initData.m_Strategy = D3D12BuddyAllocator::AllocationStrategy::ManualSubAllocation;
 
-		m_UploadBufferAllocator = std::make_unique<D3D12MultiBuddyAllocator>(m_Device.Get(), initData);
+		m_UploadBufferAllocator = std::make_unique<D3D12MultiBuddyAllocator>(m_Device.Get(), initData, fence, poolSize);
 	}
 
 	void D3D12UploadBufferAllocator::AllocateUploadBuffer(
@@ -315,7 +379,9 @@ namespace DSM {
 		std::uint32_t alignment,
 		D3D12ResourceLocation& resourceLocation)
 	{
-		m_UploadBufferAllocator->Allocate(byteSize, alignment, resourceLocation);
+		if (!m_UploadBufferAllocator->Allocate(byteSize, alignment, resourceLocation)) {
+			ThrowIfFailed(E_OUTOFMEMORY);
+		}
 	}
 
 	void D3D12UploadBufferAllocator::Deallocate(D3D12ResourceLocation& resourceLocation)
@@ -328,15 +394,32 @@ namespace DSM {
 		m_UploadBufferAllocator->ClearUpAllocations();
 	}
 
-	D3D12TextureAllocator::D3D12TextureAllocator(ID3D12Device* device)
-		:m_Device(device) {
+	AllocatorStats D3D12UploadBufferAllocator::GetStats() const
+	{
+		AllocatorStats stats{};
+		stats.m_Name = "UploadBuffer";
+		m_UploadBufferAllocator->GetStats(stats);
+		return stats;
+	}
+
+	D3D12TextureAllocator::D3D12TextureAllocator(
+		ID3D12Device* device,
+		IFence* fence,
+		std::size_t poolSize,
+		std::uint32_t trimIdleFrames)
+		:m_Device(device), m_SlabAllocator(SlabSize, D3D12_SMALL_RESOURCE_PLACEMENT_ALIGNMENT, MaxSlabTextureSize),
+		m_TrimIdleFrames(trimIdleFrames), m_Fence(fence) {
 		D3D12BuddyAllocator::AllocatorInitData initData{};
 		initData.m_HeapFlags = D3D12_HEAP_FLAG_ALLOW_ONLY_NON_RT_DS_TEXTURES;
 		initData.m_HeapType = D3D12_HEAP_TYPE_DEFAULT;
 		initData.m_ResourceFlags = D3D12_RESOURCE_FLAG_NONE;
 		initData.m_Strategy = D3D12BuddyAllocator::AllocationStrategy::PlacedResource;
 
-		m_TextureAllocator = std::make_unique<D3D12MultiBuddyAllocator>(m_Device.Get(), initData);
+		m_TextureAllocator = std::make_unique<D3D12MultiBuddyAllocator>(m_Device.Get(), initData, fence, poolSize);
+
+		m_AllocationInfoProvider = [this](const D3D12_RESOURCE_DESC& desc) {
+			return m_Device->GetResourceAllocationInfo(0, 1, &desc);
+			};
 	}
 
 	void D3D12TextureAllocator::AllocateTexture(
@@ -345,15 +428,26 @@ namespace DSM {
 		D3D12ResourceLocation& resourceLocation,
 		const D3D12_CLEAR_VALUE* clearValue)
 	{
-		// 获取在堆中的偏移
-		auto texInfo = m_Device->GetResourceAllocationInfo(0, 1, &textureDesc);
-		m_TextureAllocator->Allocate(texInfo.SizeInBytes, D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT, resourceLocation);
+		// 获取在堆中的大小与对齐
+		auto placement = GetTexturePlacementInfo(textureDesc, m_AllocationInfoProvider);
+
+		ID3D12Heap* heap = nullptr;
+		if (m_SlabAllocator.CanAllocate(placement.m_SizeInBytes)) {
+			heap = AllocateFromSlab(placement, resourceLocation);
+		}
+		else {
+			resourceLocation.m_SlabIndex = SlabAllocator::InvalidIndex;
+			if (!m_TextureAllocator->Allocate(placement.m_SizeInBytes, placement.m_Alignment, resourceLocation)) {
+				ThrowIfFailed(E_OUTOFMEMORY);
+			}
+			heap = resourceLocation.m_Allocator->GetHeap();
+		}
 
 		// 在堆中分配资源
 		ComPtr<ID3D12Resource> resource;
-		ThrowIfFailed(m_Device->CreatePlacedResource(resourceLocation.m_Allocator->GetHeap(),
+		ThrowIfFailed(m_Device->CreatePlacedResource(heap,
 			resourceLocation.m_OffsetFromBaseOfHeap,
-			&textureDesc,
+			&placement.m_Desc,
 			textureState,
 			clearValue,
 			IID_PPV_ARGS(resource.GetAddressOf())));
@@ -365,15 +459,137 @@ namespace DSM {
 
 	void D3D12TextureAllocator::Deallocate(D3D12ResourceLocation& resourceLocation)
 	{
-		m_TextureAllocator->Deallocate(resourceLocation);
+		if (resourceLocation.m_SlabIndex == SlabAllocator::InvalidIndex) {
+			m_TextureAllocator->Deallocate(resourceLocation);
+			return;
+		}
+
+		// Slab 中的纹理同样等到围栏完成后才回收
+		SlabBlockData blockData{};
+		blockData.m_Allocation = { resourceLocation.m_SlabIndex, resourceLocation.m_SlotIndex };
+		blockData.m_ActualUseSize = resourceLocation.m_BlockData.m_ActualUseSize;
+		blockData.m_PlacedResource = resourceLocation.m_BlockData.m_PlacedResource;
+		m_SlabDeletionQueue.Push(m_Fence->GetCurrentValue(), std::move(blockData));
 	}
 
 	void D3D12TextureAllocator::ClearUpAllocations()
 	{
 		m_TextureAllocator->ClearUpAllocations();
+		m_SlabDeletionQueue.Retire(m_Fence->GetCompletedValue(), [this](SlabBlockData& blockData) {
+			m_SlabAllocator.Deallocate(blockData.m_Allocation);
+			m_SlabRequestedBytes -= blockData.m_ActualUseSize;
+			--m_SlabLiveAllocations;
+			--m_SlabHeaps[blockData.m_Allocation.m_Slab / SlabsPerHeap].m_LiveAllocations;
+			blockData.m_PlacedResource = nullptr;
+			});
+		TrimSlabHeaps();
+	}
+
+	AllocatorStats D3D12TextureAllocator::GetStats() const
+	{
+		AllocatorStats stats{};
+		stats.m_Name = "Texture";
+		m_TextureAllocator->GetStats(stats);
+
+		// Slab 的堆作为一个整体统计
+		if (m_SlabHeapCount > 0) {
+			BuddyPoolStats slabStats{};
+			slabStats.m_PoolSize = m_SlabHeapCount * SlabHeapSize;
+			slabStats.m_RequestedBytes = m_SlabRequestedBytes;
+			slabStats.m_ReservedBytes = m_SlabAllocator.GetUsedSize();
+			slabStats.m_LargestFreeBlock = m_SlabAllocator.GetFreeSlabCount() > 0 ? SlabSize : 0;
+			slabStats.m_LiveAllocations = m_SlabLiveAllocations;
+			stats.AddPool(slabStats);
+		}
+		return stats;
+	}
+
+	D3D12MultiBuddyAllocator* D3D12TextureAllocator::GetBuddyAllocator() const noexcept
+	{
+		return m_TextureAllocator.get();
+	}
+
+	ID3D12Heap* D3D12TextureAllocator::AllocateFromSlab(
+		const TexturePlacementInfo& placement,
+		D3D12ResourceLocation& resourceLocation)
+	{
+		// 槽按自身大小对齐，因此槽不小于对齐即可满足对齐要求
+		auto slotSize = (std::max)(placement.m_SizeInBytes, placement.m_Alignment);
+
+		SlabAllocator::Allocation allocation{};
+		if (!m_SlabAllocator.Allocate(slotSize, allocation)) {
+			// 所有 Slab 都已用完，新建一个堆
+			CreateSlabHeap();
+			bool success = m_SlabAllocator.Allocate(slotSize, allocation);
+			assert(success);
+		}
+		m_SlabRequestedBytes += placement.m_SizeInBytes;
+		++m_SlabLiveAllocations;
+
+		// 每个堆包含固定数量的 Slab
+		auto offset = m_SlabAllocator.GetOffset(allocation);
+		auto heapIndex = offset / SlabHeapSize;
+		auto& slabHeap = m_SlabHeaps[heapIndex];
+		++slabHeap.m_LiveAllocations;
+		slabHeap.m_IdleFrames = 0;
+
+		resourceLocation.m_ResourceLocationType = D3D12ResourceLocation::ResourceLocationType::SubAllocation;
+		resourceLocation.m_Allocator = nullptr;
+		resourceLocation.m_PoolIndex = UINT32_MAX;
+		resourceLocation.m_SlabIndex = allocation.m_Slab;
+		resourceLocation.m_SlotIndex = allocation.m_Slot;
+		resourceLocation.m_BlockData.m_ActualUseSize = static_cast<std::uint32_t>(placement.m_SizeInBytes);
+		resourceLocation.m_OffsetFromBaseOfHeap = offset - heapIndex * SlabHeapSize;
+
+		return slabHeap.m_Heap.Get();
+	}
+
+	void D3D12TextureAllocator::CreateSlabHeap()
+	{
+		D3D12_HEAP_DESC heapDesc{};
+		heapDesc.SizeInBytes = SlabHeapSize;
+		heapDesc.Properties.Type = D3D12_HEAP_TYPE_DEFAULT;
+		heapDesc.Flags = D3D12_HEAP_FLAG_ALLOW_ONLY_NON_RT_DS_TEXTURES;
+
+		ComPtr<ID3D12Heap> heap;
+		ThrowIfFailed(m_Device->CreateHeap(&heapDesc, IID_PPV_ARGS(heap.GetAddressOf())));
+		heap->SetName(L"D3D12TextureAllocator SlabHeap");
+		++m_SlabHeapCount;
+
+		auto it = std::find_if(m_SlabHeaps.begin(), m_SlabHeaps.end(),
+			[](const SlabHeap& slabHeap) { return slabHeap.m_Heap == nullptr; });
+		if (it != m_SlabHeaps.end()) {
+			auto heapIndex = static_cast<std::uint32_t>(it - m_SlabHeaps.begin());
+			*it = { heap, 0, 0 };
+			m_SlabAllocator.RestoreSlabs(heapIndex * SlabsPerHeap, SlabsPerHeap);
+			return;
+		}
+		m_SlabHeaps.push_back({ heap, 0, 0 });
+		m_SlabAllocator.AddSlabs(SlabsPerHeap);
 	}
 
-	D3D12RenderTargetAllocator::D3D12RenderTargetAllocator(ID3D12Device* device)
+	void D3D12TextureAllocator::TrimSlabHeaps()
+	{
+		// 堆中的分配在围栏完成后才会被回收，因此没有存活分配的堆已不再被 GPU 使用
+		for (std::uint32_t i = 0; i < m_SlabHeaps.size(); ++i) {
+			auto& slabHeap = m_SlabHeaps[i];
+			if (slabHeap.m_Heap == nullptr) continue;
+			if (slabHeap.m_LiveAllocations > 0) {
+				slabHeap.m_IdleFrames = 0;
+				continue;
+			}
+			if (slabHeap.m_IdleFrames++ >= m_TrimIdleFrames &&
+				m_SlabAllocator.ReleaseSlabs(i * SlabsPerHeap, SlabsPerHeap)) {
+				slabHeap.m_Heap = nullptr;
+				--m_SlabHeapCount;
+			}
+		}
+	}
+
+	D3D12RenderTargetAllocator::D3D12RenderTargetAllocator(
+		ID3D12Device* device,
+		IFence* fence,
+		std::size_t poolSize)
 	:m_Device(device) {
 		D3D12BuddyAllocator::AllocatorInitData initData{};
 		initData.m_HeapFlags = D3D12_HEAP_FLAG_ALLOW_ONLY_RT_DS_TEXTURES;
@@ -381,7 +597,7 @@ namespace DSM {
 		initData.m_ResourceFlags = D3D12_RESOURCE_FLAG_ALLOW_DEPTH_STENCIL | D3D12_RESOURCE_FLAG_ALLOW_RENDER_TARGET;
 		initData.m_Strategy = D3D12BuddyAllocator::AllocationStrategy::PlacedResource;
 
-		m_Allocator = std::make_unique<D3D12MultiBuddyAllocator>(m_Device.Get(), initData);
+		m_Allocator = std::make_unique<D3D12MultiBuddyAllocator>(m_Device.Get(), initData, fence, poolSize);
 	}
 
 	void D3D12RenderTargetAllocator::Allocate(
@@ -392,7 +608,9 @@ namespace DSM {
 	{
 		// 获取在堆中的偏移
 		auto texInfo = m_Device->GetResourceAllocationInfo(0, 1, &textureDesc);
-		m_Allocator->Allocate(texInfo.SizeInBytes, D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT, resourceLocation);
+		if (!m_Allocator->Allocate(texInfo.SizeInBytes, D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT, resourceLocation)) {
+			ThrowIfFailed(E_OUTOFMEMORY);
+		}
 
 		// 在堆中分配资源
 		ComPtr<ID3D12Resource> resource;
@@ -417,4 +635,132 @@ namespace DSM {
 	{
 		m_Allocator->ClearUpAllocations();
 	}
+
+	AllocatorStats D3D12RenderTargetAllocator::GetStats() const
+	{
+		AllocatorStats stats{};
+		stats.m_Name = "RenderTarget";
+		m_Allocator->GetStats(stats);
+		return stats;
+	}
+
+	D3D12UploadRingBuffer::D3D12UploadRingBuffer(ID3D12Device* device, IFence* fence, std::size_t byteSize)
+		:m_RingAllocator(byteSize), m_Fence(fence), m_Device(device) {
+		assert(m_Device != nullptr && m_Fence != nullptr);
+
+		D3D12_HEAP_PROPERTIES heapProper{};
+		heapProper.Type = D3D12_HEAP_TYPE_UPLOAD;
+
+		D3D12_RESOURCE_DESC resourceDesc{};
+		resourceDesc.Dimension = D3D12_RESOURCE_DIMENSION_BUFFER;
+		resourceDesc.Flags = D3D12_RESOURCE_FLAG_NONE;
+		resourceDesc.Width = byteSize;
+		resourceDesc.Height = 1;
+		resourceDesc.DepthOrArraySize = 1;
+		resourceDesc.MipLevels = 1;
+		resourceDesc.SampleDesc = { 1,0 };
+		resourceDesc.Layout = D3D12_TEXTURE_LAYOUT_ROW_MAJOR;
+
+		ComPtr<ID3D12Resource> resource;
+		ThrowIfFailed(m_Device->CreateCommittedResource(
+			&heapProper,
+			D3D12_HEAP_FLAG_NONE,
+			&resourceDesc,
+			D3D12_RESOURCE_STATE_GENERIC_READ,
+			nullptr,
+			IID_PPV_ARGS(resource.GetAddressOf())));
+		resource->SetName(L"D3D12UploadRingBuffer");
+		m_Resource = std::make_unique<D3D12Resource>(resource.Get(), D3D12_RESOURCE_STATE_GENERIC_READ);
+
+		// 整个生命周期保持映射
+		m_Resource->Map();
+	}
+
+	D3D12UploadRingBuffer::~D3D12UploadRingBuffer()
+	{
+		if (m_Resource != nullptr) {
+			m_Resource->Unmap();
+		}
+	}
+
+	bool D3D12UploadRingBuffer::Allocate(
+		std::uint32_t size,
+		std::uint32_t alignment,
+		D3D12ResourceLocation& resourceLocation)
+	{
+		std::uint64_t offset;
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			offset = m_RingAllocator.Allocate(size, alignment);
+		}
+		if (offset == RingAllocator::InvalidOffset) {
+			return false;
+		}
+
+		resourceLocation.m_ResourceLocationType = D3D12ResourceLocation::ResourceLocationType::SubAllocation;
+		resourceLocation.m_Allocator = nullptr;
+		resourceLocation.m_UnderlyingResource = m_Resource.get();
+		resourceLocation.m_OffsetFromBaseOfResource = offset;
+		resourceLocation.m_GPUVirtualAddress = m_Resource->m_GPUVirtualAddress + offset;
+		resourceLocation.m_MappedBaseAddress = static_cast<char*>(m_Resource->m_MappedBaseAddress) + offset;
+
+		return true;
+	}
+
+	void D3D12UploadRingBuffer::FinishFrame()
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		m_RingAllocator.FinishFrame(m_Fence->GetCurrentValue());
+	}
+
+	void D3D12UploadRingBuffer::ClearUpAllocations()
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		m_RingAllocator.Retire(m_Fence->GetCompletedValue());
+	}
+
+	std::uint64_t D3D12UploadRingBuffer::GetFrameCount() const noexcept
+	{
+		return m_RingAllocator.GetFrameCount();
+	}
+
+	D3D12UploadRingSlice::D3D12UploadRingSlice(D3D12UploadRingBuffer* ringBuffer, std::uint32_t sliceSize)
+		:m_RingBuffer(ringBuffer), m_SliceSize(sliceSize) {
+		assert(m_RingBuffer != nullptr && m_SliceSize > 0);
+	}
+
+	bool D3D12UploadRingSlice::Allocate(
+		std::uint32_t size,
+		std::uint32_t alignment,
+		D3D12ResourceLocation& resourceLocation)
+	{
+		assert(alignment <= SliceAlignment && SliceAlignment % (std::max)(alignment, 1u) == 0);
+		if (size > m_SliceSize) {
+			return m_RingBuffer->Allocate(size, alignment, resourceLocation);
+		}
+
+		auto offset = static_cast<std::uint32_t>(D3DUtil::AlignArbitrary(m_Offset, (std::max)(alignment, 1u)));
+		if (!m_HasSlice || offset + size > m_SliceSize) {
+			if (!m_RingBuffer->Allocate(m_SliceSize, SliceAlignment, m_Slice)) {
+				m_HasSlice = false;
+				return false;
+			}
+			m_HasSlice = true;
+			offset = 0;
+		}
+		m_Offset = offset + size;
+
+		resourceLocation = m_Slice;
+		resourceLocation.m_OffsetFromBaseOfResource += offset;
+		resourceLocation.m_GPUVirtualAddress += offset;
+		resourceLocation.m_MappedBaseAddress = static_cast<char*>(m_Slice.m_MappedBaseAddress) + offset;
+
+		return true;
+	}
+
+	void D3D12UploadRingSlice::Reset() noexcept
+	{
+		m_HasSlice = false;
+		m_Offset = 0;
+	}
 }
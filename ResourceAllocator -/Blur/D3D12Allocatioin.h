@@ -2,12 +2,21 @@
 #ifndef __D3D12__ALLOCATOR__H__
 #define __D3D12__ALLOCATOR__H__
 
-#include <queue>
-#include <set>
 #include "D3D12Resource.h"
+#include "AllocatorStats.h"
+#include "BuddyAllocator.h"
+#include "BuddyPoolSet.h"
+#include "DeferredDeletionQueue.h"
+#include "Fence.h"
+#include "RingAllocator.h"
+#include "SlabAllocator.h"
+#include "TexturePlacement.h"
+#include <mutex>
 
 namespace DSM {
 	// 使用 Buddy System 的显存管理
+	// 簿记按 m_MaxBlockSize / m_MinBlockSize 个最小单位分配，默认 512MB、256B 粒度时每个分配器约占 16.5MB 的 CPU 内存，
+	// 小块请求路由到较小的分配器可减少这部分开销
 	class D3D12BuddyAllocator
 	{
 	public:
@@ -28,48 +37,62 @@ namespace DSM {
 			D3D12_RESOURCE_FLAGS m_ResourceFlags;   // 分配策略为 ManualSubAllocation 时使用
 		};
 
+		static constexpr std::size_t DefaultPoolSize = 1024 * 1024 * 512;
+
 	public:
+		// backingSize 为实际创建的堆或资源的大小，为 0 时与向下取整后的 maxBlockSize 相同
+		// 专用的分配器只会分配偏移为 0 的一块，因此只需创建请求的大小
 		D3D12BuddyAllocator(ID3D12Device* device,
 			const AllocatorInitData& initData,
+			IFence* fence,
 			std::size_t minBlockSize = 256,
-			std::size_t maxBlockSize = DefaultPoolSize);
+			std::size_t maxBlockSize = DefaultPoolSize,
+			std::size_t backingSize = 0);
 		~D3D12BuddyAllocator();
 
 		// 分配内存
 		bool Allocate(std::uint32_t size, std::uint32_t alignment, D3D12ResourceLocation& resourceLocation);
-		// 释放内存
+		// 释放内存，内存块会在当前帧的围栏完成后才被回收
 		void Deallocate(D3D12ResourceLocation& resourceLocation);
-		void ClearUpAllocations();
+		// 回收所有围栏已完成的内存块，返回回收的数量
+		std::size_t ClearUpAllocations();
 		ID3D12Heap* GetHeap() const;
 		AllocationStrategy GetAllocationStrategy() const;
+		// 指定层级的块的大小
+		std::size_t GetBlockSize(std::uint32_t order) const;
+		std::size_t GetReservedSize() const;
+		std::size_t GetBackingSize() const;
+		// 没有存活的分配，包括等待围栏的内存块
+		bool IsEmpty() const;
+		void GetStats(BuddyPoolStats& stats) const;
+		const BuddyAllocator& GetBlockAllocator() const;
+
+		// 资源在块中按 alignment 对齐后的偏移，资源需同时位于块与堆中，否则返回 false
+		// 专用分配器的实际大小可能小于块的大小
+		static bool GetAlignedOffset(
+			std::size_t blockOffset,
+			std::size_t blockSize,
+			std::size_t backingSize,
+			std::uint32_t size,
+			std::uint32_t alignment,
+			std::size_t& alignedOffset);
 
 	private:
-		// 实际大小获取单位大小
-		std::size_t SizeToUnitSize(std::size_t size);
-		// 单位大小获取层级
-		std::uint32_t UnitSizeToOrder(std::size_t unitSize);
-		// 层级获取单位大小
-		std::size_t OrderToUnitSize(std::uint32_t order);
-		// 单位大小获取实际大小
-		std::size_t UnitSizeToSize(std::size_t unitSize);
-		std::size_t GetBuddyOffset(const std::size_t& offset, const std::size_t& size);
-		// 获取偏移量并重新分割块的大小
-		std::size_t AllocBlock(std::uint32_t order);
 		void DeallocateInternal(D3D12BuddyBlockData& blockData);
-		void DeallocateBlock(std::size_t offset, std::uint32_t order);
 
 	private:
-		static constexpr std::size_t DefaultPoolSize = 1024 * 1024 * 512;
-
 		const AllocatorInitData m_InitData;     // 初始化数据
 
 		const std::size_t m_MinBlockSize;     // 内存块的最小大小
 		const std::size_t m_MaxBlockSize;     // 内存块的最大大小
 
-		std::uint32_t m_MaxOrder;             // 最大层级
+		BuddyAllocator m_BlockAllocator;        // 空闲块的簿记
+		const std::size_t m_BackingSize;      // 堆或资源的实际大小
+		DeferredDeletionQueue<D3D12BuddyBlockData> m_DeferredDeletionQueue;    // 延迟删除队列
+		IFence* m_Fence = nullptr;
 
-		std::vector<std::set<std::uint32_t>> m_FreeBlock;
-		std::queue<D3D12BuddyBlockData> m_DeferredDeletionQueue;    // 延迟删除队列
+		std::uint64_t m_RequestedBytes = 0;     // 存活的分配请求的大小
+		std::uint64_t m_LiveAllocations = 0;
 
 		Microsoft::WRL::ComPtr<ID3D12Device> m_Device;
 
@@ -77,30 +100,70 @@ namespace DSM {
 		Microsoft::WRL::ComPtr<ID3D12Heap> m_Heap = nullptr;
 	};
 
+	// 按请求大小将分配路由到不同类别的分配器，并回收长时间空闲的分配器
+	// 路由、空位复用与回收由 BuddyPoolSet 完成，此处只负责创建 D3D12 分配器
 	class D3D12MultiBuddyAllocator
 	{
 	public:
-		D3D12MultiBuddyAllocator(ID3D12Device* device, D3D12BuddyAllocator::AllocatorInitData initData);
-		void Allocate(std::uint32_t size, std::uint32_t alignment, D3D12ResourceLocation& resourceLocation);
+		using PoolSet = BuddyPoolSet<D3D12BuddyAllocator>;
+		using SizeClass = PoolSet::SizeClass;
+
+		static constexpr std::size_t SmallAllocationSize = PoolSet::SmallAllocationSize;
+		static constexpr std::size_t MinSmallPoolSize = PoolSet::MinSmallPoolSize;
+		static constexpr std::uint32_t DefaultTrimIdleFrames = PoolSet::DefaultTrimIdleFrames;
+
+	public:
+		D3D12MultiBuddyAllocator(ID3D12Device* device,
+			D3D12BuddyAllocator::AllocatorInitData initData,
+			IFence* fence,
+			std::size_t poolSize = D3D12BuddyAllocator::DefaultPoolSize,
+			std::uint32_t trimIdleFrames = DefaultTrimIdleFrames);
+		// 新建的分配器与专用的分配器都无法满足时返回 false
+		bool Allocate(std::uint32_t size, std::uint32_t alignment, D3D12ResourceLocation& resourceLocation);
 		void Deallocate(D3D12ResourceLocation& resourceLocation);
+		// 回收围栏已完成的内存块，并释放空闲次数超过 trimIdleFrames 的分配器
+		// 通常每帧调用一次，因此空闲次数近似为空闲的帧数
 		void ClearUpAllocations();
+		void GetStats(AllocatorStats& stats) const;
+
+		void SetTrimIdleFrames(std::uint32_t trimIdleFrames) noexcept;
+		SizeClass GetSizeClass(std::size_t size) const noexcept;
+		std::size_t GetPoolCount() const noexcept;
+
+		// 以下接口供显存整理使用，索引与 D3D12ResourceLocation::m_PoolIndex 一致
+		std::uint32_t GetPoolSlotCount() const noexcept;
+		// 已被回收的位置返回 nullptr
+		const D3D12BuddyAllocator* GetPool(std::uint32_t poolIndex) const noexcept;
+		SizeClass GetPoolSizeClass(std::uint32_t poolIndex) const noexcept;
+		// 只在指定的分配器中分配
+		bool AllocateInPool(std::uint32_t poolIndex, std::uint32_t size, std::uint32_t alignment, D3D12ResourceLocation& resourceLocation);
+
+	private:
+		std::shared_ptr<D3D12BuddyAllocator> CreatePool(const BuddyPoolDesc& desc);
 
 	private:
-		std::vector<std::shared_ptr<D3D12BuddyAllocator>> m_BuddyAllocators;
 		D3D12BuddyAllocator::AllocatorInitData m_InitData;
+		IFence* m_Fence = nullptr;
 		Microsoft::WRL::ComPtr<ID3D12Device> m_Device = nullptr;
+
+		PoolSet m_Pools;
 	};
 
 	class D3D12DefaultBufferAllocator
 	{
 	public:
-		D3D12DefaultBufferAllocator(ID3D12Device* device);
+		D3D12DefaultBufferAllocator(ID3D12Device* device,
+			IFence* fence,
+			std::size_t poolSize = D3D12BuddyAllocator::DefaultPoolSize);
 		void AllocateDefaultBuffer(
 			std::size_t byteSize,
 			std::uint32_t alignment,
 			D3D12ResourceLocation& resourceLocation);
 		void Deallocate(D3D12ResourceLocation& resourceLocation);
 		void ClearUpAllocations();
+		AllocatorStats GetStats() const;
+		// 用于显存整理
+		D3D12MultiBuddyAllocator* GetBuddyAllocator() const noexcept;
 
 	private:
 		std::unique_ptr<D3D12MultiBuddyAllocator> m_DefaultBufferAllocator;
@@ -110,23 +173,35 @@ namespace DSM {
 	class D3D12UploadBufferAllocator
 	{
 	public:
-		D3D12UploadBufferAllocator(ID3D12Device* device);
+		D3D12UploadBufferAllocator(ID3D12Device* device,
+			IFence* fence,
+			std::size_t poolSize = D3D12BuddyAllocator::DefaultPoolSize);
 		void AllocateUploadBuffer(
 			std::size_t byteSize,
 			std::uint32_t alignment,
 			D3D12ResourceLocation& resourceLocation);
 		void Deallocate(D3D12ResourceLocation& resourceLocation);
 		void ClearUpAllocations();
+		AllocatorStats GetStats() const;
 
 	private:
 		std::unique_ptr<D3D12MultiBuddyAllocator> m_UploadBufferAllocator;
 		Microsoft::WRL::ComPtr<ID3D12Device> m_Device = nullptr;
 	};
 
+	// 小纹理优先使用 4KB 对齐并放入 Slab 中，其余纹理使用 Buddy 分配器
 	class D3D12TextureAllocator
 	{
 	public:
-		D3D12TextureAllocator(ID3D12Device* device);
+		static constexpr std::size_t SlabHeapSize = 1024 * 1024 * 4;
+		static constexpr std::size_t SlabSize = 1024 * 256;
+		static constexpr std::size_t MaxSlabTextureSize = 1024 * 64;
+
+	public:
+		D3D12TextureAllocator(ID3D12Device* device,
+			IFence* fence,
+			std::size_t poolSize = D3D12BuddyAllocator::DefaultPoolSize,
+			std::uint32_t trimIdleFrames = D3D12MultiBuddyAllocator::DefaultTrimIdleFrames);
 		void AllocateTexture(
 			const D3D12_RESOURCE_DESC& textureDesc,
 			const D3D12_RESOURCE_STATES& textureState,
@@ -134,16 +209,57 @@ namespace DSM {
 			const D3D12_CLEAR_VALUE* clearValue = nullptr);
 		void Deallocate(D3D12ResourceLocation& resourceLocation);
 		void ClearUpAllocations();
+		AllocatorStats GetStats() const;
+		// 大纹理所在的 Buddy 分配器，用于显存整理
+		D3D12MultiBuddyAllocator* GetBuddyAllocator() const noexcept;
+
+	private:
+		struct SlabBlockData
+		{
+			SlabAllocator::Allocation m_Allocation;
+			std::uint64_t m_ActualUseSize;
+			std::shared_ptr<D3D12Resource> m_PlacedResource;
+		};
+
+		// 被释放的堆留下空位，使 Slab 的地址空间保持不变
+		struct SlabHeap
+		{
+			Microsoft::WRL::ComPtr<ID3D12Heap> m_Heap;
+			std::uint32_t m_LiveAllocations = 0;
+			std::uint32_t m_IdleFrames = 0;
+		};
+
+		static constexpr std::uint32_t SlabsPerHeap = static_cast<std::uint32_t>(SlabHeapSize / SlabSize);
+
+		// 从 Slab 中分配，返回所在的堆
+		ID3D12Heap* AllocateFromSlab(const TexturePlacementInfo& placement, D3D12ResourceLocation& resourceLocation);
+		// 新建一个 Slab 堆，优先复用已释放的空位
+		void CreateSlabHeap();
+		// 释放空闲次数超过 m_TrimIdleFrames 的 Slab 堆
+		void TrimSlabHeaps();
 
 	private:
 		std::unique_ptr<D3D12MultiBuddyAllocator> m_TextureAllocator;
+
+		SlabAllocator m_SlabAllocator;
+		std::vector<SlabHeap> m_SlabHeaps;
+		std::size_t m_SlabHeapCount = 0;
+		std::uint32_t m_TrimIdleFrames;
+		DeferredDeletionQueue<SlabBlockData> m_SlabDeletionQueue;
+		std::uint64_t m_SlabRequestedBytes = 0;
+		std::uint64_t m_SlabLiveAllocations = 0;
+
+		ResourceAllocationInfoProvider m_AllocationInfoProvider;
+		IFence* m_Fence = nullptr;
 		Microsoft::WRL::ComPtr<ID3D12Device> m_Device = nullptr;
 	};
 
 	class D3D12RenderTargetAllocator
 	{
 	public:
-		D3D12RenderTargetAllocator(ID3D12Device* device);
+		D3D12RenderTargetAllocator(ID3D12Device* device,
+			IFence* fence,
+			std::size_t poolSize = D3D12BuddyAllocator::DefaultPoolSize);
 		void Allocate(
 			const D3D12_RESOURCE_DESC& textureDesc,
 			const D3D12_RESOURCE_STATES& textureState,
@@ -151,11 +267,65 @@ namespace DSM {
 			const D3D12_CLEAR_VALUE* clearValue = nullptr);
 		void Deallocate(D3D12ResourceLocation& resourceLocation);
 		void ClearUpAllocations();
+		AllocatorStats GetStats() const;
 
 	private:
 		std::unique_ptr<D3D12MultiBuddyAllocator> m_Allocator;
 		Microsoft::WRL::ComPtr<ID3D12Device> m_Device = nullptr;
 	};
+
+	// 持久映射的环形上传缓冲区，用于每帧临时的常量与动态数据
+	class D3D12UploadRingBuffer
+	{
+	public:
+		static constexpr std::size_t DefaultRingSize = 1024 * 1024 * 32;
+
+	public:
+		D3D12UploadRingBuffer(ID3D12Device* device, IFence* fence, std::size_t byteSize = DefaultRingSize);
+		~D3D12UploadRingBuffer();
+
+		// 分配只在当前帧有效的内存，空间不足时返回 false，可在多个线程中调用
+		bool Allocate(std::uint32_t size, std::uint32_t alignment, D3D12ResourceLocation& resourceLocation);
+		// 结束当前帧的分配，需在发出围栏前调用
+		void FinishFrame();
+		// 回收围栏已完成的帧
+		void ClearUpAllocations();
+		// 已经结束的帧的数量，可用于判断分配是否属于当前帧
+		std::uint64_t GetFrameCount() const noexcept;
+
+	private:
+		RingAllocator m_RingAllocator;
+		IFence* m_Fence = nullptr;
+		std::mutex m_Mutex;
+
+		Microsoft::WRL::ComPtr<ID3D12Device> m_Device = nullptr;
+		std::unique_ptr<D3D12Resource> m_Resource = nullptr;
+	};
+
+	// 从环形上传缓冲区中取出一段供单个线程使用，段内线性分配不需要加锁
+	// 段只在当前帧有效，每帧开始录制前调用 Reset
+	class D3D12UploadRingSlice
+	{
+	public:
+		static constexpr std::uint32_t DefaultSliceSize = 1024 * 64;
+		static constexpr std::uint32_t SliceAlignment = 256;
+
+	public:
+		D3D12UploadRingSlice(D3D12UploadRingBuffer* ringBuffer, std::uint32_t sliceSize = DefaultSliceSize);
+
+		// 对齐不能超过 SliceAlignment，大于段的分配直接从环形缓冲区中分配
+		bool Allocate(std::uint32_t size, std::uint32_t alignment, D3D12ResourceLocation& resourceLocation);
+		// 丢弃当前段剩余的空间
+		void Reset() noexcept;
+
+	private:
+		D3D12UploadRingBuffer* m_RingBuffer = nullptr;
+		std::uint32_t m_SliceSize = 0;
+
+		D3D12ResourceLocation m_Slice{};
+		std::uint32_t m_Offset = 0;
+		bool m_HasSlice = false;
+	};
 }
 
 
@@ -0,0 +1,117 @@
+#include "D3D12CommandListState.h"
+#include <algorithm>
+#include <cassert>
+
+namespace DSM {
+	void D3D12CommandListState::Reset(ID3D12GraphicsCommandList* cmdList) noexcept
+	{
+		m_CmdList = cmdList;
+		m_Tracker.Reset();
+	}
+
+	ID3D12GraphicsCommandList* D3D12CommandListState::GetCommandList() const noexcept
+	{
+		return m_CmdList;
+	}
+
+	void D3D12CommandListState::SetPipelineState(ID3D12PipelineState* pipelineState)
+	{
+		assert(m_CmdList != nullptr);
+
+		if (m_Tracker.SetPipelineState(pipelineState)) {
+			m_CmdList->SetPipelineState(pipelineState);
+		}
+	}
+
+	void D3D12CommandListState::SetRootSignature(ID3D12RootSignature* rootSignature, bool isCompute)
+	{
+		assert(m_CmdList != nullptr);
+
+		if (!m_Tracker.SetRootSignature(rootSignature, isCompute)) {
+			return;
+		}
+		if (isCompute) {
+			m_CmdList->SetComputeRootSignature(rootSignature);
+		}
+		else {
+			m_CmdList->SetGraphicsRootSignature(rootSignature);
+		}
+	}
+
+	void D3D12CommandListState::SetDescriptorHeaps(std::uint32_t numHeaps, ID3D12DescriptorHeap* const* heaps)
+	{
+		assert(m_CmdList != nullptr);
+		assert(numHeaps > 0 && numHeaps <= CommandListStateTracker::MaxDescriptorHeaps);
+
+		std::array<const void*, CommandListStateTracker::MaxDescriptorHeaps> trackedHeaps{};
+		std::copy(heaps, heaps + numHeaps, trackedHeaps.begin());
+		if (m_Tracker.SetDescriptorHeaps(numHeaps, trackedHeaps.data())) {
+			m_CmdList->SetDescriptorHeaps(numHeaps, heaps);
+		}
+	}
+
+	void D3D12CommandListState::SetRootConstantBufferView(
+		std::uint32_t rootIndex,
+		D3D12_GPU_VIRTUAL_ADDRESS gpuAddress,
+		bool isCompute)
+	{
+		assert(m_CmdList != nullptr);
+
+		if (!m_Tracker.SetRootConstantBufferView(rootIndex, gpuAddress, isCompute)) {
+			return;
+		}
+		if (isCompute) {
+			m_CmdList->SetComputeRootConstantBufferView(rootIndex, gpuAddress);
+		}
+		else {
+			m_CmdList->SetGraphicsRootConstantBufferView(rootIndex, gpuAddress);
+		}
+	}
+
+	void D3D12CommandListState::SetRootDescriptorTable(
+		std::uint32_t rootIndex,
+		D3D12_GPU_DESCRIPTOR_HANDLE gpuHandle,
+		bool isCompute)
+	{
+		assert(m_CmdList != nullptr);
+
+		if (!m_Tracker.SetRootDescriptorTable(rootIndex, gpuHandle.ptr, isCompute)) {
+			return;
+		}
+		if (isCompute) {
+			m_CmdList->SetComputeRootDescriptorTable(rootIndex, gpuHandle);
+		}
+		else {
+			m_CmdList->SetGraphicsRootDescriptorTable(rootIndex, gpuHandle);
+		}
+	}
+
+	void D3D12CommandListState::SetRoot32BitConstants(
+		std::uint32_t rootIndex,
+		std::uint32_t num32BitValues,
+		const void* data,
+		bool isCompute)
+	{
+		assert(m_CmdList != nullptr);
+
+		if (!m_Tracker.SetRoot32BitConstants(rootIndex, num32BitValues, data, isCompute)) {
+			return;
+		}
+		if (isCompute) {
+			m_CmdList->SetComputeRoot32BitConstants(rootIndex, num32BitValues, data, 0);
+		}
+		else {
+			m_CmdList->SetGraphicsRoot32BitConstants(rootIndex, num32BitValues, data, 0);
+		}
+	}
+
+	const CommandListStateStats& D3D12CommandListState::GetStats() const noexcept
+	{
+		return m_Tracker.GetStats();
+	}
+
+	void D3D12CommandListState::ResetStats() noexcept
+	{
+		m_Tracker.ResetStats();
+	}
+}
@@ -0,0 +1,42 @@
+#pragma once
+#ifndef __D3D12COMMANDLISTSTATE__H__
+#define __D3D12COMMANDLISTSTATE__H__
+
+#include "CommandListStateTracker.h"
+#include <d3d12.h>
+
+namespace DSM {
+	// 记录一个命令列表上最后设置的 PSO、根签名、描述符堆与根参数，只提交发生变化的部分
+	// 是否提交由 CommandListStateTracker 判断，本类只负责写入命令列表
+	// 命令列表重置或被外部代码修改状态后需调用 Reset
+	class D3D12CommandListState
+	{
+	public:
+		D3D12CommandListState() = default;
+		D3D12CommandListState(const D3D12CommandListState&) = delete;
+		D3D12CommandListState& operator=(const D3D12CommandListState&) = delete;
+
+		// 清空记录的状态，之后的设置都会提交，统计数据保留
+		void Reset(ID3D12GraphicsCommandList* cmdList) noexcept;
+		ID3D12GraphicsCommandList* GetCommandList() const noexcept;
+
+		void SetPipelineState(ID3D12PipelineState* pipelineState);
+		// 根签名改变时，对应管线上的根参数全部失效
+		void SetRootSignature(ID3D12RootSignature* rootSignature, bool isCompute);
+		// 描述符堆改变时，所有描述符表失效
+		void SetDescriptorHeaps(std::uint32_t numHeaps, ID3D12DescriptorHeap* const* heaps);
+
+		void SetRootConstantBufferView(std::uint32_t rootIndex, D3D12_GPU_VIRTUAL_ADDRESS gpuAddress, bool isCompute);
+		void SetRootDescriptorTable(std::uint32_t rootIndex, D3D12_GPU_DESCRIPTOR_HANDLE gpuHandle, bool isCompute);
+		void SetRoot32BitConstants(std::uint32_t rootIndex, std::uint32_t num32BitValues, const void* data, bool isCompute);
+
+		const CommandListStateStats& GetStats() const noexcept;
+		void ResetStats() noexcept;
+
+	private:
+		ID3D12GraphicsCommandList* m_CmdList = nullptr;
+		CommandListStateTracker m_Tracker;
+	};
+}
+
+#endif
@@ -0,0 +1,161 @@
+#include "D3D12Defragmenter.h"
+#include "D3DUtil.h"
+
+using Microsoft::WRL::ComPtr;
+
+namespace DSM {
+	D3D12Defragmenter::D3D12Defragmenter(ID3D12Device* device, D3D12MultiBuddyAllocator* allocator, IFence* fence)
+		:m_Device(device), m_Allocator(allocator), m_Fence(fence) {
+		assert(m_Device != nullptr && m_Allocator != nullptr && m_Fence != nullptr);
+	}
+
+	void D3D12Defragmenter::Register(D3D12ResourceLocation* location, D3D12_RESOURCE_STATES state, MovedCallback onMoved)
+	{
+		assert(location != nullptr);
+		m_Registrations[location] = { state, std::move(onMoved), m_NextGeneration++ };
+	}
+
+	void D3D12Defragmenter::Unregister(D3D12ResourceLocation* location)
+	{
+		// 进行中的移动在完成时发现未注册，会直接释放新的位置
+		m_Registrations.erase(location);
+	}
+
+	bool D3D12Defragmenter::BeginDefragment()
+	{
+		if (!IsIdle()) {
+			return false;
+		}
+
+		// 只整理同一类别的分配器，专用的分配器本身只有一块
+		using SizeClass = D3D12MultiBuddyAllocator::SizeClass;
+		for (auto sizeClass : { SizeClass::Small, SizeClass::Normal }) {
+			std::vector<DefragPlanner::Pool> pools;
+			std::unordered_map<std::uint32_t, std::size_t> poolMap;
+			for (std::uint32_t i = 0; i < m_Allocator->GetPoolSlotCount(); ++i) {
+				auto pool = m_Allocator->GetPool(i);
+				if (pool == nullptr || m_Allocator->GetPoolSizeClass(i) != sizeClass) continue;
+				poolMap[i] = pools.size();
+				pools.push_back({ i, pool->GetBlockAllocator(), {} });
+			}
+			if (pools.size() < 2) continue;
+
+			for (const auto& [location, registration] : m_Registrations) {
+				auto it = poolMap.find(location->m_PoolIndex);
+				if (it == poolMap.end() || m_Allocator->GetPool(location->m_PoolIndex) != location->m_Allocator) continue;
+
+				const auto& blockData = location->m_BlockData;
+				pools[it->second].m_Blocks.push_back({
+					reinterpret_cast<std::uint64_t>(location), blockData.m_Offset, blockData.m_Order });
+			}
+
+			auto moves = DefragPlanner::Plan(std::move(pools));
+			m_PlannedMoves.insert(m_PlannedMoves.end(), moves.begin(), moves.end());
+		}
+
+		return !m_PlannedMoves.empty();
+	}
+
+	void D3D12Defragmenter::Update(ID3D12GraphicsCommandList* cmdList, std::uint64_t byteBudget)
+	{
+		RetireMoves();
+
+		// 至少发出一次移动，避免大于预算的块永远无法移动
+		std::uint64_t issuedBytes = 0;
+		while (!m_PlannedMoves.empty() && issuedBytes < byteBudget) {
+			auto move = m_PlannedMoves.front();
+			m_PlannedMoves.pop_front();
+			if (IssueMove(cmdList, move)) {
+				issuedBytes += move.m_Size;
+			}
+		}
+	}
+
+	bool D3D12Defragmenter::IsIdle() const noexcept
+	{
+		return m_PlannedMoves.empty() && m_PendingMoves.Empty();
+	}
+
+	bool D3D12Defragmenter::IssueMove(ID3D12GraphicsCommandList* cmdList, const DefragPlanner::Move& move)
+	{
+		// 规划之后资源可能已被注销或释放
+		auto location = reinterpret_cast<D3D12ResourceLocation*>(move.m_Id);
+		auto it = m_Registrations.find(location);
+		if (it == m_Registrations.end() || location->m_PoolIndex != move.m_SrcPool) {
+			return false;
+		}
+		const auto state = it->second.m_State;
+		const auto& oldLocation = *location;
+		const auto strategy = oldLocation.m_Allocator->GetAllocationStrategy();
+		const auto alignment = strategy == D3D12BuddyAllocator::AllocationStrategy::PlacedResource ?
+			D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT : 0;
+
+		// 规划之后目标可能已被新的分配占用，此时放弃该次移动
+		D3D12ResourceLocation newLocation{};
+		if (!m_Allocator->AllocateInPool(move.m_DstPool, oldLocation.m_BlockData.m_ActualUseSize, alignment, newLocation)) {
+			return false;
+		}
+
+		auto oldResource = oldLocation.m_UnderlyingResource->m_Resource.Get();
+		if (strategy == D3D12BuddyAllocator::AllocationStrategy::PlacedResource) {
+			auto desc = oldResource->GetDesc();
+			ComPtr<ID3D12Resource> resource;
+			ThrowIfFailed(m_Device->CreatePlacedResource(newLocation.m_Allocator->GetHeap(),
+				newLocation.m_OffsetFromBaseOfHeap,
+				&desc,
+				D3D12_RESOURCE_STATE_COPY_DEST,
+				nullptr,
+				IID_PPV_ARGS(resource.GetAddressOf())));
+			auto newResource = std::make_shared<D3D12Resource>(resource.Get(), state);
+			newLocation.m_UnderlyingResource = newResource.get();
+			newLocation.m_BlockData.m_PlacedResource = newResource;
+			newLocation.m_GPUVirtualAddress = newResource->m_GPUVirtualAddress;
+
+			auto transition = [](ID3D12Resource* resource, D3D12_RESOURCE_STATES before, D3D12_RESOURCE_STATES after) {
+				D3D12_RESOURCE_BARRIER barrier{};
+				barrier.Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
+				barrier.Transition = { resource, D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES, before, after };
+				return barrier;
+				};
+
+			D3D12_RESOURCE_BARRIER beforeCopy = transition(oldResource, state, D3D12_RESOURCE_STATE_COPY_SOURCE);
+			cmdList->ResourceBarrier(1, &beforeCopy);
+			cmdList->CopyResource(resource.Get(), oldResource);
+			D3D12_RESOURCE_BARRIER afterCopy[] = {
+				transition(oldResource, D3D12_RESOURCE_STATE_COPY_SOURCE, state),
+				transition(resource.Get(), D3D12_RESOURCE_STATE_COPY_DEST, state)
+			};
+			cmdList->ResourceBarrier(_countof(afterCopy), afterCopy);
+		}
+		else {
+			// 缓冲区处于 COMMON 状态，复制时会隐式提升
+			cmdList->CopyBufferRegion(
+				newLocation.m_UnderlyingResource->m_Resource.Get(),
+				newLocation.m_OffsetFromBaseOfResource,
+				oldResource,
+				oldLocation.m_OffsetFromBaseOfResource,
+				oldLocation.m_BlockData.m_ActualUseSize);
+		}
+
+		m_PendingMoves.Push(m_Fence->GetCurrentValue(), PendingMove{ location, it->second.m_Generation, std::move(newLocation) });
+		return true;
+	}
+
+	void D3D12Defragmenter::RetireMoves()
+	{
+		m_PendingMoves.Retire(m_Fence->GetCompletedValue(), [this](PendingMove& move) {
+			auto it = m_Registrations.find(move.m_Location);
+			if (it == m_Registrations.end() || it->second.m_Generation != move.m_Generation) {
+				m_Allocator->Deallocate(move.m_NewLocation);
+				return;
+			}
+
+			// 旧的位置仍可能被执行中的帧使用，交给分配器延迟释放
+			m_Allocator->Deallocate(*move.m_Location);
+			*move.m_Location = std::move(move.m_NewLocation);
+			if (it->second.m_OnMoved) {
+				it->second.m_OnMoved(*move.m_Location);
+			}
+			});
+	}
+}
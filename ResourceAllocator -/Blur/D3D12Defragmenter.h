@@ -0,0 +1,66 @@
+#pragma once
+#ifndef __D3D12DEFRAGMENTER__H__
+#define __D3D12DEFRAGMENTER__H__
+
+#include "D3D12Allocatioin.h"
+#include "DefragPlanner.h"
+#include <functional>
+#include <unordered_map>
+
+namespace DSM {
+	// 默认堆上 Buddy 分配器的增量显存整理
+	// 由 DefragPlanner 规划移动，每帧在字节预算内发出复制命令，
+	// 复制所在帧的围栏完成后更新资源的位置并通知所有者重建描述符，旧的内存块按正常的延迟释放回收
+	class D3D12Defragmenter
+	{
+	public:
+		// 资源移动后调用，所有者需要在此重建引用该资源的描述符
+		// 旧的位置在当前帧的围栏完成后才被回收，执行中的帧可能仍在读取旧资源的 Shader Visible 描述符，
+		// 因此这类描述符应写入新的位置，旧的位置同样等到当前帧的围栏完成后再复用
+		using MovedCallback = std::function<void(D3D12ResourceLocation&)>;
+
+	public:
+		D3D12Defragmenter(ID3D12Device* device, D3D12MultiBuddyAllocator* allocator, IFence* fence);
+
+		// 注册可以移动的资源，location 的地址在注销前需保持不变，释放资源前需先注销
+		// state 为资源在两次使用之间所处的状态，复制后会恢复到该状态
+		void Register(D3D12ResourceLocation* location, D3D12_RESOURCE_STATES state, MovedCallback onMoved);
+		void Unregister(D3D12ResourceLocation* location);
+
+		// 规划新的一轮整理，上一轮未完成或没有可移动的块时返回 false
+		bool BeginDefragment();
+		// 在字节预算内发出复制命令，并更新复制已完成的资源
+		void Update(ID3D12GraphicsCommandList* cmdList, std::uint64_t byteBudget);
+		bool IsIdle() const noexcept;
+
+	private:
+		struct Registration
+		{
+			D3D12_RESOURCE_STATES m_State;
+			MovedCallback m_OnMoved;
+			std::uint64_t m_Generation;     // 区分同一地址先后注册的资源
+		};
+
+		struct PendingMove
+		{
+			D3D12ResourceLocation* m_Location;
+			std::uint64_t m_Generation;
+			D3D12ResourceLocation m_NewLocation;
+		};
+
+		bool IssueMove(ID3D12GraphicsCommandList* cmdList, const DefragPlanner::Move& move);
+		void RetireMoves();
+
+	private:
+		std::unordered_map<D3D12ResourceLocation*, Registration> m_Registrations;
+		std::deque<DefragPlanner::Move> m_PlannedMoves;
+		DeferredDeletionQueue<PendingMove> m_PendingMoves;    // 等待复制完成的移动
+		std::uint64_t m_NextGeneration = 0;
+
+		D3D12MultiBuddyAllocator* m_Allocator = nullptr;
+		IFence* m_Fence = nullptr;
+		Microsoft::WRL::ComPtr<ID3D12Device> m_Device = nullptr;
+	};
+}
+
+#endif
@@ -0,0 +1,351 @@
+#include "D3D12DescriptorAllocator.h"
+#include <D3DUtil.h>
+#include <algorithm>
+
+namespace DSM {
+	D3D12DescriptorAllocator::D3D12DescriptorAllocator(ID3D12Device* device, std::uint32_t pageSize)
+		:m_Device(device), m_PageSize(pageSize) {
+		assert(m_Device != nullptr && m_PageSize > 0);
+	}
+
+	D3D12DescriptorRange D3D12DescriptorAllocator::Allocate(D3D12_DESCRIPTOR_HEAP_TYPE heapType, std::uint32_t count)
+	{
+		auto typeIndex = static_cast<std::size_t>(heapType);
+		assert(typeIndex < m_Pages.size() && count > 0);
+
+		auto& pages = m_Pages[typeIndex];
+		auto offset = DescriptorRangeAllocator::InvalidOffset;
+		std::uint32_t pageIndex = 0;
+		for (; pageIndex < pages.size(); ++pageIndex) {
+			auto& allocator = *pages[pageIndex].m_Allocator;
+			if (allocator.GetFreeCount() < count) continue;
+			if (offset = allocator.Allocate(count); offset != DescriptorRangeAllocator::InvalidOffset) break;
+		}
+
+		// 已有的页都放不下时追加新的页，超过页大小的请求单独占用一页
+		if (offset == DescriptorRangeAllocator::InvalidOffset) {
+			CreatePage(heapType, (std::max)(count, m_PageSize));
+			pageIndex = static_cast<std::uint32_t>(pages.size() - 1);
+			offset = pages[pageIndex].m_Allocator->Allocate(count);
+		}
+		assert(offset != DescriptorRangeAllocator::InvalidOffset);
+
+		D3D12DescriptorRange range{};
+		range.m_Handle = (*pages[pageIndex].m_Heap)[offset];
+		range.m_HeapType = heapType;
+		range.m_PageIndex = pageIndex;
+		range.m_Offset = offset;
+		range.m_Count = count;
+		return range;
+	}
+
+	void D3D12DescriptorAllocator::Free(D3D12DescriptorRange& range)
+	{
+		if (!range.IsValid()) return;
+
+		auto typeIndex = static_cast<std::size_t>(range.m_HeapType);
+		assert(typeIndex < m_Pages.size() && range.m_PageIndex < m_Pages[typeIndex].size());
+		auto& allocator = *m_Pages[typeIndex][range.m_PageIndex].m_Allocator;
+		assert(allocator.GetAllocationSize(range.m_Offset) == range.m_Count);
+		allocator.Free(range.m_Offset);
+		InvalidateCachedTables();
+
+		range = {};
+	}
+
+	void D3D12DescriptorAllocator::AddDescriptorRing(D3D12DescriptorRing* ring)
+	{
+		assert(ring != nullptr);
+		if (std::find(m_DescriptorRings.begin(), m_DescriptorRings.end(), ring) == m_DescriptorRings.end()) {
+			m_DescriptorRings.push_back(ring);
+		}
+	}
+
+	void D3D12DescriptorAllocator::InvalidateCachedTables() const noexcept
+	{
+		for (auto ring : m_DescriptorRings) {
+			ring->InvalidateCachedTables();
+		}
+	}
+
+	std::uint32_t D3D12DescriptorAllocator::GetPageCount(D3D12_DESCRIPTOR_HEAP_TYPE heapType) const noexcept
+	{
+		return static_cast<std::uint32_t>(m_Pages[static_cast<std::size_t>(heapType)].size());
+	}
+
+	std::uint32_t D3D12DescriptorAllocator::GetUsedCount(D3D12_DESCRIPTOR_HEAP_TYPE heapType) const noexcept
+	{
+		std::uint32_t count = 0;
+		for (const auto& page : m_Pages[static_cast<std::size_t>(heapType)]) {
+			count += page.m_Allocator->GetUsedCount();
+		}
+		return count;
+	}
+
+	void D3D12DescriptorAllocator::CreatePage(D3D12_DESCRIPTOR_HEAP_TYPE heapType, std::uint32_t count)
+	{
+		auto& pages = m_Pages[static_cast<std::size_t>(heapType)];
+
+		Page page{};
+		page.m_Heap = std::make_unique<D3D12DescriptorHeap>(m_Device);
+		page.m_Heap->Create(
+			L"D3D12DescriptorAllocatorPage" + std::to_wstring(pages.size()),
+			heapType, count, false);
+		page.m_Allocator = std::make_unique<DescriptorRangeAllocator>(count);
+		pages.push_back(std::move(page));
+	}
+
+
+	//
+	// D3D12DescriptorRing Implementation
+	//
+	D3D12DescriptorRing::D3D12DescriptorRing(
+		ID3D12Device* device,
+		IFence* fence,
+		D3D12_DESCRIPTOR_HEAP_TYPE heapType,
+		std::uint32_t count,
+		std::uint32_t staticCount)
+		:m_RingAllocator(count), m_Fence(fence), m_HeapType(heapType), m_StaticCount(staticCount), m_Device(device) {
+		assert(m_Device != nullptr && m_Fence != nullptr);
+
+		m_Heap = std::make_unique<D3D12DescriptorHeap>(m_Device);
+		m_Heap->Create(L"D3D12DescriptorRing", heapType, staticCount + count);
+	}
+
+	D3D12DescriptorHandle D3D12DescriptorRing::AllocateAndCopy(
+		const D3D12DescriptorHandle* srcHandles,
+		std::uint32_t count)
+	{
+		assert(srcHandles != nullptr && count > 0);
+
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		// 源描述符被重写后之前复制的表已经过时
+		if (auto version = m_CacheVersion.load(std::memory_order_acquire); version != m_FrameTablesVersion) {
+			m_FrameTables.clear();
+			m_FrameSources.clear();
+			m_FrameTablesVersion = version;
+		}
+
+		// 当前帧已经复制过相同的描述符表则直接复用
+		auto hash = HashHandles(srcHandles, count);
+		if (auto it = m_FrameTables.find(hash);
+			it != m_FrameTables.end() && IsSameTable(it->second, srcHandles, count)) {
+			++m_FrameReusedCount;
+			return (*m_Heap)[m_StaticCount + it->second.m_Offset];
+		}
+
+		auto offset = m_RingAllocator.Allocate(count, 0);
+		assert(offset != RingAllocator::InvalidOffset && "D3D12DescriptorRing is full");
+		if (offset == RingAllocator::InvalidOffset) {
+			return {};
+		}
+
+		m_SrcHandles.resize(count);
+		for (std::uint32_t i = 0; i < count; ++i) {
+			assert(srcHandles[i].IsValid());
+			m_SrcHandles[i] = srcHandles[i];
+		}
+		auto dstHandle = (*m_Heap)[m_StaticCount + static_cast<std::uint32_t>(offset)];
+		D3D12_CPU_DESCRIPTOR_HANDLE dstCpuHandle = dstHandle;
+		m_Device->CopyDescriptors(1, &dstCpuHandle, &count, count, m_SrcHandles.data(), nullptr, m_HeapType);
+		m_FrameCopiedCount += count;
+
+		CachedTable table{ static_cast<std::uint32_t>(offset), count, m_FrameSources.size() };
+		for (std::uint32_t i = 0; i < count; ++i) {
+			m_FrameSources.push_back(srcHandles[i].GetCpuPtr());
+		}
+		m_FrameTables[hash] = table;
+
+		return dstHandle;
+	}
+
+	D3D12DescriptorHandle D3D12DescriptorRing::AllocateAndCopy(const std::vector<D3D12DescriptorHandle>& srcHandles)
+	{
+		return AllocateAndCopy(srcHandles.data(), static_cast<std::uint32_t>(srcHandles.size()));
+	}
+
+	D3D12DescriptorHandle D3D12DescriptorRing::AllocateSlice(std::uint32_t count)
+	{
+		assert(count > 0);
+
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		auto offset = m_RingAllocator.Allocate(count, 0);
+		assert(offset != RingAllocator::InvalidOffset && "D3D12DescriptorRing is full");
+		if (offset == RingAllocator::InvalidOffset) {
+			return {};
+		}
+		return (*m_Heap)[m_StaticCount + static_cast<std::uint32_t>(offset)];
+	}
+
+	void D3D12DescriptorRing::FinishFrame()
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		m_RingAllocator.FinishFrame(m_Fence->GetCurrentValue());
+
+		// 复制的结果只在本帧中复用
+		m_FrameTables.clear();
+		m_FrameSources.clear();
+		m_FrameCopiedCount = 0;
+		m_FrameReusedCount = 0;
+	}
+
+	void D3D12DescriptorRing::ClearUpAllocations()
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		m_RingAllocator.Retire(m_Fence->GetCompletedValue());
+	}
+
+	void D3D12DescriptorRing::InvalidateCachedTables() noexcept
+	{
+		m_CacheVersion.fetch_add(1, std::memory_order_acq_rel);
+	}
+
+	std::uint64_t D3D12DescriptorRing::GetCacheVersion() const noexcept
+	{
+		return m_CacheVersion.load(std::memory_order_acquire);
+	}
+
+	void D3D12DescriptorRing::CopyToStatic(std::uint32_t index, const D3D12DescriptorHandle& srcHandle)
+	{
+		assert(index < m_StaticCount && srcHandle.IsValid());
+		m_Device->CopyDescriptorsSimple(1, (*m_Heap)[index], srcHandle, m_HeapType);
+	}
+
+	D3D12DescriptorHandle D3D12DescriptorRing::GetStaticHandle(std::uint32_t index) const noexcept
+	{
+		assert(index < m_StaticCount);
+		return (*m_Heap)[index];
+	}
+
+	std::uint32_t D3D12DescriptorRing::GetStaticCount() const noexcept
+	{
+		return m_StaticCount;
+	}
+
+	ID3D12DescriptorHeap* D3D12DescriptorRing::GetHeap() const noexcept
+	{
+		return m_Heap->GetHeap();
+	}
+
+	D3D12_DESCRIPTOR_HEAP_TYPE D3D12DescriptorRing::GetHeapType() const noexcept
+	{
+		return m_HeapType;
+	}
+
+	std::uint32_t D3D12DescriptorRing::GetDescriptorSize() const noexcept
+	{
+		return m_Heap->GetDescriptorSize();
+	}
+
+	std::uint32_t D3D12DescriptorRing::GetUsedCount() const noexcept
+	{
+		return static_cast<std::uint32_t>(m_RingAllocator.GetUsedSize());
+	}
+
+	std::uint32_t D3D12DescriptorRing::GetFrameCopiedCount() const noexcept
+	{
+		return m_FrameCopiedCount;
+	}
+
+	std::uint32_t D3D12DescriptorRing::GetFrameReusedCount() const noexcept
+	{
+		return m_FrameReusedCount;
+	}
+
+	std::uint64_t D3D12DescriptorRing::HashHandles(const D3D12DescriptorHandle* srcHandles, std::uint32_t count) noexcept
+	{
+		// FNV-1a
+		std::uint64_t hash = 14695981039346656037ull;
+		auto combine = [&hash](std::uint64_t value) {
+			hash ^= value;
+			hash *= 1099511628211ull;
+			};
+		combine(count);
+		for (std::uint32_t i = 0; i < count; ++i) {
+			combine(srcHandles[i].GetCpuPtr());
+		}
+		return hash;
+	}
+
+	bool D3D12DescriptorRing::IsSameTable(
+		const CachedTable& table,
+		const D3D12DescriptorHandle* srcHandles,
+		std::uint32_t count) const noexcept
+	{
+		if (table.m_Count != count) return false;
+		for (std::uint32_t i = 0; i < count; ++i) {
+			if (m_FrameSources[table.m_FirstSource + i] != srcHandles[i].GetCpuPtr()) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+
+	//
+	// D3D12DescriptorRingSlice Implementation
+	//
+	D3D12DescriptorRingSlice::D3D12DescriptorRingSlice(
+		ID3D12Device* device,
+		D3D12DescriptorRing* ring,
+		std::uint32_t sliceSize)
+		:m_Device(device), m_Ring(ring), m_SliceSize(sliceSize) {
+		assert(m_Device != nullptr && m_Ring != nullptr && m_SliceSize > 0);
+		m_DescriptorSize = m_Ring->GetDescriptorSize();
+	}
+
+	D3D12DescriptorHandle D3D12DescriptorRingSlice::AllocateAndCopy(
+		const D3D12DescriptorHandle* srcHandles,
+		std::uint32_t count)
+	{
+		assert(srcHandles != nullptr && count > 0);
+
+		// 相邻的绘制通常绑定相同的资源，源描述符被重写后不再复用
+		auto version = m_Ring->GetCacheVersion();
+		if (m_LastTable.IsValid() && m_LastVersion == version && m_LastSources.size() == count &&
+			std::equal(srcHandles, srcHandles + count, m_LastSources.begin(), [](const auto& handle, std::size_t source) {
+				return handle.GetCpuPtr() == source;
+				})) {
+			return m_LastTable;
+		}
+
+		D3D12DescriptorHandle dstHandle{};
+		if (count > m_SliceSize) {
+			dstHandle = m_Ring->AllocateAndCopy(srcHandles, count);
+		}
+		else {
+			if (!m_Slice.IsValid() || m_Offset + count > m_SliceSize) {
+				m_Slice = m_Ring->AllocateSlice(m_SliceSize);
+				m_Offset = 0;
+				if (!m_Slice.IsValid()) return {};
+			}
+			dstHandle = m_Slice + static_cast<int>(m_Offset * m_DescriptorSize);
+			m_Offset += count;
+
+			m_SrcHandles.resize(count);
+			for (std::uint32_t i = 0; i < count; ++i) {
+				assert(srcHandles[i].IsValid());
+				m_SrcHandles[i] = srcHandles[i];
+			}
+			D3D12_CPU_DESCRIPTOR_HANDLE dstCpuHandle = dstHandle;
+			m_Device->CopyDescriptors(1, &dstCpuHandle, &count, count, m_SrcHandles.data(), nullptr, m_Ring->GetHeapType());
+		}
+
+		m_LastSources.resize(count);
+		for (std::uint32_t i = 0; i < count; ++i) {
+			m_LastSources[i] = srcHandles[i].GetCpuPtr();
+		}
+		m_LastTable = dstHandle;
+		m_LastVersion = version;
+
+		return dstHandle;
+	}
+
+	void D3D12DescriptorRingSlice::Reset() noexcept
+	{
+		m_Slice = {};
+		m_Offset = 0;
+		m_LastSources.clear();
+		m_LastTable = {};
+	}
+}
@@ -0,0 +1,170 @@
+#pragma once
+#ifndef __D3D12DESCRIPTORALLOCATOR__H__
+#define __D3D12DESCRIPTORALLOCATOR__H__
+
+#include "D3D12DescriptorHeap.h"
+#include "DescriptorRangeAllocator.h"
+#include "RingAllocator.h"
+#include "Fence.h"
+#include <atomic>
+#include <mutex>
+#include <unordered_map>
+
+namespace DSM {
+	class D3D12DescriptorRing;
+
+	// 持久描述符分配器中的一段连续描述符
+	struct D3D12DescriptorRange
+	{
+		D3D12DescriptorHandle m_Handle{};
+		D3D12_DESCRIPTOR_HEAP_TYPE m_HeapType = D3D12_DESCRIPTOR_HEAP_TYPE_NUM_TYPES;
+		std::uint32_t m_PageIndex = UINT32_MAX;
+		std::uint32_t m_Offset = 0;		// 在页中的索引
+		std::uint32_t m_Count = 0;
+
+		bool IsValid() const noexcept { return m_PageIndex != UINT32_MAX; }
+	};
+
+	// 持久的 CPU 描述符分配器，堆均不是 Shader Visible，仅作为复制描述符的来源
+	// 每种描述符由若干页组成，页内使用 DescriptorRangeAllocator 分配，空间不足时追加新的页。
+	// 复制描述符与设置渲染目标时会立即读取 CPU 描述符，因此释放后可直接复用，无需等待围栏，
+	// 但环形描述符堆会按源描述符缓存描述符表，释放或在原处重写后需使关联的缓存失效
+	class D3D12DescriptorAllocator
+	{
+	public:
+		inline static constexpr std::uint32_t DefaultPageSize = 256;
+
+		D3D12DescriptorAllocator(ID3D12Device* device, std::uint32_t pageSize = DefaultPageSize);
+
+		D3D12DescriptorRange Allocate(D3D12_DESCRIPTOR_HEAP_TYPE heapType, std::uint32_t count = 1);
+		// 释放描述符并重置 range，同时使关联的环形描述符堆的缓存失效
+		void Free(D3D12DescriptorRange& range);
+		// 关联以该分配器中的描述符为来源的环形描述符堆
+		void AddDescriptorRing(D3D12DescriptorRing* ring);
+		// 在原处重写描述符后调用，之后的描述符表不再复用重写前复制的结果
+		void InvalidateCachedTables() const noexcept;
+
+		std::uint32_t GetPageCount(D3D12_DESCRIPTOR_HEAP_TYPE heapType) const noexcept;
+		std::uint32_t GetUsedCount(D3D12_DESCRIPTOR_HEAP_TYPE heapType) const noexcept;
+
+	private:
+		struct Page
+		{
+			std::unique_ptr<D3D12DescriptorHeap> m_Heap;
+			std::unique_ptr<DescriptorRangeAllocator> m_Allocator;
+		};
+
+		void CreatePage(D3D12_DESCRIPTOR_HEAP_TYPE heapType, std::uint32_t count);
+
+	private:
+		ID3D12Device* m_Device;
+		std::uint32_t m_PageSize;
+		std::array<std::vector<Page>, D3D12_DESCRIPTOR_HEAP_TYPE_NUM_TYPES> m_Pages;
+		std::vector<D3D12DescriptorRing*> m_DescriptorRings;
+	};
+
+	// 所有帧共用的 Shader Visible 环形描述符堆
+	// 每帧结束时记录围栏值，围栏完成后整帧的描述符一次性回收。
+	// 同一帧中源描述符完全相同的描述符表只复制一次，源描述符被释放或重写时需调用 InvalidateCachedTables。
+	// 堆的开头可保留一段常驻区域，不随帧回收，用于无绑定的资源
+	// 分配与复制可在多个线程中调用，频繁分配的线程应使用 D3D12DescriptorRingSlice
+	class D3D12DescriptorRing
+	{
+	public:
+		inline static constexpr std::uint32_t DefaultRingSize = 16384;
+
+		D3D12DescriptorRing(
+			ID3D12Device* device,
+			IFence* fence,
+			D3D12_DESCRIPTOR_HEAP_TYPE heapType = D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV,
+			std::uint32_t count = DefaultRingSize,
+			std::uint32_t staticCount = 0);
+
+		// 将一组 CPU 描述符复制到连续的位置，返回描述符表的起始句柄
+		D3D12DescriptorHandle AllocateAndCopy(const D3D12DescriptorHandle* srcHandles, std::uint32_t count);
+		D3D12DescriptorHandle AllocateAndCopy(const std::vector<D3D12DescriptorHandle>& srcHandles);
+		// 分配一段当前帧有效的连续描述符但不复制，返回起始句柄，空间不足时返回无效句柄
+		D3D12DescriptorHandle AllocateSlice(std::uint32_t count);
+		// 结束当前帧的分配，需在发出围栏前调用
+		void FinishFrame();
+		// 回收围栏已完成的帧
+		void ClearUpAllocations();
+
+		// 源描述符被释放或重写后调用，丢弃当前帧缓存的描述符表，可在多个线程中调用
+		void InvalidateCachedTables() noexcept;
+		// 每次失效都会递增，用于检查其他地方缓存的描述符表是否仍然有效
+		std::uint64_t GetCacheVersion() const noexcept;
+
+		// 将描述符复制到常驻区域的指定位置
+		void CopyToStatic(std::uint32_t index, const D3D12DescriptorHandle& srcHandle);
+		D3D12DescriptorHandle GetStaticHandle(std::uint32_t index = 0) const noexcept;
+		std::uint32_t GetStaticCount() const noexcept;
+
+		ID3D12DescriptorHeap* GetHeap() const noexcept;
+		D3D12_DESCRIPTOR_HEAP_TYPE GetHeapType() const noexcept;
+		std::uint32_t GetDescriptorSize() const noexcept;
+		std::uint32_t GetUsedCount() const noexcept;
+		// 当前帧复制的描述符数量与复用的描述符表数量
+		std::uint32_t GetFrameCopiedCount() const noexcept;
+		std::uint32_t GetFrameReusedCount() const noexcept;
+
+	private:
+		struct CachedTable
+		{
+			std::uint32_t m_Offset;			// 在环形堆中的位置
+			std::uint32_t m_Count;
+			std::size_t m_FirstSource;		// 源描述符在 m_FrameSources 中的位置，用于排除哈希冲突
+		};
+
+		static std::uint64_t HashHandles(const D3D12DescriptorHandle* srcHandles, std::uint32_t count) noexcept;
+		bool IsSameTable(const CachedTable& table, const D3D12DescriptorHandle* srcHandles, std::uint32_t count) const noexcept;
+
+	private:
+		RingAllocator m_RingAllocator;
+		IFence* m_Fence = nullptr;
+		std::mutex m_Mutex;
+		D3D12_DESCRIPTOR_HEAP_TYPE m_HeapType;
+		std::uint32_t m_StaticCount = 0;		// 环形区域位于常驻区域之后
+
+		ID3D12Device* m_Device = nullptr;
+		std::unique_ptr<D3D12DescriptorHeap> m_Heap;
+
+		std::unordered_map<std::uint64_t, CachedTable> m_FrameTables;
+		std::vector<std::size_t> m_FrameSources;
+		std::atomic<std::uint64_t> m_CacheVersion = 0;
+		std::uint64_t m_FrameTablesVersion = 0;	// 缓存的描述符表对应的版本
+		std::vector<D3D12_CPU_DESCRIPTOR_HANDLE> m_SrcHandles;	// 复制时的临时数组，避免每次分配
+		std::uint32_t m_FrameCopiedCount = 0;
+		std::uint32_t m_FrameReusedCount = 0;
+	};
+
+	// 从环形描述符堆中取出一段供单个线程使用，段内复制描述符表不需要加锁
+	// 只复用与上一个描述符表完全相同的表，段只在当前帧有效，每帧开始录制前调用 Reset
+	class D3D12DescriptorRingSlice
+	{
+	public:
+		inline static constexpr std::uint32_t DefaultSliceSize = 256;
+
+		D3D12DescriptorRingSlice(ID3D12Device* device, D3D12DescriptorRing* ring, std::uint32_t sliceSize = DefaultSliceSize);
+
+		// 大于段的描述符表直接由环形描述符堆复制
+		D3D12DescriptorHandle AllocateAndCopy(const D3D12DescriptorHandle* srcHandles, std::uint32_t count);
+		void Reset() noexcept;
+
+	private:
+		ID3D12Device* m_Device = nullptr;
+		D3D12DescriptorRing* m_Ring = nullptr;
+		std::uint32_t m_SliceSize = 0;
+		std::uint32_t m_DescriptorSize = 0;
+
+		D3D12DescriptorHandle m_Slice{};
+		std::uint32_t m_Offset = 0;
+
+		std::vector<std::size_t> m_LastSources;
+		D3D12DescriptorHandle m_LastTable{};
+		std::uint64_t m_LastVersion = 0;
+		std::vector<D3D12_CPU_DESCRIPTOR_HANDLE> m_SrcHandles;
+	};
+}
+
+#endif
@@ -27,7 +27,7 @@ namespace DSM {
 
 	bool D3D12DescriptorHandle::IsValid() const noexcept
 	{
-		return m_GPUHandle.ptr != D3D12_GPU_VIRTUAL_ADDRESS_UNKNOWN;
+		return m_CPUHandle.ptr != D3D12_GPU_VIRTUAL_ADDRESS_UNKNOWN;
 	}
 
 	bool D3D12DescriptorHandle::IsShaderVisible() const noexcept
@@ -81,9 +81,14 @@ namespace DSM {
 		Destroy();
 	}
 
-	void D3D12DescriptorHeap::Create(const std::wstring& name, D3D12_DESCRIPTOR_HEAP_TYPE heapType, std::uint32_t maxCount)
+	void D3D12DescriptorHeap::Create(
+		const std::wstring& name,
+		D3D12_DESCRIPTOR_HEAP_TYPE heapType,
+		std::uint32_t maxCount,
+		bool shaderVisible)
 	{
-		if (heapType == D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV || heapType == D3D12_DESCRIPTOR_HEAP_TYPE_SAMPLER) {
+		if (shaderVisible &&
+			(heapType == D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV || heapType == D3D12_DESCRIPTOR_HEAP_TYPE_SAMPLER)) {
 			m_HeapDesc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE;
 		}
 		else {
@@ -99,8 +104,12 @@ namespace DSM {
 
 		m_NumFreeDescriptors = m_HeapDesc.NumDescriptors;
 		m_DescriptorSize = m_Device->GetDescriptorHandleIncrementSize(m_HeapDesc.Type);
-		m_FirstHandle = { m_DescriptorHeap->GetCPUDescriptorHandleForHeapStart(),
-			m_DescriptorHeap->GetGPUDescriptorHandleForHeapStart() };
+		// 非 Shader Visible 的堆没有 GPU 句柄
+		D3D12_GPU_DESCRIPTOR_HANDLE gpuHandle{ D3D12_GPU_VIRTUAL_ADDRESS_UNKNOWN };
+		if (IsShaderVisible()) {
+			gpuHandle = m_DescriptorHeap->GetGPUDescriptorHandleForHeapStart();
+		}
+		m_FirstHandle = { m_DescriptorHeap->GetCPUDescriptorHandleForHeapStart(), gpuHandle };
 		m_NextFreeHandle = m_FirstHandle;
 	}
 
@@ -125,10 +134,10 @@ namespace DSM {
 		auto cpuPtr = handle.GetCpuPtr();
 		auto gpuPtr = handle.GetGpuPtr();
 		if (cpuPtr < m_FirstHandle.GetCpuPtr() ||
-			cpuPtr >= m_NextFreeHandle.GetCpuPtr() + m_HeapDesc.NumDescriptors * m_DescriptorSize) {
+			cpuPtr >= m_FirstHandle.GetCpuPtr() + m_HeapDesc.NumDescriptors * m_DescriptorSize) {
 			return false;
 		}
-		if (gpuPtr - m_FirstHandle.GetGpuPtr() != cpuPtr - m_FirstHandle.GetCpuPtr()) {
+		if (IsShaderVisible() && gpuPtr - m_FirstHandle.GetGpuPtr() != cpuPtr - m_FirstHandle.GetCpuPtr()) {
 			return false;
 		}
 
@@ -175,6 +184,16 @@ namespace DSM {
 		return m_DescriptorSize;
 	}
 
+	std::uint32_t D3D12DescriptorHeap::GetMaxCount() const noexcept
+	{
+		return m_HeapDesc.NumDescriptors;
+	}
+
+	bool D3D12DescriptorHeap::IsShaderVisible() const noexcept
+	{
+		return (m_HeapDesc.Flags & D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE) != 0;
+	}
+
 	D3D12DescriptorHandle D3D12DescriptorHeap::operator[](std::uint32_t index) const noexcept
 	{
 		assert(index < m_HeapDesc.NumDescriptors);
@@ -36,15 +36,19 @@ namespace DSM {
         D3D12_GPU_DESCRIPTOR_HANDLE m_GPUHandle{};
     };
 
-    // 存储 Shader Visible 的静态描述符堆 
+    // 存储静态描述符的堆，默认 CBV_SRV_UAV 与 Sampler 为 Shader Visible
     class D3D12DescriptorHeap
     {
     public:
         D3D12DescriptorHeap(ID3D12Device* device);
         ~D3D12DescriptorHeap();
 
-        // 创建描述符堆
-        void Create(const std::wstring& name, D3D12_DESCRIPTOR_HEAP_TYPE heapType, std::uint32_t maxCount);
+        // 创建描述符堆，shaderVisible 为 false 时创建仅供 CPU 使用的堆
+        void Create(
+            const std::wstring& name,
+            D3D12_DESCRIPTOR_HEAP_TYPE heapType,
+            std::uint32_t maxCount,
+            bool shaderVisible = true);
         // 销毁描述符堆
         void Destroy();
         void Clear();
@@ -57,6 +61,8 @@ namespace DSM {
         ID3D12DescriptorHeap* GetHeap() const noexcept;
         std::uint32_t GetOffsetOfHandle(const D3D12DescriptorHandle& handle) const noexcept; 
         std::uint32_t GetDescriptorSize() const noexcept;
+        std::uint32_t GetMaxCount() const noexcept;
+        bool IsShaderVisible() const noexcept;
 
         D3D12DescriptorHandle operator[](std::uint32_t index) const noexcept;
         
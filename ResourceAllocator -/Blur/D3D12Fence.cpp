@@ -0,0 +1,20 @@
+#include "D3D12Fence.h"
+#include <cassert>
+
+namespace DSM {
+	D3D12Fence::D3D12Fence(ID3D12Fence* fence, const UINT64* currentFence)
+		:m_Fence(fence), m_CurrentFence(currentFence) {
+		assert(m_Fence != nullptr && m_CurrentFence != nullptr);
+	}
+
+	std::uint64_t D3D12Fence::GetCurrentValue() const
+	{
+		// 当前帧提交后才会发出下一个围栏值
+		return *m_CurrentFence + 1;
+	}
+
+	std::uint64_t D3D12Fence::GetCompletedValue() const
+	{
+		return m_Fence->GetCompletedValue();
+	}
+}
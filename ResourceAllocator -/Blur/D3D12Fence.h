@@ -0,0 +1,25 @@
+#pragma once
+#ifndef __D3D12FENCE__H__
+#define __D3D12FENCE__H__
+
+#include <wrl/client.h>
+#include <d3d12.h>
+#include "Fence.h"
+
+namespace DSM {
+	// 基于 ID3D12Fence 的围栏，当前值由应用程序维护的围栏计数推出
+	class D3D12Fence : public IFence
+	{
+	public:
+		D3D12Fence(ID3D12Fence* fence, const UINT64* currentFence);
+
+		std::uint64_t GetCurrentValue() const override;
+		std::uint64_t GetCompletedValue() const override;
+
+	private:
+		Microsoft::WRL::ComPtr<ID3D12Fence> m_Fence;
+		const UINT64* m_CurrentFence = nullptr;     // 最后一次发出的围栏值
+	};
+}
+
+#endif
@@ -0,0 +1,395 @@
+#include "D3D12PipelineStateCache.h"
+#include <D3DUtil.h>
+#include <cassert>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <thread>
+#include <type_traits>
+
+using Microsoft::WRL::ComPtr;
+
+namespace DSM {
+	namespace {
+		// 逐字段计算 FNV-1a，避免结构体中的填充字节与指针影响结果
+		class PipelineStateHasher
+		{
+		public:
+			template <typename T>
+			void Add(const T& value) noexcept
+			{
+				static_assert(std::is_trivially_copyable_v<T>);
+				AddBytes(&value, sizeof(T));
+			}
+
+			void AddBytes(const void* data, std::size_t size) noexcept
+			{
+				auto bytes = static_cast<const std::uint8_t*>(data);
+				for (std::size_t i = 0; i < size; ++i) {
+					m_Hash ^= bytes[i];
+					m_Hash *= 1099511628211ull;
+				}
+			}
+
+			void AddString(const char* str) noexcept
+			{
+				std::size_t size = str == nullptr ? 0 : std::strlen(str);
+				Add(static_cast<std::uint64_t>(size));
+				AddBytes(str, size);
+			}
+
+			void AddShader(const D3D12_SHADER_BYTECODE& shader) noexcept
+			{
+				Add(static_cast<std::uint64_t>(shader.BytecodeLength));
+				if (shader.pShaderBytecode != nullptr) {
+					AddBytes(shader.pShaderBytecode, shader.BytecodeLength);
+				}
+			}
+
+			void AddStencilOp(const D3D12_DEPTH_STENCILOP_DESC& op) noexcept
+			{
+				Add(op.StencilFailOp);
+				Add(op.StencilDepthFailOp);
+				Add(op.StencilPassOp);
+				Add(op.StencilFunc);
+			}
+
+			std::uint64_t GetHash() const noexcept { return m_Hash; }
+
+		private:
+			std::uint64_t m_Hash = 14695981039346656037ull;
+		};
+	}
+
+	D3D12PipelineStateCache::D3D12PipelineStateCache(std::filesystem::path directory)
+		:m_Directory(std::move(directory)) {
+	}
+
+	ComPtr<ID3D12RootSignature> D3D12PipelineStateCache::GetOrCreateRootSignature(
+		ID3D12Device* device,
+		const void* serializedData,
+		std::size_t serializedSize)
+	{
+		assert(device != nullptr && serializedData != nullptr);
+
+		auto hash = HashRootSignature(serializedData, serializedSize);
+		{
+			std::lock_guard lock(m_Mutex);
+			if (auto it = m_RootSignatures.find(hash); it != m_RootSignatures.end()) {
+				return it->second;
+			}
+		}
+
+		// 在锁外创建，其他线程的查找不被阻塞
+		ComPtr<ID3D12RootSignature> rootSignature;
+		ThrowIfFailed(device->CreateRootSignature(0, serializedData, serializedSize,
+			IID_PPV_ARGS(rootSignature.GetAddressOf())));
+
+		// 其他线程可能已先插入相同的根签名，此时丢弃新建的根签名，保证同一内容只对应一个地址
+		std::lock_guard lock(m_Mutex);
+		auto [it, inserted] = m_RootSignatures.try_emplace(hash, rootSignature);
+		if (inserted) {
+			m_RootSignatureHashes[rootSignature.Get()] = hash;
+		}
+		return it->second;
+	}
+
+	ComPtr<ID3D12PipelineState> D3D12PipelineStateCache::GetOrCreateGraphicsPSO(
+		ID3D12Device* device,
+		const D3D12_GRAPHICS_PIPELINE_STATE_DESC& psoDesc)
+	{
+		assert(device != nullptr);
+
+		return GetOrCreatePSO(psoDesc, &HashGraphicsPSODesc,
+			[device](const D3D12_GRAPHICS_PIPELINE_STATE_DESC& desc, ComPtr<ID3D12PipelineState>& pso) {
+				return device->CreateGraphicsPipelineState(&desc, IID_PPV_ARGS(pso.ReleaseAndGetAddressOf()));
+			});
+	}
+
+	ComPtr<ID3D12PipelineState> D3D12PipelineStateCache::GetOrCreateComputePSO(
+		ID3D12Device* device,
+		const D3D12_COMPUTE_PIPELINE_STATE_DESC& psoDesc)
+	{
+		assert(device != nullptr);
+
+		return GetOrCreatePSO(psoDesc, &HashComputePSODesc,
+			[device](const D3D12_COMPUTE_PIPELINE_STATE_DESC& desc, ComPtr<ID3D12PipelineState>& pso) {
+				return device->CreateComputePipelineState(&desc, IID_PPV_ARGS(pso.ReleaseAndGetAddressOf()));
+			});
+	}
+
+	void D3D12PipelineStateCache::Clear()
+	{
+		std::lock_guard lock(m_Mutex);
+		m_PipelineStates.clear();
+		m_RootSignatureHashes.clear();
+		m_RootSignatures.clear();
+	}
+
+	std::uint32_t D3D12PipelineStateCache::GetPSOCount() const
+	{
+		std::lock_guard lock(m_Mutex);
+		return static_cast<std::uint32_t>(m_PipelineStates.size());
+	}
+
+	std::uint32_t D3D12PipelineStateCache::GetRootSignatureCount() const
+	{
+		std::lock_guard lock(m_Mutex);
+		return static_cast<std::uint32_t>(m_RootSignatures.size());
+	}
+
+	std::uint64_t D3D12PipelineStateCache::GetHitCount() const
+	{
+		std::lock_guard lock(m_Mutex);
+		return m_HitCount;
+	}
+
+	std::uint64_t D3D12PipelineStateCache::GetMissCount() const
+	{
+		std::lock_guard lock(m_Mutex);
+		return m_MissCount;
+	}
+
+	std::uint64_t D3D12PipelineStateCache::HashRootSignature(const void* serializedData, std::size_t serializedSize) noexcept
+	{
+		PipelineStateHasher hasher;
+		hasher.Add(static_cast<std::uint64_t>(serializedSize));
+		hasher.AddBytes(serializedData, serializedSize);
+		return hasher.GetHash();
+	}
+
+	std::uint64_t D3D12PipelineStateCache::HashGraphicsPSODesc(
+		const D3D12_GRAPHICS_PIPELINE_STATE_DESC& psoDesc,
+		std::uint64_t rootSignatureHash) noexcept
+	{
+		PipelineStateHasher hasher;
+		hasher.Add(rootSignatureHash);
+		hasher.AddShader(psoDesc.VS);
+		hasher.AddShader(psoDesc.PS);
+		hasher.AddShader(psoDesc.DS);
+		hasher.AddShader(psoDesc.HS);
+		hasher.AddShader(psoDesc.GS);
+
+		const auto& streamOutput = psoDesc.StreamOutput;
+		hasher.Add(streamOutput.NumEntries);
+		for (UINT i = 0; i < streamOutput.NumEntries; ++i) {
+			const auto& entry = streamOutput.pSODeclaration[i];
+			hasher.Add(entry.Stream);
+			hasher.AddString(entry.SemanticName);
+			hasher.Add(entry.SemanticIndex);
+			hasher.Add(entry.StartComponent);
+			hasher.Add(entry.ComponentCount);
+			hasher.Add(entry.OutputSlot);
+		}
+		hasher.Add(streamOutput.NumStrides);
+		for (UINT i = 0; i < streamOutput.NumStrides; ++i) {
+			hasher.Add(streamOutput.pBufferStrides[i]);
+		}
+		hasher.Add(streamOutput.RasterizedStream);
+
+		const auto& blend = psoDesc.BlendState;
+		hasher.Add(blend.AlphaToCoverageEnable);
+		hasher.Add(blend.IndependentBlendEnable);
+		// 未开启独立混合时只使用第一个渲染目标的设置
+		const UINT numBlendTargets = blend.IndependentBlendEnable ? D3D12_SIMULTANEOUS_RENDER_TARGET_COUNT : 1;
+		for (UINT i = 0; i < numBlendTargets; ++i) {
+			const auto& target = blend.RenderTarget[i];
+			hasher.Add(target.BlendEnable);
+			hasher.Add(target.LogicOpEnable);
+			hasher.Add(target.SrcBlend);
+			hasher.Add(target.DestBlend);
+			hasher.Add(target.BlendOp);
+			hasher.Add(target.SrcBlendAlpha);
+			hasher.Add(target.DestBlendAlpha);
+			hasher.Add(target.BlendOpAlpha);
+			hasher.Add(target.LogicOp);
+			hasher.Add(target.RenderTargetWriteMask);
+		}
+		hasher.Add(psoDesc.SampleMask);
+
+		const auto& rasterizer = psoDesc.RasterizerState;
+		hasher.Add(rasterizer.FillMode);
+		hasher.Add(rasterizer.CullMode);
+		hasher.Add(rasterizer.FrontCounterClockwise);
+		hasher.Add(rasterizer.DepthBias);
+		hasher.Add(rasterizer.DepthBiasClamp);
+		hasher.Add(rasterizer.SlopeScaledDepthBias);
+		hasher.Add(rasterizer.DepthClipEnable);
+		hasher.Add(rasterizer.MultisampleEnable);
+		hasher.Add(rasterizer.AntialiasedLineEnable);
+		hasher.Add(rasterizer.ForcedSampleCount);
+		hasher.Add(rasterizer.ConservativeRaster);
+
+		const auto& depthStencil = psoDesc.DepthStencilState;
+		hasher.Add(depthStencil.DepthEnable);
+		hasher.Add(depthStencil.DepthWriteMask);
+		hasher.Add(depthStencil.DepthFunc);
+		hasher.Add(depthStencil.StencilEnable);
+		hasher.Add(depthStencil.StencilReadMask);
+		hasher.Add(depthStencil.StencilWriteMask);
+		hasher.AddStencilOp(depthStencil.FrontFace);
+		hasher.AddStencilOp(depthStencil.BackFace);
+
+		const auto& inputLayout = psoDesc.InputLayout;
+		hasher.Add(inputLayout.NumElements);
+		for (UINT i = 0; i < inputLayout.NumElements; ++i) {
+			const auto& element = inputLayout.pInputElementDescs[i];
+			hasher.AddString(element.SemanticName);
+			hasher.Add(element.SemanticIndex);
+			hasher.Add(element.Format);
+			hasher.Add(element.InputSlot);
+			hasher.Add(element.AlignedByteOffset);
+			hasher.Add(element.InputSlotClass);
+			hasher.Add(element.InstanceDataStepRate);
+		}
+
+		hasher.Add(psoDesc.IBStripCutValue);
+		hasher.Add(psoDesc.PrimitiveTopologyType);
+		// 只计算使用到的渲染目标格式
+		const UINT numRenderTargets = (std::min)(psoDesc.NumRenderTargets, static_cast<UINT>(D3D12_SIMULTANEOUS_RENDER_TARGET_COUNT));
+		hasher.Add(numRenderTargets);
+		for (UINT i = 0; i < numRenderTargets; ++i) {
+			hasher.Add(psoDesc.RTVFormats[i]);
+		}
+		hasher.Add(psoDesc.DSVFormat);
+		hasher.Add(psoDesc.SampleDesc.Count);
+		hasher.Add(psoDesc.SampleDesc.Quality);
+		hasher.Add(psoDesc.NodeMask);
+		hasher.Add(psoDesc.Flags);
+		return hasher.GetHash();
+	}
+
+	std::uint64_t D3D12PipelineStateCache::HashComputePSODesc(
+		const D3D12_COMPUTE_PIPELINE_STATE_DESC& psoDesc,
+		std::uint64_t rootSignatureHash) noexcept
+	{
+		PipelineStateHasher hasher;
+		// 与图形管线的键区分开
+		hasher.AddString("Compute");
+		hasher.Add(rootSignatureHash);
+		hasher.AddShader(psoDesc.CS);
+		hasher.Add(psoDesc.NodeMask);
+		hasher.Add(psoDesc.Flags);
+		return hasher.GetHash();
+	}
+
+	bool D3D12PipelineStateCache::TryGetRootSignatureHash(ID3D12RootSignature* rootSignature, std::uint64_t& hash) const
+	{
+		// 缓存持有根签名的引用，因此表中的地址不会被其他对象复用
+		if (auto it = m_RootSignatureHashes.find(rootSignature); it != m_RootSignatureHashes.end()) {
+			hash = it->second;
+			return true;
+		}
+		return false;
+	}
+
+	std::filesystem::path D3D12PipelineStateCache::GetBlobPath(std::uint64_t key) const
+	{
+		std::ostringstream os;
+		os << std::hex << std::setw(16) << std::setfill('0') << key << ".pso";
+		return m_Directory / os.str();
+	}
+
+	bool D3D12PipelineStateCache::LoadBlob(std::uint64_t key, std::vector<std::uint8_t>& blob) const
+	{
+		if (m_Directory.empty()) return false;
+
+		std::ifstream file(GetBlobPath(key), std::ios::binary | std::ios::ate);
+		if (!file) return false;
+		auto size = file.tellg();
+		if (size <= 0) return false;
+		blob.resize(static_cast<std::size_t>(size));
+		file.seekg(0);
+		return file.read(reinterpret_cast<char*>(blob.data()), size).good();
+	}
+
+	void D3D12PipelineStateCache::StoreBlob(std::uint64_t key, ID3D12PipelineState* pso) const
+	{
+		if (m_Directory.empty()) return;
+
+		ComPtr<ID3DBlob> blob;
+		if (FAILED(pso->GetCachedBlob(blob.GetAddressOf())) || blob == nullptr) return;
+
+		std::error_code ec;
+		std::filesystem::create_directories(m_Directory, ec);
+		if (ec) return;
+
+		// 先写入临时文件再重命名，避免其他进程读到写了一半的文件
+		auto path = GetBlobPath(key);
+		auto tempPath = path;
+		tempPath += "." + std::to_string(std::hash<std::thread::id>{}(std::this_thread::get_id())) + ".tmp";
+		{
+			std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+			if (!file || !file.write(static_cast<const char*>(blob->GetBufferPointer()), blob->GetBufferSize())) {
+				file.close();
+				std::filesystem::remove(tempPath, ec);
+				return;
+			}
+		}
+		std::filesystem::rename(tempPath, path, ec);
+		if (ec) {
+			std::filesystem::remove(tempPath, ec);
+		}
+	}
+
+	template <typename Desc, typename HashFunc, typename CreateFunc>
+	ComPtr<ID3D12PipelineState> D3D12PipelineStateCache::GetOrCreatePSO(const Desc& psoDesc, HashFunc&& hash, CreateFunc&& create)
+	{
+		std::uint64_t rootSignatureHash = 0;
+		bool isCachedRootSignature = false;
+		{
+			std::lock_guard lock(m_Mutex);
+			isCachedRootSignature = TryGetRootSignatureHash(psoDesc.pRootSignature, rootSignatureHash);
+		}
+		if (!isCachedRootSignature) {
+			// 根签名的地址可能被复用且不能写入磁盘，不能作为键
+			assert(false && "pRootSignature must come from GetOrCreateRootSignature");
+			ComPtr<ID3D12PipelineState> pso;
+			ThrowIfFailed(create(psoDesc, pso));
+			return pso;
+		}
+
+		// 着色器字节码可能很大，在锁外计算键
+		auto key = hash(psoDesc, rootSignatureHash);
+		{
+			std::lock_guard lock(m_Mutex);
+			if (auto it = m_PipelineStates.find(key); it != m_PipelineStates.end()) {
+				++m_HitCount;
+				return it->second;
+			}
+			++m_MissCount;
+		}
+
+		// 创建 PSO 与读写磁盘可能耗时数十毫秒，在锁外进行，锁只保护表的查找与插入
+		// 多个线程同时请求同一个 PSO 时可能重复创建，插入时以先插入的为准
+		ComPtr<ID3D12PipelineState> pso;
+		bool isCreated = false;
+		std::vector<std::uint8_t> cachedBlob;
+		if (psoDesc.CachedPSO.pCachedBlob == nullptr && LoadBlob(key, cachedBlob)) {
+			auto desc = psoDesc;
+			desc.CachedPSO = { cachedBlob.data(), cachedBlob.size() };
+			// 驱动或显卡改变后缓存的 PSO 会创建失败，此时重新创建
+			if (FAILED(create(desc, pso))) {
+				pso = nullptr;
+			}
+		}
+		if (pso == nullptr) {
+			ThrowIfFailed(create(psoDesc, pso));
+			isCreated = true;
+		}
+
+		{
+			std::lock_guard lock(m_Mutex);
+			auto [it, inserted] = m_PipelineStates.try_emplace(key, pso);
+			if (!inserted) {
+				return it->second;
+			}
+		}
+		// 只有插入成功的线程写入磁盘
+		if (isCreated) {
+			StoreBlob(key, pso.Get());
+		}
+		return pso;
+	}
+}
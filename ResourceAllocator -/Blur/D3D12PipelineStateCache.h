@@ -0,0 +1,70 @@
+#pragma once
+#ifndef __D3D12PIPELINESTATECACHE__H__
+#define __D3D12PIPELINESTATECACHE__H__
+
+#include <d3d12.h>
+#include <wrl/client.h>
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace DSM {
+	// 进程内共享的根签名与 PSO 缓存
+	// 描述的键由各个字段逐一计算，指针字段替换为其指向的内容，因此跨进程保持稳定。
+	// 设置了缓存目录时，新建的 PSO 通过 GetCachedBlob 写入磁盘，下次启动时作为 CachedPSO 使用
+	// 可在多个线程中使用，锁只保护表的查找与插入，创建与磁盘读写在锁外进行
+	class D3D12PipelineStateCache
+	{
+	public:
+		// directory 为空时不使用磁盘缓存
+		explicit D3D12PipelineStateCache(std::filesystem::path directory = {});
+
+		// 以序列化后的根签名内容去重
+		Microsoft::WRL::ComPtr<ID3D12RootSignature> GetOrCreateRootSignature(
+			ID3D12Device* device,
+			const void* serializedData,
+			std::size_t serializedSize);
+		// pRootSignature 需来自 GetOrCreateRootSignature，键由其序列化后的内容计算
+		// 其他根签名没有稳定的键，断言失败，Release 下直接创建而不进入缓存
+		Microsoft::WRL::ComPtr<ID3D12PipelineState> GetOrCreateGraphicsPSO(
+			ID3D12Device* device,
+			const D3D12_GRAPHICS_PIPELINE_STATE_DESC& psoDesc);
+		Microsoft::WRL::ComPtr<ID3D12PipelineState> GetOrCreateComputePSO(
+			ID3D12Device* device,
+			const D3D12_COMPUTE_PIPELINE_STATE_DESC& psoDesc);
+		void Clear();
+
+		std::uint32_t GetPSOCount() const;
+		std::uint32_t GetRootSignatureCount() const;
+		std::uint64_t GetHitCount() const;
+		std::uint64_t GetMissCount() const;
+
+		static std::uint64_t HashRootSignature(const void* serializedData, std::size_t serializedSize) noexcept;
+		// rootSignatureHash 代替 pRootSignature 参与计算，CachedPSO 不影响键
+		static std::uint64_t HashGraphicsPSODesc(const D3D12_GRAPHICS_PIPELINE_STATE_DESC& psoDesc, std::uint64_t rootSignatureHash) noexcept;
+		static std::uint64_t HashComputePSODesc(const D3D12_COMPUTE_PIPELINE_STATE_DESC& psoDesc, std::uint64_t rootSignatureHash) noexcept;
+
+	private:
+		bool TryGetRootSignatureHash(ID3D12RootSignature* rootSignature, std::uint64_t& hash) const;
+		std::filesystem::path GetBlobPath(std::uint64_t key) const;
+		bool LoadBlob(std::uint64_t key, std::vector<std::uint8_t>& blob) const;
+		void StoreBlob(std::uint64_t key, ID3D12PipelineState* pso) const;
+
+		template <typename Desc, typename HashFunc, typename CreateFunc>
+		Microsoft::WRL::ComPtr<ID3D12PipelineState> GetOrCreatePSO(const Desc& psoDesc, HashFunc&& hash, CreateFunc&& create);
+
+	private:
+		std::filesystem::path m_Directory;
+
+		mutable std::mutex m_Mutex;
+		std::unordered_map<std::uint64_t, Microsoft::WRL::ComPtr<ID3D12RootSignature>> m_RootSignatures;
+		std::unordered_map<ID3D12RootSignature*, std::uint64_t> m_RootSignatureHashes;
+		std::unordered_map<std::uint64_t, Microsoft::WRL::ComPtr<ID3D12PipelineState>> m_PipelineStates;
+		std::uint64_t m_HitCount = 0;
+		std::uint64_t m_MissCount = 0;
+	};
+}
+
+#endif
@@ -0,0 +1,71 @@
+#pragma once
+#ifndef __DEFERREDDELETIONQUEUE__H__
+#define __DEFERREDDELETIONQUEUE__H__
+
+#include <cassert>
+#include <cstdint>
+#include <deque>
+#include <utility>
+
+namespace DSM {
+	// 按围栏值排序的延迟删除队列
+	// 每个元素记录退休时所在帧的围栏值，只有 GPU 完成该围栏值后才会被回收
+	template <typename T>
+	class DeferredDeletionQueue
+	{
+	public:
+		void Push(std::uint64_t fenceValue, T&& item)
+		{
+			// 围栏值单调递增，因此队列天然有序
+			assert(m_Entries.empty() || m_Entries.back().m_FenceValue <= fenceValue);
+			m_Entries.push_back({ fenceValue, std::move(item) });
+		}
+
+		void Push(std::uint64_t fenceValue, const T& item)
+		{
+			assert(m_Entries.empty() || m_Entries.back().m_FenceValue <= fenceValue);
+			m_Entries.push_back({ fenceValue, item });
+		}
+
+		// 回收所有围栏值不大于 completedValue 的元素，返回回收的数量
+		template <typename Func>
+		std::size_t Retire(std::uint64_t completedValue, Func&& func)
+		{
+			std::size_t count = 0;
+			while (!m_Entries.empty() && m_Entries.front().m_FenceValue <= completedValue) {
+				func(m_Entries.front().m_Item);
+				m_Entries.pop_front();
+				++count;
+			}
+			return count;
+		}
+
+		// 不等待围栏，直接回收所有元素
+		template <typename Func>
+		std::size_t RetireAll(Func&& func)
+		{
+			return Retire(UINT64_MAX, std::forward<Func>(func));
+		}
+
+		std::size_t Size() const noexcept
+		{
+			return m_Entries.size();
+		}
+
+		bool Empty() const noexcept
+		{
+			return m_Entries.empty();
+		}
+
+	private:
+		struct Entry
+		{
+			std::uint64_t m_FenceValue;
+			T m_Item;
+		};
+
+		std::deque<Entry> m_Entries;
+	};
+}
+
+#endif
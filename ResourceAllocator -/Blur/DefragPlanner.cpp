@@ -0,0 +1,87 @@
+#include "DefragPlanner.h"
+#include <algorithm>
+#include <numeric>
+
+namespace DSM {
+	std::vector<DefragPlanner::Move> DefragPlanner::Plan(std::vector<Pool> pools, std::uint64_t maxMoveBytes)
+	{
+		std::vector<Move> moves;
+		if (pools.size() < 2) {
+			return moves;
+		}
+
+		// 按占用从少到多排序，占用少的优先被清空，占用多的优先作为目标
+		std::vector<std::size_t> order(pools.size());
+		std::iota(order.begin(), order.end(), 0);
+		std::sort(order.begin(), order.end(), [&pools](std::size_t a, std::size_t b) {
+			return pools[a].m_Allocator.GetAllocatedSize() < pools[b].m_Allocator.GetAllocatedSize();
+			});
+
+		std::vector<bool> evacuated(pools.size(), false);
+		std::vector<bool> received(pools.size(), false);
+		std::uint64_t totalBytes = 0;
+
+		for (auto src : order) {
+			auto& srcPool = pools[src];
+			if (received[src] || srcPool.m_Allocator.IsEmpty()) continue;
+
+			// 存在不可移动的块时无法清空该分配器
+			std::uint64_t movableBytes = 0;
+			for (const auto& block : srcPool.m_Blocks) {
+				movableBytes += srcPool.m_Allocator.UnitSizeToSize(srcPool.m_Allocator.OrderToUnitSize(block.m_Order));
+			}
+			if (movableBytes != srcPool.m_Allocator.GetAllocatedSize()) continue;
+			if (maxMoveBytes != 0 && totalBytes + movableBytes > maxMoveBytes) continue;
+
+			// 先放大的块，减少目标中的碎片
+			auto blocks = srcPool.m_Blocks;
+			std::sort(blocks.begin(), blocks.end(), [](const Block& a, const Block& b) {
+				return a.m_Order > b.m_Order;
+				});
+
+			std::vector<Move> tentative;
+			bool success = true;
+			for (const auto& block : blocks) {
+				bool placed = false;
+				for (auto it = order.rbegin(); it != order.rend(); ++it) {
+					auto dst = *it;
+					if (dst == src || evacuated[dst]) continue;
+
+					auto& dstAllocator = pools[dst].m_Allocator;
+					if (block.m_Order > dstAllocator.GetMaxOrder()) continue;
+					auto offset = dstAllocator.AllocateBlock(block.m_Order);
+					if (offset == BuddyAllocator::InvalidOffset) continue;
+
+					auto size = dstAllocator.UnitSizeToSize(dstAllocator.OrderToUnitSize(block.m_Order));
+					tentative.push_back({ block.m_Id, static_cast<std::uint32_t>(src),
+						static_cast<std::uint32_t>(dst), offset, block.m_Order, size });
+					placed = true;
+					break;
+				}
+				if (!placed) {
+					success = false;
+					break;
+				}
+			}
+
+			if (!success) {
+				// 回滚模拟的分配
+				for (const auto& move : tentative) {
+					pools[move.m_DstPool].m_Allocator.DeallocateBlock(move.m_DstOffset, move.m_Order);
+				}
+				continue;
+			}
+
+			evacuated[src] = true;
+			totalBytes += movableBytes;
+			for (auto& move : tentative) {
+				received[move.m_DstPool] = true;
+				move.m_SrcPool = pools[move.m_SrcPool].m_PoolIndex;
+				move.m_DstPool = pools[move.m_DstPool].m_PoolIndex;
+				moves.push_back(move);
+			}
+		}
+
+		return moves;
+	}
+}
@@ -0,0 +1,45 @@
+#pragma once
+#ifndef __DEFRAGPLANNER__H__
+#define __DEFRAGPLANNER__H__
+
+#include "BuddyAllocator.h"
+#include <vector>
+
+namespace DSM {
+	// 显存整理的规划，不依赖 D3D12 设备
+	// 在 Buddy 簿记的副本上模拟移动，尝试把占用最少的分配器中的块全部搬到其他分配器中，
+	// 被清空的分配器随后会被 D3D12MultiBuddyAllocator 回收
+	class DefragPlanner
+	{
+	public:
+		// 可以移动的块，偏移量与层级以最小块为单位
+		struct Block
+		{
+			std::uint64_t m_Id;
+			std::uint32_t m_Offset;
+			std::uint32_t m_Order;
+		};
+
+		struct Pool
+		{
+			std::uint32_t m_PoolIndex;
+			BuddyAllocator m_Allocator;     // 分配器当前簿记的副本
+			std::vector<Block> m_Blocks;    // 分配器中可移动的块，其余已分配的块视为不可移动
+		};
+
+		struct Move
+		{
+			std::uint64_t m_Id;
+			std::uint32_t m_SrcPool;
+			std::uint32_t m_DstPool;
+			std::uint32_t m_DstOffset;      // 模拟时得到的偏移，执行时可能因新的分配而改变
+			std::uint32_t m_Order;
+			std::uint64_t m_Size;           // 块的字节大小
+		};
+
+		// 规划移动，maxMoveBytes 限制单次规划移动的总大小，0 表示不限制
+		static std::vector<Move> Plan(std::vector<Pool> pools, std::uint64_t maxMoveBytes = 0);
+	};
+}
+
+#endif
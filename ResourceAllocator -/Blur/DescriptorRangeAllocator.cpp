@@ -0,0 +1,199 @@
+#include "DescriptorRangeAllocator.h"
+#include <bit>
+#include <cassert>
+
+namespace DSM {
+	DescriptorRangeAllocator::DescriptorRangeAllocator(std::uint32_t capacity)
+		:m_Capacity(capacity), m_Blocks(capacity) {
+		assert(m_Capacity > 0);
+
+		m_FreeListHead.fill(NullLink);
+		m_Blocks[0].m_Size = m_Capacity;
+		PushFreeBlock(0);
+	}
+
+	std::uint32_t DescriptorRangeAllocator::Allocate(std::uint32_t count)
+	{
+		assert(count > 0);
+		if (count > m_Capacity - m_UsedCount) {
+			return InvalidOffset;
+		}
+
+		std::uint32_t fl, sl;
+		MappingSearch(count, fl, sl);
+		auto offset = fl < FirstLevelCount ? FindFreeBlock(fl, sl) : NullLink;
+		if (offset == NullLink) {
+			// 向上取整的类别中没有空闲块时，检查请求所在类别的首个块是否足够大
+			MappingInsert(count, fl, sl);
+			offset = m_FreeListHead[fl * SecondLevelCount + sl];
+			if (offset == NullLink || m_Blocks[offset].m_Size < count) {
+				return InvalidOffset;
+			}
+		}
+		RemoveFreeBlock(offset);
+
+		// 剩余的部分拆分为新的空闲块
+		auto& block = m_Blocks[offset];
+		if (block.m_Size > count) {
+			const auto remain = offset + count;
+			m_Blocks[remain].m_Size = block.m_Size - count;
+			m_Blocks[remain].m_PrevPhysical = offset;
+			SetPrevPhysical(remain + m_Blocks[remain].m_Size, remain);
+			block.m_Size = count;
+			PushFreeBlock(remain);
+		}
+
+		m_UsedCount += count;
+		return offset;
+	}
+
+	void DescriptorRangeAllocator::Free(std::uint32_t offset)
+	{
+		assert(offset < m_Capacity && m_Blocks[offset].m_Size > 0 && !m_Blocks[offset].m_IsFree);
+
+		auto size = m_Blocks[offset].m_Size;
+		m_UsedCount -= size;
+
+		// 与物理上相邻的空闲块合并
+		if (auto prev = m_Blocks[offset].m_PrevPhysical; prev != NullLink && m_Blocks[prev].m_IsFree) {
+			RemoveFreeBlock(prev);
+			m_Blocks[prev].m_Size += size;
+			m_Blocks[offset].m_Size = 0;
+			offset = prev;
+			size = m_Blocks[offset].m_Size;
+		}
+		if (auto next = offset + size; next < m_Capacity && m_Blocks[next].m_IsFree) {
+			RemoveFreeBlock(next);
+			size += m_Blocks[next].m_Size;
+			m_Blocks[next].m_Size = 0;
+			m_Blocks[offset].m_Size = size;
+		}
+		SetPrevPhysical(offset + size, offset);
+
+		PushFreeBlock(offset);
+	}
+
+	std::uint32_t DescriptorRangeAllocator::GetAllocationSize(std::uint32_t offset) const noexcept
+	{
+		assert(offset < m_Capacity && !m_Blocks[offset].m_IsFree);
+		return m_Blocks[offset].m_Size;
+	}
+
+	std::uint32_t DescriptorRangeAllocator::GetCapacity() const noexcept
+	{
+		return m_Capacity;
+	}
+
+	std::uint32_t DescriptorRangeAllocator::GetUsedCount() const noexcept
+	{
+		return m_UsedCount;
+	}
+
+	std::uint32_t DescriptorRangeAllocator::GetFreeCount() const noexcept
+	{
+		return m_Capacity - m_UsedCount;
+	}
+
+	bool DescriptorRangeAllocator::IsEmpty() const noexcept
+	{
+		return m_UsedCount == 0;
+	}
+
+	void DescriptorRangeAllocator::MappingInsert(std::uint32_t size, std::uint32_t& fl, std::uint32_t& sl) noexcept
+	{
+		if (size < SecondLevelCount) {
+			fl = 0;
+			sl = size;
+		}
+		else {
+			const auto msb = static_cast<std::uint32_t>(std::bit_width(size)) - 1;
+			fl = msb - SecondLevelLog2 + 1;
+			sl = (size >> (msb - SecondLevelLog2)) - SecondLevelCount;
+		}
+	}
+
+	void DescriptorRangeAllocator::MappingSearch(std::uint32_t size, std::uint32_t& fl, std::uint32_t& sl) noexcept
+	{
+		std::uint64_t roundSize = size;
+		if (size >= SecondLevelCount) {
+			const auto msb = static_cast<std::uint32_t>(std::bit_width(size)) - 1;
+			roundSize += (std::uint64_t(1) << (msb - SecondLevelLog2)) - 1;
+		}
+		if (roundSize > UINT32_MAX) {
+			fl = FirstLevelCount;
+			sl = 0;
+			return;
+		}
+		MappingInsert(static_cast<std::uint32_t>(roundSize), fl, sl);
+	}
+
+	std::uint32_t DescriptorRangeAllocator::FindFreeBlock(std::uint32_t fl, std::uint32_t sl) const noexcept
+	{
+		// 先在同一级中找不小于 sl 的类别，再找更高的级
+		auto slMask = m_SecondLevelMask[fl] & (~0u << sl);
+		if (slMask == 0) {
+			const auto flMask = fl + 1 < 32 ? m_FirstLevelMask & (~0u << (fl + 1)) : 0;
+			if (flMask == 0) {
+				return NullLink;
+			}
+			fl = static_cast<std::uint32_t>(std::countr_zero(flMask));
+			slMask = m_SecondLevelMask[fl];
+		}
+		sl = static_cast<std::uint32_t>(std::countr_zero(slMask));
+		return m_FreeListHead[fl * SecondLevelCount + sl];
+	}
+
+	void DescriptorRangeAllocator::PushFreeBlock(std::uint32_t offset) noexcept
+	{
+		auto& block = m_Blocks[offset];
+		std::uint32_t fl, sl;
+		MappingInsert(block.m_Size, fl, sl);
+
+		auto& head = m_FreeListHead[fl * SecondLevelCount + sl];
+		block.m_IsFree = true;
+		block.m_PrevFree = NullLink;
+		block.m_NextFree = head;
+		if (head != NullLink) {
+			m_Blocks[head].m_PrevFree = offset;
+		}
+		head = offset;
+
+		m_FirstLevelMask |= 1u << fl;
+		m_SecondLevelMask[fl] |= 1u << sl;
+	}
+
+	void DescriptorRangeAllocator::RemoveFreeBlock(std::uint32_t offset) noexcept
+	{
+		auto& block = m_Blocks[offset];
+		assert(block.m_IsFree);
+		std::uint32_t fl, sl;
+		MappingInsert(block.m_Size, fl, sl);
+
+		if (block.m_PrevFree != NullLink) {
+			m_Blocks[block.m_PrevFree].m_NextFree = block.m_NextFree;
+		}
+		else {
+			m_FreeListHead[fl * SecondLevelCount + sl] = block.m_NextFree;
+		}
+		if (block.m_NextFree != NullLink) {
+			m_Blocks[block.m_NextFree].m_PrevFree = block.m_PrevFree;
+		}
+		block.m_IsFree = false;
+		block.m_NextFree = block.m_PrevFree = NullLink;
+
+		// 链表为空时清除位图
+		if (m_FreeListHead[fl * SecondLevelCount + sl] == NullLink) {
+			m_SecondLevelMask[fl] &= ~(1u << sl);
+			if (m_SecondLevelMask[fl] == 0) {
+				m_FirstLevelMask &= ~(1u << fl);
+			}
+		}
+	}
+
+	void DescriptorRangeAllocator::SetPrevPhysical(std::uint32_t offset, std::uint32_t prev) noexcept
+	{
+		if (offset < m_Capacity) {
+			m_Blocks[offset].m_PrevPhysical = prev;
+		}
+	}
+}
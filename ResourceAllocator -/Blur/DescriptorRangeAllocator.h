@@ -0,0 +1,69 @@
+#pragma once
+#ifndef __DESCRIPTORRANGEALLOCATOR__H__
+#define __DESCRIPTORRANGEALLOCATOR__H__
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+namespace DSM {
+	// 描述符范围的 TLSF 簿记核心，不依赖 D3D12 设备
+	// 空闲范围按两级大小分类挂在分离的空闲链表上，用位图查找可用的类别，
+	// 释放时通过物理相邻的块合并，分配与释放均为常数时间
+	class DescriptorRangeAllocator
+	{
+	public:
+		static constexpr std::uint32_t InvalidOffset = UINT32_MAX;
+
+		explicit DescriptorRangeAllocator(std::uint32_t capacity);
+
+		// 分配 count 个连续的描述符，返回起始索引，空间不足返回 InvalidOffset
+		std::uint32_t Allocate(std::uint32_t count);
+		// 释放以 offset 开始的范围，大小由分配时记录
+		void Free(std::uint32_t offset);
+
+		// 已分配范围的大小
+		std::uint32_t GetAllocationSize(std::uint32_t offset) const noexcept;
+		std::uint32_t GetCapacity() const noexcept;
+		std::uint32_t GetUsedCount() const noexcept;
+		std::uint32_t GetFreeCount() const noexcept;
+		bool IsEmpty() const noexcept;
+
+	private:
+		static constexpr std::uint32_t NullLink = UINT32_MAX;
+		static constexpr std::uint32_t SecondLevelLog2 = 4;
+		static constexpr std::uint32_t SecondLevelCount = 1u << SecondLevelLog2;
+		// 小于 SecondLevelCount 的大小全部放在第 0 级，其余每个 2 的幂占一级
+		static constexpr std::uint32_t FirstLevelCount = 32 - SecondLevelLog2 + 1;
+
+		// 块的信息只记录在块的起始索引上
+		struct Block
+		{
+			std::uint32_t m_Size = 0;
+			std::uint32_t m_PrevPhysical = NullLink;	// 物理上前一个块的起始索引
+			std::uint32_t m_NextFree = NullLink;
+			std::uint32_t m_PrevFree = NullLink;
+			bool m_IsFree = false;
+		};
+
+		// 大小所在的类别，向下取整，用于插入空闲链表
+		static void MappingInsert(std::uint32_t size, std::uint32_t& fl, std::uint32_t& sl) noexcept;
+		// 大小所在的类别，向上取整，类别中的任意块都能满足请求
+		static void MappingSearch(std::uint32_t size, std::uint32_t& fl, std::uint32_t& sl) noexcept;
+		std::uint32_t FindFreeBlock(std::uint32_t fl, std::uint32_t sl) const noexcept;
+		void PushFreeBlock(std::uint32_t offset) noexcept;
+		void RemoveFreeBlock(std::uint32_t offset) noexcept;
+		void SetPrevPhysical(std::uint32_t offset, std::uint32_t prev) noexcept;
+
+	private:
+		const std::uint32_t m_Capacity;
+		std::uint32_t m_UsedCount = 0;
+
+		std::vector<Block> m_Blocks;
+		std::uint32_t m_FirstLevelMask = 0;
+		std::array<std::uint32_t, FirstLevelCount> m_SecondLevelMask{};
+		std::array<std::uint32_t, FirstLevelCount * SecondLevelCount> m_FreeListHead;
+	};
+}
+
+#endif
@@ -0,0 +1,53 @@
+#pragma once
+#ifndef __FENCE__H__
+#define __FENCE__H__
+
+#include <cstdint>
+
+namespace DSM {
+	// 抽象的围栏计数器，资源的生命周期只依赖于此，便于脱离 GPU 进行模拟
+	class IFence
+	{
+	public:
+		virtual ~IFence() = default;
+
+		// 当前录制的帧在提交后将要发出的围栏值
+		virtual std::uint64_t GetCurrentValue() const = 0;
+		// 已经完成的围栏值
+		virtual std::uint64_t GetCompletedValue() const = 0;
+	};
+
+	// 完全在 CPU 端推进的围栏
+	class CPUFence : public IFence
+	{
+	public:
+		// 结束当前帧，返回该帧的围栏值
+		std::uint64_t Signal() noexcept
+		{
+			return ++m_SignaledValue;
+		}
+
+		// 模拟 GPU 执行完成到指定的围栏值
+		void Complete(std::uint64_t value) noexcept
+		{
+			if (value > m_SignaledValue) value = m_SignaledValue;
+			if (value > m_CompletedValue) m_CompletedValue = value;
+		}
+
+		std::uint64_t GetCurrentValue() const override
+		{
+			return m_SignaledValue + 1;
+		}
+
+		std::uint64_t GetCompletedValue() const override
+		{
+			return m_CompletedValue;
+		}
+
+	private:
+		std::uint64_t m_SignaledValue = 0;
+		std::uint64_t m_CompletedValue = 0;
+	};
+}
+
+#endif
@@ -2,19 +2,39 @@
 #include "D3DUtil.h"
 
 namespace DSM {
-	FrameResource::FrameResource(ID3D12Device* device)
-		: m_Device(device) {
+	FrameResource::FrameResource(
+		ID3D12Device* device,
+		IFence* fence,
+		D3D12UploadRingBuffer* uploadRingBuffer,
+		D3D12DescriptorRing* descriptorRing)
+		: m_Device(device), m_UploadRingBuffer(uploadRingBuffer), m_DescriptorRing(descriptorRing) {
+		assert(m_DescriptorRing != nullptr);
+
 		// 创建命令队列分配器
 		ThrowIfFailed(m_Device->CreateCommandAllocator(
 			D3D12_COMMAND_LIST_TYPE_DIRECT,
 			IID_PPV_ARGS(m_CmdListAlloc.GetAddressOf())));
 
-		m_DefaultBufferAllocator = std::make_unique<D3D12DefaultBufferAllocator>(m_Device.Get());
-		m_UploadBufferAllocator = std::make_unique<D3D12UploadBufferAllocator>(m_Device.Get());
-		m_DescriptorCaches = std::make_unique<D3D12DescriptorCache>(device, 2048);
+		m_DefaultBufferAllocator = std::make_unique<D3D12DefaultBufferAllocator>(m_Device.Get(), fence, BufferPoolSize);
+		m_UploadBufferAllocator = std::make_unique<D3D12UploadBufferAllocator>(m_Device.Get(), fence, BufferPoolSize);
 		m_DescriptorHeaps = std::make_unique<D3D12DescriptorCache>(device);
 	}
 
+	FrameResource::FrameResource(FrameResource& owner)
+		: m_Device(owner.m_Device), m_UploadRingBuffer(owner.m_UploadRingBuffer),
+		m_DescriptorRing(owner.m_DescriptorRing), m_Owner(&owner) {
+		assert(m_Owner->m_Owner == nullptr);
+
+		ThrowIfFailed(m_Device->CreateCommandAllocator(
+			D3D12_COMMAND_LIST_TYPE_DIRECT,
+			IID_PPV_ARGS(m_CmdListAlloc.GetAddressOf())));
+
+		if (m_UploadRingBuffer != nullptr) {
+			m_UploadSlice = std::make_unique<D3D12UploadRingSlice>(m_UploadRingBuffer);
+		}
+		m_DescriptorSlice = std::make_unique<D3D12DescriptorRingSlice>(m_Device.Get(), m_DescriptorRing);
+	}
+
 	void FrameResource::AddConstantBuffer(
 		UINT byteSize,
 		UINT elementSize,
@@ -29,14 +49,82 @@ namespace DSM {
 		AddUploadBuffer(byteSize, elementSize, bufferName, false);
 	}
 
-	void FrameResource::ClearUp(std::uint64_t fenceValue)
+	void FrameResource::AllocateTransientBuffer(
+		UINT byteSize,
+		UINT alignment,
+		D3D12ResourceLocation& resourceLocation)
+	{
+		if (m_UploadSlice != nullptr &&
+			m_UploadSlice->Allocate(byteSize, alignment, resourceLocation)) {
+			return;
+		}
+		if (m_UploadRingBuffer != nullptr &&
+			m_UploadRingBuffer->Allocate(byteSize, alignment, resourceLocation)) {
+			return;
+		}
+
+		// 环形缓冲区已满则从上传堆中分配，并立即释放，内存在当前帧完成后才会被回收
+		auto& owner = m_Owner == nullptr ? *this : *m_Owner;
+		std::lock_guard<std::mutex> lock(owner.m_UploadMutex);
+		owner.m_UploadBufferAllocator->AllocateUploadBuffer(byteSize, alignment, resourceLocation);
+		owner.m_UploadBufferAllocator->Deallocate(resourceLocation);
+	}
+
+	D3D12DescriptorHandle FrameResource::AllocateDescriptorTable(
+		const D3D12DescriptorHandle* srcHandles,
+		std::uint32_t count)
 	{
-		// 若当前的围栏值大于该帧缓冲区的围栏值，则可释放帧资源内部数据
-		if (fenceValue >= m_Fence) {
-			m_DefaultBufferAllocator->ClearUpAllocations();
-			m_UploadBufferAllocator->ClearUpAllocations();
-			m_DescriptorCaches->Clear();
+		// 主帧资源使用环形堆的帧内缓存，同一帧中相同的描述符表只会复制一次
+		if (m_DescriptorSlice != nullptr) {
+			return m_DescriptorSlice->AllocateAndCopy(srcHandles, count);
 		}
+		return m_DescriptorRing->AllocateAndCopy(srcHandles, count);
+	}
+
+	void FrameResource::CreateWorkers(std::uint32_t workerCount)
+	{
+		assert(m_Owner == nullptr);
+		while (m_Workers.size() > workerCount) {
+			m_Workers.pop_back();
+		}
+		while (m_Workers.size() < workerCount) {
+			m_Workers.push_back(std::make_unique<FrameResource>(*this));
+		}
+	}
+
+	ID3D12GraphicsCommandList* FrameResource::GetCommandList(std::uint32_t index)
+	{
+		while (m_CommandLists.size() <= index) {
+			ComPtr<ID3D12GraphicsCommandList> cmdList;
+			ThrowIfFailed(m_Device->CreateCommandList(
+				0,
+				D3D12_COMMAND_LIST_TYPE_DIRECT,
+				m_CmdListAlloc.Get(),
+				nullptr,
+				IID_PPV_ARGS(cmdList.GetAddressOf())));
+			ThrowIfFailed(cmdList->Close());
+			m_CommandLists.push_back(std::move(cmdList));
+		}
+		return m_CommandLists[index].Get();
+	}
+
+	void FrameResource::BeginRecording()
+	{
+		if (m_UploadSlice != nullptr) {
+			m_UploadSlice->Reset();
+		}
+		if (m_DescriptorSlice != nullptr) {
+			m_DescriptorSlice->Reset();
+		}
+		m_CommandListState.Reset(nullptr);
+		m_ConstantBufferUploadBytes = 0;
+	}
+
+	void FrameResource::ClearUp()
+	{
+		// 分配器根据每个内存块的围栏值回收
+		m_DefaultBufferAllocator->ClearUpAllocations();
+		m_UploadBufferAllocator->ClearUpAllocations();
 	}
 
 	void FrameResource::AddUploadBuffer(
@@ -51,6 +139,6 @@ namespace DSM {
 		auto resourceLocation = std::make_shared<D3D12ResourceLocation>();
 		m_UploadBufferAllocator->AllocateUploadBuffer(byteSize, alignment, *resourceLocation);
 
-		m_Resources[bufferName] = resourceLocation;
+		m_Resources[ShaderPropertyID::Register(bufferName)] = resourceLocation;
 	}
 }
@@ -5,6 +5,10 @@
 #include "Pubh.h"
 #include "D3D12Allocatioin.h"
 #include "D3D12DescriptorHeap.h"
+#include "D3D12DescriptorAllocator.h"
+#include "D3D12CommandListState.h"
+#include "ShaderPropertyID.h"
+#include <mutex>
 
 namespace DSM {
 	class D3D12DescriptorCache;
@@ -13,7 +17,14 @@ namespace DSM {
 	// 帧资源
 	struct FrameResource
 	{
-		FrameResource(ID3D12Device* device);
+		FrameResource(
+			ID3D12Device* device,
+			IFence* fence,
+			D3D12UploadRingBuffer* uploadRingBuffer,
+			D3D12DescriptorRing* descriptorRing);
+		// 并行录制时工作线程使用的帧资源，拥有独立的命令分配器与环形缓冲区中的分段
+		// 常量缓冲区等资源仍属于 owner，环形缓冲区已满时从 owner 的上传堆中分配
+		explicit FrameResource(FrameResource& owner);
 		FrameResource(const FrameResource& other) = delete;
 		FrameResource& operator=(const FrameResource& other) = delete;
 		~FrameResource() = default;
@@ -29,8 +40,27 @@ namespace DSM {
 			UINT elementSize,
 			const std::string& bufferName);
 
-		void ClearUp(std::uint64_t fenceValue);
+		// 分配只在当前帧有效的上传内存，优先使用环形缓冲区
+		void AllocateTransientBuffer(
+			UINT byteSize,
+			UINT alignment,
+			D3D12ResourceLocation& resourceLocation);
+		// 将一组 CPU 描述符复制到当前帧有效的 Shader Visible 描述符表，返回起始句柄
+		D3D12DescriptorHandle AllocateDescriptorTable(const D3D12DescriptorHandle* srcHandles, std::uint32_t count);
+
+		// 创建工作线程使用的帧资源，数量不变时保留已有的帧资源
+		void CreateWorkers(std::uint32_t workerCount);
+		// 使用本帧资源的命令分配器的额外命令列表，首次获取时创建并关闭，使用前需 Reset
+		// 同一分配器上同时只能有一个命令列表处于录制状态
+		ID3D12GraphicsCommandList* GetCommandList(std::uint32_t index);
+		// 每帧录制前调用，丢弃上一帧环形缓冲区中剩余的分段并清空统计
+		void BeginRecording();
 
+		// 回收 GPU 已完成的资源
+		void ClearUp();
+
+		// 帧资源内分配器的默认大小
+		inline static constexpr std::size_t BufferPoolSize = 1024 * 1024 * 16;
 
 		template <class T>
 		using ComPtr = Microsoft::WRL::ComPtr<T>;
@@ -40,12 +70,31 @@ namespace DSM {
 		// 管理所有资源的分配
 		std::unique_ptr<D3D12DefaultBufferAllocator> m_DefaultBufferAllocator;
 		std::unique_ptr<D3D12UploadBufferAllocator> m_UploadBufferAllocator;
-		std::unordered_map<std::string, std::shared_ptr<D3D12ResourceLocation>> m_Resources;
+		// 以名称的 ShaderPropertyID 索引，每帧查找时不需要构造字符串
+		std::unordered_map<ShaderPropertyID, std::shared_ptr<D3D12ResourceLocation>> m_Resources;
+		// 所有帧资源共用的环形上传缓冲区
+		D3D12UploadRingBuffer* m_UploadRingBuffer = nullptr;
 
-		// 描述符缓冲区
-		std::unique_ptr<D3D12DescriptorCache> m_DescriptorCaches;
+		// 所有帧资源共用的 Shader Visible 描述符环形堆
+		D3D12DescriptorRing* m_DescriptorRing = nullptr;
 		// 存放所有的描述符
 		std::unique_ptr<D3D12DescriptorCache> m_DescriptorHeaps;
+		// 记录当前帧命令列表上已设置的状态，用于跳过冗余的设置
+		D3D12CommandListState m_CommandListState;
+		// 收集描述符表的源描述符，每个录制线程使用自己的帧资源，复用容量避免每次绘制分配
+		std::vector<D3D12DescriptorHandle> m_TableHandles;
+
+		// 当前帧写入上传堆的常量缓冲区字节数
+		std::uint64_t m_ConstantBufferUploadBytes = 0;
+
+		// 并行录制使用的额外命令列表与工作线程的帧资源
+		std::vector<ComPtr<ID3D12GraphicsCommandList>> m_CommandLists;
+		std::vector<std::unique_ptr<FrameResource>> m_Workers;
+		// 工作线程的帧资源所属的帧资源，主帧资源为空
+		FrameResource* m_Owner = nullptr;
+		// 只在工作线程的帧资源中创建，分段内分配不需要加锁
+		std::unique_ptr<D3D12UploadRingSlice> m_UploadSlice;
+		std::unique_ptr<D3D12DescriptorRingSlice> m_DescriptorSlice;
 
 		UINT64 m_Fence = 0;													// 当前帧资源的围栏值
 
@@ -55,6 +104,10 @@ namespace DSM {
 			UINT elementSize,
 			const std::string& bufferName,
 			bool isConstant);
+
+	private:
+		// 保护上传堆的回退分配，多个工作线程可能同时用尽环形缓冲区
+		std::mutex m_UploadMutex;
 	};
 }
 
@@ -0,0 +1,131 @@
+#include "FrustumCuller.h"
+#include <algorithm>
+#include <cmath>
+
+using namespace DirectX;
+
+namespace DSM {
+	void FrustumCuller::Clear() noexcept
+	{
+		m_Blocks.clear();
+		m_BoxCount = 0;
+	}
+
+	void FrustumCuller::Reserve(std::size_t boxCount)
+	{
+		m_Blocks.reserve((boxCount + BlockSize - 1) / BlockSize);
+	}
+
+	std::uint32_t FrustumCuller::AddBox(const XMFLOAT3& center, const XMFLOAT3& extents, const XMFLOAT4X4& world)
+	{
+		// 行向量约定，中心直接变换，半长为各轴在矩阵绝对值下的投影之和
+		const auto& m = world.m;
+		float worldCenter[3]{};
+		float worldExtents[3]{};
+		for (int i = 0; i < 3; ++i) {
+			worldCenter[i] = center.x * m[0][i] + center.y * m[1][i] + center.z * m[2][i] + m[3][i];
+			worldExtents[i] = extents.x * std::abs(m[0][i]) + extents.y * std::abs(m[1][i]) + extents.z * std::abs(m[2][i]);
+		}
+
+		auto lane = m_BoxCount % BlockSize;
+		if (lane == 0) {
+			auto zero = XMVectorZero();
+			m_Blocks.push_back(BoxBlock{ zero, zero, zero, zero, zero, zero });
+		}
+		auto& block = m_Blocks.back();
+		block.m_CenterX = XMVectorSetByIndex(block.m_CenterX, worldCenter[0], lane);
+		block.m_CenterY = XMVectorSetByIndex(block.m_CenterY, worldCenter[1], lane);
+		block.m_CenterZ = XMVectorSetByIndex(block.m_CenterZ, worldCenter[2], lane);
+		block.m_ExtentsX = XMVectorSetByIndex(block.m_ExtentsX, worldExtents[0], lane);
+		block.m_ExtentsY = XMVectorSetByIndex(block.m_ExtentsY, worldExtents[1], lane);
+		block.m_ExtentsZ = XMVectorSetByIndex(block.m_ExtentsZ, worldExtents[2], lane);
+
+		return m_BoxCount++;
+	}
+
+	std::uint32_t FrustumCuller::GetBoxCount() const noexcept
+	{
+		return m_BoxCount;
+	}
+
+	void FrustumCuller::Cull(const Planes& planes, std::vector<std::uint32_t>& visible) const
+	{
+		visible.clear();
+
+		// 平面的各分量预先展开到 4 个通道
+		struct PlaneSIMD
+		{
+			XMVECTOR m_NormalX, m_NormalY, m_NormalZ, m_Distance;
+			XMVECTOR m_AbsNormalX, m_AbsNormalY, m_AbsNormalZ;
+		};
+		std::array<PlaneSIMD, 6> planeSIMD;
+		for (std::size_t i = 0; i < planes.size(); ++i) {
+			const auto& plane = planes[i];
+			planeSIMD[i].m_NormalX = XMVectorReplicate(plane.x);
+			planeSIMD[i].m_NormalY = XMVectorReplicate(plane.y);
+			planeSIMD[i].m_NormalZ = XMVectorReplicate(plane.z);
+			planeSIMD[i].m_Distance = XMVectorReplicate(plane.w);
+			planeSIMD[i].m_AbsNormalX = XMVectorReplicate(std::abs(plane.x));
+			planeSIMD[i].m_AbsNormalY = XMVectorReplicate(std::abs(plane.y));
+			planeSIMD[i].m_AbsNormalZ = XMVectorReplicate(std::abs(plane.z));
+		}
+
+		auto zero = XMVectorZero();
+		for (std::uint32_t blockIndex = 0; blockIndex < m_Blocks.size(); ++blockIndex) {
+			const auto& block = m_Blocks[blockIndex];
+
+			auto inside = XMVectorTrueInt();
+			for (const auto& plane : planeSIMD) {
+				// 中心到平面的距离加上包围盒在法线方向上的投影半径仍小于 0 时，包围盒完全在外侧
+				auto dist = XMVectorMultiplyAdd(block.m_CenterX, plane.m_NormalX, plane.m_Distance);
+				dist = XMVectorMultiplyAdd(block.m_CenterY, plane.m_NormalY, dist);
+				dist = XMVectorMultiplyAdd(block.m_CenterZ, plane.m_NormalZ, dist);
+				auto radius = XMVectorMultiply(block.m_ExtentsX, plane.m_AbsNormalX);
+				radius = XMVectorMultiplyAdd(block.m_ExtentsY, plane.m_AbsNormalY, radius);
+				radius = XMVectorMultiplyAdd(block.m_ExtentsZ, plane.m_AbsNormalZ, radius);
+				inside = XMVectorAndInt(inside, XMVectorGreaterOrEqual(XMVectorAdd(dist, radius), zero));
+			}
+			if (XMVector4EqualInt(inside, XMVectorFalseInt())) continue;
+
+			std::uint32_t mask[BlockSize];
+			XMStoreInt4(mask, inside);
+			auto baseIndex = blockIndex * BlockSize;
+			auto laneCount = (std::min)(BlockSize, m_BoxCount - baseIndex);
+			for (std::uint32_t lane = 0; lane < laneCount; ++lane) {
+				if (mask[lane] != 0) {
+					visible.push_back(baseIndex + lane);
+				}
+			}
+		}
+	}
+
+	void FrustumCuller::Cull(const XMFLOAT4X4& viewProj, std::vector<std::uint32_t>& visible) const
+	{
+		Cull(ExtractPlanes(viewProj), visible);
+	}
+
+	FrustumCuller::Planes FrustumCuller::ExtractPlanes(const XMFLOAT4X4& viewProj) noexcept
+	{
+		// 行向量约定下裁剪坐标为位置与矩阵各列的点积，D3D 的深度范围为 [0, w]
+		const auto& m = viewProj.m;
+		auto column = [&m](int c) {
+			return XMFLOAT4{ m[0][c], m[1][c], m[2][c], m[3][c] };
+			};
+		auto add = [](const XMFLOAT4& a, const XMFLOAT4& b) {
+			return XMFLOAT4{ a.x + b.x, a.y + b.y, a.z + b.z, a.w + b.w };
+			};
+		auto sub = [](const XMFLOAT4& a, const XMFLOAT4& b) {
+			return XMFLOAT4{ a.x - b.x, a.y - b.y, a.z - b.z, a.w - b.w };
+			};
+
+		auto x = column(0), y = column(1), z = column(2), w = column(3);
+		return Planes{
+			add(w, x),		// 左
+			sub(w, x),		// 右
+			add(w, y),		// 下
+			sub(w, y),		// 上
+			z,				// 近
+			sub(w, z)		// 远
+		};
+	}
+}
@@ -0,0 +1,55 @@
+#pragma once
+#ifndef __FRUSTUMCULLER__H__
+#define __FRUSTUMCULLER__H__
+
+#include <DirectXMath.h>
+#include <array>
+#include <cstdint>
+#include <vector>
+
+namespace DSM {
+	// CPU 视锥体剔除
+	// 世界空间的包围盒以 SoA 形式每 4 个一组存放，每次迭代同时测试 4 个包围盒与一个平面
+	class FrustumCuller
+	{
+	public:
+		// 平面 (a, b, c, d) 满足 ax + by + cz + d >= 0 的一侧为视锥体内部
+		using Planes = std::array<DirectX::XMFLOAT4, 6>;
+
+		// 保留已分配的内存，每帧重新加入包围盒
+		void Clear() noexcept;
+		void Reserve(std::size_t boxCount);
+		// 局部空间的包围盒经 world 变换后取其世界空间的轴对齐包围盒，返回加入的索引
+		std::uint32_t AddBox(
+			const DirectX::XMFLOAT3& center,
+			const DirectX::XMFLOAT3& extents,
+			const DirectX::XMFLOAT4X4& world);
+		std::uint32_t GetBoxCount() const noexcept;
+
+		// 与视锥体相交或在其内部的包围盒索引按升序写入 visible
+		void Cull(const Planes& planes, std::vector<std::uint32_t>& visible) const;
+		void Cull(const DirectX::XMFLOAT4X4& viewProj, std::vector<std::uint32_t>& visible) const;
+
+		// 由观察投影矩阵提取六个平面，透视与正交投影都适用，平面未归一化不影响测试结果
+		static Planes ExtractPlanes(const DirectX::XMFLOAT4X4& viewProj) noexcept;
+
+	private:
+		static constexpr std::uint32_t BlockSize = 4;
+
+		// 每个分量的 4 个通道对应 4 个包围盒
+		struct BoxBlock
+		{
+			DirectX::XMVECTOR m_CenterX;
+			DirectX::XMVECTOR m_CenterY;
+			DirectX::XMVECTOR m_CenterZ;
+			DirectX::XMVECTOR m_ExtentsX;
+			DirectX::XMVECTOR m_ExtentsY;
+			DirectX::XMVECTOR m_ExtentsZ;
+		};
+
+		std::vector<BoxBlock> m_Blocks;
+		std::uint32_t m_BoxCount = 0;
+	};
+}
+
+#endif
@@ -1,4 +1,5 @@
 #include "ImguiManager.h"
+#include <fstream>
 
 using namespace DirectX;
 
@@ -22,6 +23,7 @@ namespace DSM {
 			ImGui::Text("Light Color: (%.1f, %.1f, %.1f)",m_LightColor.x, m_LightColor.y, m_LightColor.z);
 			ImGui::SliderFloat3("##5", lightColor, 0, 1,"");
 
+			ImGui::Checkbox("Enable Fog", &m_EnableFog);
 			ImGui::Text("Fog Color: (%.1f, %.1f, %.1f)", m_FogColor.x, m_FogColor.y, m_FogColor.z);
 			ImGui::SliderFloat3("##6", fogColor, 0, 1, "");
 			ImGui::Text("Fog Start: %.2f", fogStart);
@@ -31,9 +33,32 @@ namespace DSM {
 
 			ImGui::Text("Blur Count: %", m_BlurCount);
 			ImGui::SliderInt("##9", &m_BlurCount, 0, 10, "");
+
+			ImGui::Text("State Calls: %llu  Skipped: %llu",
+				m_CommandListStats.GetIssuedCount(), m_CommandListStats.GetSkippedCount());
+			ImGui::Text("PSO: %llu/%llu  Root Signature: %llu/%llu",
+				m_CommandListStats.m_PipelineStateCalls, m_CommandListStats.m_PipelineStateSkipped,
+				m_CommandListStats.m_RootSignatureCalls, m_CommandListStats.m_RootSignatureSkipped);
+			ImGui::Text("Heaps: %llu/%llu  Root Arguments: %llu/%llu",
+				m_CommandListStats.m_DescriptorHeapCalls, m_CommandListStats.m_DescriptorHeapSkipped,
+				m_CommandListStats.m_RootArgumentCalls, m_CommandListStats.m_RootArgumentSkipped);
+			ImGui::Text("Constant Buffer Upload: %.2f KB", m_ConstantBufferUploadBytes / 1024.0);
+			ImGui::Text("Draws: %u/%u  Shadow Draws: %u/%u",
+				m_VisibleDrawCount, m_TotalDrawCount, m_ShadowDrawCount, m_TotalDrawCount);
+			ImGui::Text("Transform Updates: %u", m_TransformUpdateCount);
+			ImGui::Checkbox("Parallel Record", &m_EnableParallelRecord);
+			ImGui::Text("Record Workers: %u  Command Lists: %u", m_RecordWorkerCount, m_RecordCommandListCount);
+			ImGui::Text("Shader Reload: %u  Rejected: %u  Failed: %u",
+				m_ShaderReloadStats.m_Reloaded, m_ShaderReloadStats.m_Rejected, m_ShaderReloadStats.m_Failed);
+			ImGui::Text("Shader Compiles: %u  Shared: %u",
+				m_ShaderReloadStats.m_Submitted, m_ShaderReloadStats.m_Shared);
+			if (!m_ShaderReloadStats.m_LastError.empty()) {
+				ImGui::TextWrapped("%s", m_ShaderReloadStats.m_LastError.c_str());
+			}
 		}
 		ImGui::End();
 
+		UpdateAllocatorStats();
 		
 		m_LightColor = {lightColor[0], lightColor[1], lightColor[2]};
 		m_LightDir = {lightDir[0], lightDir[1], lightDir[2]};
@@ -42,6 +67,41 @@ namespace DSM {
 		m_FogRange = fogRange;
 	}
 
+	void ImguiManager::UpdateAllocatorStats()
+	{
+		auto toMB = [](std::uint64_t bytes) {
+			return static_cast<double>(bytes) / (1024.0 * 1024.0);
+			};
+
+		if (ImGui::Begin("Allocator Stats"))
+		{
+			if (ImGui::Button("Dump JSON")) {
+				std::ofstream file("AllocatorStats.json");
+				file << AllocatorStatsToJson(m_AllocatorStats);
+			}
+
+			for (const auto& stats : m_AllocatorStats) {
+				if (!ImGui::CollapsingHeader(stats.m_Name.c_str())) continue;
+
+				ImGui::Text("Requested: %.2f MB  Reserved: %.2f MB", toMB(stats.m_RequestedBytes), toMB(stats.m_ReservedBytes));
+				ImGui::Text("Internal Waste: %.2f MB", toMB(stats.m_InternalWaste));
+				ImGui::Text("Pools: %u  Pool Size: %.2f MB", stats.m_PoolCount, toMB(stats.m_PoolBytes));
+				ImGui::Text("Largest Free Block: %.2f MB", toMB(stats.m_LargestFreeBlock));
+				ImGui::Text("High Water Mark: %.2f MB", toMB(stats.m_HighWaterMark));
+				ImGui::Text("Fragmentation: %.1f%%", stats.GetFragmentation() * 100);
+				ImGui::Text("Live: %llu  Alloc/s: %.1f  Free/s: %.1f",
+					stats.m_LiveAllocations, stats.m_AllocationRate, stats.m_FreeRate);
+
+				// 每一层级的空闲大小
+				for (std::size_t order = 0; order < stats.m_FreeBytesPerOrder.size(); ++order) {
+					if (stats.m_FreeBytesPerOrder[order] == 0) continue;
+					ImGui::BulletText("Order %zu: %.2f MB", order, toMB(stats.m_FreeBytesPerOrder[order]));
+				}
+			}
+		}
+		ImGui::End();
+	}
+
 	void ImguiManager::RenderImGui(ID3D12GraphicsCommandList* cmdList)
 	{
 		BaseImGuiManager<ImguiManager>::RenderImGui(cmdList);
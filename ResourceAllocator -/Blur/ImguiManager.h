@@ -5,6 +5,9 @@
 #include "BaseImGuiManager.h"
 #include "Transform.h"
 #include "D3D12DescriptorHeap.h"
+#include "AllocatorStats.h"
+#include "D3D12CommandListState.h"
+#include "ShaderHotReload.h"
 
 namespace DSM {
 	class ImguiManager : public BaseImGuiManager<ImguiManager>
@@ -23,16 +26,37 @@ namespace DSM {
 		virtual ~ImguiManager() = default;
 
 		void UpdateImGui(const CpuTimer& timer) override;
+		void UpdateAllocatorStats();
 
 	public:
 		DirectX::XMFLOAT3 m_LightDir;
 		DirectX::XMFLOAT3 m_LightColor;
 
+		bool m_EnableFog = false;
 		float m_FogStart = 10;
 		float m_FogRange = 100;
 		DirectX::XMFLOAT3 m_FogColor = DirectX::XMFLOAT3(1, 1, 1);
 
 		int m_BlurCount = 1;
+
+		std::vector<AllocatorStats> m_AllocatorStats;
+		// 上一帧命令列表状态设置的统计
+		CommandListStateStats m_CommandListStats;
+		// 上一帧写入上传堆的常量缓冲区字节数
+		std::uint64_t m_ConstantBufferUploadBytes = 0;
+		// 视锥体剔除前后的子网格数量
+		std::uint32_t m_TotalDrawCount = 0;
+		std::uint32_t m_VisibleDrawCount = 0;
+		std::uint32_t m_ShadowDrawCount = 0;
+		// 本帧重新计算世界矩阵的物体数量
+		std::uint32_t m_TransformUpdateCount = 0;
+
+		// 将可见的绘制分配给多个线程录制
+		bool m_EnableParallelRecord = false;
+		std::uint32_t m_RecordWorkerCount = 0;
+		std::uint32_t m_RecordCommandListCount = 0;
+		// 着色器热重载的统计，未启用时为空
+		ShaderHotReloadStats m_ShaderReloadStats;
 	};
 }
 
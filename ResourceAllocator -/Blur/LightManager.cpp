@@ -38,6 +38,11 @@ namespace DSM {
 		return m_LightBufferName;
 	}
 
+	ShaderPropertyID LightManager::GetLightBufferID() const
+	{
+		return m_LightBufferID;
+	}
+
 	/// <summary>
 	/// 获取对齐后的所有光源大小
 	/// </summary>
@@ -4,6 +4,7 @@
 
 #include "Singleton.h"
 #include "Light.h"
+#include "ShaderPropertyID.h"
 
 namespace DSM {
 	class FrameResource;
@@ -22,6 +23,7 @@ namespace DSM {
 		const void* GetPointLight() const;
 		const void* GetSpotLight() const;
 		const std::string& GetLightBufferName() const;
+		ShaderPropertyID GetLightBufferID() const;
 		UINT GetLightByteSize() const;
 		std::vector<D3D_SHADER_MACRO> GetLightsShaderMacros(
 			const char* dirName,
@@ -42,6 +44,7 @@ namespace DSM {
 
 	private:
 		const std::string m_LightBufferName = "LightBuffer";
+		const ShaderPropertyID m_LightBufferID{ m_LightBufferName };
 
 		std::vector<DirectionalLight> m_DirLights;
 		std::vector<PointLight> m_PointLights;
@@ -137,7 +137,12 @@ namespace DSM {
 		modelMesh.m_Mesh = mesh;
 		modelMesh.m_Name = name;
 		modelMesh.m_MaterialIndex = 0;
-		modelMesh.m_BoundingBox = BoundingBox{};
+		// 包围盒用于视锥体剔除，需由顶点计算
+		BoundingBox::CreateFromPoints(
+			modelMesh.m_BoundingBox,
+			mesh.m_Vertices.size(),
+			&mesh.m_Vertices[0].m_Position,
+			sizeof(Vertex));
 
 		model.SetName(name);
 		model.SetMesh(modelMesh);
@@ -2,7 +2,7 @@
 #ifndef __OBJECTMANAGER__H__
 #define __OBJECTMANAGER__H__
 
-#include "Object.h"
+#include "ObjectStore.h"
 #include "Singleton.h"
 #include "D3DUtil.h"
 #include "FrameResource.h"
@@ -11,82 +11,29 @@
 class CpuTimer;
 
 namespace DSM {
-	enum class RenderLayer : int
-	{
-		Opaque = 0,
-		Transparent = 1,
-		AlphaTest = 2,
-		Mirror = 3,
-		Reflection = 4,
-		Count
-	};
-
 	class ObjectManager : public Singleton<ObjectManager>
 	{
 	public:
-		using ObjectMap = std::map<std::string, std::shared_ptr<Object>>;
+		// 名称重复或层级无效时返回无效句柄
+		ObjectHandle AddObject(const std::string& name, const Model* model, RenderLayer layer);
+		bool RemoveObject(ObjectHandle handle);
 
-		bool AddObject(std::shared_ptr<Object> object, RenderLayer layer) noexcept;
-		//bool RemoveObject(std::shared_ptr<Object> object) noexcept;
-
-		std::vector<ObjectMap>& GetAllObject() noexcept;
-		const std::shared_ptr<Object> GetObjectByName(const std::string& name) const;
-		std::shared_ptr<Object> GetObjectByName(const std::string& name);
-		const std::shared_ptr<Object> GetObjectByName(const std::string& name, RenderLayer layer) const;
-		std::shared_ptr<Object> GetObjectByName(const std::string& name, RenderLayer layer);
+		ObjectStore& GetObjectStore() noexcept;
+		const ObjectStore& GetObjectStore() const noexcept;
+		ObjectHandle GetObjectByName(const std::string& name) const;
 		std::size_t GetObjectCount() const noexcept;
 		std::size_t GetMaterialCount() const noexcept;
 		std::size_t GetObjectWithModelCount() const noexcept;
 
-		// 创建所有对象的常量缓冲区资源
-		void CreateObjectsResource(FrameResource* frameResource, UINT CBByteSize, UINT matCBByteSize) const;
-
-		template<typename ObjCBFunc, typename MatCBFunc>
-		void UpdateObjectsCB(
-			FrameResource* frameReource,
-			ObjCBFunc objFunc,
-			MatCBFunc matFunc);
-
 	protected:
 		friend class Singleton<ObjectManager>;
-		ObjectManager();
+		ObjectManager() = default;
 		virtual ~ObjectManager() = default;
 
 	protected:
-		std::vector<ObjectMap> m_Objects;
+		ObjectStore m_ObjectStore;
 	};
 
-	template<typename ObjCBFunc, typename MatCBFunc>
-	inline void ObjectManager::UpdateObjectsCB(
-		FrameResource* frameReource,
-		ObjCBFunc objFunc,
-		MatCBFunc matFunc)
-	{
-		if (frameReource == nullptr)return;
-
-		for (std::size_t i = 0; i < m_Objects.size(); ++i) {
-			for (auto& [name, obj] : m_Objects[i]) {
-				auto it = frameReource->m_Resources.find(name);
-				if (it == frameReource->m_Resources.end() || obj->GetModel() == nullptr) continue;
-
-				auto resource = it->second;
-				
-				BYTE* mappedData = static_cast<BYTE*>(resource->m_MappedBaseAddress);
-
-				decltype(auto) objCB = objFunc(*obj, static_cast<RenderLayer>(i));
-				auto objByteSize = D3DUtil::CalcCBByteSize(sizeof(objCB));
-				memcpy(mappedData, &objCB, objByteSize);
-
-				std::size_t counter = 0;
-				for (const auto& mat : obj->GetModel()->GetAllMaterial()) {
-					decltype(auto) matCB = matFunc(mat);
-					auto matByteSize = D3DUtil::CalcCBByteSize(sizeof(matCB));
-					memcpy(mappedData + objByteSize + counter++ * matByteSize, &matCB, matByteSize);
-				}
-			}
-		}
-	}
-
 }
 
 #endif // !__OBJECTMANAGER__H__
@@ -0,0 +1,462 @@
+#include "ObjectStore.h"
+#include "Model.h"
+#include "MathHelper.h"
+#include <algorithm>
+#include <cassert>
+
+using namespace DirectX;
+
+namespace DSM {
+	ObjectHandle ObjectStore::Create(const std::string& name, const Model* model, RenderLayerMask layerMask)
+	{
+		if (m_NameIndex.contains(name)) {
+			return ObjectHandle{};
+		}
+
+		std::uint32_t slotIndex;
+		if (!m_FreeSlots.empty()) {
+			slotIndex = m_FreeSlots.back();
+			m_FreeSlots.pop_back();
+		}
+		else {
+			slotIndex = static_cast<std::uint32_t>(m_Slots.size());
+			m_Slots.emplace_back();
+		}
+
+		auto& slot = m_Slots[slotIndex];
+		slot.m_DenseIndex = static_cast<std::uint32_t>(m_Handles.size());
+		ObjectHandle handle{ slotIndex, slot.m_Generation };
+
+		XMFLOAT4X4 identity;
+		XMStoreFloat4x4(&identity, XMMatrixIdentity());
+		auto bounds = ComputeModelBounds(model);
+
+		m_Handles.push_back(handle);
+		m_Transforms.emplace_back();
+		m_Parents.emplace_back();
+		m_WorldMatrices.push_back(identity);
+		m_WorldInvTransposes.push_back(identity);
+		m_LocalBounds.push_back(bounds);
+		m_WorldBounds.push_back(bounds);
+		m_Models.push_back(model);
+		m_LayerMasks.push_back(layerMask);
+		m_Names.push_back(name);
+		m_TransformDirty.push_back(0);
+		m_NameIndex.emplace(name, handle);
+
+		MarkDirty(slot.m_DenseIndex);
+		m_HierarchyDirty = true;
+
+		return handle;
+	}
+
+	bool ObjectStore::Destroy(ObjectHandle handle)
+	{
+		if (!IsAlive(handle)) {
+			return false;
+		}
+
+		// 子树在拓扑顺序中连续，先记录句柄，删除时稠密下标会改变
+		if (m_HierarchyDirty) {
+			RebuildHierarchyOrder();
+		}
+		auto begin = m_OrderPositions[GetDenseIndex(handle)];
+		auto end = m_SubtreeEnds[begin];
+		std::vector<ObjectHandle> subtree;
+		subtree.reserve(end - begin);
+		for (auto i = begin; i < end; ++i) {
+			subtree.push_back(m_Handles[m_Order[i]]);
+		}
+
+		for (const auto& object : subtree) {
+			RemoveDense(GetDenseIndex(object));
+		}
+		m_HierarchyDirty = true;
+
+		return true;
+	}
+
+	void ObjectStore::Clear()
+	{
+		// 已分配的槽位保留并递增代数，之前的句柄全部失效
+		m_FreeSlots.clear();
+		for (std::uint32_t i = 0; i < m_Slots.size(); ++i) {
+			if (m_Slots[i].m_DenseIndex != ObjectHandle::InvalidIndex) {
+				m_Slots[i].m_DenseIndex = ObjectHandle::InvalidIndex;
+				++m_Slots[i].m_Generation;
+			}
+			m_FreeSlots.push_back(i);
+		}
+
+		m_Handles.clear();
+		m_Transforms.clear();
+		m_Parents.clear();
+		m_WorldMatrices.clear();
+		m_WorldInvTransposes.clear();
+		m_LocalBounds.clear();
+		m_WorldBounds.clear();
+		m_Models.clear();
+		m_LayerMasks.clear();
+		m_Names.clear();
+		m_TransformDirty.clear();
+		m_NameIndex.clear();
+
+		m_DirtyObjects.clear();
+		m_Order.clear();
+		m_OrderPositions.clear();
+		m_SubtreeEnds.clear();
+		m_HierarchyDirty = false;
+	}
+
+	void ObjectStore::Reserve(std::size_t count)
+	{
+		m_Slots.reserve(count);
+		m_Handles.reserve(count);
+		m_Transforms.reserve(count);
+		m_Parents.reserve(count);
+		m_WorldMatrices.reserve(count);
+		m_WorldInvTransposes.reserve(count);
+		m_LocalBounds.reserve(count);
+		m_WorldBounds.reserve(count);
+		m_Models.reserve(count);
+		m_LayerMasks.reserve(count);
+		m_Names.reserve(count);
+		m_TransformDirty.reserve(count);
+		m_NameIndex.reserve(count);
+		m_Order.reserve(count);
+		m_OrderPositions.reserve(count);
+		m_SubtreeEnds.reserve(count);
+	}
+
+	bool ObjectStore::IsAlive(ObjectHandle handle) const noexcept
+	{
+		return GetDenseIndex(handle) != ObjectHandle::InvalidIndex;
+	}
+
+	ObjectHandle ObjectStore::Find(const std::string& name) const
+	{
+		if (auto it = m_NameIndex.find(name); it != m_NameIndex.end()) {
+			return it->second;
+		}
+		return ObjectHandle{};
+	}
+
+	std::uint32_t ObjectStore::Size() const noexcept
+	{
+		return static_cast<std::uint32_t>(m_Handles.size());
+	}
+
+	std::uint32_t ObjectStore::GetDenseIndex(ObjectHandle handle) const noexcept
+	{
+		if (handle.m_Index >= m_Slots.size()) {
+			return ObjectHandle::InvalidIndex;
+		}
+		const auto& slot = m_Slots[handle.m_Index];
+		return slot.m_Generation == handle.m_Generation ? slot.m_DenseIndex : ObjectHandle::InvalidIndex;
+	}
+
+	const std::string& ObjectStore::GetName(ObjectHandle handle) const
+	{
+		return m_Names[GetValidDenseIndex(handle)];
+	}
+
+	Transform& ObjectStore::GetTransform(ObjectHandle handle)
+	{
+		auto denseIndex = GetValidDenseIndex(handle);
+		MarkDirty(denseIndex);
+		return m_Transforms[denseIndex];
+	}
+
+	const Transform& ObjectStore::GetTransform(ObjectHandle handle) const
+	{
+		return m_Transforms[GetValidDenseIndex(handle)];
+	}
+
+	bool ObjectStore::SetParent(ObjectHandle child, ObjectHandle parent)
+	{
+		auto childIndex = GetDenseIndex(child);
+		if (childIndex == ObjectHandle::InvalidIndex) {
+			return false;
+		}
+
+		if (parent.IsValid()) {
+			if (!IsAlive(parent)) {
+				return false;
+			}
+			// 沿父物体向上查找，避免形成环
+			for (auto curr = parent; curr.IsValid(); curr = m_Parents[GetDenseIndex(curr)]) {
+				if (curr == child) {
+					return false;
+				}
+			}
+		}
+		else {
+			parent = ObjectHandle{};
+		}
+
+		if (m_Parents[childIndex] != parent) {
+			m_Parents[childIndex] = parent;
+			MarkDirty(childIndex);
+			m_HierarchyDirty = true;
+		}
+		return true;
+	}
+
+	ObjectHandle ObjectStore::GetParent(ObjectHandle handle) const
+	{
+		return m_Parents[GetValidDenseIndex(handle)];
+	}
+
+	const XMFLOAT4X4& ObjectStore::GetWorldMatrix(ObjectHandle handle) const
+	{
+		return m_WorldMatrices[GetValidDenseIndex(handle)];
+	}
+
+	const XMFLOAT4X4& ObjectStore::GetWorldInvTranspose(ObjectHandle handle) const
+	{
+		return m_WorldInvTransposes[GetValidDenseIndex(handle)];
+	}
+
+	const BoundingBox& ObjectStore::GetWorldBounds(ObjectHandle handle) const
+	{
+		return m_WorldBounds[GetValidDenseIndex(handle)];
+	}
+
+	const Model* ObjectStore::GetModel(ObjectHandle handle) const
+	{
+		return m_Models[GetValidDenseIndex(handle)];
+	}
+
+	void ObjectStore::SetModel(ObjectHandle handle, const Model* model)
+	{
+		auto denseIndex = GetValidDenseIndex(handle);
+		m_Models[denseIndex] = model;
+		m_LocalBounds[denseIndex] = ComputeModelBounds(model);
+		// 世界空间的包围盒需要重新计算
+		MarkDirty(denseIndex);
+	}
+
+	RenderLayerMask ObjectStore::GetLayerMask(ObjectHandle handle) const
+	{
+		return m_LayerMasks[GetValidDenseIndex(handle)];
+	}
+
+	void ObjectStore::SetLayerMask(ObjectHandle handle, RenderLayerMask layerMask)
+	{
+		m_LayerMasks[GetValidDenseIndex(handle)] = layerMask;
+	}
+
+	std::uint32_t ObjectStore::UpdateWorldMatrices()
+	{
+		if (m_HierarchyDirty) {
+			RebuildHierarchyOrder();
+		}
+		if (m_DirtyObjects.empty()) {
+			return 0;
+		}
+
+		m_DirtyPositions.clear();
+		for (const auto& handle : m_DirtyObjects) {
+			if (auto denseIndex = GetDenseIndex(handle); denseIndex != ObjectHandle::InvalidIndex) {
+				m_DirtyPositions.push_back(m_OrderPositions[denseIndex]);
+			}
+		}
+		m_DirtyObjects.clear();
+		std::sort(m_DirtyPositions.begin(), m_DirtyPositions.end());
+
+		// 按拓扑顺序更新每棵脏子树，父物体总在子物体之前，已被祖先的子树覆盖的跳过
+		std::uint32_t updateCount = 0;
+		std::uint32_t coveredEnd = 0;
+		for (auto begin : m_DirtyPositions) {
+			if (begin < coveredEnd) continue;
+
+			auto end = m_SubtreeEnds[begin];
+			for (auto i = begin; i < end; ++i) {
+				UpdateWorldMatrix(m_Order[i]);
+			}
+			updateCount += end - begin;
+			coveredEnd = end;
+		}
+		return updateCount;
+	}
+
+	std::span<const ObjectHandle> ObjectStore::GetHandles() const noexcept
+	{
+		return m_Handles;
+	}
+
+	std::span<const Transform> ObjectStore::GetTransforms() const noexcept
+	{
+		return m_Transforms;
+	}
+
+	std::span<const XMFLOAT4X4> ObjectStore::GetWorldMatrices() const noexcept
+	{
+		return m_WorldMatrices;
+	}
+
+	std::span<const XMFLOAT4X4> ObjectStore::GetWorldInvTransposes() const noexcept
+	{
+		return m_WorldInvTransposes;
+	}
+
+	std::span<const BoundingBox> ObjectStore::GetLocalBounds() const noexcept
+	{
+		return m_LocalBounds;
+	}
+
+	std::span<const BoundingBox> ObjectStore::GetWorldBounds() const noexcept
+	{
+		return m_WorldBounds;
+	}
+
+	std::span<const Model* const> ObjectStore::GetModels() const noexcept
+	{
+		return m_Models;
+	}
+
+	std::span<const RenderLayerMask> ObjectStore::GetLayerMasks() const noexcept
+	{
+		return m_LayerMasks;
+	}
+
+	BoundingBox ObjectStore::ComputeModelBounds(const Model* model)
+	{
+		BoundingBox bounds{};
+		if (model == nullptr || model->GetAllMesh().empty()) {
+			return bounds;
+		}
+
+		auto it = model->GetAllMesh().begin();
+		bounds = it->second.m_BoundingBox;
+		for (++it; it != model->GetAllMesh().end(); ++it) {
+			BoundingBox::CreateMerged(bounds, bounds, it->second.m_BoundingBox);
+		}
+		return bounds;
+	}
+
+	std::uint32_t ObjectStore::GetValidDenseIndex(ObjectHandle handle) const
+	{
+		auto denseIndex = GetDenseIndex(handle);
+		assert(denseIndex != ObjectHandle::InvalidIndex);
+		return denseIndex;
+	}
+
+	void ObjectStore::RemoveDense(std::uint32_t denseIndex)
+	{
+		auto handle = m_Handles[denseIndex];
+		auto& slot = m_Slots[handle.m_Index];
+		auto lastIndex = static_cast<std::uint32_t>(m_Handles.size() - 1);
+		m_NameIndex.erase(m_Names[denseIndex]);
+
+		// 用最后一个物体填补空位，保持数组连续
+		if (denseIndex != lastIndex) {
+			m_Handles[denseIndex] = m_Handles[lastIndex];
+			m_Transforms[denseIndex] = m_Transforms[lastIndex];
+			m_Parents[denseIndex] = m_Parents[lastIndex];
+			m_WorldMatrices[denseIndex] = m_WorldMatrices[lastIndex];
+			m_WorldInvTransposes[denseIndex] = m_WorldInvTransposes[lastIndex];
+			m_LocalBounds[denseIndex] = m_LocalBounds[lastIndex];
+			m_WorldBounds[denseIndex] = m_WorldBounds[lastIndex];
+			m_Models[denseIndex] = m_Models[lastIndex];
+			m_LayerMasks[denseIndex] = m_LayerMasks[lastIndex];
+			m_Names[denseIndex] = std::move(m_Names[lastIndex]);
+			m_TransformDirty[denseIndex] = m_TransformDirty[lastIndex];
+			m_Slots[m_Handles[denseIndex].m_Index].m_DenseIndex = denseIndex;
+		}
+		m_Handles.pop_back();
+		m_Transforms.pop_back();
+		m_Parents.pop_back();
+		m_WorldMatrices.pop_back();
+		m_WorldInvTransposes.pop_back();
+		m_LocalBounds.pop_back();
+		m_WorldBounds.pop_back();
+		m_Models.pop_back();
+		m_LayerMasks.pop_back();
+		m_Names.pop_back();
+		m_TransformDirty.pop_back();
+
+		slot.m_DenseIndex = ObjectHandle::InvalidIndex;
+		++slot.m_Generation;
+		m_FreeSlots.push_back(handle.m_Index);
+	}
+
+	void ObjectStore::MarkDirty(std::uint32_t denseIndex)
+	{
+		if (m_TransformDirty[denseIndex] == 0) {
+			m_TransformDirty[denseIndex] = 1;
+			m_DirtyObjects.push_back(m_Handles[denseIndex]);
+		}
+	}
+
+	void ObjectStore::RebuildHierarchyOrder()
+	{
+		auto count = Size();
+
+		// 按父物体对子物体计数排序，根物体归到虚拟的父物体 count 之下
+		std::vector<std::uint32_t> childOffsets(count + 2, 0);
+		std::vector<std::uint32_t> parentIndices(count);
+		for (std::uint32_t i = 0; i < count; ++i) {
+			auto parent = m_Parents[i];
+			parentIndices[i] = parent.IsValid() ? GetDenseIndex(parent) : count;
+			++childOffsets[parentIndices[i] + 1];
+		}
+		for (std::uint32_t i = 1; i < childOffsets.size(); ++i) {
+			childOffsets[i] += childOffsets[i - 1];
+		}
+		std::vector<std::uint32_t> children(count);
+		auto cursors = childOffsets;
+		for (std::uint32_t i = 0; i < count; ++i) {
+			children[cursors[parentIndices[i]]++] = i;
+		}
+
+		// 先序深度优先遍历
+		m_Order.clear();
+		m_OrderPositions.resize(count);
+		std::vector<std::uint32_t> stack(children.begin() + childOffsets[count], children.begin() + childOffsets[count + 1]);
+		while (!stack.empty()) {
+			auto denseIndex = stack.back();
+			stack.pop_back();
+			m_OrderPositions[denseIndex] = static_cast<std::uint32_t>(m_Order.size());
+			m_Order.push_back(denseIndex);
+			stack.insert(stack.end(), children.begin() + childOffsets[denseIndex], children.begin() + childOffsets[denseIndex + 1]);
+		}
+		assert(m_Order.size() == count);
+
+		// 子物体的位置总在父物体之后，逆序把子树的结束位置传给父物体
+		m_SubtreeEnds.resize(count);
+		for (std::uint32_t i = 0; i < count; ++i) {
+			m_SubtreeEnds[i] = i + 1;
+		}
+		for (auto i = count; i-- > 0;) {
+			if (auto parentIndex = parentIndices[m_Order[i]]; parentIndex != count) {
+				auto& parentEnd = m_SubtreeEnds[m_OrderPositions[parentIndex]];
+				parentEnd = (std::max)(parentEnd, m_SubtreeEnds[i]);
+			}
+		}
+
+		m_HierarchyDirty = false;
+	}
+
+	void ObjectStore::UpdateWorldMatrix(std::uint32_t denseIndex)
+	{
+		// 行向量约定，先应用局部变换再应用父物体的世界变换
+		auto world = m_Transforms[denseIndex].GetLocalToWorldMatrix();
+		if (auto parent = m_Parents[denseIndex]; parent.IsValid()) {
+			world = XMMatrixMultiply(world, XMLoadFloat4x4(&m_WorldMatrices[GetDenseIndex(parent)]));
+		}
+		XMStoreFloat4x4(&m_WorldMatrices[denseIndex], world);
+		XMStoreFloat4x4(&m_WorldInvTransposes[denseIndex], MathHelper::InverseTransposeWithOutTranslate(world));
+
+		// 轴对齐包围盒的半长为各轴在矩阵绝对值下的投影之和，避免变换 8 个角点
+		const auto& localBounds = m_LocalBounds[denseIndex];
+		auto extents = XMLoadFloat3(&localBounds.Extents);
+		auto worldExtents = XMVectorMultiply(XMVectorSplatX(extents), XMVectorAbs(world.r[0]));
+		worldExtents = XMVectorMultiplyAdd(XMVectorSplatY(extents), XMVectorAbs(world.r[1]), worldExtents);
+		worldExtents = XMVectorMultiplyAdd(XMVectorSplatZ(extents), XMVectorAbs(world.r[2]), worldExtents);
+		XMStoreFloat3(&m_WorldBounds[denseIndex].Center, XMVector3Transform(XMLoadFloat3(&localBounds.Center), world));
+		XMStoreFloat3(&m_WorldBounds[denseIndex].Extents, worldExtents);
+
+		m_TransformDirty[denseIndex] = 0;
+	}
+}
@@ -0,0 +1,151 @@
+#pragma once
+#ifndef __OBJECTSTORE__H__
+#define __OBJECTSTORE__H__
+
+#include <DirectXCollision.h>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "Transform.h"
+
+namespace DSM {
+	class Model;
+
+	enum class RenderLayer : int
+	{
+		Opaque = 0,
+		Transparent = 1,
+		AlphaTest = 2,
+		Mirror = 3,
+		Reflection = 4,
+		Count
+	};
+
+	// 一个物体可以同时属于多个渲染层
+	using RenderLayerMask = std::uint32_t;
+
+	constexpr RenderLayerMask GetRenderLayerMask(RenderLayer layer) noexcept
+	{
+		return 1u << static_cast<int>(layer);
+	}
+
+	// 物体的句柄，槽位被回收时代数递增，指向已删除物体的旧句柄因此失效
+	struct ObjectHandle
+	{
+		inline static constexpr std::uint32_t InvalidIndex = 0xffffffffu;
+
+		std::uint32_t m_Index = InvalidIndex;
+		std::uint32_t m_Generation = 0;
+
+		constexpr bool IsValid() const noexcept { return m_Index != InvalidIndex; }
+		constexpr bool operator==(const ObjectHandle&) const noexcept = default;
+	};
+
+	// 以 SoA 形式存放所有物体，同一属性的数据位于连续的数组中，逐帧遍历时顺序访问内存
+	// 删除物体时由最后一个物体填补空位，稠密数组的顺序会改变，长期引用物体需使用句柄
+	// 物体可以有父物体，世界矩阵被缓存，只有变换改变的物体及其子树会在更新时重新计算
+	class ObjectStore
+	{
+	public:
+		// 名称已存在时返回无效句柄
+		ObjectHandle Create(const std::string& name, const Model* model, RenderLayerMask layerMask);
+		// 子物体一并删除
+		bool Destroy(ObjectHandle handle);
+		void Clear();
+		void Reserve(std::size_t count);
+
+		bool IsAlive(ObjectHandle handle) const noexcept;
+		// 名称不存在时返回无效句柄
+		ObjectHandle Find(const std::string& name) const;
+		std::uint32_t Size() const noexcept;
+		// 句柄在稠密数组中的下标，句柄失效时返回 ObjectHandle::InvalidIndex
+		std::uint32_t GetDenseIndex(ObjectHandle handle) const noexcept;
+
+		// 以下按句柄访问，句柄需有效
+		const std::string& GetName(ObjectHandle handle) const;
+		// 获取可修改的变换时将物体标记为脏，下次更新时重新计算其子树
+		Transform& GetTransform(ObjectHandle handle);
+		const Transform& GetTransform(ObjectHandle handle) const;
+		// 变换为相对于父物体的局部变换，parent 为无效句柄时成为根物体
+		// 父物体不存在或为 child 自身及其后代时返回 false
+		bool SetParent(ObjectHandle child, ObjectHandle parent);
+		ObjectHandle GetParent(ObjectHandle handle) const;
+		const DirectX::XMFLOAT4X4& GetWorldMatrix(ObjectHandle handle) const;
+		const DirectX::XMFLOAT4X4& GetWorldInvTranspose(ObjectHandle handle) const;
+		const DirectX::BoundingBox& GetWorldBounds(ObjectHandle handle) const;
+		const Model* GetModel(ObjectHandle handle) const;
+		// 局部空间的包围盒随模型更新
+		void SetModel(ObjectHandle handle, const Model* model);
+		RenderLayerMask GetLayerMask(ObjectHandle handle) const;
+		void SetLayerMask(ObjectHandle handle, RenderLayerMask layerMask);
+
+		// 按父子顺序重新计算脏物体子树的世界矩阵、逆转置矩阵与世界空间的包围盒
+		// 每帧遍历物体前调用一次，返回重新计算的物体数量，场景静止时为 0
+		std::uint32_t UpdateWorldMatrices();
+
+		// 按稠密下标访问的数组，长度均为 Size()
+		std::span<const ObjectHandle> GetHandles() const noexcept;
+		std::span<const Transform> GetTransforms() const noexcept;
+		std::span<const DirectX::XMFLOAT4X4> GetWorldMatrices() const noexcept;
+		// 世界矩阵去除平移后的逆转置，用于变换法线
+		std::span<const DirectX::XMFLOAT4X4> GetWorldInvTransposes() const noexcept;
+		std::span<const DirectX::BoundingBox> GetLocalBounds() const noexcept;
+		std::span<const DirectX::BoundingBox> GetWorldBounds() const noexcept;
+		std::span<const Model* const> GetModels() const noexcept;
+		std::span<const RenderLayerMask> GetLayerMasks() const noexcept;
+
+		// 模型所有网格包围盒的并集
+		static DirectX::BoundingBox ComputeModelBounds(const Model* model);
+
+	private:
+		std::uint32_t GetValidDenseIndex(ObjectHandle handle) const;
+		void RemoveDense(std::uint32_t denseIndex);
+		void MarkDirty(std::uint32_t denseIndex);
+		// 以先序深度优先的顺序排列物体，每棵子树在顺序中连续
+		void RebuildHierarchyOrder();
+		void UpdateWorldMatrix(std::uint32_t denseIndex);
+
+	private:
+		// 槽位记录稠密下标与当前代数，句柄的索引指向槽位
+		struct Slot
+		{
+			std::uint32_t m_DenseIndex = ObjectHandle::InvalidIndex;
+			std::uint32_t m_Generation = 0;
+		};
+
+		std::vector<Slot> m_Slots;
+		std::vector<std::uint32_t> m_FreeSlots;
+
+		// 稠密数组，下标相同的元素属于同一物体
+		std::vector<ObjectHandle> m_Handles;
+		std::vector<Transform> m_Transforms;
+		std::vector<ObjectHandle> m_Parents;
+		std::vector<DirectX::XMFLOAT4X4> m_WorldMatrices;
+		std::vector<DirectX::XMFLOAT4X4> m_WorldInvTransposes;
+		std::vector<DirectX::BoundingBox> m_LocalBounds;
+		std::vector<DirectX::BoundingBox> m_WorldBounds;
+		std::vector<const Model*> m_Models;
+		std::vector<RenderLayerMask> m_LayerMasks;
+		std::vector<std::string> m_Names;
+		std::vector<std::uint8_t> m_TransformDirty;
+
+		// 变换改变的物体，删除后留下的失效句柄在更新时跳过
+		std::vector<ObjectHandle> m_DirtyObjects;
+		std::vector<std::uint32_t> m_DirtyPositions;
+
+		// 父子关系的拓扑顺序，物体增删或改变父物体后在下次更新时重建
+		// m_Order 为稠密下标，m_OrderPositions 为稠密下标在顺序中的位置
+		// m_SubtreeEnds[i] 为顺序中第 i 个物体的子树结束位置（不含）
+		std::vector<std::uint32_t> m_Order;
+		std::vector<std::uint32_t> m_OrderPositions;
+		std::vector<std::uint32_t> m_SubtreeEnds;
+		bool m_HierarchyDirty = false;
+
+		// 名称只在查找时使用，不参与逐帧遍历
+		std::unordered_map<std::string, ObjectHandle> m_NameIndex;
+	};
+}
+
+#endif
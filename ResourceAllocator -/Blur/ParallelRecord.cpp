@@ -0,0 +1,78 @@
+#include "ParallelRecord.h"
+#include <algorithm>
+#include <cassert>
+
+namespace DSM {
+	//
+	// ParallelRecordPlan Implementation
+	//
+	void ParallelRecordPlan::Build(
+		std::span<const std::uint32_t> passDrawCounts,
+		std::uint32_t workerCount,
+		std::uint32_t minDrawsPerTask)
+	{
+		assert(workerCount > 0);
+		minDrawsPerTask = (std::max)(minDrawsPerTask, 1u);
+
+		m_PassCount = static_cast<std::uint32_t>(passDrawCounts.size());
+		m_WorkerCount = workerCount;
+		m_Tasks.clear();
+		m_SubmitOrder.clear();
+		m_WorkerTasks.resize(workerCount);
+		for (auto& workerTasks : m_WorkerTasks) {
+			workerTasks.clear();
+		}
+
+		std::uint32_t nextWorker = 0;
+		for (std::uint32_t pass = 0; pass < m_PassCount; ++pass) {
+			m_SubmitOrder.push_back({ RecordSubmitEntry::Type::Main, pass });
+
+			auto drawCount = passDrawCounts[pass];
+			if (drawCount == 0) continue;
+
+			// 范围保持连续，同一物体的子网格仍然相邻
+			auto taskCount = std::clamp(drawCount / minDrawsPerTask, 1u, workerCount);
+			for (std::uint32_t i = 0; i < taskCount; ++i) {
+				auto begin = static_cast<std::uint32_t>(std::uint64_t{ drawCount } * i / taskCount);
+				auto end = static_cast<std::uint32_t>(std::uint64_t{ drawCount } * (i + 1) / taskCount);
+				auto taskIndex = static_cast<std::uint32_t>(m_Tasks.size());
+				m_Tasks.push_back({ pass, nextWorker, begin, end });
+				m_WorkerTasks[nextWorker].push_back(taskIndex);
+				m_SubmitOrder.push_back({ RecordSubmitEntry::Type::Task, taskIndex });
+				nextWorker = (nextWorker + 1) % workerCount;
+			}
+		}
+		m_SubmitOrder.push_back({ RecordSubmitEntry::Type::Main, m_PassCount });
+	}
+
+	std::span<const RecordTask> ParallelRecordPlan::GetTasks() const noexcept
+	{
+		return m_Tasks;
+	}
+
+	std::span<const std::uint32_t> ParallelRecordPlan::GetWorkerTasks(std::uint32_t worker) const noexcept
+	{
+		assert(worker < m_WorkerCount);
+		return m_WorkerTasks[worker];
+	}
+
+	std::span<const RecordSubmitEntry> ParallelRecordPlan::GetSubmitOrder() const noexcept
+	{
+		return m_SubmitOrder;
+	}
+
+	std::uint32_t ParallelRecordPlan::GetPassCount() const noexcept
+	{
+		return m_PassCount;
+	}
+
+	std::uint32_t ParallelRecordPlan::GetWorkerCount() const noexcept
+	{
+		return m_WorkerCount;
+	}
+
+	std::uint32_t ParallelRecordPlan::GetMainListCount() const noexcept
+	{
+		return m_PassCount + 1;
+	}
+}
@@ -0,0 +1,60 @@
+#pragma once
+#ifndef __PARALLELRECORD__H__
+#define __PARALLELRECORD__H__
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace DSM {
+	// 一个录制槽位在一个通道中录制的连续绘制范围 [m_Begin, m_End)
+	// 每个槽位独占命令分配器，槽位的所有任务在同一个任务系统的任务中按顺序录制
+	struct RecordTask
+	{
+		std::uint32_t m_Pass;
+		std::uint32_t m_Worker;
+		std::uint32_t m_Begin;
+		std::uint32_t m_End;
+	};
+
+	// 提交顺序中的一个命令列表
+	struct RecordSubmitEntry
+	{
+		enum class Type : std::uint8_t
+		{
+			Main,		// 主线程录制的命令列表，m_Index 为其序号
+			Task		// 录制槽位录制的命令列表，m_Index 为任务的下标
+		};
+
+		Type m_Type;
+		std::uint32_t m_Index;
+	};
+
+	// 将每个通道的绘制列表划分给录制槽位，不依赖 D3D12 设备
+	// 每个通道之前以及所有通道之后各有一个主线程录制的命令列表，用于屏障、清除等，共 passCount + 1 个
+	// 提交顺序为 Main 0、通道 0 的任务、Main 1、通道 1 的任务、……、Main passCount
+	class ParallelRecordPlan
+	{
+	public:
+		// 每个任务至少有 minDrawsPerTask 个绘制，绘制较少的通道只使用部分槽位
+		// 相邻通道的任务从不同的槽位开始分配，使每个槽位的总绘制数接近
+		void Build(std::span<const std::uint32_t> passDrawCounts, std::uint32_t workerCount, std::uint32_t minDrawsPerTask);
+
+		std::span<const RecordTask> GetTasks() const noexcept;
+		// 分配给槽位的任务下标，按通道顺序排列
+		std::span<const std::uint32_t> GetWorkerTasks(std::uint32_t worker) const noexcept;
+		std::span<const RecordSubmitEntry> GetSubmitOrder() const noexcept;
+		std::uint32_t GetPassCount() const noexcept;
+		std::uint32_t GetWorkerCount() const noexcept;
+		std::uint32_t GetMainListCount() const noexcept;
+
+	private:
+		std::vector<RecordTask> m_Tasks;
+		std::vector<std::vector<std::uint32_t>> m_WorkerTasks;
+		std::vector<RecordSubmitEntry> m_SubmitOrder;
+		std::uint32_t m_PassCount = 0;
+		std::uint32_t m_WorkerCount = 0;
+	};
+}
+
+#endif
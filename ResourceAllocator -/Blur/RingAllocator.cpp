@@ -0,0 +1,93 @@
+#include "RingAllocator.h"
+#include <cassert>
+
+namespace DSM {
+	RingAllocator::RingAllocator(std::uint64_t capacity)
+		:m_Capacity(capacity) {
+		assert(m_Capacity > 0);
+	}
+
+	std::uint64_t RingAllocator::Allocate(std::uint64_t size, std::uint64_t alignment)
+	{
+		assert(alignment == 0 || (alignment & (alignment - 1)) == 0);
+		if (IsFull() || size == 0 || size > m_Capacity) {
+			return InvalidOffset;
+		}
+
+		auto alignUp = [alignment](std::uint64_t offset) {
+			return alignment == 0 ? offset : (offset + alignment - 1) & ~(alignment - 1);
+			};
+		auto commit = [this](std::uint64_t offset, std::uint64_t newTail, std::uint64_t usedSize) {
+			m_Tail = newTail;
+			m_UsedSize += usedSize;
+			m_CurrFrameSize += usedSize;
+			return offset;
+			};
+
+		const auto alignedTail = alignUp(m_Tail);
+		if (m_Tail >= m_Head) {
+			// 空闲区间为 [tail, capacity) 与 [0, head)
+			if (alignedTail + size <= m_Capacity) {
+				return commit(alignedTail, alignedTail + size, alignedTail - m_Tail + size);
+			}
+			// 尾部空间不足则回绕到开头，尾部剩余的空间记入当前帧
+			if (size <= m_Head) {
+				return commit(0, size, m_Capacity - m_Tail + size);
+			}
+		}
+		else if (alignedTail + size <= m_Head) {
+			// 空闲区间为 [tail, head)
+			return commit(alignedTail, alignedTail + size, alignedTail - m_Tail + size);
+		}
+
+		return InvalidOffset;
+	}
+
+	void RingAllocator::FinishFrame(std::uint64_t fenceValue)
+	{
+		m_FrameTails.push_back({ fenceValue, m_Tail, m_CurrFrameSize });
+		m_CurrFrameSize = 0;
+		++m_FrameCount;
+	}
+
+	void RingAllocator::Retire(std::uint64_t completedFence)
+	{
+		while (!m_FrameTails.empty() && m_FrameTails.front().m_FenceValue <= completedFence) {
+			const auto& frameTail = m_FrameTails.front();
+			assert(frameTail.m_Size <= m_UsedSize);
+			m_UsedSize -= frameTail.m_Size;
+			m_Head = frameTail.m_Tail;
+			m_FrameTails.pop_front();
+		}
+
+		// 没有任何占用时从头开始，减少回绕的浪费
+		if (m_UsedSize == 0 && m_FrameTails.empty()) {
+			m_Head = m_Tail = 0;
+		}
+	}
+
+	std::uint64_t RingAllocator::GetCapacity() const noexcept
+	{
+		return m_Capacity;
+	}
+
+	std::uint64_t RingAllocator::GetUsedSize() const noexcept
+	{
+		return m_UsedSize;
+	}
+
+	std::uint64_t RingAllocator::GetFrameCount() const noexcept
+	{
+		return m_FrameCount;
+	}
+
+	bool RingAllocator::IsFull() const noexcept
+	{
+		return m_UsedSize == m_Capacity;
+	}
+
+	bool RingAllocator::IsEmpty() const noexcept
+	{
+		return m_UsedSize == 0;
+	}
+}
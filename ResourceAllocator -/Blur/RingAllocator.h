@@ -0,0 +1,51 @@
+#pragma once
+#ifndef __RINGALLOCATOR__H__
+#define __RINGALLOCATOR__H__
+
+#include <cstdint>
+#include <deque>
+
+namespace DSM {
+	// 环形的线性分配器，不依赖 D3D12 设备
+	// 分配只需移动尾指针，每帧结束时记录帧的围栏值，围栏完成后整帧的内存一次性释放
+	class RingAllocator
+	{
+	public:
+		static constexpr std::uint64_t InvalidOffset = UINT64_MAX;
+
+		explicit RingAllocator(std::uint64_t capacity);
+
+		// 分配内存，alignment 需为 2 的幂，空间不足返回 InvalidOffset
+		std::uint64_t Allocate(std::uint64_t size, std::uint64_t alignment);
+		// 结束当前帧的分配并记录该帧的围栏值
+		void FinishFrame(std::uint64_t fenceValue);
+		// 释放所有围栏已完成的帧
+		void Retire(std::uint64_t completedFence);
+
+		std::uint64_t GetCapacity() const noexcept;
+		std::uint64_t GetUsedSize() const noexcept;
+		// 已经结束的帧的数量
+		std::uint64_t GetFrameCount() const noexcept;
+		bool IsFull() const noexcept;
+		bool IsEmpty() const noexcept;
+
+	private:
+		struct FrameTail
+		{
+			std::uint64_t m_FenceValue;
+			std::uint64_t m_Tail;       // 该帧结束时的尾指针
+			std::uint64_t m_Size;       // 该帧占用的大小，包括对齐与回绕浪费的部分
+		};
+
+		std::deque<FrameTail> m_FrameTails;
+
+		const std::uint64_t m_Capacity;
+		std::uint64_t m_Head = 0;           // 最早仍在使用的位置
+		std::uint64_t m_Tail = 0;           // 下一次分配的位置
+		std::uint64_t m_UsedSize = 0;
+		std::uint64_t m_CurrFrameSize = 0;
+		std::uint64_t m_FrameCount = 0;
+	};
+}
+
+#endif
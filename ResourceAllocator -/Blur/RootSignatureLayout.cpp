@@ -0,0 +1,202 @@
+#include "RootSignatureLayout.h"
+#include "ShaderCompiler.h"
+#include <algorithm>
+#include <climits>
+#include <map>
+
+namespace DSM {
+	namespace {
+		constexpr std::uint32_t GetStageBit(ShaderType type) noexcept
+		{
+			return 1u << static_cast<int>(type);
+		}
+
+		// 根签名中各类根参数占用的 DWORD 数
+		constexpr std::uint32_t RootDescriptorCost = 2;
+		constexpr std::uint32_t DescriptorTableCost = 1;
+	}
+
+	D3D12_SHADER_VISIBILITY GetShaderVisibility(std::uint32_t stageMask, bool isCompute) noexcept
+	{
+		// 计算着色器只能使用 ALL
+		if (isCompute) return D3D12_SHADER_VISIBILITY_ALL;
+
+		switch (stageMask) {
+		case GetStageBit(ShaderType::VERTEX_SHADER): return D3D12_SHADER_VISIBILITY_VERTEX;
+		case GetStageBit(ShaderType::HULL_SHADER): return D3D12_SHADER_VISIBILITY_HULL;
+		case GetStageBit(ShaderType::DOMAIN_SHADER): return D3D12_SHADER_VISIBILITY_DOMAIN;
+		case GetStageBit(ShaderType::GEOMETRY_SHADER): return D3D12_SHADER_VISIBILITY_GEOMETRY;
+		case GetStageBit(ShaderType::PIXEL_SHADER): return D3D12_SHADER_VISIBILITY_PIXEL;
+		default: return D3D12_SHADER_VISIBILITY_ALL;
+		}
+	}
+
+	RootSignatureLayout BuildRootSignatureLayout(
+		const std::vector<RootBindingDesc>& bindings,
+		const RootSignatureLayoutOptions& options)
+	{
+		std::vector<std::uint32_t> constantBuffers;
+		// 按可见性分组，每组生成一个描述符表
+		std::map<D3D12_SHADER_VISIBILITY, std::vector<std::uint32_t>> tableBindings;
+		std::vector<std::uint32_t> unboundedBindings;
+
+		for (std::uint32_t i = 0; i < bindings.size(); ++i) {
+			const auto& binding = bindings[i];
+			if (binding.m_StageMask == 0) continue;
+
+			if (binding.m_Type == RootBindingType::CONSTANT_BUFFER) {
+				constantBuffers.push_back(i);
+			}
+			else if (binding.m_BindCount == UINT_MAX) {
+				unboundedBindings.push_back(i);
+			}
+			else {
+				tableBindings[GetShaderVisibility(binding.m_StageMask, options.m_IsCompute)].push_back(i);
+			}
+		}
+
+		RootSignatureLayout layout{};
+		layout.m_SizeInDWords = static_cast<std::uint32_t>(
+			constantBuffers.size() * RootDescriptorCost +
+			(tableBindings.size() + unboundedBindings.size()) * DescriptorTableCost);
+
+		// 以寄存器顺序排列，使布局与输入顺序无关
+		auto byRegister = [&bindings](auto lhs, auto rhs) {
+			const auto& l = bindings[lhs];
+			const auto& r = bindings[rhs];
+			if (l.m_Type != r.m_Type) return l.m_Type < r.m_Type;
+			if (l.m_RegisterSpace != r.m_RegisterSpace) return l.m_RegisterSpace < r.m_RegisterSpace;
+			if (l.m_BindPoint != r.m_BindPoint) return l.m_BindPoint < r.m_BindPoint;
+			// 各阶段的参数常量缓冲区可能使用相同的寄存器，以阶段区分
+			return l.m_StageMask < r.m_StageMask;
+			};
+
+		// 较小的常量缓冲区优先放入根常量，直到根签名的大小达到上限
+		// 大小相同时按寄存器决定先后，否则预算不足时选中哪一个取决于反射的顺序
+		std::vector<std::uint32_t> rootConstants;
+		std::vector<std::uint32_t> rootDescriptors;
+		auto sortedBuffers = constantBuffers;
+		std::sort(sortedBuffers.begin(), sortedBuffers.end(), [&bindings, &byRegister](auto lhs, auto rhs) {
+			if (bindings[lhs].m_ByteSize != bindings[rhs].m_ByteSize) {
+				return bindings[lhs].m_ByteSize < bindings[rhs].m_ByteSize;
+			}
+			return byRegister(lhs, rhs);
+			});
+		for (auto index : sortedBuffers) {
+			const auto& binding = bindings[index];
+			auto num32BitValues = binding.m_ByteSize / 4;
+			bool fitsRootConstants = binding.m_ByteSize != 0 &&
+				binding.m_ByteSize % 4 == 0 &&
+				binding.m_ByteSize <= options.m_MaxRootConstantBytes &&
+				layout.m_SizeInDWords - RootDescriptorCost + num32BitValues <= options.m_MaxRootSignatureDWords;
+			if (fitsRootConstants) {
+				layout.m_SizeInDWords = layout.m_SizeInDWords - RootDescriptorCost + num32BitValues;
+				rootConstants.push_back(index);
+			}
+		}
+		for (auto index : constantBuffers) {
+			if (std::find(rootConstants.begin(), rootConstants.end(), index) == rootConstants.end()) {
+				rootDescriptors.push_back(index);
+			}
+		}
+		std::sort(rootConstants.begin(), rootConstants.end(), byRegister);
+		std::sort(rootDescriptors.begin(), rootDescriptors.end(), byRegister);
+
+		for (auto index : rootConstants) {
+			RootParameterLayout param{};
+			param.m_ParameterType = D3D12_ROOT_PARAMETER_TYPE_32BIT_CONSTANTS;
+			param.m_Visibility = GetShaderVisibility(bindings[index].m_StageMask, options.m_IsCompute);
+			param.m_Binding = index;
+			param.m_Num32BitValues = bindings[index].m_ByteSize / 4;
+			layout.m_Parameters.push_back(std::move(param));
+		}
+		for (auto index : rootDescriptors) {
+			RootParameterLayout param{};
+			param.m_ParameterType = D3D12_ROOT_PARAMETER_TYPE_CBV;
+			param.m_Visibility = GetShaderVisibility(bindings[index].m_StageMask, options.m_IsCompute);
+			param.m_Binding = index;
+			// 常量缓冲区在录制时写入，执行期间不会改变
+			param.m_DescriptorFlags = D3D12_ROOT_DESCRIPTOR_FLAG_DATA_STATIC_WHILE_SET_AT_EXECUTE;
+			layout.m_Parameters.push_back(std::move(param));
+		}
+
+		for (auto& [visibility, tableIndices] : tableBindings) {
+			std::sort(tableIndices.begin(), tableIndices.end(), byRegister);
+
+			RootParameterLayout param{};
+			param.m_ParameterType = D3D12_ROOT_PARAMETER_TYPE_DESCRIPTOR_TABLE;
+			param.m_Visibility = visibility;
+			for (auto index : tableIndices) {
+				const auto& binding = bindings[index];
+				auto rangeType = binding.m_Type == RootBindingType::SHADER_RESOURCE ?
+					D3D12_DESCRIPTOR_RANGE_TYPE_SRV : D3D12_DESCRIPTOR_RANGE_TYPE_UAV;
+
+				// 寄存器与上一个范围相接时合并
+				if (!param.m_Ranges.empty()) {
+					auto& last = param.m_Ranges.back();
+					if (last.m_RangeType == rangeType &&
+						last.m_RegisterSpace == binding.m_RegisterSpace &&
+						last.m_BaseShaderRegister + last.m_NumDescriptors == binding.m_BindPoint) {
+						last.m_NumDescriptors += binding.m_BindCount;
+						last.m_Bindings.push_back(index);
+						continue;
+					}
+				}
+
+				RootDescriptorRangeLayout range{};
+				range.m_RangeType = rangeType;
+				range.m_BaseShaderRegister = binding.m_BindPoint;
+				range.m_RegisterSpace = binding.m_RegisterSpace;
+				range.m_NumDescriptors = binding.m_BindCount;
+				// 描述符在设置描述符表前复制到环形堆中，只有 UAV 的数据会在执行期间改变
+				range.m_Flags = rangeType == D3D12_DESCRIPTOR_RANGE_TYPE_SRV ?
+					D3D12_DESCRIPTOR_RANGE_FLAG_DATA_STATIC_WHILE_SET_AT_EXECUTE :
+					D3D12_DESCRIPTOR_RANGE_FLAG_DATA_VOLATILE;
+				range.m_Bindings.push_back(index);
+				param.m_Ranges.push_back(std::move(range));
+			}
+			layout.m_Parameters.push_back(std::move(param));
+		}
+
+		std::sort(unboundedBindings.begin(), unboundedBindings.end(), byRegister);
+		for (auto index : unboundedBindings) {
+			const auto& binding = bindings[index];
+
+			RootDescriptorRangeLayout range{};
+			range.m_RangeType = binding.m_Type == RootBindingType::SHADER_RESOURCE ?
+				D3D12_DESCRIPTOR_RANGE_TYPE_SRV : D3D12_DESCRIPTOR_RANGE_TYPE_UAV;
+			range.m_BaseShaderRegister = binding.m_BindPoint;
+			range.m_RegisterSpace = binding.m_RegisterSpace;
+			range.m_NumDescriptors = UINT_MAX;
+			// 无绑定范围中存在未写入的描述符，且随时可能更新
+			range.m_Flags = D3D12_DESCRIPTOR_RANGE_FLAG_DESCRIPTORS_VOLATILE;
+			range.m_Bindings.push_back(index);
+
+			RootParameterLayout param{};
+			param.m_ParameterType = D3D12_ROOT_PARAMETER_TYPE_DESCRIPTOR_TABLE;
+			param.m_Visibility = GetShaderVisibility(binding.m_StageMask, options.m_IsCompute);
+			param.m_Ranges.push_back(std::move(range));
+			param.m_IsUnbounded = true;
+			layout.m_Parameters.push_back(std::move(param));
+		}
+
+		if (!options.m_IsCompute) {
+			layout.m_Flags = D3D12_ROOT_SIGNATURE_FLAG_ALLOW_INPUT_ASSEMBLER_INPUT_LAYOUT;
+			// 拒绝 Pass 中不存在的着色器阶段访问根签名
+			std::pair<ShaderType, D3D12_ROOT_SIGNATURE_FLAGS> denyFlags[] = {
+				{ ShaderType::VERTEX_SHADER, D3D12_ROOT_SIGNATURE_FLAG_DENY_VERTEX_SHADER_ROOT_ACCESS },
+				{ ShaderType::HULL_SHADER, D3D12_ROOT_SIGNATURE_FLAG_DENY_HULL_SHADER_ROOT_ACCESS },
+				{ ShaderType::DOMAIN_SHADER, D3D12_ROOT_SIGNATURE_FLAG_DENY_DOMAIN_SHADER_ROOT_ACCESS },
+				{ ShaderType::GEOMETRY_SHADER, D3D12_ROOT_SIGNATURE_FLAG_DENY_GEOMETRY_SHADER_ROOT_ACCESS },
+				{ ShaderType::PIXEL_SHADER, D3D12_ROOT_SIGNATURE_FLAG_DENY_PIXEL_SHADER_ROOT_ACCESS },
+			};
+			for (const auto& [type, flag] : denyFlags) {
+				if ((options.m_StageMask & GetStageBit(type)) == 0) {
+					layout.m_Flags = static_cast<D3D12_ROOT_SIGNATURE_FLAGS>(layout.m_Flags | flag);
+				}
+			}
+		}
+
+		return layout;
+	}
+}
@@ -0,0 +1,82 @@
+#pragma once
+#ifndef __ROOTSIGNATURELAYOUT__H__
+#define __ROOTSIGNATURELAYOUT__H__
+
+#include <d3d12.h>
+#include <cstdint>
+#include <vector>
+
+namespace DSM {
+	enum class RootBindingType : int
+	{
+		CONSTANT_BUFFER,
+		SHADER_RESOURCE,
+		RW_RESOURCE
+	};
+
+	// 一个着色器绑定的反射信息
+	struct RootBindingDesc
+	{
+		RootBindingType m_Type;
+		std::uint32_t m_BindPoint;
+		std::uint32_t m_RegisterSpace;
+		std::uint32_t m_BindCount;		// 无界数组为 UINT_MAX
+		std::uint32_t m_ByteSize;		// 仅常量缓冲区使用
+		std::uint32_t m_StageMask;		// 第 i 位表示 ShaderType i 使用了该绑定，为 0 时不生成根参数
+	};
+
+	struct RootSignatureLayoutOptions
+	{
+		bool m_IsCompute = false;
+		// Pass 中存在的着色器阶段，用于拒绝未使用阶段的根签名访问
+		std::uint32_t m_StageMask = 0;
+		// 不超过该大小的常量缓冲区可放入根常量
+		std::uint32_t m_MaxRootConstantBytes = 128;
+		std::uint32_t m_MaxRootSignatureDWords = 64;
+	};
+
+	struct RootDescriptorRangeLayout
+	{
+		D3D12_DESCRIPTOR_RANGE_TYPE m_RangeType;
+		std::uint32_t m_BaseShaderRegister;
+		std::uint32_t m_RegisterSpace;
+		std::uint32_t m_NumDescriptors;
+		D3D12_DESCRIPTOR_RANGE_FLAGS m_Flags;
+		// 按寄存器顺序排列的绑定索引，描述符按此顺序复制到表中
+		std::vector<std::uint32_t> m_Bindings;
+	};
+
+	struct RootParameterLayout
+	{
+		// 仅使用 32BIT_CONSTANTS、CBV 与 DESCRIPTOR_TABLE
+		D3D12_ROOT_PARAMETER_TYPE m_ParameterType;
+		D3D12_SHADER_VISIBILITY m_Visibility;
+
+		// 根常量与根描述符对应的绑定
+		std::uint32_t m_Binding = 0;
+		std::uint32_t m_Num32BitValues = 0;
+		D3D12_ROOT_DESCRIPTOR_FLAGS m_DescriptorFlags = D3D12_ROOT_DESCRIPTOR_FLAG_NONE;
+
+		std::vector<RootDescriptorRangeLayout> m_Ranges;
+		bool m_IsUnbounded = false;
+	};
+
+	struct RootSignatureLayout
+	{
+		// 根常量在前，其次为根描述符与描述符表，无界描述符表在最后
+		std::vector<RootParameterLayout> m_Parameters;
+		D3D12_ROOT_SIGNATURE_FLAGS m_Flags = D3D12_ROOT_SIGNATURE_FLAG_NONE;
+		std::uint32_t m_SizeInDWords = 0;
+	};
+
+	// 只根据反射信息决定根签名布局，不访问设备
+	// 同一可见性下的 SRV 与 UAV 合并到一个描述符表中，寄存器连续的绑定合并为一个范围；
+	// 在根签名大小允许的范围内，较小的常量缓冲区优先放入根常量
+	RootSignatureLayout BuildRootSignatureLayout(
+		const std::vector<RootBindingDesc>& bindings,
+		const RootSignatureLayoutOptions& options = {});
+
+	D3D12_SHADER_VISIBILITY GetShaderVisibility(std::uint32_t stageMask, bool isCompute) noexcept;
+}
+
+#endif
@@ -1,6 +1,7 @@
 #include "Shader.h"
 #include "BlurAPP.h"
 #include "Vertex.h"
+#include <chrono>
 
 namespace DSM {
 
@@ -36,6 +37,7 @@ namespace DSM {
         shaderHelper->GetConstantBufferVariable("Ambient")->SetFloat3(materialConstants.m_Ambient);
         shaderHelper->GetConstantBufferVariable("Alpha")->SetFloat(materialConstants.m_Alpha);
         shaderHelper->GetConstantBufferVariable("Gloss")->SetFloat(materialConstants.m_Gloss);
+        shaderHelper->GetConstantBufferVariable("DiffuseIndex")->SetInt(static_cast<int>(materialConstants.m_DiffuseIndex));
     }
     
 
@@ -44,37 +46,160 @@ namespace DSM {
     LitShader::LitShader(ID3D12Device* device,
         std::uint32_t numDirLight,
         std::uint32_t numPointLight,
-        std::uint32_t numSpotLight)
+        std::uint32_t numSpotLight,
+        bool enableBindless)
+        :m_Device(device), m_EnableBindless(enableBindless)
     {
+        numDirLight = max(1, numDirLight);
+        numPointLight = max(1, numPointLight);
+        numSpotLight = max(1, numSpotLight);
+
+        // 注册顺序需与 Keyword 一致
+        m_Keywords.AddRange("DIRLIGHTCOUNT", 0, numDirLight);
+        m_Keywords.AddRange("POINTLIGHTCOUNT", 0, numPointLight);
+        m_Keywords.AddRange("SPOTLIGHTCOUNT", 0, numSpotLight);
+        m_Keywords.AddToggle("ALPHATEST");
+        m_Keywords.AddToggle("ENABLEFOG");
+        assert(m_Keywords.GetKeywordCount() == NUM_KEYWORDS);
+        m_Variants.Reset(m_Keywords.GetKeyRange());
+
+        // 默认变体计算所有光源，与不使用变体时的结果一致
+        m_DefaultKey = m_Keywords.SetValue(m_DefaultKey, DIR_LIGHT_COUNT, numDirLight);
+        m_DefaultKey = m_Keywords.SetValue(m_DefaultKey, POINT_LIGHT_COUNT, numPointLight);
+        m_DefaultKey = m_Keywords.SetValue(m_DefaultKey, SPOT_LIGHT_COUNT, numSpotLight);
+        m_CurrentKey = m_DefaultKey;
+
+        // 关键字只影响像素着色器，所有变体共用同一个顶点着色器
+        auto shaderDescs = GetVariantShaderDescs(m_DefaultKey);
+        ShaderDesc shaderDesc = shaderDescs.front();
+        shaderDesc.m_Defines.RemoveDefine("DIRLIGHTCOUNT");
+        shaderDesc.m_Defines.RemoveDefine("POINTLIGHTCOUNT");
+        shaderDesc.m_Defines.RemoveDefine("SPOTLIGHTCOUNT");
+        shaderDesc.m_EnterPoint = "VS";
+        shaderDesc.m_Type = ShaderType::VERTEX_SHADER;
+        shaderDesc.m_ShaderName = "LightsVS";
+        shaderDesc.m_Target = "vs_6_1";
+        shaderDescs.push_back(shaderDesc);
+
+        // 默认变体同步编译，作为其他变体编译完成前的回退
+        m_ShaderHelper->CreateShadersFromFile(shaderDescs);
+        CreateVariantPass(m_DefaultKey);
+    }
+
+    void LitShader::SetKeyword(Keyword keyword, std::uint32_t value)
+    {
+        m_CurrentKey = m_Keywords.SetValue(m_CurrentKey, keyword, value);
+    }
+
+    void LitShader::SetLightCount(std::uint32_t numDirLight, std::uint32_t numPointLight, std::uint32_t numSpotLight)
+    {
+        // 超出最大值的光源不会被计算
+        SetKeyword(DIR_LIGHT_COUNT, (std::min)(numDirLight, m_Keywords.GetValueCount(DIR_LIGHT_COUNT) - 1));
+        SetKeyword(POINT_LIGHT_COUNT, (std::min)(numPointLight, m_Keywords.GetValueCount(POINT_LIGHT_COUNT) - 1));
+        SetKeyword(SPOT_LIGHT_COUNT, (std::min)(numSpotLight, m_Keywords.GetValueCount(SPOT_LIGHT_COUNT) - 1));
+    }
+
+    void LitShader::SetAlphaTest(bool enable)
+    {
+        SetKeyword(ALPHA_TEST, static_cast<std::uint32_t>(enable));
+    }
+
+    void LitShader::SetFogEnable(bool enable)
+    {
+        SetKeyword(FOG, static_cast<std::uint32_t>(enable));
+    }
+
+    void LitShader::WarmUpVariant(ShaderVariantKey key)
+    {
+        assert(m_Keywords.IsValid(key));
+        if (!m_Variants.Request(key)) return;
+
+        PendingVariant pendingVariant{};
+        pendingVariant.m_Key = key;
+        pendingVariant.m_ShaderDescs = GetVariantShaderDescs(key);
+        pendingVariant.m_Results = ShaderHelper::SubmitShaders(pendingVariant.m_ShaderDescs);
+        m_PendingVariants.push_back(std::move(pendingVariant));
+    }
+
+    void LitShader::PrepareForRecording()
+    {
+        m_PreparedPass = GetVariantPass(m_CurrentKey);
+        m_PreparedKey = m_CurrentKey;
+    }
+
+    std::vector<ShaderDesc> LitShader::GetVariantShaderDescs(ShaderVariantKey key) const
+    {
+        // 光源数组的大小固定为最大值，保证所有变体的常量缓冲区布局相同
         ShaderDefines shaderDefines;
-        shaderDefines.AddDefine("MAXDIRLIGHTCOUNT", std::to_string(max(1, numDirLight)));
-        shaderDefines.AddDefine("MAXPOINTLIGHTCOUNT", std::to_string(max(1, numPointLight)));
-        shaderDefines.AddDefine("MAXSPOTLIGHTCOUNT", std::to_string(max(1, numSpotLight)));
-        
+        shaderDefines.AddDefine("MAXDIRLIGHTCOUNT", std::to_string(m_Keywords.GetValueCount(DIR_LIGHT_COUNT) - 1));
+        shaderDefines.AddDefine("MAXPOINTLIGHTCOUNT", std::to_string(m_Keywords.GetValueCount(POINT_LIGHT_COUNT) - 1));
+        shaderDefines.AddDefine("MAXSPOTLIGHTCOUNT", std::to_string(m_Keywords.GetValueCount(SPOT_LIGHT_COUNT) - 1));
+        if (m_EnableBindless) {
+            shaderDefines.AddDefine("BINDLESS", "1");
+        }
+        for (const auto& [name, value] : m_Keywords.GetDefines(key)) {
+            shaderDefines.AddDefine(name, value);
+        }
+
         ShaderDesc shaderDesc{};
         shaderDesc.m_Defines = shaderDefines;
         shaderDesc.m_Target = "ps_6_1";
         shaderDesc.m_EnterPoint = "PS";
         shaderDesc.m_Type = ShaderType::PIXEL_SHADER;
         shaderDesc.m_FileName = "Shaders\\Light.hlsl";
-        shaderDesc.m_ShaderName = "LightsPS";
-        m_ShaderHelper->CreateShaderFormFile(shaderDesc);
-        shaderDesc.m_EnterPoint = "VS";
-        shaderDesc.m_Type = ShaderType::VERTEX_SHADER;
-        shaderDesc.m_ShaderName = "LightsVS";
-        shaderDesc.m_Target = "vs_6_1";
-        m_ShaderHelper->CreateShaderFormFile(shaderDesc);
+        shaderDesc.m_ShaderName = "LightsPS_" + std::to_string(key);
+        return { shaderDesc };
+    }
+
+    void LitShader::CreateVariantPass(ShaderVariantKey key)
+    {
+        auto passName = "Light_" + std::to_string(key);
         ShaderPassDesc passDesc{};
         passDesc.m_VSName = "LightsVS";
-        passDesc.m_PSName = "LightsPS";
-        m_ShaderHelper->AddShaderPass("Light", passDesc, device);
+        passDesc.m_PSName = "LightsPS_" + std::to_string(key);
+        m_ShaderHelper->AddShaderPass(passName, passDesc, m_Device);
 
         auto& inputLayout = VertexPosNormalTex::GetInputLayout();
-        auto pass = m_ShaderHelper->GetShaderPass("Light");
+        auto pass = m_ShaderHelper->GetShaderPass(passName);
         pass->SetInputLayout({inputLayout.data(), (UINT)inputLayout.size()});
         pass->SetPrimitiveTopologyType(D3D12_PRIMITIVE_TOPOLOGY_TYPE_TRIANGLE);
         
-        pass->CreatePipelineState(device);
+        pass->CreatePipelineState(m_Device);
+        m_Variants.SetVariant(key, std::move(pass));
+    }
+
+    void LitShader::UpdatePendingVariants()
+    {
+        auto isReady = [](const std::future<ShaderCacheEntry>& result) {
+            return result.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+            };
+
+        // 只合并已经编译完成的变体，不等待编译
+        for (auto it = m_PendingVariants.begin(); it != m_PendingVariants.end();) {
+            if (!std::all_of(it->m_Results.begin(), it->m_Results.end(), isReady)) {
+                ++it;
+                continue;
+            }
+            for (std::size_t i = 0; i < it->m_ShaderDescs.size(); ++i) {
+                m_ShaderHelper->AddShader(it->m_ShaderDescs[i], it->m_Results[i].get());
+            }
+            CreateVariantPass(it->m_Key);
+            it = m_PendingVariants.erase(it);
+        }
+    }
+
+    IShaderPass* LitShader::GetVariantPass(ShaderVariantKey key)
+    {
+        if (!m_PendingVariants.empty()) {
+            UpdatePendingVariants();
+        }
+        if (auto pass = m_Variants.Find(key); pass != nullptr) {
+            return pass->get();
+        }
+
+        // 首次使用时开始编译，完成前使用默认变体
+        WarmUpVariant(key);
+        return m_Variants.Find(m_DefaultKey)->get();
     }
 
     void LitShader::SetObjectCB(std::shared_ptr<D3D12ResourceLocation> cb)
@@ -140,34 +265,44 @@ namespace DSM {
     void LitShader::Apply(ID3D12GraphicsCommandList* cmdList, FrameResource* frameResource)
     {
         cmdList->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
-        m_ShaderHelper->GetShaderPass("Light")->Apply(cmdList, frameResource);
+        auto pass = m_PreparedPass != nullptr && m_PreparedKey == m_CurrentKey ?
+            m_PreparedPass : GetVariantPass(m_CurrentKey);
+        pass->Apply(cmdList, frameResource);
     }
 
 
 
 
-    ShadowShader::ShadowShader(ID3D12Device* device)
+    ShadowShader::ShadowShader(ID3D12Device* device, bool enableBindless)
+        :m_EnableBindless(enableBindless)
     {
         ShaderDefines shaderDefines;
-        shaderDefines.AddDefine("ALPHATEST", "1");
+        if (m_EnableBindless) {
+            shaderDefines.AddDefine("BINDLESS", "1");
+        }
 
+        // 各个阶段并行编译
+        std::vector<ShaderDesc> shaderDescs;
         ShaderDesc shaderDesc{};
+        shaderDesc.m_Defines = shaderDefines;
         shaderDesc.m_Target = "ps_6_1";
         shaderDesc.m_EnterPoint = "ShadowPS";
         shaderDesc.m_Type = ShaderType::PIXEL_SHADER;
         shaderDesc.m_FileName = "Shaders\\Shadow.hlsl";
         shaderDesc.m_ShaderName = "ShadowPS";
-        m_ShaderHelper->CreateShaderFormFile(shaderDesc);
+        shaderDescs.push_back(shaderDesc);
 
         shaderDesc.m_ShaderName = "ShadowPSWithAlphaTest";
+        shaderDefines.AddDefine("ALPHATEST", "1");
         shaderDesc.m_Defines = shaderDefines;
-        m_ShaderHelper->CreateShaderFormFile(shaderDesc);
+        shaderDescs.push_back(shaderDesc);
 
         shaderDesc.m_EnterPoint = "ShadowVS";
         shaderDesc.m_Type = ShaderType::VERTEX_SHADER;
         shaderDesc.m_ShaderName = "ShadowVS";
         shaderDesc.m_Target = "vs_6_1";
-        m_ShaderHelper->CreateShaderFormFile(shaderDesc);
+        shaderDescs.push_back(shaderDesc);
+        m_ShaderHelper->CreateShadersFromFile(shaderDescs);
 
         ShaderPassDesc shaderPassDesc{};
         shaderPassDesc.m_VSName = "ShadowVS";
@@ -3,15 +3,29 @@
 #define __SHADER__H__
 
 #include "IShader.h"
+#include "ShaderVariant.h"
 
 namespace DSM {
     class LitShader : public IShader
     {
     public:
+        // 着色器关键字，光源数量的取值为 0 ~ 构造时指定的最大值
+        enum Keyword : std::uint32_t
+        {
+            DIR_LIGHT_COUNT,
+            POINT_LIGHT_COUNT,
+            SPOT_LIGHT_COUNT,
+            ALPHA_TEST,
+            FOG,
+            NUM_KEYWORDS
+        };
+
+        // 光源数量的最大值决定常量缓冲区的布局，所有变体共用
         LitShader(ID3D12Device* device,
             std::uint32_t numDirLight = 3,
             std::uint32_t numPointLight = 1,
-            std::uint32_t numSpotLight = 1);
+            std::uint32_t numSpotLight = 1,
+            bool enableBindless = false);
 
         void SetObjectCB(std::shared_ptr<D3D12ResourceLocation> cb);
         void SetPassCB(std::shared_ptr<D3D12ResourceLocation> cb);
@@ -27,14 +41,55 @@ namespace DSM {
         void SetTexture(const D3D12DescriptorHandle& texture);
         void SetShadowMap(const D3D12DescriptorHandle& shadowMap);
         
+        // 切换当前使用的变体，未编译的变体在后台编译，完成前使用默认变体绘制
+        void SetKeyword(Keyword keyword, std::uint32_t value);
+        void SetLightCount(std::uint32_t numDirLight, std::uint32_t numPointLight, std::uint32_t numSpotLight);
+        void SetAlphaTest(bool enable);
+        void SetFogEnable(bool enable);
+        // 提前在后台编译变体，不改变当前变体
+        void WarmUpVariant(ShaderVariantKey key);
+        // 在主线程中确定当前变体，之后关键字不变时 Apply 不再合并编译结果或创建管线状态
+        // 工作线程录制前需调用，每帧调用一次
+        void PrepareForRecording();
+        
         virtual void Apply(ID3D12GraphicsCommandList* cmdList, FrameResource* frameResource) override;
+
+        bool IsBindless() const noexcept { return m_EnableBindless; }
+        ShaderVariantKey GetVariantKey() const noexcept { return m_CurrentKey; }
+        const ShaderKeywordSet& GetKeywordSet() const noexcept { return m_Keywords; }
+
+    private:
+        struct PendingVariant
+        {
+            ShaderVariantKey m_Key;
+            std::vector<ShaderDesc> m_ShaderDescs;
+            std::vector<std::future<ShaderCacheEntry>> m_Results;
+        };
+
+        std::vector<ShaderDesc> GetVariantShaderDescs(ShaderVariantKey key) const;
+        void CreateVariantPass(ShaderVariantKey key);
+        void UpdatePendingVariants();
+        IShaderPass* GetVariantPass(ShaderVariantKey key);
+
+    private:
+        ID3D12Device* m_Device = nullptr;
+        bool m_EnableBindless = false;
+
+        ShaderKeywordSet m_Keywords;
+        ShaderVariantTable<std::shared_ptr<IShaderPass>> m_Variants;
+        std::vector<PendingVariant> m_PendingVariants;
+        ShaderVariantKey m_DefaultKey = 0;
+        ShaderVariantKey m_CurrentKey = 0;
+
+        IShaderPass* m_PreparedPass = nullptr;
+        ShaderVariantKey m_PreparedKey = 0;
     };
 
 
     class ShadowShader : public IShader
     {
     public:
-        explicit ShadowShader(ID3D12Device* device);
+        explicit ShadowShader(ID3D12Device* device, bool enableBindless = false);
 
         void SetObjectCB(std::shared_ptr<D3D12ResourceLocation> cb);
         void SetPassCB(std::shared_ptr<D3D12ResourceLocation> cb);
@@ -50,8 +105,10 @@ namespace DSM {
 
         virtual void Apply(ID3D12GraphicsCommandList* cmdList, FrameResource* frameResource) override;
 
+        bool IsBindless() const noexcept { return m_EnableBindless; }
 
     private:
+        bool m_EnableBindless = false;
         bool m_EnableAlphaTest = true;
         std::array<std::shared_ptr<IShaderPass>, 2> m_ShaderPasses;
         std::uint8_t m_CurrentPass = 0;
@@ -0,0 +1,99 @@
+#pragma once
+#ifndef __SHADERBINDINGTABLE__H__
+#define __SHADERBINDINGTABLE__H__
+
+#include <algorithm>
+#include <cstdint>
+#include <deque>
+#include <utility>
+#include <vector>
+
+namespace DSM {
+	// 绑定表的键，高 32 位为寄存器空间，低 32 位为绑定点，不同索引的键不会冲突
+	using ShaderParameterKey = std::uint64_t;
+
+	/// <summary>
+	/// 着色器参数在着色器中的唯一索引
+	/// </summary>
+	struct ShaderParameterIndex
+	{
+		std::uint32_t m_BindPoint;
+		std::uint32_t m_RegisterSpace;
+
+		// 键的大小顺序与 (space, bindPoint) 的字典序一致
+		static constexpr ShaderParameterKey GetKeyByIndex(const ShaderParameterIndex& index) noexcept
+		{
+			return (static_cast<ShaderParameterKey>(index.m_RegisterSpace) << 32) | index.m_BindPoint;
+		}
+
+		static constexpr ShaderParameterIndex GetIndexByKey(ShaderParameterKey key) noexcept
+		{
+			return { static_cast<std::uint32_t>(key), static_cast<std::uint32_t>(key >> 32) };
+		}
+	};
+
+	// 以绑定键排序的平坦表，在反射时建立，查找为连续内存上的二分查找
+	// 元素存放在 deque 中，插入新元素后已有元素的地址不变，常量缓冲区变量可以持有其指针
+	template <typename Key, typename T>
+	class ShaderBindingTable
+	{
+	public:
+		using Entry = std::pair<Key, T*>;
+		using Iterator = typename std::vector<Entry>::const_iterator;
+
+		T* Find(Key key) noexcept
+		{
+			auto it = LowerBound(key);
+			return it != m_Entries.end() && it->first == key ? it->second : nullptr;
+		}
+
+		const T* Find(Key key) const noexcept
+		{
+			auto it = LowerBound(key);
+			return it != m_Entries.end() && it->first == key ? it->second : nullptr;
+		}
+
+		bool Contains(Key key) const noexcept
+		{
+			return Find(key) != nullptr;
+		}
+
+		// 不存在时插入默认构造的元素
+		T& operator[](Key key)
+		{
+			auto it = LowerBound(key);
+			if (it != m_Entries.end() && it->first == key) {
+				return *it->second;
+			}
+			auto& value = m_Values.emplace_back();
+			m_Entries.insert(it, Entry{ key, &value });
+			return value;
+		}
+
+		void Clear() noexcept
+		{
+			m_Entries.clear();
+			m_Values.clear();
+		}
+
+		std::size_t Size() const noexcept { return m_Entries.size(); }
+		bool Empty() const noexcept { return m_Entries.empty(); }
+
+		// 按键的顺序遍历
+		Iterator begin() const noexcept { return m_Entries.begin(); }
+		Iterator end() const noexcept { return m_Entries.end(); }
+
+	private:
+		typename std::vector<Entry>::const_iterator LowerBound(Key key) const noexcept
+		{
+			return std::lower_bound(m_Entries.begin(), m_Entries.end(), key, [](const Entry& entry, Key k) {
+				return entry.first < k;
+				});
+		}
+
+		std::vector<Entry> m_Entries;
+		std::deque<T> m_Values;
+	};
+}
+
+#endif
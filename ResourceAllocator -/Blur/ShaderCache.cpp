@@ -0,0 +1,433 @@
+#include "ShaderCache.h"
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <set>
+#include <sstream>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+
+namespace DSM {
+	namespace {
+		constexpr std::uint32_t CacheMagic = 0x43534D44;	// "DMSC"
+		constexpr std::uint64_t FnvOffsetBasis = 14695981039346656037ull;
+		constexpr std::uint64_t FnvPrime = 1099511628211ull;
+
+		// FNV-1a
+		void HashBytes(std::uint64_t& hash, const void* data, std::size_t size)
+		{
+			auto bytes = static_cast<const std::uint8_t*>(data);
+			for (std::size_t i = 0; i < size; ++i) {
+				hash ^= bytes[i];
+				hash *= FnvPrime;
+			}
+		}
+
+		template <typename T>
+		void HashValue(std::uint64_t& hash, T value)
+		{
+			static_assert(std::is_trivially_copyable_v<T>);
+			HashBytes(hash, &value, sizeof(T));
+		}
+
+		// 带上长度，避免相邻的字符串拼接后产生相同的哈希
+		void HashString(std::uint64_t& hash, std::string_view str)
+		{
+			HashValue(hash, static_cast<std::uint64_t>(str.size()));
+			HashBytes(hash, str.data(), str.size());
+		}
+
+		bool ReadWholeFile(const std::filesystem::path& fileName, std::vector<std::uint8_t>& data)
+		{
+			std::ifstream file(fileName, std::ios::binary | std::ios::ate);
+			if (!file) return false;
+
+			auto size = file.tellg();
+			if (size < 0) return false;
+			data.resize(static_cast<std::size_t>(size));
+			file.seekg(0);
+			return size == 0 || file.read(reinterpret_cast<char*>(data.data()), size).good();
+		}
+
+		// 从一行中取出 #include 的文件名
+		bool ParseInclude(std::string_view line, std::string& includeName)
+		{
+			auto skipSpace = [&line]() {
+				while (!line.empty() && (line.front() == ' ' || line.front() == '\t')) {
+					line.remove_prefix(1);
+				}
+				};
+
+			skipSpace();
+			if (line.empty() || line.front() != '#') return false;
+			line.remove_prefix(1);
+			skipSpace();
+			if (line.substr(0, 7) != "include") return false;
+			line.remove_prefix(7);
+			skipSpace();
+			if (line.empty() || (line.front() != '"' && line.front() != '<')) return false;
+
+			const char close = line.front() == '"' ? '"' : '>';
+			line.remove_prefix(1);
+			auto end = line.find(close);
+			if (end == std::string_view::npos) return false;
+			includeName.assign(line.substr(0, end));
+			return true;
+		}
+
+		void HashSourceRecursive(
+			const std::filesystem::path& fileName,
+			std::uint64_t& hash,
+			std::set<std::filesystem::path>& visited)
+		{
+			std::error_code ec;
+			auto canonical = std::filesystem::weakly_canonical(fileName, ec);
+			if (ec) canonical = fileName;
+			// 每个文件只计算一次，同时避免循环包含
+			if (!visited.insert(canonical).second) return;
+
+			std::vector<std::uint8_t> source;
+			if (!ReadWholeFile(fileName, source)) {
+				// 找不到的文件只记录名字，文件出现后键会改变
+				HashString(hash, fileName.generic_string());
+				return;
+			}
+			HashValue(hash, static_cast<std::uint64_t>(source.size()));
+			HashBytes(hash, source.data(), source.size());
+
+			// 先相对于当前文件查找被包含的文件，找不到再相对于工作目录
+			std::string_view text(reinterpret_cast<const char*>(source.data()), source.size());
+			std::string includeName;
+			while (!text.empty()) {
+				auto lineEnd = text.find('\n');
+				auto line = text.substr(0, lineEnd);
+				text.remove_prefix(lineEnd == std::string_view::npos ? text.size() : lineEnd + 1);
+
+				if (!ParseInclude(line, includeName)) continue;
+				auto includePath = fileName.parent_path() / includeName;
+				if (!std::filesystem::exists(includePath, ec)) {
+					includePath = includeName;
+				}
+				HashSourceRecursive(includePath, hash, visited);
+			}
+		}
+
+
+		class BlobWriter
+		{
+		public:
+			explicit BlobWriter(std::vector<std::uint8_t>& data) :m_Data(data) {}
+
+			template <typename T>
+			void Write(T value)
+			{
+				static_assert(std::is_trivially_copyable_v<T>);
+				WriteBytes(&value, sizeof(T));
+			}
+
+			void WriteBytes(const void* data, std::size_t size)
+			{
+				auto bytes = static_cast<const std::uint8_t*>(data);
+				m_Data.insert(m_Data.end(), bytes, bytes + size);
+			}
+
+			void WriteString(const std::string& str)
+			{
+				Write(static_cast<std::uint32_t>(str.size()));
+				WriteBytes(str.data(), str.size());
+			}
+
+			void WriteBuffer(const std::vector<std::uint8_t>& buffer)
+			{
+				Write(static_cast<std::uint32_t>(buffer.size()));
+				WriteBytes(buffer.data(), buffer.size());
+			}
+
+		private:
+			std::vector<std::uint8_t>& m_Data;
+		};
+
+		// 所有读取都检查边界，越界后保持失败状态
+		class BlobReader
+		{
+		public:
+			BlobReader(const std::uint8_t* data, std::size_t size) :m_Data(data), m_Size(size) {}
+
+			template <typename T>
+			bool Read(T& value)
+			{
+				static_assert(std::is_trivially_copyable_v<T>);
+				return ReadBytes(&value, sizeof(T));
+			}
+
+			bool ReadBytes(void* data, std::size_t size)
+			{
+				if (m_Failed || size > m_Size - m_Offset) {
+					m_Failed = true;
+					return false;
+				}
+				if (size > 0) {
+					std::memcpy(data, m_Data + m_Offset, size);
+				}
+				m_Offset += size;
+				return true;
+			}
+
+			// 读取元素数量，数量不可能超过剩余的字节数
+			bool ReadCount(std::uint32_t& count, std::size_t elementSize = 1)
+			{
+				if (!Read(count)) return false;
+				if (static_cast<std::uint64_t>(count) * elementSize > m_Size - m_Offset) {
+					m_Failed = true;
+				}
+				return !m_Failed;
+			}
+
+			bool ReadString(std::string& str)
+			{
+				std::uint32_t size = 0;
+				if (!ReadCount(size)) return false;
+				str.resize(size);
+				return ReadBytes(str.data(), size);
+			}
+
+			bool ReadBuffer(std::vector<std::uint8_t>& buffer)
+			{
+				std::uint32_t size = 0;
+				if (!ReadCount(size)) return false;
+				buffer.resize(size);
+				return ReadBytes(buffer.data(), size);
+			}
+
+			bool IsEnd() const noexcept { return !m_Failed && m_Offset == m_Size; }
+
+		private:
+			const std::uint8_t* m_Data;
+			std::size_t m_Size;
+			std::size_t m_Offset = 0;
+			bool m_Failed = false;
+		};
+
+		struct CacheHeader
+		{
+			std::uint32_t m_Magic;
+			std::uint32_t m_Version;
+			std::uint64_t m_Key;
+			std::uint64_t m_PayloadSize;
+			std::uint64_t m_PayloadHash;
+		};
+	}
+
+	ShaderCache::ShaderCache(std::filesystem::path directory, std::string configuration)
+		:m_Directory(std::move(directory)), m_Configuration(std::move(configuration)) {
+	}
+
+	std::uint64_t ShaderCache::ComputeKey(
+		const std::string& fileName,
+		const std::string& entryPoint,
+		const std::string& target,
+		const std::map<std::string, std::string>& defines) const
+	{
+		std::uint64_t hash = FnvOffsetBasis;
+		HashValue(hash, FormatVersion);
+		HashString(hash, m_Configuration);
+		HashValue(hash, HashSourceFile(fileName));
+		HashString(hash, entryPoint);
+		HashString(hash, target);
+		// std::map 已按名字排序，添加宏的顺序不影响键
+		HashValue(hash, static_cast<std::uint64_t>(defines.size()));
+		for (const auto& [name, value] : defines) {
+			HashString(hash, name);
+			HashString(hash, value);
+		}
+		return hash;
+	}
+
+	bool ShaderCache::Load(std::uint64_t key, ShaderCacheEntry& entry) const
+	{
+		std::vector<std::uint8_t> data;
+		if (!ReadWholeFile(GetEntryPath(key), data)) {
+			return false;
+		}
+		return Deserialize(data.data(), data.size(), key, entry);
+	}
+
+	bool ShaderCache::Store(std::uint64_t key, const ShaderCacheEntry& entry) const
+	{
+		std::error_code ec;
+		std::filesystem::create_directories(m_Directory, ec);
+		if (ec) return false;
+
+		// 先写入临时文件再重命名，其他线程或进程不会读到写了一半的文件
+		auto path = GetEntryPath(key);
+		auto tempPath = path;
+		tempPath += "." + std::to_string(std::hash<std::thread::id>{}(std::this_thread::get_id())) + ".tmp";
+
+		auto data = Serialize(key, entry);
+		{
+			std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+			if (!file || !file.write(reinterpret_cast<const char*>(data.data()), data.size())) {
+				file.close();
+				std::filesystem::remove(tempPath, ec);
+				return false;
+			}
+		}
+		std::filesystem::rename(tempPath, path, ec);
+		if (ec) {
+			std::filesystem::remove(tempPath, ec);
+			return false;
+		}
+		return true;
+	}
+
+	const std::filesystem::path& ShaderCache::GetDirectory() const noexcept
+	{
+		return m_Directory;
+	}
+
+	std::filesystem::path ShaderCache::GetEntryPath(std::uint64_t key) const
+	{
+		std::ostringstream os;
+		os << std::hex << std::setw(16) << std::setfill('0') << key << ".shader";
+		return m_Directory / os.str();
+	}
+
+	std::uint64_t ShaderCache::HashSourceFile(const std::filesystem::path& fileName)
+	{
+		std::uint64_t hash = FnvOffsetBasis;
+		std::set<std::filesystem::path> visited;
+		HashSourceRecursive(fileName, hash, visited);
+		return hash;
+	}
+
+	std::vector<std::filesystem::path> ShaderCache::GetSourceDependencies(const std::filesystem::path& fileName)
+	{
+		std::uint64_t hash = FnvOffsetBasis;
+		std::set<std::filesystem::path> visited;
+		HashSourceRecursive(fileName, hash, visited);
+		return { visited.begin(), visited.end() };
+	}
+
+	std::vector<std::uint8_t> ShaderCache::Serialize(std::uint64_t key, const ShaderCacheEntry& entry)
+	{
+		std::vector<std::uint8_t> payload;
+		BlobWriter writer(payload);
+		writer.WriteBuffer(entry.m_ByteCode);
+
+		const auto& reflection = entry.m_Reflection;
+		for (auto size : reflection.m_ThreadGroupSize) {
+			writer.Write(size);
+		}
+		writer.Write(static_cast<std::uint32_t>(reflection.m_ConstantBuffers.size()));
+		for (const auto& cb : reflection.m_ConstantBuffers) {
+			writer.WriteString(cb.m_Name);
+			writer.Write(cb.m_BindPoint);
+			writer.Write(cb.m_RegisterSpace);
+			writer.Write(cb.m_Size);
+			writer.Write(static_cast<std::uint32_t>(cb.m_Variables.size()));
+			for (const auto& var : cb.m_Variables) {
+				writer.WriteString(var.m_Name);
+				writer.Write(var.m_StartOffset);
+				writer.Write(var.m_Size);
+				writer.WriteBuffer(var.m_DefaultValue);
+			}
+		}
+		writer.Write(static_cast<std::uint32_t>(reflection.m_Bindings.size()));
+		for (const auto& binding : reflection.m_Bindings) {
+			writer.WriteString(binding.m_Name);
+			writer.Write(static_cast<std::uint32_t>(binding.m_Type));
+			writer.Write(binding.m_BindPoint);
+			writer.Write(binding.m_RegisterSpace);
+			writer.Write(binding.m_BindCount);
+			writer.Write(binding.m_Dimension);
+			writer.Write(static_cast<std::uint8_t>(binding.m_EnableCounter));
+		}
+
+		CacheHeader header{};
+		header.m_Magic = CacheMagic;
+		header.m_Version = FormatVersion;
+		header.m_Key = key;
+		header.m_PayloadSize = payload.size();
+		header.m_PayloadHash = FnvOffsetBasis;
+		HashBytes(header.m_PayloadHash, payload.data(), payload.size());
+
+		std::vector<std::uint8_t> data;
+		data.reserve(sizeof(CacheHeader) + payload.size());
+		BlobWriter(data).Write(header);
+		data.insert(data.end(), payload.begin(), payload.end());
+		return data;
+	}
+
+	bool ShaderCache::Deserialize(const std::uint8_t* data, std::size_t size, std::uint64_t key, ShaderCacheEntry& entry)
+	{
+		if (data == nullptr) return false;
+
+		BlobReader headerReader(data, size);
+		CacheHeader header{};
+		if (!headerReader.Read(header) ||
+			header.m_Magic != CacheMagic ||
+			header.m_Version != FormatVersion ||
+			header.m_Key != key ||
+			header.m_PayloadSize != size - sizeof(CacheHeader)) {
+			return false;
+		}
+		auto payload = data + sizeof(CacheHeader);
+		auto payloadHash = FnvOffsetBasis;
+		HashBytes(payloadHash, payload, static_cast<std::size_t>(header.m_PayloadSize));
+		if (payloadHash != header.m_PayloadHash) {
+			return false;
+		}
+
+		ShaderCacheEntry ret{};
+		BlobReader reader(payload, static_cast<std::size_t>(header.m_PayloadSize));
+		reader.ReadBuffer(ret.m_ByteCode);
+
+		auto& reflection = ret.m_Reflection;
+		for (auto& groupSize : reflection.m_ThreadGroupSize) {
+			reader.Read(groupSize);
+		}
+		std::uint32_t cbCount = 0;
+		reader.ReadCount(cbCount);
+		reflection.m_ConstantBuffers.resize(cbCount);
+		for (auto& cb : reflection.m_ConstantBuffers) {
+			std::uint32_t varCount = 0;
+			reader.ReadString(cb.m_Name);
+			reader.Read(cb.m_BindPoint);
+			reader.Read(cb.m_RegisterSpace);
+			reader.Read(cb.m_Size);
+			if (!reader.ReadCount(varCount)) return false;
+			cb.m_Variables.resize(varCount);
+			for (auto& var : cb.m_Variables) {
+				reader.ReadString(var.m_Name);
+				reader.Read(var.m_StartOffset);
+				reader.Read(var.m_Size);
+				reader.ReadBuffer(var.m_DefaultValue);
+			}
+		}
+		std::uint32_t bindingCount = 0;
+		reader.ReadCount(bindingCount);
+		reflection.m_Bindings.resize(bindingCount);
+		for (auto& binding : reflection.m_Bindings) {
+			std::uint32_t type = 0;
+			std::uint8_t enableCounter = 0;
+			reader.ReadString(binding.m_Name);
+			reader.Read(type);
+			reader.Read(binding.m_BindPoint);
+			reader.Read(binding.m_RegisterSpace);
+			reader.Read(binding.m_BindCount);
+			reader.Read(binding.m_Dimension);
+			reader.Read(enableCounter);
+			if (type > static_cast<std::uint32_t>(ShaderBindingType::SAMPLER)) return false;
+			binding.m_Type = static_cast<ShaderBindingType>(type);
+			binding.m_EnableCounter = enableCounter != 0;
+		}
+
+		// 必须恰好读完所有数据
+		if (!reader.IsEnd()) {
+			return false;
+		}
+		entry = std::move(ret);
+		return true;
+	}
+}
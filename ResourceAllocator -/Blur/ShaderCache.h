@@ -0,0 +1,101 @@
+#pragma once
+#ifndef __SHADERCACHE__H__
+#define __SHADERCACHE__H__
+
+#include <array>
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace DSM {
+	// 常量缓冲区中的变量，大小已根据反射结果计算好
+	struct ShaderVariableData
+	{
+		std::string m_Name;
+		std::uint32_t m_StartOffset = 0;
+		std::uint32_t m_Size = 0;
+		std::vector<std::uint8_t> m_DefaultValue;
+	};
+
+	struct ShaderConstantBufferData
+	{
+		std::string m_Name;
+		std::uint32_t m_BindPoint = 0;
+		std::uint32_t m_RegisterSpace = 0;
+		std::uint32_t m_Size = 0;
+		std::vector<ShaderVariableData> m_Variables;
+	};
+
+	enum class ShaderBindingType : std::uint32_t
+	{
+		SHADER_RESOURCE,
+		RW_RESOURCE,
+		SAMPLER
+	};
+
+	// 除常量缓冲区以外的资源绑定
+	struct ShaderBindingData
+	{
+		std::string m_Name;
+		ShaderBindingType m_Type = ShaderBindingType::SHADER_RESOURCE;
+		std::uint32_t m_BindPoint = 0;
+		std::uint32_t m_RegisterSpace = 0;
+		std::uint32_t m_BindCount = 0;
+		std::uint32_t m_Dimension = 0;
+		bool m_EnableCounter = false;
+	};
+
+	// 着色器反射结果的可序列化形式，不依赖 D3D12 的反射接口
+	struct ShaderReflectionData
+	{
+		std::array<std::uint32_t, 3> m_ThreadGroupSize{};
+		std::vector<ShaderConstantBufferData> m_ConstantBuffers;
+		std::vector<ShaderBindingData> m_Bindings;
+	};
+
+	struct ShaderCacheEntry
+	{
+		std::vector<std::uint8_t> m_ByteCode;
+		ShaderReflectionData m_Reflection;
+	};
+
+	// 以内容寻址的着色器字节码与反射缓存
+	// 键由源文件及其包含文件的内容、宏定义、入口点、目标与编译配置计算得到，
+	// 任意一项改变都会得到新的键，因此旧的缓存文件自然失效
+	class ShaderCache
+	{
+	public:
+		inline static constexpr std::uint32_t FormatVersion = 1;
+
+		ShaderCache(std::filesystem::path directory, std::string configuration = {});
+
+		std::uint64_t ComputeKey(
+			const std::string& fileName,
+			const std::string& entryPoint,
+			const std::string& target,
+			const std::map<std::string, std::string>& defines) const;
+
+		// 读取失败或文件损坏时返回 false
+		bool Load(std::uint64_t key, ShaderCacheEntry& entry) const;
+		bool Store(std::uint64_t key, const ShaderCacheEntry& entry) const;
+
+		const std::filesystem::path& GetDirectory() const noexcept;
+		std::filesystem::path GetEntryPath(std::uint64_t key) const;
+
+		// 递归计算文件及其 #include 文件的内容哈希
+		static std::uint64_t HashSourceFile(const std::filesystem::path& fileName);
+		// 文件本身及其递归 #include 的所有文件，与计算哈希时访问的文件相同
+		static std::vector<std::filesystem::path> GetSourceDependencies(const std::filesystem::path& fileName);
+		static std::vector<std::uint8_t> Serialize(std::uint64_t key, const ShaderCacheEntry& entry);
+		// 校验文件头、键与内容哈希，任意一项不匹配都返回 false
+		static bool Deserialize(const std::uint8_t* data, std::size_t size, std::uint64_t key, ShaderCacheEntry& entry);
+
+	private:
+		std::filesystem::path m_Directory;
+		std::string m_Configuration;
+	};
+}
+
+#endif
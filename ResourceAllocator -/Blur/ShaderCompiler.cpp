@@ -0,0 +1,88 @@
+#include "ShaderCompiler.h"
+#include <cassert>
+
+namespace DSM {
+	//
+	// CachedShaderCompiler Implementation
+	//
+	CachedShaderCompiler::CachedShaderCompiler(ShaderCache& shaderCache, IShaderCompiler& compiler)
+		:m_ShaderCache(shaderCache), m_Compiler(compiler) {
+	}
+
+	ShaderCacheEntry CachedShaderCompiler::Compile(const ShaderCompileDesc& compileDesc)
+	{
+		auto cacheKey = m_ShaderCache.ComputeKey(
+			compileDesc.m_FileName,
+			compileDesc.m_EntryPoint,
+			compileDesc.m_Target,
+			compileDesc.m_Defines);
+
+		// 命中缓存时跳过编译与反射
+		ShaderCacheEntry entry{};
+		if (m_ShaderCache.Load(cacheKey, entry) && !entry.m_ByteCode.empty()) {
+			return entry;
+		}
+
+		entry = m_Compiler.Compile(compileDesc);
+		// 写入失败只会导致下次重新编译
+		m_ShaderCache.Store(cacheKey, entry);
+		return entry;
+	}
+
+
+	//
+	// ShaderCompileQueue Implementation
+	//
+	ShaderCompileQueue::ShaderCompileQueue(IShaderCompiler* compiler, JobSystem& jobSystem)
+		:m_Compiler(compiler), m_JobSystem(jobSystem) {
+		assert(m_Compiler != nullptr);
+	}
+
+	ShaderCompileQueue::~ShaderCompileQueue()
+	{
+		// 编译的异常保存在 future 中，任务本身不会抛出异常
+		m_JobSystem.Wait(m_Pending);
+	}
+
+	std::future<ShaderCacheEntry> ShaderCompileQueue::Submit(ShaderCompileDesc compileDesc)
+	{
+		return Submit(std::move(compileDesc), m_Pending);
+	}
+
+	std::vector<ShaderCacheEntry> ShaderCompileQueue::CompileAll(const std::vector<ShaderCompileDesc>& compileDescs)
+	{
+		// 以单独的计数器等待这一组编译，不受其他线程通过 Submit 提交的编译影响
+		JobCounter counter;
+		std::vector<std::future<ShaderCacheEntry>> futures;
+		futures.reserve(compileDescs.size());
+		for (const auto& desc : compileDescs) {
+			futures.push_back(Submit(desc, counter));
+		}
+		m_JobSystem.Wait(counter);
+
+		std::vector<ShaderCacheEntry> results;
+		results.reserve(futures.size());
+		for (auto& future : futures) {
+			results.push_back(future.get());
+		}
+		return results;
+	}
+
+	std::uint32_t ShaderCompileQueue::GetThreadCount() const noexcept
+	{
+		return m_JobSystem.GetThreadCount();
+	}
+
+	std::future<ShaderCacheEntry> ShaderCompileQueue::Submit(ShaderCompileDesc compileDesc, JobCounter& counter)
+	{
+		// 编译抛出的异常保存在 future 中，在取结果的线程中重新抛出
+		// std::function 要求可复制，packaged_task 只能移动，因此以 shared_ptr 持有
+		auto task = std::make_shared<std::packaged_task<ShaderCacheEntry()>>(
+			[compiler = m_Compiler, desc = std::move(compileDesc)]() {
+				return compiler->Compile(desc);
+			});
+		auto future = task->get_future();
+		m_JobSystem.Run([task]() { (*task)(); }, counter);
+		return future;
+	}
+}
@@ -0,0 +1,80 @@
+#pragma once
+#ifndef __SHADERCOMPILER__H__
+#define __SHADERCOMPILER__H__
+
+#include "ShaderCache.h"
+#include "JobSystem.h"
+#include <future>
+
+namespace DSM {
+	enum class ShaderType : int
+	{
+		VERTEX_SHADER,
+		HULL_SHADER,
+		DOMAIN_SHADER,
+		GEOMETRY_SHADER,
+		PIXEL_SHADER,
+		COMPUTE_SHADER,
+		NUM_SHADER_TYPES
+	};
+
+	// 编译一个着色器入口点所需的全部信息
+	struct ShaderCompileDesc
+	{
+		std::string m_FileName;
+		std::string m_EntryPoint;
+		std::string m_Target;
+		ShaderType m_Type = ShaderType::VERTEX_SHADER;
+		std::map<std::string, std::string> m_Defines;
+	};
+
+	// 编译器后端，需要可在多个线程中同时调用，编译失败时抛出异常
+	struct IShaderCompiler
+	{
+		virtual ShaderCacheEntry Compile(const ShaderCompileDesc& compileDesc) = 0;
+		virtual ~IShaderCompiler() = default;
+	};
+
+	// 先查询磁盘缓存，未命中时调用实际的编译器并写回缓存
+	class CachedShaderCompiler : public IShaderCompiler
+	{
+	public:
+		CachedShaderCompiler(ShaderCache& shaderCache, IShaderCompiler& compiler);
+
+		virtual ShaderCacheEntry Compile(const ShaderCompileDesc& compileDesc) override;
+
+	private:
+		ShaderCache& m_ShaderCache;
+		IShaderCompiler& m_Compiler;
+	};
+
+	// 在任务系统的工作线程中并行编译着色器，不另外创建线程
+	// 每个着色器的结果通过 future 返回，按提交顺序取出结果即可得到与串行编译相同的合并顺序
+	class ShaderCompileQueue
+	{
+	public:
+		explicit ShaderCompileQueue(IShaderCompiler* compiler, JobSystem& jobSystem = JobSystem::GetDefault());
+		// 等待已提交的编译完成
+		~ShaderCompileQueue();
+		ShaderCompileQueue(const ShaderCompileQueue&) = delete;
+		ShaderCompileQueue& operator=(const ShaderCompileQueue&) = delete;
+
+		std::future<ShaderCacheEntry> Submit(ShaderCompileDesc compileDesc);
+		// 编译一组着色器并等待完成，结果与 compileDescs 的顺序一致
+		// 等待期间调用线程也执行编译任务，可在任务系统的任务中调用
+		std::vector<ShaderCacheEntry> CompileAll(const std::vector<ShaderCompileDesc>& compileDescs);
+
+		std::uint32_t GetThreadCount() const noexcept;
+
+	private:
+		std::future<ShaderCacheEntry> Submit(ShaderCompileDesc compileDesc, JobCounter& counter);
+
+	private:
+		IShaderCompiler* m_Compiler;
+		JobSystem& m_JobSystem;
+		// 通过 Submit 提交且尚未完成的编译
+		JobCounter m_Pending;
+	};
+}
+
+#endif
@@ -0,0 +1,129 @@
+#include "ShaderFileWatcher.h"
+#include <algorithm>
+#include <utility>
+
+namespace DSM {
+	ShaderFileWatcher::~ShaderFileWatcher()
+	{
+		Stop();
+	}
+
+	void ShaderFileWatcher::Watch(const std::filesystem::path& fileName)
+	{
+		auto path = Normalize(fileName);
+		auto stamp = GetStamp(path);
+
+		std::lock_guard lock(m_Mutex);
+		m_Files.try_emplace(std::move(path), WatchedFile{ stamp });
+	}
+
+	bool ShaderFileWatcher::IsWatching(const std::filesystem::path& fileName) const
+	{
+		auto path = Normalize(fileName);
+
+		std::lock_guard lock(m_Mutex);
+		return m_Files.contains(path);
+	}
+
+	std::size_t ShaderFileWatcher::GetWatchCount() const
+	{
+		std::lock_guard lock(m_Mutex);
+		return m_Files.size();
+	}
+
+	std::size_t ShaderFileWatcher::Poll()
+	{
+		// 读取文件状态时不持有锁，主线程取结果不会因文件系统访问而等待
+		std::vector<std::filesystem::path> paths;
+		{
+			std::lock_guard lock(m_Mutex);
+			paths.reserve(m_Files.size());
+			for (const auto& [path, file] : m_Files) {
+				paths.push_back(path);
+			}
+		}
+
+		std::vector<FileStamp> stamps;
+		stamps.reserve(paths.size());
+		for (const auto& path : paths) {
+			stamps.push_back(GetStamp(path));
+		}
+
+		std::size_t changeCount = 0;
+		std::lock_guard lock(m_Mutex);
+		for (std::size_t i = 0; i < paths.size(); ++i) {
+			auto it = m_Files.find(paths[i]);
+			if (it == m_Files.end()) continue;
+
+			auto& file = it->second;
+			if (stamps[i] == file.m_Stamp) {
+				file.m_Pending = false;
+				continue;
+			}
+			// 第一次发现变化时只记录，下一次检查状态未变才认为写入完成
+			if (!file.m_Pending || !(file.m_PendingStamp == stamps[i])) {
+				file.m_Pending = true;
+				file.m_PendingStamp = stamps[i];
+				continue;
+			}
+			file.m_Stamp = stamps[i];
+			file.m_Pending = false;
+			if (std::find(m_Changes.begin(), m_Changes.end(), paths[i]) == m_Changes.end()) {
+				m_Changes.push_back(paths[i]);
+				++changeCount;
+			}
+		}
+		return changeCount;
+	}
+
+	std::vector<std::filesystem::path> ShaderFileWatcher::TakeChanges()
+	{
+		std::lock_guard lock(m_Mutex);
+		return std::exchange(m_Changes, {});
+	}
+
+	void ShaderFileWatcher::Start(std::chrono::milliseconds interval)
+	{
+		Stop();
+
+		m_Stop = false;
+		m_Thread = std::thread([this, interval]() {
+			std::unique_lock lock(m_Mutex);
+			while (!m_Condition.wait_for(lock, interval, [this]() { return m_Stop; })) {
+				lock.unlock();
+				Poll();
+				lock.lock();
+			}
+			});
+	}
+
+	void ShaderFileWatcher::Stop()
+	{
+		if (!m_Thread.joinable()) return;
+		{
+			std::lock_guard lock(m_Mutex);
+			m_Stop = true;
+		}
+		m_Condition.notify_all();
+		m_Thread.join();
+	}
+
+	std::filesystem::path ShaderFileWatcher::Normalize(const std::filesystem::path& fileName)
+	{
+		std::error_code ec;
+		auto path = std::filesystem::weakly_canonical(fileName, ec);
+		return ec ? fileName.lexically_normal() : path;
+	}
+
+	ShaderFileWatcher::FileStamp ShaderFileWatcher::GetStamp(const std::filesystem::path& fileName)
+	{
+		FileStamp stamp{};
+		std::error_code ec;
+		stamp.m_WriteTime = std::filesystem::last_write_time(fileName, ec);
+		if (ec) return FileStamp{};
+		stamp.m_Size = std::filesystem::file_size(fileName, ec);
+		if (ec) return FileStamp{};
+		stamp.m_Exists = true;
+		return stamp;
+	}
+}
@@ -0,0 +1,73 @@
+#pragma once
+#ifndef __SHADERFILEWATCHER__H__
+#define __SHADERFILEWATCHER__H__
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace DSM {
+	// 轮询文件的修改时间与大小，检测着色器源文件的修改
+	// 可以在后台线程中定时检查，也可以由调用者直接调用 Poll
+	class ShaderFileWatcher
+	{
+	public:
+		ShaderFileWatcher() = default;
+		~ShaderFileWatcher();
+		ShaderFileWatcher(const ShaderFileWatcher&) = delete;
+		ShaderFileWatcher& operator=(const ShaderFileWatcher&) = delete;
+
+		// 记录文件当前的状态，之后的修改才会被报告，文件不存在时等待其出现
+		void Watch(const std::filesystem::path& fileName);
+		bool IsWatching(const std::filesystem::path& fileName) const;
+		std::size_t GetWatchCount() const;
+
+		// 检查一次所有文件，返回新检测到的修改数量
+		// 状态在两次检查之间保持不变才报告，避免编辑器分段写入时读到不完整的文件
+		std::size_t Poll();
+		// 取出累积的已修改文件，不会等待检查
+		std::vector<std::filesystem::path> TakeChanges();
+
+		// 在后台线程中每隔 interval 调用一次 Poll
+		void Start(std::chrono::milliseconds interval);
+		void Stop();
+
+		// 文件路径统一规范化后比较
+		static std::filesystem::path Normalize(const std::filesystem::path& fileName);
+
+	private:
+		struct FileStamp
+		{
+			std::filesystem::file_time_type m_WriteTime{};
+			std::uintmax_t m_Size = 0;
+			bool m_Exists = false;
+
+			bool operator==(const FileStamp&) const = default;
+		};
+
+		struct WatchedFile
+		{
+			FileStamp m_Stamp{};
+			FileStamp m_PendingStamp{};
+			bool m_Pending = false;
+		};
+
+		static FileStamp GetStamp(const std::filesystem::path& fileName);
+
+	private:
+		mutable std::mutex m_Mutex;
+		std::map<std::filesystem::path, WatchedFile> m_Files;
+		std::vector<std::filesystem::path> m_Changes;
+
+		std::thread m_Thread;
+		std::condition_variable m_Condition;
+		bool m_Stop = false;
+	};
+}
+
+#endif
@@ -1,6 +1,9 @@
 #include "ShaderHelper.h"
+#include "ConstantBufferData.h"
 #include "FrameResource.h"
 #include "D3DUtil.h"
+#include "RootSignatureLayout.h"
+#include "ShaderBindingTable.h"
 
 
 using namespace DirectX;
@@ -21,6 +24,7 @@ namespace DSM {
 		std::vector<D3D12DescriptorHandle> m_Handle;
 		std::uint32_t m_BindCount;
 		D3D12_SRV_DIMENSION m_Dimension;
+		bool m_IsUnbounded = false;		// 无界数组，直接绑定无绑定描述符范围
 	};
 
 	// 可读写资源
@@ -42,17 +46,40 @@ namespace DSM {
 	// 常量缓冲区
 	struct ConstantBuffer : ShaderParameter
 	{
-		bool m_IsDrty;
-		std::vector<std::uint8_t> m_Data;
+		ConstantBufferData m_Data;
 		std::shared_ptr<D3D12ResourceLocation> m_Resource;
+		// 未绑定资源时每次绑定从帧资源中分配的临时内存
+		D3D12_GPU_VIRTUAL_ADDRESS m_TransientAddress = 0;
+		std::uint64_t m_TransientFrame = UINT64_MAX;
+		std::uint64_t m_TransientVersion = 0;
 
-		// 更新常量缓冲区
-		void UpdateBuffer()
+		// 获取需要绑定的地址，未绑定资源则将数据写入临时内存
+		D3D12_GPU_VIRTUAL_ADDRESS GetGPUVirtualAddress(FrameResource* frameResource)
 		{
-			if (m_IsDrty) {
-				assert(m_Resource != nullptr);
-				memcpy(m_Resource->m_MappedBaseAddress, m_Data.data(), m_Data.size());
+			assert(frameResource != nullptr);
+
+			if (m_Resource != nullptr) {
+				frameResource->m_ConstantBufferUploadBytes += m_Data.UpdateBuffer(m_Resource, m_Resource->m_MappedBaseAddress);
+				return m_Resource->m_GPUVirtualAddress;
+			}
+
+			auto ringBuffer = frameResource->m_UploadRingBuffer;
+			auto frame = ringBuffer == nullptr ? UINT64_MAX : ringBuffer->GetFrameCount();
+			// 数据未改变且仍在同一帧内则复用上一次的内存
+			if (m_TransientVersion != m_Data.GetVersion() || m_TransientAddress == 0 ||
+				frame == UINT64_MAX || frame != m_TransientFrame) {
+				D3D12ResourceLocation location{};
+				frameResource->AllocateTransientBuffer(
+					m_Data.GetByteSize(),
+					D3D12_CONSTANT_BUFFER_DATA_PLACEMENT_ALIGNMENT,
+					location);
+				memcpy(location.m_MappedBaseAddress, m_Data.GetData(), m_Data.GetByteSize());
+				frameResource->m_ConstantBufferUploadBytes += m_Data.GetByteSize();
+				m_TransientAddress = location.m_GPUVirtualAddress;
+				m_TransientFrame = frame;
+				m_TransientVersion = m_Data.GetVersion();
 			}
+			return m_TransientAddress;
 		}
 	};
 
@@ -90,11 +117,9 @@ namespace DSM {
 
 		void SetRow(std::uint32_t byteSize, const void* data, std::uint32_t offset = 0) override
 		{
-			assert(data != nullptr);
-			byteSize = min(byteSize, m_ByteSize);
-			memcpy(m_ConstantBuffer->m_Data.data() + m_StartOffset, data, byteSize);
-
-			m_ConstantBuffer->m_IsDrty = true;
+			assert(data != nullptr && offset <= m_ByteSize);
+			byteSize = (std::min)(byteSize, m_ByteSize - offset);
+			m_ConstantBuffer->m_Data.Write(m_StartOffset + offset, data, byteSize);
 		}
 
 		std::string m_Name;
@@ -109,7 +134,11 @@ namespace DSM {
 		std::string m_Name;
 		ComPtr<ID3DBlob> m_pShader;
 		std::unique_ptr<ConstantBuffer> m_pParamData = nullptr; // 每个着色器有自己的参数常量缓冲区
-		std::map<std::string, std::shared_ptr<ConstantBufferVariable>> m_ConstantBufferVariable;    // 常量缓冲区变量 
+		std::unordered_map<ShaderPropertyID, std::shared_ptr<ConstantBufferVariable>> m_ConstantBufferVariable;    // 常量缓冲区变量 
+		// 该着色器使用的绑定，用于决定根参数的可见性
+		std::vector<ShaderParameterKey> m_CBufferKeys;
+		std::vector<ShaderParameterKey> m_ShaderResourceKeys;
+		std::vector<ShaderParameterKey> m_RWResourceKeys;
 		virtual ~ShaderInfo() = default;
 	};
 
@@ -126,6 +155,11 @@ namespace DSM {
 		std::uint32_t m_ThreadGroupSizeZ = 0;
 	};
 
+	using ConstantBufferTable = ShaderBindingTable<ShaderParameterKey, ConstantBuffer>;
+	using ShaderResourceTable = ShaderBindingTable<ShaderParameterKey, ShaderResource>;
+	using RWResourceTable = ShaderBindingTable<ShaderParameterKey, RWResource>;
+	using SamplerStateTable = ShaderBindingTable<ShaderParameterKey, SamplerState>;
+
 
 	//
 	// ShaderDefines Implementation
@@ -165,6 +199,11 @@ namespace DSM {
 		return defines;
 	}
 
+	const std::map<std::string, std::string>& ShaderDefines::GetDefines() const noexcept
+	{
+		return m_Defines;
+	}
+
 
 #pragma region Shader Pass
 	//
@@ -172,18 +211,12 @@ namespace DSM {
 	//
 	struct ShaderPass : IShaderPass
 	{
-		enum ParamType : int
-		{
-			CONSTANTBUFFER = 0, TEXTURE = 1, SAMPLER = 2, UAV = 3, NUMTYPES
-		};
-
-
 		ShaderPass(ShaderHelper* shaderHelper,
 			const std::string& passName,
-			std::map<std::uint32_t, ConstantBuffer>& cBuffers,
-			std::map<std::uint32_t, ShaderResource>& shaderResources,
-			std::map<std::uint32_t, RWResource>& rwResources,
-			std::map<std::uint32_t, SamplerState>& samplerStates);
+			ConstantBufferTable& cBuffers,
+			ShaderResourceTable& shaderResources,
+			RWResourceTable& rwResources,
+			SamplerStateTable& samplerStates);
 
 		void SetBlendState(const D3D12_BLEND_DESC& blendDesc) override;
 		void SetRasterizerState(const D3D12_RASTERIZER_DESC& rasterizerDesc) override;
@@ -199,13 +232,13 @@ namespace DSM {
 
 		const D3D12_GRAPHICS_PIPELINE_STATE_DESC& GetPSODesc() const  override;
 
-		CBVariableSP VSGetParamByName(const std::string& paramName) override;
-		CBVariableSP DSGetParamByName(const std::string& paramName) override;
-		CBVariableSP HSGetParamByName(const std::string& paramName) override;
-		CBVariableSP GSGetParamByName(const std::string& paramName) override;
-		CBVariableSP PSGetParamByName(const std::string& paramName) override;
-		CBVariableSP CSGetParamByName(const std::string& paramName) override;
-		CBVariableSP GetParamByName(const std::string& paramName, ShaderType type);
+		CBVariableSP VSGetParamByName(ShaderPropertyID paramName) override;
+		CBVariableSP DSGetParamByName(ShaderPropertyID paramName) override;
+		CBVariableSP HSGetParamByName(ShaderPropertyID paramName) override;
+		CBVariableSP GSGetParamByName(ShaderPropertyID paramName) override;
+		CBVariableSP PSGetParamByName(ShaderPropertyID paramName) override;
+		CBVariableSP CSGetParamByName(ShaderPropertyID paramName) override;
+		CBVariableSP GetParamByName(ShaderPropertyID paramName, ShaderType type);
 
 		const ShaderHelper* GetShaderHelper() const override;
 		const std::string& GetPassName() const override;
@@ -225,25 +258,35 @@ namespace DSM {
 		std::vector<std::shared_ptr<ShaderInfo>> m_ShaderInfos{};
 
 		// 来自Shader中的共用资源
-		std::map<std::uint32_t, ConstantBuffer>& m_CBuffers;
-		std::map<std::uint32_t, ShaderResource>& m_ShaderResources;
-		std::map<std::uint32_t, RWResource>& m_RWResources;
-		std::map<std::uint32_t, SamplerState>& m_SamplerStates;
+		ConstantBufferTable& m_CBuffers;
+		ShaderResourceTable& m_ShaderResources;
+		RWResourceTable& m_RWResources;
+		SamplerStateTable& m_SamplerStates;
 
 		ComPtr<ID3D12RootSignature> m_pRootSignature = nullptr;	
 
 		// 用于最后生成PSO
 		D3D12_GRAPHICS_PIPELINE_STATE_DESC m_GraphicsPSODesc{};
 		D3D12_COMPUTE_PIPELINE_STATE_DESC m_ComputePSODesc{};
-		// 一趟Pass有一个PSO， 可能会有重复的PSO，暂不考虑
+		// 一趟Pass有一个PSO，相同描述的PSO由缓存共享
 		ComPtr<ID3D12PipelineState> m_pGraphicsPSO = nullptr;
 		ComPtr<ID3D12PipelineState> m_pComputePSO = nullptr;
-		std::array<std::vector<std::uint32_t>, NUMTYPES> m_RootParamIndexs{};
+		// 根签名中的一个绑定，常量缓冲区在创建根签名时解析为指针，绑定时不再查表
+		// 着色器参数常量缓冲区没有共用的键，只能通过指针找到
+		struct RootBinding
+		{
+			RootBindingType m_Type;
+			ShaderParameterKey m_Key;
+			ConstantBuffer* m_ConstantBuffer = nullptr;
+		};
+		// 根签名布局，根参数中的绑定索引对应 m_RootBindings 中的元素
+		RootSignatureLayout m_RootLayout{};
+		std::vector<RootBinding> m_RootBindings{};
 
 
 	private:
 		void CreateRootSignature(ID3D12Device* device);
-		void BindResources(ID3D12GraphicsCommandList* cmdList,
+		void BindResources(D3D12CommandListState& cmdListState,
 			FrameResource* frameResource,
 			bool isComput);
 		const std::array<const D3D12_STATIC_SAMPLER_DESC, 7> CreateStaticSamplers() const noexcept;
@@ -252,10 +295,10 @@ namespace DSM {
 
 	ShaderPass::ShaderPass(ShaderHelper* shaderHelper,
 		const std::string& passName,
-		std::map<std::uint32_t, ConstantBuffer>& cBuffers,
-		std::map<std::uint32_t, ShaderResource>& shaderResources,
-		std::map<std::uint32_t, RWResource>& rwResources,
-		std::map<std::uint32_t, SamplerState>& samplerStates)
+		ConstantBufferTable& cBuffers,
+		ShaderResourceTable& shaderResources,
+		RWResourceTable& rwResources,
+		SamplerStateTable& samplerStates)
 		:m_PassName(passName),
 		m_pShaderHealper(shaderHelper),
 		m_CBuffers(cBuffers),
@@ -395,7 +438,7 @@ namespace DSM {
 				m_GraphicsPSODesc.PS = { PS->m_pShader->GetBufferPointer(), PS->m_pShader->GetBufferSize() };
 			}
 
-			ThrowIfFailed(device->CreateGraphicsPipelineState(&m_GraphicsPSODesc, IID_PPV_ARGS(m_pGraphicsPSO.GetAddressOf())));
+			m_pGraphicsPSO = ShaderHelper::GetPipelineStateCache().GetOrCreateGraphicsPSO(device, m_GraphicsPSODesc);
 		}
 
 		if (m_ShaderInfos[getIndex(ShaderType::COMPUTE_SHADER)] != nullptr && m_pComputePSO == nullptr) {
@@ -403,7 +446,7 @@ namespace DSM {
 			auto CS = m_ShaderInfos[getIndex(ShaderType::COMPUTE_SHADER)]->m_pShader;
 			m_ComputePSODesc.CS = { CS->GetBufferPointer(), CS->GetBufferSize() };
 
-			ThrowIfFailed(device->CreateComputePipelineState(&m_ComputePSODesc, IID_PPV_ARGS(m_pComputePSO.GetAddressOf())));
+			m_pComputePSO = ShaderHelper::GetPipelineStateCache().GetOrCreateComputePSO(device, m_ComputePSODesc);
 		}
 	}
 
@@ -413,37 +456,37 @@ namespace DSM {
 		return m_GraphicsPSODesc;
 	}
 
-	ShaderPass::CBVariableSP ShaderPass::VSGetParamByName(const std::string& paramName)
+	ShaderPass::CBVariableSP ShaderPass::VSGetParamByName(ShaderPropertyID paramName)
 	{
 		return GetParamByName(paramName, ShaderType::VERTEX_SHADER);
 	}
 
-	ShaderPass::CBVariableSP ShaderPass::DSGetParamByName(const std::string& paramName)
+	ShaderPass::CBVariableSP ShaderPass::DSGetParamByName(ShaderPropertyID paramName)
 	{
 		return GetParamByName(paramName, ShaderType::DOMAIN_SHADER);
 	}
 
-	ShaderPass::CBVariableSP ShaderPass::HSGetParamByName(const std::string& paramName)
+	ShaderPass::CBVariableSP ShaderPass::HSGetParamByName(ShaderPropertyID paramName)
 	{
 		return GetParamByName(paramName, ShaderType::HULL_SHADER);
 	}
 
-	ShaderPass::CBVariableSP ShaderPass::GSGetParamByName(const std::string& paramName)
+	ShaderPass::CBVariableSP ShaderPass::GSGetParamByName(ShaderPropertyID paramName)
 	{
 		return GetParamByName(paramName, ShaderType::GEOMETRY_SHADER);
 	}
 
-	ShaderPass::CBVariableSP ShaderPass::PSGetParamByName(const std::string& paramName)
+	ShaderPass::CBVariableSP ShaderPass::PSGetParamByName(ShaderPropertyID paramName)
 	{
 		return GetParamByName(paramName, ShaderType::PIXEL_SHADER);
 	}
 
-	ShaderPass::CBVariableSP ShaderPass::CSGetParamByName(const std::string& paramName)
+	ShaderPass::CBVariableSP ShaderPass::CSGetParamByName(ShaderPropertyID paramName)
 	{
 		return GetParamByName(paramName, ShaderType::COMPUTE_SHADER);
 	}
 
-	ShaderPass::CBVariableSP ShaderPass::GetParamByName(const std::string& paramName, ShaderType type)
+	ShaderPass::CBVariableSP ShaderPass::GetParamByName(ShaderPropertyID paramName, ShaderType type)
 	{
 		auto info = m_ShaderInfos[static_cast<int>(type)];
 		if (info != nullptr) {
@@ -495,18 +538,18 @@ namespace DSM {
 		assert(cmdList != nullptr);
 		assert(m_pRootSignature != nullptr);
 
-		// 设置资源
-		bool isCompute = m_ShaderInfos[static_cast<int>(ShaderType::COMPUTE_SHADER)] != nullptr;
-		if (isCompute) {
-			cmdList->SetPipelineState(m_pComputePSO.Get());
-			cmdList->SetComputeRootSignature(m_pRootSignature.Get());
-		}
-		else {
-			cmdList->SetPipelineState(m_pGraphicsPSO.Get());
-			cmdList->SetGraphicsRootSignature(m_pRootSignature.Get());
+		// 状态记录属于其他命令列表时重新开始记录
+		auto& cmdListState = frameResource->m_CommandListState;
+		if (cmdListState.GetCommandList() != cmdList) {
+			cmdListState.Reset(cmdList);
 		}
 
-		BindResources(cmdList, frameResource, isCompute);
+		// 设置资源，与命令列表上已有状态相同的设置会被跳过
+		bool isCompute = m_ShaderInfos[static_cast<int>(ShaderType::COMPUTE_SHADER)] != nullptr;
+		cmdListState.SetPipelineState(isCompute ? m_pComputePSO.Get() : m_pGraphicsPSO.Get());
+		cmdListState.SetRootSignature(m_pRootSignature.Get(), isCompute);
+
+		BindResources(cmdListState, frameResource, isCompute);
 
 		//for (int i = 0; i < m_SamplerStates.size(); ++i) {
 		//	auto handleSize = m_SamplerStates[i].m_Handle.size();
@@ -524,80 +567,120 @@ namespace DSM {
 
 	void ShaderPass::CreateRootSignature(ID3D12Device* device)
 	{
-		std::vector<D3D12_ROOT_PARAMETER> params{};
-
-		std::uint32_t index = 0;
-		auto paramSize = m_CBuffers.size() + m_ShaderResources.size() + m_RWResources.size();
-		params.resize(paramSize);
-		for (int i = 0; i < ParamType::NUMTYPES; ++i) {
-			m_RootParamIndexs[i].clear();
+		// 由反射信息得到每个绑定被哪些着色器阶段使用
+		RootSignatureLayoutOptions options{};
+		options.m_IsCompute = m_ShaderInfos[static_cast<int>(ShaderType::COMPUTE_SHADER)] != nullptr;
+		std::map<ShaderParameterKey, std::uint32_t> cbStageMasks;
+		std::map<ShaderParameterKey, std::uint32_t> srStageMasks;
+		std::map<ShaderParameterKey, std::uint32_t> rwStageMasks;
+		for (int i = 0; i < m_ShaderInfos.size(); ++i) {
+			const auto& shaderInfo = m_ShaderInfos[i];
+			if (shaderInfo == nullptr) continue;
+
+			options.m_StageMask |= 1u << i;
+			for (auto key : shaderInfo->m_CBufferKeys) cbStageMasks[key] |= 1u << i;
+			for (auto key : shaderInfo->m_ShaderResourceKeys) srStageMasks[key] |= 1u << i;
+			for (auto key : shaderInfo->m_RWResourceKeys) rwStageMasks[key] |= 1u << i;
 		}
 
+		std::vector<RootBindingDesc> bindings{};
+		m_RootBindings.clear();
 		for (const auto& [paramIndex, cb] : m_CBuffers) {
-			D3D12_ROOT_PARAMETER rootParameter{};
-			rootParameter.ParameterType = D3D12_ROOT_PARAMETER_TYPE_CBV;
-			rootParameter.ShaderVisibility = D3D12_SHADER_VISIBILITY_ALL;
-			rootParameter.Constants.ShaderRegister = cb.m_ParamIndex.m_BindPoint;
-			rootParameter.Constants.RegisterSpace = cb.m_ParamIndex.m_RegisterSpace;
-			params[index++] = std::move(rootParameter);
-			m_RootParamIndexs[ParamType::CONSTANTBUFFER].emplace_back(paramIndex);
+			bindings.push_back({ RootBindingType::CONSTANT_BUFFER,
+				cb->m_ParamIndex.m_BindPoint, cb->m_ParamIndex.m_RegisterSpace,
+				1, cb->m_Data.GetByteSize(), cbStageMasks[paramIndex] });
+			m_RootBindings.push_back({ RootBindingType::CONSTANT_BUFFER, paramIndex, cb });
+		}
+		// 着色器参数常量缓冲区只对所属的阶段可见，不同阶段的参数可以使用相同的寄存器
+		for (int i = 0; i < m_ShaderInfos.size(); ++i) {
+			const auto& shaderInfo = m_ShaderInfos[i];
+			if (shaderInfo == nullptr || shaderInfo->m_pParamData == nullptr) continue;
+
+			auto& paramData = *shaderInfo->m_pParamData;
+			bindings.push_back({ RootBindingType::CONSTANT_BUFFER,
+				paramData.m_ParamIndex.m_BindPoint, paramData.m_ParamIndex.m_RegisterSpace,
+				1, paramData.m_Data.GetByteSize(), 1u << i });
+			m_RootBindings.push_back({ RootBindingType::CONSTANT_BUFFER,
+				ShaderParameterIndex::GetKeyByIndex(paramData.m_ParamIndex), &paramData });
 		}
-		
-		// 由于根参数储存的是描述符范围的指针，因此需要额外储存下来，否则会使其变成悬空指针
-		std::vector<D3D12_DESCRIPTOR_RANGE> srvDescriptorRanges{};
-		srvDescriptorRanges.reserve(m_ShaderResources.size());
 		for (const auto& [paramIndex, sr] : m_ShaderResources) {
-			D3D12_ROOT_PARAMETER rootParameter{};
-			D3D12_DESCRIPTOR_RANGE texTable{};
-			texTable.NumDescriptors = sr.m_BindCount;
-			texTable.BaseShaderRegister = sr.m_ParamIndex.m_BindPoint;
-			texTable.RangeType = D3D12_DESCRIPTOR_RANGE_TYPE_SRV;
-			texTable.RegisterSpace = sr.m_ParamIndex.m_RegisterSpace;
-			texTable.OffsetInDescriptorsFromTableStart = D3D12_DESCRIPTOR_RANGE_OFFSET_APPEND;
-			auto& range = srvDescriptorRanges.emplace_back(std::move(texTable));
-
-			rootParameter.ParameterType = D3D12_ROOT_PARAMETER_TYPE_DESCRIPTOR_TABLE;
-			rootParameter.ShaderVisibility = D3D12_SHADER_VISIBILITY_ALL;
-			rootParameter.DescriptorTable.NumDescriptorRanges = 1;
-			rootParameter.DescriptorTable.pDescriptorRanges = &range;
-			params[index++] = std::move(rootParameter);
-			m_RootParamIndexs[ParamType::TEXTURE].emplace_back(paramIndex);
-		}
-
-		std::vector<D3D12_DESCRIPTOR_RANGE> uavDescriptorRanges{};
-		uavDescriptorRanges.reserve(m_RWResources.size());
+			bindings.push_back({ RootBindingType::SHADER_RESOURCE,
+				sr->m_ParamIndex.m_BindPoint, sr->m_ParamIndex.m_RegisterSpace,
+				sr->m_IsUnbounded ? UINT_MAX : sr->m_BindCount, 0, srStageMasks[paramIndex] });
+			m_RootBindings.push_back({ RootBindingType::SHADER_RESOURCE, paramIndex });
+		}
 		for (const auto& [paramIndex, rw] : m_RWResources) {
-			D3D12_ROOT_PARAMETER rootParameter{};
-			D3D12_DESCRIPTOR_RANGE texTable{};
-			texTable.NumDescriptors = rw.m_BindCount;
-			texTable.BaseShaderRegister = rw.m_ParamIndex.m_BindPoint;
-			texTable.RangeType = D3D12_DESCRIPTOR_RANGE_TYPE_UAV;
-			texTable.RegisterSpace = rw.m_ParamIndex.m_RegisterSpace;
-			texTable.OffsetInDescriptorsFromTableStart = D3D12_DESCRIPTOR_RANGE_OFFSET_APPEND;
-			auto& range = uavDescriptorRanges.emplace_back(std::move(texTable));
-
-			rootParameter.ParameterType = D3D12_ROOT_PARAMETER_TYPE_DESCRIPTOR_TABLE;
-			rootParameter.ShaderVisibility = D3D12_SHADER_VISIBILITY_ALL;
-			rootParameter.DescriptorTable.NumDescriptorRanges = 1;
-			rootParameter.DescriptorTable.pDescriptorRanges = &range;
-			params[index++] = std::move(rootParameter);
-			m_RootParamIndexs[ParamType::UAV].emplace_back(paramIndex);
+			bindings.push_back({ RootBindingType::RW_RESOURCE,
+				rw->m_ParamIndex.m_BindPoint, rw->m_ParamIndex.m_RegisterSpace,
+				rw->m_BindCount, 0, rwStageMasks[paramIndex] });
+			m_RootBindings.push_back({ RootBindingType::RW_RESOURCE, paramIndex });
+		}
+		m_RootLayout = BuildRootSignatureLayout(bindings, options);
+
+		// 由于根参数储存的是描述符范围的指针，因此需要额外储存下来，否则会使其变成悬空指针
+		std::vector<std::vector<D3D12_DESCRIPTOR_RANGE1>> descriptorRanges(m_RootLayout.m_Parameters.size());
+		std::vector<D3D12_ROOT_PARAMETER1> params(m_RootLayout.m_Parameters.size());
+		for (std::size_t i = 0; i < params.size(); ++i) {
+			const auto& paramLayout = m_RootLayout.m_Parameters[i];
+			auto& rootParameter = params[i];
+			rootParameter.ParameterType = paramLayout.m_ParameterType;
+			rootParameter.ShaderVisibility = paramLayout.m_Visibility;
+
+			switch (paramLayout.m_ParameterType) {
+			case D3D12_ROOT_PARAMETER_TYPE_32BIT_CONSTANTS: {
+				const auto& binding = bindings[paramLayout.m_Binding];
+				rootParameter.Constants.ShaderRegister = binding.m_BindPoint;
+				rootParameter.Constants.RegisterSpace = binding.m_RegisterSpace;
+				rootParameter.Constants.Num32BitValues = paramLayout.m_Num32BitValues;
+				break;
+			}
+			case D3D12_ROOT_PARAMETER_TYPE_CBV: {
+				const auto& binding = bindings[paramLayout.m_Binding];
+				rootParameter.Descriptor.ShaderRegister = binding.m_BindPoint;
+				rootParameter.Descriptor.RegisterSpace = binding.m_RegisterSpace;
+				rootParameter.Descriptor.Flags = paramLayout.m_DescriptorFlags;
+				break;
+			}
+			default: {
+				for (const auto& rangeLayout : paramLayout.m_Ranges) {
+					D3D12_DESCRIPTOR_RANGE1 range{};
+					range.RangeType = rangeLayout.m_RangeType;
+					range.NumDescriptors = rangeLayout.m_NumDescriptors;
+					range.BaseShaderRegister = rangeLayout.m_BaseShaderRegister;
+					range.RegisterSpace = rangeLayout.m_RegisterSpace;
+					range.Flags = rangeLayout.m_Flags;
+					range.OffsetInDescriptorsFromTableStart = D3D12_DESCRIPTOR_RANGE_OFFSET_APPEND;
+					descriptorRanges[i].push_back(range);
+				}
+				rootParameter.DescriptorTable.NumDescriptorRanges = (UINT)descriptorRanges[i].size();
+				rootParameter.DescriptorTable.pDescriptorRanges = descriptorRanges[i].data();
+				break;
+			}
+			}
 		}
 
 		auto staticSamplers = CreateStaticSamplers();
-		D3D12_ROOT_SIGNATURE_DESC signatureDesc{};
-		signatureDesc.Flags = D3D12_ROOT_SIGNATURE_FLAG_ALLOW_INPUT_ASSEMBLER_INPUT_LAYOUT;
-		signatureDesc.NumParameters = params.size();
-		signatureDesc.pParameters = params.data();
-		signatureDesc.NumStaticSamplers = (UINT)staticSamplers.size();
-		signatureDesc.pStaticSamplers = staticSamplers.data();
+		D3D12_VERSIONED_ROOT_SIGNATURE_DESC signatureDesc{};
+		signatureDesc.Version = D3D_ROOT_SIGNATURE_VERSION_1_1;
+		signatureDesc.Desc_1_1.Flags = m_RootLayout.m_Flags;
+		signatureDesc.Desc_1_1.NumParameters = (UINT)params.size();
+		signatureDesc.Desc_1_1.pParameters = params.data();
+		signatureDesc.Desc_1_1.NumStaticSamplers = (UINT)staticSamplers.size();
+		signatureDesc.Desc_1_1.pStaticSamplers = staticSamplers.data();
+
+		// 不支持 1.1 时去掉描述符的静态标志，退回 1.0
+		D3D12_FEATURE_DATA_ROOT_SIGNATURE featureData{};
+		featureData.HighestVersion = D3D_ROOT_SIGNATURE_VERSION_1_1;
+		if (FAILED(device->CheckFeatureSupport(D3D12_FEATURE_ROOT_SIGNATURE, &featureData, sizeof(featureData)))) {
+			featureData.HighestVersion = D3D_ROOT_SIGNATURE_VERSION_1_0;
+		}
 
 		ComPtr<ID3DBlob> errorBlob;
 		ComPtr<ID3DBlob> serializedBlob;
 
 		// 序列化根签名
-		auto hr = D3D12SerializeRootSignature(&signatureDesc,
-			D3D_ROOT_SIGNATURE_VERSION_1,
+		auto hr = D3DX12SerializeVersionedRootSignature(&signatureDesc,
+			featureData.HighestVersion,
 			serializedBlob.GetAddressOf(),
 			errorBlob.GetAddressOf());
 		if (errorBlob != nullptr) {
@@ -606,85 +689,60 @@ namespace DSM {
 		
 		ThrowIfFailed(hr);
 
-		// 创建根签名
-		ThrowIfFailed(device->CreateRootSignature(0,
+		// 创建根签名，布局相同的Pass共享同一个根签名
+		m_pRootSignature = ShaderHelper::GetPipelineStateCache().GetOrCreateRootSignature(device,
 			serializedBlob->GetBufferPointer(),
-			serializedBlob->GetBufferSize(),
-			IID_PPV_ARGS(m_pRootSignature.GetAddressOf())));
+			serializedBlob->GetBufferSize());
 	}
 
-	void ShaderPass::BindResources(ID3D12GraphicsCommandList* cmdList,
+	void ShaderPass::BindResources(D3D12CommandListState& cmdListState,
 		FrameResource* frameResource,
 		bool isComput)
 	{
-		std::uint32_t index = 0;
-		// 绑定常量缓冲区
-		for (auto& cbIndex : m_RootParamIndexs[ParamType::CONSTANTBUFFER]) {
-			auto& cb = m_CBuffers[cbIndex];
-			if (cb.m_Resource != nullptr) {
-				cb.UpdateBuffer();
-				if (isComput) {
-					cmdList->SetComputeRootConstantBufferView(index, cb.m_Resource->m_GPUVirtualAddress);
-				}
-				else {
-					cmdList->SetGraphicsRootConstantBufferView(index, cb.m_Resource->m_GPUVirtualAddress);
-				}
+		// 描述符表由帧资源复制，工作线程的帧资源使用环形堆中独占的分段
+		auto descriptorRing = frameResource->m_DescriptorRing;
+		ID3D12DescriptorHeap* descriptorHeaps[] = { descriptorRing->GetHeap() };
+		cmdListState.SetDescriptorHeaps(1, descriptorHeaps);
+
+		auto& tableHandles = frameResource->m_TableHandles;
+		for (std::uint32_t index = 0; index < m_RootLayout.m_Parameters.size(); ++index) {
+			const auto& param = m_RootLayout.m_Parameters[index];
+			switch (param.m_ParameterType) {
+			case D3D12_ROOT_PARAMETER_TYPE_32BIT_CONSTANTS: {
+				// 根常量直接写入命令列表，不需要分配常量缓冲区
+				auto& cb = *m_RootBindings[param.m_Binding].m_ConstantBuffer;
+				cmdListState.SetRoot32BitConstants(index, param.m_Num32BitValues, cb.m_Data.GetData(), isComput);
+				break;
 			}
-			index++;
-		}
-		// 绑定着色器参数中的常量缓冲区
-		for (auto& shaderInfo : m_ShaderInfos) {
-			if (shaderInfo != nullptr && shaderInfo->m_pParamData != nullptr) {
-				// 更新参数常量缓冲区
-				shaderInfo->m_pParamData->UpdateBuffer();
-				if (isComput) {
-					cmdList->SetComputeRootConstantBufferView(
-						shaderInfo->m_pParamData->m_ParamIndex.m_BindPoint,
-						shaderInfo->m_pParamData->m_Resource->m_GPUVirtualAddress);
+			case D3D12_ROOT_PARAMETER_TYPE_CBV: {
+				auto& cb = *m_RootBindings[param.m_Binding].m_ConstantBuffer;
+				auto gpuAddress = cb.GetGPUVirtualAddress(frameResource);
+				cmdListState.SetRootConstantBufferView(index, gpuAddress, isComput);
+				break;
+			}
+			default: {
+				D3D12DescriptorHandle gpuHandle{};
+				if (param.m_IsUnbounded) {
+					// 无界数组直接使用常驻区域，不需要复制描述符
+					gpuHandle = descriptorRing->GetStaticHandle();
 				}
 				else {
-					cmdList->SetGraphicsRootConstantBufferView(
-						shaderInfo->m_pParamData->m_ParamIndex.m_BindPoint,
-						shaderInfo->m_pParamData->m_Resource->m_GPUVirtualAddress);
+					// 表中的所有范围按顺序连续复制
+					tableHandles.clear();
+					for (const auto& range : param.m_Ranges) {
+						for (auto bindingIndex : range.m_Bindings) {
+							const auto& binding = m_RootBindings[bindingIndex];
+							const auto& handles = binding.m_Type == RootBindingType::SHADER_RESOURCE ?
+								m_ShaderResources.Find(binding.m_Key)->m_Handle : m_RWResources.Find(binding.m_Key)->m_Handle;
+							tableHandles.insert(tableHandles.end(), handles.begin(), handles.end());
+						}
+					}
+					gpuHandle = frameResource->AllocateDescriptorTable(
+						tableHandles.data(), static_cast<std::uint32_t>(tableHandles.size()));
 				}
+				cmdListState.SetRootDescriptorTable(index, gpuHandle, isComput);
+				break;
 			}
-		}
-
-		// 绑定着色器资源
-		auto& descriptorCache = frameResource->m_DescriptorCaches;
-		ID3D12DescriptorHeap* descriptorHeaps[] = { descriptorCache->GetHeap(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV) };
-		cmdList->SetDescriptorHeaps(1, descriptorHeaps);
-
-		for (auto& srIndex : m_RootParamIndexs[ParamType::TEXTURE]) {
-			auto& sr = m_ShaderResources[srIndex];
-			auto handleSize = sr.m_Handle.size();
-			std::vector<D3D12_CPU_DESCRIPTOR_HANDLE> cpuHandles(handleSize);
-			for (int i = 0; i < handleSize; ++i) {
-				assert(sr.m_Handle[i].IsValid());
-				cpuHandles[i] = sr.m_Handle[i];
-			}
-			auto gpuHandle = descriptorCache->AllocateAndCopy(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV, cpuHandles);
-			if (isComput) {
-				cmdList->SetComputeRootDescriptorTable(index++, gpuHandle);
-			}
-			else {
-				cmdList->SetGraphicsRootDescriptorTable(index++, gpuHandle);
-			}
-		}
-		for (auto& rwindex : m_RootParamIndexs[ParamType::UAV]) {
-			auto& rw = m_RWResources[rwindex];
-			auto handleSize = rw.m_Handle.size();
-			std::vector<D3D12_CPU_DESCRIPTOR_HANDLE> cpuHandles(handleSize);
-			for (int i = 0; i < handleSize; ++i) {
-				assert(rw.m_Handle[i].IsValid());
-				cpuHandles[i] = rw.m_Handle[i];
-			}
-			auto gpuHandle = descriptorCache->AllocateAndCopy(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV, cpuHandles);
-			if (isComput) {
-				cmdList->SetComputeRootDescriptorTable(index++, gpuHandle);
-			}
-			else {
-				cmdList->SetGraphicsRootDescriptorTable(index++, gpuHandle);
 			}
 		}
 	}
@@ -751,6 +809,163 @@ namespace DSM {
 
 
 #pragma region ShaderHelper
+	//
+	// Shader Reflection
+	//
+	ShaderConstantBufferData GetConstantBufferData(
+		ID3D12ShaderReflection* shaderReflection,
+		const D3D12_SHADER_INPUT_BIND_DESC& bindDesc)
+	{
+		ID3D12ShaderReflectionConstantBuffer* CBReflection = shaderReflection->GetConstantBufferByName(bindDesc.Name);
+		D3D12_SHADER_BUFFER_DESC CBDesc;
+		ThrowIfFailed(CBReflection->GetDesc(&CBDesc));
+
+		ShaderConstantBufferData ret{};
+		ret.m_Name = CBDesc.Name;
+		ret.m_BindPoint = bindDesc.BindPoint;
+		ret.m_RegisterSpace = bindDesc.Space;
+		ret.m_Size = CBDesc.Size;
+
+		if (CBDesc.Variables < 1) return ret;
+
+		ID3D12ShaderReflectionVariable* pSRVar = CBReflection->GetVariableByIndex(0);
+
+		D3D12_SHADER_TYPE_DESC typeDesc;
+		ID3D12ShaderReflectionType* reflectionType = pSRVar->GetType();
+		ThrowIfFailed(reflectionType->GetDesc(&typeDesc));
+		// 检测缓冲区的类型是否为结构体
+		bool isStruct = typeDesc.Class == D3D_SVC_STRUCT;
+
+		// 获取常量缓冲区中的所有变量
+		std::uint32_t numVar = isStruct ? typeDesc.Members : CBDesc.Variables;
+		ret.m_Variables.reserve(numVar);
+		for (std::uint32_t i = 0; i < numVar; i++) {
+			ShaderVariableData varData{};
+
+			// 处理两种语法导致反射的结果不同
+			if (isStruct) {
+				ID3D12ShaderReflectionType* memberType = reflectionType->GetMemberTypeByIndex(i);
+				D3D12_SHADER_TYPE_DESC memberTypeDesc;
+				ThrowIfFailed(memberType->GetDesc(&memberTypeDesc));
+
+				varData.m_Name = reflectionType->GetMemberTypeName(i);
+				varData.m_StartOffset = memberTypeDesc.Offset;
+			}
+			else {
+				D3D12_SHADER_VARIABLE_DESC varDesc;
+				pSRVar = CBReflection->GetVariableByIndex(i);
+				ThrowIfFailed(pSRVar->GetDesc(&varDesc));
+				varData.m_Name = varDesc.Name;
+				varData.m_Size = varDesc.Size;
+				varData.m_StartOffset = varDesc.StartOffset;
+				if (varDesc.DefaultValue != nullptr) { // 记录初始值
+					auto defaultValue = static_cast<const std::uint8_t*>(varDesc.DefaultValue);
+					varData.m_DefaultValue.assign(defaultValue, defaultValue + varDesc.Size);
+				}
+			}
+			ret.m_Variables.push_back(std::move(varData));
+		}
+		if (isStruct) {
+			// 结构体成员的大小为到下一个成员的距离，最后一个成员到缓冲区末尾
+			for (std::size_t i = 0; i < ret.m_Variables.size(); ++i) {
+				auto nextOffset = i + 1 < ret.m_Variables.size() ? ret.m_Variables[i + 1].m_StartOffset : CBDesc.Size;
+				ret.m_Variables[i].m_Size = nextOffset - ret.m_Variables[i].m_StartOffset;
+			}
+		}
+
+		return ret;
+	}
+
+	// 将反射接口中的信息提取为可缓存的数据
+	ShaderReflectionData GetReflectionData(ShaderType shaderType, ID3D12ShaderReflection* shaderReflection)
+	{
+		ComPtr<ID3D12ShaderReflection> pReflection = shaderReflection;
+
+		D3D12_SHADER_DESC shaderDesc{};
+		ThrowIfFailed(pReflection->GetDesc(&shaderDesc));
+
+		ShaderReflectionData ret{};
+		if (shaderType == ShaderType::COMPUTE_SHADER) {
+			pReflection->GetThreadGroupSize(
+				&ret.m_ThreadGroupSize[0],
+				&ret.m_ThreadGroupSize[1],
+				&ret.m_ThreadGroupSize[2]);
+		}
+
+		for (int i = 0; ; ++i) {
+			D3D12_SHADER_INPUT_BIND_DESC SIBDesc;
+			auto hr = pReflection->GetResourceBindingDesc(i, &SIBDesc);
+			if (FAILED(hr)) {
+				break;
+			}
+
+			// 读取常量缓冲区
+			if (SIBDesc.Type == D3D_SIT_CBUFFER) {
+				ret.m_ConstantBuffers.push_back(GetConstantBufferData(pReflection.Get(), SIBDesc));
+				continue;
+			}
+
+			ShaderBindingData bindData{};
+			if (SIBDesc.Type == D3D_SIT_TEXTURE ||
+				SIBDesc.Type == D3D_SIT_TBUFFER ||
+				SIBDesc.Type == D3D_SIT_BYTEADDRESS ||
+				SIBDesc.Type == D3D_SIT_STRUCTURED) {
+				bindData.m_Type = ShaderBindingType::SHADER_RESOURCE;
+			}
+			else if (SIBDesc.Type == D3D_SIT_UAV_RWTYPED ||
+				SIBDesc.Type == D3D_SIT_UAV_RWSTRUCTURED ||
+				SIBDesc.Type == D3D_SIT_UAV_RWSTRUCTURED_WITH_COUNTER ||
+				SIBDesc.Type == D3D_SIT_UAV_APPEND_STRUCTURED ||
+				SIBDesc.Type == D3D_SIT_UAV_CONSUME_STRUCTURED ||
+				SIBDesc.Type == D3D_SIT_UAV_RWBYTEADDRESS) {
+				bindData.m_Type = ShaderBindingType::RW_RESOURCE;
+			}
+			else if (SIBDesc.Type == D3D_SIT_SAMPLER) {
+				bindData.m_Type = ShaderBindingType::SAMPLER;
+			}
+			else {
+				continue;
+			}
+			bindData.m_Name = SIBDesc.Name;
+			bindData.m_BindPoint = SIBDesc.BindPoint;
+			bindData.m_RegisterSpace = SIBDesc.Space;
+			bindData.m_BindCount = SIBDesc.BindCount;
+			bindData.m_Dimension = static_cast<std::uint32_t>(SIBDesc.Dimension);
+			bindData.m_EnableCounter = SIBDesc.Type == D3D_SIT_UAV_RWSTRUCTURED_WITH_COUNTER;
+			ret.m_Bindings.push_back(std::move(bindData));
+		}
+
+		return ret;
+	}
+
+	// 使用 DXC 编译，失败时退回 D3DCompile
+	struct D3DShaderCompiler : IShaderCompiler
+	{
+		virtual ShaderCacheEntry Compile(const ShaderCompileDesc& compileDesc) override
+		{
+			ShaderDesc shaderDesc{};
+			shaderDesc.m_FileName = compileDesc.m_FileName;
+			shaderDesc.m_EnterPoint = compileDesc.m_EntryPoint;
+			shaderDesc.m_Target = compileDesc.m_Target;
+			shaderDesc.m_Type = compileDesc.m_Type;
+			for (const auto& [name, value] : compileDesc.m_Defines) {
+				shaderDesc.m_Defines.AddDefine(name, value);
+			}
+
+			ComPtr<ID3D12ShaderReflection> reflection;
+			ComPtr<ID3DBlob> byteCode = nullptr;
+			if (byteCode = ShaderHelper::DXCCreateShaderFromFile(shaderDesc, reflection.GetAddressOf()); byteCode == nullptr) {
+				byteCode = ShaderHelper::D3DCompileCreateShaderFromFile(shaderDesc, reflection.GetAddressOf());
+			}
+
+			ShaderCacheEntry ret{};
+			auto byteCodeData = static_cast<const std::uint8_t*>(byteCode->GetBufferPointer());
+			ret.m_ByteCode.assign(byteCodeData, byteCodeData + byteCode->GetBufferSize());
+			ret.m_Reflection = GetReflectionData(compileDesc.m_Type, reflection.Get());
+			return ret;
+		}
+	};
+
 	//
 	// ShaderHealper Implementation
 	//    
@@ -759,7 +974,11 @@ namespace DSM {
 	{
 		~Impl() = default;
 
-		void GetShaderInfo(std::string name, ShaderType shaderType, ID3D12ShaderReflection* shaderReflection);
+		// 由编译结果创建着色器信息并合并反射结果，需在主线程中按顺序调用
+		void AddShader(const ShaderDesc& shaderDesc, const ShaderCacheEntry& compileResult);
+		// 热重载时替换着色器的字节码，并重新生成使用它的 PSO，根签名与参数保持不变
+		void ReloadShader(const std::string& shaderInfoName, const ShaderCacheEntry& compileResult);
+		void GetShaderInfo(std::string name, ShaderType shaderType, const ShaderReflectionData& reflectionData);
 		void Clear();
 
 		// 存储编译后的 Shader代码
@@ -768,276 +987,276 @@ namespace DSM {
 		std::map<std::string, std::shared_ptr<ShaderInfo>> m_ShaderInfo;
 
 		std::map<std::string, std::shared_ptr<IShaderPass>> m_ShaderPass;
+		// 热重载时重新生成 PSO 使用的设备
+		ID3D12Device* m_Device = nullptr;
 
 		// 各种着色器资源，需要所有着色器的常量缓冲区没有冲突
-		std::unordered_map<std::string, std::shared_ptr<ConstantBufferVariable>> m_ConstantBufferVariables;
-		std::map<std::uint32_t, ConstantBuffer> m_ConstantBuffers;
-		std::map<std::uint32_t, ShaderResource> m_ShaderResources;
-		std::map<std::uint32_t, RWResource> m_RWResources;
-		std::map<std::uint32_t, SamplerState> m_SamplerStates;
+		std::unordered_map<ShaderPropertyID, std::shared_ptr<ConstantBufferVariable>> m_ConstantBufferVariables;
+		ConstantBufferTable m_ConstantBuffers;
+		ShaderResourceTable m_ShaderResources;
+		RWResourceTable m_RWResources;
+		SamplerStateTable m_SamplerStates;
+		// 名称到绑定键的索引，在反射时建立，按名称设置资源时不需要遍历比较字符串
+		std::unordered_map<ShaderPropertyID, ShaderParameterKey> m_ConstantBufferKeys;
+		std::unordered_map<ShaderPropertyID, ShaderParameterKey> m_ShaderResourceKeys;
+		std::unordered_map<ShaderPropertyID, ShaderParameterKey> m_RWResourceKeys;
+		std::unordered_map<ShaderPropertyID, ShaderParameterKey> m_SamplerStateKeys;
 
 	private:
+		static ComPtr<ID3DBlob> CreateByteCode(const std::vector<std::uint8_t>& byteCode);
+
 		void GetConstantBufferInfo(
-			ID3D12ShaderReflection* shaderReflection,
-			const D3D12_SHADER_INPUT_BIND_DESC& bindDes,
+			const ShaderConstantBufferData& cbData,
 			ShaderType shaderType,
 			const std::string& name);
 		void GetShaderResourceInfo(
-			const D3D12_SHADER_INPUT_BIND_DESC& bindDesc,
+			const ShaderBindingData& bindData,
 			ShaderType shaderType,
 			const std::string& name);
 		void GetRWResourceInfo(
-			const D3D12_SHADER_INPUT_BIND_DESC& bindDesc,
+			const ShaderBindingData& bindData,
 			ShaderType shaderType,
 			const std::string& name);
 		void GetSamplerStateInfo(
-			const D3D12_SHADER_INPUT_BIND_DESC& bindDesc,
+			const ShaderBindingData& bindData,
 			ShaderType shaderType,
 			const std::string& name);
 	};
 
-	void ShaderHelper::Impl::GetShaderInfo(std::string name, ShaderType shaderType, ID3D12ShaderReflection* shaderReflection)
+	void ShaderHelper::Impl::AddShader(const ShaderDesc& shaderDesc, const ShaderCacheEntry& compileResult)
 	{
-		auto infoName = std::to_string(static_cast<int>(shaderType)) + name;
-		
-		ComPtr<ID3D12ShaderReflection> pReflection = shaderReflection;
+		auto shaderInfoName = std::to_string(static_cast<int>(shaderDesc.m_Type)) + shaderDesc.m_ShaderName;
 
-		D3D12_SHADER_DESC shaderDesc{};
-		ThrowIfFailed(pReflection->GetDesc(&shaderDesc));
+		std::shared_ptr<ShaderInfo> shaderInfo;
+		switch (shaderDesc.m_Type) {
+		case ShaderType::PIXEL_SHADER: {
+			shaderInfo = std::make_shared<PixelShaderInfo>(); break;
+		}
+		case ShaderType::COMPUTE_SHADER: {
+			shaderInfo = std::make_shared<ComputeShaderInfo>(); break;
+		}
+		default: {
+			shaderInfo = std::make_shared<ShaderInfo>(); break;
+		}
+		}
+		m_ShaderInfo[shaderInfoName] = shaderInfo;
+		m_ShaderInfo[shaderInfoName]->m_Name = shaderDesc.m_ShaderName;
 
-		if (shaderType == ShaderType::COMPUTE_SHADER) {
-			auto SInfo = m_ShaderInfo[infoName];
-			auto CSInfo = std::dynamic_pointer_cast<ComputeShaderInfo>(SInfo);
-			pReflection->GetThreadGroupSize(
-				&CSInfo->m_ThreadGroupSizeX,
-				&CSInfo->m_ThreadGroupSizeY,
-				&CSInfo->m_ThreadGroupSizeZ);
+		auto byteCode = CreateByteCode(compileResult.m_ByteCode);
+		if (!shaderDesc.m_OutputFileName.empty()) {
+			ThrowIfFailed(D3DWriteBlobToFile(byteCode.Get(), AnsiToWString(shaderDesc.m_OutputFileName).c_str(), TRUE));
 		}
 
+		GetShaderInfo(shaderDesc.m_ShaderName, shaderDesc.m_Type, compileResult.m_Reflection);
 
-		for (int i = 0; ; ++i) {
-			D3D12_SHADER_INPUT_BIND_DESC SIBDesc;
-			auto hr = pReflection->GetResourceBindingDesc(i, &SIBDesc);
-			if (FAILED(hr)) {
-				break;
-			}
+		m_ShaderInfo[shaderInfoName]->m_pShader = byteCode;
 
-			// 读取常量缓冲区
-			if (SIBDesc.Type == D3D_SIT_CBUFFER) {
-				GetConstantBufferInfo(pReflection.Get(), SIBDesc, shaderType, name);
-			}
-			else if (SIBDesc.Type == D3D_SIT_TEXTURE ||
-				SIBDesc.Type == D3D_SIT_TBUFFER ||
-				SIBDesc.Type == D3D_SIT_BYTEADDRESS ||
-				SIBDesc.Type == D3D_SIT_STRUCTURED) {
-				GetShaderResourceInfo(SIBDesc, shaderType, name);
-			}
-			else if (SIBDesc.Type == D3D_SIT_UAV_RWTYPED ||
-				SIBDesc.Type == D3D_SIT_UAV_RWSTRUCTURED ||
-				SIBDesc.Type == D3D_SIT_UAV_RWSTRUCTURED_WITH_COUNTER ||
-				SIBDesc.Type == D3D_SIT_UAV_APPEND_STRUCTURED ||
-				SIBDesc.Type == D3D_SIT_UAV_CONSUME_STRUCTURED ||
-				SIBDesc.Type == D3D_SIT_UAV_RWBYTEADDRESS) {
-				GetRWResourceInfo(SIBDesc, shaderType, name);
+		m_ShaderPassByteCode[shaderDesc.m_FileName] = byteCode;
+
+		ShaderHelper::GetHotReload().Track(this, shaderInfoName, ShaderHelper::GetCompileDesc(shaderDesc), compileResult.m_Reflection,
+			[this, shaderInfoName](const ShaderCacheEntry& reloadResult) {
+				ReloadShader(shaderInfoName, reloadResult);
+			});
+	}
+
+	void ShaderHelper::Impl::ReloadShader(const std::string& shaderInfoName, const ShaderCacheEntry& compileResult)
+	{
+		auto it = m_ShaderInfo.find(shaderInfoName);
+		if (it == m_ShaderInfo.end()) return;
+
+		auto shaderInfo = it->second;
+		shaderInfo->m_pShader = CreateByteCode(compileResult.m_ByteCode);
+
+		// 旧的 PSO 仍由 PSO 缓存持有，GPU 上未完成的帧可以继续使用
+		for (auto& [passName, pass] : m_ShaderPass) {
+			auto shaderPass = std::static_pointer_cast<ShaderPass>(pass);
+			const auto& infos = shaderPass->m_ShaderInfos;
+			if (std::find(infos.begin(), infos.end(), shaderInfo) == infos.end()) continue;
+
+			// 尚未生成 PSO 的 Pass 在 CreatePipelineState 时自然使用新的字节码
+			auto hasPSO = shaderPass->m_pGraphicsPSO != nullptr || shaderPass->m_pComputePSO != nullptr;
+			shaderPass->m_pGraphicsPSO = nullptr;
+			shaderPass->m_pComputePSO = nullptr;
+			if (hasPSO && m_Device != nullptr) {
+				shaderPass->CreatePipelineState(m_Device);
 			}
-			else if (SIBDesc.Type == D3D_SIT_SAMPLER) {
-				GetSamplerStateInfo(SIBDesc, shaderType, name);
+		}
+	}
+
+	ComPtr<ID3DBlob> ShaderHelper::Impl::CreateByteCode(const std::vector<std::uint8_t>& byteCode)
+	{
+		ComPtr<ID3DBlob> blob = nullptr;
+		ThrowIfFailed(D3DCreateBlob(byteCode.size(), blob.GetAddressOf()));
+		memcpy(blob->GetBufferPointer(), byteCode.data(), byteCode.size());
+		return blob;
+	}
+
+	void ShaderHelper::Impl::GetShaderInfo(std::string name, ShaderType shaderType, const ShaderReflectionData& reflectionData)
+	{
+		auto infoName = std::to_string(static_cast<int>(shaderType)) + name;
+
+		if (shaderType == ShaderType::COMPUTE_SHADER) {
+			auto SInfo = m_ShaderInfo[infoName];
+			auto CSInfo = std::dynamic_pointer_cast<ComputeShaderInfo>(SInfo);
+			CSInfo->m_ThreadGroupSizeX = reflectionData.m_ThreadGroupSize[0];
+			CSInfo->m_ThreadGroupSizeY = reflectionData.m_ThreadGroupSize[1];
+			CSInfo->m_ThreadGroupSizeZ = reflectionData.m_ThreadGroupSize[2];
+		}
+
+		for (const auto& cbData : reflectionData.m_ConstantBuffers) {
+			GetConstantBufferInfo(cbData, shaderType, name);
+		}
+		for (const auto& bindData : reflectionData.m_Bindings) {
+			switch (bindData.m_Type) {
+			case ShaderBindingType::SHADER_RESOURCE: GetShaderResourceInfo(bindData, shaderType, name); break;
+			case ShaderBindingType::RW_RESOURCE: GetRWResourceInfo(bindData, shaderType, name); break;
+			case ShaderBindingType::SAMPLER: GetSamplerStateInfo(bindData, shaderType, name); break;
 			}
 		}
 	}
 
 	void ShaderHelper::Impl::Clear()
 	{
-		m_ConstantBuffers.clear();
+		m_ConstantBuffers.Clear();
 		m_ConstantBufferVariables.clear();
-		m_ShaderResources.clear();
+		m_ShaderResources.Clear();
 		m_ShaderInfo.clear();
 		m_ShaderPassByteCode.clear();
-		m_SamplerStates.clear();
-		m_RWResources.clear();
+		m_SamplerStates.Clear();
+		m_RWResources.Clear();
+		m_ConstantBufferKeys.clear();
+		m_ShaderResourceKeys.clear();
+		m_RWResourceKeys.clear();
+		m_SamplerStateKeys.clear();
 	}
 
 	void ShaderHelper::Impl::GetConstantBufferInfo(
-		ID3D12ShaderReflection* shaderReflection,
-		const D3D12_SHADER_INPUT_BIND_DESC& bindDesc,
+		const ShaderConstantBufferData& cbData,
 		ShaderType shaderType,
 		const std::string& name)
 	{
-		ID3D12ShaderReflectionConstantBuffer* CBReflection = shaderReflection->GetConstantBufferByName(bindDesc.Name);
-		D3D12_SHADER_BUFFER_DESC CBDesc;
-		ThrowIfFailed(CBReflection->GetDesc(&CBDesc));
-
 		auto infoName = std::to_string(static_cast<int>(shaderType)) + name;
 		auto& shaderInfo = m_ShaderInfo;
 
 		ConstantBuffer constantBuffer{};
-		constantBuffer.m_Data.resize(CBDesc.Size);
-		constantBuffer.m_Name = CBDesc.Name;
-		constantBuffer.m_ParamIndex.m_BindPoint = bindDesc.BindPoint;
-		constantBuffer.m_ParamIndex.m_RegisterSpace = bindDesc.Space;
-		bool noParams = strcmp(bindDesc.Name, "$Params") != 0;
+		constantBuffer.m_Data = ConstantBufferData(cbData.m_Size);
+		constantBuffer.m_Name = cbData.m_Name;
+		constantBuffer.m_ParamIndex.m_BindPoint = cbData.m_BindPoint;
+		constantBuffer.m_ParamIndex.m_RegisterSpace = cbData.m_RegisterSpace;
+		bool noParams = cbData.m_Name != "$Params";
 
 		auto cbKey = ShaderParameterIndex::GetKeyByIndex(constantBuffer.m_ParamIndex);
 
 		// 判断该常量缓冲区是否是参数常量缓冲区
 		if (noParams) {
 			// 不是参数CB,则在PassHelper中创建
-			if (auto it = m_ConstantBuffers.find(cbKey);
-				it == m_ConstantBuffers.end() || it->second.m_Data.size() < CBDesc.Size) {
+			if (auto cb = m_ConstantBuffers.Find(cbKey); cb == nullptr || cb->m_Data.GetByteSize() < cbData.m_Size) {
 				// 不存在则新建
 				m_ConstantBuffers[cbKey] = std::move(constantBuffer);
 			}
+			m_ConstantBufferKeys.try_emplace(ShaderPropertyID::Register(cbData.m_Name), cbKey);
+			shaderInfo[infoName]->m_CBufferKeys.push_back(cbKey);
 		}
-		else if (CBDesc.Variables > 0) {
+		else if (!cbData.m_Variables.empty()) {
 			// 若是参数CB为其创建一个常量缓冲区
 			shaderInfo[infoName]->m_pParamData = std::make_unique<ConstantBuffer>(std::move(constantBuffer));
 		}
 
-		if (CBDesc.Variables < 1)return;
-
-		ID3D12ShaderReflectionVariable* pSRVar = CBReflection->GetVariableByIndex(0);
-
-		D3D12_SHADER_TYPE_DESC typeDesc;
-		ID3D12ShaderReflectionType* reflectionType = pSRVar->GetType();
-		ThrowIfFailed(reflectionType->GetDesc(&typeDesc));
-		// 检测缓冲区的类型是否为结构体
-		bool isStruct = typeDesc.Class == D3D_SVC_STRUCT;
-
-		// 获取常量缓冲区中的所有变量
-		std::uint32_t preOffset = 0;
-		std::uint32_t numVar = isStruct ? typeDesc.Members : CBDesc.Variables;
-		// 用来记录各个变量的大小
-		std::queue<std::pair<std::string, std::uint32_t>> sizeQueue;
-		for (std::uint32_t i = 0; i < numVar; i++) {
-			// 获取变量信息
-			D3D12_SHADER_VARIABLE_DESC varDesc;
-
-			std::uint32_t varSize = 0;
-			std::uint32_t varOffset = 0;
-			std::string varName{};
-
-			// 处理两种语法导致反射的结果不同
-			if (isStruct) {
-				ID3D12ShaderReflectionType* memberType = reflectionType->GetMemberTypeByIndex(i);
-				auto memberName = reflectionType->GetMemberTypeName(i);
-				D3D12_SHADER_TYPE_DESC memberTypeDesc;
-				ThrowIfFailed(memberType->GetDesc(&memberTypeDesc));
-
-				varName = memberName;
-				varSize = 0;
-				varOffset = memberTypeDesc.Offset;
-				// 当前变量的名字和前一个变量的大小
-				sizeQueue.push({ varName, varOffset - preOffset });
-				preOffset = varOffset;
-			}
-			else {
-				pSRVar = CBReflection->GetVariableByIndex(i);
-				ThrowIfFailed(pSRVar->GetDesc(&varDesc));
-				varName = varDesc.Name;
-				varSize = varDesc.Size;
-				varOffset = varDesc.StartOffset;
-			}
-
-			// 创建常量缓冲区成员变量
+		// 创建常量缓冲区成员变量
+		for (const auto& varData : cbData.m_Variables) {
 			auto CBVariable = std::make_shared<ConstantBufferVariable>();
-			CBVariable->m_Name = varName;
-			CBVariable->m_ByteSize = varSize;
-			CBVariable->m_StartOffset = varOffset;
+			CBVariable->m_Name = varData.m_Name;
+			CBVariable->m_ByteSize = varData.m_Size;
+			CBVariable->m_StartOffset = varData.m_StartOffset;
 			if (noParams) {
 				CBVariable->m_ConstantBuffer = &m_ConstantBuffers[cbKey];
-				m_ConstantBufferVariables[CBVariable->m_Name] = CBVariable;
-				if (!isStruct && varDesc.DefaultValue != nullptr) { // 设置初始值
-					m_ConstantBufferVariables[CBVariable->m_Name]->SetRow(varDesc.Size, varDesc.DefaultValue);
+				m_ConstantBufferVariables[ShaderPropertyID::Register(CBVariable->m_Name)] = CBVariable;
+				if (!varData.m_DefaultValue.empty()) { // 设置初始值
+					CBVariable->SetRow(static_cast<std::uint32_t>(varData.m_DefaultValue.size()), varData.m_DefaultValue.data());
 				}
 			}
 			else {
 				// 若是着色器参数则独属于该着色器                
 				CBVariable->m_ConstantBuffer = shaderInfo[infoName]->m_pParamData.get();
-				shaderInfo[infoName]->m_ConstantBufferVariable[CBVariable->m_Name] = CBVariable;
+				shaderInfo[infoName]->m_ConstantBufferVariable[ShaderPropertyID::Register(CBVariable->m_Name)] = CBVariable;
 			}
 		}
-		if (isStruct) {
-			// 设置各个变量的大小
-			auto prePair = sizeQueue.front();
-			std::string lastName = sizeQueue.back().first;
-			sizeQueue.pop();
-			for (; !sizeQueue.empty(); sizeQueue.pop()) {
-				auto varPair = sizeQueue.front();
-				m_ConstantBufferVariables[prePair.first]->m_ByteSize = varPair.second;
-				prePair = varPair;
-			}
-			// 设置最后一个变量的大小
-			m_ConstantBufferVariables[lastName]->m_ByteSize = CBDesc.Size - preOffset;
-		}
 	}
 
 	void ShaderHelper::Impl::GetShaderResourceInfo(
-		const D3D12_SHADER_INPUT_BIND_DESC& bindDesc,
+		const ShaderBindingData& bindData,
 		ShaderType shaderType,
 		const std::string& name)
 	{
 		auto infoName = std::to_string(static_cast<int>(shaderType)) + name;
 
-		ShaderParameterIndex cbIndex{ bindDesc.BindPoint, bindDesc.Space };
-		auto cbKey = ShaderParameterIndex::GetKeyByIndex({ bindDesc.BindPoint, bindDesc.Space });
+		ShaderParameterIndex cbIndex{ bindData.m_BindPoint, bindData.m_RegisterSpace };
+		auto cbKey = ShaderParameterIndex::GetKeyByIndex(cbIndex);
 
-		if (auto it = m_ShaderResources.find(cbKey); it == m_ShaderResources.end()) {
+		if (!m_ShaderResources.Contains(cbKey)) {
 			ShaderResource shaderResource{};
-			shaderResource.m_Name = bindDesc.Name;
+			shaderResource.m_Name = bindData.m_Name;
 			shaderResource.m_ParamIndex = cbIndex;
-			shaderResource.m_Dimension = static_cast<D3D12_SRV_DIMENSION>(bindDesc.Dimension);
-			shaderResource.m_BindCount = bindDesc.BindCount;
+			shaderResource.m_Dimension = static_cast<D3D12_SRV_DIMENSION>(bindData.m_Dimension);
+			shaderResource.m_BindCount = bindData.m_BindCount;
+			// 反射中无界数组的数量为 0
+			shaderResource.m_IsUnbounded = bindData.m_BindCount == 0 || bindData.m_BindCount == UINT_MAX;
 			m_ShaderResources[cbKey] = std::move(shaderResource);
+			m_ShaderResourceKeys.try_emplace(ShaderPropertyID::Register(bindData.m_Name), cbKey);
 		}
+		m_ShaderInfo[infoName]->m_ShaderResourceKeys.push_back(cbKey);
 	}
 
 	void ShaderHelper::Impl::GetRWResourceInfo(
-		const D3D12_SHADER_INPUT_BIND_DESC& bindDesc,
+		const ShaderBindingData& bindData,
 		ShaderType shaderType,
 		const std::string& name)
 	{
 		auto infoName = std::to_string(static_cast<int>(shaderType)) + name;
 
-		ShaderParameterIndex cbIndex{ bindDesc.BindPoint, bindDesc.Space };
+		ShaderParameterIndex cbIndex{ bindData.m_BindPoint, bindData.m_RegisterSpace };
 		auto cbKey = ShaderParameterIndex::GetKeyByIndex(cbIndex);
 
-		if (auto it = m_RWResources.find(cbKey); it == m_RWResources.end()) {
+		if (!m_RWResources.Contains(cbKey)) {
 			RWResource rwResource{};
-			rwResource.m_Name = bindDesc.Name;
+			rwResource.m_Name = bindData.m_Name;
 			rwResource.m_ParamIndex = cbIndex;
-			rwResource.m_Dimension = static_cast<D3D12_UAV_DIMENSION>(bindDesc.Dimension);
+			rwResource.m_Dimension = static_cast<D3D12_UAV_DIMENSION>(bindData.m_Dimension);
 			rwResource.m_FirstInit = false;
-			rwResource.m_EnableCounter = bindDesc.Type == D3D_SIT_UAV_RWSTRUCTURED_WITH_COUNTER;
+			rwResource.m_EnableCounter = bindData.m_EnableCounter;
 			rwResource.m_InitialCount = 0;
-			rwResource.m_BindCount = bindDesc.BindCount;
+			rwResource.m_BindCount = bindData.m_BindCount;
 			m_RWResources[cbKey] = std::move(rwResource);
+			m_RWResourceKeys.try_emplace(ShaderPropertyID::Register(bindData.m_Name), cbKey);
 		}
+		m_ShaderInfo[infoName]->m_RWResourceKeys.push_back(cbKey);
 
 		if (shaderType == ShaderType::PIXEL_SHADER) {
 			auto shaderInfo = std::dynamic_pointer_cast<PixelShaderInfo>(m_ShaderInfo[infoName]);
-			shaderInfo->m_RwUseMask |= (1 << bindDesc.BindPoint);
+			shaderInfo->m_RwUseMask |= (1 << bindData.m_BindPoint);
 		}
 		else if (shaderType == ShaderType::COMPUTE_SHADER) {
 			auto shaderInfo = std::dynamic_pointer_cast<ComputeShaderInfo>(m_ShaderInfo[infoName]);
-			shaderInfo->m_RwUseMask |= (1 << bindDesc.BindPoint);
+			shaderInfo->m_RwUseMask |= (1 << bindData.m_BindPoint);
 		}
 	}
 
 	void ShaderHelper::Impl::GetSamplerStateInfo(
-		const D3D12_SHADER_INPUT_BIND_DESC& bindDesc,
+		const ShaderBindingData& bindData,
 		ShaderType shaderType,
 		const std::string& name)
 	{
 		auto infoName = std::to_string(static_cast<int>(shaderType)) + name;
 
-		ShaderParameterIndex cbIndex{ bindDesc.BindPoint, bindDesc.Space };
+		ShaderParameterIndex cbIndex{ bindData.m_BindPoint, bindData.m_RegisterSpace };
 		auto cbKey = ShaderParameterIndex::GetKeyByIndex(cbIndex);
 
-		if (auto it = m_ShaderResources.find(cbKey); it == m_ShaderResources.end()) {
+		if (!m_ShaderResources.Contains(cbKey)) {
 			SamplerState samplerState{};
-			samplerState.m_Name = bindDesc.Name;
+			samplerState.m_Name = bindData.m_Name;
 			samplerState.m_ParamIndex = cbIndex;
 			m_SamplerStates[cbKey] = std::move(samplerState);
+			m_SamplerStateKeys.try_emplace(ShaderPropertyID::Register(bindData.m_Name), cbKey);
 		}
 	}
 #pragma endregion 
@@ -1050,87 +1269,66 @@ namespace DSM {
 
 	ShaderHelper::~ShaderHelper()
 	{
+		GetHotReload().Untrack(m_Impl.get());
 	}
 
-	void ShaderHelper::SetConstantBufferByName(const std::string& name, std::shared_ptr<D3D12ResourceLocation> cb)
+	void ShaderHelper::SetConstantBufferByName(ShaderPropertyID name, std::shared_ptr<D3D12ResourceLocation> cb)
 	{
-		auto findByName = [&name](const auto& parame) {
-			return parame.second.m_Name == name;
-			};
-		auto it = std::find_if(m_Impl->m_ConstantBuffers.begin(), m_Impl->m_ConstantBuffers.end(), findByName);
-		if (it != m_Impl->m_ConstantBuffers.end()) {
-			it->second.m_IsDrty = true;
-			it->second.m_Resource = cb;
+		if (auto it = m_Impl->m_ConstantBufferKeys.find(name); it != m_Impl->m_ConstantBufferKeys.end()) {
+			m_Impl->m_ConstantBuffers.Find(it->second)->m_Resource = cb;
 		}
 	}
 
 	void ShaderHelper::SetConstantBufferBySlot(const ShaderParameterIndex& index, std::shared_ptr<D3D12ResourceLocation> cb)
 	{
-		if (auto it = m_Impl->m_ConstantBuffers.find(ShaderParameterIndex::GetKeyByIndex(index)); 
-			it != m_Impl->m_ConstantBuffers.end()) {
-			it->second.m_IsDrty = true;
-			it->second.m_Resource = cb;
+		if (auto param = m_Impl->m_ConstantBuffers.Find(ShaderParameterIndex::GetKeyByIndex(index)); param != nullptr) {
+			param->m_Resource = cb;
 		}
 	}
 
-	void ShaderHelper::SetShaderResourceByName(const std::string& name, const std::vector<D3D12DescriptorHandle>& resource)
+	void ShaderHelper::SetShaderResourceByName(ShaderPropertyID name, const std::vector<D3D12DescriptorHandle>& resource)
 	{
-		auto findByName = [&name](const auto& parame) {
-			return parame.second.m_Name == name;
-			};
-		auto it = std::find_if(m_Impl->m_ShaderResources.begin(), m_Impl->m_ShaderResources.end(), findByName);
-		if (it != m_Impl->m_ShaderResources.end()) {
-			it->second.m_Handle = resource;
+		if (auto it = m_Impl->m_ShaderResourceKeys.find(name); it != m_Impl->m_ShaderResourceKeys.end()) {
+			m_Impl->m_ShaderResources.Find(it->second)->m_Handle = resource;
 		}
 	}
 
 	void ShaderHelper::SetShaderResourceBySlot(const ShaderParameterIndex& index, const std::vector<D3D12DescriptorHandle>& resource)
 	{
-		if (auto it = m_Impl->m_ShaderResources.find(ShaderParameterIndex::GetKeyByIndex(index)); 
-			it != m_Impl->m_ShaderResources.end()) {
-			it->second.m_Handle = resource;
+		if (auto param = m_Impl->m_ShaderResources.Find(ShaderParameterIndex::GetKeyByIndex(index)); param != nullptr) {
+			param->m_Handle = resource;
 		}
 	}
 
-	void ShaderHelper::SetRWResourceByName(const std::string& name, const std::vector<D3D12DescriptorHandle>& resource)
+	void ShaderHelper::SetRWResourceByName(ShaderPropertyID name, const std::vector<D3D12DescriptorHandle>& resource)
 	{
-		auto findByName = [&name](const auto& parame) {
-			return parame.second.m_Name == name;
-			};
-		auto it = std::find_if(m_Impl->m_RWResources.begin(), m_Impl->m_RWResources.end(), findByName);
-		if (it != m_Impl->m_RWResources.end()) {
-			it->second.m_Handle = resource;
+		if (auto it = m_Impl->m_RWResourceKeys.find(name); it != m_Impl->m_RWResourceKeys.end()) {
+			m_Impl->m_RWResources.Find(it->second)->m_Handle = resource;
 		}
 	}
 
 	void ShaderHelper::SetRWResrouceBySlot(const ShaderParameterIndex& index, const std::vector<D3D12DescriptorHandle>& resource)
 	{
-		if (auto it = m_Impl->m_RWResources.find(ShaderParameterIndex::GetKeyByIndex(index)); 
-			it != m_Impl->m_RWResources.end()) {
-			it->second.m_Handle = resource;
+		if (auto param = m_Impl->m_RWResources.Find(ShaderParameterIndex::GetKeyByIndex(index)); param != nullptr) {
+			param->m_Handle = resource;
 		}
 	}
 
-	void ShaderHelper::SetSampleStateByName(const std::string& name, const std::vector<D3D12DescriptorHandle>& sampleState)
+	void ShaderHelper::SetSampleStateByName(ShaderPropertyID name, const std::vector<D3D12DescriptorHandle>& sampleState)
 	{
-		auto findByName = [&name](const auto& parame) {
-			return parame.second.m_Name == name;
-			};
-		auto it = std::find_if(m_Impl->m_SamplerStates.begin(), m_Impl->m_SamplerStates.end(), findByName);
-		if (it != m_Impl->m_SamplerStates.end()) {
-			it->second.m_Handle = sampleState;
+		if (auto it = m_Impl->m_SamplerStateKeys.find(name); it != m_Impl->m_SamplerStateKeys.end()) {
+			m_Impl->m_SamplerStates.Find(it->second)->m_Handle = sampleState;
 		}
 	}
 
 	void ShaderHelper::SetSampleStateBySlot(const ShaderParameterIndex& index, const std::vector<D3D12DescriptorHandle>& sampleState)
 	{
-		if (auto it = m_Impl->m_SamplerStates.find(ShaderParameterIndex::GetKeyByIndex(index)); 
-			it != m_Impl->m_SamplerStates.end()) {
-			it->second.m_Handle = sampleState;
+		if (auto param = m_Impl->m_SamplerStates.Find(ShaderParameterIndex::GetKeyByIndex(index)); param != nullptr) {
+			param->m_Handle = sampleState;
 		}
 	}
 
-	ShaderPass::CBVariableSP ShaderHelper::GetConstantBufferVariable(const std::string& name)
+	ShaderPass::CBVariableSP ShaderHelper::GetConstantBufferVariable(ShaderPropertyID name)
 	{
 		auto it = m_Impl->m_ConstantBufferVariables.find(name);
 		return it == m_Impl->m_ConstantBufferVariables.end() ? nullptr : it->second;
@@ -1142,6 +1340,7 @@ namespace DSM {
 		ID3D12Device* device)
 	{
 		assert(!shaderPassName.empty());
+		m_Impl->m_Device = device;
 
 		auto it = m_Impl->m_ShaderPass.find(shaderPassName);
 		// 防止重复添加
@@ -1181,39 +1380,84 @@ namespace DSM {
 
 	void ShaderHelper::CreateShaderFormFile(const ShaderDesc& shaderDesc)
 	{
-		auto shaderInfoName = std::to_string(static_cast<int>(shaderDesc.m_Type)) + shaderDesc.m_ShaderName;
+		m_Impl->AddShader(shaderDesc, GetShaderCompiler().Compile(GetCompileDesc(shaderDesc)));
+	}
 
-		std::shared_ptr<ShaderInfo> shaderInfo;
-		switch (shaderDesc.m_Type) {
-		case ShaderType::PIXEL_SHADER: {
-			shaderInfo = std::make_shared<PixelShaderInfo>(); break;
-		}
-		case ShaderType::COMPUTE_SHADER: {
-			shaderInfo = std::make_shared<ComputeShaderInfo>(); break;
-		}
-		default: {
-			shaderInfo = std::make_shared<ShaderInfo>(); break;
-		}
+	void ShaderHelper::CreateShadersFromFile(const std::vector<ShaderDesc>& shaderDescs)
+	{
+		auto results = SubmitShaders(shaderDescs);
+		// 编译的完成顺序不确定，按提交顺序合并保证结果与串行编译一致
+		for (std::size_t i = 0; i < shaderDescs.size(); ++i) {
+			m_Impl->AddShader(shaderDescs[i], results[i].get());
 		}
-		m_Impl->m_ShaderInfo[shaderInfoName] = shaderInfo;
-		m_Impl->m_ShaderInfo[shaderInfoName]->m_Name = shaderDesc.m_ShaderName;
+	}
 
-		ComPtr<ID3D12ShaderReflection> reflection;
-		ComPtr<ID3DBlob> byteCode = nullptr;
-		if (byteCode = DXCCreateShaderFromFile(shaderDesc, reflection.GetAddressOf()); byteCode == nullptr) {
-			byteCode = D3DCompileCreateShaderFromFile(shaderDesc, reflection.GetAddressOf());
-		}
+	void ShaderHelper::AddShader(const ShaderDesc& shaderDesc, const ShaderCacheEntry& compileResult)
+	{
+		m_Impl->AddShader(shaderDesc, compileResult);
+	}
+
+	void ShaderHelper::Clear()
+	{
+		GetHotReload().Untrack(m_Impl.get());
+		m_Impl->Clear();
+	}
+
+	ShaderCache& ShaderHelper::GetShaderCache()
+	{
+		// 调试与发布版本的编译选项不同，需要区分缓存
+#if defined(DEBUG) || defined(_DEBUG) 
+		static ShaderCache shaderCache{ "ShaderCache", "Debug" };
+#else
+		static ShaderCache shaderCache{ "ShaderCache", "Release" };
+#endif
+		return shaderCache;
+	}
+
+	D3D12PipelineStateCache& ShaderHelper::GetPipelineStateCache()
+	{
+		static D3D12PipelineStateCache pipelineStateCache{ "ShaderCache/PSO" };
+		return pipelineStateCache;
+	}
+
+	ShaderHotReload& ShaderHelper::GetHotReload()
+	{
+		static ShaderHotReload hotReload{ GetCompileQueue() };
+		return hotReload;
+	}
 
-		m_Impl->GetShaderInfo(shaderDesc.m_ShaderName, shaderDesc.m_Type, reflection.Get());
+	IShaderCompiler& ShaderHelper::GetShaderCompiler()
+	{
+		static D3DShaderCompiler d3dCompiler;
+		static CachedShaderCompiler cachedCompiler{ GetShaderCache(), d3dCompiler };
+		return cachedCompiler;
+	}
 
-		m_Impl->m_ShaderInfo[shaderInfoName]->m_pShader = byteCode;
+	ShaderCompileQueue& ShaderHelper::GetCompileQueue()
+	{
+		static ShaderCompileQueue compileQueue{ &GetShaderCompiler() };
+		return compileQueue;
+	}
 
-		m_Impl->m_ShaderPassByteCode[shaderDesc.m_FileName] = byteCode;
+	ShaderCompileDesc ShaderHelper::GetCompileDesc(const ShaderDesc& shaderDesc)
+	{
+		ShaderCompileDesc ret{};
+		ret.m_FileName = shaderDesc.m_FileName;
+		ret.m_EntryPoint = shaderDesc.m_EnterPoint;
+		ret.m_Target = shaderDesc.m_Target;
+		ret.m_Type = shaderDesc.m_Type;
+		ret.m_Defines = shaderDesc.m_Defines.GetDefines();
+		return ret;
 	}
 
-	void ShaderHelper::Clear()
+	std::vector<std::future<ShaderCacheEntry>> ShaderHelper::SubmitShaders(const std::vector<ShaderDesc>& shaderDescs)
 	{
-		m_Impl->Clear();
+		std::vector<std::future<ShaderCacheEntry>> results;
+		results.reserve(shaderDescs.size());
+		for (const auto& shaderDesc : shaderDescs) {
+			results.push_back(GetCompileQueue().Submit(GetCompileDesc(shaderDesc)));
+		}
+		return results;
 	}
 
 	ComPtr<ID3DBlob> ShaderHelper::DXCCreateShaderFromFile(const ShaderDesc& shaderDesc, ID3D12ShaderReflection** reflection)
@@ -6,9 +6,13 @@
 #include <dxcapi.h>
 #include <DirectXMath.h>
 #include <map>
-#include <cmath>
 #include "D3D12DescriptorHeap.h"
 #include "D3D12Resource.h"
+#include "ShaderCompiler.h"
+#include "ShaderHotReload.h"
+#include "D3D12PipelineStateCache.h"
+#include "ShaderPropertyID.h"
+#include "ShaderBindingTable.h"
 
 struct ID3D12ShaderReflection;
 
@@ -16,50 +20,6 @@ namespace DSM {
 	class FrameResource;
 
 
-	/// <summary>
-	/// 着色器参数在着色器中的唯一索引
-	/// </summary>
-	struct ShaderParameterIndex
-	{
-		std::uint32_t m_BindPoint;
-		std::uint32_t m_RegisterSpace;
-
-		static std::uint32_t GetKeyByIndex(const ShaderParameterIndex& index)
-		{
-			// 使用 bits 表示移动了多少位
-			std::uint8_t bits = 4;
-			std::uint8_t move = (std::uint8_t)std::log2f(index.m_BindPoint) + 1;
-			std::uint32_t ret = index.m_BindPoint;
-			ret |= index.m_RegisterSpace << move;
-			ret <<= bits;
-			ret |= move;
-			return ret;
-		}
-
-		static ShaderParameterIndex GetIndexByKey(std::uint32_t key)
-		{
-			// 使用 bits 表示移动了多少位
-			std::uint8_t bits = 4;
-			ShaderParameterIndex ret{};
-			std::uint8_t move = key & ((1 << bits) - 1);
-			key >>= bits;
-			ret.m_BindPoint = key & ((1 << move) - 1);
-			ret.m_RegisterSpace = key >> move;
-			return ret;
-		}
-	};
-
-	enum class ShaderType : int
-	{
-		VERTEX_SHADER,
-		HULL_SHADER,
-		DOMAIN_SHADER,
-		GEOMETRY_SHADER,
-		PIXEL_SHADER,
-		COMPUTE_SHADER,
-		NUM_SHADER_TYPES
-	};
-
 	class ShaderDefines
 	{
 	public:
@@ -67,6 +27,7 @@ namespace DSM {
 		void RemoveDefine(const std::string& name);
 		std::vector<D3D_SHADER_MACRO> GetShaderDefines() const;
 		std::vector<DxcDefine> GetShaderDefinesDxc() const;
+		const std::map<std::string, std::string>& GetDefines() const noexcept;
 
 	private:
 		std::map<std::string, std::string> m_Defines;
@@ -125,12 +86,12 @@ namespace DSM {
 		virtual const D3D12_GRAPHICS_PIPELINE_STATE_DESC& GetPSODesc() const = 0;
 
 		// 获取顶点着色器的uniform形参用于设置值
-		virtual CBVariableSP VSGetParamByName(const std::string& paramName) = 0;
-		virtual CBVariableSP DSGetParamByName(const std::string& paramName) = 0;
-		virtual CBVariableSP HSGetParamByName(const std::string& paramName) = 0;
-		virtual CBVariableSP GSGetParamByName(const std::string& paramName) = 0;
-		virtual CBVariableSP PSGetParamByName(const std::string& paramName) = 0;
-		virtual CBVariableSP CSGetParamByName(const std::string& paramName) = 0;
+		virtual CBVariableSP VSGetParamByName(ShaderPropertyID paramName) = 0;
+		virtual CBVariableSP DSGetParamByName(ShaderPropertyID paramName) = 0;
+		virtual CBVariableSP HSGetParamByName(ShaderPropertyID paramName) = 0;
+		virtual CBVariableSP GSGetParamByName(ShaderPropertyID paramName) = 0;
+		virtual CBVariableSP PSGetParamByName(ShaderPropertyID paramName) = 0;
+		virtual CBVariableSP CSGetParamByName(ShaderPropertyID paramName) = 0;
 
 		virtual const ShaderHelper* GetShaderHelper() const = 0;
 		virtual const std::string& GetPassName()const = 0;
@@ -156,27 +117,45 @@ namespace DSM {
 		ShaderHelper(const ShaderHelper&) = delete;
 		ShaderHelper& operator=(const ShaderHelper&) = delete;
 
-		void SetConstantBufferByName(const std::string& name, std::shared_ptr<D3D12ResourceLocation> cb);
+		// 名称使用 ShaderPropertyID，字面量在编译期计算哈希
+		void SetConstantBufferByName(ShaderPropertyID name, std::shared_ptr<D3D12ResourceLocation> cb);
 		void SetConstantBufferBySlot(const ShaderParameterIndex& index, std::shared_ptr<D3D12ResourceLocation> cb);
-		void SetShaderResourceByName(const std::string& name, const HandleArray& resource);
+		void SetShaderResourceByName(ShaderPropertyID name, const HandleArray& resource);
 		void SetShaderResourceBySlot(const ShaderParameterIndex& index, const HandleArray& resource);
-		void SetRWResourceByName(const std::string& name, const HandleArray& resource);
+		void SetRWResourceByName(ShaderPropertyID name, const HandleArray& resource);
 		void SetRWResrouceBySlot(const ShaderParameterIndex& index, const HandleArray& resource);
-		void SetSampleStateByName(const std::string& name, const HandleArray& sampleState);
+		void SetSampleStateByName(ShaderPropertyID name, const HandleArray& sampleState);
 		void SetSampleStateBySlot(const ShaderParameterIndex& index, const HandleArray& sampleState);
 
-		std::shared_ptr<IConstantBufferVariable> GetConstantBufferVariable(const std::string& name);
-		std::shared_ptr<D3D12ResourceLocation> GetShaderResourceByName(const std::string& name);
-		std::shared_ptr<D3D12ResourceLocation> GetRWResourceByName(const std::string& name);
+		std::shared_ptr<IConstantBufferVariable> GetConstantBufferVariable(ShaderPropertyID name);
+		std::shared_ptr<D3D12ResourceLocation> GetShaderResourceByName(ShaderPropertyID name);
+		std::shared_ptr<D3D12ResourceLocation> GetRWResourceByName(ShaderPropertyID name);
 
 		void AddShaderPass(const std::string& shaderPassName, const ShaderPassDesc& passDesc, ID3D12Device* device);
 		std::shared_ptr<IShaderPass> GetShaderPass(const std::string& passName);
 
+		// 优先从着色器缓存中读取字节码与反射信息，未命中时编译并写入缓存
 		void CreateShaderFormFile(const ShaderDesc& shaderDesc);
+		// 在工作线程中并行编译一组着色器，反射结果按提交顺序合并，与逐个调用 CreateShaderFormFile 的结果一致
+		void CreateShadersFromFile(const std::vector<ShaderDesc>& shaderDescs);
+		// 合并已编译的着色器，需与使用该 ShaderHelper 的线程相同
+		void AddShader(const ShaderDesc& shaderDesc, const ShaderCacheEntry& compileResult);
 		void Clear();
 
-		Microsoft::WRL::ComPtr<ID3DBlob> DXCCreateShaderFromFile(const ShaderDesc& shaderDesc, ID3D12ShaderReflection** reflection);
-		Microsoft::WRL::ComPtr<ID3DBlob> D3DCompileCreateShaderFromFile(const ShaderDesc& shaderDesc, ID3D12ShaderReflection** reflection);
+		// 所有 ShaderHelper 共用的磁盘缓存、编译器与编译队列
+		static ShaderCache& GetShaderCache();
+		static IShaderCompiler& GetShaderCompiler();
+		static ShaderCompileQueue& GetCompileQueue();
+		static ShaderCompileDesc GetCompileDesc(const ShaderDesc& shaderDesc);
+		// 提交到编译队列后立即返回，结果通过 AddShader 合并
+		static std::vector<std::future<ShaderCacheEntry>> SubmitShaders(const std::vector<ShaderDesc>& shaderDescs);
+		// 所有 ShaderPass 共用的根签名与 PSO 缓存
+		static D3D12PipelineStateCache& GetPipelineStateCache();
+		// 所有 ShaderHelper 共用的热重载，启用后创建的着色器在源文件修改时重新编译，需在帧边界调用 Update
+		static ShaderHotReload& GetHotReload();
+
+		static Microsoft::WRL::ComPtr<ID3DBlob> DXCCreateShaderFromFile(const ShaderDesc& shaderDesc, ID3D12ShaderReflection** reflection);
+		static Microsoft::WRL::ComPtr<ID3DBlob> D3DCompileCreateShaderFromFile(const ShaderDesc& shaderDesc, ID3D12ShaderReflection** reflection);
 
 	private:
 		struct Impl;
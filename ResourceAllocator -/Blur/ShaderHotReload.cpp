@@ -0,0 +1,265 @@
+#include "ShaderHotReload.h"
+#include <algorithm>
+#include <exception>
+
+namespace DSM {
+	namespace {
+		template <typename Container>
+		auto FindByName(const Container& container, const std::string& name)
+		{
+			return std::find_if(container.begin(), container.end(), [&name](const auto& item) {
+				return item.m_Name == name;
+				});
+		}
+
+		bool IsSameCompileDesc(const ShaderCompileDesc& lhs, const ShaderCompileDesc& rhs)
+		{
+			return lhs.m_FileName == rhs.m_FileName &&
+				lhs.m_EntryPoint == rhs.m_EntryPoint &&
+				lhs.m_Target == rhs.m_Target &&
+				lhs.m_Type == rhs.m_Type &&
+				lhs.m_Defines == rhs.m_Defines;
+		}
+	}
+
+	bool IsReflectionCompatible(
+		const ShaderReflectionData& current,
+		const ShaderReflectionData& reloaded,
+		std::string* reason)
+	{
+		auto fail = [reason](std::string message) {
+			if (reason != nullptr) {
+				*reason = std::move(message);
+			}
+			return false;
+			};
+
+		// 线程组大小决定 Dispatch 的线程组数量
+		if (current.m_ThreadGroupSize != reloaded.m_ThreadGroupSize) {
+			return fail("thread group size changed");
+		}
+
+		for (const auto& cb : reloaded.m_ConstantBuffers) {
+			auto it = FindByName(current.m_ConstantBuffers, cb.m_Name);
+			if (it == current.m_ConstantBuffers.end()) {
+				return fail("constant buffer " + cb.m_Name + " is not in the original layout");
+			}
+			if (it->m_BindPoint != cb.m_BindPoint || it->m_RegisterSpace != cb.m_RegisterSpace) {
+				return fail("constant buffer " + cb.m_Name + " changed its register");
+			}
+			if (it->m_Size != cb.m_Size) {
+				return fail("constant buffer " + cb.m_Name + " changed its size");
+			}
+			for (const auto& variable : cb.m_Variables) {
+				auto varIt = FindByName(it->m_Variables, variable.m_Name);
+				if (varIt == it->m_Variables.end() ||
+					varIt->m_StartOffset != variable.m_StartOffset ||
+					varIt->m_Size != variable.m_Size) {
+					return fail("variable " + variable.m_Name + " in " + cb.m_Name + " changed its layout");
+				}
+			}
+		}
+
+		for (const auto& binding : reloaded.m_Bindings) {
+			auto it = std::find_if(current.m_Bindings.begin(), current.m_Bindings.end(), [&binding](const auto& item) {
+				return item.m_Name == binding.m_Name && item.m_Type == binding.m_Type;
+				});
+			if (it == current.m_Bindings.end()) {
+				return fail("resource " + binding.m_Name + " is not in the original layout");
+			}
+			if (it->m_BindPoint != binding.m_BindPoint ||
+				it->m_RegisterSpace != binding.m_RegisterSpace ||
+				it->m_BindCount != binding.m_BindCount ||
+				it->m_Dimension != binding.m_Dimension ||
+				it->m_EnableCounter != binding.m_EnableCounter) {
+				return fail("resource " + binding.m_Name + " changed its binding");
+			}
+		}
+		return true;
+	}
+
+
+	//
+	// ShaderHotReload Implementation
+	//
+	ShaderHotReload::ShaderHotReload(ShaderCompileQueue& compileQueue)
+		:m_CompileQueue(compileQueue) {
+	}
+
+	void ShaderHotReload::Enable(std::filesystem::path sourceDirectory, std::chrono::milliseconds interval)
+	{
+		m_SourceDirectory = std::move(sourceDirectory);
+		m_Enabled = true;
+		if (interval.count() > 0) {
+			m_Watcher.Start(interval);
+		}
+	}
+
+	void ShaderHotReload::Disable()
+	{
+		m_Watcher.Stop();
+		m_Enabled = false;
+	}
+
+	bool ShaderHotReload::IsEnabled() const noexcept
+	{
+		return m_Enabled;
+	}
+
+	void ShaderHotReload::Track(
+		const void* owner,
+		const std::string& name,
+		ShaderCompileDesc compileDesc,
+		ShaderReflectionData reflection,
+		ReloadCallback onReload)
+	{
+		if (!m_Enabled) return;
+
+		if (!m_SourceDirectory.empty()) {
+			std::error_code ec;
+			if (auto sourceFile = m_SourceDirectory / compileDesc.m_FileName; std::filesystem::exists(sourceFile, ec)) {
+				compileDesc.m_FileName = sourceFile.string();
+			}
+		}
+
+		auto shader = std::make_unique<TrackedShader>();
+		shader->m_Owner = owner;
+		shader->m_Name = name;
+		shader->m_CompileDesc = std::move(compileDesc);
+		shader->m_Reflection = std::move(reflection);
+		shader->m_OnReload = std::move(onReload);
+		WatchDependencies(*shader);
+
+		auto it = std::find_if(m_Shaders.begin(), m_Shaders.end(), [owner, &name](const auto& tracked) {
+			return tracked->m_Owner == owner && tracked->m_Name == name;
+			});
+		if (it != m_Shaders.end()) {
+			*it = std::move(shader);
+		}
+		else {
+			m_Shaders.push_back(std::move(shader));
+		}
+	}
+
+	void ShaderHotReload::Untrack(const void* owner)
+	{
+		// 丢弃 future 不会等待编译完成，结果由工作线程写入共享状态后释放
+		std::erase_if(m_Shaders, [owner](const auto& tracked) {
+			return tracked->m_Owner == owner;
+			});
+	}
+
+	std::size_t ShaderHotReload::GetTrackedCount() const noexcept
+	{
+		return m_Shaders.size();
+	}
+
+	void ShaderHotReload::Update()
+	{
+		if (!m_Enabled) return;
+
+		std::vector<const TrackedShader*> submitted;
+		auto changes = m_Watcher.TakeChanges();
+		if (!changes.empty()) {
+			for (auto& shader : m_Shaders) {
+				auto affected = std::any_of(changes.begin(), changes.end(), [&shader](const auto& path) {
+					const auto& dependencies = shader->m_Dependencies;
+					return std::find(dependencies.begin(), dependencies.end(), path) != dependencies.end();
+					});
+				if (!affected) continue;
+
+				if (shader->m_Pending.valid()) {
+					shader->m_Dirty = true;
+				}
+				else {
+					Submit(*shader, submitted);
+				}
+			}
+		}
+
+		// 只取出已经完成的结果，正在编译的留到之后的帧
+		std::vector<std::pair<ReloadCallback, ShaderCacheEntry>> reloads;
+		for (auto& shader : m_Shaders) {
+			if (!shader->m_Pending.valid() ||
+				shader->m_Pending.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+				continue;
+			}
+
+			// 共用的结果需要复制，shared_future 在取出后仍然有效，需手动重置
+			ShaderCacheEntry entry{};
+			bool compiled = false;
+			auto pending = std::move(shader->m_Pending);
+			try {
+				entry = pending.get();
+				compiled = true;
+			}
+			catch (const std::exception& e) {
+				m_Stats.m_LastError = shader->m_CompileDesc.m_FileName + ": " + e.what();
+			}
+			catch (...) {
+				m_Stats.m_LastError = shader->m_CompileDesc.m_FileName + ": compilation failed";
+			}
+
+			if (!compiled) {
+				++m_Stats.m_Failed;
+			}
+			else if (std::string reason; !IsReflectionCompatible(shader->m_Reflection, entry.m_Reflection, &reason)) {
+				m_Stats.m_LastError = shader->m_CompileDesc.m_FileName + ": " + reason;
+				++m_Stats.m_Rejected;
+			}
+			else {
+				++m_Stats.m_Reloaded;
+				reloads.emplace_back(shader->m_OnReload, std::move(entry));
+			}
+
+			if (shader->m_Dirty) {
+				Submit(*shader, submitted);
+			}
+		}
+
+		// 回调中可能登记或移除着色器，遍历结束后再调用
+		for (auto& [onReload, entry] : reloads) {
+			onReload(entry);
+		}
+	}
+
+	ShaderFileWatcher& ShaderHotReload::GetWatcher() noexcept
+	{
+		return m_Watcher;
+	}
+
+	const ShaderHotReloadStats& ShaderHotReload::GetStats() const noexcept
+	{
+		return m_Stats;
+	}
+
+	void ShaderHotReload::Submit(TrackedShader& shader, std::vector<const TrackedShader*>& submitted)
+	{
+		// 修改可能增加了新的包含文件
+		WatchDependencies(shader);
+		shader.m_Dirty = false;
+
+		// 同一次 Update 中提交的编译看到的源文件相同，可以共用结果
+		auto it = std::find_if(submitted.begin(), submitted.end(), [&shader](const TrackedShader* other) {
+			return IsSameCompileDesc(other->m_CompileDesc, shader.m_CompileDesc);
+			});
+		if (it != submitted.end()) {
+			shader.m_Pending = (*it)->m_Pending;
+			++m_Stats.m_Shared;
+			return;
+		}
+
+		shader.m_Pending = m_CompileQueue.Submit(shader.m_CompileDesc).share();
+		submitted.push_back(&shader);
+		++m_Stats.m_Submitted;
+	}
+
+	void ShaderHotReload::WatchDependencies(TrackedShader& shader)
+	{
+		shader.m_Dependencies = ShaderCache::GetSourceDependencies(shader.m_CompileDesc.m_FileName);
+		for (auto& dependency : shader.m_Dependencies) {
+			dependency = ShaderFileWatcher::Normalize(dependency);
+			m_Watcher.Watch(dependency);
+		}
+	}
+}
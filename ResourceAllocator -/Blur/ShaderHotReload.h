@@ -0,0 +1,101 @@
+#pragma once
+#ifndef __SHADERHOTRELOAD__H__
+#define __SHADERHOTRELOAD__H__
+
+#include "ShaderCompiler.h"
+#include "ShaderFileWatcher.h"
+#include <functional>
+#include <memory>
+
+namespace DSM {
+	// 重新编译后的反射结果能否沿用原有的根签名与常量缓冲区布局
+	// 新结果中的每个常量缓冲区、变量与绑定都需在原结果中存在且布局相同，允许不再使用其中一部分
+	// 不兼容时 reason 给出第一个不一致之处
+	bool IsReflectionCompatible(
+		const ShaderReflectionData& current,
+		const ShaderReflectionData& reloaded,
+		std::string* reason = nullptr);
+
+	struct ShaderHotReloadStats
+	{
+		std::uint32_t m_Submitted = 0;
+		// 与同一次 Update 中编译描述相同的着色器共用编译结果
+		std::uint32_t m_Shared = 0;
+		std::uint32_t m_Reloaded = 0;
+		// 布局与原有反射结果不兼容
+		std::uint32_t m_Rejected = 0;
+		// 编译失败
+		std::uint32_t m_Failed = 0;
+		std::string m_LastError;
+	};
+
+	// 着色器热重载
+	// 源文件修改后在编译队列中重新编译，结果在帧边界调用 Update 时检查并交换，
+	// 编译期间不会等待，失败或布局不兼容时保留原有的着色器。
+	// 多个 owner 登记的相同着色器(例如每个录制线程各自的着色器)只编译一次
+	class ShaderHotReload
+	{
+	public:
+		// 在调用 Update 的线程中执行，此时没有正在录制的命令
+		using ReloadCallback = std::function<void(const ShaderCacheEntry&)>;
+
+		explicit ShaderHotReload(ShaderCompileQueue& compileQueue);
+		ShaderHotReload(const ShaderHotReload&) = delete;
+		ShaderHotReload& operator=(const ShaderHotReload&) = delete;
+
+		// sourceDirectory 非空时优先使用该目录下的同名源文件，用于监视工程中的着色器而非构建时复制的文件
+		// interval 为 0 时不启动后台线程，由调用者通过 GetWatcher().Poll() 检查
+		void Enable(
+			std::filesystem::path sourceDirectory = {},
+			std::chrono::milliseconds interval = std::chrono::milliseconds(250));
+		void Disable();
+		bool IsEnabled() const noexcept;
+
+		// 登记已创建的着色器，未启用时忽略，同一 owner 与 name 再次登记时替换原有记录
+		void Track(
+			const void* owner,
+			const std::string& name,
+			ShaderCompileDesc compileDesc,
+			ShaderReflectionData reflection,
+			ReloadCallback onReload);
+		// 移除 owner 的所有记录，尚未完成的编译结果被丢弃
+		void Untrack(const void* owner);
+		std::size_t GetTrackedCount() const noexcept;
+
+		// 在帧边界调用：提交受修改影响的着色器，并交换已完成且布局兼容的结果
+		void Update();
+
+		ShaderFileWatcher& GetWatcher() noexcept;
+		const ShaderHotReloadStats& GetStats() const noexcept;
+
+	private:
+		struct TrackedShader
+		{
+			const void* m_Owner = nullptr;
+			std::string m_Name;
+			ShaderCompileDesc m_CompileDesc;
+			// 创建着色器时的反射结果，根签名与常量缓冲区按其生成，始终以它为准
+			ShaderReflectionData m_Reflection;
+			ReloadCallback m_OnReload;
+			std::vector<std::filesystem::path> m_Dependencies;
+			std::shared_future<ShaderCacheEntry> m_Pending;
+			// 编译期间再次被修改，完成后需要重新提交
+			bool m_Dirty = false;
+		};
+
+		// submitted 为本次 Update 中已提交的着色器，编译描述相同时共用其结果
+		void Submit(TrackedShader& shader, std::vector<const TrackedShader*>& submitted);
+		void WatchDependencies(TrackedShader& shader);
+
+	private:
+		ShaderCompileQueue& m_CompileQueue;
+		ShaderFileWatcher m_Watcher;
+		std::filesystem::path m_SourceDirectory;
+		bool m_Enabled = false;
+
+		std::vector<std::unique_ptr<TrackedShader>> m_Shaders;
+		ShaderHotReloadStats m_Stats{};
+	};
+}
+
+#endif
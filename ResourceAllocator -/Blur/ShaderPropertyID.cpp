@@ -0,0 +1,42 @@
+#include "ShaderPropertyID.h"
+#include <cassert>
+#include <mutex>
+#include <unordered_map>
+
+namespace DSM {
+	namespace {
+		struct PropertyRegistry
+		{
+			std::mutex m_Mutex;
+			std::unordered_map<ShaderPropertyID, std::string> m_Names;
+		};
+
+		PropertyRegistry& GetRegistry()
+		{
+			static PropertyRegistry registry;
+			return registry;
+		}
+	}
+
+	ShaderPropertyID ShaderPropertyID::Register(std::string_view name)
+	{
+		ShaderPropertyID id{ name };
+
+		auto& registry = GetRegistry();
+		std::lock_guard lock{ registry.m_Mutex };
+		auto [it, inserted] = registry.m_Names.try_emplace(id, name);
+		assert(inserted || it->second == name);
+
+		return id;
+	}
+
+	const std::string& ShaderPropertyID::GetName(ShaderPropertyID id)
+	{
+		static const std::string empty{};
+
+		auto& registry = GetRegistry();
+		std::lock_guard lock{ registry.m_Mutex };
+		auto it = registry.m_Names.find(id);
+		return it == registry.m_Names.end() ? empty : it->second;
+	}
+}
@@ -0,0 +1,64 @@
+#pragma once
+#ifndef __SHADERPROPERTYID__H__
+#define __SHADERPROPERTYID__H__
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+
+namespace DSM {
+	// 着色器参数与帧资源的名称 ID，由名称的 64 位 FNV-1a 哈希构成
+	// 字符串字面量在编译期计算，查找时只比较整数，不会构造临时字符串
+	class ShaderPropertyID
+	{
+	public:
+		constexpr ShaderPropertyID() noexcept = default;
+
+		// 字面量隐式转换，哈希在编译期完成
+		template <std::size_t N>
+		consteval ShaderPropertyID(const char(&name)[N]) noexcept
+			:m_Hash(Hash(std::string_view{ name, N - 1 })) {}
+
+		// 运行时的名称需显式转换，应在初始化时转换一次后保存
+		constexpr explicit ShaderPropertyID(std::string_view name) noexcept
+			:m_Hash(Hash(name)) {}
+
+		constexpr std::uint64_t GetHash() const noexcept { return m_Hash; }
+		constexpr bool IsValid() const noexcept { return m_Hash != 0; }
+
+		constexpr bool operator==(const ShaderPropertyID& other) const noexcept = default;
+
+		// 记录 ID 对应的名称，不同名称的哈希相同时断言失败
+		static ShaderPropertyID Register(std::string_view name);
+		// 返回注册时的名称，未注册时返回空字符串
+		static const std::string& GetName(ShaderPropertyID id);
+
+		static constexpr std::uint64_t Hash(std::string_view name) noexcept
+		{
+			// FNV-1a
+			std::uint64_t hash = 14695981039346656037ull;
+			for (auto c : name) {
+				hash ^= static_cast<std::uint8_t>(c);
+				hash *= 1099511628211ull;
+			}
+			return hash;
+		}
+
+	private:
+		std::uint64_t m_Hash = 0;
+	};
+}
+
+template <>
+struct std::hash<DSM::ShaderPropertyID>
+{
+	// ID 本身已是哈希值，直接使用
+	std::size_t operator()(const DSM::ShaderPropertyID& id) const noexcept
+	{
+		return static_cast<std::size_t>(id.GetHash());
+	}
+};
+
+#endif
@@ -0,0 +1,106 @@
+#include "ShaderVariant.h"
+#include <bit>
+
+namespace DSM {
+	std::uint32_t ShaderKeywordSet::AddKeyword(const std::string& name, std::vector<std::string> values)
+	{
+		assert(!name.empty() && !values.empty());
+
+		auto bits = static_cast<std::uint32_t>(std::bit_width(values.size() - 1));
+		if (m_KeyBits + bits > MaxKeyBits) {
+			return InvalidKeyword;
+		}
+
+		Keyword keyword{};
+		keyword.m_Name = name;
+		keyword.m_Values = std::move(values);
+		keyword.m_Shift = m_KeyBits;
+		keyword.m_Mask = (1u << bits) - 1;
+		m_KeyBits += bits;
+		m_Keywords.push_back(std::move(keyword));
+
+		return static_cast<std::uint32_t>(m_Keywords.size() - 1);
+	}
+
+	std::uint32_t ShaderKeywordSet::AddToggle(const std::string& name)
+	{
+		return AddKeyword(name, { "", "1" });
+	}
+
+	std::uint32_t ShaderKeywordSet::AddRange(const std::string& name, std::uint32_t minValue, std::uint32_t maxValue)
+	{
+		assert(minValue <= maxValue);
+
+		std::vector<std::string> values;
+		values.reserve(maxValue - minValue + 1);
+		for (auto i = minValue; i <= maxValue; ++i) {
+			values.push_back(std::to_string(i));
+		}
+		return AddKeyword(name, std::move(values));
+	}
+
+	std::uint32_t ShaderKeywordSet::GetKeywordCount() const noexcept
+	{
+		return static_cast<std::uint32_t>(m_Keywords.size());
+	}
+
+	std::uint32_t ShaderKeywordSet::GetValueCount(std::uint32_t keyword) const
+	{
+		assert(keyword < m_Keywords.size());
+		return static_cast<std::uint32_t>(m_Keywords[keyword].m_Values.size());
+	}
+
+	const std::string& ShaderKeywordSet::GetKeywordName(std::uint32_t keyword) const
+	{
+		assert(keyword < m_Keywords.size());
+		return m_Keywords[keyword].m_Name;
+	}
+
+	std::uint32_t ShaderKeywordSet::GetKeyRange() const noexcept
+	{
+		return 1u << m_KeyBits;
+	}
+
+	ShaderVariantKey ShaderKeywordSet::SetValue(ShaderVariantKey key, std::uint32_t keyword, std::uint32_t valueIndex) const
+	{
+		assert(keyword < m_Keywords.size());
+		const auto& kw = m_Keywords[keyword];
+		assert(valueIndex < kw.m_Values.size());
+
+		key &= ~(kw.m_Mask << kw.m_Shift);
+		return key | (valueIndex << kw.m_Shift);
+	}
+
+	std::uint32_t ShaderKeywordSet::GetValue(ShaderVariantKey key, std::uint32_t keyword) const
+	{
+		assert(keyword < m_Keywords.size());
+		const auto& kw = m_Keywords[keyword];
+		return (key >> kw.m_Shift) & kw.m_Mask;
+	}
+
+	bool ShaderKeywordSet::IsValid(ShaderVariantKey key) const noexcept
+	{
+		if (key >= GetKeyRange()) return false;
+		// 取值数量不是 2 的幂时，部分编码没有对应的取值
+		for (const auto& kw : m_Keywords) {
+			if (((key >> kw.m_Shift) & kw.m_Mask) >= kw.m_Values.size()) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	std::map<std::string, std::string> ShaderKeywordSet::GetDefines(ShaderVariantKey key) const
+	{
+		assert(IsValid(key));
+
+		std::map<std::string, std::string> defines;
+		for (const auto& kw : m_Keywords) {
+			const auto& value = kw.m_Values[(key >> kw.m_Shift) & kw.m_Mask];
+			if (!value.empty()) {
+				defines[kw.m_Name] = value;
+			}
+		}
+		return defines;
+	}
+}
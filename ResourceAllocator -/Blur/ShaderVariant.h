@@ -0,0 +1,115 @@
+#pragma once
+#ifndef __SHADERVARIANT__H__
+#define __SHADERVARIANT__H__
+
+#include <cassert>
+#include <cstdint>
+#include <map>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace DSM {
+	// 着色器变体的键，每个关键字占用其中连续的若干位
+	using ShaderVariantKey = std::uint32_t;
+
+	// 一个着色器的所有关键字维度
+	// 每个取值对应一个宏的值，值为空字符串时不定义该宏，便于配合 #ifdef 使用
+	class ShaderKeywordSet
+	{
+	public:
+		// 变体表按键直接索引，限制键的位数防止表过大
+		static constexpr std::uint32_t MaxKeyBits = 16;
+		static constexpr std::uint32_t InvalidKeyword = UINT32_MAX;
+
+		// 返回关键字的索引，第一个取值为默认值，键的位数超过 MaxKeyBits 时不加入并返回 InvalidKeyword
+		std::uint32_t AddKeyword(const std::string& name, std::vector<std::string> values);
+		// 取值 0 时不定义宏，取值 1 时定义为 1
+		std::uint32_t AddToggle(const std::string& name);
+		// 取值为 [minValue, maxValue] 内的整数
+		std::uint32_t AddRange(const std::string& name, std::uint32_t minValue, std::uint32_t maxValue);
+
+		std::uint32_t GetKeywordCount() const noexcept;
+		std::uint32_t GetValueCount(std::uint32_t keyword) const;
+		const std::string& GetKeywordName(std::uint32_t keyword) const;
+		// 所有键都小于该值，可直接作为变体表的大小
+		std::uint32_t GetKeyRange() const noexcept;
+
+		ShaderVariantKey SetValue(ShaderVariantKey key, std::uint32_t keyword, std::uint32_t valueIndex) const;
+		std::uint32_t GetValue(ShaderVariantKey key, std::uint32_t keyword) const;
+		bool IsValid(ShaderVariantKey key) const noexcept;
+
+		std::map<std::string, std::string> GetDefines(ShaderVariantKey key) const;
+
+	private:
+		struct Keyword
+		{
+			std::string m_Name;
+			std::vector<std::string> m_Values;
+			std::uint32_t m_Shift;
+			std::uint32_t m_Mask;
+		};
+
+		std::vector<Keyword> m_Keywords;
+		std::uint32_t m_KeyBits = 0;
+	};
+
+
+	// 以变体键直接索引的变体表，查找为 O(1)
+	template <typename T>
+	class ShaderVariantTable
+	{
+	public:
+		explicit ShaderVariantTable(std::uint32_t keyRange = 1)
+			:m_Variants(keyRange), m_Requested(keyRange, 0) {}
+
+		void Reset(std::uint32_t keyRange)
+		{
+			m_Variants.assign(keyRange, std::nullopt);
+			m_Requested.assign(keyRange, 0);
+			m_VariantCount = 0;
+		}
+
+		// 变体尚未就绪时返回 nullptr
+		const T* Find(ShaderVariantKey key) const
+		{
+			assert(key < m_Variants.size());
+			return m_Variants[key].has_value() ? &*m_Variants[key] : nullptr;
+		}
+
+		// 首次请求时返回 true，由调用方开始编译
+		bool Request(ShaderVariantKey key)
+		{
+			assert(key < m_Requested.size());
+			if (m_Requested[key]) return false;
+			m_Requested[key] = 1;
+			return true;
+		}
+
+		bool IsRequested(ShaderVariantKey key) const
+		{
+			assert(key < m_Requested.size());
+			return m_Requested[key] != 0;
+		}
+
+		void SetVariant(ShaderVariantKey key, T variant)
+		{
+			assert(key < m_Variants.size());
+			if (!m_Variants[key].has_value()) {
+				++m_VariantCount;
+			}
+			m_Variants[key] = std::move(variant);
+			m_Requested[key] = 1;
+		}
+
+		// 已就绪的变体数量
+		std::uint32_t GetVariantCount() const noexcept { return m_VariantCount; }
+
+	private:
+		std::vector<std::optional<T>> m_Variants;
+		std::vector<std::uint8_t> m_Requested;
+		std::uint32_t m_VariantCount = 0;
+	};
+}
+
+#endif
@@ -15,6 +15,19 @@
 #define MAXSPOTLIGHTCOUNT 1
 #endif
 
+// 实际参与计算的光源数量，由着色器变体指定，不影响常量缓冲区的布局
+#ifndef DIRLIGHTCOUNT
+#define DIRLIGHTCOUNT MAXDIRLIGHTCOUNT
+#endif
+
+#ifndef POINTLIGHTCOUNT
+#define POINTLIGHTCOUNT MAXPOINTLIGHTCOUNT
+#endif
+
+#ifndef SPOTLIGHTCOUNT
+#define SPOTLIGHTCOUNT MAXSPOTLIGHTCOUNT
+#endif
+
 struct DirectionalLight
 {
     float3 Color;
@@ -48,7 +61,7 @@ struct MaterialConstants
     float3 Specular;
     float Gloss;
     float3 Ambient;
-    float pad0;
+    uint DiffuseIndex;  // 无绑定模式下漫反射纹理的描述符索引
 };
 
 // 各种光源的集合，需要按顺序传递光源
@@ -122,18 +135,18 @@ float3 ComputeLighting(
     float3 col = 0;
     
     [unroll]
-    for (uint i = 0; i < MAXDIRLIGHTCOUNT; ++i)
+    for (uint i = 0; i < DIRLIGHTCOUNT; ++i)
     {
         // 仅直接光接收阴影
         col += ComputeDirectionalLight(lights.DirectionalLights[i], mat, viewDir, normal) * shadowFactor[i];
     }
     [unroll]
-    for (uint ii = 0; ii < MAXPOINTLIGHTCOUNT; ++ii)
+    for (uint ii = 0; ii < POINTLIGHTCOUNT; ++ii)
     {
         col += ComputePointLight(lights.PointLights[ii], mat, viewDir, normal, posW);
     }
     [unroll]
-    for (uint iii = 0; iii < MAXSPOTLIGHTCOUNT; ++iii)
+    for (uint iii = 0; iii < SPOTLIGHTCOUNT; ++iii)
     {
         col += ComputeSpotLight(lights.SpotLights[iii], mat, viewDir, normal, posW);
     }
@@ -9,6 +9,10 @@ ConstantBuffer<MaterialConstants> gMatCB : register(b3);
 
 Texture2D gDiffuse : register(t0);
 Texture2D gShadowMap : register(t1);
+#ifdef BINDLESS
+// 所有纹理位于同一个描述符范围，通过材质中的索引访问
+Texture2D gTextures[] : register(t0, space1);
+#endif
 
 SamplerState gSamplerPointWrap          : register(s0);
 SamplerState gSamplerLinearWrap         : register(s1);
@@ -33,7 +37,12 @@ VertexPosWHNormalWTexShadow VS(VertexPosLNormalLTex v)
 
 float4 PS(VertexPosWHNormalWTexShadow i) : SV_Target
 {
-    float4 diffuseAlbedo = gDiffuse.Sample(gSamplerAnisotropicWrap, i.TexCoord);
+#ifdef BINDLESS
+    Texture2D diffuseMap = gTextures[NonUniformResourceIndex(gMatCB.DiffuseIndex)];
+#else
+    Texture2D diffuseMap = gDiffuse;
+#endif
+    float4 diffuseAlbedo = diffuseMap.Sample(gSamplerAnisotropicWrap, i.TexCoord);
     float alpha = diffuseAlbedo.a * gMatCB.Alpha;
 #ifdef ALPHATEST
     // 进行alpha测试，剔除alpha过低的像素
@@ -50,7 +59,12 @@ float4 PS(VertexPosWHNormalWTexShadow i) : SV_Target
     [unroll]
     for (int index = 0; index < MAXDIRLIGHTCOUNT; ++index)
     {
-        shadowFactor[index] = PCF(gSamplerShadowBorder, gShadowMap, i.ShadowPosH);
+        // 变体中未使用的光源不计算阴影
+        shadowFactor[index] = 0;
+        if (index < DIRLIGHTCOUNT)
+        {
+            shadowFactor[index] = PCF(gSamplerShadowBorder, gShadowMap, i.ShadowPosH);
+        }
     }
     float3 col = ComputeLighting(gLightCB, gMatCB, viewDir, normal, i.PosW, shadowFactor);
     col += gMatCB.Ambient;
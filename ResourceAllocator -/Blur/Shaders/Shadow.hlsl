@@ -9,6 +9,10 @@ ConstantBuffer<PassConstants> gPassCB : register(b1);
 ConstantBuffer<MaterialConstants> gMatCB : register(b2);
 
 Texture2D gDiffuse : register(t0);
+#ifdef BINDLESS
+// 所有纹理位于同一个描述符范围，通过材质中的索引访问
+Texture2D gTextures[] : register(t0, space1);
+#endif
 
 SamplerState gSamplerAnisotropicWrap : register(s2);
 
@@ -25,7 +29,12 @@ VertexPosHTex ShadowVS(VertexPosLNormalLTex i)
 // 当使用深度测试的时候，需要将透明的部分裁剪掉来保证阴影的正确
 void ShadowPS(VertexPosHTex i)
 {
-    float4 texCol = gDiffuse.Sample(gSamplerAnisotropicWrap, i.TexCoord);
+#ifdef BINDLESS
+    Texture2D diffuseMap = gTextures[NonUniformResourceIndex(gMatCB.DiffuseIndex)];
+#else
+    Texture2D diffuseMap = gDiffuse;
+#endif
+    float4 texCol = diffuseMap.Sample(gSamplerAnisotropicWrap, i.TexCoord);
     float alpha = texCol.a * gMatCB.Alpha;
 
 #ifdef ALPHATEST
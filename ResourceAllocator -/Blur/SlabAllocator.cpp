@@ -0,0 +1,194 @@
+#include "SlabAllocator.h"
+#include <bit>
+#include <cassert>
+
+namespace DSM {
+	SlabAllocator::SlabAllocator(std::uint64_t slabSize, std::uint64_t minSlotSize, std::uint64_t maxSlotSize)
+		:m_SlabSize(slabSize), m_MinSlotSize(minSlotSize), m_MaxSlotSize(maxSlotSize) {
+		assert(std::has_single_bit(m_MinSlotSize) && std::has_single_bit(m_MaxSlotSize));
+		assert(m_MinSlotSize <= m_MaxSlotSize && m_MaxSlotSize <= m_SlabSize);
+		assert(m_SlabSize % m_MaxSlotSize == 0 && m_SlabSize / m_MinSlotSize <= MaxSlotsPerSlab);
+
+		m_PartialSlabHead.assign(SizeToClass(m_MaxSlotSize) + 1, InvalidIndex);
+	}
+
+	void SlabAllocator::AddSlabs(std::uint32_t count)
+	{
+		auto first = static_cast<std::uint32_t>(m_Slabs.size());
+		m_Slabs.resize(m_Slabs.size() + count);
+		// 倒序压入，使低地址的 Slab 先被使用
+		for (std::uint32_t i = count; i > 0; --i) {
+			m_FreeSlabs.push_back(first + i - 1);
+		}
+	}
+
+	bool SlabAllocator::ReleaseSlabs(std::uint32_t first, std::uint32_t count)
+	{
+		assert(first + count <= m_Slabs.size());
+		for (auto i = first; i < first + count; ++i) {
+			if (m_Slabs[i].m_SizeClass != InvalidIndex || m_Slabs[i].m_Released) {
+				return false;
+			}
+		}
+
+		std::erase_if(m_FreeSlabs, [first, count](std::uint32_t slab) {
+			return slab >= first && slab < first + count;
+			});
+		for (auto i = first; i < first + count; ++i) {
+			m_Slabs[i].m_Released = true;
+		}
+		return true;
+	}
+
+	void SlabAllocator::RestoreSlabs(std::uint32_t first, std::uint32_t count)
+	{
+		assert(first + count <= m_Slabs.size());
+		for (std::uint32_t i = count; i > 0; --i) {
+			auto& slab = m_Slabs[first + i - 1];
+			assert(slab.m_Released);
+			slab.m_Released = false;
+			m_FreeSlabs.push_back(first + i - 1);
+		}
+	}
+
+	bool SlabAllocator::Allocate(std::uint64_t size, Allocation& allocation)
+	{
+		if (!CanAllocate(size)) {
+			return false;
+		}
+
+		auto sizeClass = SizeToClass(size);
+		auto slabIndex = m_PartialSlabHead[sizeClass];
+		if (slabIndex == InvalidIndex) {
+			if (m_FreeSlabs.empty()) {
+				return false;
+			}
+			slabIndex = m_FreeSlabs.back();
+			m_FreeSlabs.pop_back();
+
+			auto& slab = m_Slabs[slabIndex];
+			auto slotCount = GetSlotCount(sizeClass);
+			slab.m_SizeClass = sizeClass;
+			slab.m_UsedCount = 0;
+			slab.m_FreeMask = slotCount == 64 ? ~std::uint64_t(0) : (std::uint64_t(1) << slotCount) - 1;
+			PushPartialSlab(slabIndex);
+		}
+
+		auto& slab = m_Slabs[slabIndex];
+		auto slot = static_cast<std::uint32_t>(std::countr_zero(slab.m_FreeMask));
+		slab.m_FreeMask &= slab.m_FreeMask - 1;
+		++slab.m_UsedCount;
+		if (slab.m_FreeMask == 0) {
+			RemovePartialSlab(slabIndex);
+		}
+
+		m_UsedSize += ClassToSlotSize(sizeClass);
+		allocation.m_Slab = slabIndex;
+		allocation.m_Slot = slot;
+		return true;
+	}
+
+	void SlabAllocator::Deallocate(const Allocation& allocation)
+	{
+		assert(allocation.m_Slab < m_Slabs.size());
+		auto& slab = m_Slabs[allocation.m_Slab];
+		const auto bit = std::uint64_t(1) << allocation.m_Slot;
+		assert(slab.m_SizeClass != InvalidIndex && (slab.m_FreeMask & bit) == 0);
+
+		// 已满的 Slab 重新变为可分配
+		if (slab.m_FreeMask == 0) {
+			PushPartialSlab(allocation.m_Slab);
+		}
+		slab.m_FreeMask |= bit;
+		--slab.m_UsedCount;
+		m_UsedSize -= ClassToSlotSize(slab.m_SizeClass);
+
+		// 空的 Slab 归还给所有大小共用
+		if (slab.m_UsedCount == 0) {
+			RemovePartialSlab(allocation.m_Slab);
+			slab.m_SizeClass = InvalidIndex;
+			slab.m_FreeMask = 0;
+			m_FreeSlabs.push_back(allocation.m_Slab);
+		}
+	}
+
+	bool SlabAllocator::CanAllocate(std::uint64_t size) const noexcept
+	{
+		return size > 0 && size <= m_MaxSlotSize;
+	}
+
+	std::uint64_t SlabAllocator::GetSlotSize(std::uint64_t size) const noexcept
+	{
+		return ClassToSlotSize(SizeToClass(size));
+	}
+
+	std::uint64_t SlabAllocator::GetOffset(const Allocation& allocation) const noexcept
+	{
+		const auto& slab = m_Slabs[allocation.m_Slab];
+		return allocation.m_Slab * m_SlabSize + allocation.m_Slot * ClassToSlotSize(slab.m_SizeClass);
+	}
+
+	std::uint64_t SlabAllocator::GetSlabSize() const noexcept
+	{
+		return m_SlabSize;
+	}
+
+	std::uint32_t SlabAllocator::GetSlabCount() const noexcept
+	{
+		return static_cast<std::uint32_t>(m_Slabs.size());
+	}
+
+	std::uint32_t SlabAllocator::GetFreeSlabCount() const noexcept
+	{
+		return static_cast<std::uint32_t>(m_FreeSlabs.size());
+	}
+
+	std::uint64_t SlabAllocator::GetUsedSize() const noexcept
+	{
+		return m_UsedSize;
+	}
+
+	std::uint32_t SlabAllocator::SizeToClass(std::uint64_t size) const noexcept
+	{
+		// 计算 ceil(log2(size / minSlotSize))
+		auto unitSize = (size + m_MinSlotSize - 1) / m_MinSlotSize;
+		return unitSize <= 1 ? 0 : static_cast<std::uint32_t>(std::bit_width(unitSize - 1));
+	}
+
+	std::uint64_t SlabAllocator::ClassToSlotSize(std::uint32_t sizeClass) const noexcept
+	{
+		return m_MinSlotSize << sizeClass;
+	}
+
+	std::uint32_t SlabAllocator::GetSlotCount(std::uint32_t sizeClass) const noexcept
+	{
+		return static_cast<std::uint32_t>(m_SlabSize / ClassToSlotSize(sizeClass));
+	}
+
+	void SlabAllocator::PushPartialSlab(std::uint32_t slabIndex) noexcept
+	{
+		auto& slab = m_Slabs[slabIndex];
+		auto& head = m_PartialSlabHead[slab.m_SizeClass];
+		slab.m_Prev = InvalidIndex;
+		slab.m_Next = head;
+		if (head != InvalidIndex) {
+			m_Slabs[head].m_Prev = slabIndex;
+		}
+		head = slabIndex;
+	}
+
+	void SlabAllocator::RemovePartialSlab(std::uint32_t slabIndex) noexcept
+	{
+		auto& slab = m_Slabs[slabIndex];
+		if (slab.m_Prev != InvalidIndex) {
+			m_Slabs[slab.m_Prev].m_Next = slab.m_Next;
+		}
+		else {
+			m_PartialSlabHead[slab.m_SizeClass] = slab.m_Next;
+		}
+		if (slab.m_Next != InvalidIndex) {
+			m_Slabs[slab.m_Next].m_Prev = slab.m_Prev;
+		}
+		slab.m_Next = slab.m_Prev = InvalidIndex;
+	}
+}
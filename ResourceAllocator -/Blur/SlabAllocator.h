@@ -0,0 +1,79 @@
+#pragma once
+#ifndef __SLABALLOCATOR__H__
+#define __SLABALLOCATOR__H__
+
+#include <cstdint>
+#include <vector>
+
+namespace DSM {
+	// 小块内存的 Slab 簿记核心，不依赖 D3D12 设备
+	// 地址空间被划分为等大的 Slab，每个 Slab 只服务一种 2 的幂大小的槽，
+	// 槽的偏移天然按槽的大小对齐，空的 Slab 会回到公共的空闲列表供其他大小复用
+	class SlabAllocator
+	{
+	public:
+		static constexpr std::uint32_t InvalidIndex = UINT32_MAX;
+		static constexpr std::uint32_t MaxSlotsPerSlab = 64;
+
+		struct Allocation
+		{
+			std::uint32_t m_Slab = InvalidIndex;
+			std::uint32_t m_Slot = 0;
+		};
+
+		// 每个 Slab 至多包含 MaxSlotsPerSlab 个最小的槽
+		SlabAllocator(std::uint64_t slabSize, std::uint64_t minSlotSize, std::uint64_t maxSlotSize);
+
+		// 增加可用的 Slab，新的 Slab 接在已有地址空间之后
+		void AddSlabs(std::uint32_t count);
+		// 将一段全部空闲的 Slab 移出空闲列表，地址空间保持不变，供释放底层内存时使用
+		// 任一 Slab 仍有分配时返回 false
+		bool ReleaseSlabs(std::uint32_t first, std::uint32_t count);
+		// 重新启用被移出的 Slab
+		void RestoreSlabs(std::uint32_t first, std::uint32_t count);
+		// 分配槽，没有可用的 Slab 时返回 false，调用者可 AddSlabs 后重试
+		bool Allocate(std::uint64_t size, Allocation& allocation);
+		void Deallocate(const Allocation& allocation);
+
+		// 能放入 Slab 的最大请求
+		bool CanAllocate(std::uint64_t size) const noexcept;
+		std::uint64_t GetSlotSize(std::uint64_t size) const noexcept;
+		// 分配在整个地址空间中的偏移
+		std::uint64_t GetOffset(const Allocation& allocation) const noexcept;
+
+		std::uint64_t GetSlabSize() const noexcept;
+		std::uint32_t GetSlabCount() const noexcept;
+		std::uint32_t GetFreeSlabCount() const noexcept;
+		// 已分配的槽的总大小
+		std::uint64_t GetUsedSize() const noexcept;
+
+	private:
+		struct Slab
+		{
+			std::uint32_t m_SizeClass = InvalidIndex;
+			std::uint32_t m_UsedCount = 0;
+			std::uint64_t m_FreeMask = 0;       // 空闲的槽
+			std::uint32_t m_Next = InvalidIndex;    // 同一大小的未满 Slab 链表
+			std::uint32_t m_Prev = InvalidIndex;
+			bool m_Released = false;            // 已被移出空闲列表
+		};
+
+		std::uint32_t SizeToClass(std::uint64_t size) const noexcept;
+		std::uint64_t ClassToSlotSize(std::uint32_t sizeClass) const noexcept;
+		std::uint32_t GetSlotCount(std::uint32_t sizeClass) const noexcept;
+		void PushPartialSlab(std::uint32_t slab) noexcept;
+		void RemovePartialSlab(std::uint32_t slab) noexcept;
+
+	private:
+		const std::uint64_t m_SlabSize;
+		const std::uint64_t m_MinSlotSize;
+		const std::uint64_t m_MaxSlotSize;
+
+		std::vector<Slab> m_Slabs;
+		std::vector<std::uint32_t> m_FreeSlabs;         // 没有任何分配的 Slab
+		std::vector<std::uint32_t> m_PartialSlabHead;   // 每种大小的未满 Slab 链表的头
+		std::uint64_t m_UsedSize = 0;
+	};
+}
+
+#endif
@@ -90,7 +90,11 @@ namespace DSM {
 
 	void Texture::DisposeUploader() noexcept
 	{
-		m_UploadHeap.m_Allocator->ClearUpAllocations();
+		// 上传堆在当前帧完成后由分配器回收
+		if (m_UploadHeap.m_Allocator != nullptr) {
+			m_UploadHeap.m_Allocator->Deallocate(m_UploadHeap);
+			m_UploadHeap.m_Allocator = nullptr;
+		}
 	}
 
 	bool Texture::LoadTextureFromFile(
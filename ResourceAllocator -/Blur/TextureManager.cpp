@@ -25,8 +25,8 @@ namespace DSM {
 			m_UploadBufferAllocator.get());
 		if (sucess) {
 			CreateSRV(tex);
-			tex.SetDescriptorIndex(m_Textures.size());
 			m_Textures[name] = std::move(tex);
+			RegisterMovable(m_Textures[name]);
 		}
 		return sucess ? &m_Textures[name] : nullptr;
 	}
@@ -46,8 +46,8 @@ namespace DSM {
 			m_UploadBufferAllocator.get());
 		if (sucess) {
 			CreateSRV(tex);
-			tex.SetDescriptorIndex(m_Textures.size());
 			m_Textures[name] = std::move(tex);
+			RegisterMovable(m_Textures[name]);
 		}
 		return sucess ? &m_Textures[name] : nullptr;
 	}
@@ -58,8 +58,12 @@ namespace DSM {
 			return false;
 		}
 		else {
-			texture.SetDescriptorIndex(m_Textures.size());
+			AllocateDescriptorIndex(texture);
+			if (texture.GetSRV().IsValid()) {
+				UpdateBindlessDescriptor(texture);
+			}
 			m_Textures[name] = std::move(texture);
+			RegisterMovable(m_Textures[name]);
 			return true;
 		}
 	}
@@ -91,12 +95,55 @@ namespace DSM {
 		return m_Textures.find("DefaultTexture")->second.GetSRV();
 	}
 
-	TextureManager::TextureManager(ID3D12Device* device, ID3D12GraphicsCommandList* cmdList)
-		:m_Device(device), m_DescriptorHeap(std::make_unique<D3D12DescriptorHeap>(device)) {
-		m_DescriptorHeap->Create(L"TextureShaderResourceView", D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV, 512);
+	std::uint32_t TextureManager::GetTextureDescriptorIndex(const std::string& texName) const
+	{
+		if (auto it = m_Textures.find(texName); it != m_Textures.end()) {
+			return it->second.GetDescriptorIndex();
+		}
+		return m_Textures.find("DefaultTexture")->second.GetDescriptorIndex();
+	}
+
+	const Texture* TextureManager::GetTexture(const std::string& texName) const
+	{
+		if (auto it = m_Textures.find(texName); it != m_Textures.end()) {
+			return &it->second;
+		}
+		return &m_Textures.find("DefaultTexture")->second;
+	}
+
+	void TextureManager::ClearUpAllocations()
+	{
+		m_TextureAllocator->ClearUpAllocations();
+		m_UploadBufferAllocator->ClearUpAllocations();
+		m_BindlessIndices.ClearUp();
+	}
+
+	void TextureManager::GetAllocatorStats(std::vector<AllocatorStats>& stats) const
+	{
+		auto textureStats = m_TextureAllocator->GetStats();
+		textureStats.m_Name = "TextureManager Texture";
+		stats.push_back(std::move(textureStats));
+		auto uploadStats = m_UploadBufferAllocator->GetStats();
+		uploadStats.m_Name = "TextureManager Upload";
+		stats.push_back(std::move(uploadStats));
+	}
+
+	void TextureManager::Defragment(ID3D12GraphicsCommandList* cmdList)
+	{
+		if (m_Defragmenter->IsIdle() && ++m_FramesSinceDefragment >= DefragmentInterval) {
+			m_FramesSinceDefragment = 0;
+			m_Defragmenter->BeginDefragment();
+		}
+		m_Defragmenter->Update(cmdList, DefragmentByteBudget);
+	}
+
+	TextureManager::TextureManager(ID3D12Device* device, ID3D12GraphicsCommandList* cmdList, IFence* fence)
+		:m_Device(device), m_DescriptorAllocator(std::make_unique<D3D12DescriptorAllocator>(device)),
+		m_BindlessIndices(MaxBindlessTextures, fence) {
 		
-		m_TextureAllocator = std::make_unique<D3D12TextureAllocator>(m_Device.Get());
-		m_UploadBufferAllocator = std::make_unique<D3D12UploadBufferAllocator>(m_Device.Get());
+		m_TextureAllocator = std::make_unique<D3D12TextureAllocator>(m_Device.Get(), fence);
+		m_UploadBufferAllocator = std::make_unique<D3D12UploadBufferAllocator>(m_Device.Get(), fence);
+		m_Defragmenter = std::make_unique<D3D12Defragmenter>(m_Device.Get(), m_TextureAllocator->GetBuddyAllocator(), fence);
 		
 		// 创建一个空白纹理，用来处理模型没有纹理的情况
 		std::uint32_t white = (std::uint32_t) - 1;
@@ -163,12 +210,35 @@ namespace DSM {
 		whiteTexture.SetTexture(texResource);
 		whiteTexture.SetUploadHeap(uploadHeap);
 		whiteTexture.SetName("DefaultTexture");
-		whiteTexture.SetDescriptorIndex(m_Textures.size());
 		CreateSRV(whiteTexture);
 		m_Textures[whiteTexture.GetName()] = std::move(whiteTexture);
 	}
 
+	void TextureManager::AddDescriptorRing(D3D12DescriptorRing* descriptorRing)
+	{
+		m_DescriptorAllocator->AddDescriptorRing(descriptorRing);
+	}
+
+	void TextureManager::SetBindlessTable(D3D12DescriptorRing* descriptorRing)
+	{
+		assert(descriptorRing == nullptr || descriptorRing->GetStaticCount() >= MaxBindlessTextures);
+
+		m_BindlessTable = descriptorRing;
+		for (const auto& [name, texture] : m_Textures) {
+			if (texture.GetSRV().IsValid()) {
+				UpdateBindlessDescriptor(texture);
+			}
+		}
+	}
+
 	void TextureManager::CreateSRV(Texture& texture)
+	{
+		AllocateDescriptorIndex(texture);
+		texture.SetSRVHandle(m_DescriptorAllocator->Allocate(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV).m_Handle);
+		UpdateSRV(texture);
+	}
+
+	void TextureManager::UpdateSRV(const Texture& texture)
 	{
 		D3D12_SHADER_RESOURCE_VIEW_DESC SRVDesc{};
 		auto& texResource = texture.GetTexture().m_UnderlyingResource->m_Resource;
@@ -186,9 +256,67 @@ namespace DSM {
 			SRVDesc.Texture2D.MostDetailedMip = 0;
 			SRVDesc.Texture2D.ResourceMinLODClamp = 0;
 		}
-		auto handle = m_DescriptorHeap->Allocate();
-		texture.SetSRVHandle(handle);
 		m_Device->CreateShaderResourceView(
-			texture.GetTexture().m_UnderlyingResource->m_Resource.Get(), &SRVDesc, handle);
+			texture.GetTexture().m_UnderlyingResource->m_Resource.Get(), &SRVDesc, texture.GetSRV());
+		UpdateBindlessDescriptor(texture);
+	}
+
+	void TextureManager::RegisterMovable(Texture& texture)
+	{
+		m_Defragmenter->Register(&texture.GetTexture(), D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE,
+			[this, &texture](D3D12ResourceLocation&) { OnTextureMoved(texture); });
+	}
+
+	void TextureManager::OnTextureMoved(Texture& texture)
+	{
+		// 执行中的帧仍可能通过旧的无绑定索引读取旧的资源，因此不能覆盖 Shader Visible 的描述符
+		// 新的资源使用新的索引，旧的索引与旧的内存块一样等到当前帧的围栏完成后再回收
+		// 共用默认纹理索引的纹理分配自己的索引，不能回收默认纹理的索引
+		auto index = SharesDefaultDescriptorIndex(texture) ?
+			m_BindlessIndices.Allocate() :
+			m_BindlessIndices.Reallocate(texture.GetDescriptorIndex());
+		// 索引用完时保留旧的索引，在原处覆盖描述符，执行中的帧可能提前读到内容相同的新资源
+		if (index != BindlessIndexTable::InvalidIndex) {
+			texture.SetDescriptorIndex(index);
+		}
+
+		// CPU 描述符只作为复制的来源，复制时会立即读取，可在原处重建，
+		// 但环形描述符堆中按该描述符缓存的描述符表需要失效
+		UpdateSRV(texture);
+		m_DescriptorAllocator->InvalidateCachedTables();
+	}
+
+	void TextureManager::AllocateDescriptorIndex(Texture& texture)
+	{
+		if (texture.GetDescriptorIndex() != BindlessIndexTable::InvalidIndex) return;
+
+		auto index = m_BindlessIndices.Allocate();
+		// 索引用完时共用默认纹理的索引，着色器采样默认纹理而不是越界读取
+		if (index == BindlessIndexTable::InvalidIndex) {
+			index = GetDefaultDescriptorIndex();
+		}
+		texture.SetDescriptorIndex(index);
+	}
+
+	std::uint32_t TextureManager::GetDefaultDescriptorIndex() const
+	{
+		auto it = m_Textures.find("DefaultTexture");
+		return it != m_Textures.end() ? it->second.GetDescriptorIndex() : BindlessIndexTable::InvalidIndex;
+	}
+
+	bool TextureManager::SharesDefaultDescriptorIndex(const Texture& texture) const
+	{
+		return texture.GetName() != "DefaultTexture" && texture.GetDescriptorIndex() == GetDefaultDescriptorIndex();
+	}
+
+	void TextureManager::UpdateBindlessDescriptor(const Texture& texture)
+	{
+		// 常驻区域中的索引在回收前不会被复用，写入时没有执行中的帧在读取
+		// 没有索引或共用默认纹理索引的纹理不写入，以免覆盖默认纹理
+		if (m_BindlessTable != nullptr &&
+			texture.GetDescriptorIndex() != BindlessIndexTable::InvalidIndex &&
+			!SharesDefaultDescriptorIndex(texture)) {
+			m_BindlessTable->CopyToStatic(texture.GetDescriptorIndex(), texture.GetSRV());
+		}
 	}
 }
@@ -3,14 +3,22 @@
 #define __TEXTUREMANAGER__H__
 
 #include "Singleton.h"
+#include "BindlessIndexTable.h"
 #include "Texture.h"
 #include "D3D12Allocatioin.h"
+#include "D3D12Defragmenter.h"
+#include "D3D12DescriptorAllocator.h"
 #include "FrameResource.h"
 
 namespace DSM {
 	class TextureManager : public Singleton<TextureManager>
 	{
 	public:
+		inline static constexpr std::uint32_t DefragmentInterval = 600;            // 两次整理规划之间的帧数
+		inline static constexpr std::uint64_t DefragmentByteBudget = 1024 * 1024 * 8; // 每帧最多复制的字节数
+		inline static constexpr std::uint32_t MaxBindlessTextures = 1024;            // 无绑定纹理的最大数量
+
+
 		const Texture* LoadTextureFromFile(
 			const std::string& fileName,
 			ID3D12GraphicsCommandList* cmdList);
@@ -29,21 +37,48 @@ namespace DSM {
 		const std::unordered_map<std::string, Texture>& GetAllTextures() noexcept;
 		D3D12DescriptorHandle GetTextureResourceView(const std::string& texName) const;
 		D3D12DescriptorHandle GetDefaultTextureResourceView() const;
+		// 纹理在无绑定描述符范围中的索引，不存在则返回默认纹理的索引
+		std::uint32_t GetTextureDescriptorIndex(const std::string& texName) const;
+		// 不存在则返回默认纹理，指针在纹理存在期间保持不变，可在加载时解析后每帧使用
+		const Texture* GetTexture(const std::string& texName) const;
 		ID3D12DescriptorHeap* GetDescriptorHeap() const;
 
+		// 回收围栏已完成的纹理、上传堆与无绑定索引
+		void ClearUpAllocations();
+		void GetAllocatorStats(std::vector<AllocatorStats>& stats) const;
+		// 定期整理纹理所在的堆，整理进行中时每帧在预算内推进
+		void Defragment(ID3D12GraphicsCommandList* cmdList);
+		// 关联以纹理的 SRV 为来源的环形描述符堆，纹理的 SRV 重建后使其缓存失效
+		void AddDescriptorRing(D3D12DescriptorRing* descriptorRing);
+		// 设置存放无绑定纹理的描述符堆，所有纹理的 SRV 按描述符索引复制到其常驻区域
+		void SetBindlessTable(D3D12DescriptorRing* descriptorRing);
+
 	protected:
 		friend class Singleton<TextureManager>;
-		TextureManager(ID3D12Device* device, ID3D12GraphicsCommandList* cmdList);
+		TextureManager(ID3D12Device* device, ID3D12GraphicsCommandList* cmdList, IFence* fence);
 		virtual ~TextureManager() = default;
 
 		void CreateSRV(Texture& texture);
+		void UpdateSRV(const Texture& texture);
+		void RegisterMovable(Texture& texture);
+		void OnTextureMoved(Texture& texture);
+		void AllocateDescriptorIndex(Texture& texture);
+		// 默认纹理尚未创建时返回 InvalidIndex
+		std::uint32_t GetDefaultDescriptorIndex() const;
+		bool SharesDefaultDescriptorIndex(const Texture& texture) const;
+		void UpdateBindlessDescriptor(const Texture& texture);
 
 	protected:
 		Microsoft::WRL::ComPtr<ID3D12Device> m_Device;
 		
 		std::unique_ptr<D3D12UploadBufferAllocator> m_UploadBufferAllocator;
 		std::unique_ptr<D3D12TextureAllocator> m_TextureAllocator;
-		std::unique_ptr<D3D12DescriptorHeap> m_DescriptorHeap;
+		std::unique_ptr<D3D12DescriptorAllocator> m_DescriptorAllocator;
+		// 整理后被替换的无绑定索引在围栏完成后才回收
+		BindlessIndexTable m_BindlessIndices;
+		D3D12DescriptorRing* m_BindlessTable = nullptr;
+		std::unique_ptr<D3D12Defragmenter> m_Defragmenter;
+		std::uint32_t m_FramesSinceDefragment = 0;
 		
 		std::unordered_map<std::string, Texture> m_Textures;
 	};
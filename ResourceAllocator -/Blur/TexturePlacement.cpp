@@ -0,0 +1,33 @@
+#include "TexturePlacement.h"
+
+namespace DSM {
+	TexturePlacementInfo GetTexturePlacementInfo(
+		const D3D12_RESOURCE_DESC& textureDesc,
+		const ResourceAllocationInfoProvider& provider)
+	{
+		TexturePlacementInfo placement{ textureDesc, 0, 0 };
+
+		// 渲染目标、深度模板与多重采样纹理不能使用小对齐
+		const auto rtdsFlags = D3D12_RESOURCE_FLAG_ALLOW_RENDER_TARGET | D3D12_RESOURCE_FLAG_ALLOW_DEPTH_STENCIL;
+		bool canUseSmallAlignment = textureDesc.Dimension != D3D12_RESOURCE_DIMENSION_BUFFER &&
+			(textureDesc.Flags & rtdsFlags) == 0 &&
+			textureDesc.SampleDesc.Count <= 1;
+		if (canUseSmallAlignment) {
+			placement.m_Desc.Alignment = D3D12_SMALL_RESOURCE_PLACEMENT_ALIGNMENT;
+			auto info = provider(placement.m_Desc);
+			// 不支持时返回的对齐为 64KB
+			if (info.Alignment == D3D12_SMALL_RESOURCE_PLACEMENT_ALIGNMENT) {
+				placement.m_SizeInBytes = info.SizeInBytes;
+				placement.m_Alignment = info.Alignment;
+				return placement;
+			}
+		}
+
+		// 保留调用者指定的对齐，0 表示使用默认对齐
+		placement.m_Desc.Alignment = textureDesc.Alignment == D3D12_SMALL_RESOURCE_PLACEMENT_ALIGNMENT ? 0 : textureDesc.Alignment;
+		auto info = provider(placement.m_Desc);
+		placement.m_SizeInBytes = info.SizeInBytes;
+		placement.m_Alignment = info.Alignment;
+		return placement;
+	}
+}
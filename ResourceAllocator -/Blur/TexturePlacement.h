@@ -0,0 +1,25 @@
+#pragma once
+#ifndef __TEXTUREPLACEMENT__H__
+#define __TEXTUREPLACEMENT__H__
+
+#include <d3d12.h>
+#include <functional>
+
+namespace DSM {
+	// 查询资源在堆中所需的大小与对齐，通常为 ID3D12Device::GetResourceAllocationInfo
+	using ResourceAllocationInfoProvider = std::function<D3D12_RESOURCE_ALLOCATION_INFO(const D3D12_RESOURCE_DESC&)>;
+
+	struct TexturePlacementInfo
+	{
+		D3D12_RESOURCE_DESC m_Desc;     // 创建资源时使用的描述，包含最终选择的对齐
+		UINT64 m_SizeInBytes;
+		UINT64 m_Alignment;
+	};
+
+	// 先尝试 4KB 的小对齐，资源不满足小对齐的条件时回退到默认的 64KB
+	TexturePlacementInfo GetTexturePlacementInfo(
+		const D3D12_RESOURCE_DESC& textureDesc,
+		const ResourceAllocationInfoProvider& provider);
+}
+
+#endif
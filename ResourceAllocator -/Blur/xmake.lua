@@ -8,6 +8,7 @@ target(targetName)
     
     add_rules("Imguiini")
     add_rules("ShaderCopy")
+    add_rules("ShaderHotReload")
     add_rules("ModelCopy")
     add_rules("TextureCopy")
 
@@ -0,0 +1,285 @@
+#include "TestFramework.h"
+#include "AllocatorStats.h"
+#include <cctype>
+#include <cmath>
+#include <string_view>
+
+using namespace DSM;
+
+namespace {
+	// 只检查语法的 JSON 解析器，足以发现未转义的字符、缺失的分隔符与非有限的数值
+	class JsonChecker
+	{
+	public:
+		explicit JsonChecker(std::string_view json) : m_Json(json) {}
+
+		bool IsValid()
+		{
+			if (!ParseValue()) return false;
+			SkipSpace();
+			return m_Pos == m_Json.size();
+		}
+
+	private:
+		void SkipSpace()
+		{
+			while (m_Pos < m_Json.size() && std::isspace(static_cast<unsigned char>(m_Json[m_Pos]))) ++m_Pos;
+		}
+
+		bool Consume(char c)
+		{
+			SkipSpace();
+			if (m_Pos < m_Json.size() && m_Json[m_Pos] == c) {
+				++m_Pos;
+				return true;
+			}
+			return false;
+		}
+
+		bool ParseValue()
+		{
+			SkipSpace();
+			if (m_Pos >= m_Json.size()) return false;
+			switch (m_Json[m_Pos]) {
+			case '{': return ParseObject();
+			case '[': return ParseArray();
+			case '"': return ParseString();
+			default: return ParseNumber();
+			}
+		}
+
+		bool ParseObject()
+		{
+			Consume('{');
+			if (Consume('}')) return true;
+			do {
+				SkipSpace();
+				if (!ParseString() || !Consume(':') || !ParseValue()) return false;
+			} while (Consume(','));
+			return Consume('}');
+		}
+
+		bool ParseArray()
+		{
+			Consume('[');
+			if (Consume(']')) return true;
+			do {
+				if (!ParseValue()) return false;
+			} while (Consume(','));
+			return Consume(']');
+		}
+
+		bool ParseString()
+		{
+			if (m_Pos >= m_Json.size() || m_Json[m_Pos] != '"') return false;
+			++m_Pos;
+			while (m_Pos < m_Json.size()) {
+				auto c = static_cast<unsigned char>(m_Json[m_Pos++]);
+				if (c == '"') return true;
+				if (c < 0x20) return false;
+				if (c != '\\') continue;
+				if (m_Pos >= m_Json.size()) return false;
+				auto escape = m_Json[m_Pos++];
+				if (escape == 'u') {
+					for (int i = 0; i < 4; ++i) {
+						if (m_Pos >= m_Json.size() || !std::isxdigit(static_cast<unsigned char>(m_Json[m_Pos++]))) return false;
+					}
+				}
+				else if (std::string_view("\"\\/bfnrt").find(escape) == std::string_view::npos) {
+					return false;
+				}
+			}
+			return false;
+		}
+
+		bool ParseNumber()
+		{
+			auto start = m_Pos;
+			auto digits = [this]() {
+				auto begin = m_Pos;
+				while (m_Pos < m_Json.size() && std::isdigit(static_cast<unsigned char>(m_Json[m_Pos]))) ++m_Pos;
+				return m_Pos > begin;
+				};
+			if (m_Pos < m_Json.size() && m_Json[m_Pos] == '-') ++m_Pos;
+			if (!digits()) return false;
+			if (m_Pos < m_Json.size() && m_Json[m_Pos] == '.') {
+				++m_Pos;
+				if (!digits()) return false;
+			}
+			if (m_Pos < m_Json.size() && (m_Json[m_Pos] == 'e' || m_Json[m_Pos] == 'E')) {
+				++m_Pos;
+				if (m_Pos < m_Json.size() && (m_Json[m_Pos] == '+' || m_Json[m_Pos] == '-')) ++m_Pos;
+				if (!digits()) return false;
+			}
+			return m_Pos > start;
+		}
+
+	private:
+		std::string_view m_Json;
+		std::size_t m_Pos = 0;
+	};
+
+	bool IsValidJson(std::string_view json)
+	{
+		return JsonChecker(json).IsValid();
+	}
+
+	BuddyPoolStats MakePool(
+		std::uint64_t poolSize,
+		std::uint64_t requested,
+		std::uint64_t reserved,
+		std::uint64_t largestFree,
+		std::vector<std::uint64_t> freePerOrder)
+	{
+		BuddyPoolStats pool{};
+		pool.m_PoolSize = poolSize;
+		pool.m_RequestedBytes = requested;
+		pool.m_ReservedBytes = reserved;
+		pool.m_LargestFreeBlock = largestFree;
+		pool.m_LiveAllocations = requested == 0 ? 0 : 1;
+		pool.m_FreeBytesPerOrder = std::move(freePerOrder);
+		return pool;
+	}
+}
+
+TEST_CASE(AllocatorStats_AddPool)
+{
+	AllocatorStats stats{};
+	stats.AddPool(MakePool(1024, 300, 512, 512, { 0, 0, 512 }));
+	stats.AddPool(MakePool(2048, 100, 256, 1024, { 256, 512, 0, 1024 }));
+
+	CHECK(stats.m_PoolCount == 2);
+	CHECK(stats.m_PoolBytes == 3072);
+	CHECK(stats.m_RequestedBytes == 400);
+	CHECK(stats.m_ReservedBytes == 768);
+	CHECK(stats.m_InternalWaste == 368);
+	CHECK(stats.m_LargestFreeBlock == 1024);
+	CHECK(stats.m_LiveAllocations == 2);
+	// 逐层级累加，较短的数组按 0 补齐
+	CHECK((stats.m_FreeBytesPerOrder == std::vector<std::uint64_t>{ 256, 512, 512, 1024 }));
+	CHECK(stats.m_Pools.size() == 2);
+	// AddPool 不负责峰值，由分配器在分配时记录
+	CHECK(stats.m_HighWaterMark == 0);
+}
+
+TEST_CASE(AllocatorStats_MergeHighWaterMark)
+{
+	AllocatorStats a{};
+	a.AddPool(MakePool(1024, 200, 256, 512, { 0, 256, 512 }));
+	a.m_HighWaterMark = 900;
+	a.m_TotalAllocations = 10;
+	a.m_TotalFrees = 4;
+	a.m_AllocationRate = 2;
+	a.m_FreeRate = 1;
+
+	AllocatorStats b{};
+	b.AddPool(MakePool(1024, 500, 768, 256, { 0, 256 }));
+	b.m_HighWaterMark = 800;
+	b.m_TotalAllocations = 3;
+	b.m_TotalFrees = 1;
+	b.m_AllocationRate = 0.5;
+	b.m_FreeRate = 0.25;
+
+	AllocatorStats merged{};
+	merged.Merge(a);
+	merged.Merge(b);
+	CHECK(merged.m_PoolCount == 2);
+	CHECK(merged.m_PoolBytes == 2048);
+	CHECK(merged.m_ReservedBytes == 1024);
+	CHECK(merged.m_InternalWaste == 1024 - 700);
+	CHECK(merged.m_TotalAllocations == 13);
+	CHECK(merged.m_TotalFrees == 5);
+	CHECK(merged.m_AllocationRate == 2.5);
+	CHECK(merged.m_FreeRate == 1.25);
+	CHECK(merged.m_Pools.size() == 2);
+	// 峰值不是简单相加，当前合并后的占用 1024 超过了任意一方的峰值
+	CHECK(merged.m_HighWaterMark == 1024);
+
+	// 某一方的峰值更大时保留该峰值
+	AllocatorStats c{};
+	c.m_HighWaterMark = 4096;
+	merged.Merge(c);
+	CHECK(merged.m_HighWaterMark == 4096);
+	CHECK(merged.m_ReservedBytes == 1024);
+}
+
+TEST_CASE(AllocatorStats_ComputeRates)
+{
+	AllocatorStats previous{};
+	previous.m_TotalAllocations = 100;
+	previous.m_TotalFrees = 40;
+
+	AllocatorStats current{};
+	current.m_TotalAllocations = 160;
+	current.m_TotalFrees = 70;
+	current.ComputeRates(previous, 2.0);
+	CHECK(current.m_AllocationRate == 30);
+	CHECK(current.m_FreeRate == 15);
+
+	// 时间没有前进时保留原来的速率
+	current.ComputeRates(previous, 0);
+	CHECK(current.m_AllocationRate == 30);
+
+	// 计数比上一次小时（例如分配器被重建）速率为 0 而不是溢出
+	AllocatorStats reset{};
+	reset.m_TotalAllocations = 5;
+	reset.ComputeRates(previous, 1.0);
+	CHECK(reset.m_AllocationRate == 0);
+	CHECK(reset.m_FreeRate == 0);
+}
+
+TEST_CASE(AllocatorStats_Fragmentation)
+{
+	AllocatorStats empty{};
+	CHECK(empty.GetFragmentation() == 0);
+
+	// 空闲内存都在最大的空闲块中时没有碎片
+	AllocatorStats single{};
+	single.AddPool(MakePool(1024, 512, 512, 512, { 0, 0, 512 }));
+	CHECK(single.GetFragmentation() == 0);
+
+	// 空闲 512 中最大块只有 256
+	AllocatorStats split{};
+	split.AddPool(MakePool(1024, 512, 512, 256, { 0, 256, 256 }));
+	CHECK(std::abs(split.GetFragmentation() - 0.5) < 1e-9);
+
+	// 按分配器分别计算最大块，不能用某个分配器的最大块覆盖其他分配器的空闲内存
+	AllocatorStats pools{};
+	pools.AddPool(MakePool(4096, 0, 0, 4096, { 0, 0, 0, 0, 4096 }));
+	pools.AddPool(MakePool(1024, 512, 512, 256, { 0, 256, 256 }));
+	CHECK(std::abs(pools.GetFragmentation() - 256.0 / 4608.0) < 1e-9);
+
+	// 没有逐层级统计的分配器以总大小与占用之差作为空闲大小
+	AllocatorStats noOrders{};
+	noOrders.AddPool(MakePool(1000, 400, 400, 300, {}));
+	CHECK(std::abs(noOrders.GetFragmentation() - 0.5) < 1e-9);
+}
+
+TEST_CASE(AllocatorStats_JsonIsValid)
+{
+	AllocatorStats stats{};
+	// 名称中包含需要转义的字符
+	stats.m_Name = "Texture \"Atlas\" C:\\tex\n\t\x01";
+	stats.AddPool(MakePool(1024, 300, 512, 256, { 0, 256, 256 }));
+	stats.AddPool(MakePool(1024, 0, 0, 1024, {}));
+	stats.m_HighWaterMark = 512;
+	stats.m_AllocationRate = 1.0 / 3.0;
+	stats.m_FreeRate = 1e20;
+
+	auto json = stats.ToJson();
+	CHECK(IsValidJson(json));
+	CHECK(json.find("\"name\":\"Texture \\\"Atlas\\\" C:\\\\tex\\n\\t\\u0001\"") != std::string::npos);
+	CHECK(json.find("\"poolCount\":2") != std::string::npos);
+	CHECK(json.find("\"freeBytesPerOrder\":[0,256,256]") != std::string::npos);
+
+	AllocatorStats emptyStats{};
+	CHECK(IsValidJson(emptyStats.ToJson()));
+	CHECK(IsValidJson(AllocatorStatsToJson({})));
+	CHECK(IsValidJson(AllocatorStatsToJson({ stats, emptyStats, stats })));
+
+	// 校验器本身能发现错误
+	CHECK(!IsValidJson("{\"a\":1,}"));
+	CHECK(!IsValidJson("{\"a\":\"\n\"}"));
+	CHECK(!IsValidJson("[1 2]"));
+	CHECK(!IsValidJson("{\"a\":nan}"));
+}
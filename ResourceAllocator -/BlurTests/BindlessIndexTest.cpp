@@ -0,0 +1,113 @@
+#include "TestFramework.h"
+#include "BindlessIndexTable.h"
+#include "DeferredDeletionQueue.h"
+#include "Fence.h"
+#include <algorithm>
+#include <map>
+#include <random>
+#include <vector>
+
+using namespace DSM;
+
+TEST_CASE(DeferredDeletionQueue_RetiresInFenceOrder)
+{
+	DeferredDeletionQueue<std::uint32_t> queue;
+	queue.Push(1, 10);
+	queue.Push(1, 11);
+	queue.Push(3, 30);
+	std::vector<std::uint32_t> retired;
+	auto collect = [&retired](std::uint32_t item) { retired.push_back(item); };
+
+	CHECK(queue.Retire(0, collect) == 0);
+	CHECK(queue.Retire(2, collect) == 2);
+	CHECK(retired == std::vector<std::uint32_t>({ 10, 11 }));
+	CHECK(queue.Size() == 1);
+	CHECK(queue.RetireAll(collect) == 1);
+	CHECK(queue.Empty());
+}
+
+TEST_CASE(BindlessIndex_OldIndexWaitsForFence)
+{
+	CPUFence fence;
+	BindlessIndexTable table(2, &fence);
+	auto index = table.Allocate();
+	CHECK(index == 0);
+
+	// 第 1 帧中移动，旧的索引在第 1 帧完成前仍可能被读取
+	auto moved = table.Reallocate(index);
+	CHECK(moved == 1);
+	CHECK(table.GetRetiredCount() == 1);
+	auto frame = fence.Signal();
+	table.ClearUp();
+	CHECK(table.GetUsedCount() == 2);
+	// 索引用完时无法再移动，旧的索引保留
+	CHECK(table.Reallocate(moved) == BindlessIndexTable::InvalidIndex);
+
+	fence.Complete(frame);
+	table.ClearUp();
+	CHECK(table.GetRetiredCount() == 0);
+	CHECK(table.GetUsedCount() == 1);
+	CHECK(table.Reallocate(moved) == 0);
+}
+
+TEST_CASE(BindlessIndex_RandomMovesNeverReuseInFlight)
+{
+	constexpr std::uint32_t Capacity = 64;
+	CPUFence fence;
+	BindlessIndexTable table(Capacity, &fence);
+
+	// 每个纹理当前的索引，以及每个索引最后一次被读取的帧
+	std::vector<std::uint32_t> textures;
+	std::map<std::uint32_t, std::uint64_t> lastReadFrame;
+	for (std::uint32_t i = 0; i < Capacity / 2; ++i) {
+		textures.push_back(table.Allocate());
+	}
+
+	std::mt19937 random(17);
+	std::uint64_t completed = 0;
+	for (int frame = 0; frame < 3000; ++frame) {
+		auto currFrame = fence.GetCurrentValue();
+		for (auto& index : textures) {
+			if (random() % 8 == 0) {
+				auto newIndex = table.Reallocate(index);
+				if (newIndex == BindlessIndexTable::InvalidIndex) continue;
+				// 新的索引不能是仍在执行的帧会读取的索引
+				auto it = lastReadFrame.find(newIndex);
+				CHECK(it == lastReadFrame.end() || it->second <= completed);
+				index = newIndex;
+			}
+		}
+		for (auto index : textures) {
+			lastReadFrame[index] = currFrame;
+		}
+		fence.Signal();
+
+		// GPU 随机落后 0 ~ 3 帧
+		completed = (std::max)(completed, currFrame - (std::min)(currFrame, std::uint64_t{ random() % 4 }));
+		fence.Complete(completed);
+		table.ClearUp();
+		CHECK(table.GetUsedCount() == textures.size() + table.GetRetiredCount());
+	}
+
+	fence.Complete(fence.GetCurrentValue());
+	table.ClearUp();
+	CHECK(table.GetUsedCount() == textures.size());
+}
+
+TEST_CASE(BindlessIndex_ReallocateWithoutOldIndex)
+{
+	CPUFence fence;
+	BindlessIndexTable table(4, &fence);
+	CHECK(table.GetCapacity() == 4);
+
+	// 没有旧的索引时不需要等待围栏
+	auto index = table.Reallocate(BindlessIndexTable::InvalidIndex);
+	CHECK(index != BindlessIndexTable::InvalidIndex);
+	CHECK(table.GetRetiredCount() == 0);
+	CHECK(table.GetUsedCount() == 1);
+
+	for (int i = 0; i < 3; ++i) {
+		CHECK(table.Allocate() != BindlessIndexTable::InvalidIndex);
+	}
+	CHECK(table.Allocate() == BindlessIndexTable::InvalidIndex);
+}
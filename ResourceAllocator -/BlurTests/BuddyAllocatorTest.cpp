@@ -0,0 +1,300 @@
+#include "TestFramework.h"
+#include "BuddyAllocator.h"
+#include <algorithm>
+#include <bit>
+#include <random>
+#include <set>
+#include <vector>
+
+using namespace DSM;
+
+namespace {
+	struct BuddyBlock
+	{
+		std::uint32_t m_Offset;
+		std::uint32_t m_Order;
+	};
+
+	// 逐个最小单位记录占用情况的参考模型
+	class ReferenceBuddy
+	{
+	public:
+		explicit ReferenceBuddy(std::uint32_t unitCount) :m_Used(unitCount, false) {}
+
+		bool IsRangeFree(std::uint32_t offset, std::uint32_t count) const
+		{
+			return std::none_of(m_Used.begin() + offset, m_Used.begin() + offset + count, [](bool used) { return used; });
+		}
+
+		void Mark(std::uint32_t offset, std::uint32_t count, bool used)
+		{
+			std::fill(m_Used.begin() + offset, m_Used.begin() + offset + count, used);
+		}
+
+		// 存在按自身大小对齐的空闲范围时，合并完全的 Buddy 分配器一定能分配成功
+		bool HasAlignedFreeRange(std::uint32_t count) const
+		{
+			for (std::uint32_t offset = 0; offset + count <= m_Used.size(); offset += count) {
+				if (IsRangeFree(offset, count)) return true;
+			}
+			return false;
+		}
+
+	private:
+		std::vector<bool> m_Used;
+	};
+
+	// 原先每个层级一个 std::set 的实现，作为基准的对照
+	class SetBuddyAllocator
+	{
+	public:
+		explicit SetBuddyAllocator(std::uint32_t maxOrder) :m_FreeBlocks(maxOrder + 1)
+		{
+			m_FreeBlocks[maxOrder].insert(0);
+		}
+
+		std::uint32_t AllocateBlock(std::uint32_t order)
+		{
+			if (order >= m_FreeBlocks.size()) return BuddyAllocator::InvalidOffset;
+			auto& freeBlocks = m_FreeBlocks[order];
+			if (freeBlocks.empty()) {
+				auto left = AllocateBlock(order + 1);
+				if (left != BuddyAllocator::InvalidOffset) {
+					freeBlocks.insert(left + (1u << order));
+				}
+				return left;
+			}
+			auto offset = *freeBlocks.begin();
+			freeBlocks.erase(freeBlocks.begin());
+			return offset;
+		}
+
+		void DeallocateBlock(std::uint32_t offset, std::uint32_t order)
+		{
+			while (order + 1 < m_FreeBlocks.size()) {
+				auto it = m_FreeBlocks[order].find(offset ^ (1u << order));
+				if (it == m_FreeBlocks[order].end()) break;
+				m_FreeBlocks[order].erase(it);
+				offset &= ~(1u << order);
+				++order;
+			}
+			m_FreeBlocks[order].insert(offset);
+		}
+
+	private:
+		std::vector<std::set<std::uint32_t>> m_FreeBlocks;
+	};
+
+	// 预先分配一批块，之后每次随机释放一块再分配一块新的
+	template <typename Allocator>
+	void RunChurnBenchmark(const char* name, Allocator& allocator)
+	{
+		constexpr std::uint32_t OpsPerIteration = 1 << 16;
+
+		std::mt19937 random(42);
+		std::vector<std::uint32_t> orders(OpsPerIteration);
+		for (auto& order : orders) {
+			order = std::min<std::uint32_t>(std::countr_zero(random() | (1u << 6)), 6);
+		}
+
+		std::vector<BuddyBlock> blocks;
+		for (std::uint32_t i = 0; i < 4096; ++i) {
+			auto order = orders[i];
+			blocks.push_back({ allocator.AllocateBlock(order), order });
+		}
+
+		std::uint32_t next = 0;
+		Test::Benchmark(name, OpsPerIteration, [&]() {
+			std::uint64_t sum = 0;
+			for (std::uint32_t i = 0; i < OpsPerIteration; ++i) {
+				auto& block = blocks[(next * 2654435761u) % blocks.size()];
+				allocator.DeallocateBlock(block.m_Offset, block.m_Order);
+				block.m_Order = orders[i];
+				block.m_Offset = allocator.AllocateBlock(block.m_Order);
+				sum += block.m_Offset;
+				++next;
+			}
+			Test::DoNotOptimize(sum);
+			});
+	}
+}
+
+TEST_CASE(BuddyAllocator_UnitConversions)
+{
+	BuddyAllocator allocator(256, 256 * 16);
+	CHECK(allocator.GetMaxOrder() == 4);
+	CHECK(allocator.SizeToUnitSize(1) == 1);
+	CHECK(allocator.SizeToUnitSize(256) == 1);
+	CHECK(allocator.SizeToUnitSize(257) == 2);
+	CHECK(allocator.UnitSizeToOrder(0) == 0);
+	CHECK(allocator.UnitSizeToOrder(1) == 0);
+	CHECK(allocator.UnitSizeToOrder(2) == 1);
+	CHECK(allocator.UnitSizeToOrder(3) == 2);
+	CHECK(allocator.UnitSizeToOrder(16) == 4);
+	CHECK(allocator.OrderToUnitSize(3) == 8);
+	CHECK(allocator.UnitSizeToSize(3) == 768);
+}
+
+TEST_CASE(BuddyAllocator_BookkeepingSize)
+{
+	// 512MB、256B 粒度：链表 2M 个单位各 8 字节，位图 4M 个节点各 1 位
+	BuddyAllocator allocator(256, 1024 * 1024 * 512);
+	auto unitCount = std::size_t(1024) * 1024 * 2;
+	auto expected = unitCount * 8 + unitCount * 2 / 8 + (allocator.GetMaxOrder() + 1) * 8;
+	CHECK(allocator.GetBookkeepingSize() == expected);
+	CHECK(allocator.GetBookkeepingSize() < 1024 * 1024 * 17);
+}
+
+TEST_CASE(BuddyAllocator_NonPowerOfTwoRangeRoundsDown)
+{
+	// 6 个最小块向下取整为 4 个，超出的部分不会被分配
+	BuddyAllocator allocator(256, 256 * 6);
+	CHECK(allocator.GetMaxBlockSize() == 1024);
+	CHECK(allocator.GetMaxOrder() == 2);
+	CHECK(allocator.AllocateBlock(3) == BuddyAllocator::InvalidOffset);
+
+	std::vector<std::uint32_t> offsets;
+	for (std::uint32_t offset; (offset = allocator.AllocateBlock(0)) != BuddyAllocator::InvalidOffset;) {
+		CHECK(offset < 4);
+		offsets.push_back(offset);
+	}
+	CHECK(offsets.size() == 4);
+	for (auto offset : offsets) {
+		allocator.DeallocateBlock(offset, 0);
+	}
+	CHECK(allocator.IsEmpty());
+}
+
+TEST_CASE(BuddyAllocator_SplitAndMerge)
+{
+	BuddyAllocator allocator(256, 256 * 16);
+	CHECK(allocator.IsEmpty());
+	CHECK(allocator.GetFreeBlockCount(4) == 1);
+	CHECK(allocator.GetLargestFreeBlockSize() == 256 * 16);
+
+	// 拆分最大块时每一层留下一个空闲的右块
+	auto offset = allocator.AllocateBlock(0);
+	CHECK(offset == 0);
+	for (std::uint32_t order = 0; order < 4; ++order) {
+		CHECK(allocator.GetFreeBlockCount(order) == 1);
+	}
+	CHECK(allocator.GetFreeBlockCount(4) == 0);
+	CHECK(allocator.GetLargestFreeBlockSize() == 256 * 8);
+	CHECK(allocator.GetAllocatedSize() == 256);
+
+	// 释放后逐级合并回最大块
+	allocator.DeallocateBlock(offset, 0);
+	CHECK(allocator.IsEmpty());
+	CHECK(allocator.GetFreeBlockCount(4) == 1);
+	for (std::uint32_t order = 0; order < 4; ++order) {
+		CHECK(allocator.GetFreeBlockCount(order) == 0);
+	}
+
+	// 占满后再分配失败
+	std::vector<std::uint32_t> offsets;
+	for (std::uint32_t i = 0; i < 16; ++i) {
+		offsets.push_back(allocator.AllocateBlock(0));
+	}
+	std::sort(offsets.begin(), offsets.end());
+	for (std::uint32_t i = 0; i < 16; ++i) {
+		CHECK(offsets[i] == i);
+	}
+	CHECK(allocator.AllocateBlock(0) == BuddyAllocator::InvalidOffset);
+	CHECK(allocator.GetLargestFreeBlockSize() == 0);
+
+	// 伙伴未释放时不合并
+	allocator.DeallocateBlock(1, 0);
+	allocator.DeallocateBlock(2, 0);
+	CHECK(allocator.GetFreeBlockCount(0) == 2);
+	CHECK(allocator.AllocateBlock(1) == BuddyAllocator::InvalidOffset);
+	allocator.DeallocateBlock(3, 0);
+	CHECK(allocator.GetFreeBlockCount(0) == 1);
+	CHECK(allocator.GetFreeBlockCount(1) == 1);
+	CHECK(allocator.AllocateBlock(1) == 2);
+}
+
+TEST_CASE(BuddyAllocator_IsAllocatedBlock)
+{
+	BuddyAllocator allocator(256, 256 * 4);
+	auto left = allocator.AllocateBlock(1);
+	CHECK(left == 0);
+	CHECK(allocator.IsAllocatedBlock(0, 1));
+	// 未对齐、越界、父块与子块都不是已分配的块
+	CHECK(!allocator.IsAllocatedBlock(1, 1));
+	CHECK(!allocator.IsAllocatedBlock(4, 0));
+	CHECK(!allocator.IsAllocatedBlock(0, 2));
+	CHECK(!allocator.IsAllocatedBlock(0, 3));
+	// 空闲的右块
+	CHECK(!allocator.IsAllocatedBlock(2, 1));
+
+	auto small = allocator.AllocateBlock(0);
+	CHECK(small == 2);
+	// 子树中仍有空闲块
+	CHECK(!allocator.IsAllocatedBlock(2, 1));
+	CHECK(allocator.IsAllocatedBlock(2, 0));
+	CHECK(!allocator.IsAllocatedBlock(3, 0));
+
+	allocator.DeallocateBlock(left, 1);
+	allocator.DeallocateBlock(small, 0);
+	CHECK(allocator.IsEmpty());
+	CHECK(!allocator.IsAllocatedBlock(0, 0));
+	CHECK(!allocator.IsAllocatedBlock(0, 2));
+}
+
+TEST_CASE(BuddyAllocator_RandomAgainstReference)
+{
+	constexpr std::uint32_t MaxOrder = 10;
+	BuddyAllocator allocator(64, 64u << MaxOrder);
+	ReferenceBuddy reference(1u << MaxOrder);
+	std::vector<BuddyBlock> blocks;
+	std::size_t allocatedUnits = 0;
+
+	std::mt19937 random(1234);
+	for (int step = 0; step < 20000; ++step) {
+		bool allocate = blocks.empty() || random() % 100 < 55;
+		if (allocate) {
+			// 小块更常见
+			auto order = std::min<std::uint32_t>(std::countr_zero(random() | (1u << MaxOrder)), MaxOrder);
+			auto count = 1u << order;
+			auto offset = allocator.AllocateBlock(order);
+			if (offset == BuddyAllocator::InvalidOffset) {
+				CHECK(!reference.HasAlignedFreeRange(count));
+				continue;
+			}
+			CHECK(offset % count == 0);
+			CHECK(offset + count <= (1u << MaxOrder));
+			CHECK(reference.IsRangeFree(offset, count));
+			CHECK(allocator.IsAllocatedBlock(offset, order));
+			reference.Mark(offset, count, true);
+			blocks.push_back({ offset, order });
+			allocatedUnits += count;
+		}
+		else {
+			auto index = random() % blocks.size();
+			auto block = blocks[index];
+			blocks[index] = blocks.back();
+			blocks.pop_back();
+
+			allocator.DeallocateBlock(block.m_Offset, block.m_Order);
+			reference.Mark(block.m_Offset, 1u << block.m_Order, false);
+			allocatedUnits -= 1u << block.m_Order;
+		}
+		CHECK(allocator.GetAllocatedSize() == allocatedUnits * 64);
+	}
+
+	for (const auto& block : blocks) {
+		allocator.DeallocateBlock(block.m_Offset, block.m_Order);
+	}
+	CHECK(allocator.IsEmpty());
+	CHECK(allocator.GetFreeBlockCount(MaxOrder) == 1);
+}
+
+BENCHMARK(BuddyAllocator_Churn)
+{
+	constexpr std::uint32_t MaxOrder = 16;
+	BuddyAllocator allocator(256, 256u << MaxOrder);
+	RunChurnBenchmark("BuddyAllocator allocate + free", allocator);
+
+	SetBuddyAllocator setAllocator(MaxOrder);
+	RunChurnBenchmark("std::set free lists allocate + free", setAllocator);
+}
@@ -0,0 +1,438 @@
+#include "TestFramework.h"
+#include "BuddyAllocator.h"
+#include "BuddyPoolSet.h"
+#include "DeferredDeletionQueue.h"
+#include "Fence.h"
+#include <algorithm>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+using namespace DSM;
+
+namespace {
+	constexpr std::size_t KB = 1024;
+	constexpr std::size_t MB = 1024 * 1024;
+
+	struct FakeBlock
+	{
+		std::uint32_t m_PoolIndex = UINT32_MAX;
+		std::uint32_t m_Offset = 0;
+		std::uint32_t m_Order = 0;
+		std::uint32_t m_Size = 0;
+	};
+
+	// 与 D3D12BuddyAllocator 相同的簿记与延迟回收，但不创建任何设备资源
+	class FakeBuddyPool
+	{
+	public:
+		FakeBuddyPool(const BuddyPoolDesc& desc, IFence* fence)
+			:m_Blocks(BuddyPoolSet<FakeBuddyPool>::MinBlockSize, desc.m_MaxBlockSize),
+			m_BackingSize(desc.m_BackingSize == 0 ? m_Blocks.GetMaxBlockSize() : desc.m_BackingSize),
+			m_Fence(fence) {
+		}
+
+		bool Allocate(std::uint32_t size, FakeBlock& block)
+		{
+			auto order = m_Blocks.UnitSizeToOrder(m_Blocks.SizeToUnitSize(size));
+			auto offset = m_Blocks.AllocateBlock(order);
+			if (offset == BuddyAllocator::InvalidOffset) return false;
+			// 专用分配器只创建了部分块
+			if (m_Blocks.UnitSizeToSize(offset) + size > m_BackingSize) {
+				m_Blocks.DeallocateBlock(offset, order);
+				return false;
+			}
+			block.m_Offset = offset;
+			block.m_Order = order;
+			block.m_Size = size;
+			m_RequestedBytes += size;
+			++m_LiveAllocations;
+			return true;
+		}
+
+		void Deallocate(const FakeBlock& block)
+		{
+			m_Deferred.Push(m_Fence->GetCurrentValue(), block);
+		}
+
+		std::size_t ClearUpAllocations()
+		{
+			return m_Deferred.Retire(m_Fence->GetCompletedValue(), [this](FakeBlock& block) {
+				m_Blocks.DeallocateBlock(block.m_Offset, block.m_Order);
+				m_RequestedBytes -= block.m_Size;
+				--m_LiveAllocations;
+				});
+		}
+
+		bool IsEmpty() const { return m_LiveAllocations == 0; }
+		std::size_t GetReservedSize() const { return (std::min)(m_Blocks.GetAllocatedSize(), m_BackingSize); }
+		std::size_t GetBackingSize() const { return m_BackingSize; }
+
+		void GetStats(BuddyPoolStats& stats) const
+		{
+			stats.m_PoolSize = m_BackingSize;
+			stats.m_RequestedBytes = m_RequestedBytes;
+			stats.m_ReservedBytes = GetReservedSize();
+			stats.m_LargestFreeBlock = m_Blocks.GetLargestFreeBlockSize();
+			stats.m_LiveAllocations = m_LiveAllocations;
+		}
+
+	private:
+		BuddyAllocator m_Blocks;
+		std::size_t m_BackingSize;
+		IFence* m_Fence;
+		DeferredDeletionQueue<FakeBlock> m_Deferred;
+		std::uint64_t m_RequestedBytes = 0;
+		std::uint64_t m_LiveAllocations = 0;
+	};
+
+	using FakePoolSet = BuddyPoolSet<FakeBuddyPool>;
+
+	// 以 CPUFence 模拟若干帧在 GPU 上执行
+	class PoolSetHarness
+	{
+	public:
+		explicit PoolSetHarness(std::size_t poolSize, std::uint32_t trimIdleFrames = FakePoolSet::DefaultTrimIdleFrames)
+			:m_Pools([this](const BuddyPoolDesc& desc) {
+				++m_CreatedPools;
+				return std::make_shared<FakeBuddyPool>(desc, &m_Fence);
+				}, poolSize, trimIdleFrames) {
+		}
+
+		FakeBlock Allocate(std::uint32_t size)
+		{
+			FakeBlock block{};
+			block.m_PoolIndex = m_Pools.Allocate(size, [&](FakeBuddyPool& pool) { return pool.Allocate(size, block); });
+			return block;
+		}
+
+		void Deallocate(const FakeBlock& block)
+		{
+			auto pool = m_Pools.GetPool(block.m_PoolIndex);
+			CHECK(pool != nullptr);
+			pool->Deallocate(block);
+		}
+
+		// 结束一帧，GPU 落后 latency 帧，之后回收
+		void EndFrame(std::uint64_t latency)
+		{
+			auto fenceValue = m_Fence.Signal();
+			m_Fence.Complete(fenceValue > latency ? fenceValue - latency : 0);
+			m_Pools.ClearUpAllocations();
+		}
+
+		CPUFence m_Fence;
+		std::uint32_t m_CreatedPools = 0;
+		FakePoolSet m_Pools;
+	};
+}
+
+TEST_CASE(BuddyPoolSet_RoutingAndPoolDesc)
+{
+	using SizeClass = FakePoolSet::SizeClass;
+	PoolSetHarness harness(64 * MB);
+	auto& pools = harness.m_Pools;
+	CHECK(pools.GetSizeClass(FakePoolSet::SmallAllocationSize) == SizeClass::Small);
+	CHECK(pools.GetSizeClass(FakePoolSet::SmallAllocationSize + 1) == SizeClass::Normal);
+	CHECK(pools.GetSizeClass(32 * MB + 1) == SizeClass::Dedicated);
+
+	auto smallDesc = pools.GetPoolDesc(SizeClass::Small, 1);
+	CHECK(smallDesc.m_MaxBlockSize == FakePoolSet::MinSmallPoolSize);
+	CHECK(smallDesc.m_BackingSize == 0);
+	CHECK(pools.GetPoolDesc(SizeClass::Normal, 1).m_MaxBlockSize == 64 * MB);
+	// 专用的分配器按 2 的幂划分块，只创建按 64KB 对齐的请求大小
+	auto dedicatedDesc = pools.GetPoolDesc(SizeClass::Dedicated, 40 * MB + 1);
+	CHECK(dedicatedDesc.m_MaxBlockSize == 64 * MB);
+	CHECK(dedicatedDesc.m_BackingSize == 40 * MB + 64 * KB);
+
+	// 没有分配时不创建分配器
+	CHECK(pools.GetPoolCount() == 0);
+	CHECK(harness.m_CreatedPools == 0);
+}
+
+TEST_CASE(BuddyPoolSet_RoutesIntoSameClassPools)
+{
+	using SizeClass = FakePoolSet::SizeClass;
+	PoolSetHarness harness(64 * MB);
+	auto& pools = harness.m_Pools;
+
+	auto small = harness.Allocate(4 * KB);
+	auto normal = harness.Allocate(1 * MB);
+	CHECK(small.m_PoolIndex != normal.m_PoolIndex);
+	CHECK(pools.GetPoolSizeClass(small.m_PoolIndex) == SizeClass::Small);
+	CHECK(pools.GetPoolSizeClass(normal.m_PoolIndex) == SizeClass::Normal);
+
+	// 同类别的请求进入已有的分配器
+	CHECK(harness.Allocate(8 * KB).m_PoolIndex == small.m_PoolIndex);
+	CHECK(harness.Allocate(2 * MB).m_PoolIndex == normal.m_PoolIndex);
+	CHECK(pools.GetPoolCount() == 2);
+
+	// 小分配器用尽后新建同类别的分配器
+	for (std::size_t i = 0; i < FakePoolSet::MinSmallPoolSize / (64 * KB); ++i) {
+		harness.Allocate(64 * KB);
+	}
+	CHECK(pools.GetPoolCount() == 3);
+	CHECK(harness.m_CreatedPools == 3);
+
+	// 在指定的分配器中分配
+	FakeBlock block{};
+	CHECK(pools.AllocateInPool(normal.m_PoolIndex, [&](FakeBuddyPool& pool) { return pool.Allocate(1 * MB, block); }));
+	CHECK(!pools.AllocateInPool(normal.m_PoolIndex, [&](FakeBuddyPool& pool) { return pool.Allocate(128 * MB, block); }));
+	CHECK(!pools.AllocateInPool(pools.GetPoolSlotCount(), [&](FakeBuddyPool&) { return true; }));
+}
+
+TEST_CASE(BuddyPoolSet_TrimIdlePoolsAndReuseSlots)
+{
+	PoolSetHarness harness(64 * MB, 2);
+	auto& pools = harness.m_Pools;
+
+	auto small = harness.Allocate(4 * KB);
+	auto normal = harness.Allocate(1 * MB);
+	CHECK(pools.GetPoolBytes() == FakePoolSet::MinSmallPoolSize + 64 * MB);
+
+	harness.Deallocate(small);
+	// 围栏未完成时内存块仍在延迟删除队列中，分配器不算空闲
+	for (int i = 0; i < 4; ++i) {
+		harness.EndFrame(100);
+	}
+	CHECK(pools.GetPoolCount() == 2);
+
+	// 围栏完成后空闲计数从 0 开始，超过 trimIdleFrames 才释放
+	harness.EndFrame(0);
+	harness.EndFrame(0);
+	CHECK(pools.GetPoolCount() == 2);
+	harness.EndFrame(0);
+	CHECK(pools.GetPoolCount() == 1);
+	CHECK(pools.GetPool(small.m_PoolIndex) == nullptr);
+	CHECK(pools.GetPool(normal.m_PoolIndex) != nullptr);
+	CHECK(pools.GetPoolBytes() == 64 * MB);
+	CHECK(pools.GetReservedBytes() == 1 * MB);
+
+	// 新的分配器复用被回收的位置，已有的索引不变
+	auto reused = harness.Allocate(4 * KB);
+	CHECK(reused.m_PoolIndex == small.m_PoolIndex);
+	CHECK(pools.GetPoolSlotCount() == 2);
+	CHECK(pools.GetPoolCount() == 2);
+
+	// 空闲期间的分配会重置空闲计数
+	harness.Deallocate(normal);
+	harness.EndFrame(0);
+	harness.EndFrame(0);
+	auto again = harness.Allocate(1 * MB);
+	CHECK(again.m_PoolIndex == normal.m_PoolIndex);
+	harness.Deallocate(again);
+	harness.EndFrame(0);
+	harness.EndFrame(0);
+	CHECK(pools.GetPool(normal.m_PoolIndex) != nullptr);
+	harness.EndFrame(0);
+	CHECK(pools.GetPool(normal.m_PoolIndex) == nullptr);
+	CHECK(pools.GetPoolCount() == 1);
+
+	// trimIdleFrames 可以在运行时修改
+	pools.SetTrimIdleFrames(0);
+	harness.Deallocate(reused);
+	harness.EndFrame(0);
+	CHECK(pools.GetPoolCount() == 0);
+	CHECK(pools.GetPoolBytes() == 0);
+	CHECK(pools.GetPoolSlotCount() == 2);
+}
+
+TEST_CASE(BuddyPoolSet_DedicatedPools)
+{
+	PoolSetHarness harness(64 * MB, 100);
+	auto& pools = harness.m_Pools;
+
+	auto first = harness.Allocate(40 * MB);
+	auto second = harness.Allocate(40 * MB);
+	// 专用的请求总是新建分配器
+	CHECK(first.m_PoolIndex != second.m_PoolIndex);
+	CHECK(pools.GetPoolCount() == 2);
+	CHECK(pools.GetPoolBytes() == 80 * MB);
+	// 占用不超过实际创建的大小，而不是 2 的幂取整后的 64MB
+	CHECK(pools.GetReservedBytes() == 80 * MB);
+	CHECK(pools.GetHighWaterMark() == 80 * MB);
+
+	AllocatorStats stats{};
+	pools.GetStats(stats);
+	CHECK(stats.m_ReservedBytes <= stats.m_PoolBytes);
+
+	// 专用的分配器空闲后立即释放，不等待 trimIdleFrames
+	harness.Deallocate(first);
+	harness.EndFrame(0);
+	CHECK(pools.GetPoolCount() == 1);
+	CHECK(pools.GetPoolBytes() == 40 * MB);
+	CHECK(pools.GetReservedBytes() == 40 * MB);
+	CHECK(pools.GetHighWaterMark() == 80 * MB);
+}
+
+TEST_CASE(BuddyPoolSet_FailedAllocationInNewPool)
+{
+	using SizeClass = FakePoolSet::SizeClass;
+	PoolSetHarness harness(64 * MB);
+	auto& pools = harness.m_Pools;
+
+	// 对齐后超出小分配器的请求改用专用的分配器，新建的小分配器立即释放
+	FakeBlock block{};
+	auto poolIndex = pools.Allocate(4 * KB, [&](FakeBuddyPool& pool) {
+		return pool.GetBackingSize() != FakePoolSet::MinSmallPoolSize && pool.Allocate(4 * KB, block);
+		});
+	CHECK(poolIndex != FakePoolSet::InvalidIndex);
+	CHECK(pools.GetPoolSizeClass(poolIndex) == SizeClass::Dedicated);
+	CHECK(harness.m_CreatedPools == 2);
+	CHECK(pools.GetPoolCount() == 1);
+	CHECK(pools.GetPoolBytes() == FakePoolSet::DedicatedAlignment);
+	CHECK(pools.GetReservedBytes() == 4 * KB);
+
+	// 都无法满足时返回 InvalidIndex，不留下新建的分配器
+	CHECK(pools.Allocate(1 * MB, [](FakeBuddyPool&) { return false; }) == FakePoolSet::InvalidIndex);
+	CHECK(pools.Allocate(40 * MB, [](FakeBuddyPool&) { return false; }) == FakePoolSet::InvalidIndex);
+	CHECK(harness.m_CreatedPools == 5);
+	CHECK(pools.GetPoolCount() == 1);
+	CHECK(pools.GetPoolBytes() == FakePoolSet::DedicatedAlignment);
+	CHECK(pools.GetReservedBytes() == 4 * KB);
+
+	// 释放后的位置可以复用
+	auto reused = harness.Allocate(1 * MB);
+	CHECK(reused.m_PoolIndex != FakePoolSet::InvalidIndex);
+	CHECK(pools.GetPoolSlotCount() == 2);
+}
+
+TEST_CASE(BuddyPoolSet_Stats)
+{
+	PoolSetHarness harness(64 * MB);
+	auto& pools = harness.m_Pools;
+
+	std::vector<FakeBlock> blocks;
+	for (int i = 0; i < 10; ++i) {
+		blocks.push_back(harness.Allocate(1000));
+	}
+	// 1000 字节按 1KB 的块占用
+	CHECK(pools.GetReservedBytes() == 10 * KB);
+	for (auto& block : blocks) {
+		harness.Deallocate(block);
+	}
+	harness.EndFrame(0);
+	CHECK(pools.GetReservedBytes() == 0);
+
+	AllocatorStats stats{};
+	pools.GetStats(stats);
+	CHECK(stats.m_TotalAllocations == 10);
+	CHECK(stats.m_TotalFrees == 10);
+	CHECK(stats.m_HighWaterMark == 10 * KB);
+	CHECK(stats.m_PoolCount == 1);
+	CHECK(stats.m_RequestedBytes == 0);
+}
+
+namespace {
+	struct ChurnResult
+	{
+		std::size_t m_MaxPoolCount = 0;
+		std::uint64_t m_MaxPoolBytes = 0;
+		std::uint64_t m_MaxLiveBytes = 0;
+		std::size_t m_EarlyMaxPoolCount = 0;    // 前半段的最大分配器数量
+		std::size_t m_LateMaxPoolCount = 0;     // 后半段的最大分配器数量
+		std::uint64_t m_EarlyMaxPoolBytes = 0;
+		std::uint64_t m_LateMaxPoolBytes = 0;
+		std::uint64_t m_Operations = 0;
+	};
+
+	// 每帧释放一部分存活的分配并加入新的分配，存活数量有上限，偶尔出现专用大小的请求
+	// 在回收之前采样，此时同时存在的分配器最多
+	ChurnResult RunChurn(PoolSetHarness& harness, std::uint32_t frameCount, std::uint32_t seed)
+	{
+		constexpr std::size_t MaxLive = 512;
+		std::mt19937 rng(seed);
+		std::uniform_int_distribution<int> kindDist(0, 99);
+		std::uniform_int_distribution<std::uint32_t> smallDist(256, 64 * KB);
+		std::uniform_int_distribution<std::uint32_t> normalDist(64 * KB + 1, 4 * MB);
+		std::uniform_int_distribution<std::uint32_t> dedicatedDist(32 * MB + 1, 48 * MB);
+
+		ChurnResult result{};
+		std::vector<FakeBlock> live;
+		std::uint64_t liveBytes = 0;
+		for (std::uint32_t frame = 0; frame < frameCount; ++frame) {
+			auto frees = live.size() / 4;
+			for (std::size_t i = 0; i < frees; ++i) {
+				auto index = std::uniform_int_distribution<std::size_t>(0, live.size() - 1)(rng);
+				harness.Deallocate(live[index]);
+				liveBytes -= live[index].m_Size;
+				live[index] = live.back();
+				live.pop_back();
+				++result.m_Operations;
+			}
+			while (live.size() < MaxLive) {
+				auto kind = kindDist(rng);
+				auto size = kind < 70 ? smallDist(rng) : kind < 99 ? normalDist(rng) : dedicatedDist(rng);
+				live.push_back(harness.Allocate(size));
+				liveBytes += size;
+				++result.m_Operations;
+			}
+
+			auto& pools = harness.m_Pools;
+			auto poolCount = pools.GetPoolCount();
+			auto poolBytes = pools.GetPoolBytes();
+			result.m_MaxLiveBytes = (std::max)(result.m_MaxLiveBytes, liveBytes);
+			result.m_MaxPoolCount = (std::max)(result.m_MaxPoolCount, poolCount);
+			result.m_MaxPoolBytes = (std::max)(result.m_MaxPoolBytes, poolBytes);
+			auto& maxCount = frame < frameCount / 2 ? result.m_EarlyMaxPoolCount : result.m_LateMaxPoolCount;
+			auto& maxBytes = frame < frameCount / 2 ? result.m_EarlyMaxPoolBytes : result.m_LateMaxPoolBytes;
+			maxCount = (std::max)(maxCount, poolCount);
+			maxBytes = (std::max)(maxBytes, poolBytes);
+
+			harness.EndFrame(2);
+		}
+
+		for (auto& block : live) {
+			harness.Deallocate(block);
+		}
+		return result;
+	}
+}
+
+TEST_CASE(BuddyPoolSet_ChurnStaysBounded)
+{
+	constexpr std::uint32_t TrimIdleFrames = 8;
+	PoolSetHarness harness(64 * MB, TrimIdleFrames);
+	auto result = RunChurn(harness, 1000, 7);
+	auto& pools = harness.m_Pools;
+
+	// 稳定的负载下分配器的数量与大小不随时间增长，后半段的峰值不超过前半段太多
+	CHECK(result.m_LateMaxPoolCount <= result.m_EarlyMaxPoolCount + 2);
+	CHECK(result.m_LateMaxPoolBytes <= result.m_EarlyMaxPoolBytes + 2 * 64 * MB);
+	CHECK(result.m_MaxPoolBytes <= 4 * result.m_MaxLiveBytes);
+	// 空位被复用，位置的数量不超过同时存在的分配器数量的峰值
+	CHECK(pools.GetPoolSlotCount() <= result.m_MaxPoolCount);
+	// 专用的分配器在反复地创建与释放
+	CHECK(harness.m_CreatedPools > result.m_MaxPoolCount);
+
+	// 全部释放并空闲足够多帧后所有分配器都被回收
+	for (std::uint32_t i = 0; i < TrimIdleFrames + 3; ++i) {
+		harness.EndFrame(2);
+	}
+	CHECK(pools.GetPoolCount() == 0);
+	CHECK(pools.GetPoolBytes() == 0);
+	CHECK(pools.GetReservedBytes() == 0);
+
+	AllocatorStats stats{};
+	pools.GetStats(stats);
+	CHECK(stats.m_TotalAllocations == stats.m_TotalFrees);
+}
+
+BENCHMARK(BuddyPoolSet_Churn)
+{
+	// 每次迭代从空的分配器开始，输出每次分配或释放的耗时以及分配器数量与大小的峰值
+	constexpr std::uint32_t FrameCount = 400;
+	ChurnResult result{};
+	std::uint32_t createdPools = 0;
+	auto run = [&]() {
+		PoolSetHarness harness(64 * MB, FakePoolSet::DefaultTrimIdleFrames);
+		result = RunChurn(harness, FrameCount, 11);
+		createdPools = harness.m_CreatedPools;
+		};
+	run();
+	Test::Benchmark("BuddyPoolSet churn, allocate or free", result.m_Operations, run);
+	std::printf("  peak pools %zu (first half %zu, second half %zu), peak pool bytes %.1f MB (first half %.1f, second half %.1f), peak live bytes %.1f MB, pools created %u\n",
+		result.m_MaxPoolCount, result.m_EarlyMaxPoolCount, result.m_LateMaxPoolCount,
+		result.m_MaxPoolBytes / double(MB), result.m_EarlyMaxPoolBytes / double(MB), result.m_LateMaxPoolBytes / double(MB),
+		result.m_MaxLiveBytes / double(MB), createdPools);
+}
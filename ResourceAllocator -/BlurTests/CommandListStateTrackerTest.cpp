@@ -0,0 +1,171 @@
+#include "TestFramework.h"
+#include "CommandListStateTracker.h"
+#include <array>
+#include <cstdint>
+
+using namespace DSM;
+
+namespace {
+	// 只以地址区分对象，用局部变量的地址代替 D3D12 对象
+	struct FakeObjects
+	{
+		int m_PSO[2]{};
+		int m_RootSignature[2]{};
+		int m_Heap[2]{};
+
+		const void* PSO(int i) const noexcept { return &m_PSO[i]; }
+		const void* RootSignature(int i) const noexcept { return &m_RootSignature[i]; }
+		const void* Heap(int i) const noexcept { return &m_Heap[i]; }
+	};
+
+	constexpr bool Graphics = false;
+	constexpr bool Compute = true;
+}
+
+TEST_CASE(CommandListStateTracker_PipelineAndRootSignature)
+{
+	FakeObjects objects;
+	CommandListStateTracker tracker;
+
+	CHECK(tracker.SetPipelineState(objects.PSO(0)));
+	CHECK(!tracker.SetPipelineState(objects.PSO(0)));
+	CHECK(tracker.SetPipelineState(objects.PSO(1)));
+
+	// 图形与计算管线的根签名分别记录
+	CHECK(tracker.SetRootSignature(objects.RootSignature(0), Graphics));
+	CHECK(!tracker.SetRootSignature(objects.RootSignature(0), Graphics));
+	CHECK(tracker.SetRootSignature(objects.RootSignature(0), Compute));
+	CHECK(!tracker.SetRootSignature(objects.RootSignature(0), Compute));
+
+	const auto& stats = tracker.GetStats();
+	CHECK(stats.m_PipelineStateCalls == 2 && stats.m_PipelineStateSkipped == 1);
+	CHECK(stats.m_RootSignatureCalls == 2 && stats.m_RootSignatureSkipped == 2);
+	CHECK(stats.GetIssuedCount() == 4 && stats.GetSkippedCount() == 3);
+}
+
+TEST_CASE(CommandListStateTracker_RootSignatureDropsOwnArguments)
+{
+	FakeObjects objects;
+	CommandListStateTracker tracker;
+	tracker.SetRootSignature(objects.RootSignature(0), Graphics);
+	tracker.SetRootSignature(objects.RootSignature(0), Compute);
+
+	std::uint32_t constants[] = { 1, 2, 3 };
+	CHECK(tracker.SetRootConstantBufferView(0, 0x1000, Graphics));
+	CHECK(tracker.SetRootDescriptorTable(1, 0x2000, Graphics));
+	CHECK(tracker.SetRoot32BitConstants(2, 3, constants, Graphics));
+	CHECK(tracker.SetRootConstantBufferView(0, 0x1000, Compute));
+	CHECK(!tracker.SetRootConstantBufferView(0, 0x1000, Graphics));
+
+	// 设置相同的根签名不影响已有的根参数
+	tracker.SetRootSignature(objects.RootSignature(0), Graphics);
+	CHECK(!tracker.SetRootConstantBufferView(0, 0x1000, Graphics));
+
+	// 更换图形根签名后图形管线的根参数全部重新设置，计算管线不受影响
+	CHECK(tracker.SetRootSignature(objects.RootSignature(1), Graphics));
+	CHECK(tracker.SetRootConstantBufferView(0, 0x1000, Graphics));
+	CHECK(tracker.SetRootDescriptorTable(1, 0x2000, Graphics));
+	CHECK(tracker.SetRoot32BitConstants(2, 3, constants, Graphics));
+	CHECK(!tracker.SetRootConstantBufferView(0, 0x1000, Compute));
+
+	const auto& stats = tracker.GetStats();
+	CHECK(stats.m_RootArgumentCalls == 7);
+	CHECK(stats.m_RootArgumentSkipped == 3);
+}
+
+TEST_CASE(CommandListStateTracker_HeapChangeDropsOnlyTables)
+{
+	FakeObjects objects;
+	CommandListStateTracker tracker;
+	tracker.SetRootSignature(objects.RootSignature(0), Graphics);
+	tracker.SetRootSignature(objects.RootSignature(1), Compute);
+
+	std::array<const void*, 2> heaps = { objects.Heap(0), objects.Heap(1) };
+	CHECK(tracker.SetDescriptorHeaps(1, heaps.data()));
+	CHECK(!tracker.SetDescriptorHeaps(1, heaps.data()));
+
+	std::uint32_t constants[] = { 7, 8 };
+	tracker.SetRootConstantBufferView(0, 0x1000, Graphics);
+	tracker.SetRootDescriptorTable(1, 0x2000, Graphics);
+	tracker.SetRoot32BitConstants(2, 2, constants, Graphics);
+	tracker.SetRootDescriptorTable(0, 0x3000, Compute);
+
+	// 堆的数量改变同样视为更换
+	CHECK(tracker.SetDescriptorHeaps(2, heaps.data()));
+	CHECK(!tracker.SetDescriptorHeaps(2, heaps.data()));
+
+	// 两条管线上的描述符表失效，常量缓冲区与根常量保留
+	CHECK(tracker.SetRootDescriptorTable(1, 0x2000, Graphics));
+	CHECK(tracker.SetRootDescriptorTable(0, 0x3000, Compute));
+	CHECK(!tracker.SetRootConstantBufferView(0, 0x1000, Graphics));
+	CHECK(!tracker.SetRoot32BitConstants(2, 2, constants, Graphics));
+
+	// 更换为其他堆
+	std::array<const void*, 2> otherHeaps = { objects.Heap(1), objects.Heap(0) };
+	CHECK(tracker.SetDescriptorHeaps(2, otherHeaps.data()));
+	CHECK(tracker.SetRootDescriptorTable(1, 0x2000, Graphics));
+
+	const auto& stats = tracker.GetStats();
+	CHECK(stats.m_DescriptorHeapCalls == 3);
+	CHECK(stats.m_DescriptorHeapSkipped == 2);
+}
+
+TEST_CASE(CommandListStateTracker_RootArgumentsCompareByValue)
+{
+	FakeObjects objects;
+	CommandListStateTracker tracker;
+	tracker.SetRootSignature(objects.RootSignature(0), Graphics);
+
+	// 根常量比较内容而不是地址
+	std::uint32_t a[] = { 1, 2, 3, 4 };
+	std::uint32_t b[] = { 1, 2, 3, 4 };
+	CHECK(tracker.SetRoot32BitConstants(0, 4, a, Graphics));
+	CHECK(!tracker.SetRoot32BitConstants(0, 4, b, Graphics));
+	b[3] = 5;
+	CHECK(tracker.SetRoot32BitConstants(0, 4, b, Graphics));
+	// 写入后修改源数据，记录的是写入时的值
+	b[3] = 4;
+	CHECK(tracker.SetRoot32BitConstants(0, 4, b, Graphics));
+	CHECK(!tracker.SetRoot32BitConstants(0, 4, a, Graphics));
+	// 数量不同视为不同
+	CHECK(tracker.SetRoot32BitConstants(0, 3, a, Graphics));
+
+	// 相同数值但类型不同的根参数需要重新设置
+	CHECK(tracker.SetRootConstantBufferView(1, 0x4000, Graphics));
+	CHECK(tracker.SetRootDescriptorTable(1, 0x4000, Graphics));
+	CHECK(!tracker.SetRootDescriptorTable(1, 0x4000, Graphics));
+	CHECK(tracker.SetRootDescriptorTable(1, 0x4040, Graphics));
+
+	// 图形与计算管线的同一索引相互独立
+	CHECK(tracker.SetRootDescriptorTable(1, 0x4040, Compute));
+}
+
+TEST_CASE(CommandListStateTracker_ResetKeepsStats)
+{
+	FakeObjects objects;
+	CommandListStateTracker tracker;
+	std::array<const void*, 1> heaps = { objects.Heap(0) };
+	tracker.SetPipelineState(objects.PSO(0));
+	tracker.SetRootSignature(objects.RootSignature(0), Graphics);
+	tracker.SetDescriptorHeaps(1, heaps.data());
+	tracker.SetRootConstantBufferView(0, 0x1000, Graphics);
+
+	// 重置后所有状态都需要重新设置
+	tracker.Reset();
+	CHECK(tracker.SetPipelineState(objects.PSO(0)));
+	CHECK(tracker.SetRootSignature(objects.RootSignature(0), Graphics));
+	CHECK(tracker.SetDescriptorHeaps(1, heaps.data()));
+	CHECK(tracker.SetRootConstantBufferView(0, 0x1000, Graphics));
+	CHECK(tracker.GetStats().GetIssuedCount() == 8);
+
+	CommandListStateStats total{};
+	total.Merge(tracker.GetStats());
+	total.Merge(tracker.GetStats());
+	CHECK(total.GetIssuedCount() == 16);
+	CHECK(total.m_RootArgumentCalls == 4);
+
+	tracker.ResetStats();
+	CHECK(tracker.GetStats().GetIssuedCount() == 0);
+	// 清空统计不影响记录的状态
+	CHECK(!tracker.SetPipelineState(objects.PSO(0)));
+}
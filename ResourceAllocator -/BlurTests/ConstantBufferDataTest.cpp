@@ -0,0 +1,209 @@
+#include "TestFramework.h"
+#include "ConstantBufferData.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace DSM;
+
+namespace {
+	// 模拟一个帧资源中持久映射的上传缓冲区
+	struct MappedBuffer
+	{
+		std::shared_ptr<int> m_Resource = std::make_shared<int>();
+		std::vector<std::uint8_t> m_Memory;
+
+		explicit MappedBuffer(std::uint32_t byteSize) :m_Memory(byteSize, 0xCD) {}
+
+		std::uint32_t Update(ConstantBufferData& data)
+		{
+			return data.UpdateBuffer(m_Resource, m_Memory.data());
+		}
+
+		bool Matches(const ConstantBufferData& data) const
+		{
+			return std::memcmp(m_Memory.data(), data.GetData(), data.GetByteSize()) == 0;
+		}
+	};
+
+	void WriteFloat(ConstantBufferData& data, std::uint32_t offset, float value)
+	{
+		data.Write(offset, &value, sizeof(value));
+	}
+}
+
+TEST_CASE(ConstantBufferData_UploadsOnlyTheDirtyRange)
+{
+	ConstantBufferData data(256);
+	MappedBuffer buffer(256);
+
+	// 第一次同步写入全部数据
+	CHECK(buffer.Update(data) == 256);
+	CHECK(buffer.Matches(data));
+	CHECK(buffer.Update(data) == 0);
+
+	// 写入相同的值不改变版本
+	float zero = 0.0f;
+	CHECK(!data.Write(16, &zero, sizeof(zero)));
+	CHECK(data.GetVersion() == 0);
+	CHECK(buffer.Update(data) == 0);
+
+	// 两次写入合并为覆盖两者的范围 [16, 80)
+	WriteFloat(data, 16, 1.0f);
+	float color[4] = { 1.0f, 0.5f, 0.25f, 1.0f };
+	CHECK(data.Write(64, color, sizeof(color)));
+	CHECK(data.GetVersion() == 2);
+	CHECK(buffer.Update(data) == 64);
+	CHECK(buffer.Matches(data));
+	CHECK(buffer.Update(data) == 0);
+
+	// 空写入不标记
+	CHECK(!data.Write(256, color, 0));
+}
+
+TEST_CASE(ConstantBufferData_TracksEachResourceSeparately)
+{
+	ConstantBufferData data(128);
+	MappedBuffer frame0(128);
+	MappedBuffer frame1(128);
+	CHECK(frame0.Update(data) == 128);
+	CHECK(frame1.Update(data) == 128);
+
+	// 帧 0 同步后的改变仍需要写入帧 1
+	WriteFloat(data, 0, 1.0f);
+	CHECK(frame0.Update(data) == 4);
+	WriteFloat(data, 100, 2.0f);
+	CHECK(frame0.Update(data) == 4);
+	CHECK(frame1.Update(data) == 104);
+	CHECK(frame0.Matches(data) && frame1.Matches(data));
+
+	// 资源被移动后内容未知，写入全部数据
+	std::vector<std::uint8_t> moved(128, 0xEE);
+	CHECK(data.UpdateBuffer(frame0.m_Resource, moved.data()) == 128);
+	CHECK(std::memcmp(moved.data(), data.GetData(), 128) == 0);
+	CHECK(data.UpdateBuffer(frame0.m_Resource, moved.data()) == 0);
+}
+
+TEST_CASE(ConstantBufferData_ForgetsOldResources)
+{
+	ConstantBufferData data(64);
+	std::vector<MappedBuffer> buffers;
+	for (std::size_t i = 0; i <= ConstantBufferData::MaxBoundResourceStates; ++i) {
+		buffers.emplace_back(64);
+	}
+	for (auto& buffer : buffers) {
+		CHECK(buffer.Update(data) == 64);
+	}
+	// 最早的记录已被丢弃，再次同步时写入全部数据
+	WriteFloat(data, 8, 3.0f);
+	CHECK(buffers[0].Update(data) == 64);
+	CHECK(buffers.back().Update(data) == 4);
+
+	// 资源被释放后，相同地址上的新资源不会沿用旧的记录
+	auto address = buffers.back().m_Memory.data();
+	buffers.back().m_Resource = std::make_shared<int>();
+	CHECK(data.UpdateBuffer(buffers.back().m_Resource, address) == 64);
+}
+
+TEST_CASE(ConstantBufferData_RandomWritesStayInSync)
+{
+	constexpr std::uint32_t ByteSize = 512;
+	ConstantBufferData data(ByteSize);
+	std::vector<MappedBuffer> frames;
+	for (int i = 0; i < 3; ++i) {
+		frames.emplace_back(ByteSize);
+	}
+	// 每个帧资源上次同步后改变的最小与最大偏移
+	std::vector<std::uint32_t> dirtyBegin(frames.size(), 0);
+	std::vector<std::uint32_t> dirtyEnd(frames.size(), ByteSize);
+
+	std::mt19937 random(17);
+	for (int frame = 0; frame < 3000; ++frame) {
+		auto writeCount = random() % 6;
+		for (std::uint32_t i = 0; i < writeCount; ++i) {
+			auto offset = static_cast<std::uint32_t>(4 * (random() % (ByteSize / 4)));
+			auto byteSize = (std::min)(static_cast<std::uint32_t>(4 * (1 + random() % 16)), ByteSize - offset);
+			std::vector<std::uint8_t> value(byteSize);
+			for (auto& byte : value) byte = static_cast<std::uint8_t>(random() % 4);
+			if (!data.Write(offset, value.data(), byteSize)) continue;
+			for (std::size_t f = 0; f < frames.size(); ++f) {
+				bool clean = dirtyBegin[f] == dirtyEnd[f];
+				dirtyBegin[f] = clean ? offset : (std::min)(dirtyBegin[f], offset);
+				dirtyEnd[f] = clean ? offset + byteSize : (std::max)(dirtyEnd[f], offset + byteSize);
+			}
+		}
+
+		auto index = frame % frames.size();
+		auto& buffer = frames[index];
+		// 偶尔被整理移动到新的地址
+		if (random() % 50 == 0) {
+			std::vector<std::uint8_t> moved(ByteSize, 0xAB);
+			buffer.m_Memory.swap(moved);
+			dirtyBegin[index] = 0;
+			dirtyEnd[index] = ByteSize;
+		}
+		auto written = buffer.Update(data);
+		CHECK(buffer.Matches(data));
+		CHECK(written == dirtyEnd[index] - dirtyBegin[index]);
+		dirtyBegin[index] = dirtyEnd[index] = 0;
+	}
+}
+
+BENCHMARK(ConstantBufferData_PerObjectUpdate)
+{
+	// 256 字节的物体常量，每帧只改变部分物体 64 字节的世界矩阵，与每帧写入全部数据比较
+	// 这里映射的是普通内存，上传堆是写合并内存，写入的字节数比这里的耗时更重要
+	constexpr std::uint32_t ObjectCount = 1024;
+	constexpr std::uint32_t ObjectByteSize = 256;
+	std::vector<ConstantBufferData> objects(ObjectCount, ConstantBufferData(ObjectByteSize));
+	std::vector<MappedBuffer> buffers;
+	for (std::uint32_t i = 0; i < ObjectCount; ++i) {
+		buffers.emplace_back(ObjectByteSize);
+		buffers[i].Update(objects[i]);
+	}
+
+	float world[16] = {};
+	for (std::uint32_t movingPercent : { 100u, 10u }) {
+		auto movingCount = ObjectCount * movingPercent / 100;
+		std::uint64_t dirtyBytes = 0;
+		std::uint64_t fullBytes = 0;
+		auto dirtyName = "Write(64B) + UpdateBuffer: " + std::to_string(movingPercent) + "% moving";
+		auto fullName = "Write(64B) + full memcpy: " + std::to_string(movingPercent) + "% moving";
+
+		Test::Benchmark(dirtyName.c_str(), ObjectCount, [&]() {
+			std::uint64_t written = 0;
+			world[12] += 1.0f;
+			for (std::uint32_t i = 0; i < movingCount; ++i) {
+				objects[i].Write(0, world, sizeof(world));
+			}
+			for (std::uint32_t i = 0; i < ObjectCount; ++i) {
+				written += buffers[i].Update(objects[i]);
+			}
+			dirtyBytes = written;
+			Test::DoNotOptimize(written);
+			});
+		Test::Benchmark(fullName.c_str(), ObjectCount, [&]() {
+			std::uint64_t written = 0;
+			world[12] += 1.0f;
+			for (std::uint32_t i = 0; i < movingCount; ++i) {
+				objects[i].Write(0, world, sizeof(world));
+			}
+			for (std::uint32_t i = 0; i < ObjectCount; ++i) {
+				std::memcpy(buffers[i].m_Memory.data(), objects[i].GetData(), objects[i].GetByteSize());
+				written += objects[i].GetByteSize();
+			}
+			fullBytes = written;
+			Test::DoNotOptimize(written + buffers[0].m_Memory[7]);
+			});
+		// 以最后一帧统计写入映射内存的字节数
+		std::printf("  bytes per frame: UpdateBuffer %llu, full memcpy %llu (%.1f%%)\n",
+			static_cast<unsigned long long>(dirtyBytes), static_cast<unsigned long long>(fullBytes),
+			100.0 * static_cast<double>(dirtyBytes) / static_cast<double>(fullBytes));
+		CHECK(dirtyBytes == static_cast<std::uint64_t>(movingCount) * sizeof(world));
+		CHECK(fullBytes == static_cast<std::uint64_t>(ObjectCount) * ObjectByteSize);
+	}
+}
@@ -0,0 +1,81 @@
+#include "TestFramework.h"
+#include "D3D12Allocatioin.h"
+#include <algorithm>
+
+using namespace DSM;
+
+namespace {
+	constexpr std::size_t KB = 1024;
+	constexpr std::size_t MB = 1024 * 1024;
+
+	D3D12BuddyAllocator::AllocatorInitData GetBufferInitData()
+	{
+		return {
+			D3D12BuddyAllocator::AllocationStrategy::ManualSubAllocation,
+			D3D12_HEAP_TYPE_DEFAULT,
+			D3D12_HEAP_FLAG_NONE,
+			D3D12_RESOURCE_FLAG_NONE };
+	}
+}
+
+TEST_CASE(D3D12MultiBuddyAllocator_SizeClassRouting)
+{
+	// 路由只依赖大小，不需要设备，也不会创建分配器
+	using SizeClass = D3D12MultiBuddyAllocator::SizeClass;
+	D3D12MultiBuddyAllocator allocator(nullptr, GetBufferInitData(), nullptr, 64 * MB);
+	CHECK(allocator.GetSizeClass(1) == SizeClass::Small);
+	CHECK(allocator.GetSizeClass(D3D12MultiBuddyAllocator::SmallAllocationSize) == SizeClass::Small);
+	CHECK(allocator.GetSizeClass(D3D12MultiBuddyAllocator::SmallAllocationSize + 1) == SizeClass::Normal);
+	CHECK(allocator.GetSizeClass(32 * MB) == SizeClass::Normal);
+	CHECK(allocator.GetSizeClass(32 * MB + 1) == SizeClass::Dedicated);
+	CHECK(allocator.GetPoolCount() == 0);
+
+	// 小分配器不比普通分配器小时不单独划分小块
+	D3D12MultiBuddyAllocator smallPool(nullptr, GetBufferInitData(), nullptr, D3D12MultiBuddyAllocator::MinSmallPoolSize);
+	CHECK(smallPool.GetSizeClass(1) == SizeClass::Normal);
+	CHECK(smallPool.GetSizeClass(D3D12MultiBuddyAllocator::MinSmallPoolSize / 2 + 1) == SizeClass::Dedicated);
+}
+
+TEST_CASE(D3D12BuddyAllocator_AlignedOffsetEdges)
+{
+	std::size_t offset = 0;
+	// 不需要对齐
+	CHECK(D3D12BuddyAllocator::GetAlignedOffset(768, 256, 64 * KB, 256, 0, offset));
+	CHECK(offset == 768);
+	CHECK(D3D12BuddyAllocator::GetAlignedOffset(768, 256, 64 * KB, 256, 256, offset));
+	CHECK(offset == 768);
+	// 对齐后超出块
+	CHECK(!D3D12BuddyAllocator::GetAlignedOffset(768, 256, 64 * KB, 1, 512, offset));
+	CHECK(offset == 1024);
+	// 对齐后仍在块中
+	CHECK(D3D12BuddyAllocator::GetAlignedOffset(512, 1024, 64 * KB, 1024, 512, offset));
+	CHECK(offset == 512);
+	CHECK(D3D12BuddyAllocator::GetAlignedOffset(256, 1024, 64 * KB, 512, 512, offset));
+	CHECK(offset == 512);
+	CHECK(!D3D12BuddyAllocator::GetAlignedOffset(256, 1024, 64 * KB, 769, 512, offset));
+
+	// 专用分配器的堆只有请求的大小，块的其余部分不存在
+	CHECK(D3D12BuddyAllocator::GetAlignedOffset(0, 1 * MB, 600 * KB, 600 * KB, 64 * KB, offset));
+	CHECK(offset == 0);
+	CHECK(!D3D12BuddyAllocator::GetAlignedOffset(0, 1 * MB, 600 * KB, 600 * KB + 1, 64 * KB, offset));
+}
+
+TEST_CASE(D3D12BuddyAllocator_BlockRequestAlwaysFits)
+{
+	// 与 D3D12BuddyAllocator::Allocate 相同的块选择：块不小于 2 的幂的对齐，
+	// 块按自身大小对齐，因此任意位置的块都无需填充
+	BuddyAllocator blocks(256, 4 * MB);
+	const auto backingSize = blocks.GetMaxBlockSize();
+	for (std::uint32_t alignment = 256; alignment <= 64 * KB; alignment <<= 1) {
+		for (std::uint32_t size = 1; size <= 256 * KB; size = size * 3 + 1) {
+			auto blockRequest = (std::max)(size, alignment);
+			auto order = blocks.UnitSizeToOrder(blocks.SizeToUnitSize(blockRequest));
+			auto blockSize = blocks.UnitSizeToSize(blocks.OrderToUnitSize(order));
+			for (std::size_t blockOffset = 0; blockOffset < backingSize; blockOffset += blockSize) {
+				std::size_t offset = 0;
+				CHECK(D3D12BuddyAllocator::GetAlignedOffset(blockOffset, blockSize, backingSize, size, alignment, offset));
+				CHECK(offset == blockOffset);
+			}
+		}
+	}
+}
@@ -0,0 +1,308 @@
+#include "TestFramework.h"
+#include "FrustumCuller.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <random>
+#include <vector>
+
+using namespace DSM;
+using namespace DirectX;
+
+namespace {
+	using Matrix = std::array<std::array<double, 4>, 4>;
+
+	struct TestBox
+	{
+		XMFLOAT3 m_Center;
+		XMFLOAT3 m_Extents;
+		XMFLOAT4X4 m_World;
+	};
+
+	Matrix Multiply(const Matrix& a, const Matrix& b)
+	{
+		Matrix result{};
+		for (int i = 0; i < 4; ++i) {
+			for (int j = 0; j < 4; ++j) {
+				for (int k = 0; k < 4; ++k) {
+					result[i][j] += a[i][k] * b[k][j];
+				}
+			}
+		}
+		return result;
+	}
+
+	XMFLOAT4X4 ToFloat4x4(const Matrix& m)
+	{
+		XMFLOAT4X4 result{};
+		for (int i = 0; i < 4; ++i) {
+			for (int j = 0; j < 4; ++j) {
+				result.m[i][j] = static_cast<float>(m[i][j]);
+			}
+		}
+		return result;
+	}
+
+	// 行向量约定，与 XMMatrixLookToLH 相同：摄像机位于 position，绕 y 轴旋转 yaw 后看向 +z
+	Matrix GetView(double x, double y, double z, double yaw)
+	{
+		double c = std::cos(yaw), s = std::sin(yaw);
+		Matrix rotation = { { { c, 0, s, 0 }, { 0, 1, 0, 0 }, { -s, 0, c, 0 }, { 0, 0, 0, 1 } } };
+		Matrix translation = { { { 1, 0, 0, 0 }, { 0, 1, 0, 0 }, { 0, 0, 1, 0 }, { -x, -y, -z, 1 } } };
+		return Multiply(translation, rotation);
+	}
+
+	// 与 XMMatrixPerspectiveFovLH 相同
+	Matrix GetPerspective(double fovY, double aspect, double nearZ, double farZ)
+	{
+		double yScale = 1.0 / std::tan(fovY / 2);
+		double range = farZ / (farZ - nearZ);
+		return { { { yScale / aspect, 0, 0, 0 }, { 0, yScale, 0, 0 }, { 0, 0, range, 1 }, { 0, 0, -range * nearZ, 0 } } };
+	}
+
+	// 与 XMMatrixOrthographicLH 相同
+	Matrix GetOrthographic(double width, double height, double nearZ, double farZ)
+	{
+		double range = 1.0 / (farZ - nearZ);
+		return { { { 2 / width, 0, 0, 0 }, { 0, 2 / height, 0, 0 }, { 0, 0, range, 0 }, { 0, 0, -range * nearZ, 1 } } };
+	}
+
+	// 局部空间中的点变换到世界空间
+	std::array<double, 3> TransformPoint(const XMFLOAT4X4& world, double x, double y, double z)
+	{
+		std::array<double, 3> result{};
+		for (int i = 0; i < 3; ++i) {
+			result[i] = x * world.m[0][i] + y * world.m[1][i] + z * world.m[2][i] + world.m[3][i];
+		}
+		return result;
+	}
+
+	// 包围盒上的点在裁剪空间中严格位于视锥体内部
+	bool IsStrictlyInside(const Matrix& viewProj, const std::array<double, 3>& p)
+	{
+		double clip[4]{};
+		for (int j = 0; j < 4; ++j) {
+			clip[j] = p[0] * viewProj[0][j] + p[1] * viewProj[1][j] + p[2] * viewProj[2][j] + viewProj[3][j];
+		}
+		double w = clip[3];
+		double margin = 1e-3 * std::abs(w);
+		return w > 0 &&
+			std::abs(clip[0]) < w - margin && std::abs(clip[1]) < w - margin &&
+			clip[2] > margin && clip[2] < w - margin;
+	}
+
+	// 标量参照：由 8 个顶点求世界空间的轴对齐包围盒，每个平面取法线方向最远的顶点
+	// 返回 1 可见，0 被剔除，-1 与某个平面的距离过近，浮点误差下两种结果都可以接受
+	int ReferenceClassify(const TestBox& box, const FrustumCuller::Planes& planes)
+	{
+		std::array<double, 3> lower{ 1e300, 1e300, 1e300 };
+		std::array<double, 3> upper{ -1e300, -1e300, -1e300 };
+		for (int corner = 0; corner < 8; ++corner) {
+			auto p = TransformPoint(box.m_World,
+				box.m_Center.x + (corner & 1 ? box.m_Extents.x : -box.m_Extents.x),
+				box.m_Center.y + (corner & 2 ? box.m_Extents.y : -box.m_Extents.y),
+				box.m_Center.z + (corner & 4 ? box.m_Extents.z : -box.m_Extents.z));
+			for (int i = 0; i < 3; ++i) {
+				lower[i] = (std::min)(lower[i], p[i]);
+				upper[i] = (std::max)(upper[i], p[i]);
+			}
+		}
+
+		bool ambiguous = false;
+		for (const auto& plane : planes) {
+			double normal[3] = { plane.x, plane.y, plane.z };
+			double distance = plane.w;
+			double scale = std::abs(plane.w);
+			for (int i = 0; i < 3; ++i) {
+				distance += normal[i] * (normal[i] >= 0 ? upper[i] : lower[i]);
+				scale += std::abs(normal[i]) * ((std::max)(std::abs(upper[i]), std::abs(lower[i])) + 1);
+			}
+			if (std::abs(distance) <= 1e-4 * scale) {
+				ambiguous = true;
+			}
+			else if (distance < 0) {
+				return 0;
+			}
+		}
+		return ambiguous ? -1 : 1;
+	}
+
+	std::vector<TestBox> GetRandomBoxes(std::mt19937& random, std::size_t count)
+	{
+		std::uniform_real_distribution<float> position(-60.0f, 60.0f);
+		std::uniform_real_distribution<float> size(0.05f, 4.0f);
+		std::uniform_real_distribution<float> linear(-2.0f, 2.0f);
+		std::vector<TestBox> boxes(count);
+		for (auto& box : boxes) {
+			box.m_Center = { linear(random), linear(random), linear(random) };
+			box.m_Extents = { size(random), size(random), size(random) };
+			// 任意的线性变换，包含非均匀缩放、镜像与切变
+			box.m_World = {};
+			for (int i = 0; i < 3; ++i) {
+				for (int j = 0; j < 3; ++j) {
+					box.m_World.m[i][j] = linear(random);
+				}
+			}
+			box.m_World.m[3][0] = position(random);
+			box.m_World.m[3][1] = position(random);
+			box.m_World.m[3][2] = position(random);
+			box.m_World.m[3][3] = 1.0f;
+		}
+		return boxes;
+	}
+
+	void CheckAgainstReference(const std::vector<TestBox>& boxes, const Matrix& viewProj, std::mt19937& random)
+	{
+		FrustumCuller culler;
+		culler.Reserve(boxes.size());
+		for (std::uint32_t i = 0; i < boxes.size(); ++i) {
+			CHECK(culler.AddBox(boxes[i].m_Center, boxes[i].m_Extents, boxes[i].m_World) == i);
+		}
+		CHECK(culler.GetBoxCount() == boxes.size());
+
+		auto viewProjFloat = ToFloat4x4(viewProj);
+		auto planes = FrustumCuller::ExtractPlanes(viewProjFloat);
+		std::vector<std::uint32_t> visible;
+		culler.Cull(viewProjFloat, visible);
+		CHECK(std::is_sorted(visible.begin(), visible.end()));
+		CHECK(std::adjacent_find(visible.begin(), visible.end()) == visible.end());
+		CHECK(visible.empty() || visible.back() < boxes.size());
+
+		std::vector<bool> isVisible(boxes.size(), false);
+		for (auto index : visible) isVisible[index] = true;
+
+		std::uniform_real_distribution<double> unit(-1.0, 1.0);
+		std::size_t culledCount = 0;
+		for (std::size_t i = 0; i < boxes.size(); ++i) {
+			const auto& box = boxes[i];
+			auto expected = ReferenceClassify(box, planes);
+			if (expected >= 0) {
+				CHECK(isVisible[i] == (expected == 1));
+			}
+			culledCount += isVisible[i] ? 0 : 1;
+
+			// 与平面提取无关的检查：包围盒内有点在视锥体内时不能被剔除
+			for (int sample = 0; sample < 16; ++sample) {
+				auto p = TransformPoint(box.m_World,
+					box.m_Center.x + unit(random) * box.m_Extents.x,
+					box.m_Center.y + unit(random) * box.m_Extents.y,
+					box.m_Center.z + unit(random) * box.m_Extents.z);
+				if (IsStrictlyInside(viewProj, p)) {
+					CHECK(isVisible[i]);
+					break;
+				}
+			}
+		}
+		// 场景的大部分在视锥体外，确认确实剔除了包围盒
+		CHECK(culledCount > boxes.size() / 4);
+	}
+}
+
+TEST_CASE(FrustumCuller_PerspectiveMatchesReference)
+{
+	std::mt19937 random(21);
+	auto boxes = GetRandomBoxes(random, 4003);
+	auto proj = GetPerspective(0.25 * 3.14159265358979, 16.0 / 9.0, 1.0, 80.0);
+	for (int camera = 0; camera < 8; ++camera) {
+		auto view = GetView(camera * 3.0 - 10.0, camera - 2.0, -camera * 4.0, camera * 0.8);
+		CheckAgainstReference(boxes, Multiply(view, proj), random);
+	}
+}
+
+TEST_CASE(FrustumCuller_OrthographicMatchesReference)
+{
+	// 阴影贴图使用的正交投影
+	std::mt19937 random(211);
+	auto boxes = GetRandomBoxes(random, 2001);
+	auto proj = GetOrthographic(60.0, 40.0, -50.0, 50.0);
+	for (int light = 0; light < 4; ++light) {
+		auto view = GetView(light * 5.0, 0.0, light * -5.0, light * 1.3);
+		CheckAgainstReference(boxes, Multiply(view, proj), random);
+	}
+}
+
+TEST_CASE(FrustumCuller_PartialBlocksAndReuse)
+{
+	auto viewProj = ToFloat4x4(Multiply(GetView(0, 0, -10, 0), GetPerspective(1.0, 1.0, 1.0, 100.0)));
+	// 原点位于视锥体内，空余通道为零时会被判定为可见，不能写入结果
+	XMFLOAT4X4 identity{};
+	for (int i = 0; i < 4; ++i) identity.m[i][i] = 1.0f;
+	FrustumCuller culler;
+	std::vector<std::uint32_t> visible{ 42 };
+	culler.Cull(viewProj, visible);
+	CHECK(visible.empty());
+
+	for (std::uint32_t count = 1; count <= 9; ++count) {
+		culler.Clear();
+		CHECK(culler.GetBoxCount() == 0);
+		for (std::uint32_t i = 0; i < count; ++i) {
+			// 偶数索引在视锥体内，奇数索引在摄像机后方
+			auto world = identity;
+			world.m[3][2] = i % 2 == 0 ? 0.0f : -50.0f;
+			culler.AddBox({ 0, 0, 0 }, { 0.5f, 0.5f, 0.5f }, world);
+		}
+		culler.Cull(viewProj, visible);
+		CHECK(visible.size() == (count + 1) / 2);
+		for (std::size_t i = 0; i < visible.size(); ++i) {
+			CHECK(visible[i] == 2 * i);
+		}
+	}
+}
+
+BENCHMARK(FrustumCuller_Cull)
+{
+	std::mt19937 random(2121);
+	auto boxes = GetRandomBoxes(random, 16384);
+	auto viewProj = ToFloat4x4(Multiply(GetView(0, 0, -20, 0.3), GetPerspective(0.8, 16.0 / 9.0, 1.0, 80.0)));
+	auto planes = FrustumCuller::ExtractPlanes(viewProj);
+
+	FrustumCuller culler;
+	culler.Reserve(boxes.size());
+	for (const auto& box : boxes) {
+		culler.AddBox(box.m_Center, box.m_Extents, box.m_World);
+	}
+
+	// 每个包围盒分别测试 6 个平面的标量实现，包围盒数据为 AoS
+	struct ScalarBox { float m_Center[3]; float m_Extents[3]; };
+	std::vector<ScalarBox> scalarBoxes;
+	for (const auto& box : boxes) {
+		ScalarBox scalar{};
+		for (int i = 0; i < 3; ++i) {
+			const auto& m = box.m_World.m;
+			scalar.m_Center[i] = box.m_Center.x * m[0][i] + box.m_Center.y * m[1][i] + box.m_Center.z * m[2][i] + m[3][i];
+			scalar.m_Extents[i] = box.m_Extents.x * std::abs(m[0][i]) + box.m_Extents.y * std::abs(m[1][i]) + box.m_Extents.z * std::abs(m[2][i]);
+		}
+		scalarBoxes.push_back(scalar);
+	}
+
+	std::vector<std::uint32_t> visible;
+	visible.reserve(boxes.size());
+	Test::Benchmark("FrustumCuller::Cull (SoA, 4 wide)", boxes.size(), [&]() {
+		culler.Cull(planes, visible);
+		Test::DoNotOptimize(visible.size());
+		});
+	Test::Benchmark("scalar AoS", boxes.size(), [&]() {
+		visible.clear();
+		for (std::uint32_t i = 0; i < scalarBoxes.size(); ++i) {
+			const auto& box = scalarBoxes[i];
+			bool inside = true;
+			for (const auto& plane : planes) {
+				auto dist = box.m_Center[0] * plane.x + box.m_Center[1] * plane.y + box.m_Center[2] * plane.z + plane.w;
+				auto radius = box.m_Extents[0] * std::abs(plane.x) + box.m_Extents[1] * std::abs(plane.y) + box.m_Extents[2] * std::abs(plane.z);
+				if (dist + radius < 0) {
+					inside = false;
+					break;
+				}
+			}
+			if (inside) visible.push_back(i);
+		}
+		Test::DoNotOptimize(visible.size());
+		});
+	Test::Benchmark("AddBox", boxes.size(), [&]() {
+		culler.Clear();
+		for (const auto& box : boxes) {
+			culler.AddBox(box.m_Center, box.m_Extents, box.m_World);
+		}
+		Test::DoNotOptimize(culler.GetBoxCount());
+		});
+}
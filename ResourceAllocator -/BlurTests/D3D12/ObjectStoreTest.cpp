@@ -0,0 +1,548 @@
+#include "TestFramework.h"
+#include "ObjectStore.h"
+#include "Model.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <map>
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+
+using namespace DSM;
+using namespace DirectX;
+
+namespace {
+	std::uint64_t GetHandleKey(ObjectHandle handle)
+	{
+		return (static_cast<std::uint64_t>(handle.m_Index) << 32) | handle.m_Generation;
+	}
+
+	struct ReferenceObject
+	{
+		std::string m_Name;
+		const Model* m_Model = nullptr;
+		RenderLayerMask m_LayerMask = 0;
+	};
+
+	// 检查每个存活的句柄都指向正确的物体，稠密数组与句柄一一对应
+	bool MatchesReference(const ObjectStore& store, const std::map<std::uint64_t, ReferenceObject>& reference)
+	{
+		if (store.Size() != reference.size()) return false;
+		auto handles = store.GetHandles();
+		if (handles.size() != store.Size() || store.GetModels().size() != store.Size() ||
+			store.GetLayerMasks().size() != store.Size() || store.GetTransforms().size() != store.Size() ||
+			store.GetWorldMatrices().size() != store.Size() || store.GetWorldBounds().size() != store.Size()) {
+			return false;
+		}
+		for (std::uint32_t i = 0; i < handles.size(); ++i) {
+			auto it = reference.find(GetHandleKey(handles[i]));
+			if (it == reference.end() || store.GetDenseIndex(handles[i]) != i) return false;
+			const auto& expected = it->second;
+			if (store.GetName(handles[i]) != expected.m_Name || store.Find(expected.m_Name) != handles[i]) return false;
+			if (store.GetModels()[i] != expected.m_Model || store.GetLayerMasks()[i] != expected.m_LayerMask) return false;
+		}
+		return true;
+	}
+
+	Model GetBoxModel(const std::string& name, XMFLOAT3 center, XMFLOAT3 extents)
+	{
+		ModelMesh mesh{};
+		mesh.m_Name = name;
+		mesh.m_BoundingBox.Center = center;
+		mesh.m_BoundingBox.Extents = extents;
+		Model model(name);
+		model.SetMesh(mesh);
+		return model;
+	}
+
+	using Matrix = std::array<std::array<double, 4>, 4>;
+
+	Matrix ToMatrix(const XMFLOAT4X4& m)
+	{
+		Matrix result{};
+		for (int i = 0; i < 4; ++i) {
+			for (int j = 0; j < 4; ++j) {
+				result[i][j] = m.m[i][j];
+			}
+		}
+		return result;
+	}
+
+	Matrix Multiply(const Matrix& a, const Matrix& b)
+	{
+		Matrix result{};
+		for (int i = 0; i < 4; ++i) {
+			for (int j = 0; j < 4; ++j) {
+				for (int k = 0; k < 4; ++k) {
+					result[i][j] += a[i][k] * b[k][j];
+				}
+			}
+		}
+		return result;
+	}
+
+	// 相对误差，量级较小时按绝对误差
+	bool IsNear(double actual, double expected, double tolerance)
+	{
+		return std::abs(actual - expected) <= tolerance * (1.0 + std::abs(expected));
+	}
+
+	// 父子关系的参照，world 由局部矩阵沿父物体链逐个相乘得到
+	class ReferenceHierarchy
+	{
+	public:
+		void Add(ObjectHandle handle, ObjectHandle parent)
+		{
+			m_Parents[GetHandleKey(handle)] = parent;
+			m_Marked.insert(GetHandleKey(handle));
+		}
+
+		void SetParent(ObjectHandle child, ObjectHandle parent)
+		{
+			auto& current = m_Parents[GetHandleKey(child)];
+			if (current != parent) {
+				current = parent;
+				m_Marked.insert(GetHandleKey(child));
+			}
+		}
+
+		void Mark(ObjectHandle handle) { m_Marked.insert(GetHandleKey(handle)); }
+
+		bool IsAncestorOrSelf(ObjectHandle ancestor, ObjectHandle handle) const
+		{
+			for (auto curr = handle; curr.IsValid(); curr = m_Parents.at(GetHandleKey(curr))) {
+				if (curr == ancestor) return true;
+			}
+			return false;
+		}
+
+		// 删除 handle 及其后代，返回被删除的句柄
+		std::vector<ObjectHandle> Remove(ObjectHandle handle)
+		{
+			std::vector<ObjectHandle> removed;
+			for (const auto& [key, parent] : m_Parents) {
+				ObjectHandle object{ static_cast<std::uint32_t>(key >> 32), static_cast<std::uint32_t>(key) };
+				if (IsAncestorOrSelf(handle, object)) removed.push_back(object);
+			}
+			for (auto object : removed) {
+				m_Parents.erase(GetHandleKey(object));
+				m_Marked.erase(GetHandleKey(object));
+			}
+			return removed;
+		}
+
+		// 标记的物体及其后代都需要重新计算
+		std::uint32_t TakeExpectedUpdateCount()
+		{
+			std::uint32_t count = 0;
+			for (const auto& [key, parent] : m_Parents) {
+				ObjectHandle object{ static_cast<std::uint32_t>(key >> 32), static_cast<std::uint32_t>(key) };
+				for (auto curr = object; curr.IsValid(); curr = m_Parents.at(GetHandleKey(curr))) {
+					if (m_Marked.contains(GetHandleKey(curr))) {
+						++count;
+						break;
+					}
+				}
+			}
+			m_Marked.clear();
+			return count;
+		}
+
+		ObjectHandle GetParent(ObjectHandle handle) const { return m_Parents.at(GetHandleKey(handle)); }
+
+		Matrix GetWorld(const ObjectStore& store, ObjectHandle handle) const
+		{
+			XMFLOAT4X4 local;
+			XMStoreFloat4x4(&local, store.GetTransform(handle).GetLocalToWorldMatrix());
+			auto world = ToMatrix(local);
+			if (auto parent = GetParent(handle); parent.IsValid()) {
+				world = Multiply(world, GetWorld(store, parent));
+			}
+			return world;
+		}
+
+		// 世界矩阵、法线矩阵与世界空间的包围盒都与参照一致
+		bool MatchesStore(const ObjectStore& store) const
+		{
+			if (store.Size() != m_Parents.size()) return false;
+			for (auto handle : store.GetHandles()) {
+				if (store.GetParent(handle) != GetParent(handle)) return false;
+				auto expected = GetWorld(store, handle);
+				auto world = ToMatrix(store.GetWorldMatrix(handle));
+				for (int i = 0; i < 4; ++i) {
+					for (int j = 0; j < 4; ++j) {
+						if (!IsNear(world[i][j], expected[i][j], 1e-4)) return false;
+					}
+				}
+
+				// 法线矩阵为左上 3x3 的逆转置，与 world 的左上 3x3 相乘后为单位矩阵
+				auto invTranspose = ToMatrix(store.GetWorldInvTranspose(handle));
+				for (int i = 0; i < 3; ++i) {
+					for (int j = 0; j < 3; ++j) {
+						double product = 0;
+						for (int k = 0; k < 3; ++k) product += expected[i][k] * invTranspose[j][k];
+						if (!IsNear(product, i == j ? 1.0 : 0.0, 1e-3)) return false;
+					}
+				}
+
+				// 局部包围盒 8 个角点变换后的轴对齐包围盒
+				const auto& local = store.GetLocalBounds()[store.GetDenseIndex(handle)];
+				std::array<double, 3> lower{ 1e300, 1e300, 1e300 };
+				std::array<double, 3> upper{ -1e300, -1e300, -1e300 };
+				for (int corner = 0; corner < 8; ++corner) {
+					double p[3] = {
+						local.Center.x + (corner & 1 ? local.Extents.x : -local.Extents.x),
+						local.Center.y + (corner & 2 ? local.Extents.y : -local.Extents.y),
+						local.Center.z + (corner & 4 ? local.Extents.z : -local.Extents.z) };
+					for (int i = 0; i < 3; ++i) {
+						auto v = p[0] * expected[0][i] + p[1] * expected[1][i] + p[2] * expected[2][i] + expected[3][i];
+						lower[i] = (std::min)(lower[i], v);
+						upper[i] = (std::max)(upper[i], v);
+					}
+				}
+				const auto& bounds = store.GetWorldBounds(handle);
+				double center[3] = { bounds.Center.x, bounds.Center.y, bounds.Center.z };
+				double extents[3] = { bounds.Extents.x, bounds.Extents.y, bounds.Extents.z };
+				for (int i = 0; i < 3; ++i) {
+					if (!IsNear(center[i], (lower[i] + upper[i]) / 2, 1e-4) ||
+						!IsNear(extents[i], (upper[i] - lower[i]) / 2, 1e-4)) {
+						return false;
+					}
+				}
+			}
+			return true;
+		}
+
+	private:
+		std::map<std::uint64_t, ObjectHandle> m_Parents;
+		std::set<std::uint64_t> m_Marked;
+	};
+
+	void SetRandomTransform(Transform& transform, std::mt19937& random)
+	{
+		std::uniform_real_distribution<float> position(-10.0f, 10.0f);
+		std::uniform_real_distribution<float> angle(-3.14f, 3.14f);
+		std::uniform_real_distribution<float> scale(0.5f, 2.0f);
+		transform.SetPosition(position(random), position(random), position(random));
+		transform.SetRotation(angle(random), angle(random), angle(random));
+		transform.SetScale(scale(random), scale(random), scale(random));
+	}
+}
+
+TEST_CASE(ObjectStore_HandleGenerations)
+{
+	ObjectStore store;
+	auto opaque = GetRenderLayerMask(RenderLayer::Opaque);
+	auto a = store.Create("A", nullptr, opaque);
+	auto b = store.Create("B", nullptr, opaque);
+	CHECK(a.IsValid() && b.IsValid() && a != b);
+	CHECK(!store.Create("A", nullptr, opaque).IsValid());
+	CHECK(store.Find("B") == b);
+	CHECK(!store.Find("C").IsValid());
+	CHECK(!store.IsAlive(ObjectHandle{}));
+	CHECK(store.GetDenseIndex(ObjectHandle{ 1000, 0 }) == ObjectHandle::InvalidIndex);
+
+	// 删除后旧句柄失效，槽位被复用时代数不同
+	CHECK(store.Destroy(a));
+	CHECK(!store.Destroy(a));
+	CHECK(!store.IsAlive(a));
+	CHECK(!store.Find("A").IsValid());
+	auto c = store.Create("A", nullptr, opaque);
+	CHECK(c.m_Index == a.m_Index && c.m_Generation != a.m_Generation);
+	CHECK(!store.IsAlive(a) && store.IsAlive(c));
+	CHECK(store.Find("A") == c);
+
+	// Clear 之后之前的句柄全部失效，新物体复用槽位
+	store.Clear();
+	CHECK(store.Size() == 0);
+	CHECK(!store.IsAlive(b) && !store.IsAlive(c));
+	auto d = store.Create("D", nullptr, opaque);
+	auto e = store.Create("E", nullptr, opaque);
+	CHECK(store.Size() == 2);
+	for (auto old : { a, b, c }) {
+		CHECK(!store.IsAlive(old));
+		CHECK(old != d && old != e);
+	}
+}
+
+TEST_CASE(ObjectStore_DenseArraysFollowHandles)
+{
+	auto modelA = GetBoxModel("A", { 0, 1, 0 }, { 1, 1, 1 });
+	auto modelB = GetBoxModel("B", { 2, 0, 0 }, { 0.5f, 2, 0.5f });
+	ObjectStore store;
+	std::vector<ObjectHandle> handles;
+	for (int i = 0; i < 5; ++i) {
+		handles.push_back(store.Create("Object" + std::to_string(i), i % 2 ? &modelA : &modelB,
+			GetRenderLayerMask(static_cast<RenderLayer>(i % 3))));
+	}
+	store.UpdateWorldMatrices();
+
+	// 删除中间的物体，最后一个物体移动到空位，仍可通过句柄访问
+	store.Destroy(handles[1]);
+	CHECK(store.GetDenseIndex(handles[4]) == 1);
+	CHECK(store.GetHandles()[1] == handles[4]);
+	CHECK(store.GetName(handles[4]) == "Object4");
+	CHECK(store.GetModel(handles[4]) == &modelB);
+	CHECK(store.GetLayerMask(handles[4]) == GetRenderLayerMask(RenderLayer::Transparent));
+	CHECK(store.GetWorldBounds(handles[4]).Center.x == 2.0f);
+	CHECK(store.GetLocalBounds()[1].Extents.y == 2.0f);
+
+	// 模型改变时局部包围盒随之更新
+	store.SetModel(handles[4], &modelA);
+	store.UpdateWorldMatrices();
+	CHECK(store.GetWorldBounds(handles[4]).Center.y == 1.0f);
+	CHECK(ObjectStore::ComputeModelBounds(nullptr).Extents.x == BoundingBox{}.Extents.x);
+
+	// 多个网格的包围盒取并集
+	auto merged = GetBoxModel("Merged", { 0, 0, 0 }, { 1, 1, 1 });
+	ModelMesh mesh{};
+	mesh.m_Name = "Second";
+	mesh.m_BoundingBox.Center = { 4, 0, 0 };
+	mesh.m_BoundingBox.Extents = { 1, 3, 1 };
+	merged.SetMesh(mesh);
+	auto bounds = ObjectStore::ComputeModelBounds(&merged);
+	CHECK(bounds.Center.x == 2.0f && bounds.Extents.x == 3.0f && bounds.Extents.y == 3.0f);
+}
+
+TEST_CASE(ObjectStore_RandomHandlesAgainstReference)
+{
+	auto model = GetBoxModel("Box", { 0, 0, 0 }, { 1, 1, 1 });
+	ObjectStore store;
+	std::map<std::uint64_t, ReferenceObject> reference;
+	std::vector<ObjectHandle> alive;
+	std::vector<ObjectHandle> dead;
+	std::mt19937 random(22);
+
+	int nameCounter = 0;
+	for (int step = 0; step < 20000; ++step) {
+		auto op = random() % 10;
+		if (op < 5 || alive.empty()) {
+			// 偶尔复用已删除物体的名称
+			auto name = "Object" + std::to_string(random() % 4 == 0 && nameCounter > 0 ? random() % nameCounter : nameCounter++);
+			auto layerMask = static_cast<RenderLayerMask>(random() % 32);
+			auto handle = store.Create(name, random() % 2 ? &model : nullptr, layerMask);
+			bool nameTaken = std::any_of(reference.begin(), reference.end(), [&name](const auto& item) {
+				return item.second.m_Name == name;
+				});
+			CHECK(handle.IsValid() == !nameTaken);
+			if (handle.IsValid()) {
+				CHECK(!reference.contains(GetHandleKey(handle)));
+				reference[GetHandleKey(handle)] = { name, store.GetModel(handle), layerMask };
+				alive.push_back(handle);
+			}
+		}
+		else if (op < 8) {
+			auto i = random() % alive.size();
+			CHECK(store.Destroy(alive[i]));
+			reference.erase(GetHandleKey(alive[i]));
+			dead.push_back(alive[i]);
+			alive[i] = alive.back();
+			alive.pop_back();
+		}
+		else if (op < 9) {
+			auto handle = alive[random() % alive.size()];
+			auto layerMask = static_cast<RenderLayerMask>(random() % 32);
+			store.SetLayerMask(handle, layerMask);
+			reference[GetHandleKey(handle)].m_LayerMask = layerMask;
+		}
+		else {
+			// 已删除物体的句柄不会指向复用其槽位的新物体
+			if (!dead.empty()) {
+				auto handle = dead[random() % dead.size()];
+				CHECK(!store.IsAlive(handle));
+				CHECK(!store.Destroy(handle));
+			}
+		}
+		if (step % 97 == 0) {
+			CHECK(MatchesReference(store, reference));
+		}
+	}
+	CHECK(MatchesReference(store, reference));
+	for (auto handle : dead) {
+		CHECK(!store.IsAlive(handle));
+	}
+}
+
+TEST_CASE(ObjectStore_PropagatesDirtySubtrees)
+{
+	ObjectStore store;
+	auto layer = GetRenderLayerMask(RenderLayer::Opaque);
+	auto root = store.Create("Root", nullptr, layer);
+	auto arm = store.Create("Arm", nullptr, layer);
+	auto hand = store.Create("Hand", nullptr, layer);
+	auto other = store.Create("Other", nullptr, layer);
+	CHECK(store.SetParent(arm, root));
+	CHECK(store.SetParent(hand, arm));
+	CHECK(store.UpdateWorldMatrices() == 4);
+	CHECK(store.UpdateWorldMatrices() == 0);
+
+	// 只有被修改的物体及其子树重新计算
+	store.GetTransform(hand).SetPosition(0, 0, 1);
+	CHECK(store.UpdateWorldMatrices() == 1);
+	store.GetTransform(root).SetPosition(10, 0, 0);
+	store.GetTransform(hand).SetPosition(0, 0, 2);
+	CHECK(store.UpdateWorldMatrices() == 3);
+	CHECK(store.GetWorldMatrix(hand).m[3][0] == 10.0f && store.GetWorldMatrix(hand).m[3][2] == 2.0f);
+	CHECK(store.GetWorldMatrix(other).m[3][0] == 0.0f);
+
+	// 只读访问不标记
+	const auto& constStore = store;
+	CHECK(constStore.GetTransform(root).GetPosition().x == 10.0f);
+	CHECK(store.UpdateWorldMatrices() == 0);
+
+	// 不能成为自身或后代的子物体
+	CHECK(!store.SetParent(root, hand));
+	CHECK(!store.SetParent(root, root));
+	CHECK(!store.SetParent(root, ObjectHandle{ 77, 0 }));
+	CHECK(store.SetParent(hand, root));
+	CHECK(store.UpdateWorldMatrices() == 1);
+	CHECK(store.SetParent(hand, root));
+	CHECK(store.UpdateWorldMatrices() == 0);
+
+	// 删除父物体时一并删除子物体
+	CHECK(store.SetParent(hand, arm));
+	CHECK(store.Destroy(arm));
+	CHECK(!store.IsAlive(hand) && store.IsAlive(root) && store.IsAlive(other));
+	CHECK(store.Size() == 2);
+	CHECK(store.UpdateWorldMatrices() == 0);
+	CHECK(store.SetParent(other, root));
+	CHECK(store.UpdateWorldMatrices() == 1);
+	CHECK(store.GetWorldMatrix(other).m[3][0] == 10.0f);
+}
+
+TEST_CASE(ObjectStore_RandomHierarchyAgainstReference)
+{
+	auto modelA = GetBoxModel("A", { 0, 1, 0 }, { 1, 2, 0.5f });
+	auto modelB = GetBoxModel("B", { -1, 0, 2 }, { 0.25f, 0.5f, 3 });
+	ObjectStore store;
+	ReferenceHierarchy reference;
+	std::vector<ObjectHandle> alive;
+	std::mt19937 random(23);
+
+	auto randomAlive = [&]() { return alive[random() % alive.size()]; };
+	int nameCounter = 0;
+	for (int frame = 0; frame < 600; ++frame) {
+		auto opCount = random() % 12;
+		for (std::uint32_t op = 0; op < opCount; ++op) {
+			auto kind = random() % 16;
+			if (kind < 4 || alive.empty()) {
+				// 新物体挂在随机的父物体下，形成最深十几层的森林
+				auto handle = store.Create("Object" + std::to_string(nameCounter++), random() % 2 ? &modelA : &modelB, 1);
+				SetRandomTransform(store.GetTransform(handle), random);
+				auto parent = alive.empty() || random() % 4 == 0 ? ObjectHandle{} : randomAlive();
+				CHECK(store.SetParent(handle, parent));
+				reference.Add(handle, parent);
+				alive.push_back(handle);
+			}
+			else if (kind < 9) {
+				auto handle = randomAlive();
+				SetRandomTransform(store.GetTransform(handle), random);
+				reference.Mark(handle);
+			}
+			else if (kind < 12) {
+				auto child = randomAlive();
+				auto parent = random() % 5 == 0 ? ObjectHandle{} : randomAlive();
+				bool expected = !parent.IsValid() || !reference.IsAncestorOrSelf(child, parent);
+				CHECK(store.SetParent(child, parent) == expected);
+				if (expected) reference.SetParent(child, parent);
+			}
+			else if (kind < 13) {
+				auto handle = randomAlive();
+				store.SetModel(handle, random() % 2 ? &modelA : nullptr);
+				reference.Mark(handle);
+			}
+			else if (kind < 14 && alive.size() > 20) {
+				auto handle = randomAlive();
+				auto removed = reference.Remove(handle);
+				CHECK(store.Destroy(handle));
+				for (auto object : removed) {
+					CHECK(!store.IsAlive(object));
+					alive.erase(std::find(alive.begin(), alive.end(), object));
+				}
+			}
+		}
+		CHECK(store.UpdateWorldMatrices() == reference.TakeExpectedUpdateCount());
+		if (frame % 10 == 0) {
+			CHECK(reference.MatchesStore(store));
+		}
+	}
+	CHECK(reference.MatchesStore(store));
+	CHECK(store.UpdateWorldMatrices() == 0);
+}
+
+BENCHMARK(ObjectStore_HandleLookup)
+{
+	// 通过句柄随机访问物体与顺序遍历稠密数组比较
+	ObjectStore store;
+	store.Reserve(16384);
+	std::vector<ObjectHandle> handles;
+	for (int i = 0; i < 16384; ++i) {
+		handles.push_back(store.Create("Object" + std::to_string(i), nullptr, static_cast<RenderLayerMask>(i % 8)));
+	}
+	std::mt19937 random(2222);
+	for (int i = 0; i < 4096; ++i) {
+		store.Destroy(handles[random() % handles.size()]);
+	}
+	std::shuffle(handles.begin(), handles.end(), random);
+
+	Test::Benchmark("IsAlive + GetLayerMask (random handles)", handles.size(), [&]() {
+		std::uint64_t sum = 0;
+		for (auto handle : handles) {
+			if (store.IsAlive(handle)) sum += store.GetLayerMask(handle);
+		}
+		Test::DoNotOptimize(sum);
+		});
+	Test::Benchmark("GetLayerMasks (dense)", store.Size(), [&]() {
+		std::uint64_t sum = 0;
+		for (auto layerMask : store.GetLayerMasks()) sum += layerMask;
+		Test::DoNotOptimize(sum);
+		});
+}
+
+BENCHMARK(ObjectStore_UpdateWorldMatrices)
+{
+	// 400 棵每层分为 3 支、深度为 4 的树，共 16000 个物体，比较全部移动、少量叶子移动与静止时的耗时
+	ObjectStore store;
+	store.Reserve(16000);
+	std::mt19937 random(2323);
+	std::vector<ObjectHandle> roots;
+	std::vector<ObjectHandle> leaves;
+	auto create = [&](ObjectHandle parent) {
+		auto handle = store.Create("Object" + std::to_string(store.Size()), nullptr, 1);
+		SetRandomTransform(store.GetTransform(handle), random);
+		store.SetParent(handle, parent);
+		return handle;
+		};
+	for (int tree = 0; tree < 400; ++tree) {
+		std::vector<ObjectHandle> level{ create(ObjectHandle{}) };
+		roots.push_back(level.front());
+		for (int depth = 1; depth < 4; ++depth) {
+			std::vector<ObjectHandle> next;
+			for (auto parent : level) {
+				for (int i = 0; i < 3; ++i) next.push_back(create(parent));
+			}
+			level = std::move(next);
+		}
+		leaves.insert(leaves.end(), level.begin(), level.end());
+	}
+	store.UpdateWorldMatrices();
+
+	float offset = 0.0f;
+	Test::Benchmark("all roots moved", store.Size(), [&]() {
+		offset += 0.01f;
+		for (auto root : roots) store.GetTransform(root).SetPosition(offset, 0, 0);
+		Test::DoNotOptimize(store.UpdateWorldMatrices());
+		});
+	Test::Benchmark("1% of leaves moved", store.Size(), [&]() {
+		offset += 0.01f;
+		for (std::size_t i = 0; i < leaves.size() / 100; ++i) {
+			store.GetTransform(leaves[random() % leaves.size()]).SetPosition(offset, 0, 0);
+		}
+		Test::DoNotOptimize(store.UpdateWorldMatrices());
+		});
+	Test::Benchmark("static", store.Size(), [&]() {
+		Test::DoNotOptimize(store.UpdateWorldMatrices());
+		});
+}
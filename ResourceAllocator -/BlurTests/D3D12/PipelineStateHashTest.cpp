@@ -0,0 +1,261 @@
+#include "TestFramework.h"
+#include "D3D12PipelineStateCache.h"
+#include <climits>
+#include <functional>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace DSM;
+
+namespace {
+	using PSODescMutator = std::function<void(D3D12_GRAPHICS_PIPELINE_STATE_DESC&)>;
+
+	// 描述中的指针都指向这里持有的数据，复制一份即可得到内容相同但地址不同的描述
+	struct GraphicsPSOData
+	{
+		std::vector<std::uint8_t> m_VS;
+		std::vector<std::uint8_t> m_PS;
+		std::vector<std::string> m_SemanticNames;
+		std::vector<D3D12_INPUT_ELEMENT_DESC> m_InputElements;
+		D3D12_GRAPHICS_PIPELINE_STATE_DESC m_Desc{};
+
+		GraphicsPSOData(std::size_t vsSize = 64, std::size_t psSize = 96)
+			:m_VS(vsSize), m_PS(psSize), m_SemanticNames{ "POSITION", "NORMAL", "TEXCOORD" } {
+			for (std::size_t i = 0; i < m_VS.size(); ++i) m_VS[i] = static_cast<std::uint8_t>(i * 7);
+			for (std::size_t i = 0; i < m_PS.size(); ++i) m_PS[i] = static_cast<std::uint8_t>(i * 13);
+
+			m_InputElements = {
+				{ nullptr, 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 0, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
+				{ nullptr, 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 12, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
+				{ nullptr, 0, DXGI_FORMAT_R32G32_FLOAT, 0, 24, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 } };
+			BindPointers();
+
+			auto& desc = m_Desc;
+			for (auto& target : desc.BlendState.RenderTarget) {
+				target.SrcBlend = D3D12_BLEND_ONE;
+				target.DestBlend = D3D12_BLEND_ZERO;
+				target.BlendOp = D3D12_BLEND_OP_ADD;
+				target.SrcBlendAlpha = D3D12_BLEND_ONE;
+				target.DestBlendAlpha = D3D12_BLEND_ZERO;
+				target.BlendOpAlpha = D3D12_BLEND_OP_ADD;
+				target.LogicOp = D3D12_LOGIC_OP_NOOP;
+				target.RenderTargetWriteMask = D3D12_COLOR_WRITE_ENABLE_ALL;
+			}
+			desc.SampleMask = UINT_MAX;
+			desc.RasterizerState.FillMode = D3D12_FILL_MODE_SOLID;
+			desc.RasterizerState.CullMode = D3D12_CULL_MODE_BACK;
+			desc.RasterizerState.DepthClipEnable = TRUE;
+			desc.DepthStencilState.DepthEnable = TRUE;
+			desc.DepthStencilState.DepthWriteMask = D3D12_DEPTH_WRITE_MASK_ALL;
+			desc.DepthStencilState.DepthFunc = D3D12_COMPARISON_FUNC_LESS;
+			for (auto* face : { &desc.DepthStencilState.FrontFace, &desc.DepthStencilState.BackFace }) {
+				face->StencilFailOp = D3D12_STENCIL_OP_KEEP;
+				face->StencilDepthFailOp = D3D12_STENCIL_OP_KEEP;
+				face->StencilPassOp = D3D12_STENCIL_OP_KEEP;
+				face->StencilFunc = D3D12_COMPARISON_FUNC_ALWAYS;
+			}
+			desc.PrimitiveTopologyType = D3D12_PRIMITIVE_TOPOLOGY_TYPE_TRIANGLE;
+			desc.NumRenderTargets = 1;
+			desc.RTVFormats[0] = DXGI_FORMAT_R8G8B8A8_UNORM;
+			desc.DSVFormat = DXGI_FORMAT_D24_UNORM_S8_UINT;
+			desc.SampleDesc = { 1, 0 };
+		}
+
+		GraphicsPSOData(const GraphicsPSOData& other)
+			:m_VS(other.m_VS), m_PS(other.m_PS), m_SemanticNames(other.m_SemanticNames),
+			m_InputElements(other.m_InputElements), m_Desc(other.m_Desc) {
+			BindPointers();
+		}
+
+		GraphicsPSOData& operator=(const GraphicsPSOData&) = delete;
+
+		void BindPointers()
+		{
+			for (std::size_t i = 0; i < m_InputElements.size(); ++i) {
+				m_InputElements[i].SemanticName = m_SemanticNames[i].c_str();
+			}
+			m_Desc.VS = { m_VS.data(), m_VS.size() };
+			m_Desc.PS = { m_PS.data(), m_PS.size() };
+			m_Desc.InputLayout = { m_InputElements.data(), static_cast<UINT>(m_InputElements.size()) };
+		}
+
+		std::uint64_t GetHash(std::uint64_t rootSignatureHash = 1) const
+		{
+			return D3D12PipelineStateCache::HashGraphicsPSODesc(m_Desc, rootSignatureHash);
+		}
+	};
+
+	std::uint64_t HashBytesReference(const void* data, std::size_t size)
+	{
+		// 与 D3D12PipelineStateCache 相同的 FNV-1a，长度以 64 位小端写在前面
+		std::uint64_t hash = 14695981039346656037ull;
+		auto add = [&hash](std::uint8_t byte) {
+			hash ^= byte;
+			hash *= 1099511628211ull;
+			};
+		for (int i = 0; i < 8; ++i) add(static_cast<std::uint8_t>(static_cast<std::uint64_t>(size) >> (i * 8)));
+		for (std::size_t i = 0; i < size; ++i) add(static_cast<const std::uint8_t*>(data)[i]);
+		return hash;
+	}
+}
+
+TEST_CASE(PipelineStateHash_RootSignatureIsContentHash)
+{
+	const std::uint8_t serialized[] = { 0x44, 0x58, 0x42, 0x43, 0x00, 0x01, 0x02 };
+	std::vector<std::uint8_t> copy(std::begin(serialized), std::end(serialized));
+	auto hash = D3D12PipelineStateCache::HashRootSignature(serialized, sizeof(serialized));
+	CHECK(hash == HashBytesReference(serialized, sizeof(serialized)));
+	CHECK(hash == D3D12PipelineStateCache::HashRootSignature(copy.data(), copy.size()));
+	copy.back() ^= 1;
+	CHECK(hash != D3D12PipelineStateCache::HashRootSignature(copy.data(), copy.size()));
+	// 长度参与计算，前缀不会与整体相同
+	CHECK(hash != D3D12PipelineStateCache::HashRootSignature(serialized, sizeof(serialized) - 1));
+}
+
+TEST_CASE(PipelineStateHash_PointersHashByContent)
+{
+	GraphicsPSOData data;
+	GraphicsPSOData copy(data);
+	// 着色器、语义名与根签名对象都在不同的地址
+	CHECK(copy.m_Desc.VS.pShaderBytecode != data.m_Desc.VS.pShaderBytecode);
+	CHECK(copy.m_InputElements[0].SemanticName != data.m_InputElements[0].SemanticName);
+	ID3D12RootSignature* fakeRootSignature = reinterpret_cast<ID3D12RootSignature*>(std::uintptr_t{ 0x1000 });
+	copy.m_Desc.pRootSignature = fakeRootSignature;
+	CHECK(copy.GetHash() == data.GetHash());
+
+	// 流输出声明同样按内容计算
+	std::string semantic = "SV_Position";
+	std::string semanticCopy = semantic;
+	D3D12_SO_DECLARATION_ENTRY entry{ 0, semantic.c_str(), 0, 0, 4, 0 };
+	D3D12_SO_DECLARATION_ENTRY entryCopy{ 0, semanticCopy.c_str(), 0, 0, 4, 0 };
+	UINT strides[] = { 16 };
+	UINT stridesCopy[] = { 16 };
+	data.m_Desc.StreamOutput = { &entry, 1, strides, 1, 0 };
+	copy.m_Desc.StreamOutput = { &entryCopy, 1, stridesCopy, 1, 0 };
+	CHECK(copy.GetHash() == data.GetHash());
+	stridesCopy[0] = 32;
+	CHECK(copy.GetHash() != data.GetHash());
+}
+
+TEST_CASE(PipelineStateHash_IgnoresFieldsTheDriverIgnores)
+{
+	GraphicsPSOData data;
+	auto hash = data.GetHash();
+	CHECK(hash == data.GetHash());
+
+	// CachedPSO 只是创建的加速手段，不影响键
+	const std::uint8_t blob[] = { 1, 2, 3, 4 };
+	GraphicsPSOData cached(data);
+	cached.m_Desc.CachedPSO = { blob, sizeof(blob) };
+	CHECK(cached.GetHash() == hash);
+
+	// 超出 NumRenderTargets 的格式不使用
+	GraphicsPSOData unusedFormat(data);
+	unusedFormat.m_Desc.RTVFormats[3] = DXGI_FORMAT_R16G16B16A16_FLOAT;
+	CHECK(unusedFormat.GetHash() == hash);
+
+	// 未开启独立混合时只使用第一个渲染目标的混合设置
+	GraphicsPSOData unusedBlend(data);
+	unusedBlend.m_Desc.BlendState.RenderTarget[5].BlendEnable = TRUE;
+	CHECK(unusedBlend.GetHash() == hash);
+	unusedBlend.m_Desc.BlendState.IndependentBlendEnable = TRUE;
+	auto independentHash = unusedBlend.GetHash();
+	CHECK(independentHash != hash);
+	unusedBlend.m_Desc.BlendState.RenderTarget[5].BlendEnable = FALSE;
+	CHECK(unusedBlend.GetHash() != independentHash);
+}
+
+TEST_CASE(PipelineStateHash_EveryStateFieldChangesTheKey)
+{
+	std::vector<std::pair<const char*, PSODescMutator>> mutators = {
+		{ "VS", [](auto& desc) { const_cast<std::uint8_t*>(static_cast<const std::uint8_t*>(desc.VS.pShaderBytecode))[5] ^= 1; } },
+		{ "PS size", [](auto& desc) { --desc.PS.BytecodeLength; } },
+		{ "GS", [](auto& desc) { desc.GS = desc.VS; } },
+		{ "AlphaToCoverage", [](auto& desc) { desc.BlendState.AlphaToCoverageEnable = TRUE; } },
+		{ "BlendEnable", [](auto& desc) { desc.BlendState.RenderTarget[0].BlendEnable = TRUE; } },
+		{ "SrcBlend", [](auto& desc) { desc.BlendState.RenderTarget[0].SrcBlend = D3D12_BLEND_SRC_ALPHA; } },
+		{ "DestBlend", [](auto& desc) { desc.BlendState.RenderTarget[0].DestBlend = D3D12_BLEND_INV_SRC_ALPHA; } },
+		{ "BlendOpAlpha", [](auto& desc) { desc.BlendState.RenderTarget[0].BlendOpAlpha = D3D12_BLEND_OP_MAX; } },
+		{ "WriteMask", [](auto& desc) { desc.BlendState.RenderTarget[0].RenderTargetWriteMask = D3D12_COLOR_WRITE_ENABLE_RED; } },
+		{ "SampleMask", [](auto& desc) { desc.SampleMask = 0xF; } },
+		{ "FillMode", [](auto& desc) { desc.RasterizerState.FillMode = D3D12_FILL_MODE_WIREFRAME; } },
+		{ "CullMode", [](auto& desc) { desc.RasterizerState.CullMode = D3D12_CULL_MODE_FRONT; } },
+		{ "FrontCounterClockwise", [](auto& desc) { desc.RasterizerState.FrontCounterClockwise = TRUE; } },
+		{ "DepthBias", [](auto& desc) { desc.RasterizerState.DepthBias = 100; } },
+		{ "SlopeScaledDepthBias", [](auto& desc) { desc.RasterizerState.SlopeScaledDepthBias = 1.5f; } },
+		{ "DepthClip", [](auto& desc) { desc.RasterizerState.DepthClipEnable = FALSE; } },
+		{ "ConservativeRaster", [](auto& desc) { desc.RasterizerState.ConservativeRaster = D3D12_CONSERVATIVE_RASTERIZATION_MODE_ON; } },
+		{ "DepthEnable", [](auto& desc) { desc.DepthStencilState.DepthEnable = FALSE; } },
+		{ "DepthWriteMask", [](auto& desc) { desc.DepthStencilState.DepthWriteMask = D3D12_DEPTH_WRITE_MASK_ZERO; } },
+		{ "DepthFunc", [](auto& desc) { desc.DepthStencilState.DepthFunc = D3D12_COMPARISON_FUNC_LESS_EQUAL; } },
+		{ "StencilEnable", [](auto& desc) { desc.DepthStencilState.StencilEnable = TRUE; } },
+		{ "FrontStencilPass", [](auto& desc) { desc.DepthStencilState.FrontFace.StencilPassOp = D3D12_STENCIL_OP_REPLACE; } },
+		{ "BackStencilFunc", [](auto& desc) { desc.DepthStencilState.BackFace.StencilFunc = D3D12_COMPARISON_FUNC_EQUAL; } },
+		{ "SemanticName", [](auto& desc) { const_cast<D3D12_INPUT_ELEMENT_DESC*>(desc.InputLayout.pInputElementDescs)[1].SemanticName = "TANGENT"; } },
+		{ "SemanticIndex", [](auto& desc) { const_cast<D3D12_INPUT_ELEMENT_DESC*>(desc.InputLayout.pInputElementDescs)[2].SemanticIndex = 1; } },
+		{ "InputFormat", [](auto& desc) { const_cast<D3D12_INPUT_ELEMENT_DESC*>(desc.InputLayout.pInputElementDescs)[0].Format = DXGI_FORMAT_R16G16B16A16_FLOAT; } },
+		{ "InputOffset", [](auto& desc) { const_cast<D3D12_INPUT_ELEMENT_DESC*>(desc.InputLayout.pInputElementDescs)[2].AlignedByteOffset = 28; } },
+		{ "InputSlotClass", [](auto& desc) { const_cast<D3D12_INPUT_ELEMENT_DESC*>(desc.InputLayout.pInputElementDescs)[2].InputSlotClass = D3D12_INPUT_CLASSIFICATION_PER_INSTANCE_DATA; } },
+		{ "NumElements", [](auto& desc) { --desc.InputLayout.NumElements; } },
+		{ "IBStripCut", [](auto& desc) { desc.IBStripCutValue = D3D12_INDEX_BUFFER_STRIP_CUT_VALUE_0xFFFF; } },
+		{ "Topology", [](auto& desc) { desc.PrimitiveTopologyType = D3D12_PRIMITIVE_TOPOLOGY_TYPE_LINE; } },
+		{ "NumRenderTargets", [](auto& desc) { desc.NumRenderTargets = 2; desc.RTVFormats[1] = DXGI_FORMAT_R8G8B8A8_UNORM; } },
+		{ "RTVFormat", [](auto& desc) { desc.RTVFormats[0] = DXGI_FORMAT_R16G16B16A16_FLOAT; } },
+		{ "DSVFormat", [](auto& desc) { desc.DSVFormat = DXGI_FORMAT_D32_FLOAT; } },
+		{ "SampleCount", [](auto& desc) { desc.SampleDesc.Count = 4; } },
+		{ "SampleQuality", [](auto& desc) { desc.SampleDesc.Quality = 1; } },
+		{ "NodeMask", [](auto& desc) { desc.NodeMask = 1; } },
+		{ "Flags", [](auto& desc) { desc.Flags = D3D12_PIPELINE_STATE_FLAG_TOOL_DEBUG; } } };
+
+	GraphicsPSOData data;
+	std::set<std::uint64_t> hashes{ data.GetHash(), data.GetHash(2) };
+	CHECK(hashes.size() == 2);
+	// 每个字段的改变都得到与其他所有描述不同的键
+	for (const auto& [name, mutate] : mutators) {
+		GraphicsPSOData mutated(data);
+		mutate(mutated.m_Desc);
+		if (!hashes.insert(mutated.GetHash()).second) {
+			Test::Fail(name, __FILE__, __LINE__);
+		}
+	}
+}
+
+TEST_CASE(PipelineStateHash_ComputeDesc)
+{
+	std::vector<std::uint8_t> cs(128, 0x5A);
+	std::vector<std::uint8_t> csCopy = cs;
+	D3D12_COMPUTE_PIPELINE_STATE_DESC desc{};
+	desc.CS = { cs.data(), cs.size() };
+	auto hash = D3D12PipelineStateCache::HashComputePSODesc(desc, 1);
+
+	auto copy = desc;
+	copy.CS = { csCopy.data(), csCopy.size() };
+	copy.CachedPSO = { cs.data(), 4 };
+	CHECK(D3D12PipelineStateCache::HashComputePSODesc(copy, 1) == hash);
+	CHECK(D3D12PipelineStateCache::HashComputePSODesc(desc, 2) != hash);
+	copy.NodeMask = 1;
+	CHECK(D3D12PipelineStateCache::HashComputePSODesc(copy, 1) != hash);
+	csCopy[0] ^= 1;
+	copy.NodeMask = 0;
+	CHECK(D3D12PipelineStateCache::HashComputePSODesc(copy, 1) != hash);
+
+	// 与只有相同顶点着色器的图形管线区分开
+	D3D12_GRAPHICS_PIPELINE_STATE_DESC graphics{};
+	graphics.VS = desc.CS;
+	CHECK(D3D12PipelineStateCache::HashGraphicsPSODesc(graphics, 1) != hash);
+}
+
+BENCHMARK(PipelineStateHash_GraphicsDesc)
+{
+	// 典型大小：4KB 顶点着色器与 12KB 像素着色器，与 PSO 的创建相比可以忽略
+	GraphicsPSOData data(4 * 1024, 12 * 1024);
+	Test::Benchmark("HashGraphicsPSODesc (per desc)", 1, [&]() {
+		Test::DoNotOptimize(data.GetHash());
+		});
+	GraphicsPSOData small(256, 256);
+	Test::Benchmark("HashGraphicsPSODesc, 256B shaders (per desc)", 1, [&]() {
+		Test::DoNotOptimize(small.GetHash());
+		});
+}
@@ -0,0 +1,329 @@
+#include "TestFramework.h"
+#include "RootSignatureLayout.h"
+#include "ShaderCompiler.h"
+#include <algorithm>
+#include <climits>
+#include <map>
+#include <numeric>
+#include <random>
+#include <vector>
+
+using namespace DSM;
+
+namespace {
+	constexpr std::uint32_t GetStageBit(ShaderType type) noexcept
+	{
+		return 1u << static_cast<int>(type);
+	}
+
+	constexpr std::uint32_t VS = GetStageBit(ShaderType::VERTEX_SHADER);
+	constexpr std::uint32_t PS = GetStageBit(ShaderType::PIXEL_SHADER);
+	constexpr std::uint32_t CS = GetStageBit(ShaderType::COMPUTE_SHADER);
+
+	RootBindingDesc CBV(std::uint32_t bindPoint, std::uint32_t byteSize, std::uint32_t stageMask)
+	{
+		return { RootBindingType::CONSTANT_BUFFER, bindPoint, 0, 1, byteSize, stageMask };
+	}
+
+	RootBindingDesc SRV(std::uint32_t bindPoint, std::uint32_t stageMask, std::uint32_t bindCount = 1, std::uint32_t space = 0)
+	{
+		return { RootBindingType::SHADER_RESOURCE, bindPoint, space, bindCount, 0, stageMask };
+	}
+
+	RootBindingDesc UAV(std::uint32_t bindPoint, std::uint32_t stageMask)
+	{
+		return { RootBindingType::RW_RESOURCE, bindPoint, 0, 1, 0, stageMask };
+	}
+
+	std::uint32_t GetParameterCost(const RootParameterLayout& param)
+	{
+		switch (param.m_ParameterType) {
+		case D3D12_ROOT_PARAMETER_TYPE_32BIT_CONSTANTS: return param.m_Num32BitValues;
+		case D3D12_ROOT_PARAMETER_TYPE_CBV: return 2;
+		default: return 1;
+		}
+	}
+
+	// 根参数的种类决定其在布局中的顺序
+	int GetParameterRank(const RootParameterLayout& param)
+	{
+		if (param.m_IsUnbounded) return 3;
+		switch (param.m_ParameterType) {
+		case D3D12_ROOT_PARAMETER_TYPE_32BIT_CONSTANTS: return 0;
+		case D3D12_ROOT_PARAMETER_TYPE_CBV: return 1;
+		default: return 2;
+		}
+	}
+
+	std::vector<RootBindingDesc> GenerateBindings(std::mt19937& random)
+	{
+		const std::uint32_t stageMasks[] = { 0, VS, PS, VS | PS, VS | PS };
+		std::vector<RootBindingDesc> bindings;
+		auto cbCount = random() % 7;
+		for (std::uint32_t i = 0; i < cbCount; ++i) {
+			// 偶尔出现不是 4 的倍数的大小
+			std::uint32_t byteSize = random() % 8 == 0 ? 4 * (1 + random() % 40) + 2 : 16 * (1 + random() % 24);
+			bindings.push_back(CBV(i, byteSize, stageMasks[random() % 5]));
+		}
+		// SRV 与 UAV 的寄存器随机留空，使部分范围可以合并
+		for (auto type : { RootBindingType::SHADER_RESOURCE, RootBindingType::RW_RESOURCE }) {
+			std::uint32_t bindPoint = 0;
+			auto count = random() % 8;
+			for (std::uint32_t i = 0; i < count; ++i) {
+				bindPoint += random() % 3 == 0 ? 1 : 0;
+				std::uint32_t bindCount = 1 + random() % 3;
+				bindings.push_back({ type, bindPoint, random() % 4 == 0 ? 1u : 0u, bindCount, 0, stageMasks[random() % 5] });
+				bindPoint += bindCount;
+			}
+		}
+		if (random() % 2 == 0) {
+			bindings.push_back(SRV(0, PS, UINT_MAX, 2));
+		}
+		std::shuffle(bindings.begin(), bindings.end(), random);
+		return bindings;
+	}
+
+	void CheckLayoutInvariants(
+		const std::vector<RootBindingDesc>& bindings,
+		const RootSignatureLayoutOptions& options,
+		const RootSignatureLayout& layout)
+	{
+		std::vector<int> useCount(bindings.size(), 0);
+		std::uint32_t size = 0;
+		int prevRank = 0;
+		std::map<D3D12_SHADER_VISIBILITY, int> boundedTables;
+		for (const auto& param : layout.m_Parameters) {
+			size += GetParameterCost(param);
+			auto rank = GetParameterRank(param);
+			CHECK(rank >= prevRank);
+			prevRank = rank;
+
+			if (param.m_ParameterType != D3D12_ROOT_PARAMETER_TYPE_DESCRIPTOR_TABLE) {
+				const auto& binding = bindings[param.m_Binding];
+				++useCount[param.m_Binding];
+				CHECK(binding.m_Type == RootBindingType::CONSTANT_BUFFER);
+				CHECK(param.m_Visibility == GetShaderVisibility(binding.m_StageMask, options.m_IsCompute));
+				if (param.m_ParameterType == D3D12_ROOT_PARAMETER_TYPE_32BIT_CONSTANTS) {
+					CHECK(binding.m_ByteSize % 4 == 0 && binding.m_ByteSize <= options.m_MaxRootConstantBytes);
+					CHECK(param.m_Num32BitValues == binding.m_ByteSize / 4);
+				}
+				continue;
+			}
+
+			if (!param.m_IsUnbounded) {
+				CHECK(++boundedTables[param.m_Visibility] == 1);
+			}
+			for (const auto& range : param.m_Ranges) {
+				// 范围中的绑定寄存器连续且与范围的类型、空间一致
+				auto next = range.m_BaseShaderRegister;
+				for (auto index : range.m_Bindings) {
+					const auto& binding = bindings[index];
+					++useCount[index];
+					CHECK(binding.m_Type != RootBindingType::CONSTANT_BUFFER);
+					CHECK((range.m_RangeType == D3D12_DESCRIPTOR_RANGE_TYPE_SRV) == (binding.m_Type == RootBindingType::SHADER_RESOURCE));
+					CHECK(binding.m_RegisterSpace == range.m_RegisterSpace);
+					CHECK(binding.m_BindPoint == next);
+					CHECK(param.m_Visibility == GetShaderVisibility(binding.m_StageMask, options.m_IsCompute));
+					next = binding.m_BindCount == UINT_MAX ? UINT_MAX : next + binding.m_BindCount;
+				}
+				CHECK(param.m_IsUnbounded ? range.m_NumDescriptors == UINT_MAX :
+					range.m_BaseShaderRegister + range.m_NumDescriptors == next);
+			}
+		}
+
+		// 每个使用到的绑定恰好出现一次
+		for (std::size_t i = 0; i < bindings.size(); ++i) {
+			CHECK(useCount[i] == (bindings[i].m_StageMask != 0 ? 1 : 0));
+		}
+		CHECK(size == layout.m_SizeInDWords);
+
+		// 仍为根描述符的常量缓冲区都无法在预算内放入根常量
+		for (const auto& param : layout.m_Parameters) {
+			if (param.m_ParameterType != D3D12_ROOT_PARAMETER_TYPE_CBV) continue;
+			const auto& binding = bindings[param.m_Binding];
+			if (binding.m_ByteSize == 0 || binding.m_ByteSize % 4 != 0 || binding.m_ByteSize > options.m_MaxRootConstantBytes) continue;
+			CHECK(layout.m_SizeInDWords - 2 + binding.m_ByteSize / 4 > options.m_MaxRootSignatureDWords);
+		}
+	}
+}
+
+TEST_CASE(RootSignatureLayout_LitShader)
+{
+	std::vector<RootBindingDesc> bindings = {
+		CBV(0, 128, VS),
+		CBV(1, 400, VS | PS),
+		CBV(2, 160, PS),
+		CBV(3, 48, PS),
+		SRV(1, PS),
+		SRV(0, PS),
+		SRV(0, PS, UINT_MAX, 1),
+		// 未被任何阶段使用
+		SRV(5, 0) };
+	RootSignatureLayoutOptions options;
+	options.m_StageMask = VS | PS;
+	auto layout = BuildRootSignatureLayout(bindings, options);
+	CheckLayoutInvariants(bindings, options, layout);
+
+	const auto& params = layout.m_Parameters;
+	CHECK(params.size() == 6);
+	// 较小的常量缓冲区放入根常量，并按寄存器排序
+	CHECK(params[0].m_ParameterType == D3D12_ROOT_PARAMETER_TYPE_32BIT_CONSTANTS);
+	CHECK(params[0].m_Binding == 0 && params[0].m_Num32BitValues == 32);
+	CHECK(params[0].m_Visibility == D3D12_SHADER_VISIBILITY_VERTEX);
+	CHECK(params[1].m_ParameterType == D3D12_ROOT_PARAMETER_TYPE_32BIT_CONSTANTS);
+	CHECK(params[1].m_Binding == 3 && params[1].m_Visibility == D3D12_SHADER_VISIBILITY_PIXEL);
+	CHECK(params[2].m_ParameterType == D3D12_ROOT_PARAMETER_TYPE_CBV);
+	CHECK(params[2].m_Binding == 1 && params[2].m_Visibility == D3D12_SHADER_VISIBILITY_ALL);
+	CHECK(params[2].m_DescriptorFlags == D3D12_ROOT_DESCRIPTOR_FLAG_DATA_STATIC_WHILE_SET_AT_EXECUTE);
+	CHECK(params[3].m_ParameterType == D3D12_ROOT_PARAMETER_TYPE_CBV && params[3].m_Binding == 2);
+
+	// t0 与 t1 合并为一个范围，按寄存器顺序复制
+	const auto& table = params[4];
+	CHECK(table.m_ParameterType == D3D12_ROOT_PARAMETER_TYPE_DESCRIPTOR_TABLE && !table.m_IsUnbounded);
+	CHECK(table.m_Ranges.size() == 1);
+	CHECK(table.m_Ranges[0].m_BaseShaderRegister == 0 && table.m_Ranges[0].m_NumDescriptors == 2);
+	CHECK(table.m_Ranges[0].m_Bindings == std::vector<std::uint32_t>({ 5, 4 }));
+	CHECK(table.m_Ranges[0].m_Flags == D3D12_DESCRIPTOR_RANGE_FLAG_DATA_STATIC_WHILE_SET_AT_EXECUTE);
+
+	CHECK(params[5].m_IsUnbounded);
+	CHECK(params[5].m_Ranges[0].m_Flags == D3D12_DESCRIPTOR_RANGE_FLAG_DESCRIPTORS_VOLATILE);
+	CHECK(layout.m_SizeInDWords == 32 + 12 + 2 + 2 + 1 + 1);
+	CHECK(layout.m_Flags == (D3D12_ROOT_SIGNATURE_FLAG_ALLOW_INPUT_ASSEMBLER_INPUT_LAYOUT |
+		D3D12_ROOT_SIGNATURE_FLAG_DENY_HULL_SHADER_ROOT_ACCESS |
+		D3D12_ROOT_SIGNATURE_FLAG_DENY_DOMAIN_SHADER_ROOT_ACCESS |
+		D3D12_ROOT_SIGNATURE_FLAG_DENY_GEOMETRY_SHADER_ROOT_ACCESS));
+
+	// 预算紧张时只有最小的常量缓冲区放入根常量
+	options.m_MaxRootSignatureDWords = 30;
+	layout = BuildRootSignatureLayout(bindings, options);
+	CheckLayoutInvariants(bindings, options, layout);
+	CHECK(layout.m_SizeInDWords <= 30);
+	CHECK(layout.m_Parameters[0].m_Binding == 3);
+	CHECK(layout.m_Parameters[1].m_ParameterType == D3D12_ROOT_PARAMETER_TYPE_CBV);
+}
+
+TEST_CASE(RootSignatureLayout_ComputeAndRanges)
+{
+	// 计算着色器的 SRV 与 UAV 共用一个描述符表，但不合并为同一个范围
+	std::vector<RootBindingDesc> compute = { CBV(0, 64, CS), UAV(0, CS), SRV(0, CS) };
+	RootSignatureLayoutOptions computeOptions;
+	computeOptions.m_IsCompute = true;
+	computeOptions.m_StageMask = CS;
+	auto layout = BuildRootSignatureLayout(compute, computeOptions);
+	CheckLayoutInvariants(compute, computeOptions, layout);
+	CHECK(layout.m_Parameters.size() == 2);
+	CHECK(layout.m_Flags == D3D12_ROOT_SIGNATURE_FLAG_NONE);
+	const auto& ranges = layout.m_Parameters[1].m_Ranges;
+	CHECK(ranges.size() == 2);
+	CHECK(ranges[0].m_RangeType == D3D12_DESCRIPTOR_RANGE_TYPE_SRV);
+	CHECK(ranges[1].m_RangeType == D3D12_DESCRIPTOR_RANGE_TYPE_UAV);
+	CHECK(ranges[1].m_Flags == D3D12_DESCRIPTOR_RANGE_FLAG_DATA_VOLATILE);
+
+	// 寄存器不连续时拆分范围，不同可见性使用不同的表
+	std::vector<RootBindingDesc> graphics = { SRV(2, PS), SRV(0, PS), SRV(3, PS, 2), SRV(7, VS) };
+	RootSignatureLayoutOptions options;
+	options.m_StageMask = VS | PS;
+	layout = BuildRootSignatureLayout(graphics, options);
+	CheckLayoutInvariants(graphics, options, layout);
+	CHECK(layout.m_Parameters.size() == 2);
+	for (const auto& param : layout.m_Parameters) {
+		if (param.m_Visibility != D3D12_SHADER_VISIBILITY_PIXEL) continue;
+		CHECK(param.m_Ranges.size() == 2);
+		CHECK(param.m_Ranges[1].m_BaseShaderRegister == 2 && param.m_Ranges[1].m_NumDescriptors == 3);
+	}
+
+	// 大小不是 4 的倍数或超过上限的常量缓冲区不放入根常量
+	std::vector<RootBindingDesc> buffers = { CBV(0, 6, VS), CBV(1, 132, VS), CBV(2, 0, VS) };
+	layout = BuildRootSignatureLayout(buffers, options);
+	CheckLayoutInvariants(buffers, options, layout);
+	for (const auto& param : layout.m_Parameters) {
+		CHECK(param.m_ParameterType == D3D12_ROOT_PARAMETER_TYPE_CBV);
+	}
+}
+
+TEST_CASE(RootSignatureLayout_VisibilityFromStageMask)
+{
+	CHECK(GetShaderVisibility(VS, false) == D3D12_SHADER_VISIBILITY_VERTEX);
+	CHECK(GetShaderVisibility(GetStageBit(ShaderType::HULL_SHADER), false) == D3D12_SHADER_VISIBILITY_HULL);
+	CHECK(GetShaderVisibility(GetStageBit(ShaderType::DOMAIN_SHADER), false) == D3D12_SHADER_VISIBILITY_DOMAIN);
+	CHECK(GetShaderVisibility(GetStageBit(ShaderType::GEOMETRY_SHADER), false) == D3D12_SHADER_VISIBILITY_GEOMETRY);
+	CHECK(GetShaderVisibility(PS, false) == D3D12_SHADER_VISIBILITY_PIXEL);
+	CHECK(GetShaderVisibility(VS | PS, false) == D3D12_SHADER_VISIBILITY_ALL);
+	CHECK(GetShaderVisibility(PS, true) == D3D12_SHADER_VISIBILITY_ALL);
+}
+
+TEST_CASE(RootSignatureLayout_PerStageParams)
+{
+	// 顶点与像素着色器各自的参数常量缓冲区都位于 b0，各占一个只对所属阶段可见的根参数
+	std::vector<RootBindingDesc> bindings = { CBV(0, 64, PS), CBV(1, 256, VS | PS), CBV(0, 64, VS) };
+	auto layout = BuildRootSignatureLayout(bindings, {});
+	CHECK(layout.m_Parameters.size() == 3);
+	CHECK(layout.m_Parameters[0].m_Binding == 2);
+	CHECK(layout.m_Parameters[0].m_Visibility == D3D12_SHADER_VISIBILITY_VERTEX);
+	CHECK(layout.m_Parameters[1].m_Binding == 0);
+	CHECK(layout.m_Parameters[1].m_Visibility == D3D12_SHADER_VISIBILITY_PIXEL);
+
+	// 输入顺序不影响布局
+	std::swap(bindings[0], bindings[2]);
+	auto swapped = BuildRootSignatureLayout(bindings, {});
+	CHECK(swapped.m_Parameters[0].m_Binding == 0);
+	CHECK(swapped.m_Parameters[0].m_Visibility == D3D12_SHADER_VISIBILITY_VERTEX);
+	CHECK(swapped.m_Parameters[1].m_Binding == 2);
+	CHECK(swapped.m_Parameters[1].m_Visibility == D3D12_SHADER_VISIBILITY_PIXEL);
+}
+
+TEST_CASE(RootSignatureLayout_RandomBindings)
+{
+	std::mt19937 random(15);
+	for (int round = 0; round < 2000; ++round) {
+		auto bindings = GenerateBindings(random);
+		RootSignatureLayoutOptions options;
+		options.m_StageMask = VS | PS;
+		options.m_MaxRootSignatureDWords = 8 + random() % 57;
+		auto layout = BuildRootSignatureLayout(bindings, options);
+		CheckLayoutInvariants(bindings, options, layout);
+
+		// 布局与反射结果的顺序无关
+		std::vector<std::uint32_t> order(bindings.size());
+		std::iota(order.begin(), order.end(), 0);
+		std::shuffle(order.begin(), order.end(), random);
+		std::vector<RootBindingDesc> shuffled;
+		for (auto index : order) {
+			shuffled.push_back(bindings[index]);
+		}
+		auto shuffledLayout = BuildRootSignatureLayout(shuffled, options);
+		CHECK(shuffledLayout.m_SizeInDWords == layout.m_SizeInDWords);
+		CHECK(shuffledLayout.m_Flags == layout.m_Flags);
+		CHECK(shuffledLayout.m_Parameters.size() == layout.m_Parameters.size());
+		for (std::size_t i = 0; i < layout.m_Parameters.size(); ++i) {
+			const auto& a = layout.m_Parameters[i];
+			const auto& b = shuffledLayout.m_Parameters[i];
+			CHECK(a.m_ParameterType == b.m_ParameterType && a.m_Visibility == b.m_Visibility);
+			CHECK(a.m_Ranges.size() == b.m_Ranges.size());
+			if (a.m_ParameterType != D3D12_ROOT_PARAMETER_TYPE_DESCRIPTOR_TABLE) {
+				CHECK(a.m_Binding == order[b.m_Binding]);
+				continue;
+			}
+			for (std::size_t j = 0; j < a.m_Ranges.size(); ++j) {
+				CHECK(a.m_Ranges[j].m_BaseShaderRegister == b.m_Ranges[j].m_BaseShaderRegister);
+				CHECK(a.m_Ranges[j].m_NumDescriptors == b.m_Ranges[j].m_NumDescriptors);
+				CHECK(a.m_Ranges[j].m_Bindings.size() == b.m_Ranges[j].m_Bindings.size());
+				for (std::size_t k = 0; k < a.m_Ranges[j].m_Bindings.size(); ++k) {
+					CHECK(a.m_Ranges[j].m_Bindings[k] == order[b.m_Ranges[j].m_Bindings[k]]);
+				}
+			}
+		}
+	}
+}
+
+BENCHMARK(RootSignatureLayout_Build)
+{
+	std::vector<RootBindingDesc> bindings = {
+		CBV(0, 128, VS), CBV(1, 400, VS | PS), CBV(2, 160, PS), CBV(3, 48, PS),
+		SRV(0, PS), SRV(1, PS), SRV(2, PS), SRV(4, PS), SRV(0, VS | PS, 1, 1), SRV(0, PS, UINT_MAX, 2) };
+	RootSignatureLayoutOptions options;
+	options.m_StageMask = VS | PS;
+	Test::Benchmark("BuildRootSignatureLayout (10 bindings)", 1, [&]() {
+		Test::DoNotOptimize(BuildRootSignatureLayout(bindings, options).m_SizeInDWords);
+		});
+}
@@ -0,0 +1,268 @@
+#include "TestFramework.h"
+#include "D3D12Allocatioin.h"
+#include "SlabAllocator.h"
+#include "TexturePlacement.h"
+#include <functional>
+#include <iterator>
+#include <map>
+#include <random>
+#include <vector>
+
+using namespace DSM;
+
+namespace {
+	constexpr std::uint64_t KB = 1024;
+
+	SlabAllocator CreateTextureSlabAllocator()
+	{
+		return SlabAllocator(
+			D3D12TextureAllocator::SlabSize,
+			D3D12_SMALL_RESOURCE_PLACEMENT_ALIGNMENT,
+			D3D12TextureAllocator::MaxSlabTextureSize);
+	}
+
+	D3D12_RESOURCE_DESC GetTexture2DDesc(UINT64 width, UINT height)
+	{
+		D3D12_RESOURCE_DESC desc{};
+		desc.Dimension = D3D12_RESOURCE_DIMENSION_TEXTURE2D;
+		desc.Width = width;
+		desc.Height = height;
+		desc.DepthOrArraySize = 1;
+		desc.MipLevels = 1;
+		desc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+		desc.SampleDesc = { 1, 0 };
+		desc.Layout = D3D12_TEXTURE_LAYOUT_UNKNOWN;
+		desc.Flags = D3D12_RESOURCE_FLAG_NONE;
+		return desc;
+	}
+
+	// 模拟驱动：不超过 64KB 的纹理支持 4KB 对齐，其余请求小对齐时返回 64KB
+	struct FakeAllocationInfoProvider
+	{
+		std::vector<UINT64> m_RequestedAlignments;
+
+		D3D12_RESOURCE_ALLOCATION_INFO operator()(const D3D12_RESOURCE_DESC& desc)
+		{
+			m_RequestedAlignments.push_back(desc.Alignment);
+			UINT64 size = desc.Width * desc.Height * 4;
+			UINT64 alignment = desc.Alignment == D3D12_SMALL_RESOURCE_PLACEMENT_ALIGNMENT && size <= 64 * KB ?
+				D3D12_SMALL_RESOURCE_PLACEMENT_ALIGNMENT : D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT;
+			return { (size + alignment - 1) / alignment * alignment, alignment };
+		}
+	};
+}
+
+TEST_CASE(SlabAllocator_SlotSizesAndAlignment)
+{
+	auto allocator = CreateTextureSlabAllocator();
+	CHECK(!allocator.CanAllocate(0));
+	CHECK(allocator.CanAllocate(64 * KB));
+	CHECK(!allocator.CanAllocate(64 * KB + 1));
+	CHECK(allocator.GetSlotSize(1) == 4 * KB);
+	CHECK(allocator.GetSlotSize(4 * KB) == 4 * KB);
+	CHECK(allocator.GetSlotSize(4 * KB + 1) == 8 * KB);
+	CHECK(allocator.GetSlotSize(40 * KB) == 64 * KB);
+
+	SlabAllocator::Allocation allocation;
+	// 没有 Slab 时失败，调用者需先 AddSlabs
+	CHECK(!allocator.Allocate(4 * KB, allocation));
+	allocator.AddSlabs(2);
+
+	for (auto size : { 1 * KB, 5 * KB, 12 * KB, 20 * KB, 64 * KB }) {
+		CHECK(allocator.Allocate(size, allocation));
+		auto offset = allocator.GetOffset(allocation);
+		CHECK(offset % allocator.GetSlotSize(size) == 0);
+		allocator.Deallocate(allocation);
+	}
+	CHECK(allocator.GetUsedSize() == 0);
+	CHECK(allocator.GetFreeSlabCount() == 2);
+}
+
+TEST_CASE(SlabAllocator_EmptySlabsAreSharedBetweenSizes)
+{
+	auto allocator = CreateTextureSlabAllocator();
+	allocator.AddSlabs(1);
+	const auto slotCount = static_cast<std::uint32_t>(D3D12TextureAllocator::SlabSize / (4 * KB));
+
+	// 唯一的 Slab 被 4KB 的槽占满
+	std::vector<SlabAllocator::Allocation> allocations(slotCount);
+	for (auto& allocation : allocations) {
+		CHECK(allocator.Allocate(4 * KB, allocation));
+	}
+	CHECK(allocator.GetUsedSize() == D3D12TextureAllocator::SlabSize);
+	SlabAllocator::Allocation other;
+	CHECK(!allocator.Allocate(4 * KB, other));
+	CHECK(!allocator.Allocate(64 * KB, other));
+
+	// 留下一个槽时 Slab 仍属于 4KB
+	for (std::uint32_t i = 1; i < slotCount; ++i) {
+		allocator.Deallocate(allocations[i]);
+	}
+	CHECK(!allocator.Allocate(64 * KB, other));
+	CHECK(allocator.Allocate(4 * KB, other));
+	allocator.Deallocate(other);
+
+	// 清空后可被 64KB 的槽复用
+	allocator.Deallocate(allocations[0]);
+	CHECK(allocator.GetFreeSlabCount() == 1);
+	CHECK(allocator.Allocate(64 * KB, other));
+	CHECK(allocator.GetOffset(other) == 0);
+	allocator.Deallocate(other);
+}
+
+TEST_CASE(SlabAllocator_ReleaseAndRestore)
+{
+	auto allocator = CreateTextureSlabAllocator();
+	allocator.AddSlabs(4);
+
+	SlabAllocator::Allocation allocation;
+	CHECK(allocator.Allocate(8 * KB, allocation));
+	CHECK(allocation.m_Slab == 0);
+
+	// 仍有分配的 Slab 不能释放
+	CHECK(!allocator.ReleaseSlabs(0, 2));
+	CHECK(allocator.GetFreeSlabCount() == 3);
+	CHECK(allocator.ReleaseSlabs(2, 2));
+	CHECK(allocator.GetFreeSlabCount() == 1);
+	// 重复释放失败
+	CHECK(!allocator.ReleaseSlabs(2, 1));
+	CHECK(allocator.GetSlabCount() == 4);
+
+	// 被释放的 Slab 不会被分配
+	SlabAllocator::Allocation big;
+	CHECK(allocator.Allocate(64 * KB, big));
+	CHECK(big.m_Slab == 1);
+	SlabAllocator::Allocation other;
+	CHECK(!allocator.Allocate(32 * KB, other));
+
+	allocator.RestoreSlabs(2, 2);
+	CHECK(allocator.Allocate(32 * KB, other));
+	CHECK(other.m_Slab == 2);
+
+	allocator.Deallocate(allocation);
+	allocator.Deallocate(big);
+	allocator.Deallocate(other);
+	CHECK(allocator.GetFreeSlabCount() == 4);
+	CHECK(allocator.GetUsedSize() == 0);
+}
+
+TEST_CASE(SlabAllocator_RandomNeverOverlaps)
+{
+	auto allocator = CreateTextureSlabAllocator();
+	allocator.AddSlabs(8);
+
+	struct LiveSlot
+	{
+		SlabAllocator::Allocation m_Allocation;
+		std::uint64_t m_Size;
+	};
+	std::vector<LiveSlot> live;
+	// 偏移到大小的映射，用于检查相邻的槽是否重叠
+	std::map<std::uint64_t, std::uint64_t> ranges;
+	std::uint64_t usedSize = 0;
+
+	std::mt19937 random(99);
+	for (int step = 0; step < 20000; ++step) {
+		if (live.empty() || random() % 100 < 55) {
+			std::uint64_t size = 1 + random() % (64 * KB);
+			SlabAllocator::Allocation allocation;
+			if (!allocator.Allocate(size, allocation)) {
+				CHECK(allocator.GetFreeSlabCount() == 0);
+				continue;
+			}
+			auto slotSize = allocator.GetSlotSize(size);
+			auto offset = allocator.GetOffset(allocation);
+			CHECK(offset % slotSize == 0);
+			CHECK(offset + slotSize <= allocator.GetSlabCount() * allocator.GetSlabSize());
+
+			auto next = ranges.lower_bound(offset);
+			CHECK(next == ranges.end() || offset + slotSize <= next->first);
+			if (next != ranges.begin()) {
+				auto prev = std::prev(next);
+				CHECK(prev->first + prev->second <= offset);
+			}
+			ranges[offset] = slotSize;
+			live.push_back({ allocation, slotSize });
+			usedSize += slotSize;
+		}
+		else {
+			auto index = random() % live.size();
+			auto slot = live[index];
+			live[index] = live.back();
+			live.pop_back();
+
+			ranges.erase(allocator.GetOffset(slot.m_Allocation));
+			allocator.Deallocate(slot.m_Allocation);
+			usedSize -= slot.m_Size;
+		}
+		CHECK(allocator.GetUsedSize() == usedSize);
+	}
+
+	for (const auto& slot : live) {
+		allocator.Deallocate(slot.m_Allocation);
+	}
+	CHECK(allocator.GetFreeSlabCount() == 8);
+}
+
+TEST_CASE(TexturePlacement_SmallAlignmentAndFallback)
+{
+	// 小纹理使用 4KB 对齐
+	FakeAllocationInfoProvider provider;
+	auto placement = GetTexturePlacementInfo(GetTexture2DDesc(64, 64), std::ref(provider));
+	CHECK(placement.m_Alignment == D3D12_SMALL_RESOURCE_PLACEMENT_ALIGNMENT);
+	CHECK(placement.m_Desc.Alignment == D3D12_SMALL_RESOURCE_PLACEMENT_ALIGNMENT);
+	CHECK(placement.m_SizeInBytes == 16 * KB);
+	CHECK(provider.m_RequestedAlignments.size() == 1);
+
+	// 驱动拒绝小对齐时回退到默认对齐
+	provider.m_RequestedAlignments.clear();
+	placement = GetTexturePlacementInfo(GetTexture2DDesc(256, 256), std::ref(provider));
+	CHECK(placement.m_Alignment == D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT);
+	CHECK(placement.m_Desc.Alignment == 0);
+	CHECK(placement.m_SizeInBytes == 256 * KB);
+	CHECK(provider.m_RequestedAlignments == std::vector<UINT64>({ D3D12_SMALL_RESOURCE_PLACEMENT_ALIGNMENT, 0 }));
+
+	// 渲染目标与多重采样纹理不尝试小对齐
+	provider.m_RequestedAlignments.clear();
+	auto renderTarget = GetTexture2DDesc(16, 16);
+	renderTarget.Flags = D3D12_RESOURCE_FLAG_ALLOW_RENDER_TARGET;
+	placement = GetTexturePlacementInfo(renderTarget, std::ref(provider));
+	CHECK(placement.m_Alignment == D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT);
+	CHECK(provider.m_RequestedAlignments == std::vector<UINT64>({ 0 }));
+
+	provider.m_RequestedAlignments.clear();
+	auto multisample = GetTexture2DDesc(16, 16);
+	multisample.SampleDesc.Count = 4;
+	placement = GetTexturePlacementInfo(multisample, std::ref(provider));
+	CHECK(placement.m_Alignment == D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT);
+	CHECK(provider.m_RequestedAlignments == std::vector<UINT64>({ 0 }));
+}
+
+BENCHMARK(SlabAllocator_SmallTextureChurn)
+{
+	constexpr std::uint32_t OpsPerIteration = 1 << 14;
+	auto allocator = CreateTextureSlabAllocator();
+	allocator.AddSlabs(256);
+
+	std::mt19937 random(5);
+	std::vector<std::uint64_t> sizes(OpsPerIteration);
+	for (auto& size : sizes) {
+		size = 1 + random() % (64 * KB);
+	}
+	std::vector<SlabAllocator::Allocation> allocations(512);
+	for (std::uint32_t i = 0; i < allocations.size(); ++i) {
+		CHECK(allocator.Allocate(sizes[i], allocations[i]));
+	}
+
+	std::uint32_t next = 0;
+	Test::Benchmark("Deallocate + Allocate", OpsPerIteration, [&]() {
+		std::uint64_t sum = 0;
+		for (std::uint32_t i = 0; i < OpsPerIteration; ++i) {
+			auto& allocation = allocations[(next++ * 2654435761u) % allocations.size()];
+			allocator.Deallocate(allocation);
+			CHECK(allocator.Allocate(sizes[i], allocation));
+			sum += allocator.GetOffset(allocation);
+		}
+		Test::DoNotOptimize(sum);
+		});
+}
@@ -0,0 +1,225 @@
+#include "TestFramework.h"
+#include "DefragPlanner.h"
+#include <algorithm>
+#include <bit>
+#include <map>
+#include <random>
+#include <set>
+#include <vector>
+
+using namespace DSM;
+
+namespace {
+	constexpr std::size_t MinBlockSize = 256;
+
+	DefragPlanner::Pool CreatePool(std::uint32_t poolIndex, std::uint32_t maxOrder)
+	{
+		return { poolIndex, BuddyAllocator(MinBlockSize, MinBlockSize << maxOrder), {} };
+	}
+
+	// 在模拟的分配器中分配一个块，movable 为 false 时视为不可移动
+	std::uint32_t AddBlock(DefragPlanner::Pool& pool, std::uint64_t id, std::uint32_t order, bool movable = true)
+	{
+		auto offset = pool.m_Allocator.AllocateBlock(order);
+		if (offset != BuddyAllocator::InvalidOffset && movable) {
+			pool.m_Blocks.push_back({ id, offset, order });
+		}
+		return offset;
+	}
+
+	// 以最小块为单位的占用，用于检查移动的目标是否与已有的块重叠
+	struct PoolOccupancy
+	{
+		std::vector<bool> m_Used;
+
+		bool TryMark(std::uint32_t offset, std::uint32_t order)
+		{
+			auto count = 1u << order;
+			if (offset + count > m_Used.size()) return false;
+			for (auto i = offset; i < offset + count; ++i) {
+				if (m_Used[i]) return false;
+			}
+			for (auto i = offset; i < offset + count; ++i) {
+				m_Used[i] = true;
+			}
+			return true;
+		}
+	};
+}
+
+TEST_CASE(DefragPlanner_NeedsTwoPools)
+{
+	std::vector<DefragPlanner::Pool> pools;
+	pools.push_back(CreatePool(0, 8));
+	AddBlock(pools[0], 1, 0);
+	CHECK(DefragPlanner::Plan(pools).empty());
+}
+
+TEST_CASE(DefragPlanner_EvacuatesTheLightestPool)
+{
+	std::vector<DefragPlanner::Pool> pools;
+	pools.push_back(CreatePool(3, 8));
+	pools.push_back(CreatePool(7, 8));
+	// 池 7 的占用更多，成为目标
+	AddBlock(pools[0], 100, 2);
+	AddBlock(pools[0], 101, 0);
+	AddBlock(pools[1], 200, 5);
+	AddBlock(pools[1], 201, 4);
+
+	auto moves = DefragPlanner::Plan(pools);
+	CHECK(moves.size() == 2);
+	// 大的块先放
+	CHECK(moves[0].m_Id == 100);
+	CHECK(moves[0].m_Order == 2);
+	CHECK(moves[0].m_Size == MinBlockSize * 4);
+	CHECK(moves[1].m_Id == 101);
+	CHECK(moves[1].m_Size == MinBlockSize);
+	for (const auto& move : moves) {
+		CHECK(move.m_SrcPool == 3);
+		CHECK(move.m_DstPool == 7);
+		// 目标位置在原先的池 7 中空闲
+		CHECK(!pools[1].m_Allocator.IsAllocatedBlock(move.m_DstOffset, move.m_Order));
+		CHECK(move.m_DstOffset % (1u << move.m_Order) == 0);
+	}
+}
+
+TEST_CASE(DefragPlanner_SkipsPinnedAndOversizedPools)
+{
+	std::vector<DefragPlanner::Pool> pools;
+	pools.push_back(CreatePool(0, 8));
+	pools.push_back(CreatePool(1, 8));
+	// 池 0 中有一个不可移动的块
+	AddBlock(pools[0], 1, 0);
+	AddBlock(pools[0], 2, 0, false);
+	AddBlock(pools[1], 3, 6);
+	// 池 0 无法清空，改为将池 1 的块移入池 0
+	auto moves = DefragPlanner::Plan(pools);
+	CHECK(moves.size() == 1);
+	CHECK(moves[0].m_Id == 3);
+	CHECK(moves[0].m_SrcPool == 1);
+	CHECK(moves[0].m_DstPool == 0);
+
+	// 目标放不下时不产生任何移动
+	std::vector<DefragPlanner::Pool> full;
+	full.push_back(CreatePool(0, 4));
+	full.push_back(CreatePool(1, 4));
+	AddBlock(full[0], 1, 4);
+	AddBlock(full[1], 2, 3);
+	AddBlock(full[1], 3, 2);
+	CHECK(DefragPlanner::Plan(full).empty());
+}
+
+TEST_CASE(DefragPlanner_RespectsMoveBudget)
+{
+	std::vector<DefragPlanner::Pool> pools;
+	for (std::uint32_t i = 0; i < 4; ++i) {
+		pools.push_back(CreatePool(i, 10));
+	}
+	AddBlock(pools[0], 1, 1);
+	AddBlock(pools[1], 2, 2);
+	AddBlock(pools[2], 3, 3);
+	AddBlock(pools[3], 4, 8);
+
+	// 不限制时清空三个较小的池
+	auto moves = DefragPlanner::Plan(pools);
+	CHECK(moves.size() == 3);
+
+	// 预算只够移动池 0 与池 1
+	moves = DefragPlanner::Plan(pools, MinBlockSize * 6);
+	CHECK(moves.size() == 2);
+	std::uint64_t movedBytes = 0;
+	for (const auto& move : moves) {
+		CHECK(move.m_SrcPool != 2);
+		movedBytes += move.m_Size;
+	}
+	CHECK(movedBytes == MinBlockSize * 6);
+}
+
+TEST_CASE(DefragPlanner_RandomPlansAreConsistent)
+{
+	std::mt19937 random(2024);
+	int plannedRounds = 0;
+	for (int round = 0; round < 200; ++round) {
+		constexpr std::uint32_t MaxOrder = 8;
+		auto poolCount = 2 + random() % 6;
+		std::vector<DefragPlanner::Pool> pools;
+		std::vector<PoolOccupancy> occupancy;
+		std::map<std::uint64_t, std::uint32_t> blockPools;
+		std::uint64_t nextId = 0;
+
+		for (std::uint32_t i = 0; i < poolCount; ++i) {
+			// 池的索引不连续，模拟被回收的空位
+			pools.push_back(CreatePool(i * 2 + 1, MaxOrder));
+			occupancy.push_back({ std::vector<bool>(1u << MaxOrder, false) });
+			auto blockCount = random() % 24;
+			for (std::uint32_t j = 0; j < blockCount; ++j) {
+				auto order = (std::min)(static_cast<std::uint32_t>(std::countr_zero(random() | 0x40u)), 6u);
+				bool movable = random() % 10 != 0;
+				auto id = nextId++;
+				auto offset = AddBlock(pools[i], id, order, movable);
+				if (offset == BuddyAllocator::InvalidOffset) continue;
+				CHECK(occupancy[i].TryMark(offset, order));
+				if (movable) blockPools[id] = i;
+			}
+		}
+
+		std::uint64_t budget = random() % 2 == 0 ? 0 : MinBlockSize * (random() % 128);
+		auto moves = DefragPlanner::Plan(pools, budget);
+
+		auto toLocal = [](std::uint32_t poolIndex) { return (poolIndex - 1) / 2; };
+		std::map<std::uint32_t, std::uint64_t> sourceBytes;
+		std::set<std::uint32_t> destinations;
+		std::set<std::uint64_t> movedIds;
+		std::uint64_t movedBytes = 0;
+		for (const auto& move : moves) {
+			auto src = toLocal(move.m_SrcPool);
+			auto dst = toLocal(move.m_DstPool);
+			CHECK(src < poolCount && dst < poolCount && src != dst);
+			CHECK(blockPools.count(move.m_Id) == 1 && blockPools[move.m_Id] == src);
+			CHECK(movedIds.insert(move.m_Id).second);
+			CHECK(move.m_Size == MinBlockSize << move.m_Order);
+			// 目标与已有的块以及其他移动的目标都不重叠
+			CHECK(occupancy[dst].TryMark(move.m_DstOffset, move.m_Order));
+			sourceBytes[src] += move.m_Size;
+			destinations.insert(dst);
+			movedBytes += move.m_Size;
+		}
+
+		// 被清空的池不会接收块，其中所有的块都被移动且没有不可移动的块
+		for (auto [src, bytes] : sourceBytes) {
+			CHECK(destinations.count(src) == 0);
+			for (const auto& block : pools[src].m_Blocks) {
+				CHECK(movedIds.count(block.m_Id) == 1);
+			}
+			CHECK(bytes == pools[src].m_Allocator.GetAllocatedSize());
+		}
+		CHECK(budget == 0 || movedBytes <= budget);
+		plannedRounds += moves.empty() ? 0 : 1;
+	}
+	// 大部分随机场景都能清空至少一个池
+	CHECK(plannedRounds > 100);
+}
+
+BENCHMARK(DefragPlanner_Plan)
+{
+	// 16 个 64MB 的池，每个池中约 1000 个块
+	constexpr std::uint32_t MaxOrder = 18;
+	std::mt19937 random(3);
+	std::vector<DefragPlanner::Pool> pools;
+	std::uint64_t blockCount = 0;
+	for (std::uint32_t i = 0; i < 16; ++i) {
+		pools.push_back(CreatePool(i, MaxOrder));
+		auto count = 200 + random() % 1600;
+		for (std::uint32_t j = 0; j < count; ++j) {
+			auto order = (std::min)(static_cast<std::uint32_t>(std::countr_zero(random() | 0x400u)), 10u);
+			if (AddBlock(pools[i], blockCount, order) != BuddyAllocator::InvalidOffset) {
+				++blockCount;
+			}
+		}
+	}
+
+	CHECK(!DefragPlanner::Plan(pools).empty());
+	Test::Benchmark("Plan (per block)", blockCount, [&]() {
+		Test::DoNotOptimize(DefragPlanner::Plan(pools).size());
+		});
+}
@@ -0,0 +1,250 @@
+#include "TestFramework.h"
+#include "DescriptorRangeAllocator.h"
+#include <algorithm>
+#include <bit>
+#include <iterator>
+#include <map>
+#include <random>
+#include <vector>
+
+using namespace DSM;
+
+namespace {
+	struct DescriptorRange
+	{
+		std::uint32_t m_Offset;
+		std::uint32_t m_Count;
+	};
+
+	// TLSF 向上取整后的请求大小，不小于该大小的空闲块一定能被找到
+	std::uint64_t GetGuaranteedFitSize(std::uint32_t count)
+	{
+		if (count < 16) return count;
+		auto msb = static_cast<std::uint32_t>(std::bit_width(count)) - 1;
+		return std::uint64_t{ count } + (std::uint64_t{ 1 } << (msb - 4)) - 1;
+	}
+
+	class ReferenceRanges
+	{
+	public:
+		explicit ReferenceRanges(std::uint32_t capacity) :m_Used(capacity, false) {}
+
+		bool IsFree(std::uint32_t offset, std::uint32_t count) const
+		{
+			return std::none_of(m_Used.begin() + offset, m_Used.begin() + offset + count, [](bool used) { return used; });
+		}
+
+		void Mark(std::uint32_t offset, std::uint32_t count, bool used)
+		{
+			std::fill(m_Used.begin() + offset, m_Used.begin() + offset + count, used);
+		}
+
+		std::uint32_t GetLargestFreeRun() const
+		{
+			std::uint32_t largest = 0;
+			std::uint32_t run = 0;
+			for (bool used : m_Used) {
+				run = used ? 0 : run + 1;
+				largest = (std::max)(largest, run);
+			}
+			return largest;
+		}
+
+	private:
+		std::vector<bool> m_Used;
+	};
+
+	// 以 std::map 记录空闲范围的首次适配，作为基准的对照
+	class MapRangeAllocator
+	{
+	public:
+		explicit MapRangeAllocator(std::uint32_t capacity)
+		{
+			m_FreeRanges[0] = capacity;
+		}
+
+		std::uint32_t Allocate(std::uint32_t count)
+		{
+			for (auto it = m_FreeRanges.begin(); it != m_FreeRanges.end(); ++it) {
+				if (it->second < count) continue;
+				auto offset = it->first;
+				auto remain = it->second - count;
+				m_FreeRanges.erase(it);
+				if (remain > 0) m_FreeRanges[offset + count] = remain;
+				m_Sizes[offset] = count;
+				return offset;
+			}
+			return DescriptorRangeAllocator::InvalidOffset;
+		}
+
+		void Free(std::uint32_t offset)
+		{
+			auto size = m_Sizes[offset];
+			auto next = m_FreeRanges.lower_bound(offset);
+			if (next != m_FreeRanges.end() && next->first == offset + size) {
+				size += next->second;
+				next = m_FreeRanges.erase(next);
+			}
+			if (next != m_FreeRanges.begin()) {
+				auto prev = std::prev(next);
+				if (prev->first + prev->second == offset) {
+					prev->second += size;
+					return;
+				}
+			}
+			m_FreeRanges[offset] = size;
+		}
+
+	private:
+		std::map<std::uint32_t, std::uint32_t> m_FreeRanges;
+		std::map<std::uint32_t, std::uint32_t> m_Sizes;
+	};
+
+	template <typename Allocator>
+	void RunChurnBenchmark(const char* name, Allocator& allocator)
+	{
+		constexpr std::uint32_t OpsPerIteration = 1 << 14;
+		std::mt19937 random(11);
+		std::vector<std::uint32_t> counts(OpsPerIteration);
+		for (auto& count : counts) {
+			// 多数为单个描述符，少数为描述符表
+			count = random() % 4 == 0 ? 1 + random() % 32 : 1;
+		}
+		std::vector<std::uint32_t> offsets;
+		for (std::uint32_t i = 0; i < 2048; ++i) {
+			offsets.push_back(allocator.Allocate(counts[i]));
+		}
+
+		std::uint32_t next = 0;
+		Test::Benchmark(name, OpsPerIteration, [&]() {
+			std::uint64_t sum = 0;
+			for (std::uint32_t i = 0; i < OpsPerIteration; ++i) {
+				auto& offset = offsets[(next++ * 2654435761u) % offsets.size()];
+				allocator.Free(offset);
+				offset = allocator.Allocate(counts[i]);
+				sum += offset;
+			}
+			Test::DoNotOptimize(sum);
+			});
+	}
+}
+
+TEST_CASE(DescriptorRangeAllocator_SingleDescriptorCapacity)
+{
+	DescriptorRangeAllocator allocator(1);
+	CHECK(allocator.Allocate(2) == DescriptorRangeAllocator::InvalidOffset);
+	CHECK(allocator.Allocate(1) == 0);
+	CHECK(allocator.GetFreeCount() == 0);
+	CHECK(allocator.Allocate(1) == DescriptorRangeAllocator::InvalidOffset);
+	allocator.Free(0);
+	CHECK(allocator.IsEmpty());
+	CHECK(allocator.Allocate(1) == 0);
+}
+
+TEST_CASE(DescriptorRangeAllocator_SplitAndCoalesce)
+{
+	DescriptorRangeAllocator allocator(100);
+	auto a = allocator.Allocate(10);
+	auto b = allocator.Allocate(20);
+	auto c = allocator.Allocate(30);
+	CHECK(a == 0 && b == 10 && c == 30);
+	CHECK(allocator.GetAllocationSize(b) == 20);
+	CHECK(allocator.GetUsedCount() == 60);
+	CHECK(allocator.Allocate(41) == DescriptorRangeAllocator::InvalidOffset);
+
+	// 与后一个空闲块合并
+	allocator.Free(c);
+	CHECK(allocator.GetFreeCount() == 70);
+	// 与前一个空闲块合并
+	allocator.Free(a);
+	// 同时与前后合并，恢复为一整块
+	allocator.Free(b);
+	CHECK(allocator.IsEmpty());
+	CHECK(allocator.Allocate(100) == 0);
+	allocator.Free(0);
+
+	// 恰好用完的块不留下剩余部分
+	auto whole = allocator.Allocate(60);
+	auto rest = allocator.Allocate(40);
+	CHECK(whole == 0 && rest == 60);
+	CHECK(allocator.GetFreeCount() == 0);
+	allocator.Free(rest);
+	allocator.Free(whole);
+	CHECK(allocator.Allocate(100) == 0);
+}
+
+TEST_CASE(DescriptorRangeAllocator_LargeSizeClasses)
+{
+	// 接近 32 位上限的大小映射到最后一级
+	constexpr std::uint32_t Capacity = 1u << 20;
+	DescriptorRangeAllocator allocator(Capacity);
+	CHECK(allocator.Allocate(Capacity + 1) == DescriptorRangeAllocator::InvalidOffset);
+	CHECK(allocator.Allocate(UINT32_MAX) == DescriptorRangeAllocator::InvalidOffset);
+	auto big = allocator.Allocate(Capacity - 1);
+	CHECK(big == 0);
+	auto last = allocator.Allocate(1);
+	CHECK(last == Capacity - 1);
+	allocator.Free(big);
+	// 空闲块不在向上取整的类别中时，检查请求所在类别的首个块
+	CHECK(allocator.Allocate(Capacity - 1) == 0);
+	allocator.Free(0);
+	allocator.Free(last);
+	CHECK(allocator.Allocate(Capacity) == 0);
+}
+
+TEST_CASE(DescriptorRangeAllocator_RandomAgainstReference)
+{
+	for (std::uint32_t capacity : { 1u, 7u, 16u, 17u, 100u, 1024u, 4099u }) {
+		DescriptorRangeAllocator allocator(capacity);
+		ReferenceRanges reference(capacity);
+		std::vector<DescriptorRange> live;
+		std::uint32_t usedCount = 0;
+
+		std::mt19937 random(capacity);
+		for (int step = 0; step < 5000; ++step) {
+			if (live.empty() || random() % 100 < 55) {
+				auto maxCount = (std::min)(capacity, 80u);
+				auto count = static_cast<std::uint32_t>(1 + random() % maxCount);
+				auto offset = allocator.Allocate(count);
+				if (offset == DescriptorRangeAllocator::InvalidOffset) {
+					// 失败时不存在能保证放下的空闲块
+					CHECK(reference.GetLargestFreeRun() < GetGuaranteedFitSize(count));
+					continue;
+				}
+				CHECK(offset + count <= capacity);
+				CHECK(reference.IsFree(offset, count));
+				CHECK(allocator.GetAllocationSize(offset) == count);
+				reference.Mark(offset, count, true);
+				live.push_back({ offset, count });
+				usedCount += count;
+			}
+			else {
+				auto index = random() % live.size();
+				auto range = live[index];
+				live[index] = live.back();
+				live.pop_back();
+				allocator.Free(range.m_Offset);
+				reference.Mark(range.m_Offset, range.m_Count, false);
+				usedCount -= range.m_Count;
+			}
+			CHECK(allocator.GetUsedCount() == usedCount);
+		}
+
+		// 全部释放后合并为一整块
+		for (const auto& range : live) {
+			allocator.Free(range.m_Offset);
+		}
+		CHECK(allocator.IsEmpty());
+		CHECK(allocator.Allocate(capacity) == 0);
+	}
+}
+
+BENCHMARK(DescriptorRangeAllocator_Churn)
+{
+	constexpr std::uint32_t Capacity = 1 << 16;
+	DescriptorRangeAllocator allocator(Capacity);
+	RunChurnBenchmark("TLSF Free + Allocate", allocator);
+
+	MapRangeAllocator mapAllocator(Capacity);
+	RunChurnBenchmark("std::map first fit Free + Allocate", mapAllocator);
+}
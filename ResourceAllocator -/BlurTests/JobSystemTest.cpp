@@ -0,0 +1,433 @@
+#include "TestFramework.h"
+#include "JobSystem.h"
+#include <barrier>
+#include <climits>
+#include <cmath>
+#include <map>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace DSM;
+
+namespace {
+	// 工作线程数为 1 时调用线程与唯一的工作线程竞争，7 个时线程数多于核心数
+	const std::uint32_t ThreadCounts[] = { 1, 2, 4, 7 };
+
+	// 基准的工作线程数：1, 2, 4 ... 直到硬件线程数
+	std::vector<std::uint32_t> GetBenchmarkThreadCounts()
+	{
+		auto maxThreadCount = (std::max)(std::thread::hardware_concurrency(), 1u);
+		std::vector<std::uint32_t> threadCounts;
+		for (std::uint32_t threadCount = 1; threadCount < maxThreadCount; threadCount *= 2) {
+			threadCounts.push_back(threadCount);
+		}
+		threadCounts.push_back(maxThreadCount);
+		return threadCounts;
+	}
+
+	std::string GetBenchmarkName(const char* name, std::uint32_t threadCount)
+	{
+		return std::string(name) + " [workers: " + std::to_string(threadCount) + "]";
+	}
+
+	// 递归地拆分为两个任务并在任务中等待，返回叶子数量
+	std::uint32_t ForkJoin(JobSystem& jobSystem, std::uint32_t depth)
+	{
+		if (depth == 0) return 1;
+		std::atomic<std::uint32_t> leaves{ 0 };
+		JobCounter counter;
+		for (int i = 0; i < 2; ++i) {
+			jobSystem.Run([&jobSystem, &leaves, depth]() {
+				leaves.fetch_add(ForkJoin(jobSystem, depth - 1), std::memory_order_relaxed);
+				}, counter);
+		}
+		jobSystem.Wait(counter);
+		return leaves.load();
+	}
+}
+
+TEST_CASE(JobSystem_ParallelForCoversRange)
+{
+	// 每个元素恰好执行一次，块不重叠，块数不超过上限
+	const std::pair<std::uint32_t, std::uint32_t> ranges[] = {
+		{ 0, 0 }, { 5, 5 }, { 7, 3 }, { 0, 1 }, { 0, 100 }, { 3, 1003 }, { 0, 100003 },
+		{ UINT_MAX - 5000, UINT_MAX },
+	};
+	for (auto threadCount : ThreadCounts) {
+		JobSystem jobSystem(threadCount);
+		CHECK(jobSystem.GetThreadCount() == threadCount);
+		for (auto [begin, end] : ranges) {
+			for (std::uint32_t grainSize : { 0u, 1u, 7u, 100u, 1000000u }) {
+				auto count = end > begin ? end - begin : 0;
+				std::vector<std::atomic<std::uint32_t>> visits(count);
+				std::atomic<std::uint32_t> chunkCount{ 0 };
+				std::atomic<std::uint32_t> badChunks{ 0 };
+				jobSystem.ParallelFor(begin, end, grainSize, [&](std::uint32_t rangeBegin, std::uint32_t rangeEnd) {
+					if (rangeBegin < begin || rangeEnd > end || rangeBegin >= rangeEnd) {
+						badChunks.fetch_add(1);
+						return;
+					}
+					chunkCount.fetch_add(1);
+					for (auto i = rangeBegin; i < rangeEnd; ++i) {
+						visits[i - begin].fetch_add(1, std::memory_order_relaxed);
+					}
+					});
+				CHECK(badChunks == 0);
+				for (auto& visit : visits) CHECK(visit.load() == 1);
+
+				auto maxChunkCount = (threadCount + 1) * 4;
+				auto grainChunkCount = count == 0 ? 0 : (count - 1) / (std::max)(grainSize, 1u) + 1;
+				CHECK(chunkCount == (std::min)(grainChunkCount, maxChunkCount));
+			}
+		}
+	}
+}
+
+TEST_CASE(JobSystem_ManyJobsAndNestedWaits)
+{
+	for (auto threadCount : ThreadCounts) {
+		JobSystem jobSystem(threadCount);
+
+		// 大量很小的任务，计数器在 Wait 返回后复用
+		JobCounter counter;
+		std::atomic<std::uint32_t> executed{ 0 };
+		for (int round = 0; round < 3; ++round) {
+			for (int i = 0; i < 20000; ++i) {
+				jobSystem.Run([&executed]() { executed.fetch_add(1, std::memory_order_relaxed); }, counter);
+			}
+			jobSystem.Wait(counter);
+			CHECK(counter.IsDone());
+			CHECK(executed == 20000u * (round + 1));
+		}
+
+		// 任务中提交并等待子任务，所有线程都在等待时仍能完成
+		CHECK(ForkJoin(jobSystem, 12) == 4096);
+
+		// 在 ParallelFor 的块中再次 ParallelFor
+		std::atomic<std::uint64_t> sum{ 0 };
+		jobSystem.ParallelFor(0, 64, 1, [&](std::uint32_t begin, std::uint32_t end) {
+			for (auto i = begin; i < end; ++i) {
+				jobSystem.ParallelFor(0, 1000, 16, [&sum, i](std::uint32_t innerBegin, std::uint32_t innerEnd) {
+					std::uint64_t local = 0;
+					for (auto j = innerBegin; j < innerEnd; ++j) local += i * 1000 + j;
+					sum.fetch_add(local, std::memory_order_relaxed);
+					});
+			}
+			});
+		CHECK(sum == 64000ull * 63999 / 2);
+
+		// 多个非工作线程同时提交与等待
+		std::atomic<std::uint32_t> externalExecuted{ 0 };
+		std::vector<std::thread> threads;
+		for (int t = 0; t < 4; ++t) {
+			threads.emplace_back([&jobSystem, &externalExecuted]() {
+				JobCounter threadCounter;
+				for (int i = 0; i < 2000; ++i) {
+					jobSystem.Run([&externalExecuted]() { externalExecuted.fetch_add(1, std::memory_order_relaxed); }, threadCounter);
+				}
+				jobSystem.Wait(threadCounter);
+				});
+		}
+		for (auto& thread : threads) thread.join();
+		CHECK(externalExecuted == 8000);
+	}
+}
+
+TEST_CASE(JobSystem_ThreadIndex)
+{
+	for (auto threadCount : ThreadCounts) {
+		JobSystem jobSystem(threadCount);
+		CHECK(jobSystem.GetCurrentThreadIndex() == 0);
+
+		// 同一线程的序号不变，不同工作线程的序号不同
+		std::mutex mutex;
+		std::map<std::thread::id, std::uint32_t> indices;
+		std::atomic<std::uint32_t> badIndices{ 0 };
+		jobSystem.ParallelFor(0, 4000, 1, [&](std::uint32_t, std::uint32_t) {
+			auto index = jobSystem.GetCurrentThreadIndex();
+			if (index > threadCount) badIndices.fetch_add(1);
+			std::lock_guard<std::mutex> lock(mutex);
+			auto [it, inserted] = indices.try_emplace(std::this_thread::get_id(), index);
+			if (!inserted && it->second != index) badIndices.fetch_add(1);
+			});
+		CHECK(badIndices == 0);
+		std::vector<bool> used(threadCount + 1, false);
+		for (auto [id, index] : indices) {
+			CHECK(index == 0 || !used[index]);
+			used[index] = true;
+		}
+
+		// 其他任务系统的工作线程在这里不是工作线程
+		JobSystem other(1);
+		JobCounter counter;
+		std::atomic<std::uint32_t> otherIndex{ UINT_MAX };
+		other.Run([&]() { otherIndex = jobSystem.GetCurrentThreadIndex(); }, counter);
+		other.Wait(counter);
+		CHECK(otherIndex == 0);
+	}
+}
+
+TEST_CASE(JobSystem_Exceptions)
+{
+	for (auto threadCount : ThreadCounts) {
+		JobSystem jobSystem(threadCount);
+
+		// 多个任务抛出时 Wait 只重新抛出一个，其余任务仍然执行完成
+		JobCounter counter;
+		std::atomic<std::uint32_t> executed{ 0 };
+		for (int i = 0; i < 1000; ++i) {
+			jobSystem.Run([&executed, i]() {
+				executed.fetch_add(1);
+				if (i % 100 == 0) throw std::runtime_error("job failed");
+				}, counter);
+		}
+		CHECK_THROWS(jobSystem.Wait(counter));
+		CHECK(counter.IsDone());
+		CHECK(executed == 1000);
+
+		// 异常在重新抛出后清除，计数器可以继续使用
+		jobSystem.Run([&executed]() { executed.fetch_add(1); }, counter);
+		jobSystem.Wait(counter);
+		CHECK(executed == 1001);
+
+		// ParallelFor 中调用线程的块或其他块抛出时，所有块都完成后才返回
+		// 8 个元素在这些线程数下恰好分为 8 块，每块一个元素
+		for (std::uint32_t throwingChunk : { 0u, 1u, 3u }) {
+			std::atomic<std::uint32_t> finishedChunks{ 0 };
+			bool thrown = false;
+			try {
+				jobSystem.ParallelFor(0, 8, 1, [&](std::uint32_t begin, std::uint32_t) {
+					if (begin == throwingChunk) throw std::runtime_error("chunk failed");
+					std::this_thread::yield();
+					finishedChunks.fetch_add(1);
+					});
+			}
+			catch (const std::runtime_error&) {
+				thrown = true;
+			}
+			CHECK(thrown);
+			CHECK(finishedChunks == 7);
+		}
+	}
+}
+
+TEST_CASE(JobSystem_DestructorDrainsQueue)
+{
+	// 析构时队列中的任务全部执行，反复创建销毁不会死锁
+	for (int round = 0; round < 100; ++round) {
+		JobCounter counter;
+		std::atomic<std::uint32_t> executed{ 0 };
+		{
+			JobSystem jobSystem(1 + round % 4);
+			for (int i = 0; i < 200; ++i) {
+				jobSystem.Run([&executed]() { executed.fetch_add(1, std::memory_order_relaxed); }, counter);
+			}
+		}
+		CHECK(counter.IsDone());
+		CHECK(executed == 200);
+	}
+}
+
+TEST_CASE(JobGraph_RandomDagsRespectDependencies)
+{
+	std::mt19937 random(25);
+	for (auto threadCount : ThreadCounts) {
+		JobSystem jobSystem(threadCount);
+		for (int round = 0; round < 20; ++round) {
+			// 节点只依赖序号更小的节点，保证无环，重复的依赖也要等待
+			auto nodeCount = 1 + random() % 300;
+			std::vector<std::vector<JobGraph::NodeID>> predecessors(nodeCount);
+			auto done = std::make_unique<std::atomic<std::uint32_t>[]>(nodeCount);
+			std::atomic<std::uint32_t> violations{ 0 };
+			std::uint32_t execution = 0;
+
+			JobGraph graph;
+			for (JobGraph::NodeID node = 0; node < nodeCount; ++node) {
+				CHECK(graph.AddNode([&, node]() {
+					for (auto predecessor : predecessors[node]) {
+						if (done[predecessor].load(std::memory_order_acquire) != execution + 1) violations.fetch_add(1);
+					}
+					if (done[node].fetch_add(1, std::memory_order_release) != execution) violations.fetch_add(1);
+					}) == node);
+			}
+			for (JobGraph::NodeID node = 1; node < nodeCount; ++node) {
+				auto dependencyCount = random() % 4;
+				for (std::uint32_t i = 0; i < dependencyCount; ++i) {
+					auto predecessor = static_cast<JobGraph::NodeID>(random() % node);
+					predecessors[node].push_back(predecessor);
+					graph.AddDependency(predecessor, node);
+				}
+			}
+			CHECK(graph.GetNodeCount() == nodeCount);
+
+			// 同一个图执行多次
+			for (execution = 0; execution < 3; ++execution) {
+				graph.Execute(jobSystem);
+				for (std::uint32_t node = 0; node < nodeCount; ++node) CHECK(done[node].load() == execution + 1);
+			}
+			CHECK(violations == 0);
+
+			graph.Clear();
+			CHECK(graph.GetNodeCount() == 0);
+			graph.Execute(jobSystem);
+		}
+	}
+}
+
+TEST_CASE(JobGraph_CyclesThrowBeforeRunning)
+{
+	JobSystem jobSystem(2);
+	std::atomic<std::uint32_t> executed{ 0 };
+	auto job = [&executed]() { executed.fetch_add(1); };
+
+	// 自环、两个节点的环、从根可达的环与不连通的环
+	std::vector<std::vector<std::pair<JobGraph::NodeID, JobGraph::NodeID>>> cases = {
+		{ { 0, 0 } },
+		{ { 0, 1 }, { 1, 0 } },
+		{ { 0, 1 }, { 1, 2 }, { 2, 3 }, { 3, 1 } },
+		{ { 0, 1 }, { 2, 3 }, { 3, 4 }, { 4, 2 } },
+		{ { 0, 1 }, { 0, 2 }, { 1, 3 }, { 2, 3 }, { 3, 4 }, { 4, 5 }, { 5, 3 } },
+	};
+	for (const auto& edges : cases) {
+		JobGraph graph;
+		for (int i = 0; i < 6; ++i) graph.AddNode(job);
+		for (auto [before, after] : edges) graph.AddDependency(before, after);
+		bool thrown = false;
+		try {
+			graph.Execute(jobSystem);
+		}
+		catch (const std::logic_error&) {
+			thrown = true;
+		}
+		CHECK(thrown);
+		CHECK(executed == 0);
+		CHECK_THROWS(graph.Execute(jobSystem));
+
+		// 清空后可以重新构建
+		graph.Clear();
+		graph.AddDependency(graph.AddNode(job), graph.AddNode(job));
+		graph.Execute(jobSystem);
+		CHECK(executed == 2);
+		executed = 0;
+	}
+}
+
+TEST_CASE(JobGraph_ExceptionSkipsSuccessors)
+{
+	for (auto threadCount : ThreadCounts) {
+		JobSystem jobSystem(threadCount);
+		std::vector<std::atomic<std::uint32_t>> executed(6);
+
+		// 0 -> 1 -> 2 中 1 抛出，2 不执行；3 -> 4 与 5 不受影响
+		JobGraph graph;
+		for (JobGraph::NodeID node = 0; node < 6; ++node) {
+			graph.AddNode([&executed, node]() {
+				executed[node].fetch_add(1);
+				if (node == 1) throw std::runtime_error("node failed");
+				});
+		}
+		graph.AddDependency(0, 1);
+		graph.AddDependency(1, 2);
+		graph.AddDependency(3, 4);
+		CHECK_THROWS(graph.Execute(jobSystem));
+		const std::uint32_t expected[] = { 1, 1, 0, 1, 1, 1 };
+		for (int node = 0; node < 6; ++node) CHECK(executed[node] == expected[node]);
+	}
+}
+
+BENCHMARK(JobSystem_ParallelFor)
+{
+	// 每个元素做少量超越函数运算，比较串行循环与不同工作线程数的 ParallelFor
+	std::vector<float> data(1 << 20);
+	for (std::size_t i = 0; i < data.size(); ++i) data[i] = static_cast<float>(i % 1000);
+	auto work = [&data](std::uint32_t begin, std::uint32_t end) {
+		for (auto i = begin; i < end; ++i) {
+			data[i] = std::sqrt(data[i] * data[i] + 1.0f) * 0.5f + std::sin(data[i]);
+		}
+		};
+	auto count = static_cast<std::uint32_t>(data.size());
+
+	Test::Benchmark("serial", count, [&]() {
+		work(0, count);
+		Test::DoNotOptimize(static_cast<std::uint64_t>(data[count / 2]));
+		});
+	for (auto threadCount : GetBenchmarkThreadCounts()) {
+		JobSystem jobSystem(threadCount);
+		auto name = GetBenchmarkName("ParallelFor (grain 4096)", threadCount);
+		Test::Benchmark(name.c_str(), count, [&]() {
+			jobSystem.ParallelFor(0, count, 4096, work);
+			Test::DoNotOptimize(static_cast<std::uint64_t>(data[count / 2]));
+			});
+	}
+}
+
+BENCHMARK(JobSystem_TinyJobs)
+{
+	// 调度开销：空的 ParallelFor 与大量很小的任务
+	for (auto threadCount : GetBenchmarkThreadCounts()) {
+		JobSystem jobSystem(threadCount);
+		auto chunkCount = (jobSystem.GetThreadCount() + 1) * 4;
+		auto name = GetBenchmarkName("empty ParallelFor (fork-join)", threadCount);
+		Test::Benchmark(name.c_str(), 1, [&]() {
+			jobSystem.ParallelFor(0, chunkCount, 1, [](std::uint32_t, std::uint32_t) {});
+			});
+
+		std::atomic<std::uint32_t> executed{ 0 };
+		name = GetBenchmarkName("Run + Wait (1024 tiny jobs)", threadCount);
+		Test::Benchmark(name.c_str(), 1024, [&]() {
+			JobCounter counter;
+			for (int i = 0; i < 1024; ++i) {
+				jobSystem.Run([&executed]() { executed.fetch_add(1, std::memory_order_relaxed); }, counter);
+			}
+			jobSystem.Wait(counter);
+			});
+		Test::DoNotOptimize(executed.load());
+	}
+}
+
+BENCHMARK(JobSystem_ConcurrentSubmit)
+{
+	// 多个非工作线程同时提交并等待各自的任务，竞争共用的队列
+	// 提交线程在基准之外创建，每次迭代由屏障同时开始
+	constexpr std::uint32_t JobsPerIteration = 4096;
+	for (auto threadCount : GetBenchmarkThreadCounts()) {
+		JobSystem jobSystem(threadCount);
+		for (std::uint32_t submitterCount : { 1u, 2u, 4u }) {
+			std::atomic<std::uint32_t> executed{ 0 };
+			std::atomic<bool> stop{ false };
+			std::barrier start(submitterCount + 1);
+			std::barrier finish(submitterCount + 1);
+			std::vector<std::thread> submitters;
+			for (std::uint32_t i = 0; i < submitterCount; ++i) {
+				submitters.emplace_back([&]() {
+					while (true) {
+						start.arrive_and_wait();
+						if (stop.load()) break;
+						JobCounter counter;
+						for (std::uint32_t j = 0; j < JobsPerIteration / submitterCount; ++j) {
+							jobSystem.Run([&executed]() { executed.fetch_add(1, std::memory_order_relaxed); }, counter);
+						}
+						jobSystem.Wait(counter);
+						finish.arrive_and_wait();
+					}
+					});
+			}
+
+			auto name = GetBenchmarkName(
+				("Run + Wait from " + std::to_string(submitterCount) + " submitters").c_str(), threadCount);
+			Test::Benchmark(name.c_str(), JobsPerIteration, [&]() {
+				start.arrive_and_wait();
+				finish.arrive_and_wait();
+				});
+
+			stop.store(true);
+			start.arrive_and_wait();
+			for (auto& submitter : submitters) submitter.join();
+			Test::DoNotOptimize(executed.load());
+		}
+	}
+}
@@ -0,0 +1,223 @@
+#include "TestFramework.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace DSM;
+
+// ObjectStore 依赖 DirectXMath，无法在这里构建，因此以标量运算分别复制旧的与新的存储方式
+// 两种方式每个物体的计算完全相同，只比较内存布局：
+// 旧的 ObjectManager 为 std::map<std::string, std::shared_ptr<Object>>，每个物体单独分配
+// ObjectStore 以稠密数组存放同一属性的数据，逐帧按下标顺序访问
+namespace {
+	struct Float4x4
+	{
+		float m[4][4];
+	};
+
+	struct Bounds
+	{
+		float m_Center[3];
+		float m_Extents[3];
+	};
+
+	struct TransformData
+	{
+		float m_Position[3];
+		float m_Rotation[4];	// 四元数
+		float m_Scale[3];
+	};
+
+	// 行向量约定的缩放、旋转、平移矩阵
+	Float4x4 ComputeLocalToWorld(const TransformData& transform)
+	{
+		const auto [x, y, z, w] = transform.m_Rotation;
+		const auto* s = transform.m_Scale;
+		Float4x4 ret{};
+		ret.m[0][0] = (1 - 2 * (y * y + z * z)) * s[0];
+		ret.m[0][1] = 2 * (x * y + z * w) * s[0];
+		ret.m[0][2] = 2 * (x * z - y * w) * s[0];
+		ret.m[1][0] = 2 * (x * y - z * w) * s[1];
+		ret.m[1][1] = (1 - 2 * (x * x + z * z)) * s[1];
+		ret.m[1][2] = 2 * (y * z + x * w) * s[1];
+		ret.m[2][0] = 2 * (x * z + y * w) * s[2];
+		ret.m[2][1] = 2 * (y * z - x * w) * s[2];
+		ret.m[2][2] = (1 - 2 * (x * x + y * y)) * s[2];
+		ret.m[3][0] = transform.m_Position[0];
+		ret.m[3][1] = transform.m_Position[1];
+		ret.m[3][2] = transform.m_Position[2];
+		ret.m[3][3] = 1;
+		return ret;
+	}
+
+	// 与 ObjectStore 相同，半长为各轴在矩阵绝对值下的投影之和
+	Bounds TransformBounds(const Bounds& local, const Float4x4& world)
+	{
+		Bounds ret{};
+		for (int c = 0; c < 3; ++c) {
+			ret.m_Center[c] = world.m[3][c];
+			ret.m_Extents[c] = 0;
+			for (int r = 0; r < 3; ++r) {
+				ret.m_Center[c] += local.m_Center[r] * world.m[r][c];
+				ret.m_Extents[c] += local.m_Extents[r] * std::abs(world.m[r][c]);
+			}
+		}
+		return ret;
+	}
+
+	TransformData RandomTransform(std::mt19937& random)
+	{
+		std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+		TransformData ret{ { dist(random) * 100, dist(random) * 100, dist(random) * 100 },
+			{ dist(random), dist(random), dist(random), dist(random) },
+			{ 1 + dist(random) * 0.5f, 1 + dist(random) * 0.5f, 1 + dist(random) * 0.5f } };
+		auto length = std::sqrt(ret.m_Rotation[0] * ret.m_Rotation[0] + ret.m_Rotation[1] * ret.m_Rotation[1] +
+			ret.m_Rotation[2] * ret.m_Rotation[2] + ret.m_Rotation[3] * ret.m_Rotation[3]);
+		for (auto& v : ret.m_Rotation) v /= length;
+		return ret;
+	}
+
+	// 旧的 Object，另外缓存世界矩阵与包围盒，使两种方式的计算量相同
+	struct MapObject
+	{
+		std::string m_Name;
+		TransformData m_Transform;
+		const void* m_Model = nullptr;
+		std::map<std::string, std::shared_ptr<MapObject>> m_ChildObject;
+		std::weak_ptr<MapObject> m_Parent;
+		Bounds m_LocalBounds;
+		Float4x4 m_World;
+		Bounds m_WorldBounds;
+		std::uint32_t m_LayerMask = 0;
+	};
+
+	struct MapLayout
+	{
+		std::map<std::string, std::shared_ptr<MapObject>> m_Objects;
+
+		void Update(float offset)
+		{
+			for (auto& [name, object] : m_Objects) {
+				object->m_Transform.m_Position[0] = offset;
+				object->m_World = ComputeLocalToWorld(object->m_Transform);
+				object->m_WorldBounds = TransformBounds(object->m_LocalBounds, object->m_World);
+			}
+		}
+
+		// 剔除后读取可见物体的世界矩阵，模拟写入物体常量
+		float Iterate(std::uint32_t layerMask) const
+		{
+			float sum = 0;
+			for (const auto& [name, object] : m_Objects) {
+				if ((object->m_LayerMask & layerMask) == 0 || object->m_WorldBounds.m_Center[1] < -50.0f) continue;
+				sum += object->m_World.m[3][0] + object->m_World.m[0][0];
+			}
+			return sum;
+		}
+	};
+
+	struct SoALayout
+	{
+		std::vector<std::string> m_Names;
+		std::vector<TransformData> m_Transforms;
+		std::vector<const void*> m_Models;
+		std::vector<Bounds> m_LocalBounds;
+		std::vector<Float4x4> m_WorldMatrices;
+		std::vector<Bounds> m_WorldBounds;
+		std::vector<std::uint32_t> m_LayerMasks;
+
+		void Update(float offset)
+		{
+			for (std::size_t i = 0; i < m_Transforms.size(); ++i) {
+				m_Transforms[i].m_Position[0] = offset;
+				m_WorldMatrices[i] = ComputeLocalToWorld(m_Transforms[i]);
+				m_WorldBounds[i] = TransformBounds(m_LocalBounds[i], m_WorldMatrices[i]);
+			}
+		}
+
+		float Iterate(std::uint32_t layerMask) const
+		{
+			float sum = 0;
+			for (std::size_t i = 0; i < m_LayerMasks.size(); ++i) {
+				if ((m_LayerMasks[i] & layerMask) == 0 || m_WorldBounds[i].m_Center[1] < -50.0f) continue;
+				sum += m_WorldMatrices[i].m[3][0] + m_WorldMatrices[i].m[0][0];
+			}
+			return sum;
+		}
+	};
+
+	// 以相同的随机数据创建两种布局，旧的方式在创建物体的同时分配名称与子物体表，与原来的加载过程一样交错分配
+	void CreateLayouts(std::uint32_t objectCount, MapLayout& mapLayout, SoALayout& soaLayout)
+	{
+		std::mt19937 random(2222);
+		for (std::uint32_t i = 0; i < objectCount; ++i) {
+			auto name = "Object" + std::to_string(i);
+			auto transform = RandomTransform(random);
+			Bounds localBounds{ { 0, 0, 0 }, { 1, 2, 1 } };
+			std::uint32_t layerMask = 1u << (random() % 3);
+
+			auto object = std::make_shared<MapObject>();
+			object->m_Name = name;
+			object->m_Transform = transform;
+			object->m_LocalBounds = localBounds;
+			object->m_LayerMask = layerMask;
+			mapLayout.m_Objects.emplace(name, std::move(object));
+
+			soaLayout.m_Names.push_back(name);
+			soaLayout.m_Transforms.push_back(transform);
+			soaLayout.m_Models.push_back(nullptr);
+			soaLayout.m_LocalBounds.push_back(localBounds);
+			soaLayout.m_WorldMatrices.push_back({});
+			soaLayout.m_WorldBounds.push_back({});
+			soaLayout.m_LayerMasks.push_back(layerMask);
+		}
+	}
+}
+
+TEST_CASE(ObjectStoreLayout_SameResults)
+{
+	MapLayout mapLayout;
+	SoALayout soaLayout;
+	CreateLayouts(1000, mapLayout, soaLayout);
+	mapLayout.Update(3.0f);
+	soaLayout.Update(3.0f);
+
+	// 求和的顺序不同，按物体逐一比较
+	for (std::size_t i = 0; i < soaLayout.m_Names.size(); ++i) {
+		const auto& object = *mapLayout.m_Objects.at(soaLayout.m_Names[i]);
+		CHECK(std::equal(&object.m_World.m[0][0], &object.m_World.m[0][0] + 16, &soaLayout.m_WorldMatrices[i].m[0][0]));
+		CHECK(std::equal(object.m_WorldBounds.m_Extents, object.m_WorldBounds.m_Extents + 3,
+			soaLayout.m_WorldBounds[i].m_Extents));
+	}
+	CHECK(std::abs(mapLayout.Iterate(0b011) - soaLayout.Iterate(0b011)) < 1.0f);
+}
+
+BENCHMARK(ObjectStoreLayout_MapVsSoA)
+{
+	// 每帧更新所有物体的世界矩阵与包围盒，再按渲染层与包围盒遍历
+	for (std::uint32_t objectCount : { 10000u, 25000u, 50000u, 100000u }) {
+		MapLayout mapLayout;
+		SoALayout soaLayout;
+		CreateLayouts(objectCount, mapLayout, soaLayout);
+
+		auto count = std::to_string(objectCount);
+		float offset = 0.0f;
+		Test::Benchmark(("map<string, shared_ptr> update: " + count).c_str(), objectCount, [&]() {
+			mapLayout.Update(offset += 0.01f);
+			});
+		Test::Benchmark(("SoA update: " + count).c_str(), objectCount, [&]() {
+			soaLayout.Update(offset += 0.01f);
+			});
+		Test::Benchmark(("map<string, shared_ptr> iterate: " + count).c_str(), objectCount, [&]() {
+			Test::DoNotOptimize(static_cast<std::uint64_t>(mapLayout.Iterate(0b011)));
+			});
+		Test::Benchmark(("SoA iterate: " + count).c_str(), objectCount, [&]() {
+			Test::DoNotOptimize(static_cast<std::uint64_t>(soaLayout.Iterate(0b011)));
+			});
+	}
+}
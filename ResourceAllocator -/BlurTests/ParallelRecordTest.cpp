@@ -0,0 +1,250 @@
+#include "TestFramework.h"
+#include "ParallelRecord.h"
+#include <algorithm>
+#include <climits>
+#include <random>
+#include <thread>
+#include <vector>
+
+using namespace DSM;
+
+namespace {
+	// 检查计划的不变量：每个通道的任务连续覆盖全部绘制，提交顺序与串行录制一致
+	bool IsValidPlan(const ParallelRecordPlan& plan, const std::vector<std::uint32_t>& drawCounts,
+		std::uint32_t workerCount, std::uint32_t minDrawsPerTask)
+	{
+		minDrawsPerTask = (std::max)(minDrawsPerTask, 1u);
+		auto passCount = static_cast<std::uint32_t>(drawCounts.size());
+		if (plan.GetPassCount() != passCount || plan.GetWorkerCount() != workerCount ||
+			plan.GetMainListCount() != passCount + 1) {
+			return false;
+		}
+
+		auto tasks = plan.GetTasks();
+		std::vector<std::uint32_t> covered(passCount, 0);
+		std::vector<std::vector<std::uint32_t>> passTasks(passCount);
+		for (std::uint32_t i = 0; i < tasks.size(); ++i) {
+			const auto& task = tasks[i];
+			if (task.m_Pass >= passCount || task.m_Worker >= workerCount) return false;
+			// 任务按通道与范围的顺序排列，范围非空且紧接上一个任务
+			if (task.m_Begin != covered[task.m_Pass] || task.m_End <= task.m_Begin) return false;
+			if (i > 0 && tasks[i - 1].m_Pass > task.m_Pass) return false;
+			covered[task.m_Pass] = task.m_End;
+			passTasks[task.m_Pass].push_back(i);
+		}
+
+		for (std::uint32_t pass = 0; pass < passCount; ++pass) {
+			if (covered[pass] != drawCounts[pass]) return false;
+			const auto& indices = passTasks[pass];
+			if (indices.size() > workerCount) return false;
+			// 绘制足够时每个任务至少 minDrawsPerTask 个，同一通道的任务大小最多相差 1
+			if (indices.size() > 1 && drawCounts[pass] / indices.size() < minDrawsPerTask) return false;
+			if (drawCounts[pass] >= 2 * minDrawsPerTask && workerCount > 1 && indices.size() < 2) return false;
+			std::vector<bool> workerUsed(workerCount, false);
+			for (auto i : indices) {
+				auto size = tasks[i].m_End - tasks[i].m_Begin;
+				if (size > drawCounts[pass] / indices.size() + 1) return false;
+				// 同一通道的任务在不同的槽位中并行录制
+				if (workerUsed[tasks[i].m_Worker]) return false;
+				workerUsed[tasks[i].m_Worker] = true;
+			}
+		}
+
+		// 每个槽位的任务按通道顺序排列，所有任务恰好属于一个槽位
+		std::vector<std::uint32_t> taskOwners(tasks.size(), workerCount);
+		for (std::uint32_t worker = 0; worker < workerCount; ++worker) {
+			auto workerTasks = plan.GetWorkerTasks(worker);
+			for (std::size_t j = 0; j < workerTasks.size(); ++j) {
+				auto index = workerTasks[j];
+				if (index >= tasks.size() || tasks[index].m_Worker != worker || taskOwners[index] != workerCount) return false;
+				if (j > 0 && workerTasks[j - 1] >= index) return false;
+				taskOwners[index] = worker;
+			}
+		}
+		if (std::count(taskOwners.begin(), taskOwners.end(), workerCount) != 0) return false;
+
+		// Main 0、通道 0 的任务、Main 1、……、Main passCount
+		std::vector<RecordSubmitEntry> expected;
+		std::uint32_t taskIndex = 0;
+		for (std::uint32_t pass = 0; pass <= passCount; ++pass) {
+			expected.push_back({ RecordSubmitEntry::Type::Main, pass });
+			for (; pass < passCount && taskIndex < tasks.size() && tasks[taskIndex].m_Pass == pass; ++taskIndex) {
+				expected.push_back({ RecordSubmitEntry::Type::Task, taskIndex });
+			}
+		}
+		auto submitOrder = plan.GetSubmitOrder();
+		return std::equal(submitOrder.begin(), submitOrder.end(), expected.begin(), expected.end(),
+			[](const RecordSubmitEntry& a, const RecordSubmitEntry& b) {
+				return a.m_Type == b.m_Type && a.m_Index == b.m_Index;
+			});
+	}
+
+	// 录制的一条命令：Main 列表为 (UINT32_MAX, 序号)，绘制为 (通道, 绘制下标)
+	using Command = std::pair<std::uint32_t, std::uint32_t>;
+
+	// 每个槽位在自己的线程中按顺序录制分配给它的任务，再按提交顺序拼接
+	std::vector<Command> RecordInParallel(const ParallelRecordPlan& plan)
+	{
+		auto tasks = plan.GetTasks();
+		std::vector<std::vector<Command>> taskLists(tasks.size());
+		std::vector<std::thread> threads;
+		for (std::uint32_t worker = 0; worker < plan.GetWorkerCount(); ++worker) {
+			threads.emplace_back([&plan, &taskLists, tasks, worker]() {
+				for (auto index : plan.GetWorkerTasks(worker)) {
+					const auto& task = tasks[index];
+					for (auto draw = task.m_Begin; draw < task.m_End; ++draw) {
+						taskLists[index].emplace_back(task.m_Pass, draw);
+					}
+				}
+				});
+		}
+		for (auto& thread : threads) thread.join();
+
+		std::vector<Command> commands;
+		for (const auto& entry : plan.GetSubmitOrder()) {
+			if (entry.m_Type == RecordSubmitEntry::Type::Main) {
+				commands.emplace_back(UINT32_MAX, entry.m_Index);
+			}
+			else {
+				commands.insert(commands.end(), taskLists[entry.m_Index].begin(), taskLists[entry.m_Index].end());
+			}
+		}
+		return commands;
+	}
+
+	std::vector<Command> RecordSerially(const std::vector<std::uint32_t>& drawCounts)
+	{
+		std::vector<Command> commands;
+		for (std::uint32_t pass = 0; pass < drawCounts.size(); ++pass) {
+			commands.emplace_back(UINT32_MAX, pass);
+			for (std::uint32_t draw = 0; draw < drawCounts[pass]; ++draw) {
+				commands.emplace_back(pass, draw);
+			}
+		}
+		commands.emplace_back(UINT32_MAX, static_cast<std::uint32_t>(drawCounts.size()));
+		return commands;
+	}
+}
+
+TEST_CASE(ParallelRecordPlan_AllSmallPlans)
+{
+	// 所有不超过 3 个通道的绘制数组合，覆盖空通道、少于一个任务与恰好整除的情况
+	const std::uint32_t counts[] = { 0, 1, 2, 3, 15, 16, 17, 31, 32, 33, 64, 100, 1000 };
+	ParallelRecordPlan plan;
+	for (std::uint32_t workerCount = 1; workerCount <= 8; ++workerCount) {
+		for (std::uint32_t minDraws : { 0u, 1u, 16u, 64u }) {
+			std::vector<std::uint32_t> drawCounts;
+			plan.Build(drawCounts, workerCount, minDraws);
+			CHECK(IsValidPlan(plan, drawCounts, workerCount, minDraws));
+			CHECK(plan.GetSubmitOrder().size() == 1);
+			for (auto a : counts) {
+				for (auto b : counts) {
+					for (auto c : { 0u, 17u, 1000u }) {
+						drawCounts = { a, b, c };
+						plan.Build(drawCounts, workerCount, minDraws);
+						CHECK(IsValidPlan(plan, drawCounts, workerCount, minDraws));
+					}
+				}
+			}
+		}
+	}
+}
+
+TEST_CASE(ParallelRecordPlan_RotatesWorkers)
+{
+	// 绘制较少的通道只有一个任务，相邻通道从下一个槽位开始
+	ParallelRecordPlan plan;
+	std::vector<std::uint32_t> drawCounts = { 10, 10, 10, 0, 10 };
+	plan.Build(drawCounts, 4, 64);
+	auto tasks = plan.GetTasks();
+	CHECK(tasks.size() == 4);
+	for (std::uint32_t i = 0; i < tasks.size(); ++i) {
+		CHECK(tasks[i].m_Worker == i);
+	}
+
+	// 阴影与场景通道的绘制数相同时每个槽位各录制两个任务
+	drawCounts = { 4096, 4096 };
+	plan.Build(drawCounts, 4, 64);
+	tasks = plan.GetTasks();
+	for (std::uint32_t worker = 0; worker < 4; ++worker) {
+		auto workerTasks = plan.GetWorkerTasks(worker);
+		CHECK(workerTasks.size() == 2);
+		std::uint32_t load = 0;
+		for (auto index : workerTasks) load += tasks[index].m_End - tasks[index].m_Begin;
+		CHECK(load == 2048);
+	}
+}
+
+TEST_CASE(ParallelRecordPlan_RandomPlansRecordInOrder)
+{
+	std::mt19937 random(24);
+	ParallelRecordPlan plan;
+	for (int round = 0; round < 300; ++round) {
+		std::vector<std::uint32_t> drawCounts(random() % 6);
+		for (auto& count : drawCounts) {
+			count = random() % 4 == 0 ? 0 : random() % 3000;
+		}
+		auto workerCount = 1 + random() % 12;
+		auto minDraws = random() % 200;
+		plan.Build(drawCounts, workerCount, minDraws);
+		CHECK(IsValidPlan(plan, drawCounts, workerCount, minDraws));
+		// 并行录制后按提交顺序执行的命令与串行录制完全相同
+		if (round % 10 == 0) {
+			CHECK(RecordInParallel(plan) == RecordSerially(drawCounts));
+		}
+	}
+}
+
+BENCHMARK(ParallelRecordPlan_Record)
+{
+	// 每个绘制模拟写入 256 字节的常量与描述符，比较串行录制与按计划在 8 个线程中录制
+	// 不同通道的绘制写入不同的常量区域
+	std::vector<std::uint32_t> drawCounts = { 6000, 10000 };
+	std::uint32_t passOffsets[] = { 0, 6000 };
+	std::uint32_t drawCount = 16000;
+	std::vector<std::uint64_t> constants(drawCount * 32);
+	auto recordDraw = [&constants](std::uint32_t pass, std::uint32_t draw) {
+		auto data = constants.data() + std::size_t{ draw } * 32;
+		std::uint64_t hash = 14695981039346656037ull ^ pass;
+		for (int i = 0; i < 32; ++i) {
+			hash = (hash ^ (data[i] + draw)) * 1099511628211ull;
+			data[i] = hash;
+		}
+		return hash;
+	};
+
+	ParallelRecordPlan plan;
+	Test::Benchmark("Build (2 passes, 8 workers)", 1, [&]() {
+		plan.Build(drawCounts, 8, 64);
+		Test::DoNotOptimize(plan.GetTasks().size());
+		});
+
+	Test::Benchmark("serial", drawCount, [&]() {
+		std::uint64_t sum = 0;
+		for (std::uint32_t pass = 0; pass < drawCounts.size(); ++pass) {
+			for (std::uint32_t draw = 0; draw < drawCounts[pass]; ++draw) sum += recordDraw(pass, passOffsets[pass] + draw);
+		}
+		Test::DoNotOptimize(sum);
+		});
+
+	auto workerCount = (std::max)(1u, (std::min)(8u, std::thread::hardware_concurrency()));
+	plan.Build(drawCounts, workerCount, 64);
+	Test::Benchmark("plan + threads", drawCount, [&]() {
+		std::vector<std::uint64_t> sums(plan.GetWorkerCount());
+		std::vector<std::thread> threads;
+		for (std::uint32_t worker = 0; worker < plan.GetWorkerCount(); ++worker) {
+			threads.emplace_back([&, worker]() {
+				std::uint64_t sum = 0;
+				for (auto index : plan.GetWorkerTasks(worker)) {
+					const auto& task = plan.GetTasks()[index];
+					for (auto draw = task.m_Begin; draw < task.m_End; ++draw) sum += recordDraw(task.m_Pass, passOffsets[task.m_Pass] + draw);
+				}
+				sums[worker] = sum;
+				});
+		}
+		for (auto& thread : threads) thread.join();
+		std::uint64_t sum = 0;
+		for (auto value : sums) sum += value;
+		Test::DoNotOptimize(sum);
+		});
+}
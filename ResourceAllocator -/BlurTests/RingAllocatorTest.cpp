@@ -0,0 +1,176 @@
+#include "TestFramework.h"
+#include "RingAllocator.h"
+#include "BuddyAllocator.h"
+#include "DeferredDeletionQueue.h"
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <deque>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace DSM;
+
+namespace {
+	struct RingRange
+	{
+		std::uint64_t m_Offset;
+		std::uint64_t m_Size;
+		std::uint64_t m_FenceValue;
+	};
+
+	bool IsOverlapped(const RingRange& a, const RingRange& b)
+	{
+		return a.m_Offset < b.m_Offset + b.m_Size && b.m_Offset < a.m_Offset + a.m_Size;
+	}
+}
+
+TEST_CASE(RingAllocator_AlignmentAndRejects)
+{
+	RingAllocator allocator(1024);
+	CHECK(allocator.IsEmpty());
+	CHECK(allocator.Allocate(0, 16) == RingAllocator::InvalidOffset);
+	CHECK(allocator.Allocate(1025, 0) == RingAllocator::InvalidOffset);
+
+	CHECK(allocator.Allocate(10, 0) == 0);
+	// 对齐产生的空隙计入占用
+	CHECK(allocator.Allocate(16, 256) == 256);
+	CHECK(allocator.GetUsedSize() == 256 + 16);
+	CHECK(allocator.Allocate(1, 512) == 512);
+	CHECK(allocator.Allocate(511, 0) == 513);
+	CHECK(allocator.IsFull());
+	CHECK(allocator.Allocate(1, 0) == RingAllocator::InvalidOffset);
+}
+
+TEST_CASE(RingAllocator_WrapAndRetireByFence)
+{
+	RingAllocator allocator(1000);
+
+	// 第 1 帧
+	CHECK(allocator.Allocate(600, 0) == 0);
+	allocator.FinishFrame(1);
+	// 第 2 帧的尾部剩余 400，300 放得下，之后的 300 需要回绕但头部仍被第 1 帧占用
+	CHECK(allocator.Allocate(300, 0) == 600);
+	CHECK(allocator.Allocate(300, 0) == RingAllocator::InvalidOffset);
+	allocator.FinishFrame(2);
+	CHECK(allocator.GetFrameCount() == 2);
+
+	// 围栏未完成时不释放
+	allocator.Retire(0);
+	CHECK(allocator.GetUsedSize() == 900);
+
+	// 第 1 帧完成后可以回绕，尾部剩余的 100 计入第 3 帧
+	allocator.Retire(1);
+	CHECK(allocator.GetUsedSize() == 300);
+	CHECK(allocator.Allocate(300, 0) == 0);
+	CHECK(allocator.GetUsedSize() == 300 + 100 + 300);
+	// 头部位于 600，[300, 600) 仍可用
+	CHECK(allocator.Allocate(300, 0) == 300);
+	CHECK(allocator.IsFull());
+	allocator.FinishFrame(3);
+
+	allocator.Retire(2);
+	CHECK(allocator.GetUsedSize() == 700);
+	allocator.Retire(3);
+	CHECK(allocator.IsEmpty());
+	// 全部释放后回到开头
+	CHECK(allocator.Allocate(1000, 0) == 0);
+}
+
+TEST_CASE(RingAllocator_RandomFramesNeverOverlap)
+{
+	constexpr std::uint64_t Capacity = 1 << 16;
+	RingAllocator allocator(Capacity);
+	std::deque<RingRange> live;
+	std::vector<RingRange> currFrame;
+
+	std::mt19937_64 random(7);
+	std::uint64_t fenceValue = 0;
+	std::uint64_t completedFence = 0;
+	for (int frame = 0; frame < 2000; ++frame) {
+		auto drawCount = random() % 64;
+		for (std::uint64_t i = 0; i < drawCount; ++i) {
+			std::uint64_t size = 1 + random() % 2048;
+			std::uint64_t alignment = std::uint64_t{ 1 } << (random() % 9);
+			auto offset = allocator.Allocate(size, alignment);
+			if (offset == RingAllocator::InvalidOffset) continue;
+
+			RingRange range{ offset, size, fenceValue + 1 };
+			CHECK(offset % alignment == 0);
+			CHECK(offset + size <= Capacity);
+			for (const auto& other : live) {
+				CHECK(!IsOverlapped(range, other));
+			}
+			for (const auto& other : currFrame) {
+				CHECK(!IsOverlapped(range, other));
+			}
+			currFrame.push_back(range);
+		}
+		allocator.FinishFrame(++fenceValue);
+		live.insert(live.end(), currFrame.begin(), currFrame.end());
+		currFrame.clear();
+		CHECK(allocator.GetUsedSize() <= Capacity);
+
+		// GPU 随机落后 0 ~ 3 帧
+		completedFence = (std::max)(completedFence, fenceValue - (std::min)(fenceValue, random() % 4));
+		allocator.Retire(completedFence);
+		while (!live.empty() && live.front().m_FenceValue <= completedFence) {
+			live.pop_front();
+		}
+	}
+
+	allocator.Retire(fenceValue);
+	CHECK(allocator.IsEmpty());
+	CHECK(allocator.Allocate(Capacity, 0) == 0);
+}
+
+BENCHMARK(RingAllocator_PerDrawConstants)
+{
+	// 每个物体每帧写入 192 字节的常量，按 256 字节对齐，围栏落后两帧
+	// 基准为环形缓冲区之前的路径：每个物体从 Buddy 分配器分配一个块，释放后按围栏延迟回收
+	constexpr std::uint32_t ConstantSize = 192;
+	constexpr std::uint32_t BlockSize = 256;
+	constexpr std::uint64_t FrameLatency = 2;
+	const std::uint8_t constants[ConstantSize] = {};
+
+	for (std::uint32_t objectCount : { 10000u, 25000u, 50000u, 100000u }) {
+		// 上传堆的映射内存，两条路径都把常量复制到其中
+		// Buddy 分配器的范围需为 2 的幂
+		std::vector<std::uint8_t> mapped(std::bit_ceil(std::size_t(objectCount) * BlockSize * (FrameLatency + 2)));
+		std::uint64_t fenceValue = 0;
+
+		RingAllocator ring(mapped.size());
+		auto name = "ring: " + std::to_string(objectCount) + " objects";
+		Test::Benchmark(name.c_str(), objectCount, [&]() {
+			for (std::uint32_t i = 0; i < objectCount; ++i) {
+				auto offset = ring.Allocate(ConstantSize, BlockSize);
+				std::memcpy(mapped.data() + offset, constants, ConstantSize);
+			}
+			ring.FinishFrame(++fenceValue);
+			ring.Retire(fenceValue - (std::min)(fenceValue, FrameLatency));
+			Test::DoNotOptimize(mapped[0]);
+			});
+
+		BuddyAllocator buddy(BlockSize, mapped.size());
+		DeferredDeletionQueue<std::uint32_t> retired;
+		std::vector<std::uint32_t> blocks(objectCount);
+		fenceValue = 0;
+		name = "buddy per object: " + std::to_string(objectCount) + " objects";
+		Test::Benchmark(name.c_str(), objectCount, [&]() {
+			for (std::uint32_t i = 0; i < objectCount; ++i) {
+				blocks[i] = buddy.AllocateBlock(0);
+				std::memcpy(mapped.data() + std::size_t(blocks[i]) * BlockSize, constants, ConstantSize);
+			}
+			// 帧结束时释放，GPU 完成该帧后才真正回收
+			++fenceValue;
+			for (auto block : blocks) {
+				retired.Push(fenceValue, block);
+			}
+			retired.Retire(fenceValue - (std::min)(fenceValue, FrameLatency), [&buddy](std::uint32_t block) {
+				buddy.DeallocateBlock(block, 0);
+				});
+			Test::DoNotOptimize(mapped[0]);
+			});
+	}
+}
@@ -0,0 +1,161 @@
+#include "TestFramework.h"
+#include "ShaderBindingTable.h"
+#include <algorithm>
+#include <array>
+#include <climits>
+#include <map>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+using namespace DSM;
+
+namespace {
+	struct Binding
+	{
+		int m_Value = 0;
+	};
+
+	using BindingTable = ShaderBindingTable<ShaderParameterKey, Binding>;
+
+	constexpr ShaderParameterKey MakeKey(std::uint32_t space, std::uint32_t bindPoint)
+	{
+		return ShaderParameterIndex::GetKeyByIndex({ bindPoint, space });
+	}
+
+	static_assert(MakeKey(0, UINT_MAX) < MakeKey(1, 0));
+	static_assert(ShaderParameterIndex::GetIndexByKey(MakeKey(UINT_MAX, 7)).m_RegisterSpace == UINT_MAX);
+	static_assert(ShaderParameterIndex::GetIndexByKey(MakeKey(UINT_MAX, 7)).m_BindPoint == 7);
+
+	// 比较表与参照的 std::map，map 中保存插入时返回的地址
+	bool MatchesReference(BindingTable& table, const std::map<ShaderParameterKey, Binding*>& reference,
+		const std::vector<ShaderParameterKey>& allKeys)
+	{
+		if (table.Size() != reference.size() || table.Empty() != reference.empty()) return false;
+		if (!std::equal(table.begin(), table.end(), reference.begin(), reference.end(),
+			[](const auto& entry, const auto& expected) {
+				return entry.first == expected.first && entry.second == expected.second;
+			})) {
+			return false;
+		}
+		const auto& constTable = table;
+		for (auto key : allKeys) {
+			auto it = reference.find(key);
+			auto expected = it == reference.end() ? nullptr : it->second;
+			if (table.Find(key) != expected || constTable.Find(key) != expected) return false;
+			if (table.Contains(key) != (expected != nullptr)) return false;
+			if (expected != nullptr && expected->m_Value != static_cast<int>(key % 1000003)) return false;
+		}
+		return true;
+	}
+}
+
+TEST_CASE(ShaderParameterIndex_KeyRoundTrip)
+{
+	const std::uint32_t values[] = { 0, 1, 2, 15, 16, 0x7fffffff, 0x80000000, UINT_MAX - 1, UINT_MAX };
+	for (auto space : values) {
+		for (auto bindPoint : values) {
+			auto index = ShaderParameterIndex::GetIndexByKey(MakeKey(space, bindPoint));
+			CHECK(index.m_RegisterSpace == space && index.m_BindPoint == bindPoint);
+		}
+	}
+
+	// 键的大小顺序与 (space, bindPoint) 的字典序一致
+	std::mt19937 random(19);
+	for (int i = 0; i < 100000; ++i) {
+		std::pair<std::uint32_t, std::uint32_t> a{ random() % 4, static_cast<std::uint32_t>(random()) };
+		std::pair<std::uint32_t, std::uint32_t> b{ random() % 4, static_cast<std::uint32_t>(random()) };
+		if (i % 2) b.second = a.second;
+		CHECK((MakeKey(a.first, a.second) < MakeKey(b.first, b.second)) == (a < b));
+		CHECK((MakeKey(a.first, a.second) == MakeKey(b.first, b.second)) == (a == b));
+	}
+}
+
+TEST_CASE(ShaderBindingTable_AllInsertOrders)
+{
+	// 所有插入顺序的所有前缀覆盖了每个子集，每次插入后检查全部键
+	std::vector<ShaderParameterKey> keys = {
+		MakeKey(0, 0), MakeKey(0, 1), MakeKey(0, 5), MakeKey(0, UINT_MAX),
+		MakeKey(1, 0), MakeKey(1, 5), MakeKey(UINT_MAX, UINT_MAX),
+	};
+	std::vector<ShaderParameterKey> allKeys = keys;
+	allKeys.insert(allKeys.end(), { MakeKey(0, 2), MakeKey(1, 1), MakeKey(2, 0), MakeKey(UINT_MAX, 0) });
+
+	std::vector<int> order(keys.size());
+	for (int i = 0; i < static_cast<int>(order.size()); ++i) order[i] = i;
+	int permutations = 0;
+	do {
+		BindingTable table;
+		std::map<ShaderParameterKey, Binding*> reference;
+		CHECK(MatchesReference(table, reference, allKeys));
+		for (auto i : order) {
+			auto key = keys[i];
+			auto& binding = table[key];
+			binding.m_Value = static_cast<int>(key % 1000003);
+			reference[key] = &binding;
+			CHECK(MatchesReference(table, reference, allKeys));
+		}
+		// 再次插入返回已有的元素
+		for (auto key : keys) {
+			CHECK(&table[key] == reference[key]);
+		}
+		CHECK(table.Size() == keys.size());
+		table.Clear();
+		reference.clear();
+		CHECK(MatchesReference(table, reference, allKeys));
+		++permutations;
+	} while (std::next_permutation(order.begin(), order.end()));
+	CHECK(permutations == 5040);
+}
+
+TEST_CASE(ShaderBindingTable_RandomAgainstMap)
+{
+	std::mt19937 random(191);
+	BindingTable table;
+	std::map<ShaderParameterKey, Binding*> reference;
+	std::vector<ShaderParameterKey> allKeys;
+	for (int i = 0; i < 20000; ++i) {
+		auto key = MakeKey(random() % 3, random() % 2048);
+		allKeys.push_back(key);
+		auto& binding = table[key];
+		binding.m_Value = static_cast<int>(key % 1000003);
+		auto [it, inserted] = reference.try_emplace(key, &binding);
+		CHECK(it->second == &binding);
+	}
+	CHECK(MatchesReference(table, reference, allKeys));
+}
+
+BENCHMARK(ShaderBindingTable_Find)
+{
+	// 一个着色器通常只有十几个绑定
+	BindingTable table;
+	std::map<ShaderParameterKey, Binding> map;
+	std::unordered_map<ShaderParameterKey, Binding> hashMap;
+	std::vector<ShaderParameterKey> keys;
+	for (std::uint32_t i = 0; i < 16; ++i) {
+		auto key = MakeKey(i % 2, i * 3);
+		keys.push_back(key);
+		table[key].m_Value = static_cast<int>(i);
+		map[key].m_Value = static_cast<int>(i);
+		hashMap[key].m_Value = static_cast<int>(i);
+	}
+	std::mt19937 random(7);
+	std::vector<ShaderParameterKey> lookups(1024);
+	for (auto& key : lookups) key = keys[random() % keys.size()];
+
+	Test::Benchmark("ShaderBindingTable::Find", lookups.size(), [&]() {
+		std::uint64_t sum = 0;
+		for (auto key : lookups) sum += table.Find(key)->m_Value;
+		Test::DoNotOptimize(sum);
+		});
+	Test::Benchmark("std::map::find", lookups.size(), [&]() {
+		std::uint64_t sum = 0;
+		for (auto key : lookups) sum += map.find(key)->second.m_Value;
+		Test::DoNotOptimize(sum);
+		});
+	Test::Benchmark("std::unordered_map::find", lookups.size(), [&]() {
+		std::uint64_t sum = 0;
+		for (auto key : lookups) sum += hashMap.find(key)->second.m_Value;
+		Test::DoNotOptimize(sum);
+		});
+}
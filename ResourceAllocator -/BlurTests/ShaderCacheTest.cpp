@@ -0,0 +1,218 @@
+#include "TestFramework.h"
+#include "ShaderCache.h"
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <string>
+#include <vector>
+
+using namespace DSM;
+
+namespace {
+	constexpr std::uint64_t RecordedKey = 0x0123456789ABCDEFull;
+
+	// 格式版本 1 下 GetRecordedEntry() 的序列化结果
+	// 改变格式时必须增加 ShaderCache::FormatVersion 并重新录制
+	constexpr std::uint8_t RecordedBlob[] = {
+		0x44, 0x4D, 0x53, 0x43, 0x01, 0x00, 0x00, 0x00, 0xEF, 0xCD, 0xAB, 0x89, 0x67, 0x45, 0x23, 0x01,
+		0xD8, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x14, 0x66, 0xFC, 0x16, 0xCB, 0x58, 0x9F, 0x07,
+		0x08, 0x00, 0x00, 0x00, 0x44, 0x58, 0x42, 0x43, 0x01, 0x00, 0xFF, 0x7F, 0x08, 0x00, 0x00, 0x00,
+		0x08, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x0F, 0x00, 0x00, 0x00,
+		0x4F, 0x62, 0x6A, 0x65, 0x63, 0x74, 0x43, 0x6F, 0x6E, 0x73, 0x74, 0x61, 0x6E, 0x74, 0x73, 0x00,
+		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x50, 0x00, 0x00, 0x00, 0x02, 0x00, 0x00, 0x00, 0x06,
+		0x00, 0x00, 0x00, 0x67, 0x57, 0x6F, 0x72, 0x6C, 0x64, 0x00, 0x00, 0x00, 0x00, 0x40, 0x00, 0x00,
+		0x00, 0x00, 0x00, 0x00, 0x00, 0x06, 0x00, 0x00, 0x00, 0x67, 0x43, 0x6F, 0x6C, 0x6F, 0x72, 0x40,
+		0x00, 0x00, 0x00, 0x10, 0x00, 0x00, 0x00, 0x04, 0x00, 0x00, 0x00, 0x00, 0x00, 0x80, 0x3F, 0x03,
+		0x00, 0x00, 0x00, 0x0B, 0x00, 0x00, 0x00, 0x67, 0x44, 0x69, 0x66, 0x66, 0x75, 0x73, 0x65, 0x4D,
+		0x61, 0x70, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x00,
+		0x00, 0x00, 0x04, 0x00, 0x00, 0x00, 0x00, 0x07, 0x00, 0x00, 0x00, 0x67, 0x4F, 0x75, 0x74, 0x70,
+		0x75, 0x74, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x01, 0x00,
+		0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x01, 0x08, 0x00, 0x00, 0x00, 0x67, 0x53, 0x61, 0x6D, 0x70,
+		0x6C, 0x65, 0x72, 0x02, 0x00, 0x00, 0x00, 0x02, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01,
+		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+	};
+
+	ShaderCacheEntry GetRecordedEntry()
+	{
+		ShaderCacheEntry entry;
+		entry.m_ByteCode = { 0x44, 0x58, 0x42, 0x43, 0x01, 0x00, 0xFF, 0x7F };
+		auto& reflection = entry.m_Reflection;
+		reflection.m_ThreadGroupSize = { 8, 8, 1 };
+		ShaderConstantBufferData cb{ "ObjectConstants", 0, 0, 80, {} };
+		cb.m_Variables.push_back({ "gWorld", 0, 64, {} });
+		cb.m_Variables.push_back({ "gColor", 64, 16, { 0x00, 0x00, 0x80, 0x3F } });
+		reflection.m_ConstantBuffers.push_back(cb);
+		reflection.m_Bindings.push_back({ "gDiffuseMap", ShaderBindingType::SHADER_RESOURCE, 0, 0, 1, 4, false });
+		reflection.m_Bindings.push_back({ "gOutput", ShaderBindingType::RW_RESOURCE, 0, 1, 1, 1, true });
+		reflection.m_Bindings.push_back({ "gSampler", ShaderBindingType::SAMPLER, 2, 0, 1, 0, false });
+		return entry;
+	}
+
+	bool IsSameEntry(const ShaderCacheEntry& a, const ShaderCacheEntry& b)
+	{
+		const auto& ra = a.m_Reflection;
+		const auto& rb = b.m_Reflection;
+		if (a.m_ByteCode != b.m_ByteCode ||
+			ra.m_ThreadGroupSize != rb.m_ThreadGroupSize ||
+			ra.m_ConstantBuffers.size() != rb.m_ConstantBuffers.size() ||
+			ra.m_Bindings.size() != rb.m_Bindings.size()) {
+			return false;
+		}
+		for (std::size_t i = 0; i < ra.m_ConstantBuffers.size(); ++i) {
+			const auto& ca = ra.m_ConstantBuffers[i];
+			const auto& cb = rb.m_ConstantBuffers[i];
+			if (ca.m_Name != cb.m_Name || ca.m_BindPoint != cb.m_BindPoint || ca.m_RegisterSpace != cb.m_RegisterSpace ||
+				ca.m_Size != cb.m_Size || ca.m_Variables.size() != cb.m_Variables.size()) {
+				return false;
+			}
+			for (std::size_t j = 0; j < ca.m_Variables.size(); ++j) {
+				const auto& va = ca.m_Variables[j];
+				const auto& vb = cb.m_Variables[j];
+				if (va.m_Name != vb.m_Name || va.m_StartOffset != vb.m_StartOffset ||
+					va.m_Size != vb.m_Size || va.m_DefaultValue != vb.m_DefaultValue) {
+					return false;
+				}
+			}
+		}
+		for (std::size_t i = 0; i < ra.m_Bindings.size(); ++i) {
+			const auto& ba = ra.m_Bindings[i];
+			const auto& bb = rb.m_Bindings[i];
+			if (ba.m_Name != bb.m_Name || ba.m_Type != bb.m_Type || ba.m_BindPoint != bb.m_BindPoint ||
+				ba.m_RegisterSpace != bb.m_RegisterSpace || ba.m_BindCount != bb.m_BindCount ||
+				ba.m_Dimension != bb.m_Dimension || ba.m_EnableCounter != bb.m_EnableCounter) {
+				return false;
+			}
+		}
+		return true;
+	}
+}
+
+TEST_CASE(ShaderCache_RecordedBlobRoundTrip)
+{
+	ShaderCacheEntry entry;
+	CHECK(ShaderCache::Deserialize(RecordedBlob, sizeof(RecordedBlob), RecordedKey, entry));
+	CHECK(IsSameEntry(entry, GetRecordedEntry()));
+
+	// 格式未改变时序列化结果与录制的完全相同
+	auto data = ShaderCache::Serialize(RecordedKey, GetRecordedEntry());
+	CHECK(data.size() == sizeof(RecordedBlob));
+	CHECK(std::memcmp(data.data(), RecordedBlob, sizeof(RecordedBlob)) == 0);
+
+	// 空的条目同样可以往返
+	ShaderCacheEntry empty;
+	data = ShaderCache::Serialize(1, ShaderCacheEntry{});
+	CHECK(ShaderCache::Deserialize(data.data(), data.size(), 1, empty));
+	CHECK(IsSameEntry(empty, ShaderCacheEntry{}));
+}
+
+TEST_CASE(ShaderCache_RejectsCorruptBlobs)
+{
+	ShaderCacheEntry entry = GetRecordedEntry();
+	entry.m_ByteCode.clear();
+	const auto unchanged = entry;
+
+	CHECK(!ShaderCache::Deserialize(nullptr, 0, RecordedKey, entry));
+	CHECK(!ShaderCache::Deserialize(RecordedBlob, sizeof(RecordedBlob), RecordedKey + 1, entry));
+
+	// 任意位置截断都失败
+	for (std::size_t size = 0; size < sizeof(RecordedBlob); ++size) {
+		CHECK(!ShaderCache::Deserialize(RecordedBlob, size, RecordedKey, entry));
+	}
+	// 修改任意一个字节都会被文件头或内容哈希检查出来
+	std::vector<std::uint8_t> data(std::begin(RecordedBlob), std::end(RecordedBlob));
+	for (std::size_t i = 0; i < data.size(); ++i) {
+		for (std::uint8_t bit = 1; bit != 0; bit <<= 1) {
+			data[i] ^= bit;
+			CHECK(!ShaderCache::Deserialize(data.data(), data.size(), RecordedKey, entry));
+			data[i] ^= bit;
+		}
+	}
+	// 多余的数据同样失败
+	data.push_back(0);
+	CHECK(!ShaderCache::Deserialize(data.data(), data.size(), RecordedKey, entry));
+	// 失败时不修改输出
+	CHECK(IsSameEntry(entry, unchanged));
+}
+
+TEST_CASE(ShaderCache_StoreAndLoad)
+{
+	Test::TempDirectory directory("ShaderCache");
+	ShaderCache cache(directory.GetPath() / "Cache");
+	ShaderCacheEntry entry;
+	CHECK(!cache.Load(RecordedKey, entry));
+
+	CHECK(cache.Store(RecordedKey, GetRecordedEntry()));
+	CHECK(cache.Load(RecordedKey, entry));
+	CHECK(IsSameEntry(entry, GetRecordedEntry()));
+	CHECK(!cache.Load(RecordedKey + 1, entry));
+
+	// 磁盘上的文件与录制的数据相同
+	auto path = cache.GetEntryPath(RecordedKey);
+	std::ifstream file(path, std::ios::binary);
+	std::vector<char> stored{ std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>() };
+	file.close();
+	CHECK(stored.size() == sizeof(RecordedBlob));
+	CHECK(std::memcmp(stored.data(), RecordedBlob, sizeof(RecordedBlob)) == 0);
+
+	// 写了一半的文件被视为未命中
+	directory.WriteFile(std::filesystem::relative(path, directory.GetPath()), std::string(stored.data(), 40));
+	CHECK(!cache.Load(RecordedKey, entry));
+}
+
+TEST_CASE(ShaderCache_KeyTracksSourcesAndOptions)
+{
+	Test::TempDirectory directory("ShaderKey");
+	auto common = directory.WriteFile("Include/Common.hlsli", "float4 gColor;\n");
+	auto shader = directory.WriteFile("Shader.hlsl", "  #  include \"Include/Common.hlsli\"\nfloat4 PS() : SV_Target { return gColor; }\n");
+	auto file = shader.string();
+
+	ShaderCache cache(directory.GetPath(), "Debug");
+	std::map<std::string, std::string> defines{ { "BINDLESS", "1" }, { "SHADOW", "" } };
+	auto key = cache.ComputeKey(file, "PS", "ps_5_1", defines);
+	CHECK(key == cache.ComputeKey(file, "PS", "ps_5_1", defines));
+
+	auto dependencies = ShaderCache::GetSourceDependencies(shader);
+	CHECK(dependencies.size() == 2);
+
+	CHECK(key != ShaderCache(directory.GetPath(), "Release").ComputeKey(file, "PS", "ps_5_1", defines));
+	CHECK(key != cache.ComputeKey(file, "VS", "ps_5_1", defines));
+	CHECK(key != cache.ComputeKey(file, "PS", "ps_5_0", defines));
+	CHECK(key != cache.ComputeKey(file, "PS", "ps_5_1", {}));
+	auto changed = defines;
+	changed["BINDLESS"] = "0";
+	CHECK(key != cache.ComputeKey(file, "PS", "ps_5_1", changed));
+	// 宏的名字与值的边界不同
+	CHECK(cache.ComputeKey(file, "PS", "ps_5_1", { { "AB", "" } }) != cache.ComputeKey(file, "PS", "ps_5_1", { { "A", "B" } }));
+
+	// 被包含的文件改变时键随之改变，恢复后键也恢复
+	directory.WriteFile("Include/Common.hlsli", "float4 gColor2;\n");
+	CHECK(key != cache.ComputeKey(file, "PS", "ps_5_1", defines));
+	directory.WriteFile("Include/Common.hlsli", "float4 gColor;\n");
+	CHECK(key == cache.ComputeKey(file, "PS", "ps_5_1", defines));
+
+	// 循环包含不会导致死循环
+	directory.WriteFile("Include/Common.hlsli", "#include \"../Shader.hlsl\"\n");
+	CHECK(ShaderCache::GetSourceDependencies(common).size() == 2);
+}
+
+BENCHMARK(ShaderCache_Deserialize)
+{
+	// 约 32KB 的字节码与典型大小的反射数据
+	auto entry = GetRecordedEntry();
+	entry.m_ByteCode.resize(32 * 1024);
+	for (std::size_t i = 0; i < entry.m_ByteCode.size(); ++i) {
+		entry.m_ByteCode[i] = static_cast<std::uint8_t>(i * 31);
+	}
+	for (int i = 0; i < 16; ++i) {
+		entry.m_Reflection.m_Bindings.push_back({ "gTexture" + std::to_string(i), ShaderBindingType::SHADER_RESOURCE,
+			static_cast<std::uint32_t>(i), 0, 1, 4, false });
+	}
+	auto data = ShaderCache::Serialize(RecordedKey, entry);
+
+	Test::Benchmark("Deserialize (per byte)", data.size(), [&]() {
+		ShaderCacheEntry loaded;
+		CHECK(ShaderCache::Deserialize(data.data(), data.size(), RecordedKey, loaded));
+		Test::DoNotOptimize(loaded.m_ByteCode.size());
+		});
+}
@@ -0,0 +1,218 @@
+#include "TestFramework.h"
+#include "ShaderCompiler.h"
+#include <atomic>
+#include <chrono>
+#include <random>
+#include <stdexcept>
+
+using namespace DSM;
+
+namespace {
+	// 不调用 DXC 的编译器，字节码由入口点与宏定义拼接而成
+	// 名为 "Broken" 的入口点编译失败，delayMicroseconds 用于打乱完成的顺序
+	class StubShaderCompiler : public IShaderCompiler
+	{
+	public:
+		explicit StubShaderCompiler(std::uint32_t maxDelayMicroseconds = 0) :m_MaxDelay(maxDelayMicroseconds) {}
+
+		virtual ShaderCacheEntry Compile(const ShaderCompileDesc& compileDesc) override
+		{
+			++m_CompileCount;
+			if (m_MaxDelay > 0) {
+				auto delay = std::hash<std::string>{}(compileDesc.m_EntryPoint) % m_MaxDelay;
+				std::this_thread::sleep_for(std::chrono::microseconds(delay));
+			}
+			if (compileDesc.m_EntryPoint == "Broken") {
+				throw std::runtime_error(compileDesc.m_FileName + ": error X3000: syntax error");
+			}
+			return GetExpectedEntry(compileDesc);
+		}
+
+		static ShaderCacheEntry GetExpectedEntry(const ShaderCompileDesc& compileDesc)
+		{
+			std::string code = compileDesc.m_EntryPoint + "|" + compileDesc.m_Target;
+			for (const auto& [name, value] : compileDesc.m_Defines) {
+				code += "|" + name + "=" + value;
+			}
+			ShaderCacheEntry entry;
+			entry.m_ByteCode.assign(code.begin(), code.end());
+			entry.m_Reflection.m_ThreadGroupSize = { 1, 2, 3 };
+			return entry;
+		}
+
+		std::uint32_t GetCompileCount() const noexcept { return m_CompileCount; }
+
+	private:
+		std::uint32_t m_MaxDelay;
+		std::atomic<std::uint32_t> m_CompileCount = 0;
+	};
+
+	ShaderCompileDesc GetCompileDesc(const std::string& fileName, const std::string& entryPoint)
+	{
+		return { fileName, entryPoint, "ps_5_1", ShaderType::PIXEL_SHADER, {} };
+	}
+}
+
+TEST_CASE(ShaderCompileQueue_ResultsKeepSubmitOrder)
+{
+	StubShaderCompiler compiler(500);
+	JobSystem jobSystem(4);
+	ShaderCompileQueue queue(&compiler, jobSystem);
+	CHECK(queue.GetThreadCount() == 4);
+
+	std::vector<ShaderCompileDesc> descs;
+	for (int i = 0; i < 64; ++i) {
+		auto desc = GetCompileDesc("Shader.hlsl", "Main" + std::to_string(i));
+		desc.m_Defines["INDEX"] = std::to_string(i);
+		descs.push_back(desc);
+	}
+	// 完成顺序被随机延迟打乱，结果仍与提交顺序一致
+	auto results = queue.CompileAll(descs);
+	CHECK(results.size() == descs.size());
+	for (std::size_t i = 0; i < descs.size(); ++i) {
+		CHECK(results[i].m_ByteCode == StubShaderCompiler::GetExpectedEntry(descs[i]).m_ByteCode);
+	}
+	CHECK(compiler.GetCompileCount() == descs.size());
+}
+
+TEST_CASE(ShaderCompileQueue_ExceptionsReachTheCaller)
+{
+	StubShaderCompiler compiler;
+	JobSystem jobSystem(2);
+	ShaderCompileQueue queue(&compiler, jobSystem);
+
+	auto good = queue.Submit(GetCompileDesc("Good.hlsl", "PS"));
+	auto broken = queue.Submit(GetCompileDesc("Broken.hlsl", "Broken"));
+	CHECK(!good.get().m_ByteCode.empty());
+	CHECK_THROWS(broken.get());
+
+	// 一个着色器失败后队列仍可继续使用
+	CHECK_THROWS(queue.CompileAll({ GetCompileDesc("A.hlsl", "PS"), GetCompileDesc("B.hlsl", "Broken") }));
+	CHECK(queue.CompileAll({ GetCompileDesc("C.hlsl", "PS") }).size() == 1);
+}
+
+TEST_CASE(ShaderCompileQueue_DestructorFinishesPendingTasks)
+{
+	StubShaderCompiler compiler(200);
+	std::vector<std::future<ShaderCacheEntry>> futures;
+	JobSystem jobSystem(3);
+	{
+		ShaderCompileQueue queue(&compiler, jobSystem);
+		for (int i = 0; i < 32; ++i) {
+			futures.push_back(queue.Submit(GetCompileDesc("Shader.hlsl", "Main" + std::to_string(i))));
+		}
+	}
+	for (auto& future : futures) {
+		CHECK(future.wait_for(std::chrono::seconds(0)) == std::future_status::ready);
+		CHECK(!future.get().m_ByteCode.empty());
+	}
+	CHECK(compiler.GetCompileCount() == 32);
+}
+
+TEST_CASE(ShaderCompileQueue_CompileAllInsideJob)
+{
+	// 只有一个工作线程时在任务中等待编译，等待的线程自己执行编译任务而不会死锁
+	StubShaderCompiler compiler(100);
+	JobSystem jobSystem(1);
+	ShaderCompileQueue queue(&compiler, jobSystem);
+
+	std::vector<ShaderCompileDesc> descs;
+	for (int i = 0; i < 16; ++i) {
+		descs.push_back(GetCompileDesc("Shader.hlsl", "Main" + std::to_string(i)));
+	}
+	std::vector<ShaderCacheEntry> results;
+	JobCounter counter;
+	jobSystem.Run([&]() { results = queue.CompileAll(descs); }, counter);
+	jobSystem.Wait(counter);
+	CHECK(results.size() == descs.size());
+	CHECK(compiler.GetCompileCount() == descs.size());
+}
+
+TEST_CASE(CachedShaderCompiler_HitsSkipTheBackend)
+{
+	Test::TempDirectory directory("ShaderCompiler");
+	auto fileName = directory.WriteFile("Shader.hlsl", "float4 PS() : SV_Target { return 1; }\n").string();
+	ShaderCache cache(directory.GetPath() / "Cache");
+	StubShaderCompiler backend;
+	CachedShaderCompiler compiler(cache, backend);
+
+	auto desc = GetCompileDesc(fileName, "PS");
+	auto first = compiler.Compile(desc);
+	CHECK(backend.GetCompileCount() == 1);
+	auto second = compiler.Compile(desc);
+	CHECK(backend.GetCompileCount() == 1);
+	CHECK(first.m_ByteCode == second.m_ByteCode);
+	CHECK(second.m_Reflection.m_ThreadGroupSize == first.m_Reflection.m_ThreadGroupSize);
+
+	// 宏或源文件改变时重新编译
+	desc.m_Defines["BINDLESS"] = "1";
+	compiler.Compile(desc);
+	CHECK(backend.GetCompileCount() == 2);
+	directory.WriteFile("Shader.hlsl", "float4 PS() : SV_Target { return 0; }\n");
+	compiler.Compile(desc);
+	CHECK(backend.GetCompileCount() == 3);
+
+	// 失败的编译不写入缓存
+	auto broken = GetCompileDesc(fileName, "Broken");
+	CHECK_THROWS(compiler.Compile(broken));
+	CHECK_THROWS(compiler.Compile(broken));
+	CHECK(backend.GetCompileCount() == 5);
+
+	// 多个线程同时通过缓存编译，第二轮全部命中
+	std::vector<ShaderCompileDesc> descs;
+	for (int i = 0; i < 24; ++i) {
+		descs.push_back(GetCompileDesc(fileName, "Main" + std::to_string(i)));
+	}
+	JobSystem jobSystem(4);
+	ShaderCompileQueue queue(&compiler, jobSystem);
+	auto results = queue.CompileAll(descs);
+	CHECK(backend.GetCompileCount() == 5 + 24);
+	auto cached = queue.CompileAll(descs);
+	CHECK(backend.GetCompileCount() == 5 + 24);
+	for (std::size_t i = 0; i < descs.size(); ++i) {
+		CHECK(cached[i].m_ByteCode == results[i].m_ByteCode);
+	}
+}
+
+BENCHMARK(ShaderCompileQueue_Overhead)
+{
+	// 编译器本身几乎没有开销，测得的是排队、唤醒与 future 的开销
+	constexpr std::uint32_t TaskCount = 256;
+	StubShaderCompiler compiler;
+	JobSystem jobSystem(4);
+	ShaderCompileQueue queue(&compiler, jobSystem);
+	std::vector<ShaderCompileDesc> descs;
+	for (std::uint32_t i = 0; i < TaskCount; ++i) {
+		descs.push_back(GetCompileDesc("Shader.hlsl", "Main" + std::to_string(i)));
+	}
+
+	Test::Benchmark("CompileAll (per shader)", TaskCount, [&]() {
+		Test::DoNotOptimize(queue.CompileAll(descs).size());
+		});
+	Test::Benchmark("Serial Compile (per shader)", TaskCount, [&]() {
+		std::uint64_t sum = 0;
+		for (const auto& desc : descs) {
+			sum += compiler.Compile(desc).m_ByteCode.size();
+		}
+		Test::DoNotOptimize(sum);
+		});
+}
+
+BENCHMARK(CachedShaderCompiler_Hit)
+{
+	// 命中时的开销：读取源文件计算键并读取缓存文件
+	Test::TempDirectory directory("ShaderCompilerBench");
+	std::string source(16 * 1024, ' ');
+	source += "\nfloat4 PS() : SV_Target { return 1; }\n";
+	auto fileName = directory.WriteFile("Shader.hlsl", source).string();
+	ShaderCache cache(directory.GetPath() / "Cache");
+	StubShaderCompiler backend;
+	CachedShaderCompiler compiler(cache, backend);
+	auto desc = GetCompileDesc(fileName, "PS");
+	compiler.Compile(desc);
+
+	Test::Benchmark("Compile (cache hit)", 1, [&]() {
+		Test::DoNotOptimize(compiler.Compile(desc).m_ByteCode.size());
+		});
+	CHECK(backend.GetCompileCount() == 1);
+}
@@ -0,0 +1,328 @@
+#include "TestFramework.h"
+#include "ShaderHotReload.h"
+#include <atomic>
+#include <condition_variable>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+
+using namespace DSM;
+
+namespace {
+	// 不调用 DXC 的编译器，直接读取源文件：字节码为文件内容，"cb <size>" 声明常量缓冲区的大小，
+	// 含有 "broken" 时编译失败。阻塞时编译在开始后等待，用于在编译期间修改文件
+	class FileShaderCompiler : public IShaderCompiler
+	{
+	public:
+		virtual ShaderCacheEntry Compile(const ShaderCompileDesc& compileDesc) override
+		{
+			++m_StartCount;
+			{
+				std::unique_lock lock(m_Mutex);
+				m_Condition.wait(lock, [this]() { return !m_Blocked; });
+			}
+
+			std::ifstream file(compileDesc.m_FileName, std::ios::binary);
+			if (!file) {
+				throw std::runtime_error("cannot open " + compileDesc.m_FileName);
+			}
+			std::string source{ std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>() };
+			if (source.find("broken") != std::string::npos) {
+				throw std::runtime_error("error X3000: syntax error");
+			}
+
+			ShaderCacheEntry entry;
+			entry.m_ByteCode.assign(source.begin(), source.end());
+			if (auto pos = source.find("cb "); pos != std::string::npos) {
+				ShaderConstantBufferData cb;
+				cb.m_Name = "ObjectConstants";
+				cb.m_Size = static_cast<std::uint32_t>(std::stoul(source.substr(pos + 3)));
+				entry.m_Reflection.m_ConstantBuffers.push_back(cb);
+			}
+			return entry;
+		}
+
+		void SetBlocked(bool blocked)
+		{
+			{
+				std::lock_guard lock(m_Mutex);
+				m_Blocked = blocked;
+			}
+			m_Condition.notify_all();
+		}
+
+		std::uint32_t GetStartCount() const noexcept { return m_StartCount; }
+
+	private:
+		std::atomic<std::uint32_t> m_StartCount = 0;
+		std::mutex m_Mutex;
+		std::condition_variable m_Condition;
+		bool m_Blocked = false;
+	};
+
+	// 写入文件并将修改时间推后一秒，不依赖文件系统时间戳的精度
+	void EditFile(const Test::TempDirectory& directory, const std::string& name, const std::string& content)
+	{
+		static auto writeTime = std::filesystem::file_time_type::clock::now();
+		writeTime += std::chrono::seconds(1);
+		auto path = directory.WriteFile(name, content);
+		std::filesystem::last_write_time(path, writeTime);
+	}
+
+	// 模拟每帧的检查与 Update，直到 done 返回 true 或超时
+	template <typename Predicate>
+	bool UpdateUntil(ShaderHotReload& hotReload, Predicate done)
+	{
+		for (int frame = 0; frame < 5000; ++frame) {
+			hotReload.GetWatcher().Poll();
+			hotReload.Update();
+			if (done()) return true;
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+		return false;
+	}
+
+	ShaderReflectionData GetReflection(std::uint32_t cbSize)
+	{
+		ShaderReflectionData reflection;
+		ShaderConstantBufferData cb;
+		cb.m_Name = "ObjectConstants";
+		cb.m_Size = cbSize;
+		reflection.m_ConstantBuffers.push_back(cb);
+		return reflection;
+	}
+
+	ShaderCompileDesc GetCompileDesc(const std::string& fileName)
+	{
+		return { fileName, "PS", "ps_5_1", ShaderType::PIXEL_SHADER, {} };
+	}
+}
+
+TEST_CASE(ShaderFileWatcher_ReportsStableChanges)
+{
+	Test::TempDirectory directory("FileWatcher");
+	EditFile(directory, "Lit.hlsl", "v1");
+	ShaderFileWatcher watcher;
+	watcher.Watch(directory.GetPath() / "Lit.hlsl");
+	watcher.Watch(directory.GetPath() / "." / "Lit.hlsl");
+	watcher.Watch(directory.GetPath() / "Missing.hlsl");
+	CHECK(watcher.GetWatchCount() == 2);
+	CHECK(watcher.IsWatching(directory.GetPath() / "sub" / ".." / "Lit.hlsl"));
+	CHECK(watcher.Poll() == 0);
+
+	// 第一次发现变化时不报告，状态保持一次检查后才报告
+	EditFile(directory, "Lit.hlsl", "v2");
+	CHECK(watcher.Poll() == 0);
+	EditFile(directory, "Lit.hlsl", "v3 longer");
+	CHECK(watcher.Poll() == 0);
+	CHECK(watcher.Poll() == 1);
+	auto changes = watcher.TakeChanges();
+	CHECK(changes.size() == 1 && changes[0] == ShaderFileWatcher::Normalize(directory.GetPath() / "Lit.hlsl"));
+	CHECK(watcher.TakeChanges().empty());
+	CHECK(watcher.Poll() == 0);
+
+	// 新建与删除的文件同样被报告，未取出的修改只记录一次
+	EditFile(directory, "Missing.hlsl", "created");
+	std::filesystem::remove(directory.GetPath() / "Lit.hlsl");
+	CHECK(watcher.Poll() == 0);
+	CHECK(watcher.Poll() == 2);
+	EditFile(directory, "Missing.hlsl", "edited");
+	watcher.Poll();
+	CHECK(watcher.Poll() == 0);
+	CHECK(watcher.TakeChanges().size() == 2);
+}
+
+TEST_CASE(ShaderFileWatcher_BackgroundThread)
+{
+	Test::TempDirectory directory("FileWatcherThread");
+	EditFile(directory, "Lit.hlsl", "v1");
+	ShaderFileWatcher watcher;
+	watcher.Watch(directory.GetPath() / "Lit.hlsl");
+	watcher.Start(std::chrono::milliseconds(1));
+	EditFile(directory, "Lit.hlsl", "v2");
+
+	std::vector<std::filesystem::path> changes;
+	for (int i = 0; i < 5000 && changes.empty(); ++i) {
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		changes = watcher.TakeChanges();
+	}
+	watcher.Stop();
+	CHECK(changes.size() == 1);
+	// 停止后可以再次启动
+	watcher.Start(std::chrono::milliseconds(1));
+	watcher.Stop();
+}
+
+TEST_CASE(ShaderHotReload_ReflectionCompatibility)
+{
+	auto current = GetReflection(80);
+	current.m_ConstantBuffers[0].m_Variables.push_back({ "gWorld", 0, 64, {} });
+	current.m_ConstantBuffers[0].m_Variables.push_back({ "gColor", 64, 16, {} });
+	current.m_Bindings.push_back({ "gDiffuseMap", ShaderBindingType::SHADER_RESOURCE, 0, 0, 1, 4, false });
+	CHECK(IsReflectionCompatible(current, current));
+
+	// 不再使用其中一部分仍然兼容
+	auto reloaded = current;
+	reloaded.m_ConstantBuffers[0].m_Variables.pop_back();
+	reloaded.m_Bindings.clear();
+	CHECK(IsReflectionCompatible(current, reloaded));
+
+	std::string reason;
+	reloaded = current;
+	reloaded.m_ConstantBuffers[0].m_Variables[1].m_StartOffset = 68;
+	CHECK(!IsReflectionCompatible(current, reloaded, &reason));
+	CHECK(reason.find("gColor") != std::string::npos);
+
+	reloaded = current;
+	reloaded.m_Bindings[0].m_BindPoint = 1;
+	CHECK(!IsReflectionCompatible(current, reloaded, &reason));
+	CHECK(reason.find("gDiffuseMap") != std::string::npos);
+
+	reloaded = current;
+	reloaded.m_Bindings[0].m_Type = ShaderBindingType::RW_RESOURCE;
+	CHECK(!IsReflectionCompatible(current, reloaded));
+
+	reloaded = current;
+	reloaded.m_ConstantBuffers.push_back(GetReflection(16).m_ConstantBuffers[0]);
+	reloaded.m_ConstantBuffers.back().m_Name = "PassConstants";
+	CHECK(!IsReflectionCompatible(current, reloaded));
+
+	reloaded = current;
+	reloaded.m_ThreadGroupSize = { 8, 8, 1 };
+	CHECK(!IsReflectionCompatible(current, reloaded, &reason));
+	CHECK(reason == "thread group size changed");
+}
+
+TEST_CASE(ShaderHotReload_ReloadsRejectsAndFails)
+{
+	Test::TempDirectory directory("HotReload");
+	EditFile(directory, "Lit.hlsl", "#include \"Common.hlsli\"\ncb 80\n");
+	EditFile(directory, "Common.hlsli", "// common\n");
+
+	FileShaderCompiler compiler;
+	JobSystem jobSystem(2);
+	ShaderCompileQueue queue(&compiler, jobSystem);
+	ShaderHotReload hotReload(queue);
+	// 未启用时不登记
+	hotReload.Track(&compiler, "Lit", GetCompileDesc("Lit.hlsl"), GetReflection(80), {});
+	CHECK(hotReload.GetTrackedCount() == 0);
+
+	// 相对路径由源目录解析
+	hotReload.Enable(directory.GetPath(), std::chrono::milliseconds(0));
+	std::vector<std::string> reloads;
+	hotReload.Track(&compiler, "Lit", GetCompileDesc("Lit.hlsl"), GetReflection(80), [&reloads](const ShaderCacheEntry& entry) {
+		reloads.emplace_back(entry.m_ByteCode.begin(), entry.m_ByteCode.end());
+		});
+	CHECK(hotReload.GetTrackedCount() == 1);
+	CHECK(hotReload.GetWatcher().GetWatchCount() == 2);
+	const auto& stats = hotReload.GetStats();
+
+	// 兼容的修改
+	EditFile(directory, "Lit.hlsl", "#include \"Common.hlsli\"\ncb 80 // tweaked\n");
+	CHECK(UpdateUntil(hotReload, [&]() { return reloads.size() == 1; }));
+	CHECK(reloads[0].find("tweaked") != std::string::npos);
+
+	// 包含文件的修改同样触发重新编译
+	EditFile(directory, "Common.hlsli", "// common v2\n");
+	CHECK(UpdateUntil(hotReload, [&]() { return reloads.size() == 2; }));
+	CHECK(stats.m_Reloaded == 2);
+
+	// 布局改变时保留原有的着色器
+	EditFile(directory, "Lit.hlsl", "#include \"Common.hlsli\"\ncb 96\n");
+	CHECK(UpdateUntil(hotReload, [&]() { return stats.m_Rejected == 1; }));
+	CHECK(stats.m_LastError.find("changed its size") != std::string::npos);
+
+	// 编译失败
+	EditFile(directory, "Lit.hlsl", "broken\n");
+	CHECK(UpdateUntil(hotReload, [&]() { return stats.m_Failed == 1; }));
+	CHECK(stats.m_LastError.find("syntax error") != std::string::npos);
+	CHECK(reloads.size() == 2);
+
+	// 新增的包含文件也被监视
+	EditFile(directory, "Extra.hlsli", "// extra\n");
+	EditFile(directory, "Lit.hlsl", "#include \"Common.hlsli\"\n#include \"Extra.hlsli\"\ncb 80\n");
+	CHECK(UpdateUntil(hotReload, [&]() { return reloads.size() == 3; }));
+	CHECK(hotReload.GetWatcher().GetWatchCount() == 3);
+	EditFile(directory, "Extra.hlsli", "// extra v2\n");
+	CHECK(UpdateUntil(hotReload, [&]() { return reloads.size() == 4; }));
+	CHECK(stats.m_Submitted == 6 && compiler.GetStartCount() == 6);
+
+	// 禁用后不再检查
+	hotReload.Disable();
+	EditFile(directory, "Lit.hlsl", "cb 80\n");
+	hotReload.GetWatcher().Poll();
+	hotReload.GetWatcher().Poll();
+	hotReload.Update();
+	CHECK(stats.m_Submitted == 6);
+}
+
+TEST_CASE(ShaderHotReload_SharesAndResubmits)
+{
+	Test::TempDirectory directory("HotReloadShared");
+	EditFile(directory, "Lit.hlsl", "cb 80\n");
+	auto fileName = (directory.GetPath() / "Lit.hlsl").string();
+
+	FileShaderCompiler compiler;
+	JobSystem jobSystem(2);
+	ShaderCompileQueue queue(&compiler, jobSystem);
+	ShaderHotReload hotReload(queue);
+	hotReload.Enable({}, std::chrono::milliseconds(0));
+	const auto& stats = hotReload.GetStats();
+
+	// 每个录制线程各自登记相同的着色器，只编译一次
+	int owners[4]{};
+	std::vector<std::string> reloads;
+	for (auto& owner : owners) {
+		hotReload.Track(&owner, "Lit", GetCompileDesc(fileName), GetReflection(80), [&reloads](const ShaderCacheEntry& entry) {
+			reloads.emplace_back(entry.m_ByteCode.begin(), entry.m_ByteCode.end());
+			});
+	}
+	// 同一 owner 与名称再次登记时替换
+	hotReload.Track(&owners[0], "Lit", GetCompileDesc(fileName), GetReflection(80), [&reloads](const ShaderCacheEntry& entry) {
+		reloads.emplace_back(entry.m_ByteCode.begin(), entry.m_ByteCode.end());
+		});
+	CHECK(hotReload.GetTrackedCount() == 4);
+
+	EditFile(directory, "Lit.hlsl", "cb 80 // v2\n");
+	CHECK(UpdateUntil(hotReload, [&]() { return reloads.size() == 4; }));
+	CHECK(stats.m_Submitted == 1 && stats.m_Shared == 3 && compiler.GetStartCount() == 1);
+
+	// 编译期间再次修改，完成后重新提交并得到最新的内容
+	compiler.SetBlocked(true);
+	EditFile(directory, "Lit.hlsl", "cb 80 // v3\n");
+	CHECK(UpdateUntil(hotReload, [&]() { return compiler.GetStartCount() == 2; }));
+	EditFile(directory, "Lit.hlsl", "cb 80 // v4\n");
+	hotReload.GetWatcher().Poll();
+	hotReload.GetWatcher().Poll();
+	hotReload.Update();
+	CHECK(stats.m_Submitted == 2);
+
+	// 移除一个 owner，其尚未完成的结果被丢弃
+	hotReload.Untrack(&owners[3]);
+	CHECK(hotReload.GetTrackedCount() == 3);
+	compiler.SetBlocked(false);
+	CHECK(UpdateUntil(hotReload, [&]() { return reloads.size() == 10; }));
+	CHECK(stats.m_Submitted == 3 && compiler.GetStartCount() == 3);
+	CHECK(reloads.back().find("v4") != std::string::npos);
+	for (int i = 0; i < 20; ++i) {
+		hotReload.Update();
+	}
+	CHECK(reloads.size() == 10);
+}
+
+BENCHMARK(ShaderFileWatcher_Poll)
+{
+	// 后台线程每次检查的耗时随监视的文件数量增长
+	Test::TempDirectory directory("FileWatcherBench");
+	ShaderFileWatcher watcher;
+	for (int i = 0; i < 256; ++i) {
+		auto name = "Shader" + std::to_string(i) + ".hlsl";
+		EditFile(directory, name, "cb 80\n");
+		watcher.Watch(directory.GetPath() / name);
+	}
+
+	Test::Benchmark("Poll (256 files)", watcher.GetWatchCount(), [&]() {
+		Test::DoNotOptimize(watcher.Poll());
+		});
+}
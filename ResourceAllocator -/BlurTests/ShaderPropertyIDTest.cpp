@@ -0,0 +1,254 @@
+#include "TestFramework.h"
+#include "ShaderPropertyID.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <iterator>
+#include <new>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+using namespace DSM;
+
+namespace {
+	// Blur/Shaders 中声明的全部全局资源名称
+	constexpr const char* ShaderNames[] = {
+		"gBlurRadius", "gBlurTexture", "gBlurWeights", "gCache", "gDiffuse",
+		"gLightCB", "gMatCB", "gMaxBlurRadius", "gObjCB", "gOutput", "gPassCB",
+		"gSamplerAnisotropicClamp", "gSamplerAnisotropicWrap", "gSamplerLinearClamp",
+		"gSamplerLinearWrap", "gSamplerPointClamp", "gSamplerPointWrap",
+		"gSamplerShadowBorder", "gShadowMap", "gTextures",
+	};
+
+	// 字面量在编译期求值
+	static_assert(ShaderPropertyID("gObjCB").GetHash() == ShaderPropertyID::Hash("gObjCB"));
+	static_assert(ShaderPropertyID("gObjCB") != ShaderPropertyID("gMatCB"));
+	static_assert(!ShaderPropertyID().IsValid());
+
+	// 当前线程调用 operator new 的次数，用于统计每帧的堆分配
+	thread_local std::uint64_t t_AllocationCount = 0;
+
+	// 模拟每帧按名称查找物体材质的常量缓冲区与漫反射纹理
+	// 旧的做法每次绘制以 name + "Mat" + 索引构造键并复制纹理名称，名称超出短字符串优化的长度时会分配内存
+	class MaterialLookupScene
+	{
+	public:
+		static constexpr int MaterialCount = 8;
+
+		explicit MaterialLookupScene(std::vector<std::string> objectNames)
+			:m_ObjectNames(std::move(objectNames)) {
+			int value = 0;
+			for (const auto& name : m_ObjectNames) {
+				for (int i = 0; i < MaterialCount; ++i) {
+					auto matName = name + "Mat" + std::to_string(i);
+					auto texName = name + "_Diffuse" + std::to_string(i) + ".dds";
+					m_MatByName.emplace(matName, value);
+					m_TexByName.emplace(texName, value);
+					m_DiffuseNames.push_back(texName);
+					// 加载时转换一次并保存
+					m_MatIDs.push_back(ShaderPropertyID(matName));
+					m_TexIDs.push_back(ShaderPropertyID(texName));
+					m_MatByID.emplace(m_MatIDs.back(), value);
+					m_TexByID.emplace(m_TexIDs.back(), value);
+					++value;
+				}
+			}
+		}
+
+		std::uint64_t DrawByName() const
+		{
+			std::uint64_t sum = 0;
+			for (std::size_t obj = 0; obj < m_ObjectNames.size(); ++obj) {
+				const auto& name = m_ObjectNames[obj];
+				for (int i = 0; i < MaterialCount; ++i) {
+					sum += m_MatByName.find(name + "Mat" + std::to_string(i))->second;
+					std::string texName = m_DiffuseNames[obj * MaterialCount + i];
+					sum += m_TexByName.find(texName)->second;
+				}
+			}
+			return sum;
+		}
+
+		std::uint64_t DrawByID() const
+		{
+			std::uint64_t sum = 0;
+			for (std::size_t i = 0; i < m_MatIDs.size(); ++i) {
+				sum += m_MatByID.find(m_MatIDs[i])->second;
+				sum += m_TexByID.find(m_TexIDs[i])->second;
+			}
+			return sum;
+		}
+
+		std::size_t GetDrawCount() const noexcept { return m_MatIDs.size(); }
+
+	private:
+		std::vector<std::string> m_ObjectNames;
+		std::vector<std::string> m_DiffuseNames;
+		std::vector<ShaderPropertyID> m_MatIDs;
+		std::vector<ShaderPropertyID> m_TexIDs;
+		std::unordered_map<std::string, int> m_MatByName;
+		std::unordered_map<std::string, int> m_TexByName;
+		std::unordered_map<ShaderPropertyID, int> m_MatByID;
+		std::unordered_map<ShaderPropertyID, int> m_TexByID;
+	};
+
+	// 返回执行一次 func 期间当前线程的堆分配次数
+	template <typename Func>
+	std::uint64_t CountAllocations(Func&& func)
+	{
+		auto begin = t_AllocationCount;
+		Test::DoNotOptimize(func());
+		return t_AllocationCount - begin;
+	}
+
+	// 返回排序后的哈希中是否有重复
+	bool HasDuplicate(std::vector<std::uint64_t>& hashes)
+	{
+		std::sort(hashes.begin(), hashes.end());
+		return std::adjacent_find(hashes.begin(), hashes.end()) != hashes.end();
+	}
+}
+
+// 替换全局的 operator new 以统计堆分配，只计数，不改变分配行为
+// operator new[] 与不抛出异常的版本默认转发到这里
+void* operator new(std::size_t size)
+{
+	++t_AllocationCount;
+	if (auto ptr = std::malloc(size == 0 ? 1 : size)) {
+		return ptr;
+	}
+	throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept
+{
+	std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept
+{
+	std::free(ptr);
+}
+
+TEST_CASE(ShaderPropertyID_MatchesFnv1a)
+{
+	// FNV-1a 64 位的标准测试向量
+	CHECK(ShaderPropertyID::Hash("") == 0xcbf29ce484222325ull);
+	CHECK(ShaderPropertyID::Hash("a") == 0xaf63dc4c8601ec8cull);
+	CHECK(ShaderPropertyID::Hash("foobar") == 0x85944171f73967e8ull);
+
+	// 编译期与运行时的结果相同
+	std::string name = "gPassCB";
+	CHECK(ShaderPropertyID(name) == ShaderPropertyID("gPassCB"));
+	CHECK(std::hash<ShaderPropertyID>{}(ShaderPropertyID("gPassCB")) ==
+		static_cast<std::size_t>(ShaderPropertyID::Hash(name)));
+	// 名称中的 '\0' 之后的字符也参与哈希
+	CHECK(ShaderPropertyID(std::string_view{ "gPassCB\0x", 9 }) != ShaderPropertyID("gPassCB"));
+}
+
+TEST_CASE(ShaderPropertyID_RegisterAndGetName)
+{
+	auto id = ShaderPropertyID::Register("gShaderPropertyIDTest");
+	CHECK(id == ShaderPropertyID("gShaderPropertyIDTest"));
+	CHECK(ShaderPropertyID::GetName(id) == "gShaderPropertyIDTest");
+	// 重复注册返回相同的 ID
+	CHECK(ShaderPropertyID::Register("gShaderPropertyIDTest") == id);
+	CHECK(ShaderPropertyID::GetName(ShaderPropertyID("gNeverRegistered")).empty());
+}
+
+TEST_CASE(ShaderPropertyID_NoCollisions)
+{
+	// 着色器中的名称不仅完整哈希不同，作为桶下标的低 32 位也不同
+	std::vector<std::uint64_t> hashes;
+	std::vector<std::uint64_t> lowHashes;
+	for (auto name : ShaderNames) {
+		auto hash = ShaderPropertyID(std::string_view{ name }).GetHash();
+		hashes.push_back(hash);
+		lowHashes.push_back(hash & 0xffffffffull);
+	}
+	CHECK(!HasDuplicate(hashes));
+	CHECK(!HasDuplicate(lowHashes));
+
+	// 所有不超过 3 个字符的标识符，以及带编号的数组元素名称
+	const std::string alphabet = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789_";
+	std::string name;
+	for (char a : alphabet) {
+		name.assign(1, a);
+		hashes.push_back(ShaderPropertyID::Hash(name));
+		for (char b : alphabet) {
+			name.assign({ a, b });
+			hashes.push_back(ShaderPropertyID::Hash(name));
+			for (char c : alphabet) {
+				name.assign({ a, b, c });
+				hashes.push_back(ShaderPropertyID::Hash(name));
+			}
+		}
+	}
+	for (auto prefix : ShaderNames) {
+		for (int i = 0; i < 50000; ++i) {
+			hashes.push_back(ShaderPropertyID::Hash(std::string(prefix) + "[" + std::to_string(i) + "]"));
+		}
+	}
+	CHECK(std::find(hashes.begin(), hashes.end(), 0ull) == hashes.end());
+	CHECK(!HasDuplicate(hashes));
+}
+
+BENCHMARK(ShaderPropertyID_Lookup)
+{
+	// 按 ID 查找与按字面量构造字符串后查找比较
+	std::unordered_map<ShaderPropertyID, int> byID;
+	std::unordered_map<std::string, int> byName;
+	for (int i = 0; i < static_cast<int>(std::size(ShaderNames)); ++i) {
+		byID.emplace(ShaderPropertyID(std::string_view{ ShaderNames[i] }), i);
+		byName.emplace(ShaderNames[i], i);
+	}
+
+	Test::Benchmark("unordered_map<ShaderPropertyID>", 4, [&]() {
+		std::uint64_t sum = byID.find("gObjCB")->second;
+		sum += byID.find("gSamplerAnisotropicClamp")->second;
+		sum += byID.find("gPassCB")->second;
+		sum += byID.find("gShadowMap")->second;
+		Test::DoNotOptimize(sum);
+		});
+	Test::Benchmark("unordered_map<std::string>", 4, [&]() {
+		std::uint64_t sum = byName.find("gObjCB")->second;
+		sum += byName.find("gSamplerAnisotropicClamp")->second;
+		sum += byName.find("gPassCB")->second;
+		sum += byName.find("gShadowMap")->second;
+		Test::DoNotOptimize(sum);
+		});
+}
+
+TEST_CASE(ShaderPropertyID_LookupDoesNotAllocate)
+{
+	// 短名称构造的材质键落在短字符串优化的范围内，但复制纹理名称仍会分配，长名称每个键都会分配
+	MaterialLookupScene shortNames({ "Elena", "Plane" });
+	MaterialLookupScene longNames({ "SponzaCurtainFabric", "SponzaLionHeadShield" });
+	CHECK(shortNames.DrawByID() == shortNames.DrawByName());
+	CHECK(longNames.DrawByID() == longNames.DrawByName());
+
+	CHECK(CountAllocations([&]() { return shortNames.DrawByID(); }) == 0);
+	CHECK(CountAllocations([&]() { return longNames.DrawByID(); }) == 0);
+	CHECK(CountAllocations([&]() { return shortNames.DrawByName(); }) >= shortNames.GetDrawCount());
+	CHECK(CountAllocations([&]() { return longNames.DrawByName(); }) >= 2 * longNames.GetDrawCount());
+}
+
+BENCHMARK(ShaderPropertyID_FrameAllocations)
+{
+	std::pair<const char*, MaterialLookupScene> scenes[] = {
+		{ "short names", MaterialLookupScene({ "Elena", "Plane" }) },
+		{ "long names", MaterialLookupScene({ "SponzaCurtainFabric", "SponzaLionHeadShield" }) },
+	};
+	for (auto& [label, scene] : scenes) {
+		auto drawCount = scene.GetDrawCount();
+		auto byName = std::string("per frame by name: ") + label;
+		auto byID = std::string("per frame by ShaderPropertyID: ") + label;
+		Test::Benchmark(byName.c_str(), drawCount, [&]() { Test::DoNotOptimize(scene.DrawByName()); });
+		Test::Benchmark(byID.c_str(), drawCount, [&]() { Test::DoNotOptimize(scene.DrawByID()); });
+		std::printf("  heap allocations per frame (%zu draws, %s): by name %llu, by ShaderPropertyID %llu\n",
+			drawCount, label,
+			static_cast<unsigned long long>(CountAllocations([&]() { return scene.DrawByName(); })),
+			static_cast<unsigned long long>(CountAllocations([&]() { return scene.DrawByID(); })));
+	}
+}
@@ -0,0 +1,163 @@
+#include "TestFramework.h"
+#include "ShaderVariant.h"
+#include <map>
+#include <set>
+#include <string>
+
+using namespace DSM;
+
+TEST_CASE(ShaderKeywordSet_KeyPacking)
+{
+	ShaderKeywordSet keywords;
+	auto dirLight = keywords.AddRange("DIRLIGHTCOUNT", 0, 3);     // 4 个取值，2 位
+	auto alphaTest = keywords.AddToggle("ALPHATEST");             // 1 位
+	auto quality = keywords.AddKeyword("QUALITY", { "LOW", "MEDIUM", "HIGH", "ULTRA", "CINEMATIC" });    // 3 位
+	auto single = keywords.AddKeyword("PLATFORM", { "PC" });      // 只有一个取值，不占用位
+	CHECK(dirLight == 0 && alphaTest == 1 && quality == 2 && single == 3);
+	CHECK(keywords.GetKeywordCount() == 4);
+	CHECK(keywords.GetValueCount(dirLight) == 4);
+	CHECK(keywords.GetValueCount(quality) == 5);
+	CHECK(keywords.GetKeywordName(quality) == "QUALITY");
+	CHECK(keywords.GetKeyRange() == (1u << 6));
+
+	// 关键字按加入顺序占用连续的位
+	CHECK(keywords.SetValue(0, dirLight, 3) == 0b000'0'11);
+	CHECK(keywords.SetValue(0, alphaTest, 1) == 0b000'1'00);
+	CHECK(keywords.SetValue(0, quality, 4) == 0b100'0'00);
+
+	// 所有组合写入后都能原样读出，且互不影响
+	std::set<ShaderVariantKey> keys;
+	for (std::uint32_t d = 0; d < 4; ++d) {
+		for (std::uint32_t a = 0; a < 2; ++a) {
+			for (std::uint32_t q = 0; q < 5; ++q) {
+				ShaderVariantKey key = 0;
+				key = keywords.SetValue(key, quality, q);
+				key = keywords.SetValue(key, dirLight, d);
+				key = keywords.SetValue(key, alphaTest, a);
+				CHECK(key < keywords.GetKeyRange());
+				CHECK(keywords.IsValid(key));
+				CHECK(keywords.GetValue(key, dirLight) == d);
+				CHECK(keywords.GetValue(key, alphaTest) == a);
+				CHECK(keywords.GetValue(key, quality) == q);
+				CHECK(keywords.GetValue(key, single) == 0);
+				keys.insert(key);
+			}
+		}
+	}
+	CHECK(keys.size() == 4 * 2 * 5);
+
+	// 覆盖已有的取值时清除原来的位
+	auto key = keywords.SetValue(keywords.SetValue(0, quality, 4), quality, 1);
+	CHECK(keywords.GetValue(key, quality) == 1);
+	key = keywords.SetValue(keywords.SetValue(key, dirLight, 3), dirLight, 0);
+	CHECK(key == keywords.SetValue(0, quality, 1));
+}
+
+TEST_CASE(ShaderKeywordSet_IsValidWithPartialEncodings)
+{
+	// 3 个取值占用 2 位，编码 3 没有对应的取值
+	ShaderKeywordSet keywords;
+	auto count = keywords.AddRange("COUNT", 0, 2);
+	auto fog = keywords.AddToggle("ENABLEFOG");
+	CHECK(keywords.GetKeyRange() == 8);
+
+	for (ShaderVariantKey key = 0; key < keywords.GetKeyRange(); ++key) {
+		auto encoded = key & 0b11;
+		CHECK(keywords.IsValid(key) == (encoded < 3));
+	}
+	CHECK(!keywords.IsValid(keywords.GetKeyRange()));
+	CHECK(!keywords.IsValid(UINT32_MAX));
+	CHECK(keywords.IsValid(keywords.SetValue(keywords.SetValue(0, count, 2), fog, 1)));
+
+	// 没有关键字时只有键 0
+	ShaderKeywordSet empty;
+	CHECK(empty.GetKeyRange() == 1);
+	CHECK(empty.IsValid(0));
+	CHECK(!empty.IsValid(1));
+	CHECK(empty.GetDefines(0).empty());
+}
+
+TEST_CASE(ShaderKeywordSet_MaxKeyBits)
+{
+	// 恰好用满 MaxKeyBits 位
+	ShaderKeywordSet keywords;
+	for (std::uint32_t i = 0; i < ShaderKeywordSet::MaxKeyBits; ++i) {
+		CHECK(keywords.AddToggle("TOGGLE" + std::to_string(i)) == i);
+	}
+	CHECK(keywords.GetKeyRange() == (1u << ShaderKeywordSet::MaxKeyBits));
+	CHECK(keywords.IsValid(keywords.GetKeyRange() - 1));
+
+	// 超出时不加入，已有的键不变
+	CHECK(keywords.AddToggle("OVERFLOW") == ShaderKeywordSet::InvalidKeyword);
+	CHECK(keywords.GetKeywordCount() == ShaderKeywordSet::MaxKeyBits);
+	CHECK(keywords.GetKeyRange() == (1u << ShaderKeywordSet::MaxKeyBits));
+	// 不占用位的关键字仍可以加入
+	CHECK(keywords.AddKeyword("CONSTANT", { "1" }) == ShaderKeywordSet::MaxKeyBits);
+
+	// 单个关键字的取值过多
+	ShaderKeywordSet wide;
+	CHECK(wide.AddRange("WIDE", 0, (1u << ShaderKeywordSet::MaxKeyBits) - 1) == 0);
+	CHECK(wide.AddToggle("MORE") == ShaderKeywordSet::InvalidKeyword);
+	ShaderKeywordSet tooWide;
+	CHECK(tooWide.AddRange("TOOWIDE", 0, 1u << ShaderKeywordSet::MaxKeyBits) == ShaderKeywordSet::InvalidKeyword);
+	CHECK(tooWide.GetKeywordCount() == 0);
+}
+
+TEST_CASE(ShaderKeywordSet_Defines)
+{
+	ShaderKeywordSet keywords;
+	auto dirLight = keywords.AddRange("DIRLIGHTCOUNT", 0, 3);
+	auto pointLight = keywords.AddRange("POINTLIGHTCOUNT", 2, 4);
+	auto alphaTest = keywords.AddToggle("ALPHATEST");
+	auto fog = keywords.AddToggle("ENABLEFOG");
+
+	// 默认取值：开关不定义宏，范围使用最小值
+	using Defines = std::map<std::string, std::string>;
+	CHECK((keywords.GetDefines(0) == Defines{ { "DIRLIGHTCOUNT", "0" }, { "POINTLIGHTCOUNT", "2" } }));
+
+	ShaderVariantKey key = 0;
+	key = keywords.SetValue(key, dirLight, 1);
+	key = keywords.SetValue(key, pointLight, 2);
+	key = keywords.SetValue(key, alphaTest, 1);
+	CHECK((keywords.GetDefines(key) == Defines{
+		{ "ALPHATEST", "1" }, { "DIRLIGHTCOUNT", "1" }, { "POINTLIGHTCOUNT", "4" } }));
+
+	key = keywords.SetValue(key, alphaTest, 0);
+	key = keywords.SetValue(key, fog, 1);
+	CHECK((keywords.GetDefines(key) == Defines{
+		{ "DIRLIGHTCOUNT", "1" }, { "ENABLEFOG", "1" }, { "POINTLIGHTCOUNT", "4" } }));
+
+	// 自定义取值中的空字符串同样不定义宏
+	ShaderKeywordSet custom;
+	auto mode = custom.AddKeyword("MODE", { "", "FAST", "SLOW" });
+	CHECK(custom.GetDefines(custom.SetValue(0, mode, 0)).empty());
+	CHECK((custom.GetDefines(custom.SetValue(0, mode, 2)) == Defines{ { "MODE", "SLOW" } }));
+}
+
+TEST_CASE(ShaderVariantTable_RequestAndFind)
+{
+	ShaderVariantTable<std::string> table(4);
+	CHECK(table.Find(2) == nullptr);
+	CHECK(!table.IsRequested(2));
+
+	// 只有第一次请求需要开始编译
+	CHECK(table.Request(2));
+	CHECK(!table.Request(2));
+	CHECK(table.IsRequested(2));
+	CHECK(table.Find(2) == nullptr);
+
+	table.SetVariant(2, "variant2");
+	CHECK(table.Find(2) != nullptr && *table.Find(2) == "variant2");
+	CHECK(table.GetVariantCount() == 1);
+	// 替换已有的变体不增加数量，直接设置的变体视为已请求
+	table.SetVariant(2, "variant2b");
+	table.SetVariant(3, "variant3");
+	CHECK(*table.Find(2) == "variant2b");
+	CHECK(table.GetVariantCount() == 2);
+	CHECK(!table.Request(3));
+
+	table.Reset(8);
+	CHECK(table.GetVariantCount() == 0);
+	CHECK(table.Find(2) == nullptr);
+	CHECK(table.Request(7));
+}
@@ -0,0 +1,92 @@
+#include "TestFramework.h"
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <random>
+#include <string>
+
+namespace DSM::Test {
+	namespace {
+		volatile std::uint64_t g_Sink = 0;
+	}
+
+	std::vector<TestCase>& GetTestCases()
+	{
+		static std::vector<TestCase> testCases;
+		return testCases;
+	}
+
+	TestRegistrar::TestRegistrar(const char* name, TestFunc func, bool isBenchmark)
+	{
+		GetTestCases().push_back({ name, func, isBenchmark });
+	}
+
+	void Fail(const char* expression, const char* file, int line)
+	{
+		throw TestFailure(std::string(file) + "(" + std::to_string(line) + "): CHECK(" + expression + ") failed");
+	}
+
+	void DoNotOptimize(std::uint64_t value) noexcept
+	{
+		g_Sink = g_Sink + value;
+	}
+
+	double Benchmark(
+		const char* name,
+		std::uint64_t itemsPerIteration,
+		const std::function<void()>& func,
+		std::chrono::milliseconds minDuration)
+	{
+		using Clock = std::chrono::steady_clock;
+
+		// 先执行一次预热，排除首次分配内存与缓存未命中的影响
+		func();
+
+		std::uint64_t iterations = 0;
+		Clock::duration elapsed{};
+		auto start = Clock::now();
+		do {
+			func();
+			++iterations;
+			elapsed = Clock::now() - start;
+		} while (elapsed < minDuration);
+
+		auto items = (std::max)(iterations * itemsPerIteration, std::uint64_t{ 1 });
+		auto nsPerItem = std::chrono::duration<double, std::nano>(elapsed).count() / static_cast<double>(items);
+		std::printf("  %-48s %12.2f ns/item %10.2f Mitems/s  (%llu iterations)\n",
+			name, nsPerItem, 1e3 / nsPerItem, static_cast<unsigned long long>(iterations));
+		return nsPerItem;
+	}
+
+	TempDirectory::TempDirectory(const std::string& name)
+	{
+		// 加上随机数，同时运行的多个测试进程不会共用目录
+		std::random_device random;
+		auto parent = std::filesystem::temp_directory_path();
+		do {
+			m_Path = parent / ("BlurTests_" + name + "_" + std::to_string(random()));
+		} while (!std::filesystem::create_directories(m_Path));
+	}
+
+	TempDirectory::~TempDirectory()
+	{
+		std::error_code ec;
+		std::filesystem::remove_all(m_Path, ec);
+	}
+
+	const std::filesystem::path& TempDirectory::GetPath() const noexcept
+	{
+		return m_Path;
+	}
+
+	std::filesystem::path TempDirectory::WriteFile(const std::filesystem::path& relativePath, const std::string& content) const
+	{
+		auto path = m_Path / relativePath;
+		std::filesystem::create_directories(path.parent_path());
+		std::ofstream file(path, std::ios::binary | std::ios::trunc);
+		if (!file.write(content.data(), content.size())) {
+			throw std::runtime_error("Failed to write " + path.string());
+		}
+		return path;
+	}
+}
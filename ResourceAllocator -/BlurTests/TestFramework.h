@@ -0,0 +1,93 @@
+#pragma once
+#ifndef __TESTFRAMEWORK__H__
+#define __TESTFRAMEWORK__H__
+
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace DSM::Test {
+	using TestFunc = void(*)();
+
+	struct TestCase
+	{
+		const char* m_Name;
+		TestFunc m_Func;
+		bool m_IsBenchmark;
+	};
+
+	// 测试与基准在静态初始化时注册，由 main 按注册顺序执行
+	std::vector<TestCase>& GetTestCases();
+
+	struct TestRegistrar
+	{
+		TestRegistrar(const char* name, TestFunc func, bool isBenchmark);
+	};
+
+	// CHECK 失败时抛出，main 捕获后继续执行下一个测试
+	struct TestFailure : std::runtime_error
+	{
+		using std::runtime_error::runtime_error;
+	};
+
+	[[noreturn]] void Fail(const char* expression, const char* file, int line);
+
+	// 阻止编译器删除基准中未被使用的结果
+	void DoNotOptimize(std::uint64_t value) noexcept;
+
+	// 重复执行 func 直到累计时间不少于 minDuration，输出每个元素的平均耗时
+	// itemsPerIteration 为每次调用 func 处理的元素数量，返回每个元素的纳秒数
+	double Benchmark(
+		const char* name,
+		std::uint64_t itemsPerIteration,
+		const std::function<void()>& func,
+		std::chrono::milliseconds minDuration = std::chrono::milliseconds(200));
+
+	// 系统临时目录下的独立目录，析构时连同其中的文件一起删除
+	class TempDirectory
+	{
+	public:
+		explicit TempDirectory(const std::string& name);
+		~TempDirectory();
+
+		TempDirectory(const TempDirectory&) = delete;
+		TempDirectory& operator=(const TempDirectory&) = delete;
+
+		const std::filesystem::path& GetPath() const noexcept;
+		// 写入文件并创建所需的子目录，返回文件的完整路径
+		std::filesystem::path WriteFile(const std::filesystem::path& relativePath, const std::string& content) const;
+
+	private:
+		std::filesystem::path m_Path;
+	};
+}
+
+#define TEST_CASE(name) \
+	static void name(); \
+	static const DSM::Test::TestRegistrar name##Registrar{ #name, &name, false }; \
+	static void name()
+
+#define BENCHMARK(name) \
+	static void name(); \
+	static const DSM::Test::TestRegistrar name##Registrar{ #name, &name, true }; \
+	static void name()
+
+#define CHECK(expression) \
+	do { \
+		if (!(expression)) DSM::Test::Fail(#expression, __FILE__, __LINE__); \
+	} while (false)
+
+#define CHECK_THROWS(expression) \
+	do { \
+		bool thrown__ = false; \
+		try { (void)(expression); } \
+		catch (const DSM::Test::TestFailure&) { throw; } \
+		catch (...) { thrown__ = true; } \
+		if (!thrown__) DSM::Test::Fail(#expression " throws", __FILE__, __LINE__); \
+	} while (false)
+
+#endif
@@ -0,0 +1,49 @@
+#include "TestFramework.h"
+#include <cstdio>
+#include <exception>
+#include <string_view>
+
+using namespace DSM::Test;
+
+// 默认执行所有测试，--bench 时只执行基准，--filter 只执行名称包含指定字符串的项
+int main(int argc, char** argv)
+{
+	bool runBenchmarks = false;
+	std::string_view filter;
+	for (int i = 1; i < argc; ++i) {
+		std::string_view arg = argv[i];
+		if (arg == "--bench") {
+			runBenchmarks = true;
+		}
+		else if (arg == "--filter" && i + 1 < argc) {
+			filter = argv[++i];
+		}
+		else {
+			std::fprintf(stderr, "usage: %s [--bench] [--filter name]\n", argv[0]);
+			return 2;
+		}
+	}
+
+	int runCount = 0;
+	int failedCount = 0;
+	for (const auto& testCase : GetTestCases()) {
+		if (testCase.m_IsBenchmark != runBenchmarks) continue;
+		if (!filter.empty() && std::string_view(testCase.m_Name).find(filter) == std::string_view::npos) continue;
+
+		++runCount;
+		std::printf("[ RUN    ] %s\n", testCase.m_Name);
+		std::fflush(stdout);
+		try {
+			testCase.m_Func();
+			std::printf("[     OK ] %s\n", testCase.m_Name);
+		}
+		catch (const std::exception& e) {
+			++failedCount;
+			std::printf("[ FAILED ] %s\n  %s\n", testCase.m_Name, e.what());
+		}
+		std::fflush(stdout);
+	}
+
+	std::printf("%d run, %d failed\n", runCount, failedCount);
+	return failedCount == 0 ? 0 : 1;
+}
@@ -0,0 +1,60 @@
+-- 不依赖设备的测试，只编译纯 C++ 的源文件，可在 Linux 上构建
+targetName = "BlurTests"
+target(targetName)
+    set_kind("binary")
+    set_group(groupName)
+    set_targetdir(path.join(binDir, targetName))
+
+    if not is_plat("windows") then
+        add_syslinks("pthread")
+    end
+
+    add_includedirs("../Blur", "../Common")
+    add_files(
+        "../Blur/AllocatorStats.cpp",
+        "../Blur/BindlessIndexTable.cpp",
+        "../Blur/BuddyAllocator.cpp",
+        "../Blur/CommandListStateTracker.cpp",
+        "../Blur/ConstantBufferData.cpp",
+        "../Blur/DefragPlanner.cpp",
+        "../Blur/DescriptorRangeAllocator.cpp",
+        "../Blur/ParallelRecord.cpp",
+        "../Blur/RingAllocator.cpp",
+        "../Blur/ShaderCache.cpp",
+        "../Blur/ShaderCompiler.cpp",
+        "../Blur/ShaderFileWatcher.cpp",
+        "../Blur/ShaderHotReload.cpp",
+        "../Blur/ShaderPropertyID.cpp",
+        "../Blur/ShaderVariant.cpp",
+        "../Common/JobSystem.cpp")
+    add_files("*.cpp")
+    add_headerfiles("*.h")
+
+    -- xmake test 执行单元测试与基准
+    add_tests("unit")
+    add_tests("bench", {runargs = "--bench"})
+
+target_end()
+
+-- 依赖 D3D12 与 DirectXMath 的测试，只在 Windows 上构建
+if is_plat("windows") then
+targetName = "BlurD3D12Tests"
+target(targetName)
+    set_kind("binary")
+    set_group(groupName)
+    set_targetdir(path.join(binDir, targetName))
+
+    add_deps(commonName)
+
+    add_dxsdk_options()
+
+    -- 测试直接编译 Blur 中除入口以外的源文件
+    add_includedirs("./", "../Blur")
+    add_files("../Blur/**.cpp|main.cpp")
+    add_files("D3D12/*.cpp", "TestFramework.cpp", "main.cpp")
+
+    add_tests("unit")
+    add_tests("bench", {runargs = "--bench"})
+
+target_end()
+end
@@ -48,6 +48,11 @@ namespace DSM {
 		// SubAllocation Resource 子分配资源
 		D3D12BuddyBlockData m_BlockData;
 		D3D12BuddyAllocator* m_Allocator = nullptr;
+		// 所属分配器在 D3D12MultiBuddyAllocator 中的索引，用于 O(1) 的释放
+		std::uint32_t m_PoolIndex = UINT32_MAX;
+		// 从 Slab 中分配的小纹理所在的位置
+		std::uint32_t m_SlabIndex = UINT32_MAX;
+		std::uint32_t m_SlotIndex = 0;
 		// StandAlone 独立的资源,或是 SubAllocation 的父资源, 若是在自定义堆上分配则为空
 		D3D12Resource* m_UnderlyingResource = nullptr;
 
@@ -0,0 +1,274 @@
+#include "JobSystem.h"
+#include <cassert>
+#include <stdexcept>
+
+namespace DSM {
+	namespace {
+		// 当前线程所属的任务系统与队列序号
+		thread_local const JobSystem* t_JobSystem = nullptr;
+		thread_local std::uint32_t t_QueueIndex = 0;
+	}
+
+	//
+	// JobSystem Implementation
+	//
+	JobSystem::JobSystem(std::uint32_t threadCount)
+	{
+		if (threadCount == 0) {
+			threadCount = (std::max)(std::thread::hardware_concurrency(), 2u) - 1;
+		}
+
+		m_Queues.reserve(threadCount + 1);
+		for (std::uint32_t i = 0; i <= threadCount; ++i) {
+			m_Queues.push_back(std::make_unique<WorkQueue>());
+		}
+		m_Threads.reserve(threadCount);
+		for (std::uint32_t i = 1; i <= threadCount; ++i) {
+			m_Threads.emplace_back(&JobSystem::WorkerLoop, this, i);
+		}
+	}
+
+	JobSystem::~JobSystem()
+	{
+		// 工作线程执行完队列中剩余的任务后退出
+		{
+			std::lock_guard<std::mutex> lock(m_SleepMutex);
+			m_Stop.store(true);
+		}
+		m_SleepCondition.notify_all();
+		for (auto& thread : m_Threads) {
+			thread.join();
+		}
+	}
+
+	void JobSystem::Run(Job job, JobCounter& counter)
+	{
+		assert(job != nullptr);
+		counter.m_Count.fetch_add(1, std::memory_order_relaxed);
+
+		// 工作线程提交的任务放入自己的队列，之后最先被自己取出
+		auto queueIndex = t_JobSystem == this ? t_QueueIndex : 0;
+		{
+			auto& queue = *m_Queues[queueIndex];
+			std::lock_guard<std::mutex> lock(queue.m_Mutex);
+			queue.m_Jobs.push_back({ std::move(job), &counter });
+		}
+
+		// 与 WorkerLoop 中先登记休眠再检查队列的顺序配合，不会遗漏唤醒
+		m_QueuedCount.fetch_add(1);
+		if (m_SleepingCount.load() > 0) {
+			{
+				std::lock_guard<std::mutex> lock(m_SleepMutex);
+			}
+			m_SleepCondition.notify_one();
+		}
+	}
+
+	void JobSystem::Wait(JobCounter& counter)
+	{
+		if (auto exception = WaitForCounter(counter); exception != nullptr) {
+			std::rethrow_exception(exception);
+		}
+	}
+
+	std::uint32_t JobSystem::GetThreadCount() const noexcept
+	{
+		return static_cast<std::uint32_t>(m_Threads.size());
+	}
+
+	std::uint32_t JobSystem::GetCurrentThreadIndex() const noexcept
+	{
+		return t_JobSystem == this ? t_QueueIndex : 0;
+	}
+
+	JobSystem& JobSystem::GetDefault()
+	{
+		static JobSystem jobSystem;
+		return jobSystem;
+	}
+
+	bool JobSystem::TryRunJob(std::uint32_t queueIndex)
+	{
+		JobEntry entry{};
+		if (PopJob(queueIndex, entry) || StealJob(queueIndex, entry)) {
+			Execute(entry);
+			return true;
+		}
+		return false;
+	}
+
+	bool JobSystem::PopJob(std::uint32_t queueIndex, JobEntry& entry)
+	{
+		auto& queue = *m_Queues[queueIndex];
+		std::lock_guard<std::mutex> lock(queue.m_Mutex);
+		if (queue.m_Jobs.empty()) return false;
+
+		// 共用队列按提交顺序执行，工作线程的队列后进先出，数据仍在缓存中
+		if (queueIndex == 0) {
+			entry = std::move(queue.m_Jobs.front());
+			queue.m_Jobs.pop_front();
+		}
+		else {
+			entry = std::move(queue.m_Jobs.back());
+			queue.m_Jobs.pop_back();
+		}
+		m_QueuedCount.fetch_sub(1);
+		return true;
+	}
+
+	bool JobSystem::StealJob(std::uint32_t queueIndex, JobEntry& entry)
+	{
+		// 从下一个队列开始轮询，避免所有线程同时窃取同一个队列
+		auto queueCount = static_cast<std::uint32_t>(m_Queues.size());
+		for (std::uint32_t i = 1; i < queueCount; ++i) {
+			auto& queue = *m_Queues[(queueIndex + i) % queueCount];
+			std::lock_guard<std::mutex> lock(queue.m_Mutex);
+			if (queue.m_Jobs.empty()) continue;
+
+			// 头部是最早提交的任务，通常是较大的一块工作
+			entry = std::move(queue.m_Jobs.front());
+			queue.m_Jobs.pop_front();
+			m_QueuedCount.fetch_sub(1);
+			return true;
+		}
+		return false;
+	}
+
+	void JobSystem::Execute(JobEntry& entry)
+	{
+		auto counter = entry.m_Counter;
+		try {
+			entry.m_Job();
+		}
+		catch (...) {
+			std::lock_guard<std::mutex> lock(counter->m_ExceptionMutex);
+			if (counter->m_Exception == nullptr) {
+				counter->m_Exception = std::current_exception();
+			}
+		}
+		// 释放任务持有的资源后再减少计数，计数归零后计数器可能立即被销毁
+		entry.m_Job = nullptr;
+		counter->m_Count.fetch_sub(1, std::memory_order_release);
+	}
+
+	std::exception_ptr JobSystem::WaitForCounter(JobCounter& counter)
+	{
+		auto queueIndex = t_JobSystem == this ? t_QueueIndex : 0;
+		while (!counter.IsDone()) {
+			if (!TryRunJob(queueIndex)) {
+				// 剩余的任务正在其他线程中执行
+				std::this_thread::yield();
+			}
+		}
+
+		std::lock_guard<std::mutex> lock(counter.m_ExceptionMutex);
+		return std::exchange(counter.m_Exception, nullptr);
+	}
+
+	void JobSystem::WorkerLoop(std::uint32_t queueIndex)
+	{
+		t_JobSystem = this;
+		t_QueueIndex = queueIndex;
+
+		while (true) {
+			if (TryRunJob(queueIndex)) continue;
+
+			std::unique_lock<std::mutex> lock(m_SleepMutex);
+			m_SleepingCount.fetch_add(1);
+			m_SleepCondition.wait(lock, [this]() {
+				return m_Stop.load() || m_QueuedCount.load() > 0;
+				});
+			m_SleepingCount.fetch_sub(1);
+			if (m_Stop.load() && m_QueuedCount.load() <= 0) return;
+		}
+	}
+
+
+
+	//
+	// JobGraph Implementation
+	//
+	JobGraph::NodeID JobGraph::AddNode(JobSystem::Job job)
+	{
+		assert(job != nullptr);
+		auto node = static_cast<NodeID>(m_Nodes.size());
+		m_Nodes.push_back({ std::move(job), {}, 0 });
+		return node;
+	}
+
+	void JobGraph::AddDependency(NodeID before, NodeID after)
+	{
+		assert(before < m_Nodes.size() && after < m_Nodes.size());
+		m_Nodes[before].m_Successors.push_back(after);
+		++m_Nodes[after].m_DependencyCount;
+	}
+
+	void JobGraph::Execute(JobSystem& jobSystem)
+	{
+		auto nodeCount = GetNodeCount();
+		if (nodeCount == 0) return;
+
+		// 先按拓扑顺序检查是否存在环，存在环时部分节点永远不会开始
+		std::vector<std::uint32_t> remaining(nodeCount);
+		std::vector<NodeID> ready;
+		for (NodeID i = 0; i < nodeCount; ++i) {
+			remaining[i] = m_Nodes[i].m_DependencyCount;
+			if (remaining[i] == 0) {
+				ready.push_back(i);
+			}
+		}
+		auto roots = ready;
+		std::uint32_t visitedCount = 0;
+		while (!ready.empty()) {
+			auto node = ready.back();
+			ready.pop_back();
+			++visitedCount;
+			for (auto successor : m_Nodes[node].m_Successors) {
+				if (--remaining[successor] == 0) {
+					ready.push_back(successor);
+				}
+			}
+		}
+		if (visitedCount != nodeCount) {
+			throw std::logic_error("JobGraph contains a dependency cycle");
+		}
+
+		m_Remaining = std::make_unique<std::atomic<std::uint32_t>[]>(nodeCount);
+		for (NodeID i = 0; i < nodeCount; ++i) {
+			m_Remaining[i].store(m_Nodes[i].m_DependencyCount, std::memory_order_relaxed);
+		}
+
+		JobCounter counter;
+		for (auto root : roots) {
+			jobSystem.Run([this, &jobSystem, &counter, root]() {
+				RunNode(jobSystem, counter, root);
+				}, counter);
+		}
+		jobSystem.Wait(counter);
+	}
+
+	std::uint32_t JobGraph::GetNodeCount() const noexcept
+	{
+		return static_cast<std::uint32_t>(m_Nodes.size());
+	}
+
+	void JobGraph::Clear() noexcept
+	{
+		m_Nodes.clear();
+		m_Remaining.reset();
+	}
+
+	void JobGraph::RunNode(JobSystem& jobSystem, JobCounter& counter, NodeID node)
+	{
+		m_Nodes[node].m_Job();
+
+		// 后继在当前任务结束前提交，计数器不会提前归零
+		for (auto successor : m_Nodes[node].m_Successors) {
+			if (m_Remaining[successor].fetch_sub(1, std::memory_order_acq_rel) == 1) {
+				jobSystem.Run([this, &jobSystem, &counter, successor]() {
+					RunNode(jobSystem, counter, successor);
+					}, counter);
+			}
+		}
+	}
+}
@@ -0,0 +1,181 @@
+#pragma once
+#ifndef __JOBSYSTEM__H__
+#define __JOBSYSTEM__H__
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace DSM {
+	// 一组任务的计数器，提交任务时加一，任务完成时减一，归零时这组任务全部完成
+	// 等待完成前计数器不能被销毁，计数器可在 Wait 返回后复用
+	class JobCounter
+	{
+	public:
+		JobCounter() = default;
+		JobCounter(const JobCounter&) = delete;
+		JobCounter& operator=(const JobCounter&) = delete;
+
+		bool IsDone() const noexcept { return m_Count.load(std::memory_order_acquire) == 0; }
+
+	private:
+		friend class JobSystem;
+
+		std::atomic<std::uint32_t> m_Count{ 0 };
+		std::mutex m_ExceptionMutex;
+		std::exception_ptr m_Exception;
+	};
+
+
+	// 工作窃取的任务系统
+	// 每个工作线程有自己的双端队列，从尾部取出自己提交的任务，空闲时从其他队列的头部窃取
+	// 非工作线程提交的任务进入共用的队列，等待任务时调用线程也会执行任务，在任务中等待不会死锁
+	class JobSystem
+	{
+	public:
+		using Job = std::function<void()>;
+
+		// threadCount 为 0 时使用硬件线程数减一，调用线程在等待时补上剩余的一个
+		explicit JobSystem(std::uint32_t threadCount = 0);
+		~JobSystem();
+		JobSystem(const JobSystem&) = delete;
+		JobSystem& operator=(const JobSystem&) = delete;
+
+		void Run(Job job, JobCounter& counter);
+		// 等待计数器归零，期间执行队列中的任务，任务抛出的第一个异常在此重新抛出
+		void Wait(JobCounter& counter);
+
+		// 将 [begin, end) 划分为至少 grainSize 个元素的块并行执行 func(rangeBegin, rangeEnd)
+		// 调用线程执行第一块，全部完成后返回
+		template <typename Func>
+		void ParallelFor(std::uint32_t begin, std::uint32_t end, std::uint32_t grainSize, Func&& func);
+
+		std::uint32_t GetThreadCount() const noexcept;
+		// 工作线程的序号为 1 ~ GetThreadCount()，其他线程为 0，可用于选择线程独占的临时数据
+		std::uint32_t GetCurrentThreadIndex() const noexcept;
+
+		// 全局共用的任务系统，第一次使用时创建
+		static JobSystem& GetDefault();
+
+	private:
+		struct JobEntry
+		{
+			Job m_Job;
+			JobCounter* m_Counter = nullptr;
+		};
+
+		struct WorkQueue
+		{
+			std::mutex m_Mutex;
+			std::deque<JobEntry> m_Jobs;
+		};
+
+		// 依次尝试自己的队列、共用队列与其他工作线程的队列
+		bool TryRunJob(std::uint32_t queueIndex);
+		bool PopJob(std::uint32_t queueIndex, JobEntry& entry);
+		bool StealJob(std::uint32_t queueIndex, JobEntry& entry);
+		void Execute(JobEntry& entry);
+		std::exception_ptr WaitForCounter(JobCounter& counter);
+		void WorkerLoop(std::uint32_t queueIndex);
+
+	private:
+		// 0 为非工作线程共用的队列，i 为第 i 个工作线程的队列
+		std::vector<std::unique_ptr<WorkQueue>> m_Queues;
+		std::vector<std::thread> m_Threads;
+
+		// 入队但未被取出的任务数量，工作线程为零时休眠
+		std::atomic<std::int32_t> m_QueuedCount{ 0 };
+		std::atomic<std::uint32_t> m_SleepingCount{ 0 };
+		std::atomic<bool> m_Stop{ false };
+		std::mutex m_SleepMutex;
+		std::condition_variable m_SleepCondition;
+	};
+
+
+	// 有依赖关系的一组任务，节点在所有前驱完成后开始执行
+	// 节点抛出异常时其后继不会执行，异常在 Execute 中重新抛出
+	class JobGraph
+	{
+	public:
+		using NodeID = std::uint32_t;
+
+		NodeID AddNode(JobSystem::Job job);
+		// after 在 before 完成后开始
+		void AddDependency(NodeID before, NodeID after);
+		// 执行所有节点并等待完成，依赖中存在环时抛出 std::logic_error，图可以重复执行
+		void Execute(JobSystem& jobSystem);
+
+		std::uint32_t GetNodeCount() const noexcept;
+		void Clear() noexcept;
+
+	private:
+		void RunNode(JobSystem& jobSystem, JobCounter& counter, NodeID node);
+
+	private:
+		struct Node
+		{
+			JobSystem::Job m_Job;
+			std::vector<NodeID> m_Successors;
+			std::uint32_t m_DependencyCount = 0;
+		};
+
+		std::vector<Node> m_Nodes;
+		// 执行时每个节点尚未完成的前驱数量
+		std::unique_ptr<std::atomic<std::uint32_t>[]> m_Remaining;
+	};
+
+
+	template <typename Func>
+	inline void JobSystem::ParallelFor(std::uint32_t begin, std::uint32_t end, std::uint32_t grainSize, Func&& func)
+	{
+		if (begin >= end) return;
+
+		// 块数不超过线程数的若干倍，减少调度开销的同时留出窃取的余地
+		auto count = end - begin;
+		grainSize = (std::max)(grainSize, 1u);
+		auto maxChunkCount = (GetThreadCount() + 1) * 4;
+		auto chunkCount = (std::min)((count - 1) / grainSize + 1, maxChunkCount);
+		if (chunkCount == 1) {
+			func(begin, end);
+			return;
+		}
+
+		auto chunkBegin = [begin, count, chunkCount](std::uint32_t chunk) {
+			return begin + static_cast<std::uint32_t>(std::uint64_t{ count } * chunk / chunkCount);
+			};
+
+		JobCounter counter;
+		for (std::uint32_t chunk = 1; chunk < chunkCount; ++chunk) {
+			Run([&func, rangeBegin = chunkBegin(chunk), rangeEnd = chunkBegin(chunk + 1)]() {
+				func(rangeBegin, rangeEnd);
+				}, counter);
+		}
+
+		// 其他块引用了 func 与 counter，调用线程的块抛出异常时也要等待全部完成
+		std::exception_ptr exception;
+		try {
+			func(begin, chunkBegin(1));
+		}
+		catch (...) {
+			exception = std::current_exception();
+		}
+		auto jobException = WaitForCounter(counter);
+		if (exception == nullptr) {
+			exception = jobException;
+		}
+		if (exception != nullptr) {
+			std::rethrow_exception(exception);
+		}
+	}
+}
+
+#endif // !__JOBSYSTEM__H__
@@ -3,13 +3,31 @@
 //***************************************************************************************
 
 #include "Waves.h"
-#include <ppl.h>
+#include "JobSystem.h"
 #include <algorithm>
 #include <vector>
 #include <cassert>
 
 using namespace DirectX;
 
+namespace
+{
+	// Rows are independent, so they are split into chunks on the shared job system.
+	template <typename Func>
+	void ParallelForRows(int rowBegin, int rowEnd, Func&& func)
+	{
+		if(rowBegin >= rowEnd)
+			return;
+
+		DSM::JobSystem::GetDefault().ParallelFor(rowBegin, rowEnd, 16,
+			[&func](std::uint32_t chunkBegin, std::uint32_t chunkEnd)
+		{
+			for(std::uint32_t i = chunkBegin; i < chunkEnd; ++i)
+				func(static_cast<int>(i));
+		});
+	}
+}
+
 Waves::Waves(int m, int n, float dx, float dt, float speed, float damping)
 {
     mNumRows = m;
@@ -96,7 +114,7 @@ void Waves::Update(float dt)
 	if( t >= mTimeStep )
 	{
 		// Only update interior points; we use zero boundary conditions.
-		concurrency::parallel_for(1, mNumRows - 1, [this](int i)
+		ParallelForRows(1, mNumRows - 1, [this](int i)
 		//for(int i = 1; i < mNumRows-1; ++i)
 		{
 			for(int j = 1; j < mNumCols-1; ++j)
@@ -130,7 +148,7 @@ void Waves::Update(float dt)
 		//
 		// Compute normals using finite difference scheme.
 		//
-		concurrency::parallel_for(1, mNumRows - 1, [this](int i)
+		ParallelForRows(1, mNumRows - 1, [this](int i)
 		//for(int i = 1; i < mNumRows - 1; ++i)
 		{
 			for(int j = 1; j < mNumCols-1; ++j)
@@ -5,9 +5,12 @@ if is_mode("debug") then
 else 
     binDir = path.join(os.projectdir(), "Bin/Release/" .. groupName)
 end 
-includes("Common")
-includes("ResourceAllocator")
-includes("DescriptorHeap")
-includes("ShadowMap")
-includes("TreeBillboards")
-includes("Blur")
\ No newline at end of file
+if is_plat("windows") then
+    includes("Common")
+    includes("ResourceAllocator")
+    includes("DescriptorHeap")
+    includes("ShadowMap")
+    includes("TreeBillboards")
+    includes("Blur")
+end
+includes("BlurTests")
\ No newline at end of file
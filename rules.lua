@@ -28,6 +28,15 @@ rule("ShaderCopy")
         end)
 rule_end()
 
+-- 着色器热重载直接监视工程中的源文件而非复制后的文件，只用于启用了热重载的目标
+rule("ShaderHotReload")
+    on_load(
+        function(target)
+            local sourceDir = target:scriptdir():gsub("\\", "/")
+            target:add("defines", "DSM_SHADER_SOURCE_DIR=\"" .. sourceDir .. "\"")
+        end)
+rule_end()
+
 rule("ModelCopy")
     after_build(
         function(target)
@@ -14,7 +14,9 @@ end
 add_rules("mode.debug", "mode.release")
 set_defaultmode("debug")
 set_languages("c99", "cxx20")
-set_toolchains("msvc")
+if is_plat("windows") then
+    set_toolchains("msvc")
+end
 set_encodings("utf-8")
 
 
@@ -27,28 +29,30 @@ function add_dxsdk_options()
 end
 
 
--- 添加DXC
-add_includedirs("DXC/inc")
-if is_arch("x64") then
-    add_linkdirs("DXC/lib/x64")
-elseif is_arch("x86") then
-    add_linkdirs("DXC/lib/x86")
-end
-add_links("dxcompiler")
-after_build(function (target)
-        if is_plat("windows") then
+-- DXC 与 assimp 只在 Windows 上使用，其他平台只构建不依赖设备的测试
+if is_plat("windows") then
+    -- 添加DXC
+    add_includedirs("DXC/inc")
+    if is_arch("x64") then
+        add_linkdirs("DXC/lib/x64")
+    elseif is_arch("x86") then
+        add_linkdirs("DXC/lib/x86")
+    end
+    add_links("dxcompiler")
+    after_build(function (target)
             local path = is_arch("x64") and "DXC/bin/x64/dxcompiler.dll" or "DXC/bin/x86/dxcompiler.dll"
             os.cp(path, target:targetdir())
-        end
-    end)
+        end)
 
--- 添加需要的依赖包,同时禁用系统包
-add_requires("assimp", {system = false})
-add_packages("assimp")
+    -- 添加需要的依赖包,同时禁用系统包
+    add_requires("assimp", {system = false})
+    add_packages("assimp")
+end
 
 includes("rules.lua")
 
-includes("Imgui")
-
-includes("InitDX12 - Stencil")
+if is_plat("windows") then
+    includes("Imgui")
+    includes("InitDX12 - Stencil")
+end
 includes("ResourceAllocator -")